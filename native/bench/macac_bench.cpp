@@ -0,0 +1,2158 @@
+/*
+ * MacAC Native Library - Benchmarks
+ * 
+ * Times every public function in macac_native.h plus the JNI bridge entry
+ * points that wrap them, and prints machine-readable results so kernel
+ * changes can be gated on a stored baseline.
+ * 
+ * - Window-dependent functions are swept over powers of two (8..4096)
+ * - Runtime-dispatched kernels are run once per ISA the host supports
+ * - Each case reports median/min nanoseconds and TSC ticks per call
+ * 
+ * Usage:
+ *   macac_native_bench [--format json|csv] [--out FILE] [--filter SUBSTR]
+ *                      [--windows N,N,...] [--min-time-ms MS] [--repeat N]
+ *                      [--compare BASELINE.csv] [--tolerance PCT]
+ * 
+ * With --compare, every case present in the baseline is checked and the
+ * exit status is 2 if any median ns/op grew by more than the tolerance.
+ */
+
+#include "macac_native.h"
+#include "macac_fixed_ring.h"
+#include <jni.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#ifndef MACAC_BENCH_VERSION
+#define MACAC_BENCH_VERSION "dev"
+#endif
+
+// ============================================================================
+// JNI Bridge Entry Points (defined in jni_bridge.cpp)
+// ============================================================================
+
+extern "C" {
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_nanoTime(JNIEnv*, jclass);
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferPush(
+    JNIEnv*, jclass, jlong, jdouble);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferMean(
+    JNIEnv*, jclass, jlong);
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_slabPush(
+    JNIEnv*, jclass, jlong, jlong, jint, jdouble);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdSum(
+    JNIEnv*, jclass, jdoubleArray);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_median(
+    JNIEnv*, jclass, jdoubleArray);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdMeanDirect(
+    JNIEnv*, jclass, jobject, jint);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdVarianceDirect(
+    JNIEnv*, jclass, jobject, jint);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_simdDescribeDirect(
+    JNIEnv*, jclass, jobject, jint, jdoubleArray);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_medianDirect(
+    JNIEnv*, jclass, jobject, jint);
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsPush(
+    JNIEnv*, jclass, jlong, jdouble);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_distance3D(
+    JNIEnv*, jclass, jdouble, jdouble, jdouble, jdouble, jdouble, jdouble);
+JNIEXPORT jdoubleArray JNICALL Java_com_macmoment_macac_util_NativeHelper_calcAimAngles(
+    JNIEnv*, jclass, jdouble, jdouble, jdouble, jdouble, jdouble, jdouble);
+JNIEXPORT jdoubleArray JNICALL Java_com_macmoment_macac_util_NativeHelper_analyzeCombat(
+    JNIEnv*, jclass, jdoubleArray, jdoubleArray, jdoubleArray, jdoubleArray, jdoubleArray);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_analyzeCombatBatch(
+    JNIEnv*, jclass, jobject, jint, jint, jobject);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_batchDistance3DF32(
+    JNIEnv*, jclass, jobject, jint, jobject);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_batchAimError(
+    JNIEnv*, jclass, jdouble, jdouble, jdouble, jdouble, jdouble, jobject, jint, jobject);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_predictMovementBatch(
+    JNIEnv*, jclass, jobject, jint, jint, jobject);
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_perfBegin(JNIEnv*, jclass);
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_perfEnd(JNIEnv*, jclass, jint, jlong);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueuePush(
+    JNIEnv*, jclass, jlong, jint, jint, jdouble, jdouble, jdouble,
+    jfloat, jfloat, jfloat, jfloat, jint, jlong, jlong);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueueDrain(
+    JNIEnv*, jclass, jlong, jobject, jint);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_captureTelemetry(
+    JNIEnv*, jclass, jlong, jlong, jlong, jint, jdouble, jdouble, jdouble,
+    jfloat, jfloat, jfloat, jfloat, jint, jlong, jlong);
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_senderSendViolation(
+    JNIEnv*, jclass, jlong, jstring, jstring, jdouble, jdouble, jlong);
+}
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+struct bench_options {
+    std::string format = "json";
+    std::string out_path;
+    std::string filter;
+    std::string compare_path;
+    std::vector<size_t> windows = { 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    double min_time_ms = 20.0;      // Measured time per case, split across repeats
+    int repeats = 5;
+    double tolerance_pct = 10.0;
+};
+
+struct bench_result {
+    std::string name;
+    std::string isa;
+    size_t window;
+    uint64_t iterations;            // Calls per repeat
+    double ns_per_op;               // Median over repeats
+    double ns_min;                  // Fastest repeat
+    double ticks_per_op;            // Median TSC ticks (macac_rdtscp)
+};
+
+static bench_options options;
+static std::vector<bench_result> results;
+
+/**
+ * Keep a value live without emitting a store (GNU/Clang inline asm).
+ */
+template <typename T>
+static inline void keep(const T& value) {
+    __asm__ __volatile__("" : : "r,m"(value) : "memory");
+}
+
+static int64_t wall_nanos(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* active_isa(void) {
+    return macac_cpu_isa_name(macac_cpu_isa());
+}
+
+/**
+ * Run body(iterations) until one repeat takes min_time_ms / repeats,
+ * then record the median of the configured number of repeats.
+ * Wall time comes from steady_clock; ticks from macac_rdtscp.
+ */
+template <typename Body>
+static void run_case(const std::string& name, size_t window, Body&& body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return;
+    }
+    
+    int64_t target_ns = (int64_t)(options.min_time_ms * 1e6 / options.repeats);
+    if (target_ns < 1000) {
+        target_ns = 1000;
+    }
+    
+    // Calibrate iteration count (also serves as warmup)
+    uint64_t iterations = 1;
+    for (;;) {
+        int64_t start = wall_nanos();
+        body(iterations);
+        int64_t elapsed = wall_nanos() - start;
+        
+        if (elapsed >= target_ns || iterations >= (1ull << 31)) {
+            break;
+        }
+        uint64_t scaled = elapsed > 0
+            ? (uint64_t)((double)iterations * 1.2 * (double)target_ns / (double)elapsed)
+            : iterations * 16;
+        iterations = std::max(iterations * 2, std::min(scaled, iterations * 64));
+    }
+    
+    std::vector<double> ns(options.repeats);
+    std::vector<double> ticks(options.repeats);
+    for (int r = 0; r < options.repeats; r++) {
+        int64_t start = wall_nanos();
+        uint64_t tsc_start = macac_rdtscp();
+        body(iterations);
+        uint64_t tsc_end = macac_rdtscp();
+        int64_t end = wall_nanos();
+        
+        ns[r] = (double)(end - start) / (double)iterations;
+        ticks[r] = (double)(tsc_end - tsc_start) / (double)iterations;
+    }
+    
+    bench_result result;
+    result.name = name;
+    result.isa = active_isa();
+    result.window = window;
+    result.iterations = iterations;
+    result.ns_min = *std::min_element(ns.begin(), ns.end());
+    std::sort(ns.begin(), ns.end());
+    std::sort(ticks.begin(), ticks.end());
+    result.ns_per_op = ns[ns.size() / 2];
+    result.ticks_per_op = ticks[ticks.size() / 2];
+    results.push_back(result);
+    
+    fprintf(stderr, "  %-36s %-7s %5zu  %12.2f ns/op  %12.1f ticks/op\n",
+            name.c_str(), result.isa.c_str(), window, result.ns_per_op, result.ticks_per_op);
+}
+
+/**
+ * Deterministic pseudo-random samples in [lo, hi).
+ */
+static std::vector<double> make_samples(size_t count, double lo, double hi, uint32_t seed) {
+    std::vector<double> data(count);
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < count; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        data[i] = lo + (hi - lo) * ((double)x / 4294967296.0);
+    }
+    return data;
+}
+
+// ============================================================================
+// Fake JNI Environment
+// ============================================================================
+
+//
+// The bridge only talks to the JVM through the JNIEnv function table, so
+// a table that mimics HotSpot's copy semantics measures everything the
+// bridge adds on top of the C API: argument checks, Get<Type>ArrayElements
+// (HotSpot always copies into a malloc'd buffer), Get/Set<Type>ArrayRegion
+// (memcpy), UTF string copies and result array creation. Critical access
+// pins the array in place (no copy), as HotSpot does. Table entries the
+// bridge does not use stay null, so a new JNI call shows up as a crash here.
+// The Java-to-native transition itself (thread state changes, safepoint
+// polls, handle blocks) is not included; measure it from Java.
+//
+
+struct fake_array {
+    jsize length;
+    double* data;
+};
+
+struct fake_string {
+    const char* utf;
+    size_t length;
+};
+
+struct fake_buffer {
+    void* address;
+    jlong capacity;
+};
+
+// Small pool that stands in for Java heap allocation of result arrays
+#define FAKE_RESULT_SLOTS 8
+#define FAKE_RESULT_LENGTH 16
+static fake_array fake_results[FAKE_RESULT_SLOTS];
+static double fake_result_data[FAKE_RESULT_SLOTS][FAKE_RESULT_LENGTH];
+static size_t fake_result_next = 0;
+
+static fake_array* as_array(jarray array) {
+    return reinterpret_cast<fake_array*>(array);
+}
+
+static jsize JNICALL fake_get_array_length(JNIEnv*, jarray array) {
+    return as_array(array)->length;
+}
+
+static jdouble* JNICALL fake_get_double_elements(JNIEnv*, jdoubleArray array, jboolean* is_copy) {
+    fake_array* a = as_array(array);
+    jdouble* copy = (jdouble*)malloc((size_t)a->length * sizeof(jdouble));
+    if (copy) {
+        memcpy(copy, a->data, (size_t)a->length * sizeof(jdouble));
+    }
+    if (is_copy) {
+        *is_copy = JNI_TRUE;
+    }
+    return copy;
+}
+
+static void JNICALL fake_release_double_elements(JNIEnv*, jdoubleArray array, jdouble* elements,
+                                                 jint mode) {
+    fake_array* a = as_array(array);
+    if (mode != JNI_ABORT) {
+        memcpy(a->data, elements, (size_t)a->length * sizeof(jdouble));
+    }
+    if (mode != JNI_COMMIT) {
+        free(elements);
+    }
+}
+
+static void* JNICALL fake_get_critical(JNIEnv*, jarray array, jboolean* is_copy) {
+    if (is_copy) {
+        *is_copy = JNI_FALSE;
+    }
+    return as_array(array)->data;
+}
+
+static void JNICALL fake_release_critical(JNIEnv*, jarray, void*, jint) {
+}
+
+static void JNICALL fake_get_double_region(JNIEnv*, jdoubleArray array, jsize start, jsize len,
+                                           jdouble* buf) {
+    memcpy(buf, as_array(array)->data + start, (size_t)len * sizeof(jdouble));
+}
+
+static void JNICALL fake_set_double_region(JNIEnv*, jdoubleArray array, jsize start, jsize len,
+                                           const jdouble* buf) {
+    memcpy(as_array(array)->data + start, buf, (size_t)len * sizeof(jdouble));
+}
+
+static jdoubleArray JNICALL fake_new_double_array(JNIEnv*, jsize length) {
+    if (length < 0 || length > FAKE_RESULT_LENGTH) {
+        return nullptr;
+    }
+    size_t slot = fake_result_next++ % FAKE_RESULT_SLOTS;
+    fake_results[slot].length = length;
+    fake_results[slot].data = fake_result_data[slot];
+    memset(fake_result_data[slot], 0, (size_t)length * sizeof(double));
+    return reinterpret_cast<jdoubleArray>(&fake_results[slot]);
+}
+
+static const char* JNICALL fake_get_string_utf(JNIEnv*, jstring string, jboolean* is_copy) {
+    fake_string* s = reinterpret_cast<fake_string*>(string);
+    char* copy = (char*)malloc(s->length + 1);
+    if (copy) {
+        memcpy(copy, s->utf, s->length + 1);
+    }
+    if (is_copy) {
+        *is_copy = JNI_TRUE;
+    }
+    return copy;
+}
+
+static void JNICALL fake_release_string_utf(JNIEnv*, jstring, const char* chars) {
+    free((void*)chars);
+}
+
+// Fake strings are ASCII, so UTF-8 and UTF-16 lengths agree
+static jsize JNICALL fake_get_string_length(JNIEnv*, jstring string) {
+    return (jsize)reinterpret_cast<fake_string*>(string)->length;
+}
+
+static void JNICALL fake_get_string_utf_region(JNIEnv*, jstring string, jsize start, jsize len,
+                                               char* buf) {
+    memcpy(buf, reinterpret_cast<fake_string*>(string)->utf + start, (size_t)len);
+}
+
+static jstring JNICALL fake_new_string_utf(JNIEnv*, const char*) {
+    return nullptr;
+}
+
+static void* JNICALL fake_direct_address(JNIEnv*, jobject buffer) {
+    return reinterpret_cast<fake_buffer*>(buffer)->address;
+}
+
+static jlong JNICALL fake_direct_capacity(JNIEnv*, jobject buffer) {
+    return reinterpret_cast<fake_buffer*>(buffer)->capacity;
+}
+
+static JNINativeInterface_ fake_table;
+static JNIEnv fake_env;
+
+static JNIEnv* fake_jni_env(void) {
+    static bool initialized = false;
+    if (!initialized) {
+        memset(&fake_table, 0, sizeof(fake_table));
+        fake_table.GetArrayLength = fake_get_array_length;
+        fake_table.GetDoubleArrayElements = fake_get_double_elements;
+        fake_table.ReleaseDoubleArrayElements = fake_release_double_elements;
+        fake_table.GetDoubleArrayRegion = fake_get_double_region;
+        fake_table.GetPrimitiveArrayCritical = fake_get_critical;
+        fake_table.ReleasePrimitiveArrayCritical = fake_release_critical;
+        fake_table.SetDoubleArrayRegion = fake_set_double_region;
+        fake_table.NewDoubleArray = fake_new_double_array;
+        fake_table.GetStringUTFChars = fake_get_string_utf;
+        fake_table.ReleaseStringUTFChars = fake_release_string_utf;
+        fake_table.GetStringLength = fake_get_string_length;
+        fake_table.GetStringUTFLength = fake_get_string_length;
+        fake_table.GetStringUTFRegion = fake_get_string_utf_region;
+        fake_table.NewStringUTF = fake_new_string_utf;
+        fake_table.GetDirectBufferAddress = fake_direct_address;
+        fake_table.GetDirectBufferCapacity = fake_direct_capacity;
+        fake_env.functions = &fake_table;
+        initialized = true;
+    }
+    return &fake_env;
+}
+
+// ============================================================================
+// Loopback Sink (for network benchmarks)
+// ============================================================================
+
+struct loopback_sink {
+    int listen_fd = -1;
+    int port = 0;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+
+/**
+ * Accept every connection on 127.0.0.1 and discard whatever it sends.
+ * Binary-protocol hellos are not acknowledged, so senders run JSON.
+ */
+static bool sink_start(loopback_sink* sink) {
+    sink->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sink->listen_fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(sink->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(sink->listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(sink->listen_fd, 1024) < 0 ||
+        getsockname(sink->listen_fd, (sockaddr*)&addr, &len) < 0) {
+        close(sink->listen_fd);
+        sink->listen_fd = -1;
+        return false;
+    }
+    sink->port = ntohs(addr.sin_port);
+    sink->running = true;
+    
+    sink->thread = std::thread([sink]() {
+        std::vector<pollfd> fds;
+        fds.push_back({ sink->listen_fd, POLLIN, 0 });
+        char buffer[65536];
+        
+        while (sink->running.load(std::memory_order_relaxed)) {
+            if (poll(fds.data(), fds.size(), 50) <= 0) {
+                continue;
+            }
+            for (size_t i = fds.size(); i-- > 1;) {
+                if (!fds[i].revents) {
+                    continue;
+                }
+                ssize_t n = recv(fds[i].fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    close(fds[i].fd);
+                    fds.erase(fds.begin() + (ptrdiff_t)i);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                int client = accept(sink->listen_fd, nullptr, nullptr);
+                if (client >= 0) {
+                    fds.push_back({ client, POLLIN, 0 });
+                }
+            }
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            close(fds[i].fd);
+        }
+    });
+    return true;
+}
+
+static void sink_stop(loopback_sink* sink) {
+    sink->running = false;
+    if (sink->thread.joinable()) {
+        sink->thread.join();
+    }
+    if (sink->listen_fd >= 0) {
+        close(sink->listen_fd);
+        sink->listen_fd = -1;
+    }
+}
+
+// ============================================================================
+// Benchmark Groups
+// ============================================================================
+
+static void bench_timing(void) {
+    macac_calibrate_tsc();
+    run_case("timing.nanotime", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_nanotime());
+    });
+    run_case("timing.rdtscp", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_rdtscp());
+    });
+    run_case("timing.calibrate_tsc", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_calibrate_tsc());
+    });
+    run_case("timing.tsc_to_nanos", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_tsc_to_nanos(i));
+    });
+    run_case("timing.tsc_source", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_tsc_source());
+    });
+    run_case("timing.tsc_invariant", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_tsc_invariant());
+    });
+    run_case("timing.tsc_hz", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_tsc_hz());
+    });
+}
+
+static void bench_perf(void) {
+    int site = macac_perf_register("bench.perf");
+    
+    run_case("perf.begin_end", 0, [site](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_perf_end(site, macac_perf_begin());
+        }
+    });
+    run_case("perf.record", 0, [site](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_perf_record(site, i & 0xFFFF);
+        }
+    });
+    run_case("perf.scope", 0, [site](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_perf_scope scope(site);
+        }
+    });
+    run_case("perf.snapshot", 0, [site](uint64_t n) {
+        macac_perf_snapshot_t snap;
+        for (uint64_t i = 0; i < n; i++) {
+            macac_perf_snapshot(site, &snap);
+            keep(snap.p99_ns);
+        }
+    });
+    
+    // Counter cases only where perf events open (not in most VMs' PMU-less guests)
+    if (macac_pmu_start() != 0) {
+        run_case("pmu.begin_end", 0, [site](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                macac_perf_end(site, macac_perf_begin());
+            }
+        });
+        run_case("pmu.snapshot", 0, [site](uint64_t n) {
+            macac_pmu_snapshot_t snap;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_pmu_snapshot(site, &snap);
+                keep(snap.scopes);
+            }
+        });
+        macac_pmu_stop();
+    }
+}
+
+static void bench_cpu(void) {
+    run_case("cpu.init", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) macac_cpu_init();
+    });
+    run_case("cpu.isa", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_cpu_isa());
+    });
+    run_case("cpu.best_isa", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_cpu_best_isa());
+    });
+    run_case("cpu.supports", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_cpu_supports((int)(i & 3)));
+    });
+    run_case("cpu.isa_name", 0, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_cpu_isa_name((int)(i & 3)));
+    });
+    int isa = macac_cpu_isa();
+    run_case("cpu.set_isa", 0, [isa](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_cpu_set_isa(isa));
+    });
+}
+
+/**
+ * The header-only ring at compile-time capacity N, full window.
+ */
+template <size_t N>
+static void bench_fixed_ring(const std::vector<double>& samples) {
+    static macac_fixed_ring<double, N> ring;
+    for (double v : samples) ring.push(v);
+    
+    run_case("fixed_ring.push", N, [&samples](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) ring.push(samples[i & (N - 1)]);
+    });
+    run_case("fixed_ring.get", N, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(ring.get(i & (N - 1)));
+    });
+    run_case("fixed_ring.mean", N, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(ring.mean());
+    });
+    run_case("fixed_ring.variance", N, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(ring.variance());
+    });
+    run_case("fixed_ring.min", N, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(ring.min());
+    });
+    run_case("fixed_ring.max", N, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(ring.max());
+    });
+}
+
+static void bench_ringbuffer(size_t window) {
+    std::vector<double> samples = make_samples(window, 0.0, 1.0, 17);
+    
+    run_case("ringbuffer.create_destroy", window, [window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_ringbuffer_t* rb = macac_ringbuffer_create(window);
+            keep(rb);
+            macac_ringbuffer_destroy(rb);
+        }
+    });
+    
+    for (int tracked = 0; tracked <= 1; tracked++) {
+        std::string prefix = tracked ? "ringbuffer.tracked." : "ringbuffer.";
+        macac_ringbuffer_t* rb = tracked
+            ? macac_ringbuffer_create_tracked(window)
+            : macac_ringbuffer_create(window);
+        for (double v : samples) {
+            macac_ringbuffer_push(rb, v);
+        }
+        
+        run_case(prefix + "push", window, [rb, &samples](uint64_t n) {
+            size_t mask = samples.size() - 1;
+            for (uint64_t i = 0; i < n; i++) macac_ringbuffer_push(rb, samples[i & mask]);
+        });
+        run_case(prefix + "get", window, [rb, window](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_get(rb, i % window));
+        });
+        run_case(prefix + "size", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_size(rb));
+        });
+        run_case(prefix + "is_tracked", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_is_tracked(rb));
+        });
+        run_case(prefix + "mean", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_mean(rb));
+        });
+        run_case(prefix + "variance", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_variance(rb));
+        });
+        run_case(prefix + "min", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_min(rb));
+        });
+        run_case(prefix + "max", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_max(rb));
+        });
+        run_case(prefix + "clear_refill", window, [rb, &samples](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                macac_ringbuffer_clear(rb);
+                for (double v : samples) macac_ringbuffer_push(rb, v);
+            }
+        });
+        
+        macac_ringbuffer_destroy(rb);
+    }
+    
+    // Compact storage: narrowing on push, widening in every reduction
+    const int storages[] = {MACAC_STORAGE_F32, MACAC_STORAGE_Q16};
+    for (int storage : storages) {
+        std::string prefix = storage == MACAC_STORAGE_F32 ? "ringbuffer.f32." : "ringbuffer.q16.";
+        macac_ringbuffer_t* rb = macac_ringbuffer_create_typed(window, storage, 0);
+        macac_ringbuffer_t* tracked = macac_ringbuffer_create_typed(window, storage, 1);
+        for (double v : samples) {
+            macac_ringbuffer_push(rb, v);
+            macac_ringbuffer_push(tracked, v);
+        }
+        
+        run_case(prefix + "push", window, [rb, &samples](uint64_t n) {
+            size_t mask = samples.size() - 1;
+            for (uint64_t i = 0; i < n; i++) macac_ringbuffer_push(rb, samples[i & mask]);
+        });
+        run_case(prefix + "tracked.push", window, [tracked, &samples](uint64_t n) {
+            size_t mask = samples.size() - 1;
+            for (uint64_t i = 0; i < n; i++) macac_ringbuffer_push(tracked, samples[i & mask]);
+        });
+        run_case(prefix + "get", window, [rb, window](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_get(rb, i % window));
+        });
+        run_case(prefix + "mean", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_mean(rb));
+        });
+        run_case(prefix + "variance", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_variance(rb));
+        });
+        run_case(prefix + "min", window, [rb](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_min(rb));
+        });
+        
+        macac_ringbuffer_destroy(rb);
+        macac_ringbuffer_destroy(tracked);
+    }
+    
+    // Same windows through the template the specialised kernels share
+    switch (window) {
+        case 8: bench_fixed_ring<8>(samples); break;
+        case 16: bench_fixed_ring<16>(samples); break;
+        case 32: bench_fixed_ring<32>(samples); break;
+        case 64: bench_fixed_ring<64>(samples); break;
+        case 128: bench_fixed_ring<128>(samples); break;
+        case 256: bench_fixed_ring<256>(samples); break;
+        default: break;
+    }
+}
+
+static void bench_queue(size_t window) {
+    run_case("queue.create_destroy", window, [window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_packet_queue_t* q = macac_queue_create(window, MACAC_QUEUE_MPSC);
+            keep(q);
+            macac_queue_destroy(q);
+        }
+    });
+    
+    std::vector<macac_telemetry_record_t> out(window);
+    for (int mode = MACAC_QUEUE_SPSC; mode <= MACAC_QUEUE_MPSC; mode++) {
+        std::string prefix = mode == MACAC_QUEUE_SPSC ? "queue.spsc." : "queue.mpsc.";
+        macac_packet_queue_t* q = macac_queue_create(window, mode);
+        macac_telemetry_record_t record = {};
+        record.player = 7;
+        
+        // One record per iteration, drained in batches of window when full
+        run_case(prefix + "push", window, [q, &record, &out, window](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                record.nano_time = (int64_t)i;
+                if (macac_queue_push(q, &record) != 0) {
+                    keep(macac_queue_drain(q, out.data(), window));
+                    macac_queue_push(q, &record);
+                }
+            }
+        });
+        macac_queue_drain(q, out.data(), window);
+        
+        run_case(prefix + "push_drain_batch", window, [q, &record, &out, window](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < window; j++) {
+                    macac_queue_push(q, &record);
+                }
+                keep(macac_queue_drain(q, out.data(), window));
+            }
+        });
+        run_case(prefix + "size", window, [q](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_queue_size(q));
+        });
+        run_case(prefix + "dropped", window, [q](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_queue_dropped(q));
+        });
+        
+        macac_queue_destroy(q);
+    }
+}
+
+/**
+ * Capture producers at a sustained rate: when the ring is full the case
+ * waits for the writer, so the figure includes the disk, not just the copy.
+ */
+static void bench_capture(void) {
+    char dir[] = "/tmp/macac_bench_capture_XXXXXX";
+    if (!mkdtemp(dir)) {
+        return;
+    }
+    std::string prefix = std::string(dir) + "/bench";
+    
+    run_case("capture.open_close", 0, [&prefix](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_capture_t* c = macac_capture_open(prefix.c_str(), 1024, 64ull << 20, 1);
+            keep(c);
+            macac_capture_close(c);
+        }
+    });
+    
+    macac_capture_t* capture = macac_capture_open(prefix.c_str(), 1 << 16, 64ull << 20, 2);
+    if (capture) {
+        macac_telemetry_record_t record = {};
+        record.flags = MACAC_TELEMETRY_ON_GROUND;
+        macac_capture_combat_t attack = {};
+        attack.flags = MACAC_CAPTURE_HIT | MACAC_CAPTURE_HAS_TARGET;
+        
+        run_case("capture.telemetry", 0, [capture, &record](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                record.nano_time = (int64_t)i;
+                while (macac_capture_telemetry(capture, 1, 2, &record) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        run_case("capture.combat", 0, [capture, &attack](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                attack.nano_time = (int64_t)i;
+                while (macac_capture_combat(capture, &attack) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        
+        JNIEnv* env = fake_jni_env();
+        jlong handle = (jlong)(intptr_t)capture;
+        run_case("jni.captureTelemetry", 0, [env, handle](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                while (Java_com_macmoment_macac_util_NativeHelper_captureTelemetry(
+                           env, nullptr, handle, 1, 2, MACAC_TELEMETRY_ON_GROUND, 0.2, 0.0, 0.1,
+                           90.0f, 10.0f, 1.5f, 0.5f, 50, (jlong)i, 50000000) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        run_case("capture.get_stats", 0, [capture](uint64_t n) {
+            macac_capture_stats_t stats;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_capture_get_stats(capture, &stats);
+                keep(stats.records);
+            }
+        });
+        macac_capture_close(capture);
+    }
+    
+    if (DIR* d = opendir(dir)) {
+        while (struct dirent* entry = readdir(d)) {
+            if (entry->d_name[0] != '.') {
+                unlink((std::string(dir) + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir);
+}
+
+static void bench_slab(size_t window) {
+    const size_t slots = 64;
+    const size_t metrics = 4;
+    std::vector<double> samples = make_samples(window, 0.0, 1.0, 23);
+    
+    run_case("slab.create_destroy", window, [window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_history_slab_t* slab = macac_slab_create(slots, metrics, window);
+            keep(slab);
+            macac_slab_destroy(slab);
+        }
+    });
+    
+    macac_history_slab_t* slab = macac_slab_create(slots, metrics, window);
+    if (!slab) {
+        return;
+    }
+    int64_t id = macac_slab_acquire(slab);
+    for (size_t m = 0; m < metrics; m++) {
+        for (double v : samples) macac_slab_push(slab, id, m, v);
+    }
+    
+    run_case("slab.acquire_release", window, [slab](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            int64_t slot = macac_slab_acquire(slab);
+            keep(slot);
+            macac_slab_release(slab, slot);
+        }
+    });
+    run_case("slab.push", window, [slab, id, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            macac_slab_push(slab, id, (size_t)(i & (metrics - 1)), samples[i & mask]);
+        }
+    });
+    run_case("slab.get", window, [slab, id, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_get(slab, id, 0, i % window));
+    });
+    run_case("slab.size", window, [slab, id](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_size(slab, id, 0));
+    });
+    run_case("slab.window", window, [slab, id](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t count;
+            keep(macac_slab_window(slab, id, 0, &count));
+            keep(count);
+        }
+    });
+    run_case("slab.mean", window, [slab, id](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_mean(slab, id, 0));
+    });
+    run_case("slab.variance", window, [slab, id](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_variance(slab, id, 0));
+    });
+    std::vector<double> out(window);
+    run_case("slab.read", window, [slab, id, &out](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_read(slab, id, 0, out.data(), out.size()));
+    });
+    run_case("slab.active_count", window, [slab](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_active_count(slab));
+    });
+    run_case("slab.dormant_count", window, [slab](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_slab_dormant_count(slab));
+    });
+    
+    // Rejoin path: park a player and reclaim the same windows
+    run_case("slab.park_acquire_for", window, [slab](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            int64_t slot = macac_slab_acquire_for(slab, 0x1234, 0x5678);
+            keep(slot);
+            macac_slab_park(slab, slot);
+        }
+    });
+    
+    macac_slab_destroy(slab);
+    
+    // Compact windows: a quarter to a half of the arena per player
+    const int storages[] = {MACAC_STORAGE_F32, MACAC_STORAGE_Q16};
+    for (int storage : storages) {
+        std::string prefix = storage == MACAC_STORAGE_F32 ? "slab.f32." : "slab.q16.";
+        macac_history_slab_t* typed = macac_slab_create_typed(slots, metrics, window, storage);
+        if (!typed) {
+            continue;
+        }
+        int64_t tid = macac_slab_acquire(typed);
+        for (size_t m = 0; m < metrics; m++) {
+            for (double v : samples) macac_slab_push(typed, tid, m, v);
+        }
+        
+        run_case(prefix + "push", window, [typed, tid, &samples](uint64_t n) {
+            size_t mask = samples.size() - 1;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_slab_push(typed, tid, (size_t)(i & (metrics - 1)), samples[i & mask]);
+            }
+        });
+        run_case(prefix + "get", window, [typed, tid, window](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_slab_get(typed, tid, 0, i % window));
+        });
+        run_case(prefix + "mean", window, [typed, tid](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_slab_mean(typed, tid, 0));
+        });
+        run_case(prefix + "variance", window, [typed, tid](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_slab_variance(typed, tid, 0));
+        });
+        macac_slab_destroy(typed);
+    }
+    
+    // Mapped slab: the file lives in the temp directory for the run
+    char path[] = "/tmp/macac_bench_slab_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+    
+    run_case("slab.mapped.open_close", window, [&path, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_history_slab_t* mapped = macac_slab_open_mapped(path, slots, metrics, window);
+            keep(mapped);
+            macac_slab_destroy(mapped);
+        }
+    });
+    
+    macac_history_slab_t* mapped = macac_slab_open_mapped(path, slots, metrics, window);
+    if (mapped) {
+        int64_t mid = macac_slab_acquire_for(mapped, 1, 1);
+        run_case("slab.mapped.push", window, [mapped, mid, &samples](uint64_t n) {
+            size_t mask = samples.size() - 1;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_slab_push(mapped, mid, (size_t)(i & (metrics - 1)), samples[i & mask]);
+            }
+        });
+        run_case("slab.mapped.sync_async", window, [mapped](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_slab_sync(mapped, 0));
+        });
+        run_case("slab.mapped.is_mapped", window, [mapped](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_slab_is_mapped(mapped));
+        });
+        macac_slab_destroy(mapped);
+    }
+    unlink(path);
+}
+
+/**
+ * Runtime-dispatched kernels, once per ISA the host can run.
+ */
+static void bench_dispatched(size_t window) {
+    std::vector<double> samples = make_samples(window, -10.0, 10.0, 31);
+    std::vector<double> coords = make_samples(window * 6, -64.0, 64.0, 37);
+    std::vector<double> distances(window);
+    int original = macac_cpu_isa();
+    
+    // SoA columns, 64-byte aligned like the slab arena
+    double* soa = (double*)aligned_alloc(64, window * 7 * sizeof(double));
+    float* soa_f32 = (float*)aligned_alloc(64, window * 7 * sizeof(float));
+    for (size_t i = 0; i < window; i++) {
+        for (size_t k = 0; k < 6; k++) {
+            soa[k * window + i] = coords[i * 6 + k];
+            soa_f32[k * window + i] = (float)coords[i * 6 + k];
+        }
+    }
+    std::vector<double> aim(window * 3);
+    
+    // One movement step per player, window players, padded columns
+    size_t move_stride = (window + 7) & ~(size_t)7;
+    double* move_in = (double*)aligned_alloc(64, MACAC_MOVE_INPUT_COLUMNS * move_stride * sizeof(double));
+    double* move_out = (double*)aligned_alloc(64, MACAC_MOVE_OUTPUT_COLUMNS * move_stride * sizeof(double));
+    for (size_t i = 0; i < window; i++) {
+        for (size_t k = 0; k < 6; k++) {
+            move_in[k * move_stride + i] = coords[i * 6 + k] / 128.0;
+        }
+        move_in[MACAC_MOVE_GROUND * move_stride + i] = (i & 3) == 0 ? 1.0 : 0.0;
+        move_in[MACAC_MOVE_FRICTION * move_stride + i] = 0.91;
+        move_in[MACAC_MOVE_GRAVITY * move_stride + i] = 0.08;
+        move_in[MACAC_MOVE_DRAG * move_stride + i] = 0.98;
+    }
+    
+    // Compact windows reduce through the widening kernels
+    macac_ringbuffer_t* f32 = macac_ringbuffer_create_typed(window, MACAC_STORAGE_F32, 0);
+    macac_ringbuffer_t* q16 = macac_ringbuffer_create_typed(window, MACAC_STORAGE_Q16, 0);
+    for (double v : samples) {
+        macac_ringbuffer_push(f32, v);
+        macac_ringbuffer_push(q16, v);
+    }
+    
+    for (int isa = MACAC_ISA_SCALAR; isa <= MACAC_ISA_NEON; isa++) {
+        if (!macac_cpu_supports(isa) || macac_cpu_set_isa(isa) != 0) {
+            continue;
+        }
+        double mean = macac_simd_mean(samples.data(), window);
+        
+        run_case("simd.sum", window, [&samples](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_simd_sum(samples.data(), samples.size()));
+        });
+        run_case("simd.mean", window, [&samples](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_simd_mean(samples.data(), samples.size()));
+        });
+        run_case("simd.variance", window, [&samples, mean](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_simd_variance(samples.data(), samples.size(), mean));
+            }
+        });
+        run_case("simd.moments", window, [&samples](uint64_t n) {
+            macac_moments_t m;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_simd_moments(samples.data(), samples.size(), &m);
+                keep(m.variance);
+            }
+        });
+        run_case("simd.f32.mean", window, [f32](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_mean(f32));
+        });
+        run_case("simd.f32.variance", window, [f32](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_variance(f32));
+        });
+        run_case("simd.q16.mean", window, [q16](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_mean(q16));
+        });
+        run_case("simd.q16.variance", window, [q16](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_ringbuffer_variance(q16));
+        });
+        run_case("simd.describe", window, [&samples](uint64_t n) {
+            macac_describe_t d;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_simd_describe(samples.data(), samples.size(), &d);
+                keep(d.kurtosis);
+            }
+        });
+        if (window >= MACAC_SPECTRAL_MIN_WINDOW) {
+            // Windows above 256 analyse their newest 256 samples
+            run_case("spectral.analyze", window, [&samples](uint64_t n) {
+                macac_spectral_t spectrum;
+                for (uint64_t i = 0; i < n; i++) {
+                    keep(macac_spectral_analyze(samples.data(), samples.size(), &spectrum));
+                    keep(spectrum.entropy);
+                }
+            });
+        }
+        run_case("combat.batch_distance_3d", window, [&coords, &distances](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                macac_batch_distance_3d(coords.data(), distances.data(), distances.size());
+                keep(distances[0]);
+            }
+        });
+        run_case("combat.batch_distance_3d_soa", window, [soa, window](uint64_t n) {
+            const double* c = soa;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_batch_distance_3d_soa(c, c + window, c + 2 * window, c + 3 * window,
+                                            c + 4 * window, c + 5 * window, soa + 6 * window,
+                                            window);
+                keep(soa[6 * window]);
+            }
+        });
+        run_case("combat.batch_distance_3d_soa_f32", window, [soa_f32, window](uint64_t n) {
+            const float* c = soa_f32;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_batch_distance_3d_soa_f32(c, c + window, c + 2 * window, c + 3 * window,
+                                                c + 4 * window, c + 5 * window,
+                                                soa_f32 + 6 * window, window);
+                keep(soa_f32[6 * window]);
+            }
+        });
+        run_case("combat.batch_aim_error", window, [soa, &aim, window](uint64_t n) {
+            const double* t = soa + 3 * window;
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_batch_aim_error(0.5, 64.0, -0.5, 37.0, 12.0, t, t + window, t + 2 * window,
+                                           window, aim.data(), aim.data() + window,
+                                           aim.data() + 2 * window));
+            }
+        });
+        run_case("combat.batch_aim_error_argmin", window, [soa, window](uint64_t n) {
+            const double* t = soa + 3 * window;
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_batch_aim_error(0.5, 64.0, -0.5, 37.0, 12.0, t, t + window, t + 2 * window,
+                                           window, nullptr, nullptr, nullptr));
+            }
+        });
+        run_case("movement.predict_batch", window, [move_in, move_out, window, move_stride](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_movement_predict_batch(move_in, window, move_stride, move_out));
+                keep(move_out[MACAC_MOVE_DRIFT * move_stride]);
+            }
+        });
+    }
+    
+    free(soa);
+    free(soa_f32);
+    free(move_in);
+    free(move_out);
+    macac_ringbuffer_destroy(f32);
+    macac_ringbuffer_destroy(q16);
+    macac_cpu_set_isa(original);
+}
+
+static void bench_order(size_t window) {
+    std::vector<double> samples = make_samples(window, 0.0, 100.0, 41);
+    std::vector<double> scratch(window);
+    
+    run_case("stats.median", window, [&samples](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_median(samples.data(), samples.size()));
+    });
+    run_case("stats.mad", window, [&samples](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_mad(samples.data(), samples.size()));
+    });
+    run_case("stats.median_scratch", window, [&samples, &scratch](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_median_scratch(samples.data(), samples.size(), scratch.data()));
+        }
+    });
+    run_case("stats.mad_scratch", window, [&samples, &scratch](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_mad_scratch(samples.data(), samples.size(), scratch.data()));
+        }
+    });
+    
+    run_case("order_stats.create_destroy", window, [window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_order_stats_t* os = macac_order_stats_create(window);
+            keep(os);
+            macac_order_stats_destroy(os);
+        }
+    });
+    
+    macac_order_stats_t* os = macac_order_stats_create(window);
+    for (double v : samples) {
+        macac_order_stats_push(os, v);
+    }
+    
+    run_case("order_stats.push", window, [os, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) macac_order_stats_push(os, samples[(i * 7) & mask]);
+    });
+    run_case("order_stats.median", window, [os](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_order_stats_median(os));
+    });
+    run_case("order_stats.select", window, [os, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_order_stats_select(os, i % window));
+    });
+    run_case("order_stats.mad", window, [os](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_order_stats_mad(os));
+    });
+    run_case("order_stats.size", window, [os](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_order_stats_size(os));
+    });
+    run_case("order_stats.clear_refill", window, [os, &samples](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_order_stats_clear(os);
+            for (double v : samples) macac_order_stats_push(os, v);
+        }
+    });
+    
+    macac_order_stats_destroy(os);
+}
+
+static void bench_combat_scalar(void) {
+    std::vector<double> p = make_samples(1024, -64.0, 64.0, 43);
+    
+    run_case("combat.distance_3d", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 6) & 1017;
+            keep(macac_distance_3d(p[j], p[j + 1], p[j + 2], p[j + 3], p[j + 4], p[j + 5]));
+        }
+    });
+    run_case("combat.distance_horizontal", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 4) & 1019;
+            keep(macac_distance_horizontal(p[j], p[j + 1], p[j + 2], p[j + 3]));
+        }
+    });
+    run_case("combat.calc_yaw", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 2) & 1021;
+            keep(macac_calc_yaw(p[j], p[j + 1]));
+        }
+    });
+    run_case("combat.calc_pitch", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 3) & 1019;
+            keep(macac_calc_pitch(p[j], p[j + 1], p[j + 2]));
+        }
+    });
+    run_case("combat.calc_aim_angles", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 6) & 1017;
+            double yaw, pitch;
+            macac_calc_aim_angles(p[j], p[j + 1], p[j + 2], p[j + 3], p[j + 4], p[j + 5],
+                                  &yaw, &pitch);
+            keep(yaw);
+            keep(pitch);
+        }
+    });
+    run_case("combat.calc_aim_error", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 4) & 1019;
+            keep(macac_calc_aim_error(p[j], p[j + 1], p[j + 2], p[j + 3]));
+        }
+    });
+    run_case("combat.calc_snap_angle", 0, [&p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 4) & 1019;
+            keep(macac_calc_snap_angle(p[j], p[j + 1], p[j + 2], p[j + 3]));
+        }
+    });
+}
+
+/**
+ * 5000 entities spread over a 1000 x 1000 area and one 6-block reach
+ * query per player for 500 players, as on a busy survival world.
+ */
+static void bench_spatial(void) {
+    const size_t entities = 5000;
+    const size_t players = 500;
+    const size_t cap = 8;
+    std::vector<double> xz = make_samples(2 * entities, -500.0, 500.0, 53);
+    std::vector<double> ys = make_samples(entities, 60.0, 90.0, 54);
+    std::vector<double> look = make_samples(2 * players, -90.0, 90.0, 55);
+    
+    std::vector<macac_spatial_entry_t> entries(entities);
+    for (size_t i = 0; i < entities; i++) {
+        entries[i].id = (int64_t)i;
+        entries[i].x = xz[2 * i];
+        entries[i].y = ys[i];
+        entries[i].z = xz[2 * i + 1];
+    }
+    
+    // Players are the first entities, querying from eye height
+    std::vector<macac_spatial_query_t> queries(players);
+    for (size_t i = 0; i < players; i++) {
+        queries[i].x = entries[i].x;
+        queries[i].y = entries[i].y + 1.62;
+        queries[i].z = entries[i].z;
+        queries[i].yaw = 2.0 * look[2 * i];
+        queries[i].pitch = look[2 * i + 1];
+        queries[i].range = 6.0;
+        queries[i].half_angle = 30.0;
+        queries[i].exclude_id = entries[i].id;
+    }
+    
+    std::vector<int64_t> ids(players * cap);
+    std::vector<double> dist(players * cap);
+    std::vector<uint32_t> counts(players);
+    
+    macac_spatial_t* index = macac_spatial_create(entities, 0.0);
+    if (!index) {
+        return;
+    }
+    
+    run_case("spatial.update_5000", 0, [index, &entries](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_spatial_update(index, entries.data(), entries.size()));
+        }
+    });
+    macac_spatial_update(index, entries.data(), entries.size());
+    
+    run_case("spatial.query_radius_500", 0, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_spatial_query_radius(index, queries.data(), players, cap,
+                                            ids.data(), dist.data(), counts.data()));
+        }
+    });
+    run_case("spatial.query_cone_500", 0, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_spatial_query_cone(index, queries.data(), players, cap,
+                                          ids.data(), dist.data(), counts.data()));
+        }
+    });
+    
+    // Baseline: the same radius test against every entity per player
+    run_case("spatial.linear_radius_500", 0, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t found = 0;
+            for (size_t p = 0; p < players; p++) {
+                const macac_spatial_query_t& q = queries[p];
+                for (size_t k = 0; k < entities; k++) {
+                    double dx = entries[k].x - q.x;
+                    double dy = entries[k].y - q.y;
+                    double dz = entries[k].z - q.z;
+                    found += dx * dx + dy * dy + dz * dz <= q.range * q.range && entries[k].id != q.exclude_id;
+                }
+            }
+            keep(found);
+        }
+    });
+    
+    macac_spatial_destroy(index);
+}
+
+/**
+ * 500 tracked entities with a full second (20 ticks) of history each.
+ */
+static void bench_poshist(void) {
+    const size_t entities = 500;
+    const size_t window = 20;
+    const int64_t tick = 50000000;
+    std::vector<double> pos = make_samples(3 * entities, -200.0, 200.0, 57);
+    
+    std::vector<macac_position_sample_t> samples(entities);
+    std::vector<int64_t> ids(entities);
+    for (size_t i = 0; i < entities; i++) {
+        samples[i] = { (int64_t)i, 0, pos[3 * i], 64.0 + pos[3 * i + 1] * 0.05, pos[3 * i + 2], 0.6f, 1.8f };
+        ids[i] = (int64_t)i;
+    }
+    
+    macac_position_history_t* hist = macac_poshist_create(entities, window);
+    if (!hist) {
+        return;
+    }
+    int64_t now = 0;
+    for (size_t t = 0; t < window; t++) {
+        now += tick;
+        for (macac_position_sample_t& s : samples) {
+            s.nano_time = now;
+            s.x += 0.2;
+        }
+        macac_poshist_record(hist, samples.data(), entities);
+    }
+    
+    // Appends one tick; every lookup stays within the same 20-tick span
+    run_case("poshist.record_500", 0, [hist, &samples, &now, tick](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            now += tick;
+            for (macac_position_sample_t& s : samples) {
+                s.nano_time = now;
+            }
+            keep(macac_poshist_record(hist, samples.data(), samples.size()));
+        }
+    });
+    
+    std::vector<macac_position_sample_t> out(entities);
+    run_case("poshist.reach", 0, [hist, &now, tick](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_poshist_reach(hist, (int64_t)(i % 500), now - 3 * tick - 12345678,
+                                     1.0, 65.62, 1.0));
+        }
+    });
+    run_case("poshist.rewind_500", 0, [hist, &ids, &out, &now, tick](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_poshist_rewind(hist, ids.data(), ids.size(), now - 3 * tick - 12345678, out.data()));
+        }
+    });
+    
+    macac_poshist_destroy(hist);
+}
+
+static void bench_population(void) {
+    const size_t metrics = 4;
+    const size_t workers = 4;
+    std::vector<double> samples = make_samples(4096, 0.0, 1.0, 61);
+    
+    macac_population_t* p = macac_population_create(metrics, 0, 0);
+    if (!p) {
+        return;
+    }
+    
+    // One row per analysed movement, from the benchmark thread's shard
+    run_case("population.add_row", 0, [p, &samples](uint64_t n) {
+        double row[4];
+        for (uint64_t i = 0; i < n; i++) {
+            size_t j = (i * 4) & 4095;
+            row[0] = samples[j];
+            row[1] = samples[j + 1] * 30.0;
+            row[2] = samples[j + 2] * 0.1;
+            row[3] = samples[j + 3] * samples[j + 3];
+            macac_population_add_row(p, row);
+        }
+    });
+    
+    // Fill the shards of a few worker threads, as on a busy server
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; w++) {
+        threads.emplace_back([p, &samples, w] {
+            for (size_t i = 0; i < 200000; i++) {
+                double v = samples[(i * 7 + w) & 4095];
+                double row[4] = { v, v * 30.0, v * 0.1, v * v };
+                macac_population_add_row(p, row);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    
+    run_case("population.refresh", 0, [p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) macac_population_refresh(p);
+    });
+    run_case("population.quantile", 0, [p](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_population_quantile(p, i & 3, 0.999));
+    });
+    run_case("population.cdf", 0, [p, &samples](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_population_cdf(p, 0, samples[i & 4095]));
+    });
+    
+    macac_population_destroy(p);
+}
+
+/**
+ * Combat columns for one player: aim errors, snaps, reaches, intervals, hits.
+ */
+struct combat_columns {
+    std::vector<double> columns[MACAC_COMBAT_BATCH_COLUMNS];
+};
+
+static combat_columns make_combat(size_t window, uint32_t seed) {
+    combat_columns c;
+    c.columns[0] = make_samples(window, 0.0, 15.0, seed);
+    c.columns[1] = make_samples(window, 0.0, 90.0, seed + 1);
+    c.columns[2] = make_samples(window, 2.0, 3.5, seed + 2);
+    c.columns[3] = make_samples(window, 50.0, 150.0, seed + 3);
+    c.columns[4] = make_samples(window, 0.0, 1.0, seed + 4);
+    for (double& h : c.columns[4]) {
+        h = h < 0.7 ? 1.0 : 0.0;
+    }
+    return c;
+}
+
+static void bench_combat(size_t window) {
+    combat_columns c = make_combat(window, 47);
+    
+    run_case("combat.analyze_combat", window, [&c, window](uint64_t n) {
+        macac_combat_analysis_t result;
+        for (uint64_t i = 0; i < n; i++) {
+            macac_analyze_combat(c.columns[0].data(), c.columns[1].data(), c.columns[2].data(),
+                                 c.columns[3].data(), c.columns[4].data(), window, &result);
+            keep(result.combined_confidence);
+        }
+    });
+    
+    // 64 players per call; ns/op is per call, not per player
+    const size_t players = 64;
+    size_t stride = MACAC_COMBAT_BATCH_STRIDE(window);
+    std::vector<double> packed(players * stride, 0.0);
+    for (size_t p = 0; p < players; p++) {
+        double* record = &packed[p * stride];
+        record[0] = (double)window;
+        for (size_t col = 0; col < MACAC_COMBAT_BATCH_COLUMNS; col++) {
+            std::copy(c.columns[col].begin(), c.columns[col].end(),
+                      record + MACAC_COMBAT_BATCH_HEADER + col * window);
+        }
+    }
+    std::vector<macac_combat_analysis_t> out(players);
+    
+    run_case("combat.analyze_combat_batch64", window, [&packed, &out, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_analyze_combat_batch(packed.data(), out.size(), window, out.data()));
+        }
+    });
+    
+    // Steady state: the window is full, so each push also evicts a sample
+    macac_combat_accum_t* acc = macac_combat_accum_create(window);
+    for (size_t i = 0; i < window; i++) {
+        for (int col = 0; col < MACAC_COMBAT_BATCH_COLUMNS; col++) {
+            macac_combat_accum_push(acc, col, c.columns[col][i]);
+        }
+    }
+    
+    run_case("combat.accum_push", window, [&c, acc, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            size_t at = (size_t)(i % window);
+            for (int col = 0; col < MACAC_COMBAT_BATCH_COLUMNS; col++) {
+                macac_combat_accum_push(acc, col, c.columns[col][at]);
+            }
+        }
+        keep(macac_combat_accum_size(acc, 0));
+    });
+    run_case("combat.accum_analyze", window, [acc](uint64_t n) {
+        macac_combat_analysis_t result;
+        for (uint64_t i = 0; i < n; i++) {
+            macac_combat_accum_analyze(acc, &result);
+            keep(result.combined_confidence);
+        }
+    });
+    
+    macac_combat_accum_destroy(acc);
+}
+
+static void bench_network(loopback_sink* sink) {
+    const char* uuid = "123e4567-e89b-12d3-a456-426614174000";
+    
+    run_case("net.connect_close", 0, [sink](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_connection_t* conn = macac_net_connect("127.0.0.1", sink->port);
+            keep(conn);
+            macac_net_close(conn);
+        }
+    });
+    
+    macac_connection_t* conn = macac_net_connect("127.0.0.1", sink->port);
+    if (conn) {
+        run_case("net.is_connected", 0, [conn](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(macac_net_is_connected(conn));
+        });
+        run_case("net.send_violation", 0, [conn, uuid](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_net_send_violation(conn, uuid, "combat.aim", 0.9, 0.5, (int64_t)i));
+            }
+        });
+        macac_net_close(conn);
+    }
+    
+    run_case("sender.create_destroy", 0, [sink](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            macac_sender_t* s = macac_sender_create("127.0.0.1", sink->port, 1024, 1000, 100,
+                                                    MACAC_WIRE_JSON);
+            keep(s);
+            macac_sender_destroy(s);
+        }
+    });
+    
+    macac_sender_t* sender = macac_sender_create("127.0.0.1", sink->port, 65536, 1000, 100,
+                                                 MACAC_WIRE_JSON);
+    if (!sender) {
+        return;
+    }
+    
+    // Enqueue cost only; the I/O thread drains concurrently
+    run_case("sender.send_violation", 0, [sender, uuid](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_sender_send_violation(sender, uuid, "combat.aim", 0.9, 0.5, (int64_t)i));
+        }
+        macac_sender_flush(sender, 1000);
+    });
+    const char raw[] = "{\"type\":\"heartbeat\"}\n";
+    run_case("sender.send_raw", 0, [sender, &raw](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_sender_send_raw(sender, raw, sizeof(raw) - 1));
+        }
+        macac_sender_flush(sender, 1000);
+    });
+    run_case("sender.flush_idle", 0, [sender](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) keep(macac_sender_flush(sender, 0));
+    });
+    run_case("sender.get_stats", 0, [sender](uint64_t n) {
+        macac_sender_stats_t stats;
+        for (uint64_t i = 0; i < n; i++) {
+            macac_sender_get_stats(sender, &stats);
+            keep(stats.enqueued);
+        }
+    });
+    
+    // Coalescing in front of the same sender: one hot key, then 256 keys
+    // (64 players x 4 categories); flush_count bounds each record
+    macac_coalescer_t* coalescer = macac_coalescer_create(sender, 4096, 1000, 64);
+    if (coalescer) {
+        run_case("coalescer.add_hot", 0, [coalescer, uuid](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_coalescer_add(coalescer, uuid, "combat.aim", 0.9, 0.5, (int64_t)i));
+            }
+            macac_coalescer_flush(coalescer);
+        });
+        char players[64][37];
+        for (int i = 0; i < 64; i++) {
+            snprintf(players[i], sizeof(players[i]), "%08x-0000-4000-8000-0000000000%02x", 0x1000 * i, i);
+        }
+        const char* categories[4] = { "combat.aim", "combat.reach", "movement.speed", "movement.fly" };
+        run_case("coalescer.add_spread", 0, [coalescer, &players, &categories](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                keep(macac_coalescer_add(coalescer, players[i & 63], categories[(i >> 6) & 3],
+                                         0.9, 0.5, (int64_t)i));
+            }
+            macac_coalescer_flush(coalescer);
+        });
+        run_case("coalescer.get_stats", 0, [coalescer](uint64_t n) {
+            macac_coalescer_stats_t stats;
+            for (uint64_t i = 0; i < n; i++) {
+                macac_coalescer_get_stats(coalescer, &stats);
+                keep(stats.accepted);
+            }
+        });
+        macac_coalescer_destroy(coalescer);
+        macac_sender_flush(sender, 1000);
+    }
+    
+    macac_sender_destroy(sender);
+    
+    // Two connections to the same sink: routing cost with sharding across the pool
+    char endpoints[64];
+    snprintf(endpoints, sizeof(endpoints), "127.0.0.1:%d,127.0.0.1:%d", sink->port, sink->port);
+    macac_sender_t* pool = macac_sender_create_pool(endpoints, sink->port, 65536, 1000, 100,
+                                                    MACAC_WIRE_JSON);
+    if (!pool) {
+        return;
+    }
+    char uuids[16][37];
+    for (int i = 0; i < 16; i++) {
+        snprintf(uuids[i], sizeof(uuids[i]), "%08x-0000-4000-8000-0000000000%02x", 0x1000 * i, i);
+    }
+    run_case("sender.pool_send_violation", 0, [pool, &uuids](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_sender_send_violation(pool, uuids[i & 15], "combat.aim", 0.9, 0.5, (int64_t)i));
+        }
+        macac_sender_flush(pool, 1000);
+    });
+    run_case("sender.pool_get_endpoint_stats", 0, [pool](uint64_t n) {
+        macac_sender_endpoint_stats_t stats;
+        for (uint64_t i = 0; i < n; i++) {
+            keep(macac_sender_get_endpoint_stats(pool, (int)(i & 1), &stats));
+        }
+    });
+    
+    macac_sender_destroy(pool);
+    
+    // Outage: nothing listens on port 1, so every record is appended to the
+    // spill log; the case waits for the I/O thread, so the figure is spill
+    // throughput (the budget leaves room for well over a million records)
+    char dir[] = "/tmp/macac_bench_spill_XXXXXX";
+    if (!mkdtemp(dir)) {
+        return;
+    }
+    macac_spill_config_t spill = { dir, 0, (size_t)512 << 20, 0 };
+    macac_sender_t* spilling = macac_sender_create_spill("127.0.0.1:1", 1, 65536, 1000, 60000,
+                                                         MACAC_WIRE_JSON, &spill);
+    if (spilling) {
+        uint64_t spilled = 0;
+        run_case("sender.spill_send_violation", 0, [spilling, uuid, &spilled](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                while (macac_sender_send_violation(spilling, uuid, "combat.aim", 0.9, 0.5, (int64_t)i) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+            spilled += n;
+            macac_sender_stats_t stats;
+            do {
+                std::this_thread::yield();
+                macac_sender_get_stats(spilling, &stats);
+            } while (stats.spilled < spilled);
+        });
+        macac_sender_destroy(spilling);
+    }
+    
+    if (DIR* d = opendir(dir)) {
+        while (struct dirent* entry = readdir(d)) {
+            if (entry->d_name[0] != '.') {
+                unlink((std::string(dir) + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir);
+}
+
+/**
+ * Bridge entry points next to their direct C counterparts above
+ * (same case name with the "jni." prefix).
+ */
+static void bench_jni(size_t window, loopback_sink* sink) {
+    JNIEnv* env = fake_jni_env();
+    jclass clazz = nullptr;
+    
+    std::vector<double> samples = make_samples(window, 0.0, 100.0, 53);
+    fake_array data = { (jsize)window, samples.data() };
+    jdoubleArray jdata = reinterpret_cast<jdoubleArray>(&data);
+    
+    run_case("jni.simdSum", window, [env, clazz, jdata](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_simdSum(env, clazz, jdata));
+        }
+    });
+    run_case("jni.median", window, [env, clazz, jdata](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_median(env, clazz, jdata));
+        }
+    });
+    
+    // Off-heap RollingWindow path: the bridge reads the buffer in place
+    fake_buffer direct = { samples.data(), (jlong)(window * sizeof(double)) };
+    jobject jdirect = reinterpret_cast<jobject>(&direct);
+    run_case("jni.simdMeanDirect", window, [env, clazz, jdirect, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_simdMeanDirect(env, clazz, jdirect, (jint)window));
+        }
+    });
+    run_case("jni.simdVarianceDirect", window, [env, clazz, jdirect, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_simdVarianceDirect(
+                env, clazz, jdirect, (jint)window));
+        }
+    });
+    double described[8];
+    fake_array described_array = { 8, described };
+    jdoubleArray jdescribed = reinterpret_cast<jdoubleArray>(&described_array);
+    run_case("jni.simdDescribeDirect", window, [env, clazz, jdirect, jdescribed, window, &described](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            Java_com_macmoment_macac_util_NativeHelper_simdDescribeDirect(
+                env, clazz, jdirect, (jint)window, jdescribed);
+            keep(described[3]);
+        }
+    });
+    run_case("jni.medianDirect", window, [env, clazz, jdirect, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_medianDirect(env, clazz, jdirect, (jint)window));
+        }
+    });
+    
+    combat_columns c = make_combat(window, 59);
+    fake_array cols[MACAC_COMBAT_BATCH_COLUMNS];
+    jdoubleArray jcols[MACAC_COMBAT_BATCH_COLUMNS];
+    for (size_t col = 0; col < MACAC_COMBAT_BATCH_COLUMNS; col++) {
+        cols[col] = { (jsize)window, c.columns[col].data() };
+        jcols[col] = reinterpret_cast<jdoubleArray>(&cols[col]);
+    }
+    run_case("jni.analyzeCombat", window, [env, clazz, &jcols](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_analyzeCombat(
+                env, clazz, jcols[0], jcols[1], jcols[2], jcols[3], jcols[4]));
+        }
+    });
+    
+    const size_t players = 64;
+    size_t stride = MACAC_COMBAT_BATCH_STRIDE(window);
+    std::vector<double> packed(players * stride, 0.0);
+    for (size_t p = 0; p < players; p++) {
+        double* record = &packed[p * stride];
+        record[0] = (double)window;
+        for (size_t col = 0; col < MACAC_COMBAT_BATCH_COLUMNS; col++) {
+            std::copy(c.columns[col].begin(), c.columns[col].end(),
+                      record + MACAC_COMBAT_BATCH_HEADER + col * window);
+        }
+    }
+    std::vector<macac_combat_analysis_t> out(players);
+    fake_buffer in_buf = { packed.data(), (jlong)(packed.size() * sizeof(double)) };
+    fake_buffer out_buf = { out.data(), (jlong)(out.size() * sizeof(macac_combat_analysis_t)) };
+    jobject jin = reinterpret_cast<jobject>(&in_buf);
+    jobject jout = reinterpret_cast<jobject>(&out_buf);
+    run_case("jni.analyzeCombatBatch64", window, [env, clazz, jin, jout, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_analyzeCombatBatch(
+                env, clazz, jin, (jint)players, (jint)window, jout));
+        }
+    });
+    
+    std::vector<float> soa((size_t)window * 7);
+    for (size_t i = 0; i < soa.size(); i++) {
+        soa[i] = (float)samples[i % window];
+    }
+    fake_buffer soa_in = { soa.data(), (jlong)(window * 6 * sizeof(float)) };
+    fake_buffer soa_out = { soa.data() + window * 6, (jlong)(window * sizeof(float)) };
+    jobject jsoa_in = reinterpret_cast<jobject>(&soa_in);
+    jobject jsoa_out = reinterpret_cast<jobject>(&soa_out);
+    run_case("jni.batchDistance3DF32", window, [env, clazz, jsoa_in, jsoa_out, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_batchDistance3DF32(
+                env, clazz, jsoa_in, (jint)window, jsoa_out));
+        }
+    });
+    
+    std::vector<double> aim((size_t)window * 6);
+    for (size_t i = 0; i < window * 3; i++) {
+        aim[i] = samples[i % window] * 8.0;
+    }
+    fake_buffer aim_in = { aim.data(), (jlong)(window * 3 * sizeof(double)) };
+    fake_buffer aim_out = { aim.data() + window * 3, (jlong)(window * 3 * sizeof(double)) };
+    jobject jaim_in = reinterpret_cast<jobject>(&aim_in);
+    jobject jaim_out = reinterpret_cast<jobject>(&aim_out);
+    run_case("jni.batchAimError", window, [env, clazz, jaim_in, jaim_out, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_batchAimError(
+                env, clazz, 0.5, 64.0, -0.5, 37.0, 12.0, jaim_in, (jint)window, jaim_out));
+        }
+    });
+    
+    // window players through one movement step
+    std::vector<double> move((size_t)window * (MACAC_MOVE_INPUT_COLUMNS + MACAC_MOVE_OUTPUT_COLUMNS));
+    for (size_t i = 0; i < window * MACAC_MOVE_INPUT_COLUMNS; i++) {
+        move[i] = samples[i % window] / 16.0;
+    }
+    fake_buffer move_in = { move.data(), (jlong)(window * MACAC_MOVE_INPUT_COLUMNS * sizeof(double)) };
+    fake_buffer move_out = { move.data() + window * MACAC_MOVE_INPUT_COLUMNS,
+                             (jlong)(window * MACAC_MOVE_OUTPUT_COLUMNS * sizeof(double)) };
+    jobject jmove_in = reinterpret_cast<jobject>(&move_in);
+    jobject jmove_out = reinterpret_cast<jobject>(&move_out);
+    run_case("jni.predictMovementBatch", window, [env, clazz, jmove_in, jmove_out, window](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_predictMovementBatch(
+                env, clazz, jmove_in, (jint)window, (jint)window, jmove_out));
+        }
+    });
+    
+    macac_ringbuffer_t* rb = macac_ringbuffer_create_tracked(window);
+    jlong rb_handle = (jlong)(intptr_t)rb;
+    run_case("jni.ringBufferPush", window, [env, clazz, rb_handle, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            Java_com_macmoment_macac_util_NativeHelper_ringBufferPush(
+                env, clazz, rb_handle, samples[i & mask]);
+        }
+    });
+    run_case("jni.ringBufferMean", window, [env, clazz, rb_handle](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_ringBufferMean(env, clazz, rb_handle));
+        }
+    });
+    macac_ringbuffer_destroy(rb);
+    
+    macac_packet_queue_t* queue = macac_queue_create(window, MACAC_QUEUE_MPSC);
+    jlong queue_handle = (jlong)(intptr_t)queue;
+    std::vector<macac_telemetry_record_t> records(window);
+    fake_buffer queue_buf = { records.data(), (jlong)(window * sizeof(macac_telemetry_record_t)) };
+    jobject jqueue_out = reinterpret_cast<jobject>(&queue_buf);
+    run_case("jni.packetQueuePush", window,
+             [env, clazz, queue_handle, jqueue_out, window, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            double v = samples[i & mask];
+            if (Java_com_macmoment_macac_util_NativeHelper_packetQueuePush(
+                    env, clazz, queue_handle, 7, MACAC_TELEMETRY_ON_GROUND, v, 0.0, v,
+                    90.0f, 10.0f, 1.5f, 0.5f, 50, (jlong)i, 50000000) != 0) {
+                keep(Java_com_macmoment_macac_util_NativeHelper_packetQueueDrain(
+                    env, clazz, queue_handle, jqueue_out, (jint)window));
+            }
+        }
+    });
+    macac_queue_destroy(queue);
+    
+    macac_order_stats_t* os = macac_order_stats_create(window);
+    jlong os_handle = (jlong)(intptr_t)os;
+    run_case("jni.orderStatsPush", window, [env, clazz, os_handle, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            Java_com_macmoment_macac_util_NativeHelper_orderStatsPush(
+                env, clazz, os_handle, samples[(i * 7) & mask]);
+        }
+    });
+    macac_order_stats_destroy(os);
+    
+    macac_history_slab_t* slab = macac_slab_create(64, 4, window);
+    int64_t slot = macac_slab_acquire(slab);
+    jlong slab_handle = (jlong)(intptr_t)slab;
+    run_case("jni.slabPush", window, [env, clazz, slab_handle, slot, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            Java_com_macmoment_macac_util_NativeHelper_slabPush(
+                env, clazz, slab_handle, (jlong)slot, (jint)(i & 3), samples[i & mask]);
+        }
+    });
+    macac_slab_destroy(slab);
+    
+    // Window-independent entry points run once
+    if (window != options.windows.front()) {
+        return;
+    }
+    
+    run_case("jni.nanoTime", 0, [env, clazz](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_nanoTime(env, clazz));
+        }
+    });
+    
+    // One begin/end pair, as wrapped around each pipeline stage
+    int perf_site = macac_perf_register("bench.jni");
+    run_case("jni.perfBeginEnd", 0, [env, clazz, perf_site](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            jlong begin = Java_com_macmoment_macac_util_NativeHelper_perfBegin(env, clazz);
+            Java_com_macmoment_macac_util_NativeHelper_perfEnd(env, clazz, perf_site, begin);
+        }
+    });
+    run_case("jni.distance3D", 0, [env, clazz, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_distance3D(
+                env, clazz, samples[i & mask], 64.0, 0.0, 1.0, 65.0, 2.0));
+        }
+    });
+    run_case("jni.calcAimAngles", 0, [env, clazz, &samples](uint64_t n) {
+        size_t mask = samples.size() - 1;
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_calcAimAngles(
+                env, clazz, samples[i & mask], 64.0, 0.0, 1.0, 65.0, 2.0));
+        }
+    });
+    
+    if (!sink) {
+        return;
+    }
+    macac_sender_t* sender = macac_sender_create("127.0.0.1", sink->port, 65536, 1000, 100,
+                                                 MACAC_WIRE_JSON);
+    if (!sender) {
+        return;
+    }
+    const char uuid_text[] = "123e4567-e89b-12d3-a456-426614174000";
+    const char category_text[] = "combat.aim";
+    fake_string uuid = { uuid_text, sizeof(uuid_text) - 1 };
+    fake_string category = { category_text, sizeof(category_text) - 1 };
+    jstring juuid = reinterpret_cast<jstring>(&uuid);
+    jstring jcategory = reinterpret_cast<jstring>(&category);
+    jlong sender_handle = (jlong)(intptr_t)sender;
+    run_case("jni.senderSendViolation", 0,
+             [env, clazz, sender, sender_handle, juuid, jcategory](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            keep(Java_com_macmoment_macac_util_NativeHelper_senderSendViolation(
+                env, clazz, sender_handle, juuid, jcategory, 0.9, 0.5, (jlong)i));
+        }
+        macac_sender_flush(sender, 1000);
+    });
+    macac_sender_destroy(sender);
+}
+
+// ============================================================================
+// Output and Baseline Comparison
+// ============================================================================
+
+static void write_csv(FILE* out) {
+    fprintf(out, "name,isa,window,iterations,ns_per_op,ns_min,ticks_per_op\n");
+    for (const bench_result& r : results) {
+        fprintf(out, "%s,%s,%zu,%llu,%.3f,%.3f,%.2f\n",
+                r.name.c_str(), r.isa.c_str(), r.window, (unsigned long long)r.iterations,
+                r.ns_per_op, r.ns_min, r.ticks_per_op);
+    }
+}
+
+static void write_json(FILE* out) {
+    double ns_per_tick = macac_calibrate_tsc();
+    
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"macac_native_bench\",\n");
+    fprintf(out, "  \"version\": \"%s\",\n", MACAC_BENCH_VERSION);
+    fprintf(out, "  \"best_isa\": \"%s\",\n", macac_cpu_isa_name(macac_cpu_best_isa()));
+    fprintf(out, "  \"tsc_ghz\": %.4f,\n", ns_per_tick > 0.0 ? 1.0 / ns_per_tick : 0.0);
+    fprintf(out, "  \"tsc_source\": %d,\n", macac_tsc_source());
+    fprintf(out, "  \"tsc_invariant\": %d,\n", macac_tsc_invariant());
+    fprintf(out, "  \"min_time_ms\": %.1f,\n", options.min_time_ms);
+    fprintf(out, "  \"repeats\": %d,\n", options.repeats);
+    fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_result& r = results[i];
+        fprintf(out,
+                "    {\"name\": \"%s\", \"isa\": \"%s\", \"window\": %zu, \"iterations\": %llu, "
+                "\"ns_per_op\": %.3f, \"ns_min\": %.3f, \"ticks_per_op\": %.2f}%s\n",
+                r.name.c_str(), r.isa.c_str(), r.window, (unsigned long long)r.iterations,
+                r.ns_per_op, r.ns_min, r.ticks_per_op, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static std::string result_key(const std::string& name, const std::string& isa, size_t window) {
+    return name + "|" + isa + "|" + std::to_string(window);
+}
+
+/**
+ * Compare against a CSV written by --format csv.
+ * Returns the number of regressions, or -1 if the baseline is unreadable.
+ */
+static int compare_baseline(const std::string& path) {
+    FILE* in = fopen(path.c_str(), "r");
+    if (!in) {
+        fprintf(stderr, "cannot open baseline %s\n", path.c_str());
+        return -1;
+    }
+    
+    std::map<std::string, double> baseline;
+    char line[512];
+    while (fgets(line, sizeof(line), in)) {
+        char name[160], isa[32];
+        size_t window;
+        unsigned long long iterations;
+        double ns_per_op;
+        if (sscanf(line, "%159[^,],%31[^,],%zu,%llu,%lf", name, isa, &window, &iterations,
+                   &ns_per_op) == 5) {
+            baseline[result_key(name, isa, window)] = ns_per_op;
+        }
+    }
+    fclose(in);
+    
+    int regressions = 0;
+    int compared = 0;
+    double limit = 1.0 + options.tolerance_pct / 100.0;
+    for (const bench_result& r : results) {
+        auto it = baseline.find(result_key(r.name, r.isa, r.window));
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+        compared++;
+        double ratio = r.ns_per_op / it->second;
+        if (ratio > limit) {
+            regressions++;
+            fprintf(stderr, "REGRESSION %s [%s, window %zu]: %.3f -> %.3f ns/op (%+.1f%%)\n",
+                    r.name.c_str(), r.isa.c_str(), r.window, it->second, r.ns_per_op,
+                    (ratio - 1.0) * 100.0);
+        }
+    }
+    
+    fprintf(stderr, "compared %d cases against %s: %d regression(s) over %.1f%%\n",
+            compared, path.c_str(), regressions, options.tolerance_pct);
+    return regressions;
+}
+
+// ============================================================================
+// Entry Point
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--format json|csv] [--out FILE] [--filter SUBSTR]\n"
+            "          [--windows N,N,...] [--min-time-ms MS] [--repeat N]\n"
+            "          [--compare BASELINE.csv] [--tolerance PCT]\n",
+            argv0);
+}
+
+static bool parse_windows(const char* text) {
+    std::vector<size_t> windows;
+    const char* p = text;
+    while (*p) {
+        char* end;
+        unsigned long value = strtoul(p, &end, 10);
+        
+        // Kernels index windows with a mask, so require powers of two
+        if (end == p || value == 0 || (value & (value - 1)) != 0) {
+            return false;
+        }
+        windows.push_back((size_t)value);
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') {
+            return false;
+        }
+    }
+    if (windows.empty()) {
+        return false;
+    }
+    options.windows = windows;
+    return true;
+}
+
+static bool parse_args(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+        
+        if (arg == "--format") {
+            options.format = value;
+            if (options.format != "json" && options.format != "csv") {
+                return false;
+            }
+        } else if (arg == "--out") {
+            options.out_path = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--windows") {
+            if (!parse_windows(value)) {
+                fprintf(stderr, "--windows expects comma-separated powers of two\n");
+                return false;
+            }
+        } else if (arg == "--min-time-ms") {
+            options.min_time_ms = atof(value);
+            if (options.min_time_ms <= 0.0) {
+                return false;
+            }
+        } else if (arg == "--repeat") {
+            options.repeats = atoi(value);
+            if (options.repeats <= 0) {
+                return false;
+            }
+        } else if (arg == "--compare") {
+            options.compare_path = value;
+        } else if (arg == "--tolerance") {
+            options.tolerance_pct = atof(value);
+            if (options.tolerance_pct < 0.0) {
+                return false;
+            }
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    macac_cpu_init();
+    fprintf(stderr, "macac_native_bench %s (best ISA: %s)\n",
+            MACAC_BENCH_VERSION, macac_cpu_isa_name(macac_cpu_best_isa()));
+    
+    loopback_sink sink;
+    bool have_sink = sink_start(&sink);
+    if (!have_sink) {
+        fprintf(stderr, "loopback sink unavailable, skipping network cases\n");
+    }
+    
+    bench_timing();
+    bench_perf();
+    bench_cpu();
+    bench_capture();
+    bench_combat_scalar();
+    bench_spatial();
+    bench_poshist();
+    bench_population();
+    if (have_sink) {
+        bench_network(&sink);
+    }
+    for (size_t window : options.windows) {
+        bench_ringbuffer(window);
+        bench_queue(window);
+        bench_slab(window);
+        bench_dispatched(window);
+        bench_order(window);
+        bench_combat(window);
+        bench_jni(window, have_sink ? &sink : nullptr);
+    }
+    
+    sink_stop(&sink);
+    
+    FILE* out = stdout;
+    if (!options.out_path.empty()) {
+        out = fopen(options.out_path.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", options.out_path.c_str());
+            return 1;
+        }
+    }
+    if (options.format == "csv") {
+        write_csv(out);
+    } else {
+        write_json(out);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    
+    if (!options.compare_path.empty()) {
+        int regressions = compare_baseline(options.compare_path);
+        if (regressions < 0) {
+            return 1;
+        }
+        if (regressions > 0) {
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * MacAC Native Library - Fixed-Capacity Ring Buffers (C++ only)
+ * 
+ * Header-only ring buffer with the capacity N as a template parameter:
+ * storage is held inline, N must be a power of two so wrap-around is a
+ * mask instead of a division, and full-window reductions are unrolled at
+ * compile time into MACAC_FIXED_LANES independent accumulators.
+ * N below MACAC_FIXED_LANES is not supported.
+ * 
+ * The C API (macac_ringbuffer_*) dispatches to the same masked indexing
+ * and min/max reductions for capacities 8 through 256; use this header
+ * directly when the window size is known at compile time and the buffer
+ * can live inside another object.
+ */
+
+#ifndef MACAC_FIXED_RING_H
+#define MACAC_FIXED_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+// Independent partial sums per reduction: lane l takes elements l, l + 8, ...
+// so a baseline SSE2 build keeps four vector accumulators in flight
+#define MACAC_FIXED_LANES 8
+
+// ============================================================================
+// Unrolled Reductions
+// ============================================================================
+//
+// Trip counts are compile-time constants, so each reduction compiles to
+// straight-line vector code with no loop control or remainder handling.
+// The lane layout (and so the rounding) is the same for every N.
+
+/**
+ * Pairwise fold of the lane accumulators.
+ */
+static inline double macac_fixed_fold(const double* acc) {
+    return ((acc[0] + acc[4]) + (acc[2] + acc[6])) + ((acc[1] + acc[5]) + (acc[3] + acc[7]));
+}
+
+/**
+ * Sum of exactly N values, accumulated in double.
+ */
+template <size_t N, typename T>
+static inline double macac_fixed_sum(const T* p) {
+    static_assert(N % MACAC_FIXED_LANES == 0, "N must be a multiple of the lane count");
+    double acc[MACAC_FIXED_LANES] = {};
+    for (size_t i = 0; i < N; i += MACAC_FIXED_LANES) {
+        for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+            acc[l] += (double)p[i + l];
+        }
+    }
+    return macac_fixed_fold(acc);
+}
+
+/**
+ * Sum of squared deviations from mean over exactly N values.
+ */
+template <size_t N, typename T>
+static inline double macac_fixed_sum_sq_dev(const T* p, double mean) {
+    static_assert(N % MACAC_FIXED_LANES == 0, "N must be a multiple of the lane count");
+    double acc[MACAC_FIXED_LANES] = {};
+    for (size_t i = 0; i < N; i += MACAC_FIXED_LANES) {
+        for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+            double d = (double)p[i + l] - mean;
+            acc[l] += d * d;
+        }
+    }
+    return macac_fixed_fold(acc);
+}
+
+/**
+ * Minimum of exactly N values. NaNs are skipped unless p[0] is NaN.
+ */
+template <size_t N, typename T>
+static inline T macac_fixed_min(const T* p) {
+    static_assert(N % MACAC_FIXED_LANES == 0, "N must be a multiple of the lane count");
+    T acc[MACAC_FIXED_LANES];
+    for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+        acc[l] = p[0];
+    }
+    for (size_t i = 0; i < N; i += MACAC_FIXED_LANES) {
+        for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+            acc[l] = p[i + l] < acc[l] ? p[i + l] : acc[l];
+        }
+    }
+    T m = acc[0];
+    for (size_t l = 1; l < MACAC_FIXED_LANES; l++) {
+        m = acc[l] < m ? acc[l] : m;
+    }
+    return m;
+}
+
+/**
+ * Maximum of exactly N values. NaNs are skipped unless p[0] is NaN.
+ */
+template <size_t N, typename T>
+static inline T macac_fixed_max(const T* p) {
+    static_assert(N % MACAC_FIXED_LANES == 0, "N must be a multiple of the lane count");
+    T acc[MACAC_FIXED_LANES];
+    for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+        acc[l] = p[0];
+    }
+    for (size_t i = 0; i < N; i += MACAC_FIXED_LANES) {
+        for (size_t l = 0; l < MACAC_FIXED_LANES; l++) {
+            acc[l] = p[i + l] > acc[l] ? p[i + l] : acc[l];
+        }
+    }
+    T m = acc[0];
+    for (size_t l = 1; l < MACAC_FIXED_LANES; l++) {
+        m = acc[l] > m ? acc[l] : m;
+    }
+    return m;
+}
+
+// ============================================================================
+// Fixed-Capacity Ring Buffer
+// ============================================================================
+
+/**
+ * Ring buffer of the last N samples with inline, cache-line aligned storage.
+ * 
+ * Statistics scan the window: unrolled over all N slots once the buffer is
+ * full, a plain loop while it fills. Single writer, no internal locking.
+ */
+template <typename T, size_t N>
+struct macac_fixed_ring {
+    static_assert(N >= MACAC_FIXED_LANES && (N & (N - 1)) == 0, "capacity must be a power of two >= 8");
+    static_assert(std::is_arithmetic<T>::value, "ring holds numbers");
+    
+    static constexpr size_t capacity = N;
+    static constexpr size_t mask = N - 1;
+    
+    alignas(64) T data[N] = {};
+    uint64_t head = 0;          // Total pushes; data[head & mask] is written next
+    size_t count = 0;           // Valid samples, at most N
+    
+    void push(T value) {
+        data[head & mask] = value;
+        head++;
+        count += count < N;
+    }
+    
+    /**
+     * Sample at age (0 = most recent); age must be below size().
+     */
+    T get(size_t age) const {
+        return data[(head - 1 - age) & mask];
+    }
+    
+    size_t size() const { return count; }
+    bool full() const { return count == N; }
+    
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+    
+    // Until the first wrap the window is data[0..count); afterwards it is
+    // all of data, so data[0..count) is always the window in some order
+    
+    double sum() const {
+        if (count == N) {
+            return macac_fixed_sum<N>(data);
+        }
+        double s = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            s += (double)data[i];
+        }
+        return s;
+    }
+    
+    /**
+     * Mean of the window (0 if empty).
+     */
+    double mean() const {
+        return count > 0 ? sum() / (double)count : 0.0;
+    }
+    
+    /**
+     * Sample variance of the window, two-pass (0 if fewer than 2 samples).
+     */
+    double variance() const {
+        if (count < 2) {
+            return 0.0;
+        }
+        double m = mean();
+        if (count == N) {
+            return macac_fixed_sum_sq_dev<N>(data, m) / (double)(N - 1);
+        }
+        double m2 = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double d = (double)data[i] - m;
+            m2 += d * d;
+        }
+        return m2 / (double)(count - 1);
+    }
+    
+    /**
+     * Minimum of the window (NaN, or 0 for integer T, if empty).
+     */
+    T min() const {
+        if (count == 0) {
+            return empty_value();
+        }
+        if (count == N) {
+            return macac_fixed_min<N>(data);
+        }
+        T m = data[0];
+        for (size_t i = 1; i < count; i++) {
+            m = data[i] < m ? data[i] : m;
+        }
+        return m;
+    }
+    
+    /**
+     * Maximum of the window (NaN, or 0 for integer T, if empty).
+     */
+    T max() const {
+        if (count == 0) {
+            return empty_value();
+        }
+        if (count == N) {
+            return macac_fixed_max<N>(data);
+        }
+        T m = data[0];
+        for (size_t i = 1; i < count; i++) {
+            m = data[i] > m ? data[i] : m;
+        }
+        return m;
+    }
+
+private:
+    static T empty_value() {
+        if constexpr (std::is_floating_point<T>::value) {
+            return (T)std::nan("");
+        } else {
+            return T();
+        }
+    }
+};
+
+#endif // MACAC_FIXED_RING_H
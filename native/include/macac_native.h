@@ -24,8 +24,9 @@ extern "C" {
 // ============================================================================
 
 /**
- * Get high-precision monotonic timestamp in nanoseconds.
- * Uses RDTSCP on x86_64 for highest precision, falls back to clock_gettime.
+ * Get high-precision monotonic timestamp in nanoseconds (CLOCK_MONOTONIC base).
+ * Uses RDTSCP with a fixed-point conversion once the TSC is calibrated and
+ * invariant, falls back to clock_gettime otherwise.
  */
 int64_t macac_nanotime(void);
 
@@ -37,7 +38,8 @@ uint64_t macac_rdtscp(void);
 
 /**
  * Get TSC calibration factor (nanoseconds per TSC tick).
- * Must be called once during initialization.
+ * Calibrates on first call (thread-safe, idempotent); call once during
+ * initialization so macac_nanotime uses the TSC from then on.
  */
 double macac_calibrate_tsc(void);
 
@@ -46,116 +48,1293 @@ double macac_calibrate_tsc(void);
  */
 int64_t macac_tsc_to_nanos(uint64_t tsc_value);
 
+/**
+ * Where the TSC frequency came from.
+ */
+#define MACAC_TSC_SOURCE_NONE 0         // No TSC; ticks are nanoseconds
+#define MACAC_TSC_SOURCE_CPUID 1        // CPUID leaf 0x15/0x16
+#define MACAC_TSC_SOURCE_HYPERVISOR 2   // CPUID leaf 0x40000010
+#define MACAC_TSC_SOURCE_SYSFS 3        // Linux tsc_freq_khz
+#define MACAC_TSC_SOURCE_MEASURED 4     // Two-point CLOCK_MONOTONIC_RAW calibration
+
+/**
+ * Source of the TSC frequency (MACAC_TSC_SOURCE_*).
+ */
+int macac_tsc_source(void);
+
+/**
+ * Returns 1 if the TSC runs at a constant rate in every power state.
+ * macac_nanotime only reads the TSC when this holds.
+ */
+int macac_tsc_invariant(void);
+
+/**
+ * TSC frequency in Hz (0 without a TSC).
+ */
+uint64_t macac_tsc_hz(void);
+
+// ============================================================================
+// Latency Instrumentation
+// ============================================================================
+
+#define MACAC_PERF_MAX_SITES 64         // Timing sites per process
+#define MACAC_PERF_NAME_MAX 48          // Site name length including terminator
+#define MACAC_PERF_NO_SITE (-1)
+
+/**
+ * Merged latency summary of one timing site. Percentiles come from a
+ * log-linear histogram (16 linear buckets per power of two of TSC ticks),
+ * so they are within ~3% of the true value; max is exact.
+ */
+typedef struct {
+    uint64_t count;
+    double mean_ns;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+} macac_perf_snapshot_t;
+
+/**
+ * Register a timing site, or look up an existing one by name (thread-safe).
+ * Returns the site id, or MACAC_PERF_NO_SITE if the name is empty or all
+ * MACAC_PERF_MAX_SITES are taken. Names longer than MACAC_PERF_NAME_MAX - 1
+ * are truncated.
+ */
+int macac_perf_register(const char* name);
+
+/**
+ * Number of registered sites; ids are 0..count-1.
+ */
+int macac_perf_site_count(void);
+
+/**
+ * Name of a site, or null if the id is not registered.
+ */
+const char* macac_perf_site_name(int site);
+
+/**
+ * Start timestamp for macac_perf_end (TSC ticks).
+ */
+uint64_t macac_perf_begin(void);
+
+/**
+ * Record the time since begin against a site. Counts go to a histogram
+ * owned by the calling thread, so recording takes no lock and shares no
+ * cache line with other threads. Invalid sites are ignored.
+ */
+void macac_perf_end(int site, uint64_t begin);
+
+/**
+ * Record a duration in TSC ticks against a site.
+ */
+void macac_perf_record(int site, uint64_t ticks);
+
+/**
+ * Merge every thread's histogram for a site (including exited threads).
+ * Returns 0 on success, -1 if the site is not registered.
+ */
+int macac_perf_snapshot(int site, macac_perf_snapshot_t* out);
+
+/**
+ * Zero all histograms. Samples recorded concurrently may survive the reset.
+ */
+void macac_perf_reset(void);
+
+// ============================================================================
+// Hardware Counter Profiling (perf_event_open, Linux)
+// ============================================================================
+
+#define MACAC_PMU_CYCLES 0              // Core cycles
+#define MACAC_PMU_INSTRUCTIONS 1        // Instructions retired
+#define MACAC_PMU_L1D_MISSES 2          // L1 data cache read misses
+#define MACAC_PMU_LLC_MISSES 3          // Last-level cache misses
+#define MACAC_PMU_BRANCH_MISSES 4       // Mispredicted branches
+#define MACAC_PMU_TASK_CLOCK 5          // Nanoseconds on CPU (software event)
+#define MACAC_PMU_EVENTS 6
+
+// Events that need a hardware PMU; without any, only task clock is counted
+#define MACAC_PMU_HARDWARE_MASK 0x1Fu
+
+/**
+ * Counter totals of one timing site over a profiling session, summed over
+ * every scope measured. Counts are user-space only and inclusive of
+ * nested scopes, like the latency histograms.
+ */
+typedef struct {
+    uint64_t scopes;                    // Scopes counted
+    uint64_t partial;                   // Scopes skipped: counters were multiplexed out
+    uint64_t values[MACAC_PMU_EVENTS];  // Totals per MACAC_PMU_* (0 if not counted)
+    uint32_t events;                    // Bit per MACAC_PMU_* counted by some thread
+} macac_pmu_snapshot_t;
+
+/**
+ * Start a profiling session: while it runs, every macac_perf_begin/end
+ * scope also reads the calling thread's counter group (cycles,
+ * instructions, L1D and LLC misses, branch misses, task clock), opened on
+ * the thread's first scope. Clears the previous session's totals.
+ * 
+ * Each scope costs two read(2) calls (about a microsecond) while a session
+ * runs, which enclosing scopes' latencies include; idle cost is one relaxed
+ * load per scope.
+ * 
+ * Returns the bitmask of events the calling thread could open, or 0 (no
+ * session started) when perf events are unavailable: not Linux, no PMU
+ * (many VMs), or kernel.perf_event_paranoid > 2.
+ */
+uint32_t macac_pmu_start(void);
+
+/**
+ * End the session; counters stop, totals stay readable until the next start.
+ */
+void macac_pmu_stop(void);
+
+/**
+ * Returns 1 while a session runs.
+ */
+int macac_pmu_active(void);
+
+/**
+ * Merge every thread's counter totals for a site (including exited
+ * threads). Returns 0 on success, -1 if the site is not registered.
+ */
+int macac_pmu_snapshot(int site, macac_pmu_snapshot_t* out);
+
+// ============================================================================
+// Sample Storage (element types for ring buffers and history slabs)
+// ============================================================================
+
+// Samples are narrowed on push and widened to double on read; statistics
+// are always computed in double.
+#define MACAC_STORAGE_F64 0     // double, exact
+#define MACAC_STORAGE_F32 1     // float, ~7 significant digits, half the memory
+#define MACAC_STORAGE_Q16 2     // int16 with a power-of-two step per window, a quarter
+
+/**
+ * Bytes per stored sample for a MACAC_STORAGE_* type (0 if unknown).
+ * 
+ * A Q16 window's step starts at 2^-40 and grows when a sample does not fit
+ * in 15 bits, requantising the window; resolution is about 1/16384 of the
+ * largest stored magnitude. The step is shrunk back only when the write
+ * position wraps, to fit what the window then holds, so after a spike it
+ * stays coarse until the first wrap after the spike is overwritten (one to
+ * two laps after it was pushed). Samples stored under the coarse step keep
+ * its rounding until they are overwritten too, so full resolution can take
+ * up to about three laps to return. NaN and infinite samples read back as NaN.
+ */
+size_t macac_storage_bytes(int storage);
+
+// ============================================================================
+// Ring Buffer (single-writer, SIMD-optimized)
+// ============================================================================
+
+/**
+ * Running statistics kept by a tracked ring buffer (opaque).
+ */
+typedef struct macac_ringbuffer_stats macac_ringbuffer_stats_t;
+
+/**
+ * Push/get/statistics kernels specialised for the buffer's capacity (opaque).
+ */
+typedef struct macac_ringbuffer_ops macac_ringbuffer_ops_t;
+
+/**
+ * Native ring buffer structure for double values.
+ * Uses aligned storage for SIMD operations.
+ * 
+ * Push, clear and the running statistics assume one writer thread; callers
+ * that push from several threads must serialize externally. Use
+ * macac_queue_* to hand samples between threads.
+ */
+typedef struct {
+    void* data;             // Aligned buffer storage, `storage` elements
+    size_t capacity;        // Maximum elements
+    std::atomic<size_t> head;   // Write position (single writer)
+    std::atomic<size_t> size;   // Current element count
+    macac_ringbuffer_stats_t* stats;    // Running statistics (null if untracked)
+    const macac_ringbuffer_ops_t* ops;  // Kernels chosen for capacity and storage at create
+    int storage;            // MACAC_STORAGE_* element type
+    int32_t q16_exp;        // Q16 step exponent, step = 2^q16_exp
+    double q16_step;
+} macac_ringbuffer_t;
+
+/**
+ * Create a new ring buffer with specified capacity.
+ * Buffer is aligned for SIMD access. Power-of-two capacities wrap with a
+ * mask; 8 through 256 also get kernels compiled for that exact capacity
+ * (see macac_fixed_ring.h).
+ */
+macac_ringbuffer_t* macac_ringbuffer_create(size_t capacity);
+
+/**
+ * Destroy a ring buffer and free memory.
+ */
+void macac_ringbuffer_destroy(macac_ringbuffer_t* rb);
+
+/**
+ * Push a value onto the ring buffer (O(1)).
+ */
+void macac_ringbuffer_push(macac_ringbuffer_t* rb, double value);
+
+/**
+ * Get element at age (0 = most recent).
+ * Returns NaN if index out of range.
+ */
+double macac_ringbuffer_get(macac_ringbuffer_t* rb, size_t age);
+
+/**
+ * Clear the ring buffer.
+ */
+void macac_ringbuffer_clear(macac_ringbuffer_t* rb);
+
+/**
+ * Get current size.
+ */
+size_t macac_ringbuffer_size(macac_ringbuffer_t* rb);
+
+/**
+ * Create a ring buffer that maintains running statistics on every push.
+ * Mean/variance use Welford updates with evict-on-overwrite, re-normalized
+ * from the raw window once per capacity pushes; min/max use monotonic queues.
+ */
+macac_ringbuffer_t* macac_ringbuffer_create_tracked(size_t capacity);
+
+/**
+ * Create a ring buffer storing samples as a MACAC_STORAGE_* type, with
+ * running statistics if tracked != 0. Statistics describe the stored
+ * (narrowed) samples. Returns NULL for an unknown storage type.
+ */
+macac_ringbuffer_t* macac_ringbuffer_create_typed(size_t capacity, int storage, int tracked);
+
+/**
+ * Get the MACAC_STORAGE_* type of a ring buffer (-1 if null).
+ */
+int macac_ringbuffer_storage(macac_ringbuffer_t* rb);
+
+/**
+ * Check if the ring buffer maintains running statistics.
+ */
+int macac_ringbuffer_is_tracked(macac_ringbuffer_t* rb);
+
+/**
+ * Capacity the buffer's kernels were compiled for, or 0 if it uses the
+ * runtime-capacity ones.
+ */
+size_t macac_ringbuffer_fixed_capacity(macac_ringbuffer_t* rb);
+
+/**
+ * Mean of the current window (0 if empty).
+ * O(1) on tracked buffers, O(n) otherwise.
+ */
+double macac_ringbuffer_mean(macac_ringbuffer_t* rb);
+
+/**
+ * Sample variance of the current window (0 if fewer than 2 elements).
+ * O(1) on tracked buffers, O(n) otherwise.
+ */
+double macac_ringbuffer_variance(macac_ringbuffer_t* rb);
+
+/**
+ * Minimum of the current window (NaN if empty).
+ * O(1) on tracked buffers, O(n) otherwise.
+ */
+double macac_ringbuffer_min(macac_ringbuffer_t* rb);
+
+/**
+ * Maximum of the current window (NaN if empty).
+ * O(1) on tracked buffers, O(n) otherwise.
+ */
+double macac_ringbuffer_max(macac_ringbuffer_t* rb);
+
+// ============================================================================
+// Packet Queue (lock-free SPSC/MPSC telemetry hand-off)
+// ============================================================================
+
+#define MACAC_QUEUE_SPSC 0      // One producer thread, one consumer thread
+#define MACAC_QUEUE_MPSC 1      // Any number of producers, one consumer
+
+// macac_telemetry_record_t.flags bits
+#define MACAC_TELEMETRY_ON_GROUND   (1u << 0)
+#define MACAC_TELEMETRY_IN_VEHICLE  (1u << 1)
+#define MACAC_TELEMETRY_TELEPORTING (1u << 2)
+#define MACAC_TELEMETRY_SWIMMING    (1u << 3)
+#define MACAC_TELEMETRY_GLIDING     (1u << 4)
+#define MACAC_TELEMETRY_CLIMBING    (1u << 5)
+
+/**
+ * Fixed-size movement sample, field-for-field TelemetryInput plus the
+ * ingestor's player id. 72 bytes, no padding; Java reads drained records
+ * straight out of a direct ByteBuffer at these offsets.
+ */
+typedef struct {
+    double dx;              // 0
+    double dy;              // 8
+    double dz;              // 16
+    float yaw;              // 24
+    float pitch;            // 28
+    float delta_yaw;        // 32
+    float delta_pitch;      // 36
+    int64_t nano_time;      // 40
+    int64_t tick_delta;     // 48
+    int32_t ping;           // 56
+    int32_t player;         // 60: ingestor-assigned id
+    uint32_t flags;         // 64: MACAC_TELEMETRY_* bits
+    uint32_t reserved;      // 68
+} macac_telemetry_record_t;
+
+#define MACAC_TELEMETRY_RECORD_SIZE 72
+
+/**
+ * Bounded queue of telemetry records (opaque).
+ */
+typedef struct macac_packet_queue macac_packet_queue_t;
+
+/**
+ * Create a queue holding at least capacity records (rounded up to a power
+ * of two, at most 2^24). mode is MACAC_QUEUE_SPSC or MACAC_QUEUE_MPSC.
+ * Producer and consumer indices live on separate cache lines.
+ */
+macac_packet_queue_t* macac_queue_create(size_t capacity, int mode);
+
+/**
+ * Destroy a queue. No thread may be pushing or draining.
+ */
+void macac_queue_destroy(macac_packet_queue_t* queue);
+
+/**
+ * Copy one record into the queue (never blocks, no syscalls).
+ * SPSC queues accept pushes from one thread at a time; MPSC from any.
+ * Returns 0 if queued, -1 if the queue was full and the record dropped.
+ */
+int macac_queue_push(macac_packet_queue_t* queue, const macac_telemetry_record_t* record);
+
+/**
+ * Move up to max records, oldest first, into out. Single consumer.
+ * Returns the number of records copied.
+ */
+size_t macac_queue_drain(macac_packet_queue_t* queue, macac_telemetry_record_t* out, size_t max);
+
+/**
+ * Approximate number of queued records (exact when no thread is pushing).
+ */
+size_t macac_queue_size(macac_packet_queue_t* queue);
+
+/**
+ * Capacity after rounding to a power of two.
+ */
+size_t macac_queue_capacity(macac_packet_queue_t* queue);
+
+/**
+ * Records dropped because the queue was full.
+ */
+uint64_t macac_queue_dropped(macac_packet_queue_t* queue);
+
+// ============================================================================
+// Telemetry Capture (binary recording for offline replay)
+// ============================================================================
+
+/*
+ * Capture files are a 64-byte macac_capture_header_t followed by records,
+ * all in native byte order. Every record starts with a u16 type and a u16
+ * total size, so readers can skip types they do not know. Files rotate at
+ * a size limit: <prefix>-<unix seconds>-<index>.mcap.
+ */
+#define MACAC_CAPTURE_MAGIC "MACACCAP"
+#define MACAC_CAPTURE_VERSION 1
+
+#define MACAC_CAPTURE_TELEMETRY 1
+#define MACAC_CAPTURE_COMBAT 2
+
+// macac_capture_combat_t.flags bits
+#define MACAC_CAPTURE_HIT        (1u << 0)
+#define MACAC_CAPTURE_CRITICAL   (1u << 1)
+#define MACAC_CAPTURE_HAS_TARGET (1u << 2)
+
+typedef struct {
+    char magic[8];              // 0: MACAC_CAPTURE_MAGIC
+    uint32_t version;           // 8
+    uint32_t header_bytes;      // 12: sizeof(macac_capture_header_t)
+    int64_t start_nanos;        // 16: macac_nanotime() when the file was opened
+    int64_t start_unix_ms;      // 24: wall clock at the same moment
+    uint32_t file_index;        // 32: position in the rotation, from 0
+    uint32_t reserved[7];       // 36
+} macac_capture_header_t;
+
+/**
+ * One movement sample: the packet queue record plus the player's UUID.
+ */
+typedef struct {
+    uint16_t type;              // 0: MACAC_CAPTURE_TELEMETRY
+    uint16_t size;              // 2: MACAC_CAPTURE_TELEMETRY_SIZE
+    uint32_t reserved;          // 4
+    uint64_t player_hi;         // 8: UUID most significant bits
+    uint64_t player_lo;         // 16: UUID least significant bits
+    macac_telemetry_record_t telemetry;     // 24
+} macac_capture_telemetry_t;
+
+#define MACAC_CAPTURE_TELEMETRY_SIZE 96
+
+/**
+ * One attack, field-for-field CombatInput minus the attacker name.
+ */
+typedef struct {
+    uint16_t type;              // 0: MACAC_CAPTURE_COMBAT
+    uint16_t size;              // 2: MACAC_CAPTURE_COMBAT_SIZE
+    uint32_t flags;             // 4: MACAC_CAPTURE_* bits
+    uint64_t player_hi;         // 8
+    uint64_t player_lo;         // 16
+    uint64_t target_hi;         // 24: zero unless MACAC_CAPTURE_HAS_TARGET
+    uint64_t target_lo;         // 32
+    double target_x;            // 40
+    double target_y;            // 48
+    double target_z;            // 56
+    double attacker_x;          // 64
+    double attacker_y;          // 72
+    double attacker_z;          // 80
+    double damage;              // 88
+    float attacker_yaw;         // 96
+    float attacker_pitch;       // 100
+    float pre_attack_yaw;       // 104
+    float pre_attack_pitch;     // 108
+    int64_t nano_time;          // 112
+    int64_t time_since_last;    // 120: nanoseconds since the previous attack
+    int32_t ping;               // 128
+    uint32_t reserved;          // 132
+} macac_capture_combat_t;
+
+#define MACAC_CAPTURE_COMBAT_SIZE 136
+
+/**
+ * Capture writer (opaque).
+ */
+typedef struct macac_capture macac_capture_t;
+
+/**
+ * Capture counters snapshot.
+ */
+typedef struct {
+    uint64_t records;           // Records written to disk
+    uint64_t dropped;           // Records rejected because the ring was full
+    uint64_t bytes;             // Bytes written, headers included
+    uint64_t files;             // Files opened so far
+    uint64_t errors;            // Failed writes or rotations
+} macac_capture_stats_t;
+
+/**
+ * Start capturing to files named from prefix (a path without extension).
+ * Producers append into a lock-free ring of at least capacity records; a
+ * background thread writes it out in large blocks and rotates to a new
+ * file every max_file_bytes, deleting the oldest once more than max_files
+ * exist (0 keeps all). Returns NULL if the first file cannot be created.
+ */
+macac_capture_t* macac_capture_open(const char* prefix, size_t capacity,
+                                    uint64_t max_file_bytes, uint32_t max_files);
+
+/**
+ * Write out everything queued, stop the writer thread and free the capture.
+ */
+void macac_capture_close(macac_capture_t* capture);
+
+/**
+ * Queue a movement sample (thread-safe, never blocks, no syscalls).
+ * Returns 0 if queued, -1 if dropped.
+ */
+int macac_capture_telemetry(macac_capture_t* capture, uint64_t player_hi, uint64_t player_lo,
+                            const macac_telemetry_record_t* record);
+
+/**
+ * Queue an attack; type and size are filled in (thread-safe, never blocks).
+ * Returns 0 if queued, -1 if dropped.
+ */
+int macac_capture_combat(macac_capture_t* capture, const macac_capture_combat_t* record);
+
+/**
+ * Get a snapshot of the capture counters.
+ */
+void macac_capture_get_stats(macac_capture_t* capture, macac_capture_stats_t* out);
+
+// ============================================================================
+// Player History Slab (SoA arena for all per-player windows)
+// ============================================================================
+
+/**
+ * Slab of fixed-size metric windows for many players.
+ * All windows live in one 64-byte aligned arena laid out as
+ * [metric][slot][window], so sweeping one metric across players is linear.
+ */
+typedef struct macac_history_slab macac_history_slab_t;
+
+/**
+ * Create a slab with room for max_slots players, each holding
+ * num_metrics windows of the given length.
+ */
+macac_history_slab_t* macac_slab_create(size_t max_slots, size_t num_metrics, size_t window);
+
+/**
+ * Create a slab whose arena is a shared mapping of a history file, so
+ * windows are written in place and survive a restart. An existing file
+ * with the same version and geometry is mapped back without parsing;
+ * its active slots become dormant until their owners return. Any other
+ * file is reinitialised. Returns NULL on I/O failure or if another
+ * process holds the file.
+ */
+macac_history_slab_t* macac_slab_open_mapped(const char* path, size_t max_slots,
+                                             size_t num_metrics, size_t window);
+
+/**
+ * macac_slab_create / macac_slab_open_mapped with windows stored as a
+ * MACAC_STORAGE_* type; F32 and Q16 fit two and four times the samples in
+ * the same arena. The storage type is part of a history file's geometry.
+ * Returns NULL for an unknown storage type.
+ */
+macac_history_slab_t* macac_slab_create_typed(size_t max_slots, size_t num_metrics, size_t window,
+                                              int storage);
+macac_history_slab_t* macac_slab_open_mapped_typed(const char* path, size_t max_slots,
+                                                   size_t num_metrics, size_t window, int storage);
+
+/**
+ * Get the MACAC_STORAGE_* type of a slab (-1 if null).
+ */
+int macac_slab_storage(macac_history_slab_t* slab);
+
+/**
+ * Destroy a slab and free its arena. A mapped slab is unmapped and its
+ * contents left in the file.
+ */
+void macac_slab_destroy(macac_history_slab_t* slab);
+
+/**
+ * Take a free slot from the free-list (thread-safe).
+ * Returns a generation-tagged slot id, or -1 if the slab is full.
+ */
+int64_t macac_slab_acquire(macac_history_slab_t* slab);
+
+/**
+ * Take a slot for an owner key (e.g. the two halves of a player UUID).
+ * If the owner has a dormant slot its windows are kept; otherwise a free
+ * slot is reset, evicting the longest-dormant slot if none is free.
+ * Returns a slot id, or -1 if every slot is active.
+ */
+int64_t macac_slab_acquire_for(macac_history_slab_t* slab, uint64_t key_hi, uint64_t key_lo);
+
+/**
+ * Return a slot to the free-list (thread-safe).
+ * Outstanding copies of the id become invalid and are ignored.
+ */
+void macac_slab_release(macac_history_slab_t* slab, int64_t slot_id);
+
+/**
+ * Deactivate a slot but keep its windows for macac_slab_acquire_for with
+ * the same owner key (thread-safe). Outstanding ids become invalid.
+ */
+void macac_slab_park(macac_history_slab_t* slab, int64_t slot_id);
+
+/**
+ * Schedule write-back of a mapped slab's dirty pages; with wait != 0,
+ * block until they are on disk. No-op for heap slabs.
+ * Returns 0 on success, -1 on error.
+ */
+int macac_slab_sync(macac_history_slab_t* slab, int wait);
+
+/**
+ * Returns 1 if the slab is backed by a history file.
+ */
+int macac_slab_is_mapped(macac_history_slab_t* slab);
+
+/**
+ * Push a value onto one metric window of a slot (O(1)).
+ * Single writer per slot. Safe against a concurrent release or park of the
+ * slot: the push either lands before the slot is handed on or is dropped.
+ */
+void macac_slab_push(macac_history_slab_t* slab, int64_t slot_id, size_t metric, double value);
+
+/**
+ * Get element at age (0 = most recent).
+ * Returns NaN if out of range or the slot id is stale.
+ */
+double macac_slab_get(macac_history_slab_t* slab, int64_t slot_id, size_t metric, size_t age);
+
+/**
+ * Get current element count of one metric window.
+ */
+size_t macac_slab_size(macac_history_slab_t* slab, int64_t slot_id, size_t metric);
+
+/**
+ * Get an aligned pointer to the raw storage of one metric window.
+ * The first *out_count elements are valid (in ring order, not age order),
+ * suitable for order-independent kernels such as sum/mean/variance.
+ * Only MACAC_STORAGE_F64 slabs expose doubles; others return NULL with
+ * *out_count = 0 (use macac_slab_read or macac_slab_mean/variance).
+ * The pointer is not guarded: it must not be used once the slot may have
+ * been released or parked.
+ */
+const double* macac_slab_window(macac_history_slab_t* slab, int64_t slot_id,
+                                size_t metric, size_t* out_count);
+
+/**
+ * Copy up to max_count of a window's newest samples into out as doubles,
+ * oldest first. Returns the number copied.
+ */
+size_t macac_slab_read(macac_history_slab_t* slab, int64_t slot_id, size_t metric,
+                       double* out, size_t max_count);
+
+/**
+ * Mean of one metric window, widened from any storage (0 if empty).
+ */
+double macac_slab_mean(macac_history_slab_t* slab, int64_t slot_id, size_t metric);
+
+/**
+ * Sample variance of one metric window (0 if fewer than 2 samples).
+ */
+double macac_slab_variance(macac_history_slab_t* slab, int64_t slot_id, size_t metric);
+
+/**
+ * Get number of acquired slots.
+ */
+size_t macac_slab_active_count(macac_history_slab_t* slab);
+
+/**
+ * Get number of dormant slots (parked, or restored from a history file).
+ */
+size_t macac_slab_dormant_count(macac_history_slab_t* slab);
+
+// ============================================================================
+// CPU Dispatch (runtime ISA selection)
+// ============================================================================
+
+/**
+ * Instruction sets with dedicated kernels. On x86 the values are ordered,
+ * so every ISA up to the best supported one can be selected.
+ * MACAC_ISA_AVX2 also requires FMA.
+ */
+#define MACAC_ISA_SCALAR 0
+#define MACAC_ISA_SSE2 1
+#define MACAC_ISA_AVX2 2
+#define MACAC_ISA_AVX512 3
+#define MACAC_ISA_NEON 4
+
+/**
+ * Detect the CPU (CPUID/XCR0 on x86) and select the best kernels.
+ * Idempotent; kernels also self-initialize on first use.
+ */
+void macac_cpu_init(void);
+
+/**
+ * ISA of the active kernels (MACAC_ISA_*).
+ */
+int macac_cpu_isa(void);
+
+/**
+ * Best ISA supported by this CPU and OS.
+ */
+int macac_cpu_best_isa(void);
+
+/**
+ * Returns 1 if kernels for isa can run on this host.
+ */
+int macac_cpu_supports(int isa);
+
+/**
+ * Force a specific ISA (benchmarks, diagnostics).
+ * Returns 0 on success, -1 if the host does not support it.
+ */
+int macac_cpu_set_isa(int isa);
+
+/**
+ * Short name of an ISA ("scalar", "sse2", "avx2", "avx512", "neon").
+ */
+const char* macac_cpu_isa_name(int isa);
+
+// ============================================================================
+// SIMD Statistics (runtime-dispatched)
+// ============================================================================
+
+/**
+ * Calculate sum using the active SIMD kernels.
+ */
+double macac_simd_sum(const double* data, size_t count);
+
+/**
+ * Calculate mean using SIMD.
+ */
+double macac_simd_mean(const double* data, size_t count);
+
+/**
+ * Calculate variance using SIMD.
+ */
+double macac_simd_variance(const double* data, size_t count, double mean);
+
+/**
+ * Mean, sample variance and range from one pass over the data.
+ */
+typedef struct {
+    double mean;
+    double variance;        // n - 1 denominator; 0 for fewer than 2 samples
+    double min;
+    double max;
+} macac_moments_t;
+
+/**
+ * Calculate mean/variance/min/max in a single fused SIMD pass
+ * (shifted sums, so it matches the two-pass variance to rounding).
+ * Zeroes out when count is 0.
+ */
+void macac_simd_moments(const double* data, size_t count, macac_moments_t* out);
+
+/**
+ * Full summary of a window from one pass.
+ */
+typedef struct {
+    uint64_t count;
+    double sum;
+    double mean;
+    double variance;        // n - 1 denominator; 0 for fewer than 2 samples
+    double min;
+    double max;
+    double skewness;        // population g1 = m3 / m2^1.5; 0 without spread
+    double kurtosis;        // population excess g2 = m4 / m2^2 - 3; 0 without spread
+} macac_describe_t;
+
+/**
+ * Calculate count/sum/mean/variance/min/max/skewness/kurtosis in a single
+ * SIMD pass. Power sums are shifted by the first sample and compensated
+ * across blocks, so rounding error does not grow with the window length.
+ * Zeroes out when count is 0.
+ */
+void macac_simd_describe(const double* data, size_t count, macac_describe_t* out);
+
+/**
+ * Calculate median (uses partial sort, not SIMD).
+ */
+double macac_median(double* data, size_t count);
+
+/**
+ * Calculate MAD (Median Absolute Deviation).
+ */
+double macac_mad(double* data, size_t count);
+
+/**
+ * Calculate median without allocating.
+ * scratch must hold count doubles; data is not modified.
+ */
+double macac_median_scratch(const double* data, size_t count, double* scratch);
+
+/**
+ * Calculate MAD without allocating.
+ * scratch must hold count doubles; data is not modified.
+ */
+double macac_mad_scratch(const double* data, size_t count, double* scratch);
+
+// ============================================================================
+// Rolling Order Statistics (sliding-window median/MAD)
+// ============================================================================
+
+/**
+ * Fixed-size sliding window that keeps its samples ordered
+ * (order-statistic treap over the ring slots, preallocated).
+ */
+typedef struct macac_order_stats macac_order_stats_t;
+
+/**
+ * Create a rolling order-statistics window.
+ */
+macac_order_stats_t* macac_order_stats_create(size_t window);
+
+/**
+ * Destroy a rolling order-statistics window.
+ */
+void macac_order_stats_destroy(macac_order_stats_t* os);
+
+/**
+ * Push a value, evicting the oldest if full (O(log n), no allocation).
+ */
+void macac_order_stats_push(macac_order_stats_t* os, double value);
+
+/**
+ * Clear the window.
+ */
+void macac_order_stats_clear(macac_order_stats_t* os);
+
+/**
+ * Get current element count.
+ */
+size_t macac_order_stats_size(macac_order_stats_t* os);
+
+/**
+ * Median of the window, cached on push (O(1)). Returns 0 if empty.
+ */
+double macac_order_stats_median(macac_order_stats_t* os);
+
+/**
+ * k-th smallest element, 0-based (O(log n)). Returns NaN if out of range.
+ */
+double macac_order_stats_select(macac_order_stats_t* os, size_t k);
+
+/**
+ * Exact MAD of the window (O(log^2 n)). Returns 0 if empty.
+ */
+double macac_order_stats_mad(macac_order_stats_t* os);
+
+// ============================================================================
+// Population Baselines (server-wide feature quantiles)
+// ============================================================================
+
+/**
+ * Most metrics one population can track.
+ */
+#define MACAC_POPULATION_MAX_METRICS 16
+
+/**
+ * Default t-digest compression. Rank error stays within a few percent of
+ * min(q, 1 - q): the value returned for p99.9 typically ranks within
+ * p99.897 to p99.903.
+ */
+#define MACAC_POPULATION_DEFAULT_COMPRESSION 200
+
+/**
+ * Distribution of a few per-packet metrics across every player (opaque).
+ * 
+ * Each thread adds to its own shard of mergeable t-digests, so analysis
+ * workers never contend. macac_population_refresh merges the shards into
+ * the snapshot that queries read; samples added since are not visible
+ * until the next refresh. All functions are thread-safe.
+ */
+typedef struct macac_population macac_population_t;
+
+/**
+ * Snapshot summary of one metric.
+ */
+typedef struct {
+    uint64_t count;         // Samples the snapshot covers
+    uint64_t centroids;     // Centroids queries search
+    double min;             // Exact extremes (NaN if empty)
+    double max;
+} macac_population_stats_t;
+
+/**
+ * Create a population of metrics metrics (1 to MACAC_POPULATION_MAX_METRICS).
+ * compression is clamped to [20, 1000]; 0 selects the default. With
+ * window_ms > 0, refresh retires samples older than one to two windows;
+ * otherwise samples are kept for the population's lifetime.
+ */
+macac_population_t* macac_population_create(size_t metrics, uint32_t compression, int64_t window_ms);
+
+/**
+ * Destroy a population. No other call may be in progress.
+ */
+void macac_population_destroy(macac_population_t* population);
+
+/**
+ * Add one sample of a metric. Non-finite samples are ignored.
+ */
+void macac_population_add(macac_population_t* population, size_t metric, double value);
+
+/**
+ * Add one sample of every metric (values[metric], one shard lock for the
+ * row). Non-finite entries are skipped.
+ */
+void macac_population_add_row(macac_population_t* population, const double* values);
+
+/**
+ * Merge every shard into a new snapshot and retire the oldest generation
+ * when a window has passed. Costs O(S log S) for S centroids over all
+ * shards (at most a few thousand per metric); call it periodically, off
+ * the packet path.
+ */
+void macac_population_refresh(macac_population_t* population);
+
+/**
+ * Value at quantile q in [0, 1] of the last snapshot (O(log S)).
+ * Returns NaN if the metric has no samples.
+ */
+double macac_population_quantile(macac_population_t* population, size_t metric, double q);
+
+/**
+ * Fraction of the last snapshot at or below x (O(log S)).
+ * Returns NaN if the metric has no samples.
+ */
+double macac_population_cdf(macac_population_t* population, size_t metric, double x);
+
+/**
+ * Get the snapshot summary of one metric.
+ */
+void macac_population_get_stats(macac_population_t* population, size_t metric,
+                                macac_population_stats_t* out);
+
+// ============================================================================
+// Network Functions
+// ============================================================================
+
+/**
+ * Network connection handle.
+ */
+typedef struct macac_connection macac_connection_t;
+
+/**
+ * Create a TCP connection to the analytics server.
+ * Resolves host on the calling thread (IPv4 or IPv6, first reachable
+ * address wins) and waits at most 5 seconds per address.
+ */
+macac_connection_t* macac_net_connect(const char* host, int port);
+
+/**
+ * Send violation data to the server.
+ * Data is serialized as JSON.
+ */
+int macac_net_send_violation(macac_connection_t* conn, 
+                              const char* player_uuid,
+                              const char* category,
+                              double confidence,
+                              double severity,
+                              int64_t timestamp);
+
+/**
+ * Close the connection.
+ */
+void macac_net_close(macac_connection_t* conn);
+
+/**
+ * Check if connection is alive.
+ */
+int macac_net_is_connected(macac_connection_t* conn);
+
 // ============================================================================
-// Ring Buffer (Lock-free, SIMD-optimized)
+// Async Sender (MPSC queue + dedicated I/O thread)
 // ============================================================================
 
 /**
- * Native ring buffer structure for double values.
- * Uses aligned storage for SIMD operations.
+ * Maximum payload bytes of one queued record
+ * (player UUID + category for violations, whole message for raw sends).
+ */
+#define MACAC_SENDER_MAX_MESSAGE 448
+
+/**
+ * Wire protocols for the async sender.
+ * 
+ * MACAC_WIRE_JSON: one JSON object per line (default).
+ * 
+ * MACAC_WIRE_BINARY / MACAC_WIRE_BINARY_BATCHED: length-prefixed frames,
+ * all integers little-endian. On connect the client sends an 8-byte hello
+ *   "MACB" | u8 max_version | u8 flags (bit 0 = batching) | u16 reserved
+ * and waits for the server's 8-byte ack in the same layout, whose version
+ * byte is the negotiated version (0 = rejected). Then frames follow:
+ *   u32 length (bytes after this field) | u8 type | payload
+ *   MACAC_FRAME_CATEGORY:  u16 id | u8 name_len | name
+ *   MACAC_FRAME_VIOLATION: one 36-byte record
+ *   MACAC_FRAME_BATCH:     u16 count | count records
+ *   MACAC_FRAME_SUMMARY:   one record | u32 count | i64 first_timestamp
+ *                          (version 2; MACAC_WIRE_SUMMARY_BYTES)
+ * Record (MACAC_WIRE_RECORD_BYTES):
+ *   u8 uuid[16] (RFC 4122 byte order) | u16 category_id | u16 reserved |
+ *   f32 confidence | f32 severity | i64 timestamp
+ * A summary record carries the maximum confidence, mean severity and latest
+ * timestamp of the violations it merges; on a version 1 connection it is
+ * sent as a plain violation record (in batches when batching).
+ * Category ids are interned per sender; every category is (re)defined at
+ * the start of each connection and before its first use. Violations whose
+ * UUID does not parse or whose category does not fit the table are dropped.
+ * macac_sender_send_raw bytes are written verbatim in every protocol.
+ */
+#define MACAC_WIRE_JSON 0
+#define MACAC_WIRE_BINARY 1
+#define MACAC_WIRE_BINARY_BATCHED 2
+
+#define MACAC_WIRE_VERSION 2
+#define MACAC_WIRE_RECORD_BYTES 36
+#define MACAC_WIRE_SUMMARY_BYTES 48
+
+#define MACAC_FRAME_CATEGORY 0x01
+#define MACAC_FRAME_VIOLATION 0x02
+#define MACAC_FRAME_BATCH 0x03
+#define MACAC_FRAME_SUMMARY 0x04
+
+/**
+ * Most collector endpoints one sender can spread reports across.
+ */
+#define MACAC_SENDER_MAX_ENDPOINTS 8
+
+/**
+ * Endpoint states reported by macac_sender_get_endpoint_stats.
+ * STALLED: connected, but the socket has refused bytes for longer than the
+ * connect timeout; new records fail over until it drains again.
+ */
+#define MACAC_ENDPOINT_DOWN 0
+#define MACAC_ENDPOINT_RESOLVING 1
+#define MACAC_ENDPOINT_CONNECTING 2
+#define MACAC_ENDPOINT_UP 3
+#define MACAC_ENDPOINT_STALLED 4
+
+/**
+ * Background sender handle.
+ */
+typedef struct macac_sender macac_sender_t;
+
+/**
+ * Sender counters snapshot.
  */
 typedef struct {
-    double* data;           // Aligned buffer storage
-    size_t capacity;        // Maximum elements
-    std::atomic<size_t> head;   // Write position (atomic for lock-free)
-    std::atomic<size_t> size;   // Current element count
-} macac_ringbuffer_t;
+    uint64_t enqueued;      // Records accepted by the queue
+    uint64_t sent;          // Records fully written to the socket
+    uint64_t dropped;       // Records rejected (queue full, oversized, shutdown)
+    uint64_t reconnects;    // Successful connections after the first
+    uint64_t queue_depth;   // Records queued or in flight
+    int connected;          // 1 if any endpoint is currently connected
+    int protocol_version;   // Negotiated binary version (0 for JSON or not connected)
+    uint64_t failovers;     // Records written to an endpoint other than their shard's
+    int endpoints;          // Configured endpoints
+    int endpoints_up;       // Endpoints connected and accepting writes
+    uint64_t spilled;       // Records written to the spill log
+    uint64_t replayed;      // Records read back from the spill log
+    uint64_t spill_depth;   // Records in the spill log not yet read back
+} macac_sender_stats_t;
 
 /**
- * Create a new ring buffer with specified capacity.
- * Buffer is aligned for SIMD access.
+ * Per-endpoint counters snapshot.
  */
-macac_ringbuffer_t* macac_ringbuffer_create(size_t capacity);
+typedef struct {
+    char endpoint[272];     // "host:port" or "[v6]:port" as configured
+    char peer[64];          // Numeric address of the current or last connection
+    uint64_t sent;          // Records fully written to this endpoint
+    uint64_t reconnects;    // Successful connections after the first
+    uint64_t backlog;       // Records routed here and not yet written
+    int state;              // MACAC_ENDPOINT_*
+    int protocol_version;   // Negotiated binary version (0 for JSON or not connected)
+} macac_sender_endpoint_stats_t;
 
 /**
- * Destroy a ring buffer and free memory.
+ * Create a sender and start its I/O thread.
+ * Producers enqueue into a bounded lock-free queue (capacity rounded up to
+ * a power of two); the I/O thread connects, reconnects with exponential
+ * backoff starting at reconnect_delay_ms, and drains the queue with writev.
+ * host may be a name, an IPv4 literal or an IPv6 literal (bracketed or
+ * not); names are resolved on a background thread, never on the caller or
+ * the I/O thread. protocol is one of the MACAC_WIRE_* values.
  */
-void macac_ringbuffer_destroy(macac_ringbuffer_t* rb);
+macac_sender_t* macac_sender_create(const char* host, int port, size_t queue_capacity,
+                                    int connect_timeout_ms, int reconnect_delay_ms,
+                                    int protocol);
 
 /**
- * Push a value onto the ring buffer (O(1)).
+ * Create a sender over a pool of collector endpoints, one connection each.
+ * endpoints is a comma- or whitespace-separated list of "host", "host:port",
+ * "[v6]" or "[v6]:port" (at most MACAC_SENDER_MAX_ENDPOINTS entries);
+ * entries without a port use default_port.
+ * 
+ * Violations are sharded by FNV-1a of the player UUID text, so a player's
+ * reports keep going to one collector. An endpoint that is disconnected or
+ * stalled (see MACAC_ENDPOINT_STALLED) takes no new records; they and its
+ * unwritten backlog fail over to the next healthy endpoint. Raw records go
+ * round-robin. Returns null if the list is empty or any entry is invalid.
  */
-void macac_ringbuffer_push(macac_ringbuffer_t* rb, double value);
+macac_sender_t* macac_sender_create_pool(const char* endpoints, int default_port,
+                                         size_t queue_capacity, int connect_timeout_ms,
+                                         int reconnect_delay_ms, int protocol);
 
 /**
- * Get element at age (0 = most recent).
- * Returns NaN if index out of range.
+ * Defaults for macac_spill_config_t.
  */
-double macac_ringbuffer_get(macac_ringbuffer_t* rb, size_t age);
+#define MACAC_SPILL_SEGMENT_BYTES ((size_t)4 << 20)
+#define MACAC_SPILL_MAX_BYTES ((size_t)64 << 20)
 
 /**
- * Clear the ring buffer.
+ * On-disk spill settings for macac_sender_create_spill.
  */
-void macac_ringbuffer_clear(macac_ringbuffer_t* rb);
+typedef struct {
+    const char* directory;  // Segment files (created if missing; one sender per directory)
+    size_t segment_bytes;   // Size of each segment file (0 = MACAC_SPILL_SEGMENT_BYTES)
+    size_t max_bytes;       // Disk budget over all segments (0 = MACAC_SPILL_MAX_BYTES)
+    size_t high_water;      // Queue depth that spills while connected (0 = 3/4 of the queue)
+} macac_spill_config_t;
 
 /**
- * Get current size.
+ * Create a pooled sender (as macac_sender_create_pool) that spills to disk
+ * instead of holding records in memory during outages.
+ * 
+ * The I/O thread appends a record to a segmented, memory-mapped log when no
+ * endpoint is healthy or the queue is deeper than high_water, and from then
+ * on every record until the log is read back, so order is kept. Appends are
+ * made durable with one fdatasync per segment every few hundred ms. Once
+ * endpoints accept again the log is replayed ahead of new records; a
+ * segment is deleted when all its records are written. Records still
+ * unwritten at destroy are spilled rather than dropped, and a sender created
+ * on the same directory later replays them. Delivery is at least once: a
+ * record written just before a crash may be replayed. Only a full disk
+ * budget drops records.
+ * 
+ * Returns null if the endpoint list is invalid or the directory cannot be
+ * used (including when another sender holds it).
  */
-size_t macac_ringbuffer_size(macac_ringbuffer_t* rb);
+macac_sender_t* macac_sender_create_spill(const char* endpoints, int default_port,
+                                          size_t queue_capacity, int connect_timeout_ms,
+                                          int reconnect_delay_ms, int protocol,
+                                          const macac_spill_config_t* spill);
 
-// ============================================================================
-// SIMD Statistics (AVX2 optimized)
-// ============================================================================
+/**
+ * Stop the I/O thread after a bounded flush, close the socket and free the sender.
+ */
+void macac_sender_destroy(macac_sender_t* sender);
 
 /**
- * Calculate sum using SIMD (AVX2 if available).
+ * Queue a violation record (thread-safe, never blocks, no syscalls on the
+ * fast path). Serialization happens on the I/O thread.
+ * Returns 0 if queued, -1 if dropped.
  */
-double macac_simd_sum(const double* data, size_t count);
+int macac_sender_send_violation(macac_sender_t* sender,
+                                const char* player_uuid,
+                                const char* category,
+                                double confidence,
+                                double severity,
+                                int64_t timestamp);
 
 /**
- * Calculate mean using SIMD.
+ * Queue a summary of count violations of one (player, category), as
+ * produced by macac_coalescer_*. JSON sends it as a "violation_summary"
+ * object with count and first_timestamp; count 1 is sent as a violation.
+ * Returns 0 if queued, -1 if dropped.
  */
-double macac_simd_mean(const double* data, size_t count);
+int macac_sender_send_summary(macac_sender_t* sender,
+                              const char* player_uuid,
+                              const char* category,
+                              uint32_t count,
+                              double max_confidence,
+                              double mean_severity,
+                              int64_t first_timestamp,
+                              int64_t last_timestamp);
 
 /**
- * Calculate variance using SIMD.
+ * Queue pre-framed bytes to be written verbatim (thread-safe, never blocks).
+ * Returns 0 if queued, -1 if dropped.
  */
-double macac_simd_variance(const double* data, size_t count, double mean);
+int macac_sender_send_raw(macac_sender_t* sender, const char* data, size_t len);
 
 /**
- * Calculate median (uses partial sort, not SIMD).
+ * Wait until every queued record has been written, or timeout_ms elapses.
+ * Returns 1 if fully flushed, 0 on timeout.
  */
-double macac_median(double* data, size_t count);
+int macac_sender_flush(macac_sender_t* sender, int timeout_ms);
 
 /**
- * Calculate MAD (Median Absolute Deviation).
+ * Get a snapshot of the sender counters.
  */
-double macac_mad(double* data, size_t count);
+void macac_sender_get_stats(macac_sender_t* sender, macac_sender_stats_t* out);
+
+/**
+ * Get a snapshot of one endpoint's counters (index < stats.endpoints).
+ * Returns 0 on success, -1 if the index is out of range.
+ */
+int macac_sender_get_endpoint_stats(macac_sender_t* sender, int index,
+                                    macac_sender_endpoint_stats_t* out);
 
 // ============================================================================
-// Network Functions
+// Violation Coalescer (per-player, per-category aggregation before sending)
 // ============================================================================
 
 /**
- * Network connection handle.
+ * Longest player UUID plus category, in bytes, that can be merged; longer
+ * keys bypass coalescing.
  */
-typedef struct macac_connection macac_connection_t;
+#define MACAC_COALESCER_MAX_KEY 70
 
 /**
- * Create a TCP connection to the analytics server.
+ * Coalescer handle.
  */
-macac_connection_t* macac_net_connect(const char* host, int port);
+typedef struct macac_coalescer macac_coalescer_t;
 
 /**
- * Send violation data to the server.
- * Data is serialized as JSON.
+ * Coalescer counters snapshot. Records out = summaries + singles + passthrough.
  */
-int macac_net_send_violation(macac_connection_t* conn, 
-                              const char* player_uuid,
-                              const char* category,
-                              double confidence,
-                              double severity,
-                              int64_t timestamp);
+typedef struct {
+    uint64_t accepted;      // Violations added
+    uint64_t merged;        // Added to an open record
+    uint64_t summaries;     // Records closed with two or more violations
+    uint64_t singles;       // Records closed with one violation (sent as a violation)
+    uint64_t passthrough;   // Sent uncoalesced: table full or key too long
+    uint64_t rejected;      // Records or passthroughs the sender dropped
+    uint64_t open;          // Records currently open
+} macac_coalescer_stats_t;
 
 /**
- * Close the connection.
+ * Create a coalescer in front of a sender and start its flush thread.
+ * 
+ * Violations with the same (player_uuid, category) arriving within
+ * window_ms of the first are merged into one record (count, maximum
+ * confidence, mean severity, first and last timestamp). A record is sent
+ * once it is window_ms old, or as soon as it reaches flush_count
+ * violations (0 = no limit). At most max_records are open at once, in
+ * fixed tables allocated here (about 256 bytes per record); violations
+ * that find no room are sent straight through.
+ * 
+ * The sender is not owned and must outlive the coalescer.
  */
-void macac_net_close(macac_connection_t* conn);
+macac_coalescer_t* macac_coalescer_create(macac_sender_t* sender, size_t max_records,
+                                          int window_ms, uint32_t flush_count);
 
 /**
- * Check if connection is alive.
+ * Stop the flush thread, send every open record and free the coalescer.
  */
-int macac_net_is_connected(macac_connection_t* conn);
+void macac_coalescer_destroy(macac_coalescer_t* coalescer);
+
+/**
+ * Add a violation (thread-safe, never blocks on I/O).
+ * Returns 0 if merged or queued, -1 if the sender dropped it.
+ */
+int macac_coalescer_add(macac_coalescer_t* coalescer,
+                        const char* player_uuid,
+                        const char* category,
+                        double confidence,
+                        double severity,
+                        int64_t timestamp);
+
+/**
+ * Send every open record now. Returns the number of records sent.
+ */
+size_t macac_coalescer_flush(macac_coalescer_t* coalescer);
+
+/**
+ * Get a snapshot of the coalescer counters.
+ */
+void macac_coalescer_get_stats(macac_coalescer_t* coalescer, macac_coalescer_stats_t* out);
+
+// ============================================================================
+// Movement Prediction (batched physics step)
+// ============================================================================
+
+// Input columns; column c of player i is in[c * stride + i]
+#define MACAC_MOVE_VX 0                 // Velocity the step starts from (blocks/tick)
+#define MACAC_MOVE_VY 1
+#define MACAC_MOVE_VZ 2
+#define MACAC_MOVE_DX 3                 // Observed movement this tick
+#define MACAC_MOVE_DY 4
+#define MACAC_MOVE_DZ 5
+#define MACAC_MOVE_GROUND 6             // Nonzero if supported: no vertical motion expected
+#define MACAC_MOVE_FRICTION 7           // Horizontal velocity multiplier per tick
+#define MACAC_MOVE_GRAVITY 8            // Subtracted from vertical velocity per tick
+#define MACAC_MOVE_DRAG 9               // Vertical velocity multiplier after gravity
+#define MACAC_MOVE_INPUT_COLUMNS 10
+
+// Output columns, same stride
+#define MACAC_MOVE_PREDICTED_X 0        // Expected movement this tick
+#define MACAC_MOVE_PREDICTED_Y 1
+#define MACAC_MOVE_PREDICTED_Z 2
+#define MACAC_MOVE_DRIFT_X 3            // Observed minus expected
+#define MACAC_MOVE_DRIFT_Y 4
+#define MACAC_MOVE_DRIFT_Z 5
+#define MACAC_MOVE_DRIFT 6              // Length of the drift vector
+#define MACAC_MOVE_OUTPUT_COLUMNS 7
+
+/**
+ * Advance count players one physics tick and compare with what they did:
+ *   predicted_x = vx * friction, predicted_z = vz * friction
+ *   predicted_y = ground ? 0 : (vy - gravity) * drag
+ *   drift = observed - predicted, plus its length
+ * in holds MACAC_MOVE_INPUT_COLUMNS columns and out MACAC_MOVE_OUTPUT_COLUMNS,
+ * each stride doubles apart (stride >= count; a multiple of 8 keeps every
+ * column 64-byte aligned when the buffer is). Every ISA uses separate
+ * mul/add and a correctly rounded sqrt, so results match the formula
+ * evaluated in plain double arithmetic bit for bit (Java included).
+ * in and out must not overlap. Returns count, or 0 on invalid arguments.
+ */
+size_t macac_movement_predict_batch(const double* in, size_t count, size_t stride, double* out);
 
 // ============================================================================
 // Combat Analysis Functions
@@ -178,6 +1357,25 @@ double macac_distance_horizontal(double x1, double z1, double x2, double z2);
  */
 void macac_batch_distance_3d(const double* coords, double* distances, size_t count);
 
+/**
+ * Batch calculate distances from structure-of-arrays input:
+ * distances[i] = |(bx,by,bz)[i] - (ax,ay,az)[i]|.
+ * Uses aligned loads when every array is aligned to the vector width
+ * (64 bytes covers every ISA) and FMA on AVX2/AVX-512/NEON, so results
+ * may differ from macac_distance_3d in the last bit.
+ */
+void macac_batch_distance_3d_soa(const double* ax, const double* ay, const double* az,
+                                 const double* bx, const double* by, const double* bz,
+                                 double* distances, size_t count);
+
+/**
+ * Single-precision macac_batch_distance_3d_soa (4/8/16 lanes on
+ * SSE2/AVX2/AVX-512). Enough for block coordinates in reach checks.
+ */
+void macac_batch_distance_3d_soa_f32(const float* ax, const float* ay, const float* az,
+                                     const float* bx, const float* by, const float* bz,
+                                     float* distances, size_t count);
+
 /**
  * Calculate yaw angle from direction vector.
  */
@@ -208,7 +1406,30 @@ double macac_calc_snap_angle(double prev_yaw, double prev_pitch,
                              double curr_yaw, double curr_pitch);
 
 /**
- * Combat analysis results structure.
+ * Worst-case deviation of the batch aim kernels' angles from libm atan2,
+ * in degrees (polynomial atan2; measured about 3.3e-7 per angle and 4.7e-7
+ * on the combined error).
+ */
+#define MACAC_ATAN2_MAX_ERROR_DEG 1e-6
+
+/**
+ * Expected yaw/pitch and aim error from one attacker to many targets.
+ * Targets are SoA columns (center mass, like macac_calc_aim_angles);
+ * dispatched to 2/4/8-lane SSE2/AVX2/AVX-512 kernels or NEON. Any output
+ * array may be null.
+ * 
+ * @return Index of the target with the smallest aim error (lowest index on
+ *         ties), or -1 if count is 0 or no error is a number
+ */
+int64_t macac_batch_aim_error(double attacker_x, double attacker_y, double attacker_z,
+                              double actual_yaw, double actual_pitch,
+                              const double* target_x, const double* target_y, const double* target_z,
+                              size_t count, double* out_yaw, double* out_pitch, double* out_error);
+
+/**
+ * Combat analysis results structure. The spectral fields summarize the
+ * newest attack intervals (macac_spectral_analyze) and are 0 when fewer
+ * than MACAC_SPECTRAL_MIN_WINDOW intervals have any spread.
  */
 typedef struct {
     double aimbot_confidence;
@@ -221,6 +1442,9 @@ typedef struct {
     double avg_reach;
     double hit_rate;
     double avg_attack_interval;
+    double spectral_entropy;        // of attack intervals (macac_spectral_t), 0 if too few
+    double spectral_peak;           // peak_power of attack intervals
+    double interval_autocorr;       // autocorr_peak of attack intervals
 } macac_combat_analysis_t;
 
 /**
@@ -231,8 +1455,353 @@ void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
                           const double* hits, size_t count,
                           macac_combat_analysis_t* result);
 
+/**
+ * Packed batch layout for macac_analyze_combat_batch (player-major, doubles).
+ * 
+ * Each player record is MACAC_COMBAT_BATCH_STRIDE(window) doubles:
+ *   [0]                          sample count (<= window)
+ *   [1..3]                       reserved (keeps columns 32-byte aligned)
+ *   [HEADER + 0*window ...]      aim_errors[window]
+ *   [HEADER + 1*window ...]      snap_angles[window]
+ *   [HEADER + 2*window ...]      reaches[window]
+ *   [HEADER + 3*window ...]      attack_intervals[window]
+ *   [HEADER + 4*window ...]      hits[window]
+ * 
+ * Only the first `count` entries of each column are read.
+ */
+#define MACAC_COMBAT_BATCH_HEADER 4
+#define MACAC_COMBAT_BATCH_COLUMNS 5
+#define MACAC_COMBAT_BATCH_STRIDE(window) \
+    (MACAC_COMBAT_BATCH_HEADER + MACAC_COMBAT_BATCH_COLUMNS * (window))
+
+/**
+ * Analyze combat data for many players in one call.
+ * Writes one macac_combat_analysis_t per player into results.
+ * Returns number of records written.
+ */
+size_t macac_analyze_combat_batch(const double* packed, size_t player_count, size_t window,
+                                  macac_combat_analysis_t* results);
+
+/**
+ * Column indices for the combat columns (batch layout and accumulator).
+ */
+#define MACAC_COMBAT_AIM_ERROR 0
+#define MACAC_COMBAT_SNAP_ANGLE 1
+#define MACAC_COMBAT_REACH 2
+#define MACAC_COMBAT_ATTACK_INTERVAL 3
+#define MACAC_COMBAT_HIT 4
+
+/**
+ * Incremental per-player combat accumulator (opaque).
+ * 
+ * One tracked ring buffer per combat column: each push updates that
+ * column's running mean/variance/min/max in amortized O(1), so analysis
+ * reads the accumulators instead of rescanning the windows. Columns fill
+ * independently (e.g. aim error only on hits). Single writer.
+ */
+typedef struct macac_combat_accum macac_combat_accum_t;
+
+/**
+ * Create an accumulator with window samples per column.
+ */
+macac_combat_accum_t* macac_combat_accum_create(size_t window);
+
+/**
+ * Destroy an accumulator.
+ */
+void macac_combat_accum_destroy(macac_combat_accum_t* acc);
+
+/**
+ * Push one sample onto a column (MACAC_COMBAT_*). Invalid columns are ignored.
+ */
+void macac_combat_accum_push(macac_combat_accum_t* acc, int column, double value);
+
+/**
+ * Number of samples in a column's window.
+ */
+size_t macac_combat_accum_size(macac_combat_accum_t* acc, int column);
+
+/**
+ * Running moments of one column (zeroed if empty or invalid).
+ */
+void macac_combat_accum_moments(macac_combat_accum_t* acc, int column, macac_moments_t* out);
+
+/**
+ * Clear every column.
+ */
+void macac_combat_accum_clear(macac_combat_accum_t* acc);
+
+/**
+ * Analyze from the running accumulators in O(1); same scoring as
+ * macac_analyze_combat. Zeroes result while any column has fewer than 5 samples.
+ */
+void macac_combat_accum_analyze(macac_combat_accum_t* acc, macac_combat_analysis_t* result);
+
+// ============================================================================
+// Spatial Index (per-world entity positions)
+// ============================================================================
+
+/**
+ * Uniform hash grid over entity positions (opaque).
+ * 
+ * Rebuilt in bulk from a packed position buffer, normally once per tick,
+ * into preallocated arrays (no allocation after create). Queries only read
+ * the index: any number of threads may query concurrently, but not while
+ * macac_spatial_update runs. One index per world.
+ */
+typedef struct macac_spatial macac_spatial_t;
+
+/**
+ * Default cell edge in blocks (one chunk section).
+ */
+#define MACAC_SPATIAL_DEFAULT_CELL 16.0
+
+/**
+ * One entity in the packed position buffer. Fixed layout so Java can
+ * write it straight into a direct ByteBuffer at these offsets.
+ */
+typedef struct {
+    int64_t id;             // 0: caller-chosen id (e.g. entity id), returned by queries
+    double x;               // 8: position tested by queries (e.g. hitbox center)
+    double y;               // 16
+    double z;               // 24
+} macac_spatial_entry_t;
+
+#define MACAC_SPATIAL_ENTRY_SIZE 32
+
+/**
+ * One radius or look-cone query, same fixed-layout rules.
+ * Radius queries ignore yaw, pitch and half_angle.
+ */
+typedef struct {
+    double x;               // 0: origin (eye position for look cones)
+    double y;               // 8
+    double z;               // 16
+    double yaw;             // 24: look direction in degrees, Minecraft convention
+    double pitch;           // 32
+    double range;           // 40: maximum distance in blocks
+    double half_angle;      // 48: cone half-angle in degrees, clamped to [0, 180]
+    int64_t exclude_id;     // 56: id skipped by the query (the querying player)
+} macac_spatial_query_t;
+
+#define MACAC_SPATIAL_QUERY_SIZE 64
+
+/**
+ * Create an index with room for max_entities positions.
+ * cell_size <= 0 selects MACAC_SPATIAL_DEFAULT_CELL.
+ */
+macac_spatial_t* macac_spatial_create(size_t max_entities, double cell_size);
+
+/**
+ * Destroy an index.
+ */
+void macac_spatial_destroy(macac_spatial_t* index);
+
+/**
+ * Replace the indexed positions with entries (counting sort into grid
+ * cells, O(count)). Entries beyond max_entities and entries with a
+ * non-finite coordinate are dropped.
+ * 
+ * @return Number of entities indexed
+ */
+size_t macac_spatial_update(macac_spatial_t* index, const macac_spatial_entry_t* entries, size_t count);
+
+/**
+ * Number of entities currently indexed.
+ */
+size_t macac_spatial_size(macac_spatial_t* index);
+
+/**
+ * Answer count radius queries: entities within range of each origin.
+ * 
+ * Query i writes up to cap results, nearest first, to out_ids[i * cap]
+ * and (if not null) out_dist[i * cap], and its result count to
+ * out_counts[i] (if not null). When more than cap entities match, the
+ * nearest cap are kept.
+ * 
+ * @return Total results written across all queries
+ */
+size_t macac_spatial_query_radius(const macac_spatial_t* index, const macac_spatial_query_t* queries,
+                                  size_t count, size_t cap, int64_t* out_ids, double* out_dist,
+                                  uint32_t* out_counts);
+
+/**
+ * Answer count look-cone queries: entities within range of each origin
+ * whose direction lies within half_angle of the look vector. Output
+ * layout and ordering as macac_spatial_query_radius.
+ * 
+ * @return Total results written across all queries
+ */
+size_t macac_spatial_query_cone(const macac_spatial_t* index, const macac_spatial_query_t* queries,
+                                size_t count, size_t cap, int64_t* out_ids, double* out_dist,
+                                uint32_t* out_counts);
+
+// ============================================================================
+// Position History (lag-compensated entity positions)
+// ============================================================================
+
+/**
+ * Per-entity rings of timestamped positions and bounding boxes (opaque).
+ * 
+ * Entities are looked up by id; each keeps its last `window` samples in
+ * time order, so a position at any time T is a binary search plus a lerp.
+ * All storage is preallocated. Not thread-safe: record, remove, prune and
+ * queries must not run concurrently.
+ */
+typedef struct macac_position_history macac_position_history_t;
+
+/**
+ * One timestamped position. Fixed layout so Java can write it straight
+ * into a direct ByteBuffer. The bounding box is width x height x width,
+ * centered on x/z and standing on y (Minecraft entity convention).
+ */
+typedef struct {
+    int64_t id;             // 0: entity id
+    int64_t nano_time;      // 8: macac_nanotime() of the sample
+    double x;               // 16: feet position
+    double y;               // 24
+    double z;               // 32
+    float width;            // 40
+    float height;           // 44
+} macac_position_sample_t;
+
+#define MACAC_POSITION_SAMPLE_SIZE 48
+
+/**
+ * Create a history for up to max_entities entities of window samples each.
+ */
+macac_position_history_t* macac_poshist_create(size_t max_entities, size_t window);
+
+/**
+ * Destroy a history.
+ */
+void macac_poshist_destroy(macac_position_history_t* hist);
+
+/**
+ * Append samples (normally every tracked entity once per tick). Unknown ids
+ * get a slot while one is free. A sample not newer than its entity's latest
+ * replaces the latest if the times are equal and is dropped otherwise.
+ * 
+ * @return Number of samples stored
+ */
+size_t macac_poshist_record(macac_position_history_t* hist, const macac_position_sample_t* samples,
+                            size_t count);
+
+/**
+ * Forget an entity and free its slot. Unknown ids are ignored.
+ */
+void macac_poshist_remove(macac_position_history_t* hist, int64_t id);
+
+/**
+ * Forget every entity whose latest sample is older than nano_time
+ * (despawned or unloaded without a remove). Returns entities removed.
+ */
+size_t macac_poshist_prune(macac_position_history_t* hist, int64_t nano_time);
+
+/**
+ * Number of tracked entities.
+ */
+size_t macac_poshist_size(macac_position_history_t* hist);
+
+/**
+ * Position of an entity at nano_time, linearly interpolated between the
+ * two samples around it. Times outside the history clamp to the oldest or
+ * newest sample; out->nano_time is the time actually used.
+ * 
+ * @return 0 if interpolated, 1 if clamped, -1 if the id is unknown
+ *         (out is then filled with NaN coordinates)
+ */
+int macac_poshist_at(const macac_position_history_t* hist, int64_t id, int64_t nano_time,
+                     macac_position_sample_t* out);
+
+/**
+ * Rewind count entities to nano_time (macac_poshist_at for each id).
+ * out[i] receives ids[i]'s position; unknown ids get NaN coordinates.
+ * 
+ * @return Number of ids found
+ */
+size_t macac_poshist_rewind(const macac_position_history_t* hist, const int64_t* ids, size_t count,
+                            int64_t nano_time, macac_position_sample_t* out);
+
+/**
+ * Lag-compensated reach: distance from (eye_x, eye_y, eye_z) to the
+ * nearest point of the entity's bounding box at nano_time (0 inside it).
+ * 
+ * @return Distance in blocks, or NaN if the id is unknown
+ */
+double macac_poshist_reach(const macac_position_history_t* hist, int64_t id, int64_t nano_time,
+                           double eye_x, double eye_y, double eye_z);
+
+// ============================================================================
+// Spectral Analysis (periodic structure in interval series)
+// ============================================================================
+
+/**
+ * Window limits for macac_spectral_analyze. The newest power-of-two run of
+ * samples (at most MACAC_SPECTRAL_MAX_WINDOW) is analysed.
+ */
+#define MACAC_SPECTRAL_MIN_WINDOW 32
+#define MACAC_SPECTRAL_MAX_WINDOW 256
+
+/**
+ * Spectrum and autocorrelation summary of one window (all doubles, so
+ * the JNI bridge copies it as MACAC_SPECTRAL_FIELDS values).
+ * 
+ * Power is taken over the mean-removed window's DFT bins 1..n/2. Entropy
+ * is the Shannon entropy of that power distribution divided by log(n/2):
+ * near 1 for white jitter, near 0 when one frequency dominates.
+ * Autocorrelation is the linear (zero-padded) estimate r[lag] / r[0].
+ */
+typedef struct {
+    double window;              // samples analysed (n)
+    double entropy;             // normalized spectral entropy [0, 1]
+    double peak_power;          // share of AC power in the strongest bin
+    double peak_frequency;      // strongest bin in cycles per sample (k / n)
+    double autocorr_peak;       // max r[lag] / r[0] over lags 1..n/2
+    double autocorr_lag;        // lag of autocorr_peak
+} macac_spectral_t;
+
+#define MACAC_SPECTRAL_FIELDS 6
+
+/**
+ * Build the FFT twiddle and bit-reversal tables. Called by the JNI init;
+ * analysis builds them on first use otherwise. Idempotent, thread-safe.
+ */
+void macac_spectral_init(void);
+
+/**
+ * Analyse the newest n values of data, where n is the largest power of two
+ * <= min(count, MACAC_SPECTRAL_MAX_WINDOW). Real FFT of the zero-padded
+ * window through the active SIMD kernels; O(n log n), no allocation.
+ * 
+ * @return 0 on success; -1 (out zeroed) if n < MACAC_SPECTRAL_MIN_WINDOW,
+ *         a value is not finite or the window has no spread
+ */
+int macac_spectral_analyze(const double* data, size_t count, macac_spectral_t* out);
+
+/**
+ * macac_spectral_analyze over a ring of count values whose oldest value is
+ * at index oldest (e.g. a full rolling window read in place).
+ */
+int macac_spectral_analyze_ring(const double* ring, size_t count, size_t oldest, macac_spectral_t* out);
+
 #ifdef __cplusplus
 }
+
+/**
+ * Times the enclosing scope against a site:
+ *     macac_perf_scope scope(site);
+ */
+struct macac_perf_scope {
+    int site;
+    uint64_t begin;
+    
+    explicit macac_perf_scope(int s) : site(s), begin(macac_perf_begin()) {}
+    ~macac_perf_scope() { macac_perf_end(site, begin); }
+    
+    macac_perf_scope(const macac_perf_scope&) = delete;
+    macac_perf_scope& operator=(const macac_perf_scope&) = delete;
+};
 #endif
 
 #endif // MACAC_NATIVE_H
@@ -0,0 +1,369 @@
+/*
+ * MacAC Native Library - Telemetry Capture
+ * 
+ * Records movement and combat samples to rotating binary files for
+ * offline replay (tools/macac_replay.cpp, CaptureReplay in Java).
+ * 
+ * Producers copy a fixed-size record into a bounded MPSC ring (Vyukov
+ * sequence cells, as in packet_queue.cpp): one CAS and a memcpy, no lock
+ * and no syscall. A background thread drains the ring into a large block
+ * buffer and writes it out with one write() per block. The writer never
+ * wakes producers and producers never wake the writer: it polls every
+ * few milliseconds, and the ring is sized to absorb that gap.
+ */
+
+#include "macac_native.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Largest record type
+#define CAPTURE_MAX_RECORD MACAC_CAPTURE_COMBAT_SIZE
+
+// Writer block size and idle poll interval
+#define CAPTURE_BLOCK_BYTES (256 * 1024)
+#define CAPTURE_IDLE_MS 5
+
+#define CAPTURE_MAX_CAPACITY (1u << 22)
+#define CAPTURE_PREFIX_MAX 512
+#define CAPTURE_MIN_FILE_BYTES (64 * 1024)
+
+static_assert(sizeof(macac_capture_header_t) == 64, "capture header layout");
+static_assert(sizeof(macac_capture_telemetry_t) == MACAC_CAPTURE_TELEMETRY_SIZE, "telemetry record layout");
+static_assert(sizeof(macac_capture_combat_t) == MACAC_CAPTURE_COMBAT_SIZE, "combat record layout");
+
+struct capture_cell {
+    std::atomic<size_t> sequence;
+    alignas(8) uint8_t record[CAPTURE_MAX_RECORD];
+};
+
+struct macac_capture {
+    capture_cell* cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;    // Writer thread only
+    alignas(64) std::atomic<bool> stopping;
+    
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> files;
+    std::atomic<uint64_t> errors;
+    
+    // Writer thread state
+    std::thread thread;
+    char prefix[CAPTURE_PREFIX_MAX];
+    int64_t session;            // Unix seconds at open, part of every file name
+    uint64_t max_file_bytes;
+    uint32_t max_files;
+    uint32_t file_index;
+    int fd;
+    uint64_t file_bytes;
+    uint8_t* block;
+    size_t block_used;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static size_t round_up_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static void capture_path(const macac_capture_t* c, uint32_t index, char* out, size_t len) {
+    snprintf(out, len, "%s-%lld-%04u.mcap", c->prefix, (long long)c->session, index);
+}
+
+static bool write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * Close the current file (if any) and start the next one in the rotation,
+ * deleting the file that falls out of the max_files window.
+ */
+static bool capture_rotate(macac_capture_t* c) {
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+        c->file_index++;
+    }
+    
+    char path[CAPTURE_PREFIX_MAX + 64];
+    if (c->max_files > 0 && c->file_index >= c->max_files) {
+        capture_path(c, c->file_index - c->max_files, path, sizeof(path));
+        unlink(path);
+    }
+    
+    capture_path(c, c->file_index, path, sizeof(path));
+    c->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (c->fd < 0) {
+        return false;
+    }
+    
+    macac_capture_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MACAC_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = MACAC_CAPTURE_VERSION;
+    header.header_bytes = sizeof(header);
+    header.start_nanos = macac_nanotime();
+    header.start_unix_ms = (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header.file_index = c->file_index;
+    
+    if (!write_all(c->fd, (const uint8_t*)&header, sizeof(header))) {
+        close(c->fd);
+        c->fd = -1;
+        return false;
+    }
+    c->file_bytes = sizeof(header);
+    c->bytes.fetch_add(sizeof(header), std::memory_order_relaxed);
+    c->files.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Write the block buffer to the current file.
+ */
+static void capture_flush(macac_capture_t* c) {
+    if (c->block_used == 0) {
+        return;
+    }
+    if (c->fd >= 0 && write_all(c->fd, c->block, c->block_used)) {
+        c->file_bytes += c->block_used;
+        c->bytes.fetch_add(c->block_used, std::memory_order_relaxed);
+    } else {
+        c->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    c->block_used = 0;
+}
+
+/**
+ * Append one record to the block, flushing and rotating as needed.
+ */
+static void capture_append(macac_capture_t* c, const uint8_t* record) {
+    uint16_t size;
+    memcpy(&size, record + 2, sizeof(size));
+    
+    if (c->file_bytes + c->block_used + size > c->max_file_bytes) {
+        capture_flush(c);
+        if (!capture_rotate(c)) {
+            c->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (c->block_used + size > CAPTURE_BLOCK_BYTES) {
+        capture_flush(c);
+    }
+    
+    memcpy(c->block + c->block_used, record, size);
+    c->block_used += size;
+    c->records.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Move every published record into the block. Returns the number moved.
+ */
+static size_t capture_drain(macac_capture_t* c) {
+    size_t pos = c->dequeue_pos.load(std::memory_order_relaxed);
+    size_t moved = 0;
+    
+    for (;;) {
+        capture_cell* cell = &c->cells[pos & c->mask];
+        if (cell->sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+        capture_append(c, cell->record);
+        cell->sequence.store(pos + c->mask + 1, std::memory_order_release);
+        pos++;
+        moved++;
+    }
+    
+    c->dequeue_pos.store(pos, std::memory_order_relaxed);
+    return moved;
+}
+
+static void capture_run(macac_capture_t* c) {
+    for (;;) {
+        bool stopping = c->stopping.load(std::memory_order_acquire);
+        size_t moved = capture_drain(c);
+        
+        // Write partial blocks only when caught up, so bursts go out in
+        // full blocks and a quiet server still reaches disk within a poll
+        if (moved == 0) {
+            capture_flush(c);
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(CAPTURE_IDLE_MS));
+        }
+    }
+}
+
+/**
+ * Copy a record into the ring. Returns 0 if queued, -1 if full.
+ */
+static int capture_push(macac_capture_t* c, const void* record, size_t size) {
+    if (c->stopping.load(std::memory_order_relaxed)) {
+        c->dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    
+    size_t pos = c->enqueue_pos.load(std::memory_order_relaxed);
+    capture_cell* cell;
+    for (;;) {
+        cell = &c->cells[pos & c->mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (c->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            c->dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        } else {
+            pos = c->enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    
+    memcpy(cell->record, record, size);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return 0;
+}
+
+static void capture_free(macac_capture_t* c) {
+    if (c->fd >= 0) {
+        close(c->fd);
+    }
+    delete[] c->cells;
+    delete[] c->block;
+    delete c;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+macac_capture_t* macac_capture_open(const char* prefix, size_t capacity,
+                                    uint64_t max_file_bytes, uint32_t max_files) {
+    if (!prefix || !prefix[0] || strlen(prefix) >= CAPTURE_PREFIX_MAX ||
+        capacity == 0 || capacity > CAPTURE_MAX_CAPACITY) {
+        return nullptr;
+    }
+    
+    macac_capture_t* c = new (std::nothrow) macac_capture_t();
+    if (!c) {
+        return nullptr;
+    }
+    
+    strcpy(c->prefix, prefix);
+    c->session = (int64_t)time(nullptr);
+    c->max_file_bytes = max_file_bytes > CAPTURE_MIN_FILE_BYTES ? max_file_bytes : CAPTURE_MIN_FILE_BYTES;
+    c->max_files = max_files;
+    c->fd = -1;
+    
+    size_t cells = round_up_pow2(capacity);
+    c->mask = cells - 1;
+    c->cells = new (std::nothrow) capture_cell[cells];
+    c->block = new (std::nothrow) uint8_t[CAPTURE_BLOCK_BYTES];
+    if (!c->cells || !c->block) {
+        capture_free(c);
+        return nullptr;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        c->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    // Fail here, on the caller's thread, rather than dropping silently later
+    if (!capture_rotate(c)) {
+        capture_free(c);
+        return nullptr;
+    }
+    
+    try {
+        c->thread = std::thread(capture_run, c);
+    } catch (...) {
+        capture_free(c);
+        return nullptr;
+    }
+    return c;
+}
+
+void macac_capture_close(macac_capture_t* capture) {
+    if (!capture) {
+        return;
+    }
+    
+    capture->stopping.store(true, std::memory_order_release);
+    if (capture->thread.joinable()) {
+        capture->thread.join();
+    }
+    capture_free(capture);
+}
+
+int macac_capture_telemetry(macac_capture_t* capture, uint64_t player_hi, uint64_t player_lo,
+                            const macac_telemetry_record_t* record) {
+    if (!capture || !record) {
+        return -1;
+    }
+    
+    macac_capture_telemetry_t out;
+    out.type = MACAC_CAPTURE_TELEMETRY;
+    out.size = MACAC_CAPTURE_TELEMETRY_SIZE;
+    out.reserved = 0;
+    out.player_hi = player_hi;
+    out.player_lo = player_lo;
+    out.telemetry = *record;
+    return capture_push(capture, &out, sizeof(out));
+}
+
+int macac_capture_combat(macac_capture_t* capture, const macac_capture_combat_t* record) {
+    if (!capture || !record) {
+        return -1;
+    }
+    
+    macac_capture_combat_t out = *record;
+    out.type = MACAC_CAPTURE_COMBAT;
+    out.size = MACAC_CAPTURE_COMBAT_SIZE;
+    return capture_push(capture, &out, sizeof(out));
+}
+
+void macac_capture_get_stats(macac_capture_t* capture, macac_capture_stats_t* out) {
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!capture) {
+        return;
+    }
+    
+    out->records = capture->records.load(std::memory_order_relaxed);
+    out->dropped = capture->dropped.load(std::memory_order_relaxed);
+    out->bytes = capture->bytes.load(std::memory_order_relaxed);
+    out->files = capture->files.load(std::memory_order_relaxed);
+    out->errors = capture->errors.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
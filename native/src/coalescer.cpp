@@ -0,0 +1,418 @@
+/*
+ * MacAC Native Library - Violation Coalescer
+ * 
+ * Sits in front of a macac_sender_t and merges the bursts of near-identical
+ * reports one player produces for one category into summary records, so
+ * the analytics link carries one record per (player, category) per window
+ * instead of one per violation.
+ * 
+ * Layout:
+ *   stripes  COALESCER_STRIPES independently locked tables, picked by the
+ *            top bits of the key hash so producers rarely contend
+ *   table    open addressing per stripe (linear probing, backward-shift
+ *            deletion), at least twice a stripe's share of max_records
+ * 
+ * Memory is fixed at create, 128 bytes per cell. A stripe may fill to 3/4
+ * of its cells, so an uneven spread of keys does not strand the budget;
+ * max_records bounds the total. A flush thread sweeps the tables
+ * every quarter window and sends records that have aged out; records that
+ * hit flush_count are sent by the producer that filled them.
+ */
+
+#include "macac_native.h"
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <new>
+
+// Independently locked tables (power of two)
+#define COALESCER_STRIPES 8
+#define COALESCER_STRIPE_SHIFT 61
+
+// Sweep period bounds; the period is a quarter of the window
+#define COALESCER_MIN_TICK_MS 10
+#define COALESCER_MAX_TICK_MS 1000
+
+/**
+ * One open record. count == 0 marks a free cell. The key is the UUID and
+ * the category, each NUL-terminated, so both can be passed to the sender
+ * as they are.
+ */
+struct coalescer_entry {
+    uint64_t hash;
+    int64_t opened_ms;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    double max_confidence;
+    double severity_sum;
+    uint32_t count;
+    uint8_t uuid_len;
+    uint8_t category_len;
+    char key[MACAC_COALESCER_MAX_KEY + 2];
+};
+
+static_assert(sizeof(coalescer_entry) == 128, "two cache lines per cell");
+
+/**
+ * One locked table. Counters live here, under the lock the add already
+ * holds, rather than as shared atomics every producer would bounce.
+ */
+struct coalescer_stripe {
+    alignas(64) std::mutex lock;
+    coalescer_entry* cells;
+    size_t mask;
+    size_t open;
+    uint64_t opened;
+    uint64_t merged;
+    uint64_t summaries;
+    uint64_t singles;
+    uint64_t rejected;
+};
+
+struct macac_coalescer {
+    macac_sender_t* sender;
+    int window_ms;
+    uint32_t flush_count;
+    uint64_t max_records;
+    size_t stripe_limit;        // Open records a stripe may hold
+    
+    coalescer_stripe stripes[COALESCER_STRIPES];
+    
+    std::atomic<uint64_t> open;             // Records claimed across stripes
+    std::atomic<uint64_t> passthrough;
+    std::atomic<uint64_t> passthrough_rejected;
+    
+    // Flush thread
+    std::thread thread;
+    std::mutex wait_lock;
+    std::condition_variable wait_cv;
+    bool stopping;              // Guarded by wait_lock
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static inline int64_t coalescer_now_ms(void) {
+    return macac_nanotime() / 1000000;
+}
+
+/**
+ * Fold bytes into a hash eight at a time (the key is hashed on every add,
+ * and a byte-serial FNV over a 36-character UUID dominated the lookup).
+ */
+static inline uint64_t hash_bytes(uint64_t hash, const char* p, size_t len) {
+    const uint64_t K = 0x9E3779B97F4A7C15ULL;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        hash = (hash ^ w) * K;
+        hash ^= hash >> 32;
+    }
+    
+    // Tail byte by byte; a variable-length memcpy would be a library call
+    uint64_t w = 0;
+    for (size_t i = 0; i < len; i++) {
+        w |= (uint64_t)(uint8_t)p[i] << (8 * i);
+    }
+    hash = (hash ^ w ^ ((uint64_t)len << 56)) * K;
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * Hash of (UUID, category); the top bits pick the stripe, the low bits the
+ * home cell.
+ */
+static uint64_t key_hash(const char* uuid, size_t uuid_len, const char* category, size_t category_len) {
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ULL, uuid, uuid_len);
+    hash = hash_bytes(hash, category, category_len);
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    return hash ^ (hash >> 31);
+}
+
+static inline bool key_equals(const coalescer_entry* e, uint64_t hash, const char* uuid, size_t uuid_len,
+                              const char* category, size_t category_len) {
+    return e->hash == hash && e->uuid_len == uuid_len && e->category_len == category_len &&
+           memcmp(e->key, uuid, uuid_len) == 0 &&
+           memcmp(e->key + uuid_len + 1, category, category_len) == 0;
+}
+
+/**
+ * Hand a closed record to the sender. A record of one violation goes out
+ * as that violation.
+ */
+static void emit(macac_coalescer_t* c, coalescer_stripe* st, const coalescer_entry* e) {
+    const char* uuid = e->key;
+    const char* category = e->key + e->uuid_len + 1;
+    int rc = macac_sender_send_summary(c->sender, uuid, category, e->count, e->max_confidence,
+                                       e->severity_sum / (double)e->count,
+                                       e->first_timestamp, e->last_timestamp);
+    (e->count == 1 ? st->singles : st->summaries)++;
+    st->rejected += rc != 0;
+}
+
+/**
+ * Free cell i of a stripe, shifting later cells of its probe run back so
+ * lookups never stop early. Caller holds the stripe lock.
+ */
+static void erase_cell(macac_coalescer_t* c, coalescer_stripe* st, size_t i) {
+    st->open--;
+    c->open.fetch_sub(1, std::memory_order_relaxed);
+    
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & st->mask;
+        if (st->cells[j].count == 0) {
+            break;
+        }
+        
+        // Move j into the hole unless its home lies cyclically in (i, j]
+        size_t k = st->cells[j].hash & st->mask;
+        bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            st->cells[i] = st->cells[j];
+            i = j;
+        }
+    }
+    st->cells[i].count = 0;
+}
+
+/**
+ * Send and free every record of a stripe opened at or before cutoff_ms.
+ * A cell is re-examined after an erase, since a later record may have
+ * shifted into it. Caller holds the stripe lock.
+ */
+static size_t sweep_stripe(macac_coalescer_t* c, coalescer_stripe* st, int64_t cutoff_ms) {
+    size_t sent = 0;
+    size_t i = 0;
+    while (i <= st->mask && st->open > 0) {
+        coalescer_entry* e = &st->cells[i];
+        if (e->count != 0 && e->opened_ms <= cutoff_ms) {
+            emit(c, st, e);
+            erase_cell(c, st, i);
+            sent++;
+            continue;
+        }
+        i++;
+    }
+    return sent;
+}
+
+static size_t sweep(macac_coalescer_t* c, int64_t cutoff_ms) {
+    size_t sent = 0;
+    for (size_t s = 0; s < COALESCER_STRIPES; s++) {
+        coalescer_stripe* st = &c->stripes[s];
+        std::lock_guard<std::mutex> guard(st->lock);
+        if (st->open > 0) {
+            sent += sweep_stripe(c, st, cutoff_ms);
+        }
+    }
+    return sent;
+}
+
+/**
+ * Flush thread: send records once they are a window old.
+ */
+static void coalescer_run(macac_coalescer_t* c) {
+    int tick_ms = c->window_ms / 4;
+    tick_ms = tick_ms < COALESCER_MIN_TICK_MS ? COALESCER_MIN_TICK_MS
+            : (tick_ms > COALESCER_MAX_TICK_MS ? COALESCER_MAX_TICK_MS : tick_ms);
+    
+    std::unique_lock<std::mutex> lock(c->wait_lock);
+    while (!c->stopping) {
+        c->wait_cv.wait_for(lock, std::chrono::milliseconds(tick_ms));
+        if (c->stopping) {
+            break;
+        }
+        lock.unlock();
+        sweep(c, coalescer_now_ms() - c->window_ms);
+        lock.lock();
+    }
+}
+
+static void coalescer_free(macac_coalescer_t* c) {
+    for (size_t s = 0; s < COALESCER_STRIPES; s++) {
+        delete[] c->stripes[s].cells;
+    }
+    delete c;
+}
+
+extern "C" {
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+macac_coalescer_t* macac_coalescer_create(macac_sender_t* sender, size_t max_records,
+                                          int window_ms, uint32_t flush_count) {
+    if (!sender || max_records == 0 || max_records > ((size_t)1 << 30) || window_ms <= 0) {
+        return nullptr;
+    }
+    
+    macac_coalescer_t* c = new (std::nothrow) macac_coalescer_t();
+    if (!c) {
+        return nullptr;
+    }
+    
+    c->sender = sender;
+    c->window_ms = window_ms;
+    c->flush_count = flush_count;
+    c->max_records = max_records;
+    c->stopping = false;
+    
+    size_t share = (max_records + COALESCER_STRIPES - 1) / COALESCER_STRIPES;
+    size_t cells = 8;
+    while (cells < 2 * share) {
+        cells <<= 1;
+    }
+    c->stripe_limit = cells / 4 * 3;
+    for (size_t s = 0; s < COALESCER_STRIPES; s++) {
+        coalescer_stripe* st = &c->stripes[s];
+        st->cells = new (std::nothrow) coalescer_entry[cells]();
+        st->mask = cells - 1;
+        st->open = 0;
+        if (!st->cells) {
+            coalescer_free(c);
+            return nullptr;
+        }
+    }
+    
+    try {
+        c->thread = std::thread(coalescer_run, c);
+    } catch (...) {
+        coalescer_free(c);
+        return nullptr;
+    }
+    return c;
+}
+
+void macac_coalescer_destroy(macac_coalescer_t* coalescer) {
+    if (!coalescer) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> guard(coalescer->wait_lock);
+        coalescer->stopping = true;
+    }
+    coalescer->wait_cv.notify_all();
+    if (coalescer->thread.joinable()) {
+        coalescer->thread.join();
+    }
+    
+    sweep(coalescer, INT64_MAX);
+    coalescer_free(coalescer);
+}
+
+int macac_coalescer_add(macac_coalescer_t* coalescer,
+                        const char* player_uuid,
+                        const char* category,
+                        double confidence,
+                        double severity,
+                        int64_t timestamp) {
+    if (!coalescer || !player_uuid || !category) {
+        return -1;
+    }
+    macac_coalescer_t* c = coalescer;
+    
+    size_t uuid_len = strlen(player_uuid);
+    size_t category_len = strlen(category);
+    if (uuid_len + category_len <= MACAC_COALESCER_MAX_KEY) {
+        uint64_t hash = key_hash(player_uuid, uuid_len, category, category_len);
+        coalescer_stripe* st = &c->stripes[hash >> COALESCER_STRIPE_SHIFT];
+        std::lock_guard<std::mutex> guard(st->lock);
+        
+        size_t i = hash & st->mask;
+        while (st->cells[i].count != 0 &&
+               !key_equals(&st->cells[i], hash, player_uuid, uuid_len, category, category_len)) {
+            i = (i + 1) & st->mask;
+        }
+        coalescer_entry* e = &st->cells[i];
+        
+        if (e->count != 0) {
+            e->count++;
+            e->max_confidence = confidence > e->max_confidence ? confidence : e->max_confidence;
+            e->severity_sum += severity;
+            e->first_timestamp = timestamp < e->first_timestamp ? timestamp : e->first_timestamp;
+            e->last_timestamp = timestamp > e->last_timestamp ? timestamp : e->last_timestamp;
+            st->merged++;
+            if (c->flush_count != 0 && e->count >= c->flush_count) {
+                emit(c, st, e);
+                erase_cell(c, st, i);
+            }
+            return 0;
+        }
+        
+        // Claim a record from the global budget before opening one
+        if (st->open < c->stripe_limit &&
+            c->open.fetch_add(1, std::memory_order_relaxed) < c->max_records) {
+            e->hash = hash;
+            e->opened_ms = coalescer_now_ms();
+            e->first_timestamp = timestamp;
+            e->last_timestamp = timestamp;
+            e->max_confidence = confidence;
+            e->severity_sum = severity;
+            e->count = 1;
+            e->uuid_len = (uint8_t)uuid_len;
+            e->category_len = (uint8_t)category_len;
+            memcpy(e->key, player_uuid, uuid_len + 1);
+            memcpy(e->key + uuid_len + 1, category, category_len + 1);
+            st->open++;
+            st->opened++;
+            
+            if (c->flush_count == 1) {
+                emit(c, st, e);
+                erase_cell(c, st, i);
+            }
+            return 0;
+        }
+        if (st->open < c->stripe_limit) {
+            c->open.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // Out of records or oversized key: report it as it is
+    c->passthrough.fetch_add(1, std::memory_order_relaxed);
+    if (macac_sender_send_violation(c->sender, player_uuid, category, confidence, severity, timestamp) != 0) {
+        c->passthrough_rejected.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    return 0;
+}
+
+size_t macac_coalescer_flush(macac_coalescer_t* coalescer) {
+    if (!coalescer) {
+        return 0;
+    }
+    return sweep(coalescer, INT64_MAX);
+}
+
+void macac_coalescer_get_stats(macac_coalescer_t* coalescer, macac_coalescer_stats_t* out) {
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!coalescer) {
+        return;
+    }
+    
+    for (size_t s = 0; s < COALESCER_STRIPES; s++) {
+        coalescer_stripe* st = &coalescer->stripes[s];
+        std::lock_guard<std::mutex> guard(st->lock);
+        out->accepted += st->opened + st->merged;
+        out->merged += st->merged;
+        out->summaries += st->summaries;
+        out->singles += st->singles;
+        out->rejected += st->rejected;
+        out->open += st->open;
+    }
+    out->passthrough = coalescer->passthrough.load(std::memory_order_relaxed);
+    out->accepted += out->passthrough;
+    out->rejected += coalescer->passthrough_rejected.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
@@ -3,28 +3,22 @@
  * 
  * High-performance combat pattern detection using:
  * - SIMD-optimized angle calculations
- * - Fast distance computations with SSE/AVX
+ * - Fast distance computations (runtime-dispatched SSE2/AVX2/AVX-512/NEON)
  * - Pattern matching for aimbot detection
  * - Statistical analysis of combat data
  */
 
 #include "macac_native.h"
+#include "simd_dispatch.h"
 #include <cmath>
 #include <cstring>
 #include <algorithm>
 
-// Check for SIMD support
-#if defined(__AVX2__)
-#include <immintrin.h>
-#define HAS_AVX2 1
-#elif defined(__SSE4_1__)
+// Only baseline-ISA code is compiled here; wide kernels are dispatched at
+// runtime (simd_dispatch.cpp)
+#if defined(__SSE4_1__)
 #include <smmintrin.h>
 #define HAS_SSE4 1
-#elif defined(__SSE2__)
-#include <emmintrin.h>
-#define HAS_SSE2 1
-#else
-#define HAS_SIMD 0
 #endif
 
 // ============================================================================
@@ -139,78 +133,45 @@ double macac_distance_horizontal(double x1, double z1, double x2, double z2) {
 }
 
 /**
- * Batch calculate distances using AVX2.
+ * Batch calculate distances with the active SIMD kernels.
  * Input: arrays of x1,y1,z1,x2,y2,z2 coordinates
  * Output: array of distances
  */
 void macac_batch_distance_3d(const double* coords, double* distances, size_t count) {
     // coords layout: [x1,y1,z1,x2,y2,z2] per element, total 6 * count
-    
-#if HAS_AVX2
-    // Process 4 distances at a time
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        // Load coordinates for 4 distance calculations
-        __m256d x1 = _mm256_set_pd(
-            coords[(i+3)*6 + 0], coords[(i+2)*6 + 0],
-            coords[(i+1)*6 + 0], coords[(i+0)*6 + 0]
-        );
-        __m256d y1 = _mm256_set_pd(
-            coords[(i+3)*6 + 1], coords[(i+2)*6 + 1],
-            coords[(i+1)*6 + 1], coords[(i+0)*6 + 1]
-        );
-        __m256d z1 = _mm256_set_pd(
-            coords[(i+3)*6 + 2], coords[(i+2)*6 + 2],
-            coords[(i+1)*6 + 2], coords[(i+0)*6 + 2]
-        );
-        __m256d x2 = _mm256_set_pd(
-            coords[(i+3)*6 + 3], coords[(i+2)*6 + 3],
-            coords[(i+1)*6 + 3], coords[(i+0)*6 + 3]
-        );
-        __m256d y2 = _mm256_set_pd(
-            coords[(i+3)*6 + 4], coords[(i+2)*6 + 4],
-            coords[(i+1)*6 + 4], coords[(i+0)*6 + 4]
-        );
-        __m256d z2 = _mm256_set_pd(
-            coords[(i+3)*6 + 5], coords[(i+2)*6 + 5],
-            coords[(i+1)*6 + 5], coords[(i+0)*6 + 5]
-        );
-        
-        // Calculate deltas
-        __m256d dx = _mm256_sub_pd(x2, x1);
-        __m256d dy = _mm256_sub_pd(y2, y1);
-        __m256d dz = _mm256_sub_pd(z2, z1);
-        
-        // Square and sum
-        __m256d dx2 = _mm256_mul_pd(dx, dx);
-        __m256d dy2 = _mm256_mul_pd(dy, dy);
-        __m256d dz2 = _mm256_mul_pd(dz, dz);
-        
-        __m256d sum = _mm256_add_pd(dx2, _mm256_add_pd(dy2, dz2));
-        
-        // Square root
-        __m256d dist = _mm256_sqrt_pd(sum);
-        
-        // Store results
-        _mm256_storeu_pd(&distances[i], dist);
+    if (!coords || !distances || count == 0) {
+        return;
     }
     
-    // Handle remaining elements
-    for (; i < count; i++) {
-        distances[i] = macac_distance_3d(
-            coords[i*6 + 0], coords[i*6 + 1], coords[i*6 + 2],
-            coords[i*6 + 3], coords[i*6 + 4], coords[i*6 + 5]
-        );
+    macac_simd_active()->distance_3d(coords, distances, count);
+}
+
+/**
+ * Batch calculate distances from separate x/y/z arrays.
+ */
+void macac_batch_distance_3d_soa(const double* ax, const double* ay, const double* az,
+                                 const double* bx, const double* by, const double* bz,
+                                 double* distances, size_t count) {
+    if (!ax || !ay || !az || !bx || !by || !bz || !distances || count == 0) {
+        return;
     }
-#else
-    // Scalar fallback
-    for (size_t i = 0; i < count; i++) {
-        distances[i] = macac_distance_3d(
-            coords[i*6 + 0], coords[i*6 + 1], coords[i*6 + 2],
-            coords[i*6 + 3], coords[i*6 + 4], coords[i*6 + 5]
-        );
+    
+    const double* columns[6] = { ax, ay, az, bx, by, bz };
+    macac_simd_active()->distance_3d_soa(columns, distances, count);
+}
+
+/**
+ * Single-precision variant of macac_batch_distance_3d_soa.
+ */
+void macac_batch_distance_3d_soa_f32(const float* ax, const float* ay, const float* az,
+                                     const float* bx, const float* by, const float* bz,
+                                     float* distances, size_t count) {
+    if (!ax || !ay || !az || !bx || !by || !bz || !distances || count == 0) {
+        return;
     }
-#endif
+    
+    const float* columns[6] = { ax, ay, az, bx, by, bz };
+    macac_simd_active()->distance_3d_soa_f32(columns, distances, count);
 }
 
 // ============================================================================
@@ -263,9 +224,7 @@ void macac_calc_aim_angles(double attacker_x, double attacker_y, double attacker
 double macac_calc_aim_error(double actual_yaw, double actual_pitch,
                             double expected_yaw, double expected_pitch) {
     // Normalize yaw difference to [-180, 180]
-    double yaw_diff = actual_yaw - expected_yaw;
-    while (yaw_diff > 180.0) yaw_diff -= 360.0;
-    while (yaw_diff < -180.0) yaw_diff += 360.0;
+    double yaw_diff = macac_wrap_degrees(actual_yaw - expected_yaw);
     
     double pitch_diff = actual_pitch - expected_pitch;
     
@@ -278,54 +237,45 @@ double macac_calc_aim_error(double actual_yaw, double actual_pitch,
  */
 double macac_calc_snap_angle(double prev_yaw, double prev_pitch,
                              double curr_yaw, double curr_pitch) {
-    double yaw_diff = curr_yaw - prev_yaw;
-    while (yaw_diff > 180.0) yaw_diff -= 360.0;
-    while (yaw_diff < -180.0) yaw_diff += 360.0;
+    double yaw_diff = macac_wrap_degrees(curr_yaw - prev_yaw);
     
     double pitch_diff = curr_pitch - prev_pitch;
     
     return sqrt(yaw_diff * yaw_diff + pitch_diff * pitch_diff);
 }
 
+/**
+ * Expected angles and aim error from one attacker to many targets with the
+ * active SIMD kernels.
+ * 
+ * @return Index of the target with the smallest aim error, or -1
+ */
+int64_t macac_batch_aim_error(double attacker_x, double attacker_y, double attacker_z,
+                              double actual_yaw, double actual_pitch,
+                              const double* target_x, const double* target_y, const double* target_z,
+                              size_t count, double* out_yaw, double* out_pitch, double* out_error) {
+    if (!target_x || !target_y || !target_z || count == 0) {
+        return -1;
+    }
+    
+    macac_aim_pose pose = {
+        attacker_x, attacker_y + PLAYER_EYE_HEIGHT, attacker_z, actual_yaw, actual_pitch
+    };
+    const double* targets[3] = { target_x, target_y, target_z };
+    return macac_simd_active()->aim_error(&pose, targets, count, out_yaw, out_pitch, out_error);
+}
+
 // ============================================================================
 // Combat Pattern Analysis
 // ============================================================================
 
 /**
- * Analyze combat data for cheating patterns.
- * 
- * @param aim_errors - Array of aim errors
- * @param snap_angles - Array of snap angles
- * @param reaches - Array of reach distances
- * @param attack_intervals - Array of attack intervals in ms
- * @param hits - Array of hit flags (1.0 = hit, 0.0 = miss)
- * @param count - Number of samples
- * @param result - Output analysis results
+ * Score one player from its window statistics. Shared by the window scan
+ * and the incremental accumulator.
  */
-void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
-                          const double* reaches, const double* attack_intervals,
-                          const double* hits, size_t count,
-                          macac_combat_analysis_t* result) {
-    if (!result || count < 5) {
-        if (result) memset(result, 0, sizeof(macac_combat_analysis_t));
-        return;
-    }
-    
-    // Validate all input pointers
-    if (!aim_errors || !snap_angles || !reaches || !attack_intervals || !hits) {
-        memset(result, 0, sizeof(macac_combat_analysis_t));
-        return;
-    }
-    
-    // Calculate statistics using SIMD where possible
-    double avg_aim = macac_simd_mean(aim_errors, count);
-    double aim_var = macac_simd_variance(aim_errors, count, avg_aim);
-    double avg_snap = macac_simd_mean(snap_angles, count);
-    double avg_reach = macac_simd_mean(reaches, count);
-    double hit_rate = macac_simd_mean(hits, count);
-    double avg_interval = macac_simd_mean(attack_intervals, count);
-    double interval_var = macac_simd_variance(attack_intervals, count, avg_interval);
-    
+static void score_combat(double avg_aim, double aim_var, double avg_snap, double avg_reach,
+                         double hit_rate, double avg_interval, double interval_var,
+                         const macac_spectral_t* spectrum, macac_combat_analysis_t* result) {
     // Store debug data
     result->avg_aim_error = avg_aim;
     result->aim_variance = aim_var;
@@ -333,6 +283,9 @@ void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
     result->avg_reach = avg_reach;
     result->hit_rate = hit_rate;
     result->avg_attack_interval = avg_interval;
+    result->spectral_entropy = spectrum->entropy;
+    result->spectral_peak = spectrum->peak_power;
+    result->interval_autocorr = spectrum->autocorr_peak;
     
     // === Aimbot Detection ===
     double aimbot_score = 0.0;
@@ -380,6 +333,18 @@ void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
         autoclicker_score += (hit_rate - 0.85) * 5.0;
     }
     
+    // Periodic structure that survives added jitter: one dominant interval
+    // frequency or a repeating pattern. The lowest bin and lag 1 are left
+    // out; they mostly measure drift in click speed.
+    if (spectrum->window > 0) {
+        if (spectrum->peak_power > 0.4 && spectrum->peak_frequency * spectrum->window >= 2.0) {
+            autoclicker_score += (spectrum->peak_power - 0.4) * 2.0;
+        }
+        if (spectrum->autocorr_peak > 0.6 && spectrum->autocorr_lag >= 2.0) {
+            autoclicker_score += (spectrum->autocorr_peak - 0.6) * 2.5;
+        }
+    }
+    
     result->autoclicker_confidence = 1.0 - exp(-autoclicker_score);
     
     // === Combined Confidence ===
@@ -391,4 +356,206 @@ void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
     });
 }
 
+/**
+ * Analyze combat data for cheating patterns.
+ * 
+ * @param aim_errors - Array of aim errors
+ * @param snap_angles - Array of snap angles
+ * @param reaches - Array of reach distances
+ * @param attack_intervals - Array of attack intervals in ms
+ * @param hits - Array of hit flags (1.0 = hit, 0.0 = miss)
+ * @param count - Number of samples
+ * @param result - Output analysis results
+ */
+void macac_analyze_combat(const double* aim_errors, const double* snap_angles,
+                          const double* reaches, const double* attack_intervals,
+                          const double* hits, size_t count,
+                          macac_combat_analysis_t* result) {
+    if (!result || count < 5) {
+        if (result) memset(result, 0, sizeof(macac_combat_analysis_t));
+        return;
+    }
+    
+    // Validate all input pointers
+    if (!aim_errors || !snap_angles || !reaches || !attack_intervals || !hits) {
+        memset(result, 0, sizeof(macac_combat_analysis_t));
+        return;
+    }
+    
+    // One fused pass over all five columns instead of seven mean/variance scans
+    const double* columns[MACAC_COMBAT_BATCH_COLUMNS];
+    columns[MACAC_COMBAT_AIM_ERROR] = aim_errors;
+    columns[MACAC_COMBAT_SNAP_ANGLE] = snap_angles;
+    columns[MACAC_COMBAT_REACH] = reaches;
+    columns[MACAC_COMBAT_ATTACK_INTERVAL] = attack_intervals;
+    columns[MACAC_COMBAT_HIT] = hits;
+    double acc[7];
+    macac_simd_active()->combat_moments(columns, count, acc);
+    
+    // Shifted sums: mean = x0 + s1/n, variance = (s2 - s1^2/n) / (n - 1)
+    double n = (double)count;
+    double aim_s1 = acc[MACAC_COMBAT_AIM_ERROR];
+    double interval_s1 = acc[MACAC_COMBAT_ATTACK_INTERVAL];
+    double aim_var = std::max(0.0, (acc[5] - aim_s1 * aim_s1 / n) / (n - 1.0));
+    double interval_var = std::max(0.0, (acc[6] - interval_s1 * interval_s1 / n) / (n - 1.0));
+    
+    // Zeroed when the window is too short or has no spread
+    macac_spectral_t spectrum;
+    macac_spectral_analyze(attack_intervals, count, &spectrum);
+    
+    score_combat(aim_errors[0] + aim_s1 / n, aim_var,
+                 acc[MACAC_COMBAT_SNAP_ANGLE] / n, acc[MACAC_COMBAT_REACH] / n,
+                 acc[MACAC_COMBAT_HIT] / n, attack_intervals[0] + interval_s1 / n, interval_var,
+                 &spectrum, result);
+}
+
+/**
+ * Analyze combat data for a batch of players.
+ * 
+ * @param packed - Player-major records, see MACAC_COMBAT_BATCH_STRIDE
+ * @param player_count - Number of player records
+ * @param window - Column length per record
+ * @param results - Output array of player_count analysis records
+ * @return Number of records written
+ */
+size_t macac_analyze_combat_batch(const double* packed, size_t player_count, size_t window,
+                                  macac_combat_analysis_t* results) {
+    if (!packed || !results || window == 0) {
+        return 0;
+    }
+    
+    const size_t stride = MACAC_COMBAT_BATCH_STRIDE(window);
+    
+    for (size_t p = 0; p < player_count; p++) {
+        const double* record = packed + p * stride;
+        const double* columns = record + MACAC_COMBAT_BATCH_HEADER;
+        
+        // Clamp count to the column length; NaN/negative counts become 0
+        double raw_count = record[0];
+        size_t count = 0;
+        if (raw_count >= (double)window) {
+            count = window;
+        } else if (raw_count >= 1.0) {
+            count = (size_t)raw_count;
+        }
+        
+        macac_analyze_combat(columns + 0 * window,
+                             columns + 1 * window,
+                             columns + 2 * window,
+                             columns + 3 * window,
+                             columns + 4 * window,
+                             count, &results[p]);
+    }
+    
+    return player_count;
+}
+
+// ============================================================================
+// Incremental Combat Accumulator
+// ============================================================================
+
+struct macac_combat_accum {
+    macac_ringbuffer_t* columns[MACAC_COMBAT_BATCH_COLUMNS];
+};
+
+static inline bool valid_column(int column) {
+    return column >= 0 && column < MACAC_COMBAT_BATCH_COLUMNS;
+}
+
+macac_combat_accum_t* macac_combat_accum_create(size_t window) {
+    if (window == 0) {
+        return nullptr;
+    }
+    
+    macac_combat_accum_t* acc = new macac_combat_accum_t();
+    for (int c = 0; c < MACAC_COMBAT_BATCH_COLUMNS; c++) {
+        acc->columns[c] = macac_ringbuffer_create_tracked(window);
+        if (!acc->columns[c]) {
+            macac_combat_accum_destroy(acc);
+            return nullptr;
+        }
+    }
+    return acc;
+}
+
+void macac_combat_accum_destroy(macac_combat_accum_t* acc) {
+    if (acc) {
+        for (int c = 0; c < MACAC_COMBAT_BATCH_COLUMNS; c++) {
+            macac_ringbuffer_destroy(acc->columns[c]);
+        }
+        delete acc;
+    }
+}
+
+void macac_combat_accum_push(macac_combat_accum_t* acc, int column, double value) {
+    if (acc && valid_column(column)) {
+        macac_ringbuffer_push(acc->columns[column], value);
+    }
+}
+
+size_t macac_combat_accum_size(macac_combat_accum_t* acc, int column) {
+    if (!acc || !valid_column(column)) {
+        return 0;
+    }
+    return macac_ringbuffer_size(acc->columns[column]);
+}
+
+void macac_combat_accum_moments(macac_combat_accum_t* acc, int column, macac_moments_t* out) {
+    if (!out) {
+        return;
+    }
+    if (!acc || !valid_column(column) || macac_ringbuffer_size(acc->columns[column]) == 0) {
+        memset(out, 0, sizeof(macac_moments_t));
+        return;
+    }
+    
+    macac_ringbuffer_t* rb = acc->columns[column];
+    out->mean = macac_ringbuffer_mean(rb);
+    out->variance = macac_ringbuffer_variance(rb);
+    out->min = macac_ringbuffer_min(rb);
+    out->max = macac_ringbuffer_max(rb);
+}
+
+void macac_combat_accum_clear(macac_combat_accum_t* acc) {
+    if (acc) {
+        for (int c = 0; c < MACAC_COMBAT_BATCH_COLUMNS; c++) {
+            macac_ringbuffer_clear(acc->columns[c]);
+        }
+    }
+}
+
+void macac_combat_accum_analyze(macac_combat_accum_t* acc, macac_combat_analysis_t* result) {
+    if (!result) {
+        return;
+    }
+    if (!acc) {
+        memset(result, 0, sizeof(macac_combat_analysis_t));
+        return;
+    }
+    
+    macac_moments_t m[MACAC_COMBAT_BATCH_COLUMNS];
+    for (int c = 0; c < MACAC_COMBAT_BATCH_COLUMNS; c++) {
+        if (macac_ringbuffer_size(acc->columns[c]) < 5) {
+            memset(result, 0, sizeof(macac_combat_analysis_t));
+            return;
+        }
+        macac_combat_accum_moments(acc, c, &m[c]);
+    }
+    
+    // Newest intervals in time order for the spectrum
+    macac_ringbuffer_t* intervals = acc->columns[MACAC_COMBAT_ATTACK_INTERVAL];
+    size_t recent = std::min(macac_ringbuffer_size(intervals), (size_t)MACAC_SPECTRAL_MAX_WINDOW);
+    double series[MACAC_SPECTRAL_MAX_WINDOW];
+    for (size_t age = 0; age < recent; age++) {
+        series[recent - 1 - age] = macac_ringbuffer_get(intervals, age);
+    }
+    macac_spectral_t spectrum;
+    macac_spectral_analyze(series, recent, &spectrum);
+    
+    score_combat(m[MACAC_COMBAT_AIM_ERROR].mean, m[MACAC_COMBAT_AIM_ERROR].variance,
+                 m[MACAC_COMBAT_SNAP_ANGLE].mean, m[MACAC_COMBAT_REACH].mean,
+                 m[MACAC_COMBAT_HIT].mean, m[MACAC_COMBAT_ATTACK_INTERVAL].mean,
+                 m[MACAC_COMBAT_ATTACK_INTERVAL].variance, &spectrum, result);
+}
+
 } // extern "C"
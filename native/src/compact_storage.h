@@ -0,0 +1,225 @@
+/*
+ * MacAC Native Library - Compact Sample Storage (internal)
+ * 
+ * Element types behind MACAC_STORAGE_*, shared by the ring buffer and the
+ * history slab. Samples are narrowed on store and widened to double on
+ * load, so every statistic is computed in double whatever the storage.
+ * 
+ * Q16 keeps one power-of-two step per window: a sample is stored as
+ * round(v / 2^exp) in int16. When a sample does not fit, exp grows and the
+ * stored window is shifted down to the new step. Only when the write
+ * position wraps is the step shrunk back to fit what is left (an exact
+ * left shift), so a spike keeps the step coarse until the first wrap after
+ * it is overwritten, one to two laps after it was pushed. Bits the coarse
+ * step rounded away are not recovered; the samples stored meanwhile stay
+ * coarse until they are overwritten, up to about three laps in all.
+ * INT16_MIN marks a NaN or infinite sample.
+ */
+
+#ifndef MACAC_COMPACT_STORAGE_H
+#define MACAC_COMPACT_STORAGE_H
+
+#include "macac_native.h"
+#include "simd_dispatch.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Step of an empty Q16 window, 2^-40; the first non-zero sample rescales it
+#define Q16_EXP_MIN (-40)
+
+// Largest step: 2^1000 * 32767 stays finite
+#define Q16_EXP_MAX 1000
+
+#define Q16_NAN INT16_MIN
+#define Q16_LIMIT 32767
+
+/**
+ * 2^e for |e| <= Q16_EXP_MAX, built from the
+ * exponent bits (ldexp is a libm call on every push otherwise).
+ */
+static inline double q16_pow2(int32_t e) {
+    uint64_t bits = (uint64_t)(e + 1023) << 52;
+    double p;
+    memcpy(&p, &bits, sizeof(p));
+    return p;
+}
+
+/**
+ * Step exponent that stores |v| in [2^13, 2^14), one bit of headroom
+ * below Q16_LIMIT so a slowly growing series rarely rescales.
+ */
+static inline int32_t q16_exponent_for(double v) {
+    int e = ilogb(v) - 13;
+    return e < Q16_EXP_MIN ? Q16_EXP_MIN : (e > Q16_EXP_MAX ? Q16_EXP_MAX : e);
+}
+
+/**
+ * Shift count stored values down by k bits, rounding to nearest.
+ */
+static inline void q16_shift(int16_t* data, size_t count, int32_t k) {
+    if (k <= 0) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int32_t q = data[i];
+        if (q == Q16_NAN) {
+            continue;
+        }
+        data[i] = (int16_t)(k >= 16 ? 0 : (q + (1 << (k - 1))) >> k);
+    }
+}
+
+/**
+ * Shift count stored values up by k bits (exact).
+ */
+static inline void q16_unshift(int16_t* data, size_t count, int32_t k) {
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] != Q16_NAN) {
+            data[i] = (int16_t)(data[i] * (1 << k));
+        }
+    }
+}
+
+/**
+ * Storage policies. For a window whose valid samples are data[0..count):
+ *   fit(data, count, v, &exp)   make room for v; Q16 may grow the step and
+ *                               requantise the window, and returns true if
+ *                               it did (the step, and maybe stored values,
+ *                               changed)
+ *   refit(data, count, &exp)    shrink the step to the window, without
+ *                               changing any widened value; returns true if
+ *                               the step changed
+ *   narrow(v, exp)              element to store for v
+ *   widen(q, step)              double for a stored element
+ *   step(exp)                   what widen needs, computed once per window
+ * The float types ignore exp and step.
+ */
+struct storage_f64 {
+    typedef double T;
+    static const int id = MACAC_STORAGE_F64;
+    static bool fit(T*, size_t, double, int32_t*) { return false; }
+    static bool refit(T*, size_t, int32_t*) { return false; }
+    static T narrow(double v, int32_t) { return v; }
+    static double widen(T q, double) { return q; }
+    static double step(int32_t) { return 1.0; }
+};
+
+struct storage_f32 {
+    typedef float T;
+    static const int id = MACAC_STORAGE_F32;
+    static bool fit(T*, size_t, double, int32_t*) { return false; }
+    static bool refit(T*, size_t, int32_t*) { return false; }
+    static T narrow(double v, int32_t) { return (float)v; }
+    static double widen(T q, double) { return (double)q; }
+    static double step(int32_t) { return 1.0; }
+};
+
+struct storage_q16 {
+    typedef int16_t T;
+    static const int id = MACAC_STORAGE_Q16;
+    
+    static bool fit(T* data, size_t count, double v, int32_t* exp) {
+        if (!std::isfinite(v) || fabs(v) * q16_pow2(-*exp) <= Q16_LIMIT) {
+            return false;
+        }
+        int32_t e = q16_exponent_for(v);
+        q16_shift(data, count, e - *exp);
+        *exp = e;
+        return true;
+    }
+    
+    static bool refit(T* data, size_t count, int32_t* exp) {
+        int32_t peak = 0;
+        for (size_t i = 0; i < count; i++) {
+            int32_t q = data[i] == Q16_NAN ? 0 : data[i];
+            peak |= q < 0 ? -q : q;
+        }
+        
+        // Nothing but zeros (and NaNs): any step stores them exactly
+        if (peak == 0) {
+            bool changed = *exp != Q16_EXP_MIN;
+            *exp = Q16_EXP_MIN;
+            return changed;
+        }
+        
+        // Bring the largest magnitude back into [2^13, 2^14)
+        int32_t k = 0;
+        while (k < *exp - Q16_EXP_MIN && (peak << (k + 1)) < (1 << 14)) {
+            k++;
+        }
+        if (k == 0) {
+            return false;
+        }
+        q16_unshift(data, count, k);
+        *exp -= k;
+        return true;
+    }
+    
+    static T narrow(double v, int32_t exp) {
+        const double ROUND_MAGIC = 6755399441055744.0;
+        if (!std::isfinite(v)) {
+            return Q16_NAN;
+        }
+        
+        // Clamp first so the magic-number rounding (to nearest even) holds
+        double q = v * q16_pow2(-exp);
+        q = q > Q16_LIMIT ? Q16_LIMIT : (q < -Q16_LIMIT ? -Q16_LIMIT : q);
+        return (T)((q + ROUND_MAGIC) - ROUND_MAGIC);
+    }
+    
+    // Power-of-two step, so the product is exact
+    static double widen(T q, double step) {
+        return q == Q16_NAN ? NAN : (double)q * step;
+    }
+    
+    static double step(int32_t exp) { return q16_pow2(exp); }
+};
+
+// ============================================================================
+// Widening Reductions
+// ============================================================================
+//
+// Through the dispatch table, so every storage type gets the widest loads
+// the CPU has. Q16 sums are exact integers, scaled once; a NaN sample
+// (the sentinel is the minimum int16) makes the sum NaN, as it would for
+// double storage.
+
+/**
+ * Sum of data[0..count), widened to double.
+ */
+template <class S>
+static inline double storage_sum(const typename S::T* data, size_t count, double step) {
+    const macac_simd_kernels* k = macac_simd_active();
+    if constexpr (S::id == MACAC_STORAGE_F64) {
+        (void)step;
+        return k->sum(data, count);
+    } else if constexpr (S::id == MACAC_STORAGE_F32) {
+        (void)step;
+        return k->sum_f32(data, count);
+    } else {
+        int32_t min;
+        int64_t sum = k->sum_i16(data, count, &min);
+        return min == Q16_NAN ? NAN : (double)sum * step;
+    }
+}
+
+/**
+ * Sum of (x - mean)^2 over data[0..count), widened to double.
+ */
+template <class S>
+static inline double storage_sum_sq_dev(const typename S::T* data, size_t count, double step, double mean) {
+    const macac_simd_kernels* k = macac_simd_active();
+    if constexpr (S::id == MACAC_STORAGE_F64) {
+        (void)step;
+        return k->sum_sq_dev(data, count, mean);
+    } else if constexpr (S::id == MACAC_STORAGE_F32) {
+        (void)step;
+        return k->sum_sq_dev_f32(data, count, mean);
+    } else {
+        return k->sum_sq_dev_i16(data, count, step, mean);
+    }
+}
+
+#endif // MACAC_COMPACT_STORAGE_H
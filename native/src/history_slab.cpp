@@ -0,0 +1,790 @@
+/*
+ * MacAC Native Library - Player History Slab
+ * 
+ * Keeps every player's metric windows in a single contiguous arena
+ * instead of one heap block per ring buffer.
+ * 
+ * Layout (structure-of-arrays):
+ *   arena[metric][slot][stride]
+ * 
+ * Each (metric, slot) window starts on a 64-byte boundary, so a check
+ * sweeping one metric across all players walks memory linearly. Slots
+ * are recycled through a free-list; slot ids carry a generation counter
+ * so a stale id held by a departed player can never write into the
+ * slot of the player who replaced it.
+ * 
+ * Windows hold a MACAC_STORAGE_* element type fixed at create: F32 and
+ * Q16 windows are narrowed on push and widened on every read, and each
+ * Q16 window carries its own step exponent in `scales`.
+ * 
+ * Every array lives in one block, carved at fixed offsets. A heap slab
+ * allocates the block; a mapped slab (macac_slab_open_mapped) maps it
+ * from a file, so windows are written in place and survive a restart
+ * with no serialisation step. File layout (64-byte aligned sections):
+ *   header | arena | owners | parked_at | heads | sizes | scales | generations | state
+ * The header records version, byte order and geometry; a file whose
+ * header does not match is reinitialised rather than parsed.
+ * 
+ * Slots that were active when the previous process stopped come back
+ * dormant: their windows are kept until the owning player returns
+ * (macac_slab_acquire_for) or the slot is needed for someone else.
+ */
+
+#include "macac_native.h"
+#include "compact_storage.h"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <mutex>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Arena alignment (one cache line, also satisfies AVX-512 loads)
+#define SLAB_ALIGNMENT 64
+
+// History file format; bump the version on any layout change
+#define SLAB_FILE_MAGIC "MACACHS"
+#define SLAB_FILE_VERSION 2
+#define SLAB_BYTE_ORDER 0x01020304u
+
+// Slot states
+#define SLOT_FREE 0
+#define SLOT_ACTIVE 1
+#define SLOT_DORMANT 2              // Released with its windows kept for the owner
+
+/**
+ * First section of a history file. Fixed size, native byte order.
+ */
+struct slab_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t max_slots;
+    uint64_t num_metrics;
+    uint64_t window;
+    uint64_t stride;
+    uint64_t file_bytes;
+    uint32_t storage;
+    uint8_t reserved[4];
+};
+
+static_assert(sizeof(slab_file_header) == SLAB_ALIGNMENT, "header must fill one cache line");
+
+/**
+ * Byte offsets of each section within the block.
+ */
+struct slab_layout {
+    size_t arena;
+    size_t owners;
+    size_t parked_at;
+    size_t heads;
+    size_t sizes;
+    size_t scales;
+    size_t generations;
+    size_t state;
+    size_t total;
+};
+
+struct macac_history_slab {
+    uint8_t* arena;             // [metric][slot][stride] of `storage` elements
+    size_t max_slots;
+    size_t num_metrics;
+    size_t window;              // Logical window length
+    size_t stride;              // Window length in elements, rounded to a cache line
+    int storage;                // MACAC_STORAGE_* element type
+    size_t elem_bytes;
+    
+    uint64_t* owners;           // [slot][2] owner key, 0/0 if none
+    uint64_t* parked_at;        // [slot] park order, oldest dormant is evicted first
+    uint32_t* heads;            // [metric][slot] next write position
+    uint32_t* sizes;            // [metric][slot] current element count
+    int32_t* scales;            // [metric][slot] Q16 step exponent
+    uint32_t* generations;      // [slot] bumped on every release
+    uint8_t* state;             // [slot] SLOT_FREE / SLOT_ACTIVE / SLOT_DORMANT
+    
+    int32_t* free_list;         // Stack of free slot indices
+    size_t free_count;
+    size_t active_count;
+    size_t dormant_count;
+    uint64_t park_clock;
+    
+    void* block;                // Heap allocation or file mapping
+    size_t block_bytes;
+    int fd;                     // History file, -1 for a heap slab
+    
+    // state and generations change only under both lock and the slot's
+    // slot_locks entry; data calls hold the latter from resolve to return,
+    // so a release cannot hand the slot on mid-push
+    std::mutex lock;            // Guards the free-list, counters and slot changes
+    std::mutex* slot_locks;     // [slot], heap-only (not part of the file)
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+/**
+ * Slot ids are (generation << 32) | slot index.
+ */
+static inline int64_t make_slot_id(uint32_t generation, size_t slot) {
+    return (int64_t)(((uint64_t)generation << 32) | (uint64_t)slot);
+}
+
+/**
+ * Resolve a slot id to its index, or -1 if the id is stale or invalid.
+ */
+static inline int64_t resolve_slot(const macac_history_slab_t* slab, int64_t slot_id) {
+    if (!slab || slot_id < 0) {
+        return -1;
+    }
+    
+    size_t slot = (size_t)(slot_id & 0xFFFFFFFFLL);
+    uint32_t generation = (uint32_t)((uint64_t)slot_id >> 32);
+    
+    if (slot >= slab->max_slots || slab->state[slot] != SLOT_ACTIVE ||
+        slab->generations[slot] != generation) {
+        return -1;
+    }
+    return (int64_t)slot;
+}
+
+/**
+ * Lock the slot an id names and resolve it, or return -1 (and leave guard
+ * unlocked) if the id is stale or invalid.
+ */
+static inline int64_t lock_slot(const macac_history_slab_t* slab, int64_t slot_id,
+                                std::unique_lock<std::mutex>& guard) {
+    if (!slab || slot_id < 0 || (size_t)(slot_id & 0xFFFFFFFFLL) >= slab->max_slots) {
+        return -1;
+    }
+    
+    guard = std::unique_lock<std::mutex>(slab->slot_locks[slot_id & 0xFFFFFFFFLL]);
+    int64_t slot = resolve_slot(slab, slot_id);
+    if (slot < 0) {
+        guard.unlock();
+    }
+    return slot;
+}
+
+static inline size_t meta_index(const macac_history_slab_t* slab, size_t metric, size_t slot) {
+    return metric * slab->max_slots + slot;
+}
+
+static inline uint8_t* window_ptr(const macac_history_slab_t* slab, size_t metric, size_t slot) {
+    return slab->arena + meta_index(slab, metric, slot) * slab->stride * slab->elem_bytes;
+}
+
+/**
+ * Reset every metric window of a slot to empty.
+ */
+static void reset_slot(macac_history_slab_t* slab, size_t slot) {
+    for (size_t m = 0; m < slab->num_metrics; m++) {
+        size_t idx = meta_index(slab, m, slot);
+        slab->heads[idx] = 0;
+        slab->sizes[idx] = 0;
+        slab->scales[idx] = Q16_EXP_MIN;
+        memset(window_ptr(slab, m, slot), 0, slab->stride * slab->elem_bytes);
+    }
+}
+
+static inline size_t align_up(size_t bytes) {
+    return (bytes + SLAB_ALIGNMENT - 1) & ~(size_t)(SLAB_ALIGNMENT - 1);
+}
+
+static inline size_t stride_of(size_t window, size_t elem_bytes) {
+    size_t line = SLAB_ALIGNMENT / elem_bytes;
+    return ((window + line - 1) / line) * line;
+}
+
+static slab_layout layout_of(size_t max_slots, size_t num_metrics, size_t stride, size_t elem_bytes) {
+    size_t windows = max_slots * num_metrics;
+    slab_layout l;
+    l.arena = align_up(sizeof(slab_file_header));
+    l.owners = l.arena + align_up(windows * stride * elem_bytes);
+    l.parked_at = l.owners + align_up(max_slots * 2 * sizeof(uint64_t));
+    l.heads = l.parked_at + align_up(max_slots * sizeof(uint64_t));
+    l.sizes = l.heads + align_up(windows * sizeof(uint32_t));
+    l.scales = l.sizes + align_up(windows * sizeof(uint32_t));
+    l.generations = l.scales + align_up(windows * sizeof(int32_t));
+    l.state = l.generations + align_up(max_slots * sizeof(uint32_t));
+    l.total = l.state + align_up(max_slots * sizeof(uint8_t));
+    return l;
+}
+
+/**
+ * Allocate the slab shell (everything except the block) for a geometry.
+ */
+static macac_history_slab_t* new_slab(size_t max_slots, size_t num_metrics, size_t window, int storage) {
+    size_t elem_bytes = macac_storage_bytes(storage);
+    if (max_slots == 0 || num_metrics == 0 || window == 0 || max_slots > 0x7FFFFFFF || elem_bytes == 0) {
+        return nullptr;
+    }
+    
+    macac_history_slab_t* slab = new (std::nothrow) macac_history_slab_t();
+    if (!slab) {
+        return nullptr;
+    }
+    
+    slab->max_slots = max_slots;
+    slab->num_metrics = num_metrics;
+    slab->window = window;
+    slab->storage = storage;
+    slab->elem_bytes = elem_bytes;
+    slab->stride = stride_of(window, elem_bytes);
+    slab->fd = -1;
+    slab->free_list = (int32_t*)malloc(max_slots * sizeof(int32_t));
+    slab->slot_locks = new (std::nothrow) std::mutex[max_slots];
+    if (!slab->free_list || !slab->slot_locks) {
+        free(slab->free_list);
+        delete[] slab->slot_locks;
+        delete slab;
+        return nullptr;
+    }
+    return slab;
+}
+
+/**
+ * Point every section at its offset within slab->block.
+ */
+static void carve(macac_history_slab_t* slab) {
+    slab_layout l = layout_of(slab->max_slots, slab->num_metrics, slab->stride, slab->elem_bytes);
+    uint8_t* base = (uint8_t*)slab->block;
+    slab->arena = base + l.arena;
+    slab->owners = (uint64_t*)(base + l.owners);
+    slab->parked_at = (uint64_t*)(base + l.parked_at);
+    slab->heads = (uint32_t*)(base + l.heads);
+    slab->sizes = (uint32_t*)(base + l.sizes);
+    slab->scales = (int32_t*)(base + l.scales);
+    slab->generations = (uint32_t*)(base + l.generations);
+    slab->state = (uint8_t*)(base + l.state);
+}
+
+/**
+ * Rebuild the free-list and counters from slot states, highest index
+ * pushed first so the lowest is handed out first, keeping active players
+ * packed at the front of each column.
+ */
+static void rebuild_free_list(macac_history_slab_t* slab) {
+    slab->free_count = 0;
+    slab->active_count = 0;
+    slab->dormant_count = 0;
+    slab->park_clock = 0;
+    for (size_t i = slab->max_slots; i-- > 0;) {
+        if (slab->state[i] == SLOT_FREE) {
+            slab->free_list[slab->free_count++] = (int32_t)i;
+        } else if (slab->state[i] == SLOT_ACTIVE) {
+            slab->active_count++;
+        } else {
+            slab->dormant_count++;
+            if (slab->parked_at[i] >= slab->park_clock) {
+                slab->park_clock = slab->parked_at[i] + 1;
+            }
+        }
+    }
+}
+
+/**
+ * Bring a mapped file's slots back: anything left active by the previous
+ * process becomes dormant, and slots whose bookkeeping is out of range
+ * (a torn write at crash time) are cleared. Touches metadata only.
+ */
+static void recover_slots(macac_history_slab_t* slab) {
+    for (size_t slot = 0; slot < slab->max_slots; slot++) {
+        bool valid = slab->state[slot] <= SLOT_DORMANT;
+        for (size_t m = 0; valid && m < slab->num_metrics; m++) {
+            size_t idx = meta_index(slab, m, slot);
+            valid = slab->heads[idx] < slab->window && slab->sizes[idx] <= slab->window &&
+                    slab->scales[idx] >= Q16_EXP_MIN && slab->scales[idx] <= Q16_EXP_MAX;
+        }
+        
+        if (!valid) {
+            reset_slot(slab, slot);
+            slab->state[slot] = SLOT_FREE;
+            slab->owners[2 * slot] = 0;
+            slab->owners[2 * slot + 1] = 0;
+        } else if (slab->state[slot] == SLOT_ACTIVE) {
+            slab->state[slot] = SLOT_DORMANT;
+        }
+        slab->generations[slot]++;
+    }
+}
+
+static bool header_matches(const slab_file_header* h, const macac_history_slab_t* slab,
+                           size_t file_bytes) {
+    return memcmp(h->magic, SLAB_FILE_MAGIC, sizeof(SLAB_FILE_MAGIC)) == 0 &&
+           h->version == SLAB_FILE_VERSION &&
+           h->byte_order == SLAB_BYTE_ORDER &&
+           h->max_slots == slab->max_slots &&
+           h->num_metrics == slab->num_metrics &&
+           h->window == slab->window &&
+           h->stride == slab->stride &&
+           h->file_bytes == file_bytes &&
+           h->storage == (uint32_t)slab->storage;
+}
+
+/**
+ * Take a slot for a new owner: a free one if any, else evict the dormant
+ * slot parked longest ago. Caller holds the lock.
+ */
+static int64_t take_slot(macac_history_slab_t* slab) {
+    if (slab->free_count > 0) {
+        return slab->free_list[--slab->free_count];
+    }
+    if (slab->dormant_count == 0) {
+        return -1;
+    }
+    
+    int64_t oldest = -1;
+    for (size_t i = 0; i < slab->max_slots; i++) {
+        if (slab->state[i] == SLOT_DORMANT &&
+            (oldest < 0 || slab->parked_at[i] < slab->parked_at[oldest])) {
+            oldest = (int64_t)i;
+        }
+    }
+    slab->dormant_count--;
+    return oldest;
+}
+
+/**
+ * Hand out a slot that take_slot returned. Caller holds the lock.
+ */
+static int64_t activate_slot(macac_history_slab_t* slab, size_t slot,
+                             uint64_t key_hi, uint64_t key_lo) {
+    std::lock_guard<std::mutex> slot_guard(slab->slot_locks[slot]);
+    reset_slot(slab, slot);
+    slab->owners[2 * slot] = key_hi;
+    slab->owners[2 * slot + 1] = key_lo;
+    slab->state[slot] = SLOT_ACTIVE;
+    slab->active_count++;
+    return make_slot_id(slab->generations[slot], slot);
+}
+
+// ============================================================================
+// Typed Window Access
+// ============================================================================
+
+template <class S>
+static void window_push(macac_history_slab_t* slab, size_t idx, uint8_t* window, double value) {
+    typename S::T* data = (typename S::T*)window;
+    uint32_t head = slab->heads[idx];
+    
+    // data[0..size) is the window in ring order, which is all fit touches
+    S::fit(data, slab->sizes[idx], value, &slab->scales[idx]);
+    data[head] = S::narrow(value, slab->scales[idx]);
+    
+    slab->heads[idx] = (uint32_t)((head + 1) % slab->window);
+    if (slab->sizes[idx] < slab->window) {
+        slab->sizes[idx]++;
+    }
+    
+    // Once per lap, give back precision a departed outlier took
+    if (slab->heads[idx] == 0) {
+        S::refit(data, slab->sizes[idx], &slab->scales[idx]);
+    }
+}
+
+template <class S>
+static double window_get(const macac_history_slab_t* slab, size_t idx, const uint8_t* window, size_t index) {
+    return S::widen(((const typename S::T*)window)[index], S::step(slab->scales[idx]));
+}
+
+template <class S>
+static double window_sum(const macac_history_slab_t* slab, size_t idx, const uint8_t* window) {
+    return storage_sum<S>((const typename S::T*)window, slab->sizes[idx], S::step(slab->scales[idx]));
+}
+
+template <class S>
+static double window_sum_sq_dev(const macac_history_slab_t* slab, size_t idx, const uint8_t* window,
+                                double mean) {
+    return storage_sum_sq_dev<S>((const typename S::T*)window, slab->sizes[idx],
+                                 S::step(slab->scales[idx]), mean);
+}
+
+/**
+ * Call f with the storage policy of a slab.
+ */
+template <class F>
+static auto with_storage(const macac_history_slab_t* slab, F f) {
+    switch (slab->storage) {
+        case MACAC_STORAGE_F32: return f(storage_f32());
+        case MACAC_STORAGE_Q16: return f(storage_q16());
+        default: return f(storage_f64());
+    }
+}
+
+/**
+ * Lock and resolve (slot id, metric) to a meta index, or -1 (unlocked).
+ */
+static inline int64_t resolve_window(const macac_history_slab_t* slab, int64_t slot_id, size_t metric,
+                                     std::unique_lock<std::mutex>& guard) {
+    if (!slab || metric >= slab->num_metrics) {
+        return -1;
+    }
+    int64_t slot = lock_slot(slab, slot_id, guard);
+    if (slot < 0) {
+        return -1;
+    }
+    return (int64_t)meta_index(slab, metric, (size_t)slot);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+extern "C" {
+
+macac_history_slab_t* macac_slab_create(size_t max_slots, size_t num_metrics, size_t window) {
+    return macac_slab_create_typed(max_slots, num_metrics, window, MACAC_STORAGE_F64);
+}
+
+macac_history_slab_t* macac_slab_create_typed(size_t max_slots, size_t num_metrics, size_t window,
+                                              int storage) {
+    macac_history_slab_t* slab = new_slab(max_slots, num_metrics, window, storage);
+    if (!slab) {
+        return nullptr;
+    }
+    
+    slab->block_bytes = layout_of(max_slots, num_metrics, slab->stride, slab->elem_bytes).total;
+    slab->block = aligned_alloc(SLAB_ALIGNMENT, slab->block_bytes);
+    if (!slab->block) {
+        macac_slab_destroy(slab);
+        return nullptr;
+    }
+    
+    memset(slab->block, 0, slab->block_bytes);
+    carve(slab);
+    for (size_t i = 0; i < max_slots * num_metrics; i++) {
+        slab->scales[i] = Q16_EXP_MIN;
+    }
+    rebuild_free_list(slab);
+    
+    return slab;
+}
+
+macac_history_slab_t* macac_slab_open_mapped(const char* path, size_t max_slots,
+                                             size_t num_metrics, size_t window) {
+    return macac_slab_open_mapped_typed(path, max_slots, num_metrics, window, MACAC_STORAGE_F64);
+}
+
+macac_history_slab_t* macac_slab_open_mapped_typed(const char* path, size_t max_slots,
+                                                   size_t num_metrics, size_t window, int storage) {
+    if (!path || !path[0]) {
+        return nullptr;
+    }
+    
+    macac_history_slab_t* slab = new_slab(max_slots, num_metrics, window, storage);
+    if (!slab) {
+        return nullptr;
+    }
+    
+    // One process per file: a second server on the same file would
+    // interleave writes into the same windows
+    slab->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (slab->fd < 0 || flock(slab->fd, LOCK_EX | LOCK_NB) != 0) {
+        macac_slab_destroy(slab);
+        return nullptr;
+    }
+    
+    size_t bytes = layout_of(max_slots, num_metrics, slab->stride, slab->elem_bytes).total;
+    struct stat st;
+    if (fstat(slab->fd, &st) != 0) {
+        macac_slab_destroy(slab);
+        return nullptr;
+    }
+    
+    // Truncating to zero first discards stale contents of a mismatched file;
+    // the regrown file reads back as zeros, which is an all-free slab
+    bool fresh = (size_t)st.st_size != bytes;
+    if (fresh && (ftruncate(slab->fd, 0) != 0 || ftruncate(slab->fd, (off_t)bytes) != 0)) {
+        macac_slab_destroy(slab);
+        return nullptr;
+    }
+    
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, slab->fd, 0);
+    if (map == MAP_FAILED) {
+        macac_slab_destroy(slab);
+        return nullptr;
+    }
+    slab->block = map;
+    slab->block_bytes = bytes;
+    carve(slab);
+    
+    slab_file_header* header = (slab_file_header*)slab->block;
+    if (!fresh && !header_matches(header, slab, bytes)) {
+        memset(slab->block, 0, bytes);
+        fresh = true;
+    }
+    
+    if (fresh) {
+        // Geometry first, magic last: a crash in between leaves a file
+        // that is rejected and reinitialised on the next open
+        header->version = SLAB_FILE_VERSION;
+        header->byte_order = SLAB_BYTE_ORDER;
+        header->max_slots = max_slots;
+        header->num_metrics = num_metrics;
+        header->window = window;
+        header->stride = slab->stride;
+        header->file_bytes = bytes;
+        header->storage = (uint32_t)storage;
+        for (size_t i = 0; i < max_slots * num_metrics; i++) {
+            slab->scales[i] = Q16_EXP_MIN;
+        }
+        memcpy(header->magic, SLAB_FILE_MAGIC, sizeof(SLAB_FILE_MAGIC));
+    } else {
+        recover_slots(slab);
+    }
+    rebuild_free_list(slab);
+    
+    return slab;
+}
+
+void macac_slab_destroy(macac_history_slab_t* slab) {
+    if (!slab) {
+        return;
+    }
+    
+    if (slab->fd >= 0) {
+        // Dirty pages stay in the page cache after munmap and are written
+        // back by the kernel; start that now rather than at its leisure
+        if (slab->block) {
+            msync(slab->block, slab->block_bytes, MS_ASYNC);
+            munmap(slab->block, slab->block_bytes);
+        }
+        close(slab->fd);
+    } else {
+        free(slab->block);
+    }
+    free(slab->free_list);
+    delete[] slab->slot_locks;
+    delete slab;
+}
+
+int64_t macac_slab_acquire(macac_history_slab_t* slab) {
+    return macac_slab_acquire_for(slab, 0, 0);
+}
+
+int64_t macac_slab_acquire_for(macac_history_slab_t* slab, uint64_t key_hi, uint64_t key_lo) {
+    if (!slab) {
+        return -1;
+    }
+    
+    std::lock_guard<std::mutex> guard(slab->lock);
+    
+    // Returning owner: reclaim the dormant slot with its windows intact
+    if (slab->dormant_count > 0 && (key_hi | key_lo) != 0) {
+        for (size_t i = 0; i < slab->max_slots; i++) {
+            if (slab->state[i] == SLOT_DORMANT &&
+                slab->owners[2 * i] == key_hi && slab->owners[2 * i + 1] == key_lo) {
+                std::lock_guard<std::mutex> slot_guard(slab->slot_locks[i]);
+                slab->state[i] = SLOT_ACTIVE;
+                slab->dormant_count--;
+                slab->active_count++;
+                return make_slot_id(slab->generations[i], i);
+            }
+        }
+    }
+    
+    int64_t slot = take_slot(slab);
+    if (slot < 0) {
+        return -1;
+    }
+    return activate_slot(slab, (size_t)slot, key_hi, key_lo);
+}
+
+void macac_slab_release(macac_history_slab_t* slab, int64_t slot_id) {
+    if (!slab) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> guard(slab->lock);
+    
+    int64_t slot = resolve_slot(slab, slot_id);
+    if (slot < 0) {
+        return;
+    }
+    
+    // Invalidate outstanding ids before the slot can be reused; a push
+    // already past resolve finishes first
+    std::lock_guard<std::mutex> slot_guard(slab->slot_locks[slot]);
+    slab->state[slot] = SLOT_FREE;
+    slab->owners[2 * slot] = 0;
+    slab->owners[2 * slot + 1] = 0;
+    slab->generations[slot]++;
+    slab->free_list[slab->free_count++] = (int32_t)slot;
+    slab->active_count--;
+}
+
+void macac_slab_park(macac_history_slab_t* slab, int64_t slot_id) {
+    if (!slab) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> guard(slab->lock);
+    
+    int64_t slot = resolve_slot(slab, slot_id);
+    if (slot < 0) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> slot_guard(slab->slot_locks[slot]);
+    
+    // Anonymous slots have no owner to come back for them
+    if ((slab->owners[2 * slot] | slab->owners[2 * slot + 1]) == 0) {
+        slab->state[slot] = SLOT_FREE;
+        slab->free_list[slab->free_count++] = (int32_t)slot;
+    } else {
+        slab->state[slot] = SLOT_DORMANT;
+        slab->parked_at[slot] = slab->park_clock++;
+        slab->dormant_count++;
+    }
+    slab->generations[slot]++;
+    slab->active_count--;
+}
+
+int macac_slab_sync(macac_history_slab_t* slab, int wait) {
+    if (!slab) {
+        return -1;
+    }
+    if (slab->fd < 0) {
+        return 0;
+    }
+    
+    if (wait) {
+        return msync(slab->block, slab->block_bytes, MS_SYNC) == 0 ? 0 : -1;
+    }
+#ifdef __linux__
+    // MS_ASYNC only marks pages dirty on Linux; this actually queues writeback
+    return sync_file_range(slab->fd, 0, 0, SYNC_FILE_RANGE_WRITE) == 0 ? 0 : -1;
+#else
+    return msync(slab->block, slab->block_bytes, MS_ASYNC) == 0 ? 0 : -1;
+#endif
+}
+
+int macac_slab_is_mapped(macac_history_slab_t* slab) {
+    return slab && slab->fd >= 0 ? 1 : 0;
+}
+
+int macac_slab_storage(macac_history_slab_t* slab) {
+    return slab ? slab->storage : -1;
+}
+
+void macac_slab_push(macac_history_slab_t* slab, int64_t slot_id, size_t metric, double value) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0) {
+        return;
+    }
+    
+    uint8_t* window = window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+    with_storage(slab, [&](auto s) { window_push<decltype(s)>(slab, (size_t)idx, window, value); });
+}
+
+double macac_slab_get(macac_history_slab_t* slab, int64_t slot_id, size_t metric, size_t age) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0 || age >= slab->sizes[idx]) {
+        return std::nan("");
+    }
+    
+    size_t index = (slab->heads[idx] + slab->window - 1 - age) % slab->window;
+    const uint8_t* window = window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+    return with_storage(slab, [&](auto s) { return window_get<decltype(s)>(slab, (size_t)idx, window, index); });
+}
+
+size_t macac_slab_size(macac_history_slab_t* slab, int64_t slot_id, size_t metric) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0) {
+        return 0;
+    }
+    return slab->sizes[idx];
+}
+
+const double* macac_slab_window(macac_history_slab_t* slab, int64_t slot_id,
+                                size_t metric, size_t* out_count) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0 || slab->storage != MACAC_STORAGE_F64) {
+        if (out_count) *out_count = 0;
+        return nullptr;
+    }
+    
+    if (out_count) {
+        *out_count = slab->sizes[idx];
+    }
+    return (const double*)window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+}
+
+size_t macac_slab_read(macac_history_slab_t* slab, int64_t slot_id, size_t metric,
+                       double* out, size_t max_count) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0 || !out) {
+        return 0;
+    }
+    
+    size_t count = slab->sizes[idx] < max_count ? slab->sizes[idx] : max_count;
+    size_t first = (slab->heads[idx] + slab->window - count) % slab->window;
+    const uint8_t* window = window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+    with_storage(slab, [&](auto s) {
+        double step = decltype(s)::step(slab->scales[idx]);
+        const auto* data = (const typename decltype(s)::T*)window;
+        size_t index = first;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = decltype(s)::widen(data[index], step);
+            index = index + 1 == slab->window ? 0 : index + 1;
+        }
+    });
+    return count;
+}
+
+double macac_slab_mean(macac_history_slab_t* slab, int64_t slot_id, size_t metric) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0 || slab->sizes[idx] == 0) {
+        return 0.0;
+    }
+    
+    const uint8_t* window = window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+    double sum = with_storage(slab, [&](auto s) { return window_sum<decltype(s)>(slab, (size_t)idx, window); });
+    return sum / (double)slab->sizes[idx];
+}
+
+double macac_slab_variance(macac_history_slab_t* slab, int64_t slot_id, size_t metric) {
+    std::unique_lock<std::mutex> guard;
+    int64_t idx = resolve_window(slab, slot_id, metric, guard);
+    if (idx < 0 || slab->sizes[idx] < 2) {
+        return 0.0;
+    }
+    
+    const uint8_t* window = window_ptr(slab, metric, (size_t)(slot_id & 0xFFFFFFFFLL));
+    size_t count = slab->sizes[idx];
+    return with_storage(slab, [&](auto s) {
+        double mean = window_sum<decltype(s)>(slab, (size_t)idx, window) / (double)count;
+        return window_sum_sq_dev<decltype(s)>(slab, (size_t)idx, window, mean) / (double)(count - 1);
+    });
+}
+
+size_t macac_slab_active_count(macac_history_slab_t* slab) {
+    if (!slab) {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> guard(slab->lock);
+    return slab->active_count;
+}
+
+size_t macac_slab_dormant_count(macac_history_slab_t* slab) {
+    if (!slab) {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> guard(slab->lock);
+    return slab->dormant_count;
+}
+
+} // extern "C"
@@ -8,6 +8,9 @@
 #include <jni.h>
 #include "macac_native.h"
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,11 +22,29 @@ extern "C" {
 
 /**
  * Initialize native library.
- * Calibrates TSC timer.
+ * Selects SIMD kernels for this CPU and calibrates TSC timer.
  */
 JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_init
   (JNIEnv *env, jclass clazz) {
+    macac_cpu_init();
     macac_calibrate_tsc();
+    macac_spectral_init();
+}
+
+/**
+ * Get the ISA of the active SIMD kernels (MACAC_ISA_*).
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_cpuIsa
+  (JNIEnv *env, jclass clazz) {
+    return (jint)macac_cpu_isa();
+}
+
+/**
+ * Get the name of the active SIMD ISA.
+ */
+JNIEXPORT jstring JNICALL Java_com_macmoment_macac_util_NativeHelper_cpuIsaName
+  (JNIEnv *env, jclass clazz) {
+    return env->NewStringUTF(macac_cpu_isa_name(macac_cpu_isa()));
 }
 
 /**
@@ -107,6 +128,392 @@ JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferClea
     }
 }
 
+/**
+ * Create a native ring buffer that tracks running statistics.
+ * Returns handle (pointer as long).
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createTrackedRingBuffer
+  (JNIEnv *env, jclass clazz, jint capacity) {
+    if (capacity <= 0) {
+        return 0;
+    }
+    macac_ringbuffer_t* rb = macac_ringbuffer_create_tracked((size_t)capacity);
+    return (jlong)(intptr_t)rb;
+}
+
+/**
+ * Get ring buffer window mean.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferMean
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_ringbuffer_t* rb = (macac_ringbuffer_t*)(intptr_t)handle;
+    if (rb) {
+        return macac_ringbuffer_mean(rb);
+    }
+    return 0.0;
+}
+
+/**
+ * Get ring buffer window sample variance.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferVariance
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_ringbuffer_t* rb = (macac_ringbuffer_t*)(intptr_t)handle;
+    if (rb) {
+        return macac_ringbuffer_variance(rb);
+    }
+    return 0.0;
+}
+
+/**
+ * Get ring buffer window minimum.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferMin
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_ringbuffer_t* rb = (macac_ringbuffer_t*)(intptr_t)handle;
+    return macac_ringbuffer_min(rb);
+}
+
+/**
+ * Get ring buffer window maximum.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_ringBufferMax
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_ringbuffer_t* rb = (macac_ringbuffer_t*)(intptr_t)handle;
+    return macac_ringbuffer_max(rb);
+}
+
+// ============================================================================
+// JNI History Slab Functions
+// ============================================================================
+
+/**
+ * Create a player history slab with MACAC_STORAGE_* windows.
+ * Returns handle (pointer as long).
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createHistorySlab
+  (JNIEnv *env, jclass clazz, jint maxSlots, jint numMetrics, jint window, jint storage) {
+    if (maxSlots <= 0 || numMetrics <= 0 || window <= 0) return 0;
+    macac_history_slab_t* slab = macac_slab_create_typed((size_t)maxSlots, (size_t)numMetrics,
+                                                         (size_t)window, (int)storage);
+    return (jlong)(intptr_t)slab;
+}
+
+/**
+ * Open a history slab backed by a file at path.
+ * Returns handle (pointer as long), or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_openHistorySlab
+  (JNIEnv *env, jclass clazz, jstring path, jint maxSlots, jint numMetrics, jint window, jint storage) {
+    if (!path || maxSlots <= 0 || numMetrics <= 0 || window <= 0) return 0;
+    
+    const char* chars = env->GetStringUTFChars(path, NULL);
+    if (!chars) return 0;
+    
+    macac_history_slab_t* slab = macac_slab_open_mapped_typed(chars, (size_t)maxSlots, (size_t)numMetrics,
+                                                              (size_t)window, (int)storage);
+    env->ReleaseStringUTFChars(path, chars);
+    return (jlong)(intptr_t)slab;
+}
+
+/**
+ * Destroy a player history slab.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyHistorySlab
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    macac_slab_destroy(slab);
+}
+
+/**
+ * Acquire a slot. Returns slot id or -1 if full.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_slabAcquire
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    return (jlong)macac_slab_acquire(slab);
+}
+
+/**
+ * Acquire a slot for an owner key, reclaiming its dormant slot if any.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_slabAcquireFor
+  (JNIEnv *env, jclass clazz, jlong handle, jlong keyHi, jlong keyLo) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    return (jlong)macac_slab_acquire_for(slab, (uint64_t)keyHi, (uint64_t)keyLo);
+}
+
+/**
+ * Release a slot back to the free-list.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_slabRelease
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    macac_slab_release(slab, (int64_t)slotId);
+}
+
+/**
+ * Park a slot, keeping its windows for the owner's return.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_slabPark
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    macac_slab_park(slab, (int64_t)slotId);
+}
+
+/**
+ * Schedule (or with wait, complete) write-back of a mapped slab.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_slabSync
+  (JNIEnv *env, jclass clazz, jlong handle, jboolean wait) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    return (jint)macac_slab_sync(slab, wait ? 1 : 0);
+}
+
+/**
+ * Push value to a slot's metric window.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_slabPush
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId, jint metric, jdouble value) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    if (metric < 0) return;
+    macac_slab_push(slab, (int64_t)slotId, (size_t)metric, value);
+}
+
+/**
+ * Get value from a slot's metric window at age.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_slabGet
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId, jint metric, jint age) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    if (metric < 0 || age < 0) return std::nan("");
+    return macac_slab_get(slab, (int64_t)slotId, (size_t)metric, (size_t)age);
+}
+
+/**
+ * Mean of a slot's metric window, widened from the slab's storage.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_slabMean
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId, jint metric) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    if (metric < 0) return 0.0;
+    return macac_slab_mean(slab, (int64_t)slotId, (size_t)metric);
+}
+
+/**
+ * Sample variance of a slot's metric window.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_slabVariance
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId, jint metric) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    if (metric < 0) return 0.0;
+    return macac_slab_variance(slab, (int64_t)slotId, (size_t)metric);
+}
+
+/**
+ * Get a slot's metric window size.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_slabSize
+  (JNIEnv *env, jclass clazz, jlong handle, jlong slotId, jint metric) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    if (metric < 0) return 0;
+    return (jint)macac_slab_size(slab, (int64_t)slotId, (size_t)metric);
+}
+
+/**
+ * Get number of acquired slots.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_slabActiveCount
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    return (jint)macac_slab_active_count(slab);
+}
+
+/**
+ * Get number of dormant slots.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_slabDormantCount
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_history_slab_t* slab = (macac_history_slab_t*)(intptr_t)handle;
+    return (jint)macac_slab_dormant_count(slab);
+}
+
+// ============================================================================
+// JNI Spatial Index Functions
+// ============================================================================
+
+/**
+ * Create a spatial index. Returns handle (pointer as long), or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createSpatialIndex
+  (JNIEnv *env, jclass clazz, jint maxEntities, jdouble cellSize) {
+    if (maxEntities <= 0) return 0;
+    return (jlong)(intptr_t)macac_spatial_create((size_t)maxEntities, cellSize);
+}
+
+/**
+ * Destroy a spatial index.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroySpatialIndex
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_spatial_destroy((macac_spatial_t*)(intptr_t)handle);
+}
+
+/**
+ * Rebuild the index from count MACAC_SPATIAL_ENTRY_SIZE-byte entries in a
+ * direct buffer. Returns entities indexed, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_spatialUpdate
+  (JNIEnv *env, jclass clazz, jlong handle, jobject entries, jint count) {
+    macac_spatial_t* index = (macac_spatial_t*)(intptr_t)handle;
+    if (!index || count < 0) return -1;
+    if (count == 0) return (jint)macac_spatial_update(index, nullptr, 0);
+    
+    if (!entries) return -1;
+    const macac_spatial_entry_t* data = (const macac_spatial_entry_t*)env->GetDirectBufferAddress(entries);
+    if (!data || env->GetDirectBufferCapacity(entries) < (jlong)count * MACAC_SPATIAL_ENTRY_SIZE) {
+        return -1;
+    }
+    return (jint)macac_spatial_update(index, data, (size_t)count);
+}
+
+/**
+ * Answer count radius (or, with cone, look-cone) queries from a direct
+ * buffer of MACAC_SPATIAL_QUERY_SIZE-byte records. Results go to
+ * count * cap longs in outIds, count * cap doubles in outDist and count
+ * ints in outCounts; outDist and outCounts may be null.
+ * Returns total results written, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_spatialQuery
+  (JNIEnv *env, jclass clazz, jlong handle, jobject queries, jint count, jint cap, jboolean cone,
+   jobject outIds, jobject outDist, jobject outCounts) {
+    macac_spatial_t* index = (macac_spatial_t*)(intptr_t)handle;
+    if (!index || !queries || !outIds || count < 0 || cap < 0) return -1;
+    
+    // Validate capacities before touching native memory
+    jlong slots = (jlong)count * (jlong)cap;
+    const macac_spatial_query_t* q = (const macac_spatial_query_t*)env->GetDirectBufferAddress(queries);
+    int64_t* ids = (int64_t*)env->GetDirectBufferAddress(outIds);
+    if (!q || !ids || env->GetDirectBufferCapacity(queries) < (jlong)count * MACAC_SPATIAL_QUERY_SIZE ||
+        env->GetDirectBufferCapacity(outIds) < slots * (jlong)sizeof(int64_t)) {
+        return -1;
+    }
+    
+    double* dist = nullptr;
+    if (outDist) {
+        dist = (double*)env->GetDirectBufferAddress(outDist);
+        if (!dist || env->GetDirectBufferCapacity(outDist) < slots * (jlong)sizeof(double)) return -1;
+    }
+    uint32_t* counts = nullptr;
+    if (outCounts) {
+        counts = (uint32_t*)env->GetDirectBufferAddress(outCounts);
+        if (!counts || env->GetDirectBufferCapacity(outCounts) < (jlong)count * (jlong)sizeof(uint32_t)) return -1;
+    }
+    
+    size_t total = cone
+        ? macac_spatial_query_cone(index, q, (size_t)count, (size_t)cap, ids, dist, counts)
+        : macac_spatial_query_radius(index, q, (size_t)count, (size_t)cap, ids, dist, counts);
+    return (jint)total;
+}
+
+/**
+ * Get number of indexed entities.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_spatialSize
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    return (jint)macac_spatial_size((macac_spatial_t*)(intptr_t)handle);
+}
+
+// ============================================================================
+// JNI Position History Functions
+// ============================================================================
+
+/**
+ * Create a position history. Returns handle (pointer as long), or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createPositionHistory
+  (JNIEnv *env, jclass clazz, jint maxEntities, jint window) {
+    if (maxEntities <= 0 || window <= 0) return 0;
+    return (jlong)(intptr_t)macac_poshist_create((size_t)maxEntities, (size_t)window);
+}
+
+/**
+ * Destroy a position history.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyPositionHistory
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_poshist_destroy((macac_position_history_t*)(intptr_t)handle);
+}
+
+/**
+ * Record count MACAC_POSITION_SAMPLE_SIZE-byte samples from a direct buffer.
+ * Returns samples stored, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistoryRecord
+  (JNIEnv *env, jclass clazz, jlong handle, jobject samples, jint count) {
+    macac_position_history_t* hist = (macac_position_history_t*)(intptr_t)handle;
+    if (!hist || !samples || count < 0) return -1;
+    
+    const macac_position_sample_t* data = (const macac_position_sample_t*)env->GetDirectBufferAddress(samples);
+    if (!data || env->GetDirectBufferCapacity(samples) < (jlong)count * MACAC_POSITION_SAMPLE_SIZE) {
+        return -1;
+    }
+    return (jint)macac_poshist_record(hist, data, (size_t)count);
+}
+
+/**
+ * Forget an entity.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistoryRemove
+  (JNIEnv *env, jclass clazz, jlong handle, jlong id) {
+    macac_poshist_remove((macac_position_history_t*)(intptr_t)handle, (int64_t)id);
+}
+
+/**
+ * Forget entities with no sample since nanoTime. Returns entities removed.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistoryPrune
+  (JNIEnv *env, jclass clazz, jlong handle, jlong nanoTime) {
+    return (jint)macac_poshist_prune((macac_position_history_t*)(intptr_t)handle, (int64_t)nanoTime);
+}
+
+/**
+ * Get number of tracked entities.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistorySize
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    return (jint)macac_poshist_size((macac_position_history_t*)(intptr_t)handle);
+}
+
+/**
+ * Rewind count entities (longs in a direct buffer) to nanoTime, writing one
+ * sample per id to output. Returns ids found, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistoryRewind
+  (JNIEnv *env, jclass clazz, jlong handle, jobject ids, jint count, jlong nanoTime, jobject output) {
+    macac_position_history_t* hist = (macac_position_history_t*)(intptr_t)handle;
+    if (!hist || !ids || !output || count < 0) return -1;
+    
+    const int64_t* in = (const int64_t*)env->GetDirectBufferAddress(ids);
+    macac_position_sample_t* out = (macac_position_sample_t*)env->GetDirectBufferAddress(output);
+    if (!in || !out || env->GetDirectBufferCapacity(ids) < (jlong)count * (jlong)sizeof(int64_t) ||
+        env->GetDirectBufferCapacity(output) < (jlong)count * MACAC_POSITION_SAMPLE_SIZE) {
+        return -1;
+    }
+    return (jint)macac_poshist_rewind(hist, in, (size_t)count, (int64_t)nanoTime, out);
+}
+
+/**
+ * Distance from an eye position to an entity's bounding box at nanoTime.
+ * Returns NaN if the entity is unknown.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_positionHistoryReach
+  (JNIEnv *env, jclass clazz, jlong handle, jlong id, jlong nanoTime,
+   jdouble eyeX, jdouble eyeY, jdouble eyeZ) {
+    return macac_poshist_reach((macac_position_history_t*)(intptr_t)handle, (int64_t)id,
+                               (int64_t)nanoTime, eyeX, eyeY, eyeZ);
+}
+
 /**
  * Calculate SIMD sum of double array.
  */
@@ -117,12 +524,14 @@ JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdSum
     jsize len = env->GetArrayLength(data);
     if (len == 0) return 0.0;
     
-    jdouble* elements = env->GetDoubleArrayElements(data, NULL);
+    // Critical access pins the array instead of copying it; the kernel is
+    // short and makes no JNI calls while the region is held
+    jdouble* elements = (jdouble*)env->GetPrimitiveArrayCritical(data, NULL);
     if (!elements) return 0.0;
     
     double result = macac_simd_sum(elements, (size_t)len);
     
-    env->ReleaseDoubleArrayElements(data, elements, JNI_ABORT);
+    env->ReleasePrimitiveArrayCritical(data, elements, JNI_ABORT);
     return result;
 }
 
@@ -136,15 +545,29 @@ JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdMean
     jsize len = env->GetArrayLength(data);
     if (len == 0) return 0.0;
     
-    jdouble* elements = env->GetDoubleArrayElements(data, NULL);
+    // Critical access pins the array instead of copying it; the kernel is
+    // short and makes no JNI calls while the region is held
+    jdouble* elements = (jdouble*)env->GetPrimitiveArrayCritical(data, NULL);
     if (!elements) return 0.0;
     
     double result = macac_simd_mean(elements, (size_t)len);
     
-    env->ReleaseDoubleArrayElements(data, elements, JNI_ABORT);
+    env->ReleasePrimitiveArrayCritical(data, elements, JNI_ABORT);
     return result;
 }
 
+/**
+ * Per-thread scratch space for order statistics, grown on demand and
+ * reused across calls so median/MAD do not allocate in steady state.
+ */
+static double* order_scratch(size_t count) {
+    thread_local std::vector<double> scratch;
+    if (scratch.size() < count) {
+        scratch.resize(count);
+    }
+    return scratch.data();
+}
+
 /**
  * Calculate median of double array.
  */
@@ -155,18 +578,11 @@ JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_median
     jsize len = env->GetArrayLength(data);
     if (len == 0) return 0.0;
     
-    jdouble* elements = env->GetDoubleArrayElements(data, NULL);
-    if (!elements) return 0.0;
-    
-    // Create copy for median (modifies array)
-    double* copy = new double[len];
-    memcpy(copy, elements, len * sizeof(double));
-    
-    double result = macac_median(copy, (size_t)len);
+    // [0, len) holds the samples, [len, 2*len) is selection scratch
+    double* buffer = order_scratch((size_t)len * 2);
+    env->GetDoubleArrayRegion(data, 0, len, buffer);
     
-    delete[] copy;
-    env->ReleaseDoubleArrayElements(data, elements, JNI_ABORT);
-    return result;
+    return macac_median_scratch(buffer, (size_t)len, buffer + len);
 }
 
 /**
@@ -179,79 +595,367 @@ JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_mad
     jsize len = env->GetArrayLength(data);
     if (len == 0) return 0.0;
     
-    jdouble* elements = env->GetDoubleArrayElements(data, NULL);
-    if (!elements) return 0.0;
-    
-    // Create copy for MAD (modifies array)
-    double* copy = new double[len];
-    memcpy(copy, elements, len * sizeof(double));
-    
-    double result = macac_mad(copy, (size_t)len);
+    double* buffer = order_scratch((size_t)len * 2);
+    env->GetDoubleArrayRegion(data, 0, len, buffer);
     
-    delete[] copy;
-    env->ReleaseDoubleArrayElements(data, elements, JNI_ABORT);
-    return result;
+    return macac_mad_scratch(buffer, (size_t)len, buffer + len);
 }
 
 // ============================================================================
-// JNI Network Functions
+// JNI Direct Buffer Statistics Functions
 // ============================================================================
 
 /**
- * Connect to analytics server.
- * Returns connection handle or 0 on failure.
+ * First count doubles of a direct buffer, read in place; null if the buffer
+ * is not direct or is too small.
  */
-JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_netConnect
-  (JNIEnv *env, jclass clazz, jstring host, jint port) {
-    if (!host) return 0;
-    
-    const char* hostStr = env->GetStringUTFChars(host, NULL);
-    if (!hostStr) return 0;
-    
-    macac_connection_t* conn = macac_net_connect(hostStr, port);
-    
-    env->ReleaseStringUTFChars(host, hostStr);
-    return (jlong)(intptr_t)conn;
+static const double* direct_doubles(JNIEnv* env, jobject buffer, jint count) {
+    if (!buffer || count <= 0) {
+        return nullptr;
+    }
+    const double* data = (const double*)env->GetDirectBufferAddress(buffer);
+    if (!data || env->GetDirectBufferCapacity(buffer) < (jlong)count * (jlong)sizeof(double)) {
+        return nullptr;
+    }
+    return data;
 }
 
 /**
- * Send violation to server.
+ * Calculate SIMD sum of the first count doubles of a direct buffer.
  */
-JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_netSendViolation
-  (JNIEnv *env, jclass clazz, jlong handle, jstring playerUuid, jstring category,
-   jdouble confidence, jdouble severity, jlong timestamp) {
-    
-    macac_connection_t* conn = (macac_connection_t*)(intptr_t)handle;
-    if (!conn || !playerUuid || !category) return -1;
-    
-    const char* uuidStr = env->GetStringUTFChars(playerUuid, NULL);
-    const char* catStr = env->GetStringUTFChars(category, NULL);
-    
-    if (!uuidStr || !catStr) {
-        if (uuidStr) env->ReleaseStringUTFChars(playerUuid, uuidStr);
-        if (catStr) env->ReleaseStringUTFChars(category, catStr);
-        return -1;
-    }
-    
-    int result = macac_net_send_violation(conn, uuidStr, catStr, confidence, severity, timestamp);
-    
-    env->ReleaseStringUTFChars(playerUuid, uuidStr);
-    env->ReleaseStringUTFChars(category, catStr);
-    
-    return result;
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdSumDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count) {
+    const double* data = direct_doubles(env, buffer, count);
+    return data ? macac_simd_sum(data, (size_t)count) : 0.0;
 }
 
 /**
- * Close network connection.
+ * Calculate SIMD mean of the first count doubles of a direct buffer.
  */
-JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_netClose
-  (JNIEnv *env, jclass clazz, jlong handle) {
-    macac_connection_t* conn = (macac_connection_t*)(intptr_t)handle;
-    macac_net_close(conn);
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdMeanDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count) {
+    const double* data = direct_doubles(env, buffer, count);
+    return data ? macac_simd_mean(data, (size_t)count) : 0.0;
 }
 
 /**
- * Check if connection is alive.
+ * Calculate sample variance (n - 1) of the first count doubles of a direct buffer.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_simdVarianceDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count) {
+    const double* data = direct_doubles(env, buffer, count);
+    if (!data) return 0.0;
+    
+    double mean = macac_simd_mean(data, (size_t)count);
+    return macac_simd_variance(data, (size_t)count, mean);
+}
+
+/**
+ * Describe the first count doubles of a direct buffer in one pass.
+ * Writes {count, sum, mean, variance, min, max, skewness, kurtosis} to out.
+ * Returns 0 on success, -1 if the buffer or out array is invalid.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_simdDescribeDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count, jdoubleArray out) {
+    const double* data = direct_doubles(env, buffer, count);
+    if (!data || !out || env->GetArrayLength(out) < 8) return -1;
+    
+    macac_describe_t d;
+    macac_simd_describe(data, (size_t)count, &d);
+    jdouble values[8] = { (double)d.count, d.sum, d.mean, d.variance,
+                         d.min, d.max, d.skewness, d.kurtosis };
+    env->SetDoubleArrayRegion(out, 0, 8, values);
+    return 0;
+}
+
+/**
+ * Spectrum of a rolling window read in place: the direct buffer holds a
+ * ring of count doubles whose oldest value is at index oldest.
+ * out receives the MACAC_SPECTRAL_FIELDS values of macac_spectral_t.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_spectralDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count, jint oldest, jdoubleArray out) {
+    const double* data = direct_doubles(env, buffer, count);
+    if (!data || oldest < 0 || !out || env->GetArrayLength(out) < MACAC_SPECTRAL_FIELDS) return -1;
+    
+    macac_spectral_t spectrum;
+    int rc = macac_spectral_analyze_ring(data, (size_t)count, (size_t)oldest, &spectrum);
+    env->SetDoubleArrayRegion(out, 0, MACAC_SPECTRAL_FIELDS, (const jdouble*)&spectrum);
+    return rc;
+}
+
+/**
+ * Calculate median of the first count doubles of a direct buffer.
+ * Selection runs on the per-thread scratch; the buffer is read in place.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_medianDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count) {
+    const double* data = direct_doubles(env, buffer, count);
+    if (!data) return 0.0;
+    
+    return macac_median_scratch(data, (size_t)count, order_scratch((size_t)count));
+}
+
+/**
+ * Calculate MAD of the first count doubles of a direct buffer.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_madDirect
+  (JNIEnv *env, jclass clazz, jobject buffer, jint count) {
+    const double* data = direct_doubles(env, buffer, count);
+    if (!data) return 0.0;
+    
+    return macac_mad_scratch(data, (size_t)count, order_scratch((size_t)count));
+}
+
+// ============================================================================
+// JNI Rolling Order Statistics Functions
+// ============================================================================
+
+/**
+ * Create a rolling order-statistics window.
+ * Returns handle (pointer as long).
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createOrderStats
+  (JNIEnv *env, jclass clazz, jint window) {
+    if (window <= 0) {
+        return 0;
+    }
+    macac_order_stats_t* os = macac_order_stats_create((size_t)window);
+    return (jlong)(intptr_t)os;
+}
+
+/**
+ * Destroy a rolling order-statistics window.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyOrderStats
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    macac_order_stats_destroy(os);
+}
+
+/**
+ * Push value to rolling order-statistics window.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsPush
+  (JNIEnv *env, jclass clazz, jlong handle, jdouble value) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    macac_order_stats_push(os, value);
+}
+
+/**
+ * Get rolling median.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsMedian
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    return macac_order_stats_median(os);
+}
+
+/**
+ * Get rolling MAD.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsMad
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    return macac_order_stats_mad(os);
+}
+
+/**
+ * Get k-th smallest element of rolling window.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsSelect
+  (JNIEnv *env, jclass clazz, jlong handle, jint k) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    if (k < 0) {
+        return std::nan("");
+    }
+    return macac_order_stats_select(os, (size_t)k);
+}
+
+/**
+ * Get rolling window size.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsSize
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    return (jint)macac_order_stats_size(os);
+}
+
+/**
+ * Clear rolling order-statistics window.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_orderStatsClear
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_order_stats_t* os = (macac_order_stats_t*)(intptr_t)handle;
+    macac_order_stats_clear(os);
+}
+
+// ============================================================================
+// JNI Population Baseline Functions
+// ============================================================================
+
+/**
+ * Create a population baseline.
+ * Returns handle (pointer as long), or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createPopulation
+  (JNIEnv *env, jclass clazz, jint metrics, jint compression, jlong windowMs) {
+    if (metrics <= 0 || compression < 0) {
+        return 0;
+    }
+    macac_population_t* p = macac_population_create((size_t)metrics, (uint32_t)compression, (int64_t)windowMs);
+    return (jlong)(intptr_t)p;
+}
+
+/**
+ * Destroy a population baseline.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyPopulation
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    macac_population_destroy(p);
+}
+
+/**
+ * Add one sample of a metric.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_populationAdd
+  (JNIEnv *env, jclass clazz, jlong handle, jint metric, jdouble value) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    if (metric < 0) {
+        return;
+    }
+    macac_population_add(p, (size_t)metric, value);
+}
+
+/**
+ * Add one sample of every metric; missing entries count as NaN (skipped).
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_populationAddRow
+  (JNIEnv *env, jclass clazz, jlong handle, jdoubleArray values) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    if (!p || !values) {
+        return;
+    }
+    
+    double row[MACAC_POPULATION_MAX_METRICS];
+    jsize len = env->GetArrayLength(values);
+    if (len > MACAC_POPULATION_MAX_METRICS) {
+        len = MACAC_POPULATION_MAX_METRICS;
+    }
+    env->GetDoubleArrayRegion(values, 0, len, row);
+    for (jsize i = len; i < MACAC_POPULATION_MAX_METRICS; i++) {
+        row[i] = std::nan("");
+    }
+    macac_population_add_row(p, row);
+}
+
+/**
+ * Merge the per-thread shards into the snapshot queries read.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_populationRefresh
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    macac_population_refresh(p);
+}
+
+/**
+ * Value at quantile q of a metric, or NaN if it has no samples.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_populationQuantile
+  (JNIEnv *env, jclass clazz, jlong handle, jint metric, jdouble q) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    if (metric < 0) {
+        return std::nan("");
+    }
+    return macac_population_quantile(p, (size_t)metric, q);
+}
+
+/**
+ * Fraction of a metric's samples at or below x, or NaN if it has none.
+ */
+JNIEXPORT jdouble JNICALL Java_com_macmoment_macac_util_NativeHelper_populationCdf
+  (JNIEnv *env, jclass clazz, jlong handle, jint metric, jdouble x) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    if (metric < 0) {
+        return std::nan("");
+    }
+    return macac_population_cdf(p, (size_t)metric, x);
+}
+
+/**
+ * Samples of a metric the current snapshot covers.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_populationCount
+  (JNIEnv *env, jclass clazz, jlong handle, jint metric) {
+    macac_population_t* p = (macac_population_t*)(intptr_t)handle;
+    if (metric < 0) {
+        return 0;
+    }
+    macac_population_stats_t stats;
+    macac_population_get_stats(p, (size_t)metric, &stats);
+    return (jlong)stats.count;
+}
+
+// ============================================================================
+// JNI Network Functions
+// ============================================================================
+
+/**
+ * Connect to analytics server.
+ * Returns connection handle or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_netConnect
+  (JNIEnv *env, jclass clazz, jstring host, jint port) {
+    if (!host) return 0;
+    
+    const char* hostStr = env->GetStringUTFChars(host, NULL);
+    if (!hostStr) return 0;
+    
+    macac_connection_t* conn = macac_net_connect(hostStr, port);
+    
+    env->ReleaseStringUTFChars(host, hostStr);
+    return (jlong)(intptr_t)conn;
+}
+
+/**
+ * Send violation to server.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_netSendViolation
+  (JNIEnv *env, jclass clazz, jlong handle, jstring playerUuid, jstring category,
+   jdouble confidence, jdouble severity, jlong timestamp) {
+    
+    macac_connection_t* conn = (macac_connection_t*)(intptr_t)handle;
+    if (!conn || !playerUuid || !category) return -1;
+    
+    const char* uuidStr = env->GetStringUTFChars(playerUuid, NULL);
+    const char* catStr = env->GetStringUTFChars(category, NULL);
+    
+    if (!uuidStr || !catStr) {
+        if (uuidStr) env->ReleaseStringUTFChars(playerUuid, uuidStr);
+        if (catStr) env->ReleaseStringUTFChars(category, catStr);
+        return -1;
+    }
+    
+    int result = macac_net_send_violation(conn, uuidStr, catStr, confidence, severity, timestamp);
+    
+    env->ReleaseStringUTFChars(playerUuid, uuidStr);
+    env->ReleaseStringUTFChars(category, catStr);
+    
+    return result;
+}
+
+/**
+ * Close network connection.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_netClose
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_connection_t* conn = (macac_connection_t*)(intptr_t)handle;
+    macac_net_close(conn);
+}
+
+/**
+ * Check if connection is alive.
  */
 JNIEXPORT jboolean JNICALL Java_com_macmoment_macac_util_NativeHelper_netIsConnected
   (JNIEnv *env, jclass clazz, jlong handle) {
@@ -259,6 +963,350 @@ JNIEXPORT jboolean JNICALL Java_com_macmoment_macac_util_NativeHelper_netIsConne
     return macac_net_is_connected(conn) ? JNI_TRUE : JNI_FALSE;
 }
 
+// ============================================================================
+// JNI Async Sender Functions
+// ============================================================================
+
+/**
+ * Copy a Java string as modified UTF-8 into a caller buffer without
+ * allocating. Returns false if it does not fit.
+ */
+static bool copy_utf(JNIEnv *env, jstring str, char* buffer, size_t buffer_size) {
+    jsize utf_len = env->GetStringUTFLength(str);
+    if (utf_len < 0 || (size_t)utf_len >= buffer_size) {
+        return false;
+    }
+    env->GetStringUTFRegion(str, 0, env->GetStringLength(str), buffer);
+    buffer[utf_len] = '\0';
+    return true;
+}
+
+/**
+ * Create an async sender and start its I/O thread.
+ * Returns handle or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderCreate
+  (JNIEnv *env, jclass clazz, jstring host, jint port, jint queueCapacity,
+   jint connectTimeoutMs, jint reconnectDelayMs, jint protocol) {
+    if (!host || queueCapacity <= 0) return 0;
+    
+    const char* hostStr = env->GetStringUTFChars(host, NULL);
+    if (!hostStr) return 0;
+    
+    macac_sender_t* sender = macac_sender_create(hostStr, port, (size_t)queueCapacity,
+                                                 connectTimeoutMs, reconnectDelayMs, protocol);
+    
+    env->ReleaseStringUTFChars(host, hostStr);
+    return (jlong)(intptr_t)sender;
+}
+
+/**
+ * Create an async sender over a comma-separated endpoint list.
+ * Returns handle or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderCreatePool
+  (JNIEnv *env, jclass clazz, jstring endpoints, jint defaultPort, jint queueCapacity,
+   jint connectTimeoutMs, jint reconnectDelayMs, jint protocol) {
+    if (!endpoints || queueCapacity <= 0) return 0;
+    
+    const char* endpointsStr = env->GetStringUTFChars(endpoints, NULL);
+    if (!endpointsStr) return 0;
+    
+    macac_sender_t* sender = macac_sender_create_pool(endpointsStr, defaultPort, (size_t)queueCapacity,
+                                                      connectTimeoutMs, reconnectDelayMs, protocol);
+    
+    env->ReleaseStringUTFChars(endpoints, endpointsStr);
+    return (jlong)(intptr_t)sender;
+}
+
+/**
+ * Create a pooled async sender that spills to disk during outages.
+ * Byte sizes of 0 use the native defaults; highWater 0 is 3/4 of the queue.
+ * Returns handle or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderCreateSpill
+  (JNIEnv *env, jclass clazz, jstring endpoints, jint defaultPort, jint queueCapacity,
+   jint connectTimeoutMs, jint reconnectDelayMs, jint protocol, jstring directory,
+   jlong segmentBytes, jlong maxBytes, jint highWater) {
+    if (!endpoints || !directory || queueCapacity <= 0 || segmentBytes < 0 || maxBytes < 0 || highWater < 0) {
+        return 0;
+    }
+    
+    const char* endpointsStr = env->GetStringUTFChars(endpoints, NULL);
+    if (!endpointsStr) return 0;
+    const char* directoryStr = env->GetStringUTFChars(directory, NULL);
+    if (!directoryStr) {
+        env->ReleaseStringUTFChars(endpoints, endpointsStr);
+        return 0;
+    }
+    
+    macac_spill_config_t spill = { directoryStr, (size_t)segmentBytes, (size_t)maxBytes, (size_t)highWater };
+    macac_sender_t* sender = macac_sender_create_spill(endpointsStr, defaultPort, (size_t)queueCapacity,
+                                                       connectTimeoutMs, reconnectDelayMs, protocol, &spill);
+    
+    env->ReleaseStringUTFChars(directory, directoryStr);
+    env->ReleaseStringUTFChars(endpoints, endpointsStr);
+    return (jlong)(intptr_t)sender;
+}
+
+/**
+ * Flush (bounded) and destroy an async sender.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_senderDestroy
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_destroy(sender);
+}
+
+/**
+ * Queue a violation on an async sender.
+ * Strings are copied onto the stack, so the fast path does not allocate.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_senderSendViolation
+  (JNIEnv *env, jclass clazz, jlong handle, jstring playerUuid, jstring category,
+   jdouble confidence, jdouble severity, jlong timestamp) {
+    
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    if (!sender || !playerUuid || !category) return -1;
+    
+    char uuidStr[MACAC_SENDER_MAX_MESSAGE + 1];
+    char catStr[MACAC_SENDER_MAX_MESSAGE + 1];
+    if (!copy_utf(env, playerUuid, uuidStr, sizeof(uuidStr)) ||
+        !copy_utf(env, category, catStr, sizeof(catStr))) {
+        return -1;
+    }
+    
+    return macac_sender_send_violation(sender, uuidStr, catStr, confidence, severity, timestamp);
+}
+
+/**
+ * Wait for an async sender to drain.
+ */
+JNIEXPORT jboolean JNICALL Java_com_macmoment_macac_util_NativeHelper_senderFlush
+  (JNIEnv *env, jclass clazz, jlong handle, jint timeoutMs) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    return macac_sender_flush(sender, timeoutMs) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Get async sender queue depth (queued + in flight).
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_senderQueueDepth
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return (jint)stats.queue_depth;
+}
+
+/**
+ * Get async sender drop count.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderDroppedCount
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return (jlong)stats.dropped;
+}
+
+/**
+ * Get async sender sent count.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderSentCount
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return (jlong)stats.sent;
+}
+
+/**
+ * Check if async sender is connected.
+ */
+JNIEXPORT jboolean JNICALL Java_com_macmoment_macac_util_NativeHelper_senderIsConnected
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return stats.connected ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Get the wire protocol version negotiated by an async sender (0 if none).
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_senderProtocolVersion
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return (jint)stats.protocol_version;
+}
+
+/**
+ * Get the number of records an async sender failed over to another endpoint.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_senderFailoverCount
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    return (jlong)stats.failovers;
+}
+
+/**
+ * Get one endpoint's counters as {state, sent, reconnects, backlog,
+ * protocolVersion}, or null if the index is out of range.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_macmoment_macac_util_NativeHelper_senderEndpointStats
+  (JNIEnv *env, jclass clazz, jlong handle, jint index) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_endpoint_stats_t stats;
+    if (macac_sender_get_endpoint_stats(sender, index, &stats) != 0) {
+        return nullptr;
+    }
+    
+    jlongArray result = env->NewLongArray(5);
+    if (result) {
+        jlong values[5] = {
+            (jlong)stats.state, (jlong)stats.sent, (jlong)stats.reconnects,
+            (jlong)stats.backlog, (jlong)stats.protocol_version
+        };
+        env->SetLongArrayRegion(result, 0, 5, values);
+    }
+    return result;
+}
+
+/**
+ * Get an async sender's spill counters as {spilled, replayed, depth}.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_macmoment_macac_util_NativeHelper_senderSpillStats
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)handle;
+    macac_sender_stats_t stats;
+    macac_sender_get_stats(sender, &stats);
+    
+    jlongArray result = env->NewLongArray(3);
+    if (result) {
+        jlong values[3] = { (jlong)stats.spilled, (jlong)stats.replayed, (jlong)stats.spill_depth };
+        env->SetLongArrayRegion(result, 0, 3, values);
+    }
+    return result;
+}
+
+// ============================================================================
+// JNI Violation Coalescer Functions
+// ============================================================================
+
+/**
+ * Create a coalescer in front of an async sender.
+ * Returns handle or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_coalescerCreate
+  (JNIEnv *env, jclass clazz, jlong senderHandle, jint maxRecords, jint windowMs, jint flushCount) {
+    macac_sender_t* sender = (macac_sender_t*)(intptr_t)senderHandle;
+    if (!sender || maxRecords <= 0 || flushCount < 0) return 0;
+    
+    macac_coalescer_t* coalescer = macac_coalescer_create(sender, (size_t)maxRecords, windowMs,
+                                                          (uint32_t)flushCount);
+    return (jlong)(intptr_t)coalescer;
+}
+
+/**
+ * Send every open record and destroy a coalescer.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_coalescerDestroy
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_coalescer_t* coalescer = (macac_coalescer_t*)(intptr_t)handle;
+    macac_coalescer_destroy(coalescer);
+}
+
+/**
+ * Add a violation to a coalescer.
+ * Strings are copied onto the stack, so the fast path does not allocate.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_coalescerAdd
+  (JNIEnv *env, jclass clazz, jlong handle, jstring playerUuid, jstring category,
+   jdouble confidence, jdouble severity, jlong timestamp) {
+    
+    macac_coalescer_t* coalescer = (macac_coalescer_t*)(intptr_t)handle;
+    if (!coalescer || !playerUuid || !category) return -1;
+    
+    char uuidStr[MACAC_SENDER_MAX_MESSAGE + 1];
+    char catStr[MACAC_SENDER_MAX_MESSAGE + 1];
+    if (!copy_utf(env, playerUuid, uuidStr, sizeof(uuidStr)) ||
+        !copy_utf(env, category, catStr, sizeof(catStr))) {
+        return -1;
+    }
+    
+    return macac_coalescer_add(coalescer, uuidStr, catStr, confidence, severity, timestamp);
+}
+
+/**
+ * Send every open record of a coalescer now.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_coalescerFlush
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_coalescer_t* coalescer = (macac_coalescer_t*)(intptr_t)handle;
+    return (jint)macac_coalescer_flush(coalescer);
+}
+
+/**
+ * Get a coalescer's counters as {accepted, merged, summaries, singles,
+ * passthrough, rejected, open}.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_macmoment_macac_util_NativeHelper_coalescerStats
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_coalescer_t* coalescer = (macac_coalescer_t*)(intptr_t)handle;
+    macac_coalescer_stats_t stats;
+    macac_coalescer_get_stats(coalescer, &stats);
+    
+    jlongArray result = env->NewLongArray(7);
+    if (result) {
+        jlong values[7] = {
+            (jlong)stats.accepted, (jlong)stats.merged, (jlong)stats.summaries,
+            (jlong)stats.singles, (jlong)stats.passthrough, (jlong)stats.rejected,
+            (jlong)stats.open
+        };
+        env->SetLongArrayRegion(result, 0, 7, values);
+    }
+    return result;
+}
+
+// ============================================================================
+// JNI Movement Prediction Functions
+// ============================================================================
+
+/**
+ * One physics step for count players over direct buffers.
+ * Input holds MACAC_MOVE_INPUT_COLUMNS double columns and output
+ * MACAC_MOVE_OUTPUT_COLUMNS, each stride entries apart. Both buffers must
+ * be direct and in native byte order.
+ * Returns number of players written, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_predictMovementBatch
+  (JNIEnv *env, jclass clazz, jobject input, jint count, jint stride, jobject output) {
+    
+    if (!input || !output || count <= 0 || stride < count) {
+        return -1;
+    }
+    
+    double* in = (double*)env->GetDirectBufferAddress(input);
+    double* out = (double*)env->GetDirectBufferAddress(output);
+    if (!in || !out) {
+        return -1;
+    }
+    
+    jlong inputBytes = env->GetDirectBufferCapacity(input);
+    jlong outputBytes = env->GetDirectBufferCapacity(output);
+    if (inputBytes < MACAC_MOVE_INPUT_COLUMNS * (jlong)stride * (jlong)sizeof(double) ||
+        outputBytes < MACAC_MOVE_OUTPUT_COLUMNS * (jlong)stride * (jlong)sizeof(double)) {
+        return -1;
+    }
+    
+    return (jint)macac_movement_predict_batch(in, (size_t)count, (size_t)stride, out);
+}
+
 // ============================================================================
 // JNI Combat Analysis Functions
 // ============================================================================
@@ -338,43 +1386,41 @@ JNIEXPORT jdoubleArray JNICALL Java_com_macmoment_macac_util_NativeHelper_analyz
         return nullptr;
     }
     
+    // Shortest input bounds every column
     jsize count = env->GetArrayLength(aimErrors);
+    count = std::min(count, env->GetArrayLength(snapAngles));
+    count = std::min(count, env->GetArrayLength(reaches));
+    count = std::min(count, env->GetArrayLength(attackIntervals));
+    count = std::min(count, env->GetArrayLength(hits));
     if (count < 5) {
         return nullptr;
     }
     
-    // Get array elements
-    jdouble* aimErrorsData = env->GetDoubleArrayElements(aimErrors, NULL);
-    jdouble* snapAnglesData = env->GetDoubleArrayElements(snapAngles, NULL);
-    jdouble* reachesData = env->GetDoubleArrayElements(reaches, NULL);
-    jdouble* intervalsData = env->GetDoubleArrayElements(attackIntervals, NULL);
-    jdouble* hitsData = env->GetDoubleArrayElements(hits, NULL);
-    
-    if (!aimErrorsData || !snapAnglesData || !reachesData || !intervalsData || !hitsData) {
-        if (aimErrorsData) env->ReleaseDoubleArrayElements(aimErrors, aimErrorsData, JNI_ABORT);
-        if (snapAnglesData) env->ReleaseDoubleArrayElements(snapAngles, snapAnglesData, JNI_ABORT);
-        if (reachesData) env->ReleaseDoubleArrayElements(reaches, reachesData, JNI_ABORT);
-        if (intervalsData) env->ReleaseDoubleArrayElements(attackIntervals, intervalsData, JNI_ABORT);
-        if (hitsData) env->ReleaseDoubleArrayElements(hits, hitsData, JNI_ABORT);
-        return nullptr;
+    // Pin all five arrays; the analysis makes no JNI calls until released
+    jdoubleArray arrays[5] = { aimErrors, snapAngles, reaches, attackIntervals, hits };
+    jdouble* data[5] = {};
+    bool pinned = true;
+    for (int i = 0; i < 5 && pinned; i++) {
+        data[i] = (jdouble*)env->GetPrimitiveArrayCritical(arrays[i], NULL);
+        pinned = data[i] != nullptr;
     }
     
-    // Perform analysis
     macac_combat_analysis_t analysis;
-    macac_analyze_combat(aimErrorsData, snapAnglesData, reachesData,
-                         intervalsData, hitsData, (size_t)count, &analysis);
+    if (pinned) {
+        macac_analyze_combat(data[0], data[1], data[2], data[3], data[4], (size_t)count, &analysis);
+    }
     
-    // Release arrays
-    env->ReleaseDoubleArrayElements(aimErrors, aimErrorsData, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(snapAngles, snapAnglesData, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(reaches, reachesData, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(attackIntervals, intervalsData, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(hits, hitsData, JNI_ABORT);
+    for (int i = 4; i >= 0; i--) {
+        if (data[i]) env->ReleasePrimitiveArrayCritical(arrays[i], data[i], JNI_ABORT);
+    }
+    if (!pinned) {
+        return nullptr;
+    }
     
     // Create result array
-    jdoubleArray result = env->NewDoubleArray(10);
+    jdoubleArray result = env->NewDoubleArray(13);
     if (result) {
-        jdouble values[10] = {
+        jdouble values[13] = {
             analysis.aimbot_confidence,
             analysis.reach_confidence,
             analysis.autoclicker_confidence,
@@ -384,9 +1430,537 @@ JNIEXPORT jdoubleArray JNICALL Java_com_macmoment_macac_util_NativeHelper_analyz
             analysis.avg_snap_angle,
             analysis.avg_reach,
             analysis.hit_rate,
-            analysis.avg_attack_interval
+            analysis.avg_attack_interval,
+            analysis.spectral_entropy,
+            analysis.spectral_peak,
+            analysis.interval_autocorr
+        };
+        env->SetDoubleArrayRegion(result, 0, 13, values);
+    }
+    return result;
+}
+
+/**
+ * Analyze combat data for a batch of players over direct buffers.
+ * Input layout is documented at MACAC_COMBAT_BATCH_STRIDE; output receives
+ * one macac_combat_analysis_t (13 doubles) per player.
+ * Both buffers must be direct and in native byte order.
+ * Returns number of records written, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_analyzeCombatBatch
+  (JNIEnv *env, jclass clazz, jobject input, jint playerCount, jint window, jobject output) {
+    
+    if (!input || !output || playerCount < 0 || window <= 0) {
+        return -1;
+    }
+    
+    double* packed = (double*)env->GetDirectBufferAddress(input);
+    macac_combat_analysis_t* results =
+        (macac_combat_analysis_t*)env->GetDirectBufferAddress(output);
+    if (!packed || !results) {
+        return -1;
+    }
+    
+    // Validate capacities before touching native memory
+    jlong inputBytes = env->GetDirectBufferCapacity(input);
+    jlong outputBytes = env->GetDirectBufferCapacity(output);
+    jlong neededInput = (jlong)playerCount * (jlong)MACAC_COMBAT_BATCH_STRIDE((jlong)window)
+                        * (jlong)sizeof(double);
+    jlong neededOutput = (jlong)playerCount * (jlong)sizeof(macac_combat_analysis_t);
+    if (inputBytes < neededInput || outputBytes < neededOutput) {
+        return -1;
+    }
+    
+    return (jint)macac_analyze_combat_batch(packed, (size_t)playerCount, (size_t)window, results);
+}
+
+/**
+ * Batch single-precision distances over direct buffers.
+ * Input holds six float columns of count entries (ax, ay, az, bx, by, bz);
+ * output receives count floats. Both buffers must be direct and in native
+ * byte order.
+ * Returns number of distances written, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_batchDistance3DF32
+  (JNIEnv *env, jclass clazz, jobject input, jint count, jobject output) {
+    
+    if (!input || !output || count < 0) {
+        return -1;
+    }
+    
+    float* columns = (float*)env->GetDirectBufferAddress(input);
+    float* distances = (float*)env->GetDirectBufferAddress(output);
+    if (!columns || !distances) {
+        return -1;
+    }
+    
+    jlong inputBytes = env->GetDirectBufferCapacity(input);
+    jlong outputBytes = env->GetDirectBufferCapacity(output);
+    if (inputBytes < 6 * (jlong)count * (jlong)sizeof(float) ||
+        outputBytes < (jlong)count * (jlong)sizeof(float)) {
+        return -1;
+    }
+    
+    size_t n = (size_t)count;
+    macac_batch_distance_3d_soa_f32(columns, columns + n, columns + 2 * n,
+                                    columns + 3 * n, columns + 4 * n, columns + 5 * n,
+                                    distances, n);
+    return count;
+}
+
+/**
+ * Batch aim error from one attacker to count targets over direct buffers.
+ * Targets hold three double columns (x, y, z); output, if not null,
+ * receives three double columns (expected yaw, expected pitch, error).
+ * Returns index of the best-aimed target, or -1 if there is none or the
+ * arguments are invalid.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_batchAimError
+  (JNIEnv *env, jclass clazz, jdouble attackerX, jdouble attackerY, jdouble attackerZ,
+   jdouble yaw, jdouble pitch, jobject targets, jint count, jobject output) {
+    
+    if (!targets || count <= 0) {
+        return -1;
+    }
+    
+    double* columns = (double*)env->GetDirectBufferAddress(targets);
+    if (!columns || env->GetDirectBufferCapacity(targets) < 3 * (jlong)count * (jlong)sizeof(double)) {
+        return -1;
+    }
+    
+    size_t n = (size_t)count;
+    double* results = nullptr;
+    if (output) {
+        results = (double*)env->GetDirectBufferAddress(output);
+        if (!results || env->GetDirectBufferCapacity(output) < 3 * (jlong)count * (jlong)sizeof(double)) {
+            return -1;
+        }
+    }
+    
+    int64_t best = macac_batch_aim_error(attackerX, attackerY, attackerZ, yaw, pitch,
+                                         columns, columns + n, columns + 2 * n, n,
+                                         results, results ? results + n : nullptr,
+                                         results ? results + 2 * n : nullptr);
+    return (jint)best;
+}
+
+// ============================================================================
+// JNI Incremental Combat Accumulator Functions
+// ============================================================================
+
+/**
+ * Create an incremental combat accumulator over the last window samples
+ * of each column.
+ * Returns handle (pointer as long), or 0 on failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createCombatAccum
+  (JNIEnv *env, jclass clazz, jint window) {
+    if (window <= 0) {
+        return 0;
+    }
+    return (jlong)(intptr_t)macac_combat_accum_create((size_t)window);
+}
+
+/**
+ * Destroy an incremental combat accumulator.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyCombatAccum
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_combat_accum_destroy((macac_combat_accum_t*)(intptr_t)handle);
+}
+
+/**
+ * Push one sample into a column (MACAC_COMBAT_* index).
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_combatAccumPush
+  (JNIEnv *env, jclass clazz, jlong handle, jint column, jdouble value) {
+    macac_combat_accum_push((macac_combat_accum_t*)(intptr_t)handle, (int)column, value);
+}
+
+/**
+ * Clear all columns of an accumulator.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_combatAccumClear
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_combat_accum_clear((macac_combat_accum_t*)(intptr_t)handle);
+}
+
+/**
+ * Score the accumulated window into one macac_combat_analysis_t
+ * (10 doubles) in a direct, native-order buffer.
+ * Returns 1 on success, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_combatAccumAnalyze
+  (JNIEnv *env, jclass clazz, jlong handle, jobject output) {
+    macac_combat_accum_t* acc = (macac_combat_accum_t*)(intptr_t)handle;
+    if (!acc || !output) {
+        return -1;
+    }
+    
+    macac_combat_analysis_t* result =
+        (macac_combat_analysis_t*)env->GetDirectBufferAddress(output);
+    if (!result || env->GetDirectBufferCapacity(output) < (jlong)sizeof(macac_combat_analysis_t)) {
+        return -1;
+    }
+    
+    macac_combat_accum_analyze(acc, result);
+    return 1;
+}
+
+// ============================================================================
+// JNI Latency Instrumentation Functions
+// ============================================================================
+
+/**
+ * Register or look up a timing site by name.
+ * Returns the site id, or -1 if the name is invalid or the table is full.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_perfRegister
+  (JNIEnv *env, jclass clazz, jstring name) {
+    if (!name) {
+        return MACAC_PERF_NO_SITE;
+    }
+    const char* chars = env->GetStringUTFChars(name, NULL);
+    if (!chars) {
+        return MACAC_PERF_NO_SITE;
+    }
+    int site = macac_perf_register(chars);
+    env->ReleaseStringUTFChars(name, chars);
+    return (jint)site;
+}
+
+/**
+ * Start timestamp for perfEnd.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_perfBegin
+  (JNIEnv *env, jclass clazz) {
+    return (jlong)macac_perf_begin();
+}
+
+/**
+ * Record the time since begin against a site.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_perfEnd
+  (JNIEnv *env, jclass clazz, jint site, jlong begin) {
+    macac_perf_end((int)site, (uint64_t)begin);
+}
+
+/**
+ * Number of registered timing sites.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_perfSiteCount
+  (JNIEnv *env, jclass clazz) {
+    return (jint)macac_perf_site_count();
+}
+
+/**
+ * Name of a timing site, or null if not registered.
+ */
+JNIEXPORT jstring JNICALL Java_com_macmoment_macac_util_NativeHelper_perfSiteName
+  (JNIEnv *env, jclass clazz, jint site) {
+    const char* name = macac_perf_site_name((int)site);
+    return name ? env->NewStringUTF(name) : nullptr;
+}
+
+/**
+ * Merged latency summary of a site.
+ * Returns array [count, mean_ns, p50_ns, p99_ns, p999_ns, max_ns], or null
+ * if the site is not registered.
+ */
+JNIEXPORT jdoubleArray JNICALL Java_com_macmoment_macac_util_NativeHelper_perfSnapshot
+  (JNIEnv *env, jclass clazz, jint site) {
+    macac_perf_snapshot_t snap;
+    if (macac_perf_snapshot((int)site, &snap) != 0) {
+        return nullptr;
+    }
+    
+    jdoubleArray result = env->NewDoubleArray(6);
+    if (result) {
+        jdouble values[6] = {
+            (double)snap.count, snap.mean_ns, snap.p50_ns, snap.p99_ns, snap.p999_ns, snap.max_ns
+        };
+        env->SetDoubleArrayRegion(result, 0, 6, values);
+    }
+    return result;
+}
+
+/**
+ * Zero all timing histograms.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_perfReset
+  (JNIEnv *env, jclass clazz) {
+    macac_perf_reset();
+}
+
+// ============================================================================
+// JNI Hardware Counter Profiling Functions
+// ============================================================================
+
+/**
+ * Start a hardware counter session.
+ * Returns the bitmask of events counted, or 0 if perf events are unavailable.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_pmuStart
+  (JNIEnv *env, jclass clazz) {
+    return (jint)macac_pmu_start();
+}
+
+/**
+ * End the hardware counter session.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_pmuStop
+  (JNIEnv *env, jclass clazz) {
+    macac_pmu_stop();
+}
+
+/**
+ * Whether a hardware counter session runs.
+ */
+JNIEXPORT jboolean JNICALL Java_com_macmoment_macac_util_NativeHelper_pmuActive
+  (JNIEnv *env, jclass clazz) {
+    return macac_pmu_active() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Counter totals of a site.
+ * Returns array [scopes, partial, events, cycles, instructions, l1d_misses,
+ * llc_misses, branch_misses, task_clock_ns], or null if the site is not
+ * registered.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_macmoment_macac_util_NativeHelper_pmuSnapshot
+  (JNIEnv *env, jclass clazz, jint site) {
+    macac_pmu_snapshot_t snap;
+    if (macac_pmu_snapshot((int)site, &snap) != 0) {
+        return nullptr;
+    }
+    
+    jlongArray result = env->NewLongArray(3 + MACAC_PMU_EVENTS);
+    if (result) {
+        jlong values[3 + MACAC_PMU_EVENTS] = {
+            (jlong)snap.scopes, (jlong)snap.partial, (jlong)snap.events
+        };
+        for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+            values[3 + e] = (jlong)snap.values[e];
+        }
+        env->SetLongArrayRegion(result, 0, 3 + MACAC_PMU_EVENTS, values);
+    }
+    return result;
+}
+
+// ============================================================================
+// JNI Packet Queue Functions
+// ============================================================================
+
+/**
+ * Create a telemetry queue. mode is MACAC_QUEUE_SPSC (0) or MACAC_QUEUE_MPSC (1).
+ * Returns a handle, or 0 on invalid arguments / allocation failure.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_createPacketQueue
+  (JNIEnv *env, jclass clazz, jint capacity, jint mode) {
+    if (capacity <= 0) {
+        return 0;
+    }
+    return (jlong)(intptr_t)macac_queue_create((size_t)capacity, (int)mode);
+}
+
+/**
+ * Destroy a telemetry queue.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_destroyPacketQueue
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_queue_destroy((macac_packet_queue_t*)(intptr_t)handle);
+}
+
+/**
+ * Queue one movement sample. Fields are passed as scalars so producer
+ * threads need neither a buffer nor an allocation.
+ * Returns 0 if queued, -1 if dropped or the handle is invalid.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueuePush
+  (JNIEnv *env, jclass clazz, jlong handle, jint player, jint flags,
+   jdouble dx, jdouble dy, jdouble dz,
+   jfloat yaw, jfloat pitch, jfloat deltaYaw, jfloat deltaPitch,
+   jint ping, jlong nanoTime, jlong tickDelta) {
+    macac_packet_queue_t* queue = (macac_packet_queue_t*)(intptr_t)handle;
+    if (!queue) {
+        return -1;
+    }
+    
+    macac_telemetry_record_t record;
+    record.dx = dx;
+    record.dy = dy;
+    record.dz = dz;
+    record.yaw = yaw;
+    record.pitch = pitch;
+    record.delta_yaw = deltaYaw;
+    record.delta_pitch = deltaPitch;
+    record.nano_time = nanoTime;
+    record.tick_delta = tickDelta;
+    record.ping = ping;
+    record.player = player;
+    record.flags = (uint32_t)flags;
+    record.reserved = 0;
+    return (jint)macac_queue_push(queue, &record);
+}
+
+/**
+ * Drain up to max records into a direct, native-order buffer of
+ * MACAC_TELEMETRY_RECORD_SIZE-byte records.
+ * Returns the number of records written, or -1 on invalid arguments.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueueDrain
+  (JNIEnv *env, jclass clazz, jlong handle, jobject output, jint max) {
+    macac_packet_queue_t* queue = (macac_packet_queue_t*)(intptr_t)handle;
+    if (!queue || !output || max < 0) {
+        return -1;
+    }
+    
+    macac_telemetry_record_t* out =
+        (macac_telemetry_record_t*)env->GetDirectBufferAddress(output);
+    if (!out || env->GetDirectBufferCapacity(output) < (jlong)max * MACAC_TELEMETRY_RECORD_SIZE) {
+        return -1;
+    }
+    
+    return (jint)macac_queue_drain(queue, out, (size_t)max);
+}
+
+/**
+ * Approximate number of queued records.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueueSize
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    return (jint)macac_queue_size((macac_packet_queue_t*)(intptr_t)handle);
+}
+
+/**
+ * Records dropped because the queue was full.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_packetQueueDropped
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    return (jlong)macac_queue_dropped((macac_packet_queue_t*)(intptr_t)handle);
+}
+
+// ============================================================================
+// JNI Telemetry Capture Functions
+// ============================================================================
+
+/**
+ * Start a capture. Returns a handle, or 0 if the first file cannot be created.
+ */
+JNIEXPORT jlong JNICALL Java_com_macmoment_macac_util_NativeHelper_captureOpen
+  (JNIEnv *env, jclass clazz, jstring prefix, jint capacity, jlong maxFileBytes, jint maxFiles) {
+    if (!prefix || capacity <= 0 || maxFileBytes <= 0 || maxFiles < 0) {
+        return 0;
+    }
+    
+    const char* chars = env->GetStringUTFChars(prefix, NULL);
+    if (!chars) return 0;
+    
+    macac_capture_t* capture = macac_capture_open(chars, (size_t)capacity,
+                                                  (uint64_t)maxFileBytes, (uint32_t)maxFiles);
+    env->ReleaseStringUTFChars(prefix, chars);
+    return (jlong)(intptr_t)capture;
+}
+
+/**
+ * Flush and stop a capture.
+ */
+JNIEXPORT void JNICALL Java_com_macmoment_macac_util_NativeHelper_captureClose
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_capture_close((macac_capture_t*)(intptr_t)handle);
+}
+
+/**
+ * Queue one movement sample, passed as scalars like packetQueuePush.
+ * Returns 0 if queued, -1 if dropped or the handle is invalid.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_captureTelemetry
+  (JNIEnv *env, jclass clazz, jlong handle, jlong playerHi, jlong playerLo, jint flags,
+   jdouble dx, jdouble dy, jdouble dz,
+   jfloat yaw, jfloat pitch, jfloat deltaYaw, jfloat deltaPitch,
+   jint ping, jlong nanoTime, jlong tickDelta) {
+    macac_capture_t* capture = (macac_capture_t*)(intptr_t)handle;
+    if (!capture) {
+        return -1;
+    }
+    
+    macac_telemetry_record_t record;
+    record.dx = dx;
+    record.dy = dy;
+    record.dz = dz;
+    record.yaw = yaw;
+    record.pitch = pitch;
+    record.delta_yaw = deltaYaw;
+    record.delta_pitch = deltaPitch;
+    record.nano_time = nanoTime;
+    record.tick_delta = tickDelta;
+    record.ping = ping;
+    record.player = 0;
+    record.flags = (uint32_t)flags;
+    record.reserved = 0;
+    return (jint)macac_capture_telemetry(capture, (uint64_t)playerHi, (uint64_t)playerLo, &record);
+}
+
+/**
+ * Queue one attack. flags are MACAC_CAPTURE_* bits.
+ * Returns 0 if queued, -1 if dropped or the handle is invalid.
+ */
+JNIEXPORT jint JNICALL Java_com_macmoment_macac_util_NativeHelper_captureCombat
+  (JNIEnv *env, jclass clazz, jlong handle, jlong playerHi, jlong playerLo,
+   jlong targetHi, jlong targetLo, jint flags,
+   jdouble targetX, jdouble targetY, jdouble targetZ,
+   jdouble attackerX, jdouble attackerY, jdouble attackerZ, jdouble damage,
+   jfloat yaw, jfloat pitch, jfloat preYaw, jfloat prePitch,
+   jint ping, jlong nanoTime, jlong timeSinceLast) {
+    macac_capture_t* capture = (macac_capture_t*)(intptr_t)handle;
+    if (!capture) {
+        return -1;
+    }
+    
+    macac_capture_combat_t record;
+    memset(&record, 0, sizeof(record));
+    record.flags = (uint32_t)flags;
+    record.player_hi = (uint64_t)playerHi;
+    record.player_lo = (uint64_t)playerLo;
+    record.target_hi = (uint64_t)targetHi;
+    record.target_lo = (uint64_t)targetLo;
+    record.target_x = targetX;
+    record.target_y = targetY;
+    record.target_z = targetZ;
+    record.attacker_x = attackerX;
+    record.attacker_y = attackerY;
+    record.attacker_z = attackerZ;
+    record.damage = damage;
+    record.attacker_yaw = yaw;
+    record.attacker_pitch = pitch;
+    record.pre_attack_yaw = preYaw;
+    record.pre_attack_pitch = prePitch;
+    record.nano_time = nanoTime;
+    record.time_since_last = timeSinceLast;
+    record.ping = ping;
+    return (jint)macac_capture_combat(capture, &record);
+}
+
+/**
+ * Capture counters as {records, dropped, bytes, files, errors}, or null.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_macmoment_macac_util_NativeHelper_captureStats
+  (JNIEnv *env, jclass clazz, jlong handle) {
+    macac_capture_t* capture = (macac_capture_t*)(intptr_t)handle;
+    if (!capture) {
+        return nullptr;
+    }
+    
+    macac_capture_stats_t stats;
+    macac_capture_get_stats(capture, &stats);
+    
+    jlongArray result = env->NewLongArray(5);
+    if (result) {
+        jlong values[5] = {
+            (jlong)stats.records, (jlong)stats.dropped, (jlong)stats.bytes,
+            (jlong)stats.files, (jlong)stats.errors
         };
-        env->SetDoubleArrayRegion(result, 0, 10, values);
+        env->SetLongArrayRegion(result, 0, 5, values);
     }
     return result;
 }
@@ -0,0 +1,40 @@
+/*
+ * MacAC Native Library - Movement Prediction
+ * 
+ * One physics tick for every tracked player at once: the expected movement
+ * from the velocity a player carried into the tick, and how far the
+ * observed movement drifted from it.
+ * 
+ * The columns are laid out structure-of-arrays so the step runs as a
+ * single dispatched kernel (simd_dispatch.cpp) over the whole batch
+ * instead of one call per player.
+ */
+
+#include "macac_native.h"
+#include "simd_dispatch.h"
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+size_t macac_movement_predict_batch(const double* in, size_t count, size_t stride, double* out) {
+    if (!in || !out || count == 0 || stride < count) {
+        return 0;
+    }
+    
+    const double* columns_in[MACAC_MOVE_INPUT_COLUMNS];
+    double* columns_out[MACAC_MOVE_OUTPUT_COLUMNS];
+    for (int c = 0; c < MACAC_MOVE_INPUT_COLUMNS; c++) {
+        columns_in[c] = in + (size_t)c * stride;
+    }
+    for (int c = 0; c < MACAC_MOVE_OUTPUT_COLUMNS; c++) {
+        columns_out[c] = out + (size_t)c * stride;
+    }
+    
+    macac_simd_active()->movement_step(columns_in, columns_out, count);
+    return count;
+}
+
+} // extern "C"
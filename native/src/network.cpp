@@ -2,12 +2,20 @@
  * MacAC Native Library - Networking Implementation
  * 
  * Provides TCP networking for centralized violation reporting.
- * Uses non-blocking I/O with epoll for efficient connection management.
+ * 
+ * Two interfaces:
+ * - macac_net_*: synchronous sends on the caller's socket
+ * - macac_sender_*: bounded lock-free MPSC queue drained by a dedicated
+ *   epoll-driven I/O thread (scatter-gather batching, reconnect with backoff,
+ *   off-thread DNS, IPv4/IPv6, sharding and failover across endpoints,
+ *   optional on-disk spill during outages)
  */
 
 #include "macac_native.h"
+#include "spill_log.h"
 #include <cstring>
 #include <cstdio>
+#include <cstddef>
 #include <cerrno>
 #include <cinttypes>
 #include <unistd.h>
@@ -19,6 +27,19 @@
 #include <netdb.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 // Connection state
 struct macac_connection {
@@ -30,6 +51,9 @@ struct macac_connection {
     size_t send_buffer_len;
 };
 
+// Timeout for macac_net_connect
+#define NET_CONNECT_TIMEOUT_MS 5000
+
 // ============================================================================
 // Internal Helpers
 // ============================================================================
@@ -53,26 +77,75 @@ static int set_tcp_nodelay(int sockfd) {
     return setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
 }
 
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Wait for a non-blocking connect to finish. Returns 0 once connected.
+ */
+static int wait_connected(int sockfd, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = sockfd;
+    pfd.events = POLLOUT;
+    
+    int64_t deadline = monotonic_ms() + timeout_ms;
+    for (;;) {
+        pfd.revents = 0;
+        int left = (int)(deadline - monotonic_ms());
+        int ret = poll(&pfd, 1, left > 0 ? left : 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return -1;
+        }
+        
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+            return -1;
+        }
+        return 0;
+    }
+}
+
 /**
- * Resolve hostname to IP address.
+ * Connect to the first reachable address of host, IPv4 or IPv6, giving each
+ * address at most timeout_ms. Returns a non-blocking socket or -1.
  */
-static int resolve_host(const char* host, struct sockaddr_in* addr) {
+static int connect_host(const char* host, int port, int timeout_ms) {
+    char service[8];
+    snprintf(service, sizeof(service), "%d", port);
+    
     struct addrinfo hints, *result;
     memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
+    hints.ai_family = AF_UNSPEC;
     hints.ai_socktype = SOCK_STREAM;
     
-    int ret = getaddrinfo(host, NULL, &hints, &result);
-    if (ret != 0) {
+    if (getaddrinfo(host, service, &hints, &result) != 0) {
         return -1;
     }
     
-    // Copy first result
-    struct sockaddr_in* ipv4 = (struct sockaddr_in*)result->ai_addr;
-    addr->sin_addr = ipv4->sin_addr;
+    int sockfd = -1;
+    for (struct addrinfo* ai = result; ai && sockfd < 0; ai = ai->ai_next) {
+        sockfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sockfd < 0) {
+            continue;
+        }
+        set_nonblocking(sockfd);
+        
+        if (connect(sockfd, ai->ai_addr, ai->ai_addrlen) < 0 &&
+            (errno != EINPROGRESS || wait_connected(sockfd, timeout_ms) < 0)) {
+            close(sockfd);
+            sockfd = -1;
+        }
+    }
     
     freeaddrinfo(result);
-    return 0;
+    return sockfd;
 }
 
 /**
@@ -96,156 +169,2262 @@ static int format_violation_json(char* buffer, size_t buffer_size,
         player_uuid, category, confidence, severity, timestamp);
 }
 
+/**
+ * Write any bytes left over from an earlier EAGAIN or partial send.
+ * Returns 0 when the buffer is empty, 1 if bytes remain, -1 on error.
+ */
+static int flush_send_buffer(macac_connection_t* conn) {
+    while (conn->send_buffer_len > 0) {
+        ssize_t sent = send(conn->sockfd, conn->send_buffer, conn->send_buffer_len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 1;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        
+        memmove(conn->send_buffer, conn->send_buffer + sent, conn->send_buffer_len - (size_t)sent);
+        conn->send_buffer_len -= (size_t)sent;
+    }
+    return 0;
+}
+
 // ============================================================================
-// Public API
+// Async Sender Internals
 // ============================================================================
 
-extern "C" {
+// Records coalesced into one writev call
+#define SENDER_BATCH 64
 
-macac_connection_t* macac_net_connect(const char* host, int port) {
-    if (!host || port <= 0 || port > 65535) {
-        return nullptr;
-    }
+// Formatted record size (payload plus JSON framing)
+#define SENDER_SLOT_BYTES (MACAC_SENDER_MAX_MESSAGE + 256)
+
+// Reconnect backoff cap
+#define SENDER_MAX_BACKOFF_MS 30000
+
+// How long shutdown keeps trying to drain the queue
+#define SENDER_SHUTDOWN_FLUSH_MS 2000
+
+// Idle wait when nothing is queued (wakeups normally come from producers)
+#define SENDER_IDLE_WAIT_MS 1000
+
+// Records an endpoint holds between the shared queue and its socket (power of two)
+#define SENDER_BACKLOG 256
+
+// Spill log: how often appends are synced, how often a queue that cannot
+// be routed is rechecked against the high-water mark, and the record layout tag
+#define SENDER_SPILL_SYNC_MS 200
+#define SENDER_SPILL_POLL_MS 10
+#define SENDER_SPILL_FORMAT ((uint32_t)(1u << 16 | offsetof(sender_message, payload)))
+
+// Addresses kept from one lookup, tried in order
+#define SENDER_MAX_ADDRS 8
+
+// Lookup results are reused this long before the next reconnect re-resolves
+#define SENDER_RESOLVE_TTL_MS 60000
+
+// Keepalive probing and the unacknowledged-data limit that fail a dead link
+#define SENDER_KEEPALIVE_IDLE_S 10
+#define SENDER_KEEPALIVE_INTERVAL_S 5
+#define SENDER_KEEPALIVE_COUNT 3
+#define SENDER_USER_TIMEOUT_MS 15000
+
+// epoll tag of the wake fd; sockets are tagged with their endpoint index
+#define SENDER_WAKE_TAG 0xFFFFFFFFu
+
+// Binary protocol: interned categories and their frames
+#define SENDER_MAX_CATEGORIES 64
+#define SENDER_MAX_CATEGORY_NAME 255
+#define SENDER_FRAME_HEADER 5
+#define SENDER_CATEGORY_FRAME_MAX (SENDER_FRAME_HEADER + 3 + SENDER_MAX_CATEGORY_NAME)
+#define SENDER_HELLO_BYTES 8
+
+#ifdef MSG_NOSIGNAL
+#define SENDER_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SENDER_SEND_FLAGS 0
+#endif
+
+#ifdef __linux__
+#define SENDER_EV_IN EPOLLIN
+#define SENDER_EV_OUT EPOLLOUT
+#else
+#define SENDER_EV_IN POLLIN
+#define SENDER_EV_OUT POLLOUT
+#endif
+
+enum sender_kind : uint8_t {
+    SENDER_VIOLATION = 0,
+    SENDER_RAW = 1,
+    SENDER_SKIPPED = 2,         // Backlog slot of a record dropped as unencodable
+    SENDER_SUMMARY = 3          // Coalesced violations (macac_sender_send_summary)
+};
+
+/**
+ * One record as the producer stored it. The I/O thread serializes it, so the
+ * reporting thread never pays for snprintf.
+ */
+struct sender_message {
+    uint8_t kind;
+    uint16_t uuid_len;          // Violation: payload = uuid, then category
+    uint16_t len;               // Payload bytes
+    uint32_t count;             // Summary: violations merged
+    double confidence;          // Summary: maximum
+    double severity;            // Summary: mean
+    int64_t timestamp;          // Summary: latest
+    int64_t first_timestamp;    // Summary: earliest
+    uint64_t spill_ticket;      // Spill log position if read back from it, else 0
+    char payload[MACAC_SENDER_MAX_MESSAGE];
+};
+
+/**
+ * Queue cell.
+ */
+struct sender_cell {
+    std::atomic<size_t> sequence;
+    sender_message msg;
+};
+
+enum sender_conn_state {
+    SENDER_DISCONNECTED,
+    SENDER_RESOLVING,
+    SENDER_CONNECTING,
+    SENDER_HANDSHAKE,
+    SENDER_CONNECTED
+};
+
+/**
+ * Lookup requests and results, shared with the resolver thread. The thread
+ * is detached and holds its own reference, so a lookup stuck in getaddrinfo
+ * never holds up macac_sender_destroy.
+ */
+struct sender_resolver {
+    std::mutex lock;
+    std::condition_variable cv;
+    bool closed = false;
+    bool started = false;
+    int wake_fd = -1;               // Written under lock while !closed
     
-    macac_connection_t* conn = new macac_connection_t();
-    if (!conn) {
-        return nullptr;
-    }
+    uint32_t requests[MACAC_SENDER_MAX_ENDPOINTS];
+    size_t request_count = 0;
+    char hosts[MACAC_SENDER_MAX_ENDPOINTS][256];
+    int ports[MACAC_SENDER_MAX_ENDPOINTS];
     
-    memset(conn, 0, sizeof(macac_connection_t));
-    strncpy(conn->host, host, sizeof(conn->host) - 1);
-    conn->port = port;
-    conn->sockfd = -1;
-    conn->connected = false;
+    bool ready[MACAC_SENDER_MAX_ENDPOINTS] = {};
+    struct sockaddr_storage addrs[MACAC_SENDER_MAX_ENDPOINTS][SENDER_MAX_ADDRS];
+    socklen_t addr_lens[MACAC_SENDER_MAX_ENDPOINTS][SENDER_MAX_ADDRS];
+    size_t addr_counts[MACAC_SENDER_MAX_ENDPOINTS] = {};
     
-    // Create socket
-    conn->sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (conn->sockfd < 0) {
-        delete conn;
-        return nullptr;
-    }
+    char peers[MACAC_SENDER_MAX_ENDPOINTS][64] = {};     // Last connected address, for stats
+};
+
+/**
+ * One collector connection. Records routed here wait in the backlog ring:
+ * [head, read) are in the current batch, [read, tail) are not yet encoded.
+ * A record leaves the backlog only once fully written, so a disconnect
+ * rewinds read to head and nothing written is lost or sent twice.
+ */
+struct sender_endpoint {
+    char host[256];
+    int port;
+    uint32_t index;
     
-    // Resolve host
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
+    // Addresses in use (I/O thread only)
+    struct sockaddr_storage addrs[SENDER_MAX_ADDRS];
+    socklen_t addr_lens[SENDER_MAX_ADDRS];
+    size_t addr_count;
+    size_t addr_next;
+    int64_t resolved_at;
     
-    if (resolve_host(host, &server_addr) < 0) {
-        // Try as IP address
-        if (inet_pton(AF_INET, host, &server_addr.sin_addr) <= 0) {
-            close(conn->sockfd);
-            delete conn;
-            return nullptr;
-        }
-    }
+    // Connection (I/O thread only)
+    int sockfd;
+    sender_conn_state state;
+    bool sock_registered;
+    uint32_t sock_events;
+    int64_t connect_deadline;
+    int64_t next_connect_at;
+    int backoff_ms;
+    bool ever_connected;
+    int64_t stalled_since;      // Last time the socket refused bytes with data pending, 0 if not
+    bool readable;              // Events from the last wait
+    bool writable;
+    bool error;
     
-    // Set socket options
-    set_tcp_nodelay(conn->sockfd);
+    // Binary protocol state (I/O thread only)
+    char categories[SENDER_MAX_CATEGORIES][SENDER_MAX_CATEGORY_NAME];
+    uint8_t category_lens[SENDER_MAX_CATEGORIES];
+    size_t category_count;
+    uint8_t ack[SENDER_HELLO_BYTES];
+    size_t ack_len;
+    char preamble[SENDER_MAX_CATEGORIES * SENDER_CATEGORY_FRAME_MAX];
+    size_t preamble_len;
+    size_t preamble_off;
     
-    // Set connection timeout
-    struct timeval timeout;
-    timeout.tv_sec = 5;
-    timeout.tv_usec = 0;
-    setsockopt(conn->sockfd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    setsockopt(conn->sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    // Backlog ring (indices grow monotonically)
+    sender_message* backlog;
+    size_t head;
+    size_t read;
+    size_t tail;
     
-    // Connect
-    if (connect(conn->sockfd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        close(conn->sockfd);
-        delete conn;
-        return nullptr;
-    }
+    // Current batch: entry i covers out_slots[i] backlog slots, of which
+    // out_records[i] are real records
+    char (*out)[SENDER_SLOT_BYTES];
+    struct iovec iov[SENDER_BATCH];
+    char* out_base[SENDER_BATCH];
+    size_t out_len[SENDER_BATCH];
+    uint32_t out_records[SENDER_BATCH];
+    uint32_t out_slots[SENDER_BATCH];
+    size_t batch_start;
+    size_t batch_count;
+    
+    // Published for stats
+    std::atomic<int> public_state;      // MACAC_ENDPOINT_*
+    std::atomic<int> protocol_version;
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> reconnects;
+    std::atomic<size_t> depth;
+};
+
+struct macac_sender {
+    int connect_timeout_ms;
+    int reconnect_delay_ms;
+    int protocol;               // MACAC_WIRE_*
     
-    // Set non-blocking after connect
-    set_nonblocking(conn->sockfd);
+    sender_endpoint* endpoints;
+    size_t endpoint_count;
     
-    conn->connected = true;
-    return conn;
+    // Bounded MPSC queue (Vyukov sequence cells)
+    sender_cell* cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;    // Written by I/O thread only
+    
+    // Wakeup: producers signal only when the I/O thread is parked
+    alignas(64) std::atomic<bool> consumer_waiting;
+    int wake_fd;
+    int wake_wr_fd;
+    
+    std::atomic<bool> stopping;
+    std::atomic<size_t> in_flight;      // Dequeued into a backlog but not fully written
+    
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> reconnects;
+    std::atomic<uint64_t> failovers;
+    
+    // On-disk spill (I/O thread only; null when disabled)
+    spill_log* spill;
+    size_t spill_high_water;
+    int64_t spill_synced_at;
+    std::atomic<uint64_t> spilled;
+    std::atomic<uint64_t> replayed;
+    std::atomic<size_t> spill_depth;
+    
+    // I/O thread state
+    std::thread thread;
+    int epoll_fd;
+    size_t raw_next;            // Round-robin start for raw records
+    
+    std::shared_ptr<sender_resolver> resolver;
+};
+
+static size_t round_up_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
 }
 
-int macac_net_send_violation(macac_connection_t* conn,
-                              const char* player_uuid,
-                              const char* category,
-                              double confidence,
-                              double severity,
-                              int64_t timestamp) {
-    if (!conn || !conn->connected || conn->sockfd < 0) {
-        return -1;
+/**
+ * Claim a cell for writing. Returns null if the queue is full.
+ */
+static sender_cell* sender_claim(macac_sender_t* s, size_t* out_pos) {
+    size_t pos = s->enqueue_pos.load(std::memory_order_relaxed);
+    
+    for (;;) {
+        sender_cell* cell = &s->cells[pos & s->mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (s->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                *out_pos = pos;
+                return cell;
+            }
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            pos = s->enqueue_pos.load(std::memory_order_relaxed);
+        }
     }
+}
+
+/**
+ * Publish a claimed cell and wake the I/O thread if it is parked.
+ */
+static void sender_publish(macac_sender_t* s, sender_cell* cell, size_t pos) {
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    s->enqueued.fetch_add(1, std::memory_order_relaxed);
     
-    if (!player_uuid || !category) {
+    // Pairs with the fence in sender_run: either the consumer sees this
+    // record before sleeping, or we see it waiting and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s->consumer_waiting.load(std::memory_order_relaxed) &&
+        s->consumer_waiting.exchange(false, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        ssize_t ignored = write(s->wake_wr_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+/**
+ * Oldest published cell, or null if the queue is empty. Single consumer.
+ */
+static sender_cell* sender_peek(const macac_sender_t* s) {
+    size_t pos = s->dequeue_pos.load(std::memory_order_relaxed);
+    sender_cell* cell = &s->cells[pos & s->mask];
+    if (cell->sequence.load(std::memory_order_acquire) != pos + 1) {
+        return nullptr;
+    }
+    return cell;
+}
+
+/**
+ * Hand the cell returned by sender_peek back to producers.
+ */
+static void sender_release(macac_sender_t* s, sender_cell* cell) {
+    size_t pos = s->dequeue_pos.load(std::memory_order_relaxed);
+    cell->sequence.store(pos + s->mask + 1, std::memory_order_release);
+    s->dequeue_pos.store(pos + 1, std::memory_order_release);
+}
+
+static bool sender_queue_empty(const macac_sender_t* s) {
+    return sender_peek(s) == nullptr;
+}
+
+// ============================================================================
+// Wire Encoding
+// ============================================================================
+
+static inline char* put_u16(char* p, uint16_t v) {
+    p[0] = (char)(v & 0xFF);
+    p[1] = (char)(v >> 8);
+    return p + 2;
+}
+
+static inline char* put_u32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (char)((v >> (8 * i)) & 0xFF);
+    }
+    return p + 4;
+}
+
+static inline char* put_u64(char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (char)((v >> (8 * i)) & 0xFF);
+    }
+    return p + 8;
+}
+
+static inline char* put_f32(char* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return put_u32(p, bits);
+}
+
+static inline char* put_frame_header(char* p, uint32_t payload_len, uint8_t type) {
+    p = put_u32(p, payload_len + 1);
+    *p++ = (char)type;
+    return p;
+}
+
+static inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * Parse a textual UUID (dashes optional) into 16 bytes.
+ */
+static bool parse_uuid(const char* text, size_t len, uint8_t out[16]) {
+    size_t nibbles = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '-') {
+            continue;
+        }
+        int v = hex_value(text[i]);
+        if (v < 0 || nibbles >= 32) {
+            return false;
+        }
+        if (nibbles % 2 == 0) {
+            out[nibbles / 2] = (uint8_t)(v << 4);
+        } else {
+            out[nibbles / 2] |= (uint8_t)v;
+        }
+        nibbles++;
+    }
+    return nibbles == 32;
+}
+
+static size_t encode_category_frame(char* dst, size_t id, const char* name, size_t len) {
+    char* p = put_frame_header(dst, (uint32_t)(3 + len), MACAC_FRAME_CATEGORY);
+    p = put_u16(p, (uint16_t)id);
+    *p++ = (char)len;
+    memcpy(p, name, len);
+    return (size_t)(p + len - dst);
+}
+
+/**
+ * Look up or intern a category. Returns its id, or -1 if the name is too
+ * long or the table is full. *is_new is set when the id was just assigned.
+ */
+static int intern_category(sender_endpoint* ep, const char* name, size_t len, bool* is_new) {
+    *is_new = false;
+    if (len > SENDER_MAX_CATEGORY_NAME) {
         return -1;
     }
     
-    // Format JSON message
-    char json_buffer[1024];
-    int json_len = format_violation_json(json_buffer, sizeof(json_buffer),
-                                          player_uuid, category,
-                                          confidence, severity, timestamp);
+    for (size_t i = 0; i < ep->category_count; i++) {
+        if (ep->category_lens[i] == len && memcmp(ep->categories[i], name, len) == 0) {
+            return (int)i;
+        }
+    }
     
-    if (json_len < 0 || json_len >= (int)sizeof(json_buffer)) {
+    if (ep->category_count >= SENDER_MAX_CATEGORIES) {
         return -1;
     }
     
-    // Send data
-    ssize_t sent = send(conn->sockfd, json_buffer, json_len, MSG_NOSIGNAL);
+    size_t id = ep->category_count++;
+    memcpy(ep->categories[id], name, len);
+    ep->category_lens[id] = (uint8_t)len;
+    *is_new = true;
+    return (int)id;
+}
+
+/**
+ * Encode one violation or summary as a binary record (a summary's maximum
+ * confidence, mean severity and latest timestamp). Any category definition
+ * needed first is written to defs (which may alias dst's prefix).
+ * Returns false if the record cannot be encoded.
+ */
+static bool encode_record(sender_endpoint* ep, const sender_message* m, char* record,
+                          char* defs, size_t* defs_len) {
+    uint8_t uuid[16];
+    if (!parse_uuid(m->payload, m->uuid_len, uuid)) {
+        return false;
+    }
     
-    if (sent < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Would block, buffer for later
-            if (conn->send_buffer_len + json_len < sizeof(conn->send_buffer)) {
-                memcpy(conn->send_buffer + conn->send_buffer_len, json_buffer, json_len);
-                conn->send_buffer_len += json_len;
-                return 0;
-            }
-            return -1; // Buffer full
-        }
-        
-        // Connection error
-        conn->connected = false;
-        return -1;
+    const char* category = m->payload + m->uuid_len;
+    size_t category_len = (size_t)(m->len - m->uuid_len);
+    bool is_new;
+    int id = intern_category(ep, category, category_len, &is_new);
+    if (id < 0) {
+        return false;
+    }
+    if (is_new) {
+        *defs_len += encode_category_frame(defs + *defs_len, (size_t)id, category, category_len);
     }
     
-    return (int)sent;
+    char* p = record;
+    memcpy(p, uuid, 16);
+    p += 16;
+    p = put_u16(p, (uint16_t)id);
+    p = put_u16(p, 0);
+    p = put_f32(p, (float)m->confidence);
+    p = put_f32(p, (float)m->severity);
+    put_u64(p, (uint64_t)m->timestamp);
+    return true;
 }
 
-void macac_net_close(macac_connection_t* conn) {
-    if (!conn) {
-        return;
+/**
+ * Summaries get their own frame from version 2; a version 1 server sees
+ * them as plain violation records.
+ */
+static inline bool sender_summary_frames(const sender_endpoint* ep) {
+    return ep->protocol_version.load(std::memory_order_relaxed) >= 2;
+}
+
+/**
+ * Serialize one record into dst for JSON or unbatched binary.
+ * Returns formatted length, or -1 if the record is unusable.
+ */
+static int format_message(const macac_sender_t* s, sender_endpoint* ep, const sender_message* m,
+                          char* dst, size_t dst_size) {
+    if (m->kind == SENDER_RAW) {
+        memcpy(dst, m->payload, m->len);
+        return m->len;
     }
     
-    if (conn->sockfd >= 0) {
-        // Graceful shutdown
-        shutdown(conn->sockfd, SHUT_RDWR);
-        close(conn->sockfd);
+    if (s->protocol == MACAC_WIRE_JSON && m->kind == SENDER_SUMMARY) {
+        int len = snprintf(dst, dst_size,
+            "{"
+            "\"type\":\"violation_summary\","
+            "\"player_uuid\":\"%.*s\","
+            "\"category\":\"%.*s\","
+            "\"count\":%" PRIu32 ","
+            "\"confidence\":%.6f,"
+            "\"severity\":%.6f,"
+            "\"first_timestamp\":%" PRId64 ","
+            "\"timestamp\":%" PRId64
+            "}\n",
+            (int)m->uuid_len, m->payload,
+            (int)(m->len - m->uuid_len), m->payload + m->uuid_len,
+            m->count, m->confidence, m->severity, m->first_timestamp, m->timestamp);
+        return len < (int)dst_size ? len : -1;
     }
     
-    delete conn;
+    if (s->protocol == MACAC_WIRE_JSON) {
+        int len = snprintf(dst, dst_size,
+            "{"
+            "\"type\":\"violation\","
+            "\"player_uuid\":\"%.*s\","
+            "\"category\":\"%.*s\","
+            "\"confidence\":%.6f,"
+            "\"severity\":%.6f,"
+            "\"timestamp\":%" PRId64
+            "}\n",
+            (int)m->uuid_len, m->payload,
+            (int)(m->len - m->uuid_len), m->payload + m->uuid_len,
+            m->confidence, m->severity, m->timestamp);
+        return len < (int)dst_size ? len : -1;
+    }
+    
+    // Binary: [category frame if new] [violation or summary frame]
+    size_t defs_len = 0;
+    char record[MACAC_WIRE_RECORD_BYTES];
+    if (!encode_record(ep, m, record, dst, &defs_len)) {
+        return -1;
+    }
+    
+    if (m->kind == SENDER_SUMMARY && sender_summary_frames(ep)) {
+        char* p = put_frame_header(dst + defs_len, MACAC_WIRE_SUMMARY_BYTES, MACAC_FRAME_SUMMARY);
+        memcpy(p, record, MACAC_WIRE_RECORD_BYTES);
+        p = put_u32(p + MACAC_WIRE_RECORD_BYTES, m->count);
+        p = put_u64(p, (uint64_t)m->first_timestamp);
+        return (int)(p - dst);
+    }
+    
+    char* p = put_frame_header(dst + defs_len, MACAC_WIRE_RECORD_BYTES, MACAC_FRAME_VIOLATION);
+    memcpy(p, record, MACAC_WIRE_RECORD_BYTES);
+    return (int)(p + MACAC_WIRE_RECORD_BYTES - dst);
 }
 
-int macac_net_is_connected(macac_connection_t* conn) {
-    if (!conn || !conn->connected || conn->sockfd < 0) {
-        return 0;
+/**
+ * Rebuild the per-connection preamble: every known category definition, so
+ * ids in records batched before a reconnect stay meaningful.
+ */
+static void build_preamble(sender_endpoint* ep) {
+    size_t len = 0;
+    for (size_t i = 0; i < ep->category_count; i++) {
+        len += encode_category_frame(ep->preamble + len, i, ep->categories[i], ep->category_lens[i]);
     }
+    ep->preamble_len = len;
+    ep->preamble_off = 0;
+}
+
+// ============================================================================
+// Endpoint Lists
+// ============================================================================
+
+/**
+ * Parse "host", "host:port", "[v6]", "[v6]:port" or a bare IPv6 literal.
+ * Returns false if the text is empty or the port is invalid.
+ */
+static bool parse_endpoint(const char* text, size_t len, int default_port,
+                           char* host, size_t host_size, int* port) {
+    const char* host_start = text;
+    size_t host_len = len;
+    const char* port_text = nullptr;
+    size_t port_len = 0;
     
-    // Check if connection is still alive using poll
-    struct pollfd pfd;
-    pfd.fd = conn->sockfd;
-    pfd.events = POLLOUT | POLLERR | POLLHUP;
+    if (len > 0 && text[0] == '[') {
+        const char* close = (const char*)memchr(text, ']', len);
+        if (!close) {
+            return false;
+        }
+        host_start = text + 1;
+        host_len = (size_t)(close - host_start);
+        size_t rest = len - (size_t)(close + 1 - text);
+        if (rest > 0) {
+            if (close[1] != ':') {
+                return false;
+            }
+            port_text = close + 2;
+            port_len = rest - 1;
+        }
+    } else {
+        // Exactly one colon separates a port; more means a bare IPv6 address
+        const char* colon = (const char*)memchr(text, ':', len);
+        if (colon && !memchr(colon + 1, ':', len - (size_t)(colon + 1 - text))) {
+            host_len = (size_t)(colon - text);
+            port_text = colon + 1;
+            port_len = len - host_len - 1;
+        }
+    }
     
-    int ret = poll(&pfd, 1, 0);
-    if (ret < 0) {
-        conn->connected = false;
-        return 0;
+    if (host_len == 0 || host_len >= host_size) {
+        return false;
     }
     
-    if (pfd.revents & (POLLERR | POLLHUP)) {
-        conn->connected = false;
-        return 0;
+    int value = default_port;
+    if (port_text) {
+        if (port_len == 0 || port_len > 5) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < port_len; i++) {
+            if (port_text[i] < '0' || port_text[i] > '9') {
+                return false;
+            }
+            value = value * 10 + (port_text[i] - '0');
+        }
+    }
+    if (value <= 0 || value > 65535) {
+        return false;
     }
     
-    return 1;
+    memcpy(host, host_start, host_len);
+    host[host_len] = '\0';
+    *port = value;
+    return true;
+}
+
+static inline bool is_endpoint_separator(char c) {
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// ============================================================================
+// Address Resolution
+// ============================================================================
+
+/**
+ * Copy up to SENDER_MAX_ADDRS stream addresses from a getaddrinfo result.
+ */
+static size_t copy_addresses(const struct addrinfo* result, struct sockaddr_storage* addrs,
+                             socklen_t* lens) {
+    size_t count = 0;
+    for (const struct addrinfo* ai = result; ai && count < SENDER_MAX_ADDRS; ai = ai->ai_next) {
+        if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) ||
+            ai->ai_addrlen > sizeof(struct sockaddr_storage)) {
+            continue;
+        }
+        memcpy(&addrs[count], ai->ai_addr, ai->ai_addrlen);
+        lens[count] = (socklen_t)ai->ai_addrlen;
+        count++;
+    }
+    return count;
+}
+
+static struct addrinfo sender_hints(int flags) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+    return hints;
+}
+
+/**
+ * Resolve a literal IPv4/IPv6 address inline (no DNS traffic).
+ * Returns false if the host is a name that needs a real lookup.
+ */
+static bool resolve_numeric(sender_endpoint* ep, int64_t now) {
+    char service[8];
+    snprintf(service, sizeof(service), "%d", ep->port);
+    struct addrinfo hints = sender_hints(AI_NUMERICHOST | AI_NUMERICSERV);
+    struct addrinfo* result;
+    
+    if (getaddrinfo(ep->host, service, &hints, &result) != 0) {
+        return false;
+    }
+    ep->addr_count = copy_addresses(result, ep->addrs, ep->addr_lens);
+    ep->addr_next = 0;
+    ep->resolved_at = now;
+    freeaddrinfo(result);
+    return ep->addr_count > 0;
+}
+
+/**
+ * Resolver thread: serves lookups in request order until the sender closes.
+ */
+static void resolver_run(std::shared_ptr<sender_resolver> r) {
+    std::unique_lock<std::mutex> guard(r->lock);
+    
+    for (;;) {
+        r->cv.wait(guard, [&] { return r->closed || r->request_count > 0; });
+        if (r->closed) {
+            return;
+        }
+        
+        uint32_t index = r->requests[0];
+        r->request_count--;
+        memmove(r->requests, r->requests + 1, r->request_count * sizeof(uint32_t));
+        char host[256];
+        char service[8];
+        memcpy(host, r->hosts[index], sizeof(host));
+        snprintf(service, sizeof(service), "%d", r->ports[index]);
+        guard.unlock();
+        
+        struct addrinfo hints = sender_hints(AI_NUMERICSERV);
+        struct addrinfo* result = nullptr;
+        int ret = getaddrinfo(host, service, &hints, &result);
+        
+        guard.lock();
+        if (r->closed) {
+            if (ret == 0) {
+                freeaddrinfo(result);
+            }
+            return;
+        }
+        r->addr_counts[index] = ret == 0 ? copy_addresses(result, r->addrs[index], r->addr_lens[index]) : 0;
+        r->ready[index] = true;
+        if (ret == 0) {
+            freeaddrinfo(result);
+        }
+        
+        uint64_t one = 1;
+        ssize_t ignored = write(r->wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// ============================================================================
+// Event Loop
+// ============================================================================
+
+/**
+ * Register interest in socket events (no-op if unchanged).
+ */
+static void sender_watch_socket(macac_sender_t* s, sender_endpoint* ep, uint32_t events) {
+    if (ep->sockfd < 0 || (ep->sock_registered && ep->sock_events == events)) {
+        return;
+    }
+#ifdef __linux__
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events | EPOLLRDHUP;
+    ev.data.u32 = ep->index;
+    epoll_ctl(s->epoll_fd, ep->sock_registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, ep->sockfd, &ev);
+#else
+    (void)s;
+#endif
+    ep->sock_registered = true;
+    ep->sock_events = events;
+}
+
+static void sender_drain_wake(macac_sender_t* s) {
+    uint64_t value;
+    while (read(s->wake_fd, &value, sizeof(value)) > 0) {
+    }
+}
+
+/**
+ * Wait for wakeups and the watched socket events, recording each
+ * endpoint's events on the endpoint.
+ */
+static void sender_wait(macac_sender_t* s, int timeout_ms) {
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        ep->readable = ep->writable = ep->error = false;
+    }
+
+#ifdef __linux__
+    struct epoll_event events[MACAC_SENDER_MAX_ENDPOINTS + 1];
+    int n = epoll_wait(s->epoll_fd, events, MACAC_SENDER_MAX_ENDPOINTS + 1, timeout_ms);
+    for (int i = 0; i < n; i++) {
+        if (events[i].data.u32 == SENDER_WAKE_TAG) {
+            sender_drain_wake(s);
+            continue;
+        }
+        sender_endpoint* ep = &s->endpoints[events[i].data.u32];
+        ep->error |= (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0;
+        ep->readable |= (events[i].events & EPOLLIN) != 0;
+        ep->writable |= (events[i].events & EPOLLOUT) != 0;
+    }
+#else
+    struct pollfd pfds[MACAC_SENDER_MAX_ENDPOINTS + 1];
+    sender_endpoint* owners[MACAC_SENDER_MAX_ENDPOINTS + 1];
+    nfds_t count = 1;
+    pfds[0].fd = s->wake_fd;
+    pfds[0].events = POLLIN;
+    pfds[0].revents = 0;
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        if (ep->sockfd >= 0) {
+            pfds[count].fd = ep->sockfd;
+            pfds[count].events = (short)ep->sock_events;
+            pfds[count].revents = 0;
+            owners[count++] = ep;
+        }
+    }
+    
+    int n = poll(pfds, count, timeout_ms);
+    if (n > 0) {
+        if (pfds[0].revents & POLLIN) {
+            sender_drain_wake(s);
+        }
+        for (nfds_t i = 1; i < count; i++) {
+            owners[i]->error = (pfds[i].revents & (POLLERR | POLLHUP)) != 0;
+            owners[i]->readable = (pfds[i].revents & POLLIN) != 0;
+            owners[i]->writable = (pfds[i].revents & POLLOUT) != 0;
+        }
+    }
+#endif
+}
+
+/**
+ * Healthy: connected, and the socket accepted bytes within the connect
+ * timeout. Accepting: healthy with room in the backlog.
+ */
+static inline bool sender_healthy(const macac_sender_t* s, const sender_endpoint* ep, int64_t now) {
+    return ep->state == SENDER_CONNECTED &&
+           (ep->stalled_since == 0 || now - ep->stalled_since < s->connect_timeout_ms);
+}
+
+static inline bool sender_accepts(const macac_sender_t* s, const sender_endpoint* ep, int64_t now) {
+    return sender_healthy(s, ep, now) && ep->tail - ep->head < SENDER_BACKLOG;
+}
+
+/**
+ * Shard of a violation: FNV-1a of the player UUID text, so one player's
+ * reports always reach the same collector while it is healthy.
+ */
+static size_t sender_shard(const sender_message* m, size_t endpoint_count) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < m->uuid_len; i++) {
+        hash = (hash ^ (uint8_t)m->payload[i]) * 0x100000001b3ULL;
+    }
+    return (size_t)((hash ^ (hash >> 32)) % endpoint_count);
+}
+
+/**
+ * Endpoint for a record whose preferred endpoint is home. A healthy home
+ * keeps the record even when its backlog is momentarily full (null: wait
+ * for it to drain), so bursts do not break shard affinity; otherwise the
+ * next endpoint that accepts. Null when none can take it.
+ */
+static sender_endpoint* sender_pick(macac_sender_t* s, size_t home, int64_t now) {
+    if (sender_healthy(s, &s->endpoints[home], now)) {
+        return sender_accepts(s, &s->endpoints[home], now) ? &s->endpoints[home] : nullptr;
+    }
+    for (size_t k = 1; k < s->endpoint_count; k++) {
+        size_t i = home + k < s->endpoint_count ? home + k : home + k - s->endpoint_count;
+        if (sender_accepts(s, &s->endpoints[i], now)) {
+            return &s->endpoints[i];
+        }
+    }
+    return nullptr;
+}
+
+static inline size_t sender_home(const macac_sender_t* s, const sender_message* m) {
+    if (s->endpoint_count == 1) {
+        return 0;
+    }
+    return m->kind != SENDER_RAW ? sender_shard(m, s->endpoint_count) : s->raw_next;
+}
+
+static inline sender_message* backlog_at(sender_endpoint* ep, size_t pos) {
+    return &ep->backlog[pos & (SENDER_BACKLOG - 1)];
+}
+
+static void sender_push(sender_endpoint* ep, const sender_message* m) {
+    memcpy(backlog_at(ep, ep->tail), m, offsetof(sender_message, payload) + m->len);
+    ep->tail++;
+    ep->depth.store(ep->tail - ep->head, std::memory_order_relaxed);
+}
+
+/**
+ * Fail over the records an unhealthy endpoint has not started writing:
+ * each goes to the next healthy endpoint after its shard; records nobody
+ * can take stay, compacted in order.
+ */
+static void sender_shed(macac_sender_t* s, sender_endpoint* from, int64_t now) {
+    if (from->read == from->tail || s->endpoint_count == 1) {
+        return;
+    }
+    bool any = false;
+    for (size_t i = 0; i < s->endpoint_count && !any; i++) {
+        any = &s->endpoints[i] != from && sender_accepts(s, &s->endpoints[i], now);
+    }
+    if (!any) {
+        return;
+    }
+    
+    size_t keep = from->read;
+    for (size_t pos = from->read; pos < from->tail; pos++) {
+        sender_message* m = backlog_at(from, pos);
+        if (m->kind == SENDER_SKIPPED) {
+            continue;
+        }
+        sender_endpoint* to = sender_pick(s, sender_home(s, m), now);
+        if (to) {
+            sender_push(to, m);
+            s->failovers.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (keep != pos) {
+            memcpy(backlog_at(from, keep), m, offsetof(sender_message, payload) + m->len);
+        }
+        keep++;
+    }
+    from->tail = keep;
+    from->depth.store(from->tail - from->head, std::memory_order_relaxed);
+}
+
+/**
+ * Append a record to the spill log. False if the disk budget is used up.
+ */
+static bool sender_spill(macac_sender_t* s, const sender_message* m) {
+    if (!spill_append(s->spill, m, offsetof(sender_message, payload) + m->len)) {
+        return false;
+    }
+    s->spilled.fetch_add(1, std::memory_order_relaxed);
+    s->spill_depth.store(spill_unread(s->spill), std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Acknowledge a record read back from the spill log once it is written
+ * or dropped, so its segment can be deleted.
+ */
+static inline void sender_spill_done(macac_sender_t* s, sender_message* m) {
+    if (m->spill_ticket != 0) {
+        spill_ack(s->spill, m->spill_ticket);
+        m->spill_ticket = 0;
+    }
+}
+
+/**
+ * Release n written or dropped slots at the head of a backlog.
+ */
+static void sender_advance_head(macac_sender_t* s, sender_endpoint* ep, size_t n) {
+    if (s->spill) {
+        for (size_t pos = ep->head; pos < ep->head + n; pos++) {
+            sender_spill_done(s, backlog_at(ep, pos));
+        }
+    }
+    ep->head += n;
+}
+
+/**
+ * True if no endpoint could write a record now.
+ */
+static bool sender_outage(const macac_sender_t* s, int64_t now) {
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        if (sender_healthy(s, &s->endpoints[i], now)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Route spilled records back into endpoint backlogs, oldest first, for as
+ * long as their endpoints accept them.
+ */
+static void sender_replay(macac_sender_t* s, int64_t now) {
+    const void* data;
+    size_t len;
+    while ((data = spill_peek(s->spill, &len)) != nullptr) {
+        // The log checksums records, so a bad one here is from another build
+        const sender_message* m = (const sender_message*)data;
+        if (len < offsetof(sender_message, payload) || m->len > MACAC_SENDER_MAX_MESSAGE ||
+            len != offsetof(sender_message, payload) + m->len || m->uuid_len > m->len ||
+            (m->kind != SENDER_VIOLATION && m->kind != SENDER_RAW && m->kind != SENDER_SUMMARY)) {
+            spill_ack(s->spill, spill_take(s->spill));
+            s->dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        
+        size_t home = sender_home(s, m);
+        sender_endpoint* ep = sender_pick(s, home, now);
+        if (!ep) {
+            break;
+        }
+        if (m->kind == SENDER_RAW) {
+            s->raw_next = ep->index + 1 < s->endpoint_count ? ep->index + 1 : 0;
+        } else if (ep->index != home) {
+            s->failovers.fetch_add(1, std::memory_order_relaxed);
+        }
+        sender_push(ep, m);
+        backlog_at(ep, ep->tail - 1)->spill_ticket = spill_take(s->spill);
+        s->in_flight.fetch_add(1, std::memory_order_release);
+        s->replayed.fetch_add(1, std::memory_order_relaxed);
+    }
+    s->spill_depth.store(spill_unread(s->spill), std::memory_order_relaxed);
+}
+
+/**
+ * Move records from the shared queue into endpoint backlogs. While no
+ * endpoint can take a record it stays queued, so a full queue makes
+ * producers drop rather than block.
+ * 
+ * With a spill log, records that cannot be routed during an outage or
+ * above the high-water mark go to disk, and while the log holds records
+ * not yet read back every new record follows them there.
+ */
+static void sender_route(macac_sender_t* s, int64_t now) {
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        if (!sender_healthy(s, ep, now)) {
+            sender_shed(s, ep, now);
+        }
+    }
+    
+    if (s->spill) {
+        sender_replay(s, now);
+    }
+    
+    sender_cell* cell;
+    while ((cell = sender_peek(s)) != nullptr) {
+        const sender_message* m = &cell->msg;
+        size_t home = sender_home(s, m);
+        bool behind_spill = s->spill && spill_unread(s->spill) > 0;
+        sender_endpoint* ep = behind_spill ? nullptr : sender_pick(s, home, now);
+        if (!ep) {
+            if (!s->spill) {
+                break;
+            }
+            size_t queued = s->enqueue_pos.load(std::memory_order_acquire) -
+                            s->dequeue_pos.load(std::memory_order_relaxed);
+            if (!(behind_spill || queued > s->spill_high_water || sender_outage(s, now)) ||
+                !sender_spill(s, m)) {
+                break;
+            }
+            sender_release(s, cell);
+            continue;
+        }
+        
+        if (m->kind == SENDER_RAW) {
+            s->raw_next = ep->index + 1 < s->endpoint_count ? ep->index + 1 : 0;
+        } else if (ep->index != home) {
+            s->failovers.fetch_add(1, std::memory_order_relaxed);
+        }
+        sender_push(ep, m);
+        s->in_flight.fetch_add(1, std::memory_order_release);
+        sender_release(s, cell);
+    }
+}
+
+static void sender_close_socket(macac_sender_t* s, sender_endpoint* ep) {
+    if (ep->sockfd >= 0) {
+#ifdef __linux__
+        if (ep->sock_registered) {
+            epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, ep->sockfd, nullptr);
+        }
+#else
+        (void)s;
+#endif
+        close(ep->sockfd);
+        ep->sockfd = -1;
+    }
+    ep->sock_registered = false;
+    ep->sock_events = 0;
+    ep->stalled_since = 0;
+    ep->preamble_len = 0;
+    ep->preamble_off = 0;
+    ep->ack_len = 0;
+    ep->protocol_version.store(0, std::memory_order_release);
+}
+
+/**
+ * Close the socket and schedule a reconnect with exponential backoff.
+ * The unfinished batch is rewound into the backlog so partially written
+ * records are resent whole, then the backlog fails over to healthy endpoints.
+ */
+static void sender_disconnect(macac_sender_t* s, sender_endpoint* ep) {
+    sender_close_socket(s, ep);
+    ep->state = SENDER_DISCONNECTED;
+    ep->public_state.store(MACAC_ENDPOINT_DOWN, std::memory_order_release);
+    
+    ep->batch_start = 0;
+    ep->batch_count = 0;
+    ep->read = ep->head;
+    
+    int64_t now = monotonic_ms();
+    ep->next_connect_at = now + ep->backoff_ms;
+    ep->backoff_ms = ep->backoff_ms * 2 > SENDER_MAX_BACKOFF_MS ? SENDER_MAX_BACKOFF_MS : ep->backoff_ms * 2;
+    sender_shed(s, ep, now);
+}
+
+/**
+ * Connecting to the current address failed: try the next one right away,
+ * or back off and re-resolve once every address has failed.
+ */
+static void sender_connect_failed(macac_sender_t* s, sender_endpoint* ep) {
+    if (ep->addr_next + 1 < ep->addr_count) {
+        sender_close_socket(s, ep);
+        ep->addr_next++;
+        ep->state = SENDER_DISCONNECTED;
+        ep->next_connect_at = monotonic_ms();
+        return;
+    }
+    ep->addr_next = 0;
+    ep->addr_count = 0;
+    sender_disconnect(s, ep);
+}
+
+static void sender_on_connected(macac_sender_t* s, sender_endpoint* ep) {
+    ep->state = SENDER_CONNECTED;
+    ep->backoff_ms = s->reconnect_delay_ms;
+    ep->public_state.store(MACAC_ENDPOINT_UP, std::memory_order_release);
+    if (ep->ever_connected) {
+        ep->reconnects.fetch_add(1, std::memory_order_relaxed);
+        s->reconnects.fetch_add(1, std::memory_order_relaxed);
+    }
+    ep->ever_connected = true;
+    
+    char peer[64] = "";
+    char host[INET6_ADDRSTRLEN];
+    char service[8];
+    const struct sockaddr_storage* addr = &ep->addrs[ep->addr_next];
+    if (getnameinfo((const struct sockaddr*)addr, ep->addr_lens[ep->addr_next], host, sizeof(host),
+                    service, sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV) == 0) {
+        snprintf(peer, sizeof(peer), addr->ss_family == AF_INET6 ? "[%s]:%s" : "%s:%s", host, service);
+    }
+    std::lock_guard<std::mutex> guard(s->resolver->lock);
+    memcpy(s->resolver->peers[ep->index], peer, sizeof(peer));
+}
+
+/**
+ * TCP is up: JSON starts sending immediately, binary sends its hello and
+ * waits for the server to pick a version.
+ */
+static void sender_on_tcp_connected(macac_sender_t* s, sender_endpoint* ep) {
+    if (s->protocol == MACAC_WIRE_JSON) {
+        sender_on_connected(s, ep);
+        return;
+    }
+    
+    char hello[SENDER_HELLO_BYTES] = { 'M', 'A', 'C', 'B', MACAC_WIRE_VERSION,
+        (char)(s->protocol == MACAC_WIRE_BINARY_BATCHED ? 1 : 0), 0, 0 };
+    
+    // A fresh socket's send buffer is empty, so 8 bytes go out in one call
+    if (send(ep->sockfd, hello, sizeof(hello), SENDER_SEND_FLAGS) != (ssize_t)sizeof(hello)) {
+        sender_connect_failed(s, ep);
+        return;
+    }
+    
+    ep->state = SENDER_HANDSHAKE;
+    ep->ack_len = 0;
+    ep->connect_deadline = monotonic_ms() + s->connect_timeout_ms;
+    sender_watch_socket(s, ep, SENDER_EV_IN);
+}
+
+/**
+ * Read the server's ack; on a valid version, queue the preamble and start.
+ */
+static void sender_read_ack(macac_sender_t* s, sender_endpoint* ep) {
+    while (ep->ack_len < SENDER_HELLO_BYTES) {
+        ssize_t n = recv(ep->sockfd, ep->ack + ep->ack_len, SENDER_HELLO_BYTES - ep->ack_len, 0);
+        if (n > 0) {
+            ep->ack_len += (size_t)n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        sender_connect_failed(s, ep);
+        return;
+    }
+    
+    int version = ep->ack[4];
+    if (memcmp(ep->ack, "MACB", 4) != 0 || version < 1 || version > MACAC_WIRE_VERSION) {
+        sender_connect_failed(s, ep);
+        return;
+    }
+    
+    ep->protocol_version.store(version, std::memory_order_release);
+    build_preamble(ep);
+    sender_watch_socket(s, ep, 0);
+    sender_on_connected(s, ep);
+}
+
+/**
+ * Keepalive probes and a bound on unacknowledged data, so a collector that
+ * vanished without a FIN fails over instead of absorbing writes forever.
+ */
+static void set_keepalive(int sockfd) {
+    int one = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+#ifdef TCP_KEEPIDLE
+    int idle = SENDER_KEEPALIVE_IDLE_S;
+    int interval = SENDER_KEEPALIVE_INTERVAL_S;
+    int count = SENDER_KEEPALIVE_COUNT;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+#ifdef TCP_USER_TIMEOUT
+    unsigned int user_timeout = SENDER_USER_TIMEOUT_MS;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_USER_TIMEOUT, &user_timeout, sizeof(user_timeout));
+#endif
+}
+
+/**
+ * Hand a name lookup to the resolver thread (started on first use); its
+ * result arrives through the wake fd.
+ */
+static void sender_request_lookup(macac_sender_t* s, sender_endpoint* ep) {
+    sender_resolver* r = s->resolver.get();
+    {
+        std::lock_guard<std::mutex> guard(r->lock);
+        if (!r->started) {
+            try {
+                std::thread(resolver_run, s->resolver).detach();
+                r->started = true;
+            } catch (...) {
+            }
+        }
+        if (r->started) {
+            memcpy(r->hosts[ep->index], ep->host, sizeof(ep->host));
+            r->ports[ep->index] = ep->port;
+            r->ready[ep->index] = false;
+            r->requests[r->request_count++] = ep->index;
+        }
+    }
+    
+    if (!r->started) {
+        sender_disconnect(s, ep);
+        return;
+    }
+    r->cv.notify_one();
+    ep->state = SENDER_RESOLVING;
+    ep->public_state.store(MACAC_ENDPOINT_RESOLVING, std::memory_order_release);
+}
+
+/**
+ * Pick up a finished lookup. A name that resolves to nothing backs off
+ * like a failed connect.
+ */
+static void sender_poll_lookup(macac_sender_t* s, sender_endpoint* ep, int64_t now) {
+    sender_resolver* r = s->resolver.get();
+    {
+        std::lock_guard<std::mutex> guard(r->lock);
+        if (!r->ready[ep->index]) {
+            return;
+        }
+        r->ready[ep->index] = false;
+        ep->addr_count = r->addr_counts[ep->index];
+        memcpy(ep->addrs, r->addrs[ep->index], ep->addr_count * sizeof(struct sockaddr_storage));
+        memcpy(ep->addr_lens, r->addr_lens[ep->index], ep->addr_count * sizeof(socklen_t));
+    }
+    
+    ep->addr_next = 0;
+    ep->resolved_at = now;
+    if (ep->addr_count == 0) {
+        sender_disconnect(s, ep);
+        return;
+    }
+    ep->state = SENDER_DISCONNECTED;
+    ep->next_connect_at = now;
+}
+
+/**
+ * Start a non-blocking connect to the endpoint's next address. Literal
+ * addresses resolve inline; names go to the resolver thread, so neither a
+ * producer nor the I/O thread ever blocks on DNS.
+ */
+static void sender_start_connect(macac_sender_t* s, sender_endpoint* ep, int64_t now) {
+    if (ep->addr_count == 0 || now - ep->resolved_at >= SENDER_RESOLVE_TTL_MS) {
+        if (!resolve_numeric(ep, now)) {
+            sender_request_lookup(s, ep);
+            return;
+        }
+    }
+    
+    const struct sockaddr_storage* addr = &ep->addrs[ep->addr_next];
+    ep->sockfd = socket(addr->ss_family, SOCK_STREAM, 0);
+    if (ep->sockfd < 0) {
+        sender_connect_failed(s, ep);
+        return;
+    }
+    
+    set_tcp_nodelay(ep->sockfd);
+    set_nonblocking(ep->sockfd);
+    set_keepalive(ep->sockfd);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(ep->sockfd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    
+    ep->public_state.store(MACAC_ENDPOINT_CONNECTING, std::memory_order_release);
+    if (connect(ep->sockfd, (const struct sockaddr*)addr, ep->addr_lens[ep->addr_next]) == 0) {
+        sender_on_tcp_connected(s, ep);
+        return;
+    }
+    if (errno != EINPROGRESS) {
+        sender_connect_failed(s, ep);
+        return;
+    }
+    
+    ep->state = SENDER_CONNECTING;
+    ep->connect_deadline = now + s->connect_timeout_ms;
+    sender_watch_socket(s, ep, SENDER_EV_OUT);
+}
+
+static void sender_finish_connect(macac_sender_t* s, sender_endpoint* ep) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(ep->sockfd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+        sender_connect_failed(s, ep);
+        return;
+    }
+    sender_on_tcp_connected(s, ep);
+}
+
+static void sender_add_entry(sender_endpoint* ep, char* base, size_t len, uint32_t records, uint32_t slots) {
+    size_t i = ep->batch_count++;
+    ep->out_base[i] = base;
+    ep->out_len[i] = len;
+    ep->out_records[i] = records;
+    ep->out_slots[i] = slots;
+    ep->iov[i].iov_base = base;
+    ep->iov[i].iov_len = len;
+}
+
+/**
+ * Drop a record that cannot be encoded. Its slot stays in the backlog,
+ * marked, until the entry covering it is written.
+ */
+static void sender_skip(macac_sender_t* s, sender_message* m) {
+    if (s->spill) {
+        sender_spill_done(s, m);
+    }
+    m->kind = SENDER_SKIPPED;
+    s->dropped.fetch_add(1, std::memory_order_relaxed);
+    s->in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * Whether a backlog record can ride in a batch frame: violations, and
+ * summaries where the server has no summary frame.
+ */
+static inline bool sender_batchable(const sender_endpoint* ep, const sender_message* m) {
+    return m->kind == SENDER_VIOLATION || m->kind == SENDER_SKIPPED ||
+           (m->kind == SENDER_SUMMARY && !sender_summary_frames(ep));
+}
+
+/**
+ * Refill the batch from the backlog: one entry per record, or for batched
+ * binary one entry of new category definitions plus one batch frame.
+ * Only called once the previous batch is fully written (read == head).
+ */
+static void sender_fill_batch(macac_sender_t* s, sender_endpoint* ep) {
+    ep->batch_start = 0;
+    ep->batch_count = 0;
+    uint32_t skipped = 0;           // Dropped slots not yet covered by an entry
+    
+    if (s->protocol != MACAC_WIRE_BINARY_BATCHED) {
+        while (ep->batch_count < SENDER_BATCH && ep->read < ep->tail) {
+            sender_message* m = backlog_at(ep, ep->read++);
+            if (m->kind == SENDER_SKIPPED) {
+                skipped++;
+                continue;
+            }
+            char* slot = ep->out[ep->batch_count];
+            int len = format_message(s, ep, m, slot, SENDER_SLOT_BYTES);
+            if (len < 0) {
+                sender_skip(s, m);
+                skipped++;
+                continue;
+            }
+            sender_add_entry(ep, slot, (size_t)len, 1, 1 + skipped);
+            skipped = 0;
+        }
+    } else {
+        // Batched binary: definitions in the first half of the staging area,
+        // the batch frame in the second; raw records and summary frames end
+        // the batch early
+        char* defs = ep->out[0];
+        char* frame = ep->out[SENDER_BATCH / 2];
+        char* records = frame + SENDER_FRAME_HEADER + 2;
+        size_t defs_len = 0;
+        uint32_t count = 0;
+        
+        while (count < SENDER_BATCH && ep->read < ep->tail) {
+            sender_message* m = backlog_at(ep, ep->read);
+            if (!sender_batchable(ep, m)) {
+                break;
+            }
+            ep->read++;
+            if (m->kind == SENDER_SKIPPED) {
+                skipped++;
+                continue;
+            }
+            if (!encode_record(ep, m, records + count * MACAC_WIRE_RECORD_BYTES, defs, &defs_len)) {
+                sender_skip(s, m);
+                skipped++;
+                continue;
+            }
+            count++;
+        }
+        
+        if (count > 0) {
+            if (defs_len > 0) {
+                sender_add_entry(ep, defs, defs_len, 0, 0);
+            }
+            char* p = put_frame_header(frame, 2 + count * MACAC_WIRE_RECORD_BYTES, MACAC_FRAME_BATCH);
+            put_u16(p, (uint16_t)count);
+            sender_add_entry(ep, frame, SENDER_FRAME_HEADER + 2 + count * MACAC_WIRE_RECORD_BYTES,
+                             count, count + skipped);
+            skipped = 0;
+        } else {
+            // Raw records and summaries at the head of the backlog go out
+            // one frame per entry, up to the next batchable record
+            while (ep->batch_count < SENDER_BATCH && ep->read < ep->tail) {
+                sender_message* m = backlog_at(ep, ep->read);
+                if (m->kind != SENDER_SKIPPED && sender_batchable(ep, m)) {
+                    break;
+                }
+                ep->read++;
+                if (m->kind == SENDER_SKIPPED) {
+                    skipped++;
+                    continue;
+                }
+                char* slot = ep->out[ep->batch_count];
+                int len = format_message(s, ep, m, slot, SENDER_SLOT_BYTES);
+                if (len < 0) {
+                    sender_skip(s, m);
+                    skipped++;
+                    continue;
+                }
+                sender_add_entry(ep, slot, (size_t)len, 1, 1 + skipped);
+                skipped = 0;
+            }
+        }
+    }
+    
+    // Trailing dropped slots ride on the last entry, or are released now
+    if (skipped > 0) {
+        if (ep->batch_count > 0) {
+            ep->out_slots[ep->batch_count - 1] += skipped;
+        } else {
+            sender_advance_head(s, ep, skipped);
+            ep->depth.store(ep->tail - ep->head, std::memory_order_relaxed);
+        }
+    }
+}
+
+enum sender_write_result {
+    SENDER_WRITE_DONE,
+    SENDER_WRITE_BLOCKED,
+    SENDER_WRITE_ERROR
+};
+
+/**
+ * Write the pending preamble and as much of the current batch as the socket
+ * accepts, handling partial writes across entry boundaries.
+ */
+static sender_write_result sender_write_batch(macac_sender_t* s, sender_endpoint* ep, int64_t now) {
+    while (ep->preamble_off < ep->preamble_len || ep->batch_count > 0) {
+        struct iovec iov[SENDER_BATCH + 1];
+        size_t iovcnt = 0;
+        size_t preamble_left = ep->preamble_len - ep->preamble_off;
+        
+        if (preamble_left > 0) {
+            iov[iovcnt].iov_base = ep->preamble + ep->preamble_off;
+            iov[iovcnt].iov_len = preamble_left;
+            iovcnt++;
+        }
+        memcpy(&iov[iovcnt], &ep->iov[ep->batch_start], ep->batch_count * sizeof(struct iovec));
+        iovcnt += ep->batch_count;
+        
+        // sendmsg is writev plus flags, so a dropped peer cannot raise SIGPIPE
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        
+        ssize_t written = sendmsg(ep->sockfd, &msg, SENDER_SEND_FLAGS);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (ep->stalled_since == 0) {
+                    ep->stalled_since = now;
+                }
+                return SENDER_WRITE_BLOCKED;
+            }
+            return SENDER_WRITE_ERROR;
+        }
+        ep->stalled_since = 0;
+        
+        size_t remaining = (size_t)written;
+        size_t from_preamble = remaining < preamble_left ? remaining : preamble_left;
+        ep->preamble_off += from_preamble;
+        remaining -= from_preamble;
+        
+        while (remaining > 0 && ep->batch_count > 0) {
+            struct iovec* v = &ep->iov[ep->batch_start];
+            if (remaining >= v->iov_len) {
+                uint32_t records = ep->out_records[ep->batch_start];
+                sender_advance_head(s, ep, ep->out_slots[ep->batch_start]);
+                remaining -= v->iov_len;
+                ep->batch_start++;
+                ep->batch_count--;
+                ep->sent.fetch_add(records, std::memory_order_relaxed);
+                s->sent.fetch_add(records, std::memory_order_relaxed);
+                s->in_flight.fetch_sub(records, std::memory_order_release);
+            } else {
+                v->iov_base = (char*)v->iov_base + remaining;
+                v->iov_len -= remaining;
+                remaining = 0;
+            }
+        }
+        ep->depth.store(ep->tail - ep->head, std::memory_order_relaxed);
+    }
+    return SENDER_WRITE_DONE;
+}
+
+static inline bool sender_pending_write(const sender_endpoint* ep) {
+    return ep->batch_count > 0 || ep->preamble_off < ep->preamble_len;
+}
+
+/**
+ * Drop everything still queued or in a backlog (shutdown gave up). With a
+ * spill log, records are spilled for the next run instead; ones read back
+ * from it are still there, unacknowledged.
+ */
+static void sender_discard_pending(macac_sender_t* s) {
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        for (size_t pos = ep->head; pos < ep->tail; pos++) {
+            const sender_message* m = backlog_at(ep, pos);
+            if (m->kind == SENDER_SKIPPED) {
+                continue;
+            }
+            if (m->spill_ticket == 0 && !(s->spill && sender_spill(s, m))) {
+                s->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            s->in_flight.fetch_sub(1, std::memory_order_release);
+        }
+        ep->batch_count = 0;
+        ep->head = ep->read = ep->tail;
+        ep->depth.store(0, std::memory_order_relaxed);
+    }
+    
+    sender_cell* cell;
+    while ((cell = sender_peek(s)) != nullptr) {
+        if (!(s->spill && sender_spill(s, &cell->msg))) {
+            s->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        sender_release(s, cell);
+    }
+}
+
+static inline int min_timeout(int timeout_ms, int64_t deadline, int64_t now) {
+    int64_t left = deadline - now;
+    return left < timeout_ms ? (int)left : timeout_ms;
+}
+
+/**
+ * I/O thread main loop.
+ */
+static void sender_run(macac_sender_t* s) {
+    int64_t shutdown_deadline = 0;
+    
+    for (;;) {
+        int64_t now = monotonic_ms();
+        
+        if (s->stopping.load(std::memory_order_acquire)) {
+            if (shutdown_deadline == 0) {
+                shutdown_deadline = now + SENDER_SHUTDOWN_FLUSH_MS;
+            }
+            bool drained = s->in_flight.load(std::memory_order_acquire) == 0 && sender_queue_empty(s) &&
+                           (!s->spill || spill_unread(s->spill) == 0);
+            
+            // With a spill log nothing waits on a collector that is down
+            if (drained || now >= shutdown_deadline || (s->spill && sender_outage(s, now))) {
+                break;
+            }
+        }
+        
+        // Connection management
+        bool awaiting = false;
+        for (size_t i = 0; i < s->endpoint_count; i++) {
+            sender_endpoint* ep = &s->endpoints[i];
+            if (ep->state == SENDER_RESOLVING) {
+                sender_poll_lookup(s, ep, now);
+            }
+            if (ep->state == SENDER_DISCONNECTED && now >= ep->next_connect_at) {
+                sender_start_connect(s, ep, now);
+            }
+            awaiting |= ep->state != SENDER_CONNECTED && ep->state != SENDER_DISCONNECTED;
+        }
+        
+        sender_route(s, now);
+        
+        // Appends become durable in batches, not per record
+        if (s->spill && spill_dirty(s->spill) && now - s->spill_synced_at >= SENDER_SPILL_SYNC_MS) {
+            spill_sync(s->spill);
+            s->spill_synced_at = now;
+        }
+        
+        bool progress = false;
+        for (size_t i = 0; i < s->endpoint_count; i++) {
+            sender_endpoint* ep = &s->endpoints[i];
+            if (ep->state != SENDER_CONNECTED) {
+                continue;
+            }
+            if (ep->batch_count == 0) {
+                sender_fill_batch(s, ep);
+            }
+            if (sender_pending_write(ep)) {
+                sender_write_result result = sender_write_batch(s, ep, now);
+                if (result == SENDER_WRITE_ERROR) {
+                    sender_disconnect(s, ep);
+                    progress = true;
+                } else if (result == SENDER_WRITE_DONE) {
+                    progress = true;
+                }
+            }
+            ep->public_state.store(sender_healthy(s, ep, now) ? MACAC_ENDPOINT_UP : MACAC_ENDPOINT_STALLED,
+                                   std::memory_order_relaxed);
+        }
+        
+        // Keep writing while there is work, polling (not waiting) for
+        // events when another endpoint is mid-connect
+        if (progress && !awaiting) {
+            continue;
+        }
+        
+        // Decide what to wait for
+        int timeout_ms = progress ? 0 : SENDER_IDLE_WAIT_MS;
+        for (size_t i = 0; i < s->endpoint_count; i++) {
+            sender_endpoint* ep = &s->endpoints[i];
+            switch (ep->state) {
+            case SENDER_CONNECTED:
+                sender_watch_socket(s, ep, sender_pending_write(ep) ? SENDER_EV_OUT : 0u);
+                if (ep->stalled_since != 0 && sender_healthy(s, ep, now)) {
+                    timeout_ms = min_timeout(timeout_ms, ep->stalled_since + s->connect_timeout_ms, now);
+                }
+                break;
+            case SENDER_CONNECTING:
+            case SENDER_HANDSHAKE:
+                timeout_ms = min_timeout(timeout_ms, ep->connect_deadline, now);
+                break;
+            case SENDER_DISCONNECTED:
+                timeout_ms = min_timeout(timeout_ms, ep->next_connect_at, now);
+                break;
+            case SENDER_RESOLVING:
+                break;      // The resolver writes the wake fd
+            }
+        }
+        
+        bool parked = false;
+        if (sender_queue_empty(s)) {
+            // Park until a producer publishes
+            s->consumer_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!sender_queue_empty(s)) {
+                s->consumer_waiting.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            parked = true;
+        }
+        
+        if (shutdown_deadline != 0) {
+            timeout_ms = min_timeout(timeout_ms, shutdown_deadline, now);
+        }
+        if (s->spill && spill_dirty(s->spill)) {
+            timeout_ms = min_timeout(timeout_ms, s->spill_synced_at + SENDER_SPILL_SYNC_MS, now);
+        }
+        if (s->spill && !parked && timeout_ms > SENDER_SPILL_POLL_MS) {
+            // Producers only wake a parked thread; records stuck behind a full
+            // backlog must be checked for spilling before the queue fills
+            timeout_ms = SENDER_SPILL_POLL_MS;
+        }
+        if (timeout_ms < 0) {
+            timeout_ms = 0;
+        }
+        
+        sender_wait(s, timeout_ms);
+        if (parked) {
+            s->consumer_waiting.store(false, std::memory_order_relaxed);
+        }
+        
+        now = monotonic_ms();
+        for (size_t i = 0; i < s->endpoint_count; i++) {
+            sender_endpoint* ep = &s->endpoints[i];
+            if (ep->state == SENDER_CONNECTING) {
+                if (ep->writable || ep->error) {
+                    sender_finish_connect(s, ep);
+                } else if (now >= ep->connect_deadline) {
+                    sender_connect_failed(s, ep);
+                }
+            } else if (ep->state == SENDER_HANDSHAKE) {
+                if (ep->readable || ep->error) {
+                    sender_read_ack(s, ep);
+                } else if (now >= ep->connect_deadline) {
+                    sender_connect_failed(s, ep);
+                }
+            } else if (ep->state == SENDER_CONNECTED && ep->error) {
+                sender_disconnect(s, ep);
+            }
+        }
+    }
+    
+    // Nothing will be shed from here on: stop routing before discarding
+    // (spilling, if enabled; the log is synced when the sender is freed)
+    sender_discard_pending(s);
+    for (size_t i = 0; i < s->endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        if (ep->sockfd >= 0) {
+            shutdown(ep->sockfd, SHUT_WR);
+        }
+        sender_close_socket(s, ep);
+        ep->state = SENDER_DISCONNECTED;
+        ep->public_state.store(MACAC_ENDPOINT_DOWN, std::memory_order_release);
+    }
+}
+
+static void sender_free(macac_sender_t* s) {
+    if (s->resolver) {
+        std::lock_guard<std::mutex> guard(s->resolver->lock);
+        s->resolver->closed = true;
+        s->resolver->cv.notify_all();
+    }
+    if (s->wake_fd >= 0) close(s->wake_fd);
+    if (s->wake_wr_fd >= 0 && s->wake_wr_fd != s->wake_fd) close(s->wake_wr_fd);
+    if (s->epoll_fd >= 0) close(s->epoll_fd);
+    if (s->endpoints) {
+        for (size_t i = 0; i < s->endpoint_count; i++) {
+            delete[] s->endpoints[i].backlog;
+            delete[] s->endpoints[i].out;
+        }
+        delete[] s->endpoints;
+    }
+    spill_close(s->spill);
+    delete[] s->cells;
+    delete s;
+}
+
+/**
+ * Allocate a sender with endpoint_count blank endpoints (hosts filled in
+ * by the caller before sender_start).
+ */
+static macac_sender_t* sender_alloc(size_t endpoint_count, size_t queue_capacity,
+                                    int connect_timeout_ms, int reconnect_delay_ms, int protocol) {
+    if (endpoint_count == 0 || endpoint_count > MACAC_SENDER_MAX_ENDPOINTS ||
+        queue_capacity == 0 || queue_capacity > ((size_t)1 << 24) ||
+        protocol < MACAC_WIRE_JSON || protocol > MACAC_WIRE_BINARY_BATCHED) {
+        return nullptr;
+    }
+    
+    macac_sender_t* s = new (std::nothrow) macac_sender_t();
+    if (!s) {
+        return nullptr;
+    }
+    
+    s->protocol = protocol;
+    s->connect_timeout_ms = connect_timeout_ms > 0 ? connect_timeout_ms : 5000;
+    s->reconnect_delay_ms = reconnect_delay_ms > 0 ? reconnect_delay_ms : 1000;
+    s->wake_fd = -1;
+    s->wake_wr_fd = -1;
+    s->epoll_fd = -1;
+    
+    size_t capacity = round_up_pow2(queue_capacity);
+    s->mask = capacity - 1;
+    s->cells = new (std::nothrow) sender_cell[capacity];
+    s->endpoints = new (std::nothrow) sender_endpoint[endpoint_count]();
+    if (!s->cells || !s->endpoints) {
+        sender_free(s);
+        return nullptr;
+    }
+    s->endpoint_count = endpoint_count;
+    for (size_t i = 0; i < capacity; i++) {
+        s->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    for (size_t i = 0; i < endpoint_count; i++) {
+        sender_endpoint* ep = &s->endpoints[i];
+        ep->index = (uint32_t)i;
+        ep->sockfd = -1;
+        ep->state = SENDER_DISCONNECTED;
+        ep->backoff_ms = s->reconnect_delay_ms;
+        ep->backlog = new (std::nothrow) sender_message[SENDER_BACKLOG];
+        ep->out = new (std::nothrow) char[SENDER_BATCH][SENDER_SLOT_BYTES];
+        if (!ep->backlog || !ep->out) {
+            sender_free(s);
+            return nullptr;
+        }
+    }
+    
+    try {
+        s->resolver = std::make_shared<sender_resolver>();
+    } catch (...) {
+        sender_free(s);
+        return nullptr;
+    }
+    return s;
+}
+
+/**
+ * Create the wake and epoll fds and start the I/O thread.
+ */
+static macac_sender_t* sender_start(macac_sender_t* s) {
+#ifdef __linux__
+    s->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    s->wake_wr_fd = s->wake_fd;
+    s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (s->wake_fd < 0 || s->epoll_fd < 0) {
+        sender_free(s);
+        return nullptr;
+    }
+    
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = SENDER_WAKE_TAG;
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->wake_fd, &ev);
+#else
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0) {
+        sender_free(s);
+        return nullptr;
+    }
+    s->wake_fd = pipe_fds[0];
+    s->wake_wr_fd = pipe_fds[1];
+    set_nonblocking(s->wake_fd);
+    set_nonblocking(s->wake_wr_fd);
+#endif
+    s->resolver->wake_fd = s->wake_wr_fd;
+    
+    try {
+        s->thread = std::thread(sender_run, s);
+    } catch (...) {
+        sender_free(s);
+        return nullptr;
+    }
+    
+    return s;
+}
+
+/**
+ * Allocate a sender over an endpoint list (see macac_sender_create_pool),
+ * not yet started.
+ */
+static macac_sender_t* sender_alloc_pool(const char* endpoints, int default_port,
+                                         size_t queue_capacity, int connect_timeout_ms,
+                                         int reconnect_delay_ms, int protocol) {
+    if (!endpoints) {
+        return nullptr;
+    }
+    
+    // Validate and count first so a bad entry rejects the whole list
+    char host[256];
+    int port;
+    size_t count = 0;
+    for (const char* p = endpoints; *p; ) {
+        while (*p && is_endpoint_separator(*p)) p++;
+        const char* start = p;
+        while (*p && !is_endpoint_separator(*p)) p++;
+        if (p == start) {
+            continue;
+        }
+        if (!parse_endpoint(start, (size_t)(p - start), default_port, host, sizeof(host), &port) ||
+            ++count > MACAC_SENDER_MAX_ENDPOINTS) {
+            return nullptr;
+        }
+    }
+    
+    macac_sender_t* s = sender_alloc(count, queue_capacity, connect_timeout_ms, reconnect_delay_ms, protocol);
+    if (!s) {
+        return nullptr;
+    }
+    
+    size_t i = 0;
+    for (const char* p = endpoints; *p; ) {
+        while (*p && is_endpoint_separator(*p)) p++;
+        const char* start = p;
+        while (*p && !is_endpoint_separator(*p)) p++;
+        if (p > start) {
+            sender_endpoint* ep = &s->endpoints[i++];
+            parse_endpoint(start, (size_t)(p - start), default_port, ep->host, sizeof(ep->host), &ep->port);
+        }
+    }
+    return s;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+extern "C" {
+
+macac_connection_t* macac_net_connect(const char* host, int port) {
+    if (!host || port <= 0 || port > 65535) {
+        return nullptr;
+    }
+    
+    macac_connection_t* conn = new (std::nothrow) macac_connection_t();
+    if (!conn) {
+        return nullptr;
+    }
+    
+    memset(conn, 0, sizeof(macac_connection_t));
+    strncpy(conn->host, host, sizeof(conn->host) - 1);
+    conn->port = port;
+    
+    // Resolve (IPv4 or IPv6) and connect with a bounded wait per address;
+    // the socket stays non-blocking
+    conn->sockfd = connect_host(host, port, NET_CONNECT_TIMEOUT_MS);
+    if (conn->sockfd < 0) {
+        delete conn;
+        return nullptr;
+    }
+    
+    set_tcp_nodelay(conn->sockfd);
+    conn->connected = true;
+    return conn;
+}
+
+int macac_net_send_violation(macac_connection_t* conn,
+                              const char* player_uuid,
+                              const char* category,
+                              double confidence,
+                              double severity,
+                              int64_t timestamp) {
+    if (!conn || !conn->connected || conn->sockfd < 0) {
+        return -1;
+    }
+    
+    if (!player_uuid || !category) {
+        return -1;
+    }
+    
+    // Format JSON message
+    char json_buffer[1024];
+    int json_len = format_violation_json(json_buffer, sizeof(json_buffer),
+                                          player_uuid, category,
+                                          confidence, severity, timestamp);
+    
+    if (json_len < 0 || json_len >= (int)sizeof(json_buffer)) {
+        return -1;
+    }
+    
+    // Earlier bytes go first so messages are never reordered or interleaved
+    int pending = flush_send_buffer(conn);
+    if (pending < 0) {
+        conn->connected = false;
+        return -1;
+    }
+    
+    ssize_t sent = 0;
+    if (pending == 0) {
+        sent = send(conn->sockfd, json_buffer, json_len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                // Connection error
+                conn->connected = false;
+                return -1;
+            }
+            sent = 0;
+        }
+    }
+    
+    // Would block or partial write: buffer the remainder for the next call
+    size_t remainder = (size_t)json_len - (size_t)sent;
+    if (remainder > 0) {
+        if (conn->send_buffer_len + remainder > sizeof(conn->send_buffer)) {
+            return -1; // Buffer full
+        }
+        memcpy(conn->send_buffer + conn->send_buffer_len, json_buffer + sent, remainder);
+        conn->send_buffer_len += remainder;
+    }
+    
+    return (int)sent;
+}
+
+void macac_net_close(macac_connection_t* conn) {
+    if (!conn) {
+        return;
+    }
+    
+    if (conn->sockfd >= 0) {
+        // Graceful shutdown
+        shutdown(conn->sockfd, SHUT_RDWR);
+        close(conn->sockfd);
+    }
+    
+    delete conn;
+}
+
+int macac_net_is_connected(macac_connection_t* conn) {
+    if (!conn || !conn->connected || conn->sockfd < 0) {
+        return 0;
+    }
+    
+    // Check if connection is still alive using poll
+    struct pollfd pfd;
+    pfd.fd = conn->sockfd;
+    pfd.events = POLLOUT | POLLERR | POLLHUP;
+    
+    int ret = poll(&pfd, 1, 0);
+    if (ret < 0) {
+        conn->connected = false;
+        return 0;
+    }
+    
+    if (pfd.revents & (POLLERR | POLLHUP)) {
+        conn->connected = false;
+        return 0;
+    }
+    
+    return 1;
+}
+
+macac_sender_t* macac_sender_create(const char* host, int port, size_t queue_capacity,
+                                    int connect_timeout_ms, int reconnect_delay_ms,
+                                    int protocol) {
+    if (!host || port <= 0 || port > 65535) {
+        return nullptr;
+    }
+    
+    // Accept a bracketed IPv6 literal as well as a bare one
+    size_t len = strlen(host);
+    if (len >= 2 && host[0] == '[' && host[len - 1] == ']') {
+        host++;
+        len -= 2;
+    }
+    if (len == 0 || len >= sizeof(sender_endpoint::host)) {
+        return nullptr;
+    }
+    
+    macac_sender_t* s = sender_alloc(1, queue_capacity, connect_timeout_ms, reconnect_delay_ms, protocol);
+    if (!s) {
+        return nullptr;
+    }
+    memcpy(s->endpoints[0].host, host, len);
+    s->endpoints[0].port = port;
+    return sender_start(s);
+}
+
+macac_sender_t* macac_sender_create_pool(const char* endpoints, int default_port,
+                                         size_t queue_capacity, int connect_timeout_ms,
+                                         int reconnect_delay_ms, int protocol) {
+    macac_sender_t* s = sender_alloc_pool(endpoints, default_port, queue_capacity,
+                                          connect_timeout_ms, reconnect_delay_ms, protocol);
+    return s ? sender_start(s) : nullptr;
+}
+
+macac_sender_t* macac_sender_create_spill(const char* endpoints, int default_port,
+                                          size_t queue_capacity, int connect_timeout_ms,
+                                          int reconnect_delay_ms, int protocol,
+                                          const macac_spill_config_t* spill) {
+    if (!spill || !spill->directory) {
+        return nullptr;
+    }
+    
+    macac_sender_t* s = sender_alloc_pool(endpoints, default_port, queue_capacity,
+                                          connect_timeout_ms, reconnect_delay_ms, protocol);
+    if (!s) {
+        return nullptr;
+    }
+    
+    s->spill = spill_open(spill->directory,
+                          spill->segment_bytes ? spill->segment_bytes : MACAC_SPILL_SEGMENT_BYTES,
+                          spill->max_bytes ? spill->max_bytes : MACAC_SPILL_MAX_BYTES,
+                          SENDER_SPILL_FORMAT);
+    if (!s->spill) {
+        sender_free(s);
+        return nullptr;
+    }
+    
+    size_t capacity = s->mask + 1;
+    s->spill_high_water = spill->high_water > 0 && spill->high_water < capacity ?
+                          spill->high_water : capacity - capacity / 4;
+    
+    // Records left by an earlier run are waiting as far as macac_sender_flush is concerned
+    s->spill_depth.store(spill_unread(s->spill), std::memory_order_relaxed);
+    return sender_start(s);
+}
+
+void macac_sender_destroy(macac_sender_t* sender) {
+    if (!sender) {
+        return;
+    }
+    
+    sender->stopping.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t ignored = write(sender->wake_wr_fd, &one, sizeof(one));
+    (void)ignored;
+    
+    if (sender->thread.joinable()) {
+        sender->thread.join();
+    }
+    sender_free(sender);
+}
+
+int macac_sender_send_violation(macac_sender_t* sender,
+                                const char* player_uuid,
+                                const char* category,
+                                double confidence,
+                                double severity,
+                                int64_t timestamp) {
+    return macac_sender_send_summary(sender, player_uuid, category, 1, confidence, severity,
+                                     timestamp, timestamp);
+}
+
+int macac_sender_send_summary(macac_sender_t* sender,
+                              const char* player_uuid,
+                              const char* category,
+                              uint32_t count,
+                              double max_confidence,
+                              double mean_severity,
+                              int64_t first_timestamp,
+                              int64_t last_timestamp) {
+    if (!sender || !player_uuid || !category || count == 0) {
+        return -1;
+    }
+    
+    size_t uuid_len = strlen(player_uuid);
+    size_t category_len = strlen(category);
+    if (uuid_len + category_len > MACAC_SENDER_MAX_MESSAGE ||
+        sender->stopping.load(std::memory_order_relaxed)) {
+        sender->dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    
+    size_t pos;
+    sender_cell* cell = sender_claim(sender, &pos);
+    if (!cell) {
+        sender->dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    
+    // A single violation keeps its own record type
+    cell->msg.kind = count == 1 ? SENDER_VIOLATION : SENDER_SUMMARY;
+    cell->msg.uuid_len = (uint16_t)uuid_len;
+    cell->msg.len = (uint16_t)(uuid_len + category_len);
+    cell->msg.count = count;
+    cell->msg.confidence = max_confidence;
+    cell->msg.severity = mean_severity;
+    cell->msg.timestamp = last_timestamp;
+    cell->msg.first_timestamp = first_timestamp;
+    cell->msg.spill_ticket = 0;
+    memcpy(cell->msg.payload, player_uuid, uuid_len);
+    memcpy(cell->msg.payload + uuid_len, category, category_len);
+    
+    sender_publish(sender, cell, pos);
+    return 0;
+}
+
+int macac_sender_send_raw(macac_sender_t* sender, const char* data, size_t len) {
+    if (!sender || !data || len == 0) {
+        return -1;
+    }
+    
+    if (len > MACAC_SENDER_MAX_MESSAGE || sender->stopping.load(std::memory_order_relaxed)) {
+        sender->dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    
+    size_t pos;
+    sender_cell* cell = sender_claim(sender, &pos);
+    if (!cell) {
+        sender->dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    
+    cell->msg.kind = SENDER_RAW;
+    cell->msg.uuid_len = 0;
+    cell->msg.len = (uint16_t)len;
+    cell->msg.spill_ticket = 0;
+    memcpy(cell->msg.payload, data, len);
+    
+    sender_publish(sender, cell, pos);
+    return 0;
+}
+
+int macac_sender_flush(macac_sender_t* sender, int timeout_ms) {
+    if (!sender) {
+        return 0;
+    }
+    
+    int64_t deadline = monotonic_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    for (;;) {
+        size_t queued = sender->enqueue_pos.load(std::memory_order_acquire) -
+                        sender->dequeue_pos.load(std::memory_order_acquire);
+        if (queued == 0 && sender->in_flight.load(std::memory_order_acquire) == 0 &&
+            sender->spill_depth.load(std::memory_order_acquire) == 0) {
+            return 1;
+        }
+        if (monotonic_ms() >= deadline) {
+            return 0;
+        }
+        usleep(1000);
+    }
+}
+
+void macac_sender_get_stats(macac_sender_t* sender, macac_sender_stats_t* out) {
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!sender) {
+        return;
+    }
+    
+    size_t queued = sender->enqueue_pos.load(std::memory_order_acquire) -
+                    sender->dequeue_pos.load(std::memory_order_acquire);
+    
+    out->enqueued = sender->enqueued.load(std::memory_order_relaxed);
+    out->sent = sender->sent.load(std::memory_order_relaxed);
+    out->dropped = sender->dropped.load(std::memory_order_relaxed);
+    out->reconnects = sender->reconnects.load(std::memory_order_relaxed);
+    out->queue_depth = queued + sender->in_flight.load(std::memory_order_relaxed);
+    out->failovers = sender->failovers.load(std::memory_order_relaxed);
+    out->endpoints = (int)sender->endpoint_count;
+    out->spilled = sender->spilled.load(std::memory_order_relaxed);
+    out->replayed = sender->replayed.load(std::memory_order_relaxed);
+    out->spill_depth = sender->spill_depth.load(std::memory_order_relaxed);
+    
+    // Connected and version come from the first endpoint that is up
+    for (size_t i = 0; i < sender->endpoint_count; i++) {
+        const sender_endpoint* ep = &sender->endpoints[i];
+        if (ep->public_state.load(std::memory_order_acquire) != MACAC_ENDPOINT_UP) {
+            continue;
+        }
+        if (out->endpoints_up++ == 0) {
+            out->connected = 1;
+            out->protocol_version = ep->protocol_version.load(std::memory_order_acquire);
+        }
+    }
+}
+
+int macac_sender_get_endpoint_stats(macac_sender_t* sender, int index,
+                                    macac_sender_endpoint_stats_t* out) {
+    if (!out) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!sender || index < 0 || (size_t)index >= sender->endpoint_count) {
+        return -1;
+    }
+    
+    const sender_endpoint* ep = &sender->endpoints[index];
+    snprintf(out->endpoint, sizeof(out->endpoint), strchr(ep->host, ':') ? "[%s]:%d" : "%s:%d",
+             ep->host, ep->port);
+    {
+        std::lock_guard<std::mutex> guard(sender->resolver->lock);
+        memcpy(out->peer, sender->resolver->peers[index], sizeof(out->peer));
+    }
+    out->sent = ep->sent.load(std::memory_order_relaxed);
+    out->reconnects = ep->reconnects.load(std::memory_order_relaxed);
+    out->backlog = ep->depth.load(std::memory_order_relaxed);
+    out->state = ep->public_state.load(std::memory_order_acquire);
+    out->protocol_version = ep->protocol_version.load(std::memory_order_acquire);
+    return 0;
 }
 
 } // extern "C"
@@ -0,0 +1,326 @@
+/*
+ * MacAC Native Library - Rolling Order Statistics
+ * 
+ * Sliding-window median/MAD without per-query allocation or sorting.
+ * 
+ * The window is a ring of samples; every ring slot doubles as a node of an
+ * order-statistic treap keyed by (value, slot), so duplicates stay distinct
+ * and evicting the oldest sample is "erase node[head]". All nodes are
+ * preallocated at create time.
+ * 
+ *   push     O(log n) expected (erase oldest + insert newest, cache median)
+ *   median   O(1)     (cached on push)
+ *   select   O(log n) expected
+ *   mad      O(log^2 n) expected (k-th of two sorted deviation sequences)
+ */
+
+#include "macac_native.h"
+#include <cstdlib>
+#include <cmath>
+
+// Null node index
+#define OS_NIL UINT32_MAX
+
+struct macac_order_stats {
+    double* values;             // [slot] sample stored in ring slot
+    uint32_t* left;             // [slot] treap children
+    uint32_t* right;
+    uint32_t* sizes;            // [slot] subtree size
+    uint32_t* priorities;       // [slot] heap priority
+    
+    size_t capacity;
+    size_t head;                // Next ring slot to write
+    size_t count;               // Current element count
+    uint32_t root;
+    uint32_t rng;               // xorshift state for priorities
+    
+    double median;              // Cached after every push
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static inline uint32_t next_priority(macac_order_stats_t* os) {
+    uint32_t x = os->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    os->rng = x;
+    return x;
+}
+
+static inline uint32_t node_size(const macac_order_stats_t* os, uint32_t n) {
+    return n == OS_NIL ? 0 : os->sizes[n];
+}
+
+static inline void update(macac_order_stats_t* os, uint32_t n) {
+    os->sizes[n] = 1 + node_size(os, os->left[n]) + node_size(os, os->right[n]);
+}
+
+/**
+ * Strict weak order on (value, slot). NaN sorts after every number so the
+ * tree stays consistent when a NaN sample is pushed.
+ */
+static inline bool key_less(const macac_order_stats_t* os, uint32_t a, uint32_t b) {
+    double va = os->values[a];
+    double vb = os->values[b];
+    bool na = std::isnan(va);
+    bool nb = std::isnan(vb);
+    
+    if (na != nb) {
+        return nb;
+    }
+    if (!na && va != vb) {
+        return va < vb;
+    }
+    return a < b;
+}
+
+/**
+ * Split tree into keys < pivot and keys >= pivot.
+ */
+static void split(macac_order_stats_t* os, uint32_t n, uint32_t pivot,
+                  uint32_t* out_left, uint32_t* out_right) {
+    if (n == OS_NIL) {
+        *out_left = OS_NIL;
+        *out_right = OS_NIL;
+        return;
+    }
+    
+    if (key_less(os, n, pivot)) {
+        split(os, os->right[n], pivot, &os->right[n], out_right);
+        *out_left = n;
+    } else {
+        split(os, os->left[n], pivot, out_left, &os->left[n]);
+        *out_right = n;
+    }
+    update(os, n);
+}
+
+/**
+ * Merge two trees where every key of a precedes every key of b.
+ */
+static uint32_t merge(macac_order_stats_t* os, uint32_t a, uint32_t b) {
+    if (a == OS_NIL) return b;
+    if (b == OS_NIL) return a;
+    
+    if (os->priorities[a] > os->priorities[b]) {
+        os->right[a] = merge(os, os->right[a], b);
+        update(os, a);
+        return a;
+    }
+    os->left[b] = merge(os, a, os->left[b]);
+    update(os, b);
+    return b;
+}
+
+static void tree_insert(macac_order_stats_t* os, uint32_t n) {
+    os->left[n] = OS_NIL;
+    os->right[n] = OS_NIL;
+    os->sizes[n] = 1;
+    os->priorities[n] = next_priority(os);
+    
+    uint32_t l, r;
+    split(os, os->root, n, &l, &r);
+    os->root = merge(os, merge(os, l, n), r);
+}
+
+/**
+ * Remove node n. Keys are unique, so n is the minimum of the >= n half.
+ */
+static void tree_erase(macac_order_stats_t* os, uint32_t n) {
+    uint32_t l, r;
+    split(os, os->root, n, &l, &r);
+    
+    // Unlink n from the leftmost spine of r
+    uint32_t* link = &r;
+    while (*link != n) {
+        os->sizes[*link]--;
+        link = &os->left[*link];
+    }
+    *link = os->right[n];
+    
+    os->root = merge(os, l, r);
+}
+
+/**
+ * Value of the k-th smallest element (0-based).
+ */
+static double select_value(const macac_order_stats_t* os, size_t k) {
+    uint32_t n = os->root;
+    while (n != OS_NIL) {
+        size_t left_size = node_size(os, os->left[n]);
+        if (k < left_size) {
+            n = os->left[n];
+        } else if (k == left_size) {
+            return os->values[n];
+        } else {
+            k -= left_size + 1;
+            n = os->right[n];
+        }
+    }
+    return std::nan("");
+}
+
+static double compute_median(const macac_order_stats_t* os) {
+    size_t n = os->count;
+    if (n == 0) {
+        return 0.0;
+    }
+    if (n % 2 == 0) {
+        return (select_value(os, n / 2 - 1) + select_value(os, n / 2)) / 2.0;
+    }
+    return select_value(os, n / 2);
+}
+
+/**
+ * k-th smallest absolute deviation (0-based).
+ * 
+ * Sorted samples s[0..n) split at c = n/2 into two sequences that are
+ * already sorted by deviation from the median m:
+ *   below[j] = m - s[c - 1 - j]    (j < c)
+ *   above[j] = s[c + j] - m        (j < n - c)
+ * The k-th of their union is found by binary search on how many come
+ * from below.
+ */
+static double kth_deviation(const macac_order_stats_t* os, double m, size_t k) {
+    size_t c = os->count / 2;
+    size_t na = c;
+    size_t nb = os->count - c;
+    size_t take = k + 1;
+    
+    size_t lo = take > nb ? take - nb : 0;
+    size_t hi = take < na ? take : na;
+    
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = take - i;
+        double below_i = m - select_value(os, c - 1 - i);
+        double above_j = select_value(os, c + j - 1) - m;
+        if (below_i < above_j) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    
+    size_t i = lo;
+    size_t j = take - i;
+    double result = -INFINITY;
+    if (i > 0) {
+        result = m - select_value(os, c - i);
+    }
+    if (j > 0) {
+        double above = select_value(os, c + j - 1) - m;
+        if (above > result) {
+            result = above;
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+extern "C" {
+
+macac_order_stats_t* macac_order_stats_create(size_t window) {
+    if (window == 0 || window >= OS_NIL) {
+        return nullptr;
+    }
+    
+    macac_order_stats_t* os = new macac_order_stats_t();
+    
+    os->capacity = window;
+    os->values = (double*)calloc(window, sizeof(double));
+    os->left = (uint32_t*)malloc(window * sizeof(uint32_t));
+    os->right = (uint32_t*)malloc(window * sizeof(uint32_t));
+    os->sizes = (uint32_t*)malloc(window * sizeof(uint32_t));
+    os->priorities = (uint32_t*)malloc(window * sizeof(uint32_t));
+    
+    if (!os->values || !os->left || !os->right || !os->sizes || !os->priorities) {
+        macac_order_stats_destroy(os);
+        return nullptr;
+    }
+    
+    os->rng = 0x9E3779B9u;
+    macac_order_stats_clear(os);
+    return os;
+}
+
+void macac_order_stats_destroy(macac_order_stats_t* os) {
+    if (!os) {
+        return;
+    }
+    
+    free(os->values);
+    free(os->left);
+    free(os->right);
+    free(os->sizes);
+    free(os->priorities);
+    delete os;
+}
+
+void macac_order_stats_push(macac_order_stats_t* os, double value) {
+    if (!os) {
+        return;
+    }
+    
+    uint32_t slot = (uint32_t)os->head;
+    
+    if (os->count == os->capacity) {
+        tree_erase(os, slot);
+    } else {
+        os->count++;
+    }
+    
+    os->values[slot] = value;
+    tree_insert(os, slot);
+    
+    os->head = (os->head + 1) % os->capacity;
+    os->median = compute_median(os);
+}
+
+void macac_order_stats_clear(macac_order_stats_t* os) {
+    if (!os) {
+        return;
+    }
+    
+    os->root = OS_NIL;
+    os->head = 0;
+    os->count = 0;
+    os->median = 0.0;
+}
+
+size_t macac_order_stats_size(macac_order_stats_t* os) {
+    return os ? os->count : 0;
+}
+
+double macac_order_stats_median(macac_order_stats_t* os) {
+    return os ? os->median : 0.0;
+}
+
+double macac_order_stats_select(macac_order_stats_t* os, size_t k) {
+    if (!os || k >= os->count) {
+        return std::nan("");
+    }
+    return select_value(os, k);
+}
+
+double macac_order_stats_mad(macac_order_stats_t* os) {
+    if (!os || os->count == 0) {
+        return 0.0;
+    }
+    
+    size_t n = os->count;
+    double m = os->median;
+    
+    if (n % 2 == 0) {
+        return (kth_deviation(os, m, n / 2 - 1) + kth_deviation(os, m, n / 2)) / 2.0;
+    }
+    return kth_deviation(os, m, n / 2);
+}
+
+} // extern "C"
@@ -0,0 +1,231 @@
+/*
+ * MacAC Native Library - Packet Queue
+ * 
+ * Bounded lock-free queues that carry fixed-size telemetry records from
+ * packet threads (netty I/O) to the analysis thread.
+ * 
+ * Both variants keep the producer index, the consumer index and the drop
+ * counter on separate cache lines and index cells with a power-of-two mask.
+ * 
+ * - SPSC: Lamport queue. Each side caches the other side's index and only
+ *   reloads it when the cached value says full/empty, so the steady state
+ *   touches no shared line except the cell itself.
+ * - MPSC: Vyukov sequence cells (as in the async sender). Producers claim a
+ *   position with one CAS and publish the cell with a release store; the
+ *   consumer drains runs of published cells.
+ */
+
+#include "macac_native.h"
+#include <cstring>
+#include <new>
+
+// Upper bound on capacity (records), matching the async sender
+#define QUEUE_MAX_CAPACITY ((size_t)1 << 24)
+
+static_assert(sizeof(macac_telemetry_record_t) == MACAC_TELEMETRY_RECORD_SIZE,
+              "telemetry record layout is shared with Java");
+
+/**
+ * Queue cell. sequence is only used by MPSC queues.
+ */
+struct queue_cell {
+    std::atomic<size_t> sequence;
+    macac_telemetry_record_t record;
+};
+
+struct macac_packet_queue {
+    queue_cell* cells;
+    size_t mask;
+    int mode;                           // MACAC_QUEUE_*
+    
+    // Producer side
+    alignas(64) std::atomic<size_t> tail;
+    size_t cached_head;                 // SPSC: consumer index last seen
+    
+    // Consumer side
+    alignas(64) std::atomic<size_t> head;
+    size_t cached_tail;                 // SPSC: producer index last seen
+    
+    alignas(64) std::atomic<uint64_t> dropped;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static size_t round_up_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static int spsc_push(macac_packet_queue_t* q, const macac_telemetry_record_t* record) {
+    size_t tail = q->tail.load(std::memory_order_relaxed);
+    
+    if (tail - q->cached_head > q->mask) {
+        q->cached_head = q->head.load(std::memory_order_acquire);
+        if (tail - q->cached_head > q->mask) {
+            return -1;
+        }
+    }
+    
+    q->cells[tail & q->mask].record = *record;
+    q->tail.store(tail + 1, std::memory_order_release);
+    return 0;
+}
+
+static size_t spsc_drain(macac_packet_queue_t* q, macac_telemetry_record_t* out, size_t max) {
+    size_t head = q->head.load(std::memory_order_relaxed);
+    
+    if (q->cached_tail - head < max) {
+        q->cached_tail = q->tail.load(std::memory_order_acquire);
+    }
+    size_t n = q->cached_tail - head;
+    if (n > max) {
+        n = max;
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        out[i] = q->cells[(head + i) & q->mask].record;
+    }
+    
+    // One release store hands the whole run back to the producer
+    q->head.store(head + n, std::memory_order_release);
+    return n;
+}
+
+static int mpsc_push(macac_packet_queue_t* q, const macac_telemetry_record_t* record) {
+    size_t pos = q->tail.load(std::memory_order_relaxed);
+    queue_cell* cell;
+    
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (q->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = q->tail.load(std::memory_order_relaxed);
+        }
+    }
+    
+    cell->record = *record;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return 0;
+}
+
+/**
+ * Stops at the first claimed-but-unpublished cell, so records are always
+ * delivered in claim order.
+ */
+static size_t mpsc_drain(macac_packet_queue_t* q, macac_telemetry_record_t* out, size_t max) {
+    size_t head = q->head.load(std::memory_order_relaxed);
+    size_t n = 0;
+    
+    while (n < max) {
+        queue_cell* cell = &q->cells[(head + n) & q->mask];
+        if (cell->sequence.load(std::memory_order_acquire) != head + n + 1) {
+            break;
+        }
+        out[n] = cell->record;
+        cell->sequence.store(head + n + q->mask + 1, std::memory_order_release);
+        n++;
+    }
+    
+    q->head.store(head + n, std::memory_order_release);
+    return n;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+macac_packet_queue_t* macac_queue_create(size_t capacity, int mode) {
+    if (capacity == 0 || capacity > QUEUE_MAX_CAPACITY ||
+        (mode != MACAC_QUEUE_SPSC && mode != MACAC_QUEUE_MPSC)) {
+        return nullptr;
+    }
+    
+    macac_packet_queue_t* q = new (std::nothrow) macac_packet_queue_t();
+    if (!q) {
+        return nullptr;
+    }
+    
+    capacity = round_up_pow2(capacity);
+    q->cells = new (std::nothrow) queue_cell[capacity];
+    if (!q->cells) {
+        delete q;
+        return nullptr;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        q->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    q->mask = capacity - 1;
+    q->mode = mode;
+    q->tail.store(0, std::memory_order_relaxed);
+    q->head.store(0, std::memory_order_relaxed);
+    q->cached_head = 0;
+    q->cached_tail = 0;
+    q->dropped.store(0, std::memory_order_relaxed);
+    return q;
+}
+
+void macac_queue_destroy(macac_packet_queue_t* queue) {
+    if (queue) {
+        delete[] queue->cells;
+        delete queue;
+    }
+}
+
+int macac_queue_push(macac_packet_queue_t* queue, const macac_telemetry_record_t* record) {
+    if (!queue || !record) {
+        return -1;
+    }
+    
+    int rc = queue->mode == MACAC_QUEUE_SPSC ? spsc_push(queue, record)
+                                             : mpsc_push(queue, record);
+    if (rc != 0) {
+        queue->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return rc;
+}
+
+size_t macac_queue_drain(macac_packet_queue_t* queue, macac_telemetry_record_t* out, size_t max) {
+    if (!queue || !out || max == 0) {
+        return 0;
+    }
+    return queue->mode == MACAC_QUEUE_SPSC ? spsc_drain(queue, out, max)
+                                           : mpsc_drain(queue, out, max);
+}
+
+size_t macac_queue_size(macac_packet_queue_t* queue) {
+    if (!queue) {
+        return 0;
+    }
+    
+    // Head first: it never passes tail, so the difference cannot underflow
+    size_t head = queue->head.load(std::memory_order_acquire);
+    size_t tail = queue->tail.load(std::memory_order_acquire);
+    size_t size = tail - head;
+    return size > queue->mask + 1 ? queue->mask + 1 : size;
+}
+
+size_t macac_queue_capacity(macac_packet_queue_t* queue) {
+    return queue ? queue->mask + 1 : 0;
+}
+
+uint64_t macac_queue_dropped(macac_packet_queue_t* queue) {
+    return queue ? queue->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+} // extern "C"
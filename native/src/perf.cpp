@@ -0,0 +1,343 @@
+/*
+ * MacAC Native Library - Latency Instrumentation
+ * 
+ * Per-site latency histograms built on macac_rdtscp, cheap enough to leave
+ * on in production.
+ * 
+ * Each thread records into its own histograms, allocated on the first
+ * sample per site, so the hot path is a TSC read, a bucket index and a few
+ * relaxed single-writer stores: no lock, no atomic RMW, no shared cache
+ * line. Readers merge every live thread's histograms, plus the totals
+ * folded in by threads that have exited.
+ * 
+ * Buckets are log-linear (HDR-style) over TSC ticks: values below 32 get
+ * one bucket each, and every power of two above is split into 16 linear
+ * buckets, bounding the relative error of a percentile to 1/32.
+ * 
+ * While a hardware counter session runs (perf_counters.cpp), begin and end
+ * also read the thread's counter group for the same scope.
+ */
+
+#include "macac_native.h"
+#include "perf_counters.h"
+#include <cstring>
+#include <mutex>
+
+// Linear sub-buckets per power of two
+#define PERF_SUB_BITS 4
+#define PERF_SUB (1u << PERF_SUB_BITS)
+
+// Durations are clamped below 2^48 ticks (about a day at 3 GHz)
+#define PERF_MAX_BITS 48
+#define PERF_BUCKETS ((PERF_MAX_BITS - PERF_SUB_BITS + 1) * PERF_SUB)
+
+/**
+ * One site's counts. Written by a single thread with relaxed load/store
+ * pairs (plain moves on x86/ARM64), read concurrently by snapshots.
+ */
+struct perf_hist {
+    std::atomic<uint64_t> buckets[PERF_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+    
+    perf_hist() : count(0), sum(0), max(0) {
+        for (size_t b = 0; b < PERF_BUCKETS; b++) {
+            buckets[b].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * Histograms of one thread; linked into perf_threads while the thread lives.
+ */
+struct perf_thread {
+    std::atomic<perf_hist*> sites[MACAC_PERF_MAX_SITES];
+    perf_thread* prev;
+    perf_thread* next;
+    
+    perf_thread();
+    ~perf_thread();
+};
+
+// Site table: names are written once under perf_lock before the count is published
+static char perf_names[MACAC_PERF_MAX_SITES][MACAC_PERF_NAME_MAX];
+static std::atomic<int> perf_site_count{0};
+
+// Guards perf_threads, perf_retired and registration; never taken per sample
+static std::mutex perf_lock;
+static perf_thread* perf_threads = nullptr;
+static perf_hist perf_retired[MACAC_PERF_MAX_SITES];
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static inline unsigned bucket_of(uint64_t ticks) {
+    if (ticks >= (1ull << PERF_MAX_BITS)) {
+        ticks = (1ull << PERF_MAX_BITS) - 1;
+    }
+    if (ticks < 2 * PERF_SUB) {
+        return (unsigned)ticks;
+    }
+    unsigned msb = 63 - (unsigned)__builtin_clzll(ticks);
+    unsigned shift = msb - PERF_SUB_BITS;
+    return (shift + 1) * PERF_SUB + (unsigned)(ticks >> shift) - PERF_SUB;
+}
+
+/**
+ * Midpoint of a bucket in ticks.
+ */
+static inline double bucket_value(unsigned bucket) {
+    if (bucket < 2 * PERF_SUB) {
+        return (double)bucket;
+    }
+    unsigned shift = bucket / PERF_SUB - 1;
+    uint64_t low = (uint64_t)(bucket % PERF_SUB + PERF_SUB) << shift;
+    return (double)low + (double)((1ull << shift) - 1) / 2.0;
+}
+
+/**
+ * Add one histogram's counts into plain accumulators.
+ */
+static void merge_hist(const perf_hist* hist, uint64_t* buckets, uint64_t* count,
+                       uint64_t* sum, uint64_t* max) {
+    for (size_t b = 0; b < PERF_BUCKETS; b++) {
+        buckets[b] += hist->buckets[b].load(std::memory_order_relaxed);
+    }
+    *count += hist->count.load(std::memory_order_relaxed);
+    *sum += hist->sum.load(std::memory_order_relaxed);
+    uint64_t hist_max = hist->max.load(std::memory_order_relaxed);
+    if (hist_max > *max) {
+        *max = hist_max;
+    }
+}
+
+static void clear_hist(perf_hist* hist) {
+    for (size_t b = 0; b < PERF_BUCKETS; b++) {
+        hist->buckets[b].store(0, std::memory_order_relaxed);
+    }
+    hist->count.store(0, std::memory_order_relaxed);
+    hist->sum.store(0, std::memory_order_relaxed);
+    hist->max.store(0, std::memory_order_relaxed);
+}
+
+perf_thread::perf_thread() : prev(nullptr) {
+    for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+        sites[s].store(nullptr, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> guard(perf_lock);
+    next = perf_threads;
+    if (next) {
+        next->prev = this;
+    }
+    perf_threads = this;
+}
+
+/**
+ * Thread exit: fold this thread's counts into perf_retired so snapshots
+ * keep them, then unlink and free.
+ */
+perf_thread::~perf_thread() {
+    std::lock_guard<std::mutex> guard(perf_lock);
+    for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+        perf_hist* hist = sites[s].load(std::memory_order_relaxed);
+        if (!hist) {
+            continue;
+        }
+        
+        perf_hist* retired = &perf_retired[s];
+        for (size_t b = 0; b < PERF_BUCKETS; b++) {
+            uint64_t n = hist->buckets[b].load(std::memory_order_relaxed);
+            if (n) {
+                retired->buckets[b].fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+        retired->count.fetch_add(hist->count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        retired->sum.fetch_add(hist->sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint64_t hist_max = hist->max.load(std::memory_order_relaxed);
+        if (hist_max > retired->max.load(std::memory_order_relaxed)) {
+            retired->max.store(hist_max, std::memory_order_relaxed);
+        }
+        delete hist;
+    }
+    
+    if (prev) {
+        prev->next = next;
+    } else {
+        perf_threads = next;
+    }
+    if (next) {
+        next->prev = prev;
+    }
+}
+
+static inline perf_thread* this_thread_perf(void) {
+    static thread_local perf_thread state;
+    return &state;
+}
+
+/**
+ * First sample for a site on this thread. The release store pairs with
+ * the snapshot's acquire load, so readers never see an unconstructed histogram.
+ */
+static perf_hist* attach_hist(perf_thread* state, int site) {
+    perf_hist* hist = new perf_hist();
+    state->sites[site].store(hist, std::memory_order_release);
+    return hist;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+int macac_perf_register(const char* name) {
+    if (!name || !name[0]) {
+        return MACAC_PERF_NO_SITE;
+    }
+    
+    char key[MACAC_PERF_NAME_MAX];
+    strncpy(key, name, MACAC_PERF_NAME_MAX - 1);
+    key[MACAC_PERF_NAME_MAX - 1] = '\0';
+    
+    std::lock_guard<std::mutex> guard(perf_lock);
+    int count = perf_site_count.load(std::memory_order_relaxed);
+    for (int s = 0; s < count; s++) {
+        if (strcmp(perf_names[s], key) == 0) {
+            return s;
+        }
+    }
+    if (count >= MACAC_PERF_MAX_SITES) {
+        return MACAC_PERF_NO_SITE;
+    }
+    
+    memcpy(perf_names[count], key, MACAC_PERF_NAME_MAX);
+    perf_site_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+int macac_perf_site_count(void) {
+    return perf_site_count.load(std::memory_order_acquire);
+}
+
+const char* macac_perf_site_name(int site) {
+    if (site < 0 || site >= perf_site_count.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return perf_names[site];
+}
+
+uint64_t macac_perf_begin(void) {
+    if (pmu_profiling()) {
+        return pmu_scope_begin();
+    }
+    return macac_rdtscp();
+}
+
+void macac_perf_end(int site, uint64_t begin) {
+    uint64_t now = macac_rdtscp();
+    if (pmu_profiling()) {
+        pmu_scope_end(site, begin);
+    }
+    
+    // Another core's TSC may trail the one that took begin
+    macac_perf_record(site, now > begin ? now - begin : 0);
+}
+
+void macac_perf_record(int site, uint64_t ticks) {
+    if ((unsigned)site >= MACAC_PERF_MAX_SITES) {
+        return;
+    }
+    
+    perf_thread* state = this_thread_perf();
+    perf_hist* hist = state->sites[site].load(std::memory_order_relaxed);
+    if (!hist) {
+        hist = attach_hist(state, site);
+    }
+    
+    // Single writer: load+store instead of a locked RMW
+    std::atomic<uint64_t>& bucket = hist->buckets[bucket_of(ticks)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    hist->count.store(hist->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    hist->sum.store(hist->sum.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    if (ticks > hist->max.load(std::memory_order_relaxed)) {
+        hist->max.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+int macac_perf_snapshot(int site, macac_perf_snapshot_t* out) {
+    if (!out || site < 0 || site >= perf_site_count.load(std::memory_order_acquire)) {
+        return -1;
+    }
+    
+    uint64_t buckets[PERF_BUCKETS] = {};
+    uint64_t count = 0, sum = 0, max = 0;
+    {
+        std::lock_guard<std::mutex> guard(perf_lock);
+        merge_hist(&perf_retired[site], buckets, &count, &sum, &max);
+        for (perf_thread* t = perf_threads; t; t = t->next) {
+            perf_hist* hist = t->sites[site].load(std::memory_order_acquire);
+            if (hist) {
+                merge_hist(hist, buckets, &count, &sum, &max);
+            }
+        }
+    }
+    
+    memset(out, 0, sizeof(macac_perf_snapshot_t));
+    
+    // Bucket totals and count are read at slightly different times
+    uint64_t total = 0;
+    for (size_t b = 0; b < PERF_BUCKETS; b++) {
+        total += buckets[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    
+    double nanos_per_tick = macac_calibrate_tsc();
+    const double quantiles[3] = { 0.5, 0.99, 0.999 };
+    double* targets[3] = { &out->p50_ns, &out->p99_ns, &out->p999_ns };
+    
+    // Rank ceil(q * total), clamped to the exact max
+    uint64_t seen = 0;
+    size_t b = 0;
+    for (int q = 0; q < 3; q++) {
+        uint64_t rank = (uint64_t)(quantiles[q] * (double)total);
+        if ((double)rank < quantiles[q] * (double)total) {
+            rank++;
+        }
+        if (rank == 0) {
+            rank = 1;
+        }
+        while (b < PERF_BUCKETS && seen + buckets[b] < rank) {
+            seen += buckets[b];
+            b++;
+        }
+        double ticks = b < PERF_BUCKETS ? bucket_value((unsigned)b) : (double)max;
+        *targets[q] = (ticks < (double)max ? ticks : (double)max) * nanos_per_tick;
+    }
+    
+    out->count = count;
+    out->mean_ns = count ? (double)sum / (double)count * nanos_per_tick : 0.0;
+    out->max_ns = (double)max * nanos_per_tick;
+    return 0;
+}
+
+void macac_perf_reset(void) {
+    std::lock_guard<std::mutex> guard(perf_lock);
+    for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+        clear_hist(&perf_retired[s]);
+    }
+    for (perf_thread* t = perf_threads; t; t = t->next) {
+        for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+            perf_hist* hist = t->sites[s].load(std::memory_order_acquire);
+            if (hist) {
+                clear_hist(hist);
+            }
+        }
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,421 @@
+/*
+ * MacAC Native Library - Hardware Counter Profiling
+ * 
+ * Optional per-site PMU counters on top of the latency instrumentation,
+ * for telling a cache-miss regression from a mispredict or a frequency
+ * drop without attaching an external profiler.
+ * 
+ * While a session runs, each thread that opens a timed scope gets one
+ * perf_event group (user space only, pid = self, any CPU), led by the
+ * first event the kernel accepts. Scope begin and end each read the whole
+ * group with one read(2) (PERF_FORMAT_GROUP), so every delta in a scope
+ * covers the same instructions. Open scopes sit on a small per-thread
+ * stack keyed by their begin timestamp: nesting works, and an end whose
+ * begin ran outside the session is ignored.
+ * 
+ * Totals live in per-thread, per-site accumulators (single writer, relaxed
+ * stores, as in perf.cpp); readers merge them under pmu_lock. Scopes the
+ * kernel multiplexed out for part of their run are counted as partial
+ * rather than scaled.
+ */
+
+#include "macac_native.h"
+#include "perf_counters.h"
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Open scopes tracked per thread; deeper scopes are not counted
+#define PMU_MAX_DEPTH 16
+
+std::atomic<int> pmu_session_active{0};
+
+/**
+ * One site's totals on one thread. Written by the owning thread only.
+ */
+struct pmu_site {
+    std::atomic<uint64_t> scopes;
+    std::atomic<uint64_t> partial;
+    std::atomic<uint64_t> values[MACAC_PMU_EVENTS];
+    
+    pmu_site() : scopes(0), partial(0) {
+        for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+            values[e].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+static inline void pmu_bump(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+static void pmu_clear(pmu_site* site) {
+    site->scopes.store(0, std::memory_order_relaxed);
+    site->partial.store(0, std::memory_order_relaxed);
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        site->values[e].store(0, std::memory_order_relaxed);
+    }
+}
+
+static void pmu_merge(const pmu_site* site, macac_pmu_snapshot_t* out) {
+    out->scopes += site->scopes.load(std::memory_order_relaxed);
+    out->partial += site->partial.load(std::memory_order_relaxed);
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        out->values[e] += site->values[e].load(std::memory_order_relaxed);
+    }
+}
+
+// Guards pmu_threads, pmu_retired and session changes; never taken per scope
+static std::mutex pmu_lock;
+static pmu_site pmu_retired[MACAC_PERF_MAX_SITES];
+static uint32_t pmu_retired_events = 0;
+
+// Session number; a thread's frames from an older session are dropped
+static std::atomic<uint32_t> pmu_generation{0};
+
+#ifdef __linux__
+
+/**
+ * Group reading at one scope boundary, indexed by MACAC_PMU_*.
+ */
+struct pmu_frame {
+    uint64_t begin;
+    uint64_t enabled;
+    uint64_t running;
+    uint64_t values[MACAC_PMU_EVENTS];
+};
+
+/**
+ * Counter group of one thread; linked into pmu_threads once opened.
+ */
+struct pmu_thread {
+    int fds[MACAC_PMU_EVENTS];
+    int leader;
+    uint32_t events;                    // MACAC_PMU_* bits opened
+    uint32_t members;                   // Values in one group read
+    int slot[MACAC_PMU_EVENTS];         // Position in the group read, -1 if not opened
+    uint32_t tried;                     // Session of the last open attempt
+    uint32_t generation;                // Session the frames belong to
+    int depth;
+    pmu_site* sites;
+    pmu_thread* prev;
+    pmu_thread* next;
+    pmu_frame frames[PMU_MAX_DEPTH];
+    
+    pmu_thread();
+    ~pmu_thread();
+};
+
+static pmu_thread* pmu_threads = nullptr;
+
+struct pmu_event_spec {
+    uint32_t type;
+    uint64_t config;
+};
+
+// Indexed by MACAC_PMU_*
+static const pmu_event_spec pmu_specs[MACAC_PMU_EVENTS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static int pmu_open(const pmu_event_spec* spec, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec->type;
+    attr.config = spec->config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    
+    unsigned long flags = 0;
+#ifdef PERF_FLAG_FD_CLOEXEC
+    flags |= PERF_FLAG_FD_CLOEXEC;
+#endif
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, flags);
+}
+
+static void pmu_close_group(pmu_thread* state) {
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        if (state->fds[e] >= 0) {
+            close(state->fds[e]);
+            state->fds[e] = -1;
+        }
+        state->slot[e] = -1;
+    }
+    state->leader = -1;
+    state->events = 0;
+    state->members = 0;
+}
+
+pmu_thread::pmu_thread()
+    : leader(-1), events(0), members(0), tried(0), generation(0), depth(0),
+      sites(nullptr), prev(nullptr), next(nullptr) {
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        fds[e] = -1;
+        slot[e] = -1;
+    }
+}
+
+/**
+ * Thread exit: fold this thread's totals into pmu_retired so snapshots
+ * keep them, then unlink and close the group.
+ */
+pmu_thread::~pmu_thread() {
+    if (leader < 0) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> guard(pmu_lock);
+    for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+        pmu_site* retired = &pmu_retired[s];
+        pmu_bump(retired->scopes, sites[s].scopes.load(std::memory_order_relaxed));
+        pmu_bump(retired->partial, sites[s].partial.load(std::memory_order_relaxed));
+        for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+            pmu_bump(retired->values[e], sites[s].values[e].load(std::memory_order_relaxed));
+        }
+    }
+    pmu_retired_events |= events;
+    
+    if (prev) {
+        prev->next = next;
+    } else {
+        pmu_threads = next;
+    }
+    if (next) {
+        next->prev = prev;
+    }
+    pmu_close_group(this);
+    delete[] sites;
+}
+
+static inline pmu_thread* this_thread_pmu(void) {
+    static thread_local pmu_thread state;
+    return &state;
+}
+
+/**
+ * Open the calling thread's group and link it (pmu_lock held). Events the
+ * kernel or CPU rejects are left out; the first accepted one leads.
+ */
+static void pmu_attach_locked(pmu_thread* state, uint32_t generation) {
+    state->tried = generation;
+    if (!pmu_session_active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        int fd = pmu_open(&pmu_specs[e], state->leader);
+        if (fd < 0) {
+            continue;
+        }
+        if (state->leader < 0) {
+            state->leader = fd;
+        }
+        state->fds[e] = fd;
+        state->slot[e] = (int)state->members++;
+        state->events |= 1u << e;
+    }
+    if (state->leader < 0) {
+        return;
+    }
+    
+    state->sites = new (std::nothrow) pmu_site[MACAC_PERF_MAX_SITES];
+    if (!state->sites) {
+        pmu_close_group(state);
+        return;
+    }
+    
+    state->next = pmu_threads;
+    if (state->next) {
+        state->next->prev = state;
+    }
+    pmu_threads = state;
+}
+
+/**
+ * Read the whole group into a frame; false if the read came back short.
+ */
+static bool pmu_read(const pmu_thread* state, pmu_frame* frame) {
+    uint64_t buf[3 + MACAC_PMU_EVENTS];
+    ssize_t expect = (ssize_t)((3 + state->members) * sizeof(uint64_t));
+    if (read(state->leader, buf, sizeof(buf)) != expect) {
+        return false;
+    }
+    
+    // nr, time_enabled, time_running, then one value per member
+    frame->enabled = buf[1];
+    frame->running = buf[2];
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        frame->values[e] = state->slot[e] >= 0 ? buf[3 + state->slot[e]] : 0;
+    }
+    return true;
+}
+
+// ============================================================================
+// Scope Hooks (perf.cpp)
+// ============================================================================
+
+uint64_t pmu_scope_begin(void) {
+    pmu_thread* state = this_thread_pmu();
+    uint32_t generation = pmu_generation.load(std::memory_order_acquire);
+    if (state->generation != generation) {
+        state->generation = generation;
+        state->depth = 0;
+    }
+    if (state->leader < 0 && state->tried != generation) {
+        std::lock_guard<std::mutex> guard(pmu_lock);
+        pmu_attach_locked(state, generation);
+    }
+    if (state->leader < 0 || state->depth >= PMU_MAX_DEPTH) {
+        return macac_rdtscp();
+    }
+    
+    // Timestamp after the read, so the scope's latency leaves it out
+    pmu_frame* frame = &state->frames[state->depth];
+    if (!pmu_read(state, frame)) {
+        return macac_rdtscp();
+    }
+    frame->begin = macac_rdtscp();
+    state->depth++;
+    return frame->begin;
+}
+
+void pmu_scope_end(int site, uint64_t begin) {
+    pmu_thread* state = this_thread_pmu();
+    int depth = state->depth;
+    while (depth > 0 && state->frames[depth - 1].begin != begin) {
+        depth--;
+    }
+    if (depth == 0) {
+        return;
+    }
+    
+    // Frames above the match are scopes that never ended
+    const pmu_frame* opened = &state->frames[depth - 1];
+    state->depth = depth - 1;
+    
+    pmu_frame now;
+    if ((unsigned)site >= MACAC_PERF_MAX_SITES || !pmu_read(state, &now)) {
+        return;
+    }
+    
+    pmu_site* totals = &state->sites[site];
+    if (now.enabled - opened->enabled != now.running - opened->running) {
+        pmu_bump(totals->partial, 1);
+        return;
+    }
+    pmu_bump(totals->scopes, 1);
+    for (int e = 0; e < MACAC_PMU_EVENTS; e++) {
+        if (state->events & (1u << e)) {
+            pmu_bump(totals->values[e], now.values[e] - opened->values[e]);
+        }
+    }
+}
+
+#else // !__linux__
+
+uint64_t pmu_scope_begin(void) {
+    return macac_rdtscp();
+}
+
+void pmu_scope_end(int site, uint64_t begin) {
+    (void)site;
+    (void)begin;
+}
+
+#endif // __linux__
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+uint32_t macac_pmu_start(void) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> guard(pmu_lock);
+    for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+        pmu_clear(&pmu_retired[s]);
+    }
+    pmu_retired_events = 0;
+    for (pmu_thread* t = pmu_threads; t; t = t->next) {
+        for (int s = 0; s < MACAC_PERF_MAX_SITES; s++) {
+            pmu_clear(&t->sites[s]);
+        }
+    }
+    
+    uint32_t generation = pmu_generation.load(std::memory_order_relaxed) + 1;
+    pmu_generation.store(generation, std::memory_order_release);
+    pmu_session_active.store(1, std::memory_order_relaxed);
+    
+    // Probe on the calling thread: if it cannot count, no thread can
+    pmu_thread* self = this_thread_pmu();
+    if (self->leader < 0) {
+        pmu_attach_locked(self, generation);
+    }
+    if (self->leader < 0) {
+        pmu_session_active.store(0, std::memory_order_relaxed);
+        return 0;
+    }
+    
+    for (pmu_thread* t = pmu_threads; t; t = t->next) {
+        ioctl(t->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    return self->events;
+#else
+    return 0;
+#endif
+}
+
+void macac_pmu_stop(void) {
+    std::lock_guard<std::mutex> guard(pmu_lock);
+    pmu_session_active.store(0, std::memory_order_relaxed);
+#ifdef __linux__
+    for (pmu_thread* t = pmu_threads; t; t = t->next) {
+        ioctl(t->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+int macac_pmu_active(void) {
+    return pmu_profiling() ? 1 : 0;
+}
+
+int macac_pmu_snapshot(int site, macac_pmu_snapshot_t* out) {
+    if (!out || site < 0 || site >= macac_perf_site_count()) {
+        return -1;
+    }
+    
+    memset(out, 0, sizeof(macac_pmu_snapshot_t));
+    std::lock_guard<std::mutex> guard(pmu_lock);
+    pmu_merge(&pmu_retired[site], out);
+    out->events = pmu_retired_events;
+#ifdef __linux__
+    for (pmu_thread* t = pmu_threads; t; t = t->next) {
+        pmu_merge(&t->sites[site], out);
+        out->events |= t->events;
+    }
+#endif
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,33 @@
+/*
+ * MacAC Native Library - Hardware Counter Hooks (internal)
+ * 
+ * Called by the latency instrumentation (perf.cpp) around every timed
+ * scope while a profiling session runs. Nothing here is exported.
+ */
+
+#ifndef MACAC_PERF_COUNTERS_H
+#define MACAC_PERF_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+
+// Nonzero while macac_pmu_start's session runs; the only cost when idle
+extern std::atomic<int> pmu_session_active;
+
+static inline bool pmu_profiling(void) {
+    return pmu_session_active.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+ * Read the calling thread's counters for a scope opening now; returns the
+ * scope's begin timestamp, taken after the read.
+ */
+uint64_t pmu_scope_begin(void);
+
+/**
+ * Read the counters again and add the deltas since the scope that began
+ * at begin to a site. Scopes this thread did not open are ignored.
+ */
+void pmu_scope_end(int site, uint64_t begin);
+
+#endif // MACAC_PERF_COUNTERS_H
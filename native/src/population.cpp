@@ -0,0 +1,571 @@
+/*
+ * MacAC Native Library - Population Baselines
+ * 
+ * Server-wide distributions of per-packet features, so a check can ask
+ * where a player stands among everyone online ("timing skew above the
+ * population p99.9") rather than against a fixed constant.
+ * 
+ * Each metric is summarised by merging t-digests (Dunning): sorted
+ * centroids (mean, weight) whose sizes are bounded by a logistic scale
+ * function, so centroids shrink to single samples at both tails and the
+ * rank error at quantile q stays a small fraction of min(q, 1 - q). That
+ * is where population thresholds live; a rank-uniform sketch (KLL) would
+ * spend its accuracy on the median. A digest holds fewer than compression
+ * centroids.
+ * 
+ * Layout:
+ *   shards    POPULATION_SHARDS independently locked sets of digests; a
+ *             thread always adds to the shard its thread-local slot picks,
+ *             so each analysis worker has its own and adds never contend
+ *   digests   current and previous generation per (shard, metric); refresh
+ *             swaps them once per window, so baselines follow the live
+ *             population and cover the last one to two windows
+ *   buffer    samples are appended unsorted and folded into the current
+ *             digest 5 * compression at a time (one sort, one merge pass)
+ *   snapshot  refresh concatenates every shard's centroids per metric and
+ *             sorts them by mean. No recompression is needed: the merged
+ *             list is at most POPULATION_SHARDS * 2 * compression
+ *             centroids, and queries binary-search it
+ * 
+ *   add       O(1) amortised (O(log compression) per sample for the sort)
+ *   refresh   O(S log S), S = centroids over all shards
+ *   quantile  O(log S)
+ *   cdf       O(log S)
+ * 
+ * Two snapshot buffers alternate. Readers lock their own shard around a
+ * query, and refresh publishes a snapshot by storing it into every shard
+ * under that shard's lock, so once the last store is done no reader can
+ * still be inside the old buffer and the next refresh may overwrite it.
+ * Readers never touch a lock other threads use, except during refresh.
+ * All memory is allocated at create.
+ */
+
+#include "macac_native.h"
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+// Independently locked shards (power of two); threads beyond this share
+#define POPULATION_SHARDS 8
+
+// Compression bounds
+#define POPULATION_MIN_COMPRESSION 20
+#define POPULATION_MAX_COMPRESSION 1000
+
+// Unsorted samples per (shard, metric), in multiples of the compression
+#define POPULATION_BUFFER_FACTOR 5
+
+/**
+ * One digest: centroids sorted by mean, buffered samples excluded.
+ */
+struct population_digest {
+    double* means;
+    double* weights;
+    uint32_t count;
+    double total;
+    double min;
+    double max;
+};
+
+/**
+ * One metric of a published snapshot.
+ */
+struct population_view {
+    double* means;                  // Centroid means, ascending
+    double* centers;                // Weight below each centroid's midpoint
+    size_t count;
+    double total;
+    double min;
+    double max;
+};
+
+struct population_snapshot {
+    population_view* views;         // [metric]
+};
+
+struct alignas(64) population_shard {
+    std::mutex lock;
+    population_digest* current;     // [metric]
+    population_digest* previous;    // [metric]
+    double* buffers;                // [metric * buffer_cap] unsorted samples
+    uint32_t* buffered;             // [metric]
+    double* merge_means;            // Output of a fold, swapped into the digest
+    double* merge_weights;
+    const population_snapshot* snapshot;
+};
+
+struct population_centroid {
+    double mean;
+    double weight;
+};
+
+struct macac_population {
+    size_t metrics;
+    double compression;
+    uint32_t centroid_cap;
+    uint32_t buffer_cap;
+    int64_t window_ms;
+    int64_t rotated_ms;
+    
+    population_shard shards[POPULATION_SHARDS];
+    
+    std::mutex refresh_lock;        // Serialises refresh; guards everything below
+    population_snapshot snapshots[2];
+    int published;                  // Index of the snapshot the shards point at
+    population_centroid* build;     // [POPULATION_SHARDS * 2 * centroid_cap]
+    
+    // Backing storage
+    double* digest_storage;
+    population_digest* digest_headers;
+    double* view_storage;
+    population_view* view_headers;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static std::atomic<uint32_t> population_next_slot{0};
+
+/**
+ * Shard of the calling thread. Slots are handed out in thread start
+ * order, so the first POPULATION_SHARDS threads to touch any population
+ * (normally the analysis workers) each get a shard to themselves.
+ */
+static inline uint32_t population_slot(void) {
+    static thread_local uint32_t slot =
+        population_next_slot.fetch_add(1, std::memory_order_relaxed) & (POPULATION_SHARDS - 1);
+    return slot;
+}
+
+static inline int64_t population_now_ms(void) {
+    return macac_nanotime() / 1000000;
+}
+
+static void digest_reset(population_digest* d) {
+    d->count = 0;
+    d->total = 0.0;
+    d->min = INFINITY;
+    d->max = -INFINITY;
+}
+
+/**
+ * Logistic scale function k(q) = c * log(q / (1 - q)), with the
+ * normaliser c = compression / (4 log(n / compression) + 24), and its
+ * inverse. Adjacent centroids may only merge while they span at most one
+ * unit of k, so centroid weight is proportional to q(1 - q) and the first
+ * and last few samples stay single. q = 0 maps to -inf: the first
+ * centroid is always a single sample.
+ */
+static inline double scale_norm(double compression, double total) {
+    return compression / (4.0 * std::log(std::max(total / compression, 1.0)) + 24.0);
+}
+
+static inline double scale_k(double q, double norm) {
+    return norm * std::log(q / (1.0 - q));
+}
+
+static inline double scale_q(double k, double norm) {
+    return 1.0 / (1.0 + std::exp(-k / norm));
+}
+
+/**
+ * Append a centroid to a fold's output. The scale bound guarantees room;
+ * merging into the last centroid only guards against rounding.
+ */
+static inline uint32_t emit(double* means, double* weights, uint32_t out, uint32_t cap,
+                            double mean, double weight) {
+    if (out < cap) {
+        means[out] = mean;
+        weights[out] = weight;
+        return out + 1;
+    }
+    double w = weights[out - 1] + weight;
+    means[out - 1] += (mean - means[out - 1]) * weight / w;
+    weights[out - 1] = w;
+    return out;
+}
+
+/**
+ * Fold a shard's buffered samples for one metric into its current digest:
+ * sort the buffer, then one merge pass over buffer and centroids that
+ * greedily combines neighbours while the scale function allows it.
+ */
+static void digest_fold(macac_population_t* p, population_shard* shard, size_t metric) {
+    uint32_t n = shard->buffered[metric];
+    if (n == 0) {
+        return;
+    }
+    double* buf = shard->buffers + metric * p->buffer_cap;
+    population_digest* d = &shard->current[metric];
+    std::sort(buf, buf + n);
+    
+    double total = d->total + n;
+    double* out_means = shard->merge_means;
+    double* out_weights = shard->merge_weights;
+    uint32_t out = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    
+    // First item overall starts the current centroid
+    double cur_mean;
+    double cur_weight;
+    if (i < d->count && d->means[i] <= buf[j]) {
+        cur_mean = d->means[i];
+        cur_weight = d->weights[i];
+        i++;
+    } else {
+        cur_mean = buf[j++];
+        cur_weight = 1.0;
+    }
+    
+    double norm = scale_norm(p->compression, total);
+    double so_far = 0.0;
+    double limit = total * scale_q(scale_k(0.0, norm) + 1.0, norm);
+    
+    while (i < d->count || j < n) {
+        double mean;
+        double weight;
+        if (j >= n || (i < d->count && d->means[i] <= buf[j])) {
+            mean = d->means[i];
+            weight = d->weights[i];
+            i++;
+        } else {
+            mean = buf[j++];
+            weight = 1.0;
+        }
+        
+        if (so_far + cur_weight + weight <= limit) {
+            cur_weight += weight;
+            cur_mean += (mean - cur_mean) * weight / cur_weight;
+            continue;
+        }
+        
+        out = emit(out_means, out_weights, out, p->centroid_cap, cur_mean, cur_weight);
+        so_far += cur_weight;
+        limit = total * scale_q(scale_k(so_far / total, norm) + 1.0, norm);
+        cur_mean = mean;
+        cur_weight = weight;
+    }
+    out = emit(out_means, out_weights, out, p->centroid_cap, cur_mean, cur_weight);
+    
+    d->min = std::min(d->min, buf[0]);
+    d->max = std::max(d->max, buf[n - 1]);
+    shard->merge_means = d->means;
+    shard->merge_weights = d->weights;
+    d->means = out_means;
+    d->weights = out_weights;
+    d->count = out;
+    d->total = total;
+    shard->buffered[metric] = 0;
+}
+
+static inline void shard_add(macac_population_t* p, population_shard* shard, size_t metric, double value) {
+    uint32_t n = shard->buffered[metric];
+    shard->buffers[metric * p->buffer_cap + n] = value;
+    shard->buffered[metric] = n + 1;
+    if (n + 1 == p->buffer_cap) {
+        digest_fold(p, shard, metric);
+    }
+}
+
+/**
+ * Append one digest's centroids to the build list.
+ */
+static size_t gather(const population_digest* d, population_centroid* build, size_t n,
+                     double* min, double* max) {
+    for (uint32_t i = 0; i < d->count; i++) {
+        build[n].mean = d->means[i];
+        build[n].weight = d->weights[i];
+        n++;
+    }
+    if (d->count > 0) {
+        *min = std::min(*min, d->min);
+        *max = std::max(*max, d->max);
+    }
+    return n;
+}
+
+static inline const population_view* shard_view(const population_shard* shard, size_t metric) {
+    return &shard->snapshot->views[metric];
+}
+
+static void population_free(macac_population_t* p) {
+    delete[] p->digest_storage;
+    delete[] p->digest_headers;
+    delete[] p->view_storage;
+    delete[] p->view_headers;
+    delete[] p->build;
+    for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+        delete[] p->shards[s].buffers;
+        delete[] p->shards[s].buffered;
+    }
+    delete p;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+macac_population_t* macac_population_create(size_t metrics, uint32_t compression, int64_t window_ms) {
+    if (metrics == 0 || metrics > MACAC_POPULATION_MAX_METRICS) {
+        return nullptr;
+    }
+    if (compression == 0) {
+        compression = MACAC_POPULATION_DEFAULT_COMPRESSION;
+    }
+    compression = std::min<uint32_t>(POPULATION_MAX_COMPRESSION,
+                                     std::max<uint32_t>(POPULATION_MIN_COMPRESSION, compression));
+    
+    macac_population_t* p = new (std::nothrow) macac_population_t();
+    if (!p) {
+        return nullptr;
+    }
+    
+    p->metrics = metrics;
+    p->compression = compression;
+    p->centroid_cap = compression + 8;
+    p->buffer_cap = compression * POPULATION_BUFFER_FACTOR;
+    p->window_ms = window_ms > 0 ? window_ms : 0;
+    p->rotated_ms = population_now_ms();
+    p->published = 0;
+    
+    // Per shard: current and previous digest per metric plus the fold output
+    size_t cap = p->centroid_cap;
+    size_t digests = POPULATION_SHARDS * 2 * metrics;
+    size_t stride = POPULATION_SHARDS * 2 * cap;
+    p->digest_storage = new (std::nothrow) double[(digests + POPULATION_SHARDS) * 2 * cap];
+    p->digest_headers = new (std::nothrow) population_digest[digests];
+    p->view_storage = new (std::nothrow) double[2 * metrics * 2 * stride];
+    p->view_headers = new (std::nothrow) population_view[2 * metrics]();
+    p->build = new (std::nothrow) population_centroid[stride];
+    for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+        p->shards[s].buffers = new (std::nothrow) double[metrics * p->buffer_cap];
+        p->shards[s].buffered = new (std::nothrow) uint32_t[metrics]();
+        if (!p->shards[s].buffers || !p->shards[s].buffered) {
+            population_free(p);
+            return nullptr;
+        }
+    }
+    if (!p->digest_storage || !p->digest_headers || !p->view_storage || !p->view_headers || !p->build) {
+        population_free(p);
+        return nullptr;
+    }
+    
+    double* next = p->digest_storage;
+    for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+        population_shard* shard = &p->shards[s];
+        shard->current = p->digest_headers + (2 * s) * metrics;
+        shard->previous = p->digest_headers + (2 * s + 1) * metrics;
+        for (size_t m = 0; m < 2 * metrics; m++) {
+            population_digest* d = &shard->current[m];
+            d->means = next;
+            d->weights = next + cap;
+            next += 2 * cap;
+            digest_reset(d);
+        }
+        shard->merge_means = next;
+        shard->merge_weights = next + cap;
+        next += 2 * cap;
+    }
+    
+    double* view_next = p->view_storage;
+    for (int b = 0; b < 2; b++) {
+        p->snapshots[b].views = p->view_headers + b * metrics;
+        for (size_t m = 0; m < metrics; m++) {
+            population_view* v = &p->snapshots[b].views[m];
+            v->means = view_next;
+            v->centers = view_next + stride;
+            view_next += 2 * stride;
+            v->count = 0;
+            v->total = 0.0;
+            v->min = NAN;
+            v->max = NAN;
+        }
+    }
+    for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+        p->shards[s].snapshot = &p->snapshots[0];
+    }
+    
+    return p;
+}
+
+void macac_population_destroy(macac_population_t* population) {
+    if (!population) {
+        return;
+    }
+    population_free(population);
+}
+
+void macac_population_add(macac_population_t* population, size_t metric, double value) {
+    if (!population || metric >= population->metrics || !std::isfinite(value)) {
+        return;
+    }
+    population_shard* shard = &population->shards[population_slot()];
+    std::lock_guard<std::mutex> guard(shard->lock);
+    shard_add(population, shard, metric, value);
+}
+
+void macac_population_add_row(macac_population_t* population, const double* values) {
+    if (!population || !values) {
+        return;
+    }
+    population_shard* shard = &population->shards[population_slot()];
+    std::lock_guard<std::mutex> guard(shard->lock);
+    for (size_t m = 0; m < population->metrics; m++) {
+        if (std::isfinite(values[m])) {
+            shard_add(population, shard, m, values[m]);
+        }
+    }
+}
+
+void macac_population_refresh(macac_population_t* population) {
+    if (!population) {
+        return;
+    }
+    macac_population_t* p = population;
+    std::lock_guard<std::mutex> refresh(p->refresh_lock);
+    
+    int64_t now = population_now_ms();
+    bool rotate = p->window_ms > 0 && now - p->rotated_ms >= p->window_ms;
+    if (rotate) {
+        p->rotated_ms = now;
+    }
+    
+    int target = 1 - p->published;
+    population_snapshot* snap = &p->snapshots[target];
+    
+    for (size_t m = 0; m < p->metrics; m++) {
+        size_t n = 0;
+        double min = INFINITY;
+        double max = -INFINITY;
+        
+        for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+            population_shard* shard = &p->shards[s];
+            std::lock_guard<std::mutex> guard(shard->lock);
+            digest_fold(p, shard, m);
+            if (rotate) {
+                std::swap(shard->current[m], shard->previous[m]);
+                digest_reset(&shard->current[m]);
+            }
+            n = gather(&shard->current[m], p->build, n, &min, &max);
+            n = gather(&shard->previous[m], p->build, n, &min, &max);
+        }
+        
+        std::sort(p->build, p->build + n,
+                  [](const population_centroid& a, const population_centroid& b) { return a.mean < b.mean; });
+        
+        population_view* v = &snap->views[m];
+        double below = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            v->means[i] = p->build[i].mean;
+            v->centers[i] = below + p->build[i].weight / 2.0;
+            below += p->build[i].weight;
+        }
+        v->count = n;
+        v->total = below;
+        v->min = n > 0 ? min : NAN;
+        v->max = n > 0 ? max : NAN;
+    }
+    
+    // Once every shard has switched, no reader is left in the old buffer
+    for (size_t s = 0; s < POPULATION_SHARDS; s++) {
+        std::lock_guard<std::mutex> guard(p->shards[s].lock);
+        p->shards[s].snapshot = snap;
+    }
+    p->published = target;
+}
+
+double macac_population_quantile(macac_population_t* population, size_t metric, double q) {
+    if (!population || metric >= population->metrics || std::isnan(q)) {
+        return NAN;
+    }
+    population_shard* shard = &population->shards[population_slot()];
+    std::lock_guard<std::mutex> guard(shard->lock);
+    const population_view* v = shard_view(shard, metric);
+    size_t n = v->count;
+    if (n == 0) {
+        return NAN;
+    }
+    if (q <= 0.0) {
+        return v->min;
+    }
+    if (q >= 1.0) {
+        return v->max;
+    }
+    
+    // Interpolate between centroid midpoints; the extremes anchor the ends
+    double t = q * v->total;
+    if (t <= v->centers[0]) {
+        return v->min + (v->means[0] - v->min) * (t / v->centers[0]);
+    }
+    if (t >= v->centers[n - 1]) {
+        double span = v->total - v->centers[n - 1];
+        return span > 0.0
+            ? v->means[n - 1] + (v->max - v->means[n - 1]) * ((t - v->centers[n - 1]) / span)
+            : v->max;
+    }
+    size_t i = (size_t)(std::upper_bound(v->centers, v->centers + n, t) - v->centers) - 1;
+    double frac = (t - v->centers[i]) / (v->centers[i + 1] - v->centers[i]);
+    return v->means[i] + (v->means[i + 1] - v->means[i]) * frac;
+}
+
+double macac_population_cdf(macac_population_t* population, size_t metric, double x) {
+    if (!population || metric >= population->metrics || std::isnan(x)) {
+        return NAN;
+    }
+    population_shard* shard = &population->shards[population_slot()];
+    std::lock_guard<std::mutex> guard(shard->lock);
+    const population_view* v = shard_view(shard, metric);
+    size_t n = v->count;
+    if (n == 0) {
+        return NAN;
+    }
+    if (x < v->min) {
+        return 0.0;
+    }
+    if (x >= v->max) {
+        return 1.0;
+    }
+    
+    double t;
+    if (x < v->means[0]) {
+        t = v->centers[0] * ((x - v->min) / (v->means[0] - v->min));
+    } else if (x >= v->means[n - 1]) {
+        t = v->centers[n - 1] + (v->total - v->centers[n - 1])
+            * ((x - v->means[n - 1]) / (v->max - v->means[n - 1]));
+    } else {
+        size_t i = (size_t)(std::upper_bound(v->means, v->means + n, x) - v->means) - 1;
+        double frac = (x - v->means[i]) / (v->means[i + 1] - v->means[i]);
+        t = v->centers[i] + (v->centers[i + 1] - v->centers[i]) * frac;
+    }
+    return t / v->total;
+}
+
+void macac_population_get_stats(macac_population_t* population, size_t metric,
+                                macac_population_stats_t* out) {
+    if (!out) {
+        return;
+    }
+    out->count = 0;
+    out->centroids = 0;
+    out->min = NAN;
+    out->max = NAN;
+    if (!population || metric >= population->metrics) {
+        return;
+    }
+    population_shard* shard = &population->shards[population_slot()];
+    std::lock_guard<std::mutex> guard(shard->lock);
+    const population_view* v = shard_view(shard, metric);
+    out->count = (uint64_t)v->total;
+    out->centroids = v->count;
+    out->min = v->min;
+    out->max = v->max;
+}
+
+} // extern "C"
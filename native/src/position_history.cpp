@@ -0,0 +1,375 @@
+/*
+ * MacAC Native Library - Position History
+ * 
+ * Keeps the last `window` timestamped positions of every tracked entity so
+ * reach can be measured against where the target was when the attacker saw
+ * it (now minus their ping) instead of where it is now.
+ * 
+ * Layout:
+ *   table   open-addressing id -> slot map (linear probing, backward-shift
+ *           deletion, so no tombstones build up with entity churn)
+ *   rings   rings[slot][window] records, oldest at (head - size)
+ * 
+ * Samples within a ring are strictly increasing in time, which is what
+ * makes the binary search valid; late samples are dropped on record.
+ */
+
+#include "macac_native.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+static_assert(sizeof(macac_position_sample_t) == MACAC_POSITION_SAMPLE_SIZE, "sample layout");
+
+#define POSHIST_EMPTY UINT32_MAX
+
+/**
+ * One stored sample (the id lives in the slot).
+ */
+struct poshist_record {
+    int64_t t;
+    double x;
+    double y;
+    double z;
+    float width;
+    float height;
+};
+
+struct macac_position_history {
+    size_t capacity;
+    size_t window;
+    size_t count;
+    
+    // id -> slot map, at least twice as many cells as slots
+    unsigned table_shift;
+    size_t table_mask;
+    int64_t* table_ids;
+    uint32_t* table_slots;      // POSHIST_EMPTY marks a free cell
+    
+    // Per-slot state
+    int64_t* slot_ids;
+    uint32_t* heads;            // next write position
+    uint32_t* sizes;            // 0 for a free slot
+    uint32_t* free_list;
+    size_t free_count;
+    
+    poshist_record* rings;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static size_t home_of(const macac_position_history_t* hist, int64_t id) {
+    return (size_t)(((uint64_t)id * 0x9E3779B97F4A7C15ull) >> hist->table_shift);
+}
+
+/**
+ * Table cell holding id, or the empty cell where it would go.
+ */
+static size_t probe(const macac_position_history_t* hist, int64_t id) {
+    size_t i = home_of(hist, id);
+    while (hist->table_slots[i] != POSHIST_EMPTY && hist->table_ids[i] != id) {
+        i = (i + 1) & hist->table_mask;
+    }
+    return i;
+}
+
+static uint32_t find_slot(const macac_position_history_t* hist, int64_t id) {
+    return hist->table_slots[probe(hist, id)];
+}
+
+/**
+ * Remove the entity in table cell i, shifting later cells of its probe
+ * run back so lookups never stop early.
+ */
+static void erase_cell(macac_position_history_t* hist, size_t i) {
+    uint32_t slot = hist->table_slots[i];
+    hist->sizes[slot] = 0;
+    hist->heads[slot] = 0;
+    hist->free_list[hist->free_count++] = slot;
+    hist->count--;
+    
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & hist->table_mask;
+        if (hist->table_slots[j] == POSHIST_EMPTY) {
+            break;
+        }
+        
+        // Move j into the hole unless its home lies cyclically in (i, j]
+        size_t k = home_of(hist, hist->table_ids[j]);
+        bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            hist->table_ids[i] = hist->table_ids[j];
+            hist->table_slots[i] = hist->table_slots[j];
+            i = j;
+        }
+    }
+    hist->table_slots[i] = POSHIST_EMPTY;
+}
+
+static const poshist_record* record_at(const macac_position_history_t* hist, uint32_t slot, size_t logical) {
+    size_t n = hist->sizes[slot];
+    size_t phys = (hist->heads[slot] + hist->window - n + logical) % hist->window;
+    return &hist->rings[(size_t)slot * hist->window + phys];
+}
+
+static void fill_sample(macac_position_sample_t* out, int64_t id, const poshist_record* r) {
+    out->id = id;
+    out->nano_time = r->t;
+    out->x = r->x;
+    out->y = r->y;
+    out->z = r->z;
+    out->width = r->width;
+    out->height = r->height;
+}
+
+static bool finite_sample(const macac_position_sample_t& s) {
+    return std::isfinite(s.x) && std::isfinite(s.y) && std::isfinite(s.z) &&
+           std::isfinite(s.width) && std::isfinite(s.height);
+}
+
+extern "C" {
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+macac_position_history_t* macac_poshist_create(size_t max_entities, size_t window) {
+    if (max_entities == 0 || window == 0 || max_entities > UINT32_MAX / 4 || window > UINT32_MAX) {
+        return nullptr;
+    }
+    
+    macac_position_history_t* hist = new (std::nothrow) macac_position_history_t();
+    if (!hist) {
+        return nullptr;
+    }
+    
+    unsigned bits = 4;
+    while (((size_t)1 << bits) < 2 * max_entities) {
+        bits++;
+    }
+    size_t cells = (size_t)1 << bits;
+    
+    hist->capacity = max_entities;
+    hist->window = window;
+    hist->table_shift = 64 - bits;
+    hist->table_mask = cells - 1;
+    hist->table_ids = new (std::nothrow) int64_t[cells];
+    hist->table_slots = new (std::nothrow) uint32_t[cells];
+    hist->slot_ids = new (std::nothrow) int64_t[max_entities];
+    hist->heads = new (std::nothrow) uint32_t[max_entities]();
+    hist->sizes = new (std::nothrow) uint32_t[max_entities]();
+    hist->free_list = new (std::nothrow) uint32_t[max_entities];
+    hist->rings = new (std::nothrow) poshist_record[max_entities * window];
+    
+    if (!hist->table_ids || !hist->table_slots || !hist->slot_ids || !hist->heads ||
+        !hist->sizes || !hist->free_list || !hist->rings) {
+        macac_poshist_destroy(hist);
+        return nullptr;
+    }
+    
+    for (size_t i = 0; i < cells; i++) {
+        hist->table_slots[i] = POSHIST_EMPTY;
+    }
+    
+    // Hand out low slots first
+    for (size_t i = 0; i < max_entities; i++) {
+        hist->free_list[i] = (uint32_t)(max_entities - 1 - i);
+    }
+    hist->free_count = max_entities;
+    
+    return hist;
+}
+
+void macac_poshist_destroy(macac_position_history_t* hist) {
+    if (!hist) {
+        return;
+    }
+    
+    delete[] hist->table_ids;
+    delete[] hist->table_slots;
+    delete[] hist->slot_ids;
+    delete[] hist->heads;
+    delete[] hist->sizes;
+    delete[] hist->free_list;
+    delete[] hist->rings;
+    delete hist;
+}
+
+size_t macac_poshist_record(macac_position_history_t* hist, const macac_position_sample_t* samples,
+                            size_t count) {
+    if (!hist || !samples) {
+        return 0;
+    }
+    
+    size_t stored = 0;
+    for (size_t i = 0; i < count; i++) {
+        const macac_position_sample_t& s = samples[i];
+        if (!finite_sample(s)) {
+            continue;
+        }
+        
+        size_t cell = probe(hist, s.id);
+        uint32_t slot = hist->table_slots[cell];
+        if (slot == POSHIST_EMPTY) {
+            if (hist->free_count == 0) {
+                continue;
+            }
+            slot = hist->free_list[--hist->free_count];
+            hist->table_ids[cell] = s.id;
+            hist->table_slots[cell] = slot;
+            hist->slot_ids[slot] = s.id;
+            hist->count++;
+        }
+        
+        // Equal times overwrite the latest sample; older ones are dropped
+        poshist_record* ring = &hist->rings[(size_t)slot * hist->window];
+        uint32_t pos = hist->heads[slot];
+        bool append = true;
+        if (hist->sizes[slot] > 0) {
+            uint32_t latest = (uint32_t)((pos + hist->window - 1) % hist->window);
+            if (s.nano_time < ring[latest].t) {
+                continue;
+            }
+            if (s.nano_time == ring[latest].t) {
+                pos = latest;
+                append = false;
+            }
+        }
+        
+        poshist_record& r = ring[pos];
+        r.t = s.nano_time;
+        r.x = s.x;
+        r.y = s.y;
+        r.z = s.z;
+        r.width = s.width;
+        r.height = s.height;
+        
+        if (append) {
+            hist->heads[slot] = (uint32_t)((pos + 1) % hist->window);
+            if (hist->sizes[slot] < hist->window) {
+                hist->sizes[slot]++;
+            }
+        }
+        stored++;
+    }
+    return stored;
+}
+
+void macac_poshist_remove(macac_position_history_t* hist, int64_t id) {
+    if (!hist) {
+        return;
+    }
+    
+    size_t cell = probe(hist, id);
+    if (hist->table_slots[cell] != POSHIST_EMPTY) {
+        erase_cell(hist, cell);
+    }
+}
+
+size_t macac_poshist_prune(macac_position_history_t* hist, int64_t nano_time) {
+    if (!hist) {
+        return 0;
+    }
+    
+    size_t removed = 0;
+    for (uint32_t slot = 0; slot < hist->capacity; slot++) {
+        if (hist->sizes[slot] == 0) {
+            continue;
+        }
+        const poshist_record* latest = record_at(hist, slot, hist->sizes[slot] - 1);
+        if (latest->t < nano_time) {
+            erase_cell(hist, probe(hist, hist->slot_ids[slot]));
+            removed++;
+        }
+    }
+    return removed;
+}
+
+size_t macac_poshist_size(macac_position_history_t* hist) {
+    return hist ? hist->count : 0;
+}
+
+int macac_poshist_at(const macac_position_history_t* hist, int64_t id, int64_t nano_time,
+                     macac_position_sample_t* out) {
+    if (!out) {
+        return -1;
+    }
+    
+    uint32_t slot = hist ? find_slot(hist, id) : POSHIST_EMPTY;
+    if (slot == POSHIST_EMPTY) {
+        out->id = id;
+        out->nano_time = nano_time;
+        out->x = out->y = out->z = std::nan("");
+        out->width = out->height = std::nanf("");
+        return -1;
+    }
+    
+    // First sample strictly after nano_time
+    size_t n = hist->sizes[slot];
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (record_at(hist, slot, mid)->t <= nano_time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    if (lo == 0) {
+        fill_sample(out, id, record_at(hist, slot, 0));
+        return 1;
+    }
+    const poshist_record* a = record_at(hist, slot, lo - 1);
+    if (lo == n || a->t == nano_time) {
+        fill_sample(out, id, a);
+        return a->t == nano_time ? 0 : 1;
+    }
+    
+    const poshist_record* b = record_at(hist, slot, lo);
+    double f = (double)(nano_time - a->t) / (double)(b->t - a->t);
+    out->id = id;
+    out->nano_time = nano_time;
+    out->x = a->x + (b->x - a->x) * f;
+    out->y = a->y + (b->y - a->y) * f;
+    out->z = a->z + (b->z - a->z) * f;
+    out->width = (float)(a->width + (b->width - a->width) * f);
+    out->height = (float)(a->height + (b->height - a->height) * f);
+    return 0;
+}
+
+size_t macac_poshist_rewind(const macac_position_history_t* hist, const int64_t* ids, size_t count,
+                            int64_t nano_time, macac_position_sample_t* out) {
+    if (!ids || !out) {
+        return 0;
+    }
+    
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (macac_poshist_at(hist, ids[i], nano_time, &out[i]) >= 0) {
+            found++;
+        }
+    }
+    return found;
+}
+
+double macac_poshist_reach(const macac_position_history_t* hist, int64_t id, int64_t nano_time,
+                           double eye_x, double eye_y, double eye_z) {
+    macac_position_sample_t s;
+    if (macac_poshist_at(hist, id, nano_time, &s) < 0) {
+        return std::nan("");
+    }
+    
+    // Nearest point of the box to the eye, per axis
+    double half = s.width * 0.5;
+    double dx = eye_x < s.x - half ? s.x - half - eye_x : (eye_x > s.x + half ? eye_x - s.x - half : 0.0);
+    double dy = eye_y < s.y ? s.y - eye_y : (eye_y > s.y + s.height ? eye_y - s.y - s.height : 0.0);
+    double dz = eye_z < s.z - half ? s.z - half - eye_z : (eye_z > s.z + half ? eye_z - s.z - half : 0.0);
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // extern "C"
@@ -1,11 +1,22 @@
 /*
  * MacAC Native Library - Ring Buffer Implementation
  * 
- * Lock-free ring buffer with aligned storage for SIMD operations.
- * Uses atomic operations for thread-safe push/access.
+ * Single-writer ring buffer with aligned storage for SIMD operations.
+ * head/size are atomics so a concurrent reader never sees a torn index,
+ * but push is a plain read-modify-write: with more than one writer,
+ * samples and running statistics are lost. Cross-thread hand-off goes
+ * through the packet queue (packet_queue.cpp) instead.
+ * 
+ * Push, get and the statistics are templates over the index wrap, and
+ * create picks an ops table per capacity: compile-time N for the common
+ * power-of-two windows (masking, divisions by a constant, unrolled scans
+ * from macac_fixed_ring.h), a runtime mask for other powers of two, and
+ * modulo for everything else.
  */
 
 #include "macac_native.h"
+#include "macac_fixed_ring.h"
+#include "compact_storage.h"
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
@@ -14,10 +25,387 @@
 // Alignment for SIMD (AVX2 = 32 bytes, AVX-512 = 64 bytes)
 #define SIMD_ALIGNMENT 32
 
+// Re-normalize early when an overwrite shrinks M2 by more than this factor
+#define RENORM_CANCELLATION (1.0 / (1 << 20))
+
+/**
+ * Running statistics for a tracked ring buffer.
+ * 
+ * Mean and M2 (sum of squared deviations) follow Welford's update while the
+ * window fills, and a combined remove-oldest/add-newest update once it is
+ * full. Every `capacity` overwrites they are recomputed from the raw window
+ * so floating-point drift (or an evicted NaN) cannot accumulate.
+ * 
+ * Min/max use monotonic queues of push sequence numbers: the front of each
+ * queue is the extreme of the current window, and each sample is queued and
+ * dequeued at most once, so push is amortized O(1).
+ */
+struct macac_ringbuffer_stats {
+    double mean;
+    double m2;
+    uint64_t pushes;            // Total pushes since create/clear
+    size_t since_renorm;        // Overwrites since last re-normalization
+    
+    uint64_t* max_queue;        // Sequence numbers, values decreasing
+    uint64_t* min_queue;        // Sequence numbers, values increasing
+    uint64_t max_front, max_back;
+    uint64_t min_front, min_back;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+/**
+ * Index wrap policies. Each maps a position or push sequence number onto
+ * [0, capacity) and reports the capacity, as a constant where it can.
+ */
+struct wrap_modulo {
+    size_t n;
+    explicit wrap_modulo(const macac_ringbuffer_t* rb) : n(rb->capacity) {}
+    size_t operator()(uint64_t i) const { return (size_t)(i % n); }
+    size_t capacity() const { return n; }
+};
+
+struct wrap_mask {
+    size_t m;
+    explicit wrap_mask(const macac_ringbuffer_t* rb) : m(rb->capacity - 1) {}
+    size_t operator()(uint64_t i) const { return (size_t)(i & m); }
+    size_t capacity() const { return m + 1; }
+};
+
+template <size_t N>
+struct wrap_fixed {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+    explicit wrap_fixed(const macac_ringbuffer_t*) {}
+    size_t operator()(uint64_t i) const { return (size_t)(i & (N - 1)); }
+    static constexpr size_t capacity() { return N; }
+};
+
+/**
+ * Per-capacity, per-storage kernels, chosen once at create.
+ */
+struct macac_ringbuffer_ops {
+    size_t fixed_capacity;      // N for compile-time kernels, else 0
+    void (*push)(macac_ringbuffer_t* rb, double value);
+    double (*get)(const macac_ringbuffer_t* rb, size_t age);
+    double (*mean)(const macac_ringbuffer_t* rb, size_t count);         // Untracked, count > 0
+    double (*variance)(const macac_ringbuffer_t* rb, size_t count);     // Untracked, count > 1
+    double (*min)(const macac_ringbuffer_t* rb, size_t count);
+    double (*max)(const macac_ringbuffer_t* rb, size_t count);
+};
+
+template <class S>
+static inline typename S::T* elems(const macac_ringbuffer_t* rb) {
+    return (typename S::T*)rb->data;
+}
+
+template <class W, class S>
+static inline double value_at(const macac_ringbuffer_t* rb, W wrap, uint64_t seq) {
+    return S::widen(elems<S>(rb)[wrap(seq)], rb->q16_step);
+}
+
+static void stats_reset(macac_ringbuffer_stats_t* st) {
+    st->mean = 0.0;
+    st->m2 = 0.0;
+    st->pushes = 0;
+    st->since_renorm = 0;
+    st->max_front = st->max_back = 0;
+    st->min_front = st->min_back = 0;
+}
+
+/**
+ * Window sum and sum of squared deviations, widened from the storage type;
+ * a full window of a compile-time capacity unrolls (Q16 sums stay integer).
+ */
+template <class S, class W>
+static double scan_sum(const macac_ringbuffer_t* rb, W, size_t count) {
+    return storage_sum<S>(elems<S>(rb), count, rb->q16_step);
+}
+
+template <class S, size_t N>
+static double scan_sum(const macac_ringbuffer_t* rb, wrap_fixed<N>, size_t count) {
+    if constexpr (S::id != MACAC_STORAGE_Q16) {
+        if (count == N) {
+            return macac_fixed_sum<N>(elems<S>(rb));
+        }
+    }
+    return storage_sum<S>(elems<S>(rb), count, rb->q16_step);
+}
+
+template <class S, class W>
+static double scan_sq_dev(const macac_ringbuffer_t* rb, W, size_t count, double mean) {
+    return storage_sum_sq_dev<S>(elems<S>(rb), count, rb->q16_step, mean);
+}
+
+template <class S, size_t N>
+static double scan_sq_dev(const macac_ringbuffer_t* rb, wrap_fixed<N>, size_t count, double mean) {
+    if constexpr (S::id != MACAC_STORAGE_Q16) {
+        if (count == N) {
+            return macac_fixed_sum_sq_dev<N>(elems<S>(rb), mean);
+        }
+    }
+    return storage_sum_sq_dev<S>(elems<S>(rb), count, rb->q16_step, mean);
+}
+
+/**
+ * Recompute mean/M2 exactly from the window (two-pass).
+ */
+template <class W, class S>
+static void stats_renormalize(macac_ringbuffer_t* rb, W wrap, size_t count) {
+    macac_ringbuffer_stats_t* st = rb->stats;
+    
+    double mean = count > 0 ? scan_sum<S>(rb, wrap, count) / count : 0.0;
+    
+    st->mean = mean;
+    st->m2 = scan_sq_dev<S>(rb, wrap, count, mean);
+    st->since_renorm = 0;
+}
+
+/**
+ * Update running statistics for a push. Must be called before the new
+ * value overwrites data[head].
+ */
+template <class W, class S>
+static void stats_push(macac_ringbuffer_t* rb, W wrap, size_t head, size_t count, double value) {
+    macac_ringbuffer_stats_t* st = rb->stats;
+    size_t capacity = wrap.capacity();
+    
+    if (count < capacity) {
+        // Window still filling: plain Welford add
+        double delta = value - st->mean;
+        st->mean += delta / (double)(count + 1);
+        st->m2 += delta * (value - st->mean);
+    } else {
+        // Window full: replace oldest with newest at fixed n
+        double old = S::widen(elems<S>(rb)[head], rb->q16_step);
+        double delta = value - old;
+        double new_mean = st->mean + delta / (double)capacity;
+        double prev_m2 = st->m2;
+        st->m2 += delta * (value - new_mean + old - st->mean);
+        st->mean = new_mean;
+        st->since_renorm++;
+        
+        // Evicting an outlier cancels most of M2 and leaves mostly rounding
+        // error behind; re-normalize right away instead of waiting
+        if (st->m2 < prev_m2 * RENORM_CANCELLATION) {
+            st->since_renorm = capacity;
+        }
+    }
+    if (st->m2 < 0.0) {
+        st->m2 = 0.0;
+    }
+    
+    uint64_t seq = st->pushes;
+    
+    // Drop the sample leaving the window from the queue fronts
+    if (seq >= capacity) {
+        uint64_t evicted = seq - capacity;
+        if (st->max_front < st->max_back && st->max_queue[wrap(st->max_front)] == evicted) {
+            st->max_front++;
+        }
+        if (st->min_front < st->min_back && st->min_queue[wrap(st->min_front)] == evicted) {
+            st->min_front++;
+        }
+    }
+    
+    // Pop dominated samples from the backs; they can never be the extreme again
+    while (st->max_front < st->max_back &&
+           value_at<W, S>(rb, wrap, st->max_queue[wrap(st->max_back - 1)]) <= value) {
+        st->max_back--;
+    }
+    while (st->min_front < st->min_back &&
+           value_at<W, S>(rb, wrap, st->min_queue[wrap(st->min_back - 1)]) >= value) {
+        st->min_back--;
+    }
+    
+    st->max_queue[wrap(st->max_back++)] = seq;
+    st->min_queue[wrap(st->min_back++)] = seq;
+    st->pushes = seq + 1;
+}
+
+// ============================================================================
+// Capacity- and Storage-Specialised Kernels
+// ============================================================================
+
+template <class W, class S>
+static void ring_push(macac_ringbuffer_t* rb, double value) {
+    W wrap(rb);
+    size_t capacity = wrap.capacity();
+    size_t current_head = rb->head.load(std::memory_order_relaxed);
+    size_t current_size = rb->size.load(std::memory_order_relaxed);
+    typename S::T* data = elems<S>(rb);
+    
+    // A Q16 step that grows requantises the window, so the tracked
+    // statistics are recomputed below instead of trusted
+    bool rescaled = S::fit(data, current_size, value, &rb->q16_exp);
+    if (rescaled) {
+        rb->q16_step = S::step(rb->q16_exp);
+    }
+    typename S::T stored = S::narrow(value, rb->q16_exp);
+    
+    // Update running statistics while the evicted value is still readable;
+    // they describe what is stored, not what was pushed
+    if (rb->stats) {
+        stats_push<W, S>(rb, wrap, current_head, current_size, S::widen(stored, rb->q16_step));
+    }
+    
+    data[current_head] = stored;
+    size_t new_head = wrap(current_head + 1);
+    rb->head.store(new_head, std::memory_order_release);
+    size_t new_size = current_size < capacity ? current_size + 1 : capacity;
+    if (current_size < capacity) {
+        rb->size.store(new_size, std::memory_order_release);
+    }
+    
+    // Once per lap, give back precision a departed outlier took
+    if (new_head == 0 && S::refit(data, new_size, &rb->q16_exp)) {
+        rb->q16_step = S::step(rb->q16_exp);
+    }
+    
+    // Periodically discard accumulated rounding error
+    if (rb->stats && (rescaled || rb->stats->since_renorm >= capacity)) {
+        stats_renormalize<W, S>(rb, wrap, new_size);
+    }
+}
+
+/**
+ * Element at age; the caller has checked age < size.
+ */
+template <class W, class S>
+static double ring_get(const macac_ringbuffer_t* rb, size_t age) {
+    W wrap(rb);
+    size_t current_head = rb->head.load(std::memory_order_acquire);
+    return value_at<W, S>(rb, wrap, current_head + wrap.capacity() - 1 - age);
+}
+
+// Untracked buffers fall back to a scan. Until the buffer wraps, the valid
+// elements are data[0..size); afterwards the whole array is the window, so
+// data[0..size) is always the window in some order. Mean and variance run
+// on the SIMD dispatch table, whose full-width kernels (widening on load
+// for compact storage) beat an unrolled baseline-ISA loop. Min/max compare
+// stored elements (widening is monotonic) and unroll over a full
+// compile-time window, which std::min_element cannot.
+
+template <class S>
+static double ring_mean(const macac_ringbuffer_t* rb, size_t count) {
+    return storage_sum<S>(elems<S>(rb), count, rb->q16_step) / (double)count;
+}
+
+template <class S>
+static double ring_variance(const macac_ringbuffer_t* rb, size_t count) {
+    double mean = ring_mean<S>(rb, count);
+    return storage_sum_sq_dev<S>(elems<S>(rb), count, rb->q16_step, mean) / (double)(count - 1);
+}
+
+template <class W, class S>
+static double ring_min(const macac_ringbuffer_t* rb, size_t count) {
+    if (rb->stats) {
+        W wrap(rb);
+        return value_at<W, S>(rb, wrap, rb->stats->min_queue[wrap(rb->stats->min_front)]);
+    }
+    const typename S::T* data = elems<S>(rb);
+    return S::widen(*std::min_element(data, data + count), rb->q16_step);
+}
+
+template <class W, class S>
+static double ring_max(const macac_ringbuffer_t* rb, size_t count) {
+    if (rb->stats) {
+        W wrap(rb);
+        return value_at<W, S>(rb, wrap, rb->stats->max_queue[wrap(rb->stats->max_front)]);
+    }
+    const typename S::T* data = elems<S>(rb);
+    return S::widen(*std::max_element(data, data + count), rb->q16_step);
+}
+
+template <size_t N, class S>
+struct fixed_scan {
+    static double min(const macac_ringbuffer_t* rb, size_t count) {
+        if (count == N && !rb->stats) {
+            return S::widen(macac_fixed_min<N>(elems<S>(rb)), rb->q16_step);
+        }
+        return ring_min<wrap_fixed<N>, S>(rb, count);
+    }
+    
+    static double max(const macac_ringbuffer_t* rb, size_t count) {
+        if (count == N && !rb->stats) {
+            return S::widen(macac_fixed_max<N>(elems<S>(rb)), rb->q16_step);
+        }
+        return ring_max<wrap_fixed<N>, S>(rb, count);
+    }
+};
+
+template <class W, class S>
+static const macac_ringbuffer_ops generic_ops = {
+    0,
+    ring_push<W, S>,
+    ring_get<W, S>,
+    ring_mean<S>,
+    ring_variance<S>,
+    ring_min<W, S>,
+    ring_max<W, S>,
+};
+
+template <size_t N, class S>
+static const macac_ringbuffer_ops fixed_ops = {
+    N,
+    ring_push<wrap_fixed<N>, S>,
+    ring_get<wrap_fixed<N>, S>,
+    ring_mean<S>,
+    ring_variance<S>,
+    fixed_scan<N, S>::min,
+    fixed_scan<N, S>::max,
+};
+
+/**
+ * Kernels for a capacity: compile-time N from 8 to 256, where combat and
+ * movement windows live, then masking for other powers of two.
+ */
+template <class S>
+static const macac_ringbuffer_ops* select_ops(size_t capacity) {
+    switch (capacity) {
+        case 8: return &fixed_ops<8, S>;
+        case 16: return &fixed_ops<16, S>;
+        case 32: return &fixed_ops<32, S>;
+        case 64: return &fixed_ops<64, S>;
+        case 128: return &fixed_ops<128, S>;
+        case 256: return &fixed_ops<256, S>;
+        default: break;
+    }
+    return (capacity & (capacity - 1)) == 0 ? &generic_ops<wrap_mask, S> : &generic_ops<wrap_modulo, S>;
+}
+
+static const macac_ringbuffer_ops* select_ops(size_t capacity, int storage) {
+    switch (storage) {
+        case MACAC_STORAGE_F64: return select_ops<storage_f64>(capacity);
+        case MACAC_STORAGE_F32: return select_ops<storage_f32>(capacity);
+        case MACAC_STORAGE_Q16: return select_ops<storage_q16>(capacity);
+        default: return nullptr;
+    }
+}
+
 extern "C" {
 
+size_t macac_storage_bytes(int storage) {
+    switch (storage) {
+        case MACAC_STORAGE_F64: return sizeof(double);
+        case MACAC_STORAGE_F32: return sizeof(float);
+        case MACAC_STORAGE_Q16: return sizeof(int16_t);
+        default: return 0;
+    }
+}
+
 macac_ringbuffer_t* macac_ringbuffer_create(size_t capacity) {
-    if (capacity == 0) {
+    return macac_ringbuffer_create_typed(capacity, MACAC_STORAGE_F64, 0);
+}
+
+macac_ringbuffer_t* macac_ringbuffer_create_tracked(size_t capacity) {
+    return macac_ringbuffer_create_typed(capacity, MACAC_STORAGE_F64, 1);
+}
+
+macac_ringbuffer_t* macac_ringbuffer_create_typed(size_t capacity, int storage, int tracked) {
+    size_t elem = macac_storage_bytes(storage);
+    if (capacity == 0 || elem == 0) {
         return nullptr;
     }
     
@@ -27,10 +415,10 @@ macac_ringbuffer_t* macac_ringbuffer_create(size_t capacity) {
     }
     
     // Allocate aligned memory for SIMD operations
-    size_t aligned_size = ((capacity * sizeof(double) + SIMD_ALIGNMENT - 1) 
+    size_t aligned_size = ((capacity * elem + SIMD_ALIGNMENT - 1) 
                            / SIMD_ALIGNMENT) * SIMD_ALIGNMENT;
     
-    rb->data = (double*)aligned_alloc(SIMD_ALIGNMENT, aligned_size);
+    rb->data = aligned_alloc(SIMD_ALIGNMENT, aligned_size);
     if (!rb->data) {
         delete rb;
         return nullptr;
@@ -40,14 +428,39 @@ macac_ringbuffer_t* macac_ringbuffer_create(size_t capacity) {
     memset(rb->data, 0, aligned_size);
     
     rb->capacity = capacity;
+    rb->storage = storage;
+    rb->q16_exp = Q16_EXP_MIN;
+    rb->q16_step = storage_q16::step(Q16_EXP_MIN);
+    rb->ops = select_ops(capacity, storage);
     rb->head.store(0, std::memory_order_relaxed);
     rb->size.store(0, std::memory_order_relaxed);
+    rb->stats = nullptr;
+    
+    if (!tracked) {
+        return rb;
+    }
+    
+    macac_ringbuffer_stats_t* st = new macac_ringbuffer_stats_t();
+    st->max_queue = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    st->min_queue = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    rb->stats = st;
+    
+    if (!st->max_queue || !st->min_queue) {
+        macac_ringbuffer_destroy(rb);
+        return nullptr;
+    }
     
+    stats_reset(st);
     return rb;
 }
 
 void macac_ringbuffer_destroy(macac_ringbuffer_t* rb) {
     if (rb) {
+        if (rb->stats) {
+            free(rb->stats->max_queue);
+            free(rb->stats->min_queue);
+            delete rb->stats;
+        }
         if (rb->data) {
             free(rb->data);
         }
@@ -59,22 +472,7 @@ void macac_ringbuffer_push(macac_ringbuffer_t* rb, double value) {
     if (!rb || !rb->data) {
         return;
     }
-    
-    // Get current head position
-    size_t current_head = rb->head.load(std::memory_order_relaxed);
-    
-    // Store value
-    rb->data[current_head] = value;
-    
-    // Advance head (wrap around)
-    size_t new_head = (current_head + 1) % rb->capacity;
-    rb->head.store(new_head, std::memory_order_release);
-    
-    // Update size if not full
-    size_t current_size = rb->size.load(std::memory_order_relaxed);
-    if (current_size < rb->capacity) {
-        rb->size.store(current_size + 1, std::memory_order_release);
-    }
+    rb->ops->push(rb, value);
 }
 
 double macac_ringbuffer_get(macac_ringbuffer_t* rb, size_t age) {
@@ -86,13 +484,7 @@ double macac_ringbuffer_get(macac_ringbuffer_t* rb, size_t age) {
     if (age >= current_size) {
         return std::nan("");
     }
-    
-    size_t current_head = rb->head.load(std::memory_order_acquire);
-    
-    // Calculate index: head - 1 - age (with wrap-around)
-    size_t index = (current_head + rb->capacity - 1 - age) % rb->capacity;
-    
-    return rb->data[index];
+    return rb->ops->get(rb, age);
 }
 
 void macac_ringbuffer_clear(macac_ringbuffer_t* rb) {
@@ -104,7 +496,13 @@ void macac_ringbuffer_clear(macac_ringbuffer_t* rb) {
     rb->size.store(0, std::memory_order_release);
     
     if (rb->data) {
-        memset(rb->data, 0, rb->capacity * sizeof(double));
+        memset(rb->data, 0, rb->capacity * macac_storage_bytes(rb->storage));
+    }
+    rb->q16_exp = Q16_EXP_MIN;
+    rb->q16_step = storage_q16::step(Q16_EXP_MIN);
+    
+    if (rb->stats) {
+        stats_reset(rb->stats);
     }
 }
 
@@ -115,4 +513,70 @@ size_t macac_ringbuffer_size(macac_ringbuffer_t* rb) {
     return rb->size.load(std::memory_order_acquire);
 }
 
+int macac_ringbuffer_is_tracked(macac_ringbuffer_t* rb) {
+    return (rb && rb->stats) ? 1 : 0;
+}
+
+int macac_ringbuffer_storage(macac_ringbuffer_t* rb) {
+    return rb ? rb->storage : -1;
+}
+
+size_t macac_ringbuffer_fixed_capacity(macac_ringbuffer_t* rb) {
+    return (rb && rb->ops) ? rb->ops->fixed_capacity : 0;
+}
+
+double macac_ringbuffer_mean(macac_ringbuffer_t* rb) {
+    if (!rb || !rb->data) {
+        return 0.0;
+    }
+    
+    size_t count = rb->size.load(std::memory_order_acquire);
+    if (count == 0) {
+        return 0.0;
+    }
+    if (rb->stats) {
+        return rb->stats->mean;
+    }
+    return rb->ops->mean(rb, count);
+}
+
+double macac_ringbuffer_variance(macac_ringbuffer_t* rb) {
+    if (!rb || !rb->data) {
+        return 0.0;
+    }
+    
+    size_t count = rb->size.load(std::memory_order_acquire);
+    if (count < 2) {
+        return 0.0;
+    }
+    if (rb->stats) {
+        return rb->stats->m2 / (double)(count - 1);
+    }
+    return rb->ops->variance(rb, count);
+}
+
+double macac_ringbuffer_min(macac_ringbuffer_t* rb) {
+    if (!rb || !rb->data) {
+        return std::nan("");
+    }
+    
+    size_t count = rb->size.load(std::memory_order_acquire);
+    if (count == 0) {
+        return std::nan("");
+    }
+    return rb->ops->min(rb, count);
+}
+
+double macac_ringbuffer_max(macac_ringbuffer_t* rb) {
+    if (!rb || !rb->data) {
+        return std::nan("");
+    }
+    
+    size_t count = rb->size.load(std::memory_order_acquire);
+    if (count == 0) {
+        return std::nan("");
+    }
+    return rb->ops->max(rb, count);
+}
+
 } // extern "C"
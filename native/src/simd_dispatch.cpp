@@ -0,0 +1,2524 @@
+/*
+ * MacAC Native Library - Runtime SIMD Dispatch
+ * 
+ * One binary for every host: each kernel is compiled for scalar, SSE2,
+ * AVX2 and AVX-512 (x86, via per-function target attributes) or NEON
+ * (AArch64), and the best table for the running CPU is picked from CPUID
+ * at init time. The library itself is built for the baseline ISA only.
+ * 
+ * All variants of distance_3d round identically to the scalar code (this
+ * file is built with -ffp-contract=off so no FMA is formed); sum and
+ * sum_sq_dev reassociate, so they agree only to rounding. The SoA distance
+ * kernels use explicit FMA on AVX2/AVX-512/NEON and may differ from the
+ * scalar result in the last bit; the aim and FFT kernels likewise.
+ */
+
+#include "macac_native.h"
+#include "simd_dispatch.h"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MACAC_SIMD_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define MACAC_SIMD_X86 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MACAC_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define MACAC_SIMD_NEON 0
+#endif
+
+// ============================================================================
+// Scalar Kernels
+// ============================================================================
+
+static double scalar_sum(const double* data, size_t count) {
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static double scalar_sum_sq_dev(const double* data, size_t count, double mean) {
+    double sum_sq = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double diff = data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+// Widening kernels keep four independent chains so the baseline build
+// vectorizes them; SSE2 and NEON use these directly
+
+static double scalar_sum_f32(const float* data, size_t count) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t l = 0; l < 4; l++) {
+            acc[l] += (double)data[i + l];
+        }
+    }
+    for (; i < count; i++) {
+        acc[0] += (double)data[i];
+    }
+    return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+}
+
+static double scalar_sum_sq_dev_f32(const float* data, size_t count, double mean) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t l = 0; l < 4; l++) {
+            double diff = (double)data[i + l] - mean;
+            acc[l] += diff * diff;
+        }
+    }
+    for (; i < count; i++) {
+        double diff = (double)data[i] - mean;
+        acc[0] += diff * diff;
+    }
+    return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+}
+
+static int64_t scalar_sum_i16(const int16_t* data, size_t count, int32_t* out_min) {
+    int64_t sum = 0;
+    int32_t min = INT16_MAX;
+    for (size_t i = 0; i < count; i++) {
+        sum += data[i];
+        min = data[i] < min ? data[i] : min;
+    }
+    *out_min = min;
+    return sum;
+}
+
+static double scalar_sum_sq_dev_i16(const int16_t* data, size_t count, double step, double mean) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t l = 0; l < 4; l++) {
+            double diff = (double)data[i + l] * step - mean;
+            acc[l] += diff * diff;
+        }
+    }
+    for (; i < count; i++) {
+        double diff = (double)data[i] * step - mean;
+        acc[0] += diff * diff;
+    }
+    return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+}
+
+/**
+ * Moments are accumulated around shift = data[0], which keeps the
+ * one-pass sum of squares from cancelling when values sit far from zero.
+ * min/max follow minsd/maxsd (a NaN sample is skipped unless it is first).
+ */
+static inline void scalar_moments_tail(const double* data, size_t start, size_t count,
+                                       double shift, double* out) {
+    for (size_t i = start; i < count; i++) {
+        double x = data[i];
+        double d = x - shift;
+        out[0] += d;
+        out[1] += d * d;
+        out[2] = x < out[2] ? x : out[2];
+        out[3] = x > out[3] ? x : out[3];
+    }
+}
+
+static void scalar_moments(const double* data, size_t count, double* out) {
+    out[0] = 0.0;
+    out[1] = 0.0;
+    out[2] = data[0];
+    out[3] = data[0];
+    scalar_moments_tail(data, 0, count, data[0], out);
+}
+
+/**
+ * Describe kernels return the shifted power sums sum(d^k), k = 1..4, with
+ * d = x - data[0], and min/max. Each ISA reduces one block of at most
+ * DESCRIBE_BLOCK values with plain sums, every power on its own add chains;
+ * describe_blocks() folds the block results into Neumaier-compensated
+ * totals, so rounding error grows with the block rather than the window.
+ */
+static const size_t DESCRIBE_BLOCK = 256;
+
+// out = {s1, s2, s3, s4, min, max} of one block; count > 0
+typedef void (*describe_block_fn)(const double* data, size_t count, double shift, double* out);
+
+static inline void scalar_describe_tail(const double* data, size_t start, size_t count,
+                                        double shift, double* out) {
+    for (size_t i = start; i < count; i++) {
+        double x = data[i];
+        double d = x - shift;
+        double q = d * d;
+        out[0] += d;
+        out[1] += q;
+        out[2] += q * d;
+        out[3] += q * q;
+        out[4] = x < out[4] ? x : out[4];
+        out[5] = x > out[5] ? x : out[5];
+    }
+}
+
+static void scalar_describe_block(const double* data, size_t count, double shift, double* out) {
+    out[0] = out[1] = out[2] = out[3] = 0.0;
+    out[4] = out[5] = data[0];
+    scalar_describe_tail(data, 0, count, shift, out);
+}
+
+static inline void neumaier_add(double* sum, double* comp, double value) {
+    double t = *sum + value;
+    if (std::fabs(*sum) >= std::fabs(value)) {
+        *comp += (*sum - t) + value;
+    } else {
+        *comp += (value - t) + *sum;
+    }
+    *sum = t;
+}
+
+static inline void describe_blocks(describe_block_fn block, const double* data, size_t count,
+                                   double* out) {
+    double shift = data[0];
+    double sum[4] = {0.0, 0.0, 0.0, 0.0};
+    double comp[4] = {0.0, 0.0, 0.0, 0.0};
+    out[4] = out[5] = shift;
+    
+    for (size_t i = 0; i < count; i += DESCRIBE_BLOCK) {
+        size_t n = count - i < DESCRIBE_BLOCK ? count - i : DESCRIBE_BLOCK;
+        double part[6];
+        block(data + i, n, shift, part);
+        for (int k = 0; k < 4; k++) {
+            neumaier_add(&sum[k], &comp[k], part[k]);
+        }
+        out[4] = part[4] < out[4] ? part[4] : out[4];
+        out[5] = part[5] > out[5] ? part[5] : out[5];
+    }
+    
+    for (int k = 0; k < 4; k++) {
+        out[k] = sum[k] + comp[k];
+    }
+}
+
+static void scalar_describe(const double* data, size_t count, double* out) {
+    describe_blocks(scalar_describe_block, data, count, out);
+}
+
+/**
+ * Fused combat pass over the five MACAC_COMBAT_* columns. Only aim error and
+ * attack interval need a variance, so only they are shifted by their first
+ * sample and squared; the heuristics never read the other columns' spread.
+ */
+static inline void scalar_combat_moments_tail(const double* const* c, size_t start, size_t count,
+                                              double* out) {
+    double aim0 = c[MACAC_COMBAT_AIM_ERROR][0];
+    double interval0 = c[MACAC_COMBAT_ATTACK_INTERVAL][0];
+    for (size_t i = start; i < count; i++) {
+        double da = c[MACAC_COMBAT_AIM_ERROR][i] - aim0;
+        double di = c[MACAC_COMBAT_ATTACK_INTERVAL][i] - interval0;
+        out[MACAC_COMBAT_AIM_ERROR] += da;
+        out[MACAC_COMBAT_SNAP_ANGLE] += c[MACAC_COMBAT_SNAP_ANGLE][i];
+        out[MACAC_COMBAT_REACH] += c[MACAC_COMBAT_REACH][i];
+        out[MACAC_COMBAT_ATTACK_INTERVAL] += di;
+        out[MACAC_COMBAT_HIT] += c[MACAC_COMBAT_HIT][i];
+        out[5] += da * da;
+        out[6] += di * di;
+    }
+}
+
+static void scalar_combat_moments(const double* const* c, size_t count, double* out) {
+    for (int k = 0; k < 7; k++) {
+        out[k] = 0.0;
+    }
+    scalar_combat_moments_tail(c, 0, count, out);
+}
+
+static inline double scalar_distance(const double* c) {
+    double dx = c[3] - c[0];
+    double dy = c[4] - c[1];
+    double dz = c[5] - c[2];
+    return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+static void scalar_distance_3d(const double* coords, double* distances, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        distances[i] = scalar_distance(&coords[i * 6]);
+    }
+}
+
+// SoA kernels take the six columns as c = {ax, ay, az, bx, by, bz}
+
+/**
+ * True if every column and the output are aligned to width bytes,
+ * so the vector loop can use aligned loads and stores.
+ */
+template <typename T>
+static inline bool soa_aligned(const T* const* c, const T* out, uintptr_t width) {
+    uintptr_t bits = (uintptr_t)out;
+    for (int k = 0; k < 6; k++) {
+        bits |= (uintptr_t)c[k];
+    }
+    return (bits & (width - 1)) == 0;
+}
+
+/**
+ * Elements [start, count); also finishes the vector kernels' remainders.
+ */
+static inline void scalar_distance_3d_soa_tail(const double* const* c, double* distances,
+                                               size_t start, size_t count) {
+    for (size_t i = start; i < count; i++) {
+        double dx = c[3][i] - c[0][i];
+        double dy = c[4][i] - c[1][i];
+        double dz = c[5][i] - c[2][i];
+        distances[i] = sqrt(dx*dx + dy*dy + dz*dz);
+    }
+}
+
+static inline void scalar_distance_3d_soa_f32_tail(const float* const* c, float* distances,
+                                                   size_t start, size_t count) {
+    for (size_t i = start; i < count; i++) {
+        float dx = c[3][i] - c[0][i];
+        float dy = c[4][i] - c[1][i];
+        float dz = c[5][i] - c[2][i];
+        distances[i] = sqrtf(dx*dx + dy*dy + dz*dz);
+    }
+}
+
+static void scalar_distance_3d_soa(const double* const* c, double* distances, size_t count) {
+    scalar_distance_3d_soa_tail(c, distances, 0, count);
+}
+
+static void scalar_distance_3d_soa_f32(const float* const* c, float* distances, size_t count) {
+    scalar_distance_3d_soa_f32_tail(c, distances, 0, count);
+}
+
+// ----------------------------------------------------------------------------
+// Aim kernels: expected yaw/pitch from one eye position to many SoA targets
+// (t = {tx, ty, tz}), the wrapped angular error to the actual aim, and the
+// index of the closest target.
+//
+// atan2 is approximated as a * P(a^2) on a = min/max in [0, 1] and folded
+// into the right octant; P is a degree-8 minimax fit with max error
+// 5.8e-9 rad (3.3e-7 degrees), so the angles stay well within
+// MACAC_ATAN2_MAX_ERROR_DEG of libm for finite inputs.
+// ----------------------------------------------------------------------------
+
+static const double AIM_PI = 3.14159265358979323846;
+static const double AIM_HALF_PI = 1.57079632679489661923;
+static const double AIM_RAD_TO_DEG = 180.0 / 3.14159265358979323846;
+static const double AIM_TINY = 2.2250738585072014e-308;   // DBL_MIN, keeps 0/0 out
+
+static const double ATAN_C0 = 0.99999988637574699;
+static const double ATAN_C1 = -0.33332596992540009;
+static const double ATAN_C2 = 0.19985906257434652;
+static const double ATAN_C3 = -0.14161225936414124;
+static const double ATAN_C4 = 0.10498935047348459;
+static const double ATAN_C5 = -0.072348362284394813;
+static const double ATAN_C6 = 0.039780993244900927;
+static const double ATAN_C7 = -0.014401224964748799;
+static const double ATAN_C8 = 0.00245669302332558;
+
+static inline double scalar_atan2_poly(double y, double x) {
+    double ax = fabs(x);
+    double ay = fabs(y);
+    double hi = ax > ay ? ax : ay;
+    double lo = ax > ay ? ay : ax;
+    double a = lo / (hi > AIM_TINY ? hi : AIM_TINY);
+    double s = a * a;
+    
+    double p = ATAN_C8;
+    p = p * s + ATAN_C7;
+    p = p * s + ATAN_C6;
+    p = p * s + ATAN_C5;
+    p = p * s + ATAN_C4;
+    p = p * s + ATAN_C3;
+    p = p * s + ATAN_C2;
+    p = p * s + ATAN_C1;
+    p = p * s + ATAN_C0;
+    
+    double r = a * p;
+    r = ay > ax ? AIM_HALF_PI - r : r;
+    r = x < 0.0 ? AIM_PI - r : r;
+    return copysign(r, y);
+}
+
+/**
+ * Elements [start, count); also finishes the vector kernels' remainders.
+ * Strict < keeps the earliest index on ties and never lets NaN win.
+ */
+static inline void scalar_aim_error_tail(const macac_aim_pose* pose, const double* const* t,
+                                         size_t start, size_t count,
+                                         double* out_yaw, double* out_pitch, double* out_error,
+                                         double* best, int64_t* best_index) {
+    for (size_t i = start; i < count; i++) {
+        double dx = t[0][i] - pose->eye_x;
+        double dy = t[1][i] - pose->eye_y;
+        double dz = t[2][i] - pose->eye_z;
+        
+        double yaw = scalar_atan2_poly(-dx, dz) * AIM_RAD_TO_DEG;
+        double pitch = -scalar_atan2_poly(dy, sqrt(dx*dx + dz*dz)) * AIM_RAD_TO_DEG;
+        double yaw_diff = macac_wrap_degrees(pose->yaw - yaw);
+        double pitch_diff = pose->pitch - pitch;
+        double error = sqrt(yaw_diff*yaw_diff + pitch_diff*pitch_diff);
+        
+        if (out_yaw) out_yaw[i] = yaw;
+        if (out_pitch) out_pitch[i] = pitch;
+        if (out_error) out_error[i] = error;
+        if (error < *best) {
+            *best = error;
+            *best_index = (int64_t)i;
+        }
+    }
+}
+
+/**
+ * Fold per-lane minima (indices carried as doubles) into one, preferring
+ * the lower index on ties.
+ */
+static inline void aim_reduce_lanes(const double* lane_best, const double* lane_index, int lanes,
+                                    double* best, int64_t* best_index) {
+    for (int k = 0; k < lanes; k++) {
+        int64_t index = (int64_t)lane_index[k];
+        if (lane_best[k] < *best || (lane_best[k] == *best && index < *best_index)) {
+            *best = lane_best[k];
+            *best_index = index;
+        }
+    }
+}
+
+static int64_t scalar_aim_error(const macac_aim_pose* pose, const double* const* t, size_t count,
+                                double* out_yaw, double* out_pitch, double* out_error) {
+    double best = INFINITY;
+    int64_t best_index = -1;
+    scalar_aim_error_tail(pose, t, 0, count, out_yaw, out_pitch, out_error, &best, &best_index);
+    return best_index;
+}
+
+// ============================================================================
+// x86 Kernels (SSE2 / AVX2 / AVX-512)
+// ============================================================================
+
+#if MACAC_SIMD_X86
+
+__attribute__((target("sse2")))
+static double sse2_sum(const double* data, size_t count) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(&data[i]));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(&data[i + 2]));
+    }
+    
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    
+    for (; i < count; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static double sse2_sum_sq_dev(const double* data, size_t count, double mean) {
+    __m128d mean_vec = _mm_set1_pd(mean);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(&data[i]), mean_vec);
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(&data[i + 2]), mean_vec);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    double sum_sq = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    
+    for (; i < count; i++) {
+        double diff = data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+__attribute__((target("sse2")))
+static void sse2_moments(const double* data, size_t count, double* out) {
+    __m128d shift = _mm_set1_pd(data[0]);
+    __m128d s1a = _mm_setzero_pd(), s1b = _mm_setzero_pd();
+    __m128d s2a = _mm_setzero_pd(), s2b = _mm_setzero_pd();
+    __m128d mna = shift, mnb = shift, mxa = shift, mxb = shift;
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d x0 = _mm_loadu_pd(&data[i]);
+        __m128d x1 = _mm_loadu_pd(&data[i + 2]);
+        __m128d d0 = _mm_sub_pd(x0, shift);
+        __m128d d1 = _mm_sub_pd(x1, shift);
+        s1a = _mm_add_pd(s1a, d0);
+        s1b = _mm_add_pd(s1b, d1);
+        s2a = _mm_add_pd(s2a, _mm_mul_pd(d0, d0));
+        s2b = _mm_add_pd(s2b, _mm_mul_pd(d1, d1));
+        mna = _mm_min_pd(x0, mna);
+        mnb = _mm_min_pd(x1, mnb);
+        mxa = _mm_max_pd(x0, mxa);
+        mxb = _mm_max_pd(x1, mxb);
+    }
+    
+    __m128d mn = _mm_min_pd(mnb, mna);
+    __m128d mx = _mm_max_pd(mxb, mxa);
+    __m128d s1 = _mm_add_pd(s1a, s1b);
+    __m128d s2 = _mm_add_pd(s2a, s2b);
+    out[0] = _mm_cvtsd_f64(_mm_add_sd(s1, _mm_unpackhi_pd(s1, s1)));
+    out[1] = _mm_cvtsd_f64(_mm_add_sd(s2, _mm_unpackhi_pd(s2, s2)));
+    out[2] = _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(mn, mn), mn));
+    out[3] = _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(mx, mx), mx));
+    scalar_moments_tail(data, i, count, data[0], out);
+}
+
+__attribute__((target("sse2")))
+static inline double sse2_hsum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("sse2")))
+static inline void sse2_describe_step(__m128d x, __m128d shift, __m128d* s, __m128d* mn, __m128d* mx) {
+    __m128d d = _mm_sub_pd(x, shift);
+    __m128d q = _mm_mul_pd(d, d);
+    s[0] = _mm_add_pd(s[0], d);
+    s[1] = _mm_add_pd(s[1], q);
+    s[2] = _mm_add_pd(s[2], _mm_mul_pd(q, d));
+    s[3] = _mm_add_pd(s[3], _mm_mul_pd(q, q));
+    *mn = _mm_min_pd(x, *mn);
+    *mx = _mm_max_pd(x, *mx);
+}
+
+__attribute__((target("sse2")))
+static void sse2_describe_block(const double* data, size_t count, double shift, double* out) {
+    __m128d sh = _mm_set1_pd(shift);
+    __m128d first = _mm_set1_pd(data[0]);
+    __m128d sa[4], sb[4];
+    for (int k = 0; k < 4; k++) {
+        sa[k] = _mm_setzero_pd();
+        sb[k] = _mm_setzero_pd();
+    }
+    __m128d mna = first, mnb = first, mxa = first, mxb = first;
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sse2_describe_step(_mm_loadu_pd(&data[i]), sh, sa, &mna, &mxa);
+        sse2_describe_step(_mm_loadu_pd(&data[i + 2]), sh, sb, &mnb, &mxb);
+    }
+    
+    for (int k = 0; k < 4; k++) {
+        out[k] = sse2_hsum(_mm_add_pd(sa[k], sb[k]));
+    }
+    __m128d mn = _mm_min_pd(mnb, mna);
+    __m128d mx = _mm_max_pd(mxb, mxa);
+    out[4] = _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(mn, mn), mn));
+    out[5] = _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(mx, mx), mx));
+    scalar_describe_tail(data, i, count, shift, out);
+}
+
+__attribute__((target("sse2")))
+static void sse2_describe(const double* data, size_t count, double* out) {
+    describe_blocks(sse2_describe_block, data, count, out);
+}
+
+__attribute__((target("sse2")))
+static void sse2_combat_moments(const double* const* c, size_t count, double* out) {
+    const double* aim = c[MACAC_COMBAT_AIM_ERROR];
+    const double* snap = c[MACAC_COMBAT_SNAP_ANGLE];
+    const double* reach = c[MACAC_COMBAT_REACH];
+    const double* interval = c[MACAC_COMBAT_ATTACK_INTERVAL];
+    const double* hit = c[MACAC_COMBAT_HIT];
+    __m128d aim0 = _mm_set1_pd(aim[0]);
+    __m128d interval0 = _mm_set1_pd(interval[0]);
+    __m128d acc[7];
+    for (int k = 0; k < 7; k++) {
+        acc[k] = _mm_setzero_pd();
+    }
+    
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d da = _mm_sub_pd(_mm_loadu_pd(&aim[i]), aim0);
+        __m128d di = _mm_sub_pd(_mm_loadu_pd(&interval[i]), interval0);
+        acc[MACAC_COMBAT_AIM_ERROR] = _mm_add_pd(acc[MACAC_COMBAT_AIM_ERROR], da);
+        acc[MACAC_COMBAT_SNAP_ANGLE] = _mm_add_pd(acc[MACAC_COMBAT_SNAP_ANGLE], _mm_loadu_pd(&snap[i]));
+        acc[MACAC_COMBAT_REACH] = _mm_add_pd(acc[MACAC_COMBAT_REACH], _mm_loadu_pd(&reach[i]));
+        acc[MACAC_COMBAT_ATTACK_INTERVAL] = _mm_add_pd(acc[MACAC_COMBAT_ATTACK_INTERVAL], di);
+        acc[MACAC_COMBAT_HIT] = _mm_add_pd(acc[MACAC_COMBAT_HIT], _mm_loadu_pd(&hit[i]));
+        acc[5] = _mm_add_pd(acc[5], _mm_mul_pd(da, da));
+        acc[6] = _mm_add_pd(acc[6], _mm_mul_pd(di, di));
+    }
+    
+    for (int k = 0; k < 7; k++) {
+        out[k] = _mm_cvtsd_f64(_mm_add_sd(acc[k], _mm_unpackhi_pd(acc[k], acc[k])));
+    }
+    scalar_combat_moments_tail(c, i, count, out);
+}
+
+/**
+ * Two distances per iteration: three unaligned loads per record, then
+ * unpack into x1/y1/z1/x2/y2/z2 lanes.
+ */
+__attribute__((target("sse2")))
+static void sse2_distance_3d(const double* coords, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const double* p = &coords[i * 6];
+        __m128d a0 = _mm_loadu_pd(p);          // x1 y1
+        __m128d a1 = _mm_loadu_pd(p + 2);      // z1 x2
+        __m128d a2 = _mm_loadu_pd(p + 4);      // y2 z2
+        __m128d b0 = _mm_loadu_pd(p + 6);
+        __m128d b1 = _mm_loadu_pd(p + 8);
+        __m128d b2 = _mm_loadu_pd(p + 10);
+        
+        __m128d dx = _mm_sub_pd(_mm_unpackhi_pd(a1, b1), _mm_unpacklo_pd(a0, b0));
+        __m128d dy = _mm_sub_pd(_mm_unpacklo_pd(a2, b2), _mm_unpackhi_pd(a0, b0));
+        __m128d dz = _mm_sub_pd(_mm_unpackhi_pd(a2, b2), _mm_unpacklo_pd(a1, b1));
+        
+        __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)),
+                                 _mm_mul_pd(dz, dz));
+        _mm_storeu_pd(&distances[i], _mm_sqrt_pd(sum));
+    }
+    
+    for (; i < count; i++) {
+        distances[i] = scalar_distance(&coords[i * 6]);
+    }
+}
+
+__attribute__((target("avx2")))
+static inline double avx2_hsum(__m256d v) {
+    __m128d sum128 = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum128, _mm_unpackhi_pd(sum128, sum128)));
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum(const double* data, size_t count) {
+    // Four chains cover the add latency at two adds per cycle
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(&data[i]));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(&data[i + 4]));
+        acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(&data[i + 8]));
+        acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(&data[i + 12]));
+    }
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(&data[i]));
+    }
+    
+    double sum = avx2_hsum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+    for (; i < count; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum_sq_dev(const double* data, size_t count, double mean) {
+    __m256d mean_vec = _mm256_set1_pd(mean);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(&data[i]), mean_vec);
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(&data[i + 4]), mean_vec);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+    }
+    if (i + 4 <= count) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(&data[i]), mean_vec);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+        i += 4;
+    }
+    
+    double sum_sq = avx2_hsum(_mm256_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum_f32(const float* data, size_t count) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(&data[i])));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(&data[i + 4])));
+        acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(_mm_loadu_ps(&data[i + 8])));
+        acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(_mm_loadu_ps(&data[i + 12])));
+    }
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(&data[i])));
+    }
+    
+    double sum = avx2_hsum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+    for (; i < count; i++) {
+        sum += (double)data[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum_sq_dev_f32(const float* data, size_t count, double mean) {
+    __m256d mean_vec = _mm256_set1_pd(mean);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(&data[i])), mean_vec);
+        __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(&data[i + 4])), mean_vec);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+    }
+    
+    double sum_sq = avx2_hsum(_mm256_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = (double)data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+/**
+ * Pairwise sums (madd against ones) fit in int32 and are widened to int64
+ * every step, so the sum is exact for any count.
+ */
+__attribute__((target("avx2")))
+static int64_t avx2_sum_i16(const int16_t* data, size_t count, int32_t* out_min) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    __m256i min = _mm256_set1_epi16(INT16_MAX);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&data[i]);
+        __m256i pairs = _mm256_madd_epi16(x, ones);
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+        min = _mm256_min_epi16(min, x);
+    }
+    
+    alignas(32) int64_t sums[4];
+    alignas(32) int16_t mins[16];
+    _mm256_store_si256((__m256i*)sums, acc);
+    _mm256_store_si256((__m256i*)mins, min);
+    int64_t sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    int32_t m = INT16_MAX;
+    for (size_t l = 0; l < 16; l++) {
+        m = mins[l] < m ? mins[l] : m;
+    }
+    for (; i < count; i++) {
+        sum += data[i];
+        m = data[i] < m ? data[i] : m;
+    }
+    *out_min = m;
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum_sq_dev_i16(const int16_t* data, size_t count, double step, double mean) {
+    __m256d step_vec = _mm256_set1_pd(step);
+    __m256d mean_vec = _mm256_set1_pd(mean);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&data[i]));
+        __m256d x0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x));
+        __m256d x1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1));
+        __m256d d0 = _mm256_sub_pd(_mm256_mul_pd(x0, step_vec), mean_vec);
+        __m256d d1 = _mm256_sub_pd(_mm256_mul_pd(x1, step_vec), mean_vec);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+    }
+    
+    double sum_sq = avx2_hsum(_mm256_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = (double)data[i] * step - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+__attribute__((target("avx2")))
+static void avx2_moments(const double* data, size_t count, double* out) {
+    __m256d shift = _mm256_set1_pd(data[0]);
+    __m256d s1a = _mm256_setzero_pd(), s1b = _mm256_setzero_pd();
+    __m256d s2a = _mm256_setzero_pd(), s2b = _mm256_setzero_pd();
+    __m256d mna = shift, mnb = shift, mxa = shift, mxb = shift;
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(&data[i]);
+        __m256d x1 = _mm256_loadu_pd(&data[i + 4]);
+        __m256d d0 = _mm256_sub_pd(x0, shift);
+        __m256d d1 = _mm256_sub_pd(x1, shift);
+        s1a = _mm256_add_pd(s1a, d0);
+        s1b = _mm256_add_pd(s1b, d1);
+        s2a = _mm256_add_pd(s2a, _mm256_mul_pd(d0, d0));
+        s2b = _mm256_add_pd(s2b, _mm256_mul_pd(d1, d1));
+        mna = _mm256_min_pd(x0, mna);
+        mnb = _mm256_min_pd(x1, mnb);
+        mxa = _mm256_max_pd(x0, mxa);
+        mxb = _mm256_max_pd(x1, mxb);
+    }
+    if (i + 4 <= count) {
+        __m256d x0 = _mm256_loadu_pd(&data[i]);
+        __m256d d0 = _mm256_sub_pd(x0, shift);
+        s1a = _mm256_add_pd(s1a, d0);
+        s2a = _mm256_add_pd(s2a, _mm256_mul_pd(d0, d0));
+        mna = _mm256_min_pd(x0, mna);
+        mxa = _mm256_max_pd(x0, mxa);
+        i += 4;
+    }
+    
+    __m256d mn = _mm256_min_pd(mnb, mna);
+    __m256d mx = _mm256_max_pd(mxb, mxa);
+    
+    __m128d mn2 = _mm_min_pd(_mm256_extractf128_pd(mn, 1), _mm256_castpd256_pd128(mn));
+    __m128d mx2 = _mm_max_pd(_mm256_extractf128_pd(mx, 1), _mm256_castpd256_pd128(mx));
+    out[0] = avx2_hsum(_mm256_add_pd(s1a, s1b));
+    out[1] = avx2_hsum(_mm256_add_pd(s2a, s2b));
+    out[2] = _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(mn2, mn2), mn2));
+    out[3] = _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(mx2, mx2), mx2));
+    scalar_moments_tail(data, i, count, data[0], out);
+}
+
+__attribute__((target("avx2")))
+static inline void avx2_describe_step(__m256d x, __m256d shift, __m256d* s, __m256d* mn, __m256d* mx) {
+    __m256d d = _mm256_sub_pd(x, shift);
+    __m256d q = _mm256_mul_pd(d, d);
+    s[0] = _mm256_add_pd(s[0], d);
+    s[1] = _mm256_add_pd(s[1], q);
+    s[2] = _mm256_add_pd(s[2], _mm256_mul_pd(q, d));
+    s[3] = _mm256_add_pd(s[3], _mm256_mul_pd(q, q));
+    *mn = _mm256_min_pd(x, *mn);
+    *mx = _mm256_max_pd(x, *mx);
+}
+
+/**
+ * Two steps per iteration already keep eight add chains in flight (four
+ * powers each); unrolling further would spill the sixteen ymm registers.
+ */
+__attribute__((target("avx2")))
+static void avx2_describe_block(const double* data, size_t count, double shift, double* out) {
+    __m256d sh = _mm256_set1_pd(shift);
+    __m256d first = _mm256_set1_pd(data[0]);
+    __m256d sa[4], sb[4];
+    for (int k = 0; k < 4; k++) {
+        sa[k] = _mm256_setzero_pd();
+        sb[k] = _mm256_setzero_pd();
+    }
+    __m256d mna = first, mnb = first, mxa = first, mxb = first;
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        avx2_describe_step(_mm256_loadu_pd(&data[i]), sh, sa, &mna, &mxa);
+        avx2_describe_step(_mm256_loadu_pd(&data[i + 4]), sh, sb, &mnb, &mxb);
+    }
+    if (i + 4 <= count) {
+        avx2_describe_step(_mm256_loadu_pd(&data[i]), sh, sa, &mna, &mxa);
+        i += 4;
+    }
+    
+    for (int k = 0; k < 4; k++) {
+        out[k] = avx2_hsum(_mm256_add_pd(sa[k], sb[k]));
+    }
+    __m256d mn = _mm256_min_pd(mnb, mna);
+    __m256d mx = _mm256_max_pd(mxb, mxa);
+    __m128d mn2 = _mm_min_pd(_mm256_extractf128_pd(mn, 1), _mm256_castpd256_pd128(mn));
+    __m128d mx2 = _mm_max_pd(_mm256_extractf128_pd(mx, 1), _mm256_castpd256_pd128(mx));
+    out[4] = _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(mn2, mn2), mn2));
+    out[5] = _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(mx2, mx2), mx2));
+    scalar_describe_tail(data, i, count, shift, out);
+}
+
+__attribute__((target("avx2")))
+static void avx2_describe(const double* data, size_t count, double* out) {
+    describe_blocks(avx2_describe_block, data, count, out);
+}
+
+__attribute__((target("avx2")))
+static void avx2_combat_moments(const double* const* c, size_t count, double* out) {
+    const double* aim = c[MACAC_COMBAT_AIM_ERROR];
+    const double* snap = c[MACAC_COMBAT_SNAP_ANGLE];
+    const double* reach = c[MACAC_COMBAT_REACH];
+    const double* interval = c[MACAC_COMBAT_ATTACK_INTERVAL];
+    const double* hit = c[MACAC_COMBAT_HIT];
+    __m256d aim0 = _mm256_set1_pd(aim[0]);
+    __m256d interval0 = _mm256_set1_pd(interval[0]);
+    __m256d acc[7];
+    for (int k = 0; k < 7; k++) {
+        acc[k] = _mm256_setzero_pd();
+    }
+    
+    // 9 live registers; 11 FP ops per step already cover the add latency
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d da = _mm256_sub_pd(_mm256_loadu_pd(&aim[i]), aim0);
+        __m256d di = _mm256_sub_pd(_mm256_loadu_pd(&interval[i]), interval0);
+        acc[MACAC_COMBAT_AIM_ERROR] = _mm256_add_pd(acc[MACAC_COMBAT_AIM_ERROR], da);
+        acc[MACAC_COMBAT_SNAP_ANGLE] = _mm256_add_pd(acc[MACAC_COMBAT_SNAP_ANGLE],
+                                                     _mm256_loadu_pd(&snap[i]));
+        acc[MACAC_COMBAT_REACH] = _mm256_add_pd(acc[MACAC_COMBAT_REACH], _mm256_loadu_pd(&reach[i]));
+        acc[MACAC_COMBAT_ATTACK_INTERVAL] = _mm256_add_pd(acc[MACAC_COMBAT_ATTACK_INTERVAL], di);
+        acc[MACAC_COMBAT_HIT] = _mm256_add_pd(acc[MACAC_COMBAT_HIT], _mm256_loadu_pd(&hit[i]));
+        acc[5] = _mm256_add_pd(acc[5], _mm256_mul_pd(da, da));
+        acc[6] = _mm256_add_pd(acc[6], _mm256_mul_pd(di, di));
+    }
+    
+    for (int k = 0; k < 7; k++) {
+        out[k] = avx2_hsum(acc[k]);
+    }
+    scalar_combat_moments_tail(c, i, count, out);
+}
+
+/**
+ * Four distances per iteration: a 4x4 transpose of each record's first
+ * four doubles gives x1/y1/z1/x2; the trailing y2/z2 pairs are unpacked.
+ */
+__attribute__((target("avx2")))
+static void avx2_distance_3d(const double* coords, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const double* p = &coords[i * 6];
+        __m256d r0 = _mm256_loadu_pd(p);            // x1 y1 z1 x2
+        __m256d r1 = _mm256_loadu_pd(p + 6);
+        __m256d r2 = _mm256_loadu_pd(p + 12);
+        __m256d r3 = _mm256_loadu_pd(p + 18);
+        
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);   // x1_0 x1_1 z1_0 z1_1
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);   // y1_0 y1_1 x2_0 x2_1
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        
+        __m256d x1 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        __m256d z1 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        __m256d y1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        __m256d x2 = _mm256_permute2f128_pd(t1, t3, 0x31);
+        
+        __m128d s0 = _mm_loadu_pd(p + 4);           // y2 z2
+        __m128d s1 = _mm_loadu_pd(p + 10);
+        __m128d s2 = _mm_loadu_pd(p + 16);
+        __m128d s3 = _mm_loadu_pd(p + 22);
+        __m256d y2 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_unpacklo_pd(s0, s1)),
+                                          _mm_unpacklo_pd(s2, s3), 1);
+        __m256d z2 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_unpackhi_pd(s0, s1)),
+                                          _mm_unpackhi_pd(s2, s3), 1);
+        
+        __m256d dx = _mm256_sub_pd(x2, x1);
+        __m256d dy = _mm256_sub_pd(y2, y1);
+        __m256d dz = _mm256_sub_pd(z2, z1);
+        __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                                    _mm256_mul_pd(dz, dz));
+        _mm256_storeu_pd(&distances[i], _mm256_sqrt_pd(sum));
+    }
+    
+    for (; i < count; i++) {
+        distances[i] = scalar_distance(&coords[i * 6]);
+    }
+}
+
+__attribute__((target("avx512f")))
+static inline double avx512_hsum(__m512d v) {
+    __m256d hi = _mm512_maskz_extractf64x4_pd(0xF, v, 1);
+    __m256d lo = _mm512_maskz_extractf64x4_pd(0xF, v, 0);
+    return avx2_hsum(_mm256_add_pd(lo, hi));
+}
+
+__attribute__((target("avx512f")))
+static double avx512_sum(const double* data, size_t count) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(&data[i]));
+        acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(&data[i + 8]));
+        acc2 = _mm512_add_pd(acc2, _mm512_loadu_pd(&data[i + 16]));
+        acc3 = _mm512_add_pd(acc3, _mm512_loadu_pd(&data[i + 24]));
+    }
+    acc0 = _mm512_add_pd(acc0, acc2);
+    acc1 = _mm512_add_pd(acc1, acc3);
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(&data[i]));
+        acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(&data[i + 8]));
+    }
+    for (; i < count; i += 8) {
+        size_t left = count - i;
+        __mmask8 mask = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        acc0 = _mm512_add_pd(acc0, _mm512_maskz_loadu_pd(mask, &data[i]));
+    }
+    
+    return avx512_hsum(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static double avx512_sum_sq_dev(const double* data, size_t count, double mean) {
+    __m512d mean_vec = _mm512_set1_pd(mean);
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(&data[i]), mean_vec);
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(&data[i + 8]), mean_vec);
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(d0, d0));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(d1, d1));
+    }
+    for (; i < count; i += 8) {
+        // Masked-off lanes stay zero instead of becoming -mean
+        size_t left = count - i;
+        __mmask8 mask = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __m512d d = _mm512_maskz_sub_pd(mask, _mm512_maskz_loadu_pd(mask, &data[i]), mean_vec);
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(d, d));
+    }
+    
+    return avx512_hsum(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static double avx512_sum_f32(const float* data, size_t count) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        acc0 = _mm512_add_pd(acc0, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i])));
+        acc1 = _mm512_add_pd(acc1, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i + 8])));
+        acc2 = _mm512_add_pd(acc2, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i + 16])));
+        acc3 = _mm512_add_pd(acc3, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i + 24])));
+    }
+    acc0 = _mm512_add_pd(acc0, acc2);
+    acc1 = _mm512_add_pd(acc1, acc3);
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm512_add_pd(acc0, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i])));
+    }
+    
+    double sum = avx512_hsum(_mm512_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        sum += (double)data[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static double avx512_sum_sq_dev_f32(const float* data, size_t count, double mean) {
+    __m512d mean_vec = _mm512_set1_pd(mean);
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i])), mean_vec);
+        __m512d d1 = _mm512_sub_pd(_mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(&data[i + 8])), mean_vec);
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(d0, d0));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(d1, d1));
+    }
+    
+    double sum_sq = avx512_hsum(_mm512_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = (double)data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+/**
+ * Sixteen samples per step, sign-extended to int32 and converted exactly.
+ * The widening kernels finish with a scalar tail of fewer than 16 samples.
+ */
+__attribute__((target("avx512f")))
+static double avx512_sum_sq_dev_i16(const int16_t* data, size_t count, double step, double mean) {
+    __m512d step_vec = _mm512_set1_pd(step);
+    __m512d mean_vec = _mm512_set1_pd(mean);
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_maskz_cvtepi16_epi32(0xFFFF, _mm256_loadu_si256((const __m256i*)&data[i]));
+        __m512d x0 = _mm512_maskz_cvtepi32_pd(0xFF, _mm512_maskz_extracti64x4_epi64(0xF, x, 0));
+        __m512d x1 = _mm512_maskz_cvtepi32_pd(0xFF, _mm512_maskz_extracti64x4_epi64(0xF, x, 1));
+        __m512d d0 = _mm512_sub_pd(_mm512_mul_pd(x0, step_vec), mean_vec);
+        __m512d d1 = _mm512_sub_pd(_mm512_mul_pd(x1, step_vec), mean_vec);
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(d0, d0));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(d1, d1));
+    }
+    
+    double sum_sq = avx512_hsum(_mm512_add_pd(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = (double)data[i] * step - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+/**
+ * The masked tail leaves inactive lanes' sums at zero and their min/max
+ * unchanged.
+ */
+__attribute__((target("avx512f")))
+static void avx512_moments(const double* data, size_t count, double* out) {
+    __m512d shift = _mm512_set1_pd(data[0]);
+    __m512d s1a = _mm512_setzero_pd(), s1b = _mm512_setzero_pd();
+    __m512d s2a = _mm512_setzero_pd(), s2b = _mm512_setzero_pd();
+    __m512d mna = shift, mnb = shift, mxa = shift, mxb = shift;
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d x0 = _mm512_loadu_pd(&data[i]);
+        __m512d x1 = _mm512_loadu_pd(&data[i + 8]);
+        __m512d d0 = _mm512_sub_pd(x0, shift);
+        __m512d d1 = _mm512_sub_pd(x1, shift);
+        s1a = _mm512_add_pd(s1a, d0);
+        s1b = _mm512_add_pd(s1b, d1);
+        s2a = _mm512_add_pd(s2a, _mm512_mul_pd(d0, d0));
+        s2b = _mm512_add_pd(s2b, _mm512_mul_pd(d1, d1));
+        mna = _mm512_maskz_min_pd(0xFF, x0, mna);
+        mnb = _mm512_maskz_min_pd(0xFF, x1, mnb);
+        mxa = _mm512_maskz_max_pd(0xFF, x0, mxa);
+        mxb = _mm512_maskz_max_pd(0xFF, x1, mxb);
+    }
+    for (; i < count; i += 8) {
+        size_t left = count - i;
+        __mmask8 m = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __m512d x = _mm512_maskz_loadu_pd(m, &data[i]);
+        __m512d d = _mm512_maskz_sub_pd(m, x, shift);
+        s1a = _mm512_add_pd(s1a, d);
+        s2a = _mm512_add_pd(s2a, _mm512_mul_pd(d, d));
+        mna = _mm512_mask_min_pd(mna, m, x, mna);
+        mxa = _mm512_mask_max_pd(mxa, m, x, mxa);
+    }
+    
+    __m512d mn = _mm512_maskz_min_pd(0xFF, mnb, mna);
+    __m512d mx = _mm512_maskz_max_pd(0xFF, mxb, mxa);
+    
+    out[0] = avx512_hsum(_mm512_add_pd(s1a, s1b));
+    out[1] = avx512_hsum(_mm512_add_pd(s2a, s2b));
+    alignas(64) double lo[8], hi[8];
+    _mm512_store_pd(lo, mn);
+    _mm512_store_pd(hi, mx);
+    out[2] = lo[0];
+    out[3] = hi[0];
+    for (int k = 1; k < 8; k++) {
+        out[2] = lo[k] < out[2] ? lo[k] : out[2];
+        out[3] = hi[k] > out[3] ? hi[k] : out[3];
+    }
+}
+
+__attribute__((target("avx512f")))
+static inline void avx512_describe_step(__m512d x, __m512d shift, __m512d* s, __m512d* mn, __m512d* mx) {
+    __m512d d = _mm512_sub_pd(x, shift);
+    __m512d q = _mm512_mul_pd(d, d);
+    s[0] = _mm512_add_pd(s[0], d);
+    s[1] = _mm512_add_pd(s[1], q);
+    s[2] = _mm512_add_pd(s[2], _mm512_mul_pd(q, d));
+    s[3] = _mm512_add_pd(s[3], _mm512_mul_pd(q, q));
+    *mn = _mm512_maskz_min_pd(0xFF, x, *mn);
+    *mx = _mm512_maskz_max_pd(0xFF, x, *mx);
+}
+
+/**
+ * Four independent accumulator sets (sixteen add chains) fit in the 32 zmm
+ * registers. The masked tail leaves inactive lanes' sums at zero and their
+ * min/max unchanged.
+ */
+__attribute__((target("avx512f")))
+static void avx512_describe_block(const double* data, size_t count, double shift, double* out) {
+    __m512d sh = _mm512_set1_pd(shift);
+    __m512d first = _mm512_set1_pd(data[0]);
+    __m512d s[4][4];
+    __m512d mn[4], mx[4];
+    for (int u = 0; u < 4; u++) {
+        for (int k = 0; k < 4; k++) {
+            s[u][k] = _mm512_setzero_pd();
+        }
+        mn[u] = first;
+        mx[u] = first;
+    }
+    
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        avx512_describe_step(_mm512_loadu_pd(&data[i]), sh, s[0], &mn[0], &mx[0]);
+        avx512_describe_step(_mm512_loadu_pd(&data[i + 8]), sh, s[1], &mn[1], &mx[1]);
+        avx512_describe_step(_mm512_loadu_pd(&data[i + 16]), sh, s[2], &mn[2], &mx[2]);
+        avx512_describe_step(_mm512_loadu_pd(&data[i + 24]), sh, s[3], &mn[3], &mx[3]);
+    }
+    for (; i < count; i += 8) {
+        size_t left = count - i;
+        __mmask8 m = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __m512d x = _mm512_maskz_loadu_pd(m, &data[i]);
+        __m512d d = _mm512_maskz_sub_pd(m, x, sh);
+        __m512d q = _mm512_mul_pd(d, d);
+        s[0][0] = _mm512_add_pd(s[0][0], d);
+        s[0][1] = _mm512_add_pd(s[0][1], q);
+        s[0][2] = _mm512_add_pd(s[0][2], _mm512_mul_pd(q, d));
+        s[0][3] = _mm512_add_pd(s[0][3], _mm512_mul_pd(q, q));
+        mn[0] = _mm512_mask_min_pd(mn[0], m, x, mn[0]);
+        mx[0] = _mm512_mask_max_pd(mx[0], m, x, mx[0]);
+    }
+    
+    for (int k = 0; k < 4; k++) {
+        out[k] = avx512_hsum(_mm512_add_pd(_mm512_add_pd(s[0][k], s[1][k]),
+                                           _mm512_add_pd(s[2][k], s[3][k])));
+    }
+    __m512d mnv = _mm512_maskz_min_pd(0xFF, _mm512_maskz_min_pd(0xFF, mn[3], mn[2]),
+                                      _mm512_maskz_min_pd(0xFF, mn[1], mn[0]));
+    __m512d mxv = _mm512_maskz_max_pd(0xFF, _mm512_maskz_max_pd(0xFF, mx[3], mx[2]),
+                                      _mm512_maskz_max_pd(0xFF, mx[1], mx[0]));
+    alignas(64) double lo[8], hi[8];
+    _mm512_store_pd(lo, mnv);
+    _mm512_store_pd(hi, mxv);
+    out[4] = lo[0];
+    out[5] = hi[0];
+    for (int k = 1; k < 8; k++) {
+        out[4] = lo[k] < out[4] ? lo[k] : out[4];
+        out[5] = hi[k] > out[5] ? hi[k] : out[5];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512_describe(const double* data, size_t count, double* out) {
+    describe_blocks(avx512_describe_block, data, count, out);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_combat_moments(const double* const* c, size_t count, double* out) {
+    const double* aim = c[MACAC_COMBAT_AIM_ERROR];
+    const double* snap = c[MACAC_COMBAT_SNAP_ANGLE];
+    const double* reach = c[MACAC_COMBAT_REACH];
+    const double* interval = c[MACAC_COMBAT_ATTACK_INTERVAL];
+    const double* hit = c[MACAC_COMBAT_HIT];
+    __m512d aim0 = _mm512_set1_pd(aim[0]);
+    __m512d interval0 = _mm512_set1_pd(interval[0]);
+    __m512d acc[7];
+    for (int k = 0; k < 7; k++) {
+        acc[k] = _mm512_setzero_pd();
+    }
+    
+    // Masked-off lanes load as zero and their deviations stay zero
+    for (size_t i = 0; i < count; i += 8) {
+        size_t left = count - i;
+        __mmask8 m = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __m512d da = _mm512_maskz_sub_pd(m, _mm512_maskz_loadu_pd(m, &aim[i]), aim0);
+        __m512d di = _mm512_maskz_sub_pd(m, _mm512_maskz_loadu_pd(m, &interval[i]), interval0);
+        acc[MACAC_COMBAT_AIM_ERROR] = _mm512_add_pd(acc[MACAC_COMBAT_AIM_ERROR], da);
+        acc[MACAC_COMBAT_SNAP_ANGLE] = _mm512_add_pd(acc[MACAC_COMBAT_SNAP_ANGLE],
+                                                     _mm512_maskz_loadu_pd(m, &snap[i]));
+        acc[MACAC_COMBAT_REACH] = _mm512_add_pd(acc[MACAC_COMBAT_REACH],
+                                                _mm512_maskz_loadu_pd(m, &reach[i]));
+        acc[MACAC_COMBAT_ATTACK_INTERVAL] = _mm512_add_pd(acc[MACAC_COMBAT_ATTACK_INTERVAL], di);
+        acc[MACAC_COMBAT_HIT] = _mm512_add_pd(acc[MACAC_COMBAT_HIT],
+                                              _mm512_maskz_loadu_pd(m, &hit[i]));
+        acc[5] = _mm512_add_pd(acc[5], _mm512_mul_pd(da, da));
+        acc[6] = _mm512_add_pd(acc[6], _mm512_mul_pd(di, di));
+    }
+    
+    for (int k = 0; k < 7; k++) {
+        out[k] = avx512_hsum(acc[k]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// SoA distance kernels: one vector load per column, no shuffles.
+// ALIGNED picks aligned loads/stores when soa_aligned() holds.
+// ----------------------------------------------------------------------------
+
+template <bool ALIGNED>
+__attribute__((target("sse2")))
+static inline void sse2_soa_loop(const double* const* c, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d dx = ALIGNED ? _mm_sub_pd(_mm_load_pd(&c[3][i]), _mm_load_pd(&c[0][i]))
+                             : _mm_sub_pd(_mm_loadu_pd(&c[3][i]), _mm_loadu_pd(&c[0][i]));
+        __m128d dy = ALIGNED ? _mm_sub_pd(_mm_load_pd(&c[4][i]), _mm_load_pd(&c[1][i]))
+                             : _mm_sub_pd(_mm_loadu_pd(&c[4][i]), _mm_loadu_pd(&c[1][i]));
+        __m128d dz = ALIGNED ? _mm_sub_pd(_mm_load_pd(&c[5][i]), _mm_load_pd(&c[2][i]))
+                             : _mm_sub_pd(_mm_loadu_pd(&c[5][i]), _mm_loadu_pd(&c[2][i]));
+        __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)),
+                                 _mm_mul_pd(dz, dz));
+        if (ALIGNED) {
+            _mm_store_pd(&distances[i], _mm_sqrt_pd(sum));
+        } else {
+            _mm_storeu_pd(&distances[i], _mm_sqrt_pd(sum));
+        }
+    }
+    
+    scalar_distance_3d_soa_tail(c, distances, i, count);
+}
+
+__attribute__((target("sse2")))
+static void sse2_distance_3d_soa(const double* const* c, double* distances, size_t count) {
+    if (soa_aligned(c, distances, 16)) {
+        sse2_soa_loop<true>(c, distances, count);
+    } else {
+        sse2_soa_loop<false>(c, distances, count);
+    }
+}
+
+template <bool ALIGNED>
+__attribute__((target("sse2")))
+static inline void sse2_soa_f32_loop(const float* const* c, float* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = ALIGNED ? _mm_sub_ps(_mm_load_ps(&c[3][i]), _mm_load_ps(&c[0][i]))
+                            : _mm_sub_ps(_mm_loadu_ps(&c[3][i]), _mm_loadu_ps(&c[0][i]));
+        __m128 dy = ALIGNED ? _mm_sub_ps(_mm_load_ps(&c[4][i]), _mm_load_ps(&c[1][i]))
+                            : _mm_sub_ps(_mm_loadu_ps(&c[4][i]), _mm_loadu_ps(&c[1][i]));
+        __m128 dz = ALIGNED ? _mm_sub_ps(_mm_load_ps(&c[5][i]), _mm_load_ps(&c[2][i]))
+                            : _mm_sub_ps(_mm_loadu_ps(&c[5][i]), _mm_loadu_ps(&c[2][i]));
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                _mm_mul_ps(dz, dz));
+        if (ALIGNED) {
+            _mm_store_ps(&distances[i], _mm_sqrt_ps(sum));
+        } else {
+            _mm_storeu_ps(&distances[i], _mm_sqrt_ps(sum));
+        }
+    }
+    
+    scalar_distance_3d_soa_f32_tail(c, distances, i, count);
+}
+
+__attribute__((target("sse2")))
+static void sse2_distance_3d_soa_f32(const float* const* c, float* distances, size_t count) {
+    if (soa_aligned(c, distances, 16)) {
+        sse2_soa_f32_loop<true>(c, distances, count);
+    } else {
+        sse2_soa_f32_loop<false>(c, distances, count);
+    }
+}
+
+template <bool ALIGNED>
+__attribute__((target("avx2,fma")))
+static inline __m256d avx2_load(const double* p) {
+    return ALIGNED ? _mm256_load_pd(p) : _mm256_loadu_pd(p);
+}
+
+template <bool ALIGNED>
+__attribute__((target("avx2,fma")))
+static inline __m256 avx2_load(const float* p) {
+    return ALIGNED ? _mm256_load_ps(p) : _mm256_loadu_ps(p);
+}
+
+template <bool ALIGNED>
+__attribute__((target("avx2,fma")))
+static inline void avx2_soa_loop(const double* const* c, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(avx2_load<ALIGNED>(&c[3][i]), avx2_load<ALIGNED>(&c[0][i]));
+        __m256d dy = _mm256_sub_pd(avx2_load<ALIGNED>(&c[4][i]), avx2_load<ALIGNED>(&c[1][i]));
+        __m256d dz = _mm256_sub_pd(avx2_load<ALIGNED>(&c[5][i]), avx2_load<ALIGNED>(&c[2][i]));
+        __m256d sum = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+        if (ALIGNED) {
+            _mm256_store_pd(&distances[i], _mm256_sqrt_pd(sum));
+        } else {
+            _mm256_storeu_pd(&distances[i], _mm256_sqrt_pd(sum));
+        }
+    }
+    
+    scalar_distance_3d_soa_tail(c, distances, i, count);
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_distance_3d_soa(const double* const* c, double* distances, size_t count) {
+    if (soa_aligned(c, distances, 32)) {
+        avx2_soa_loop<true>(c, distances, count);
+    } else {
+        avx2_soa_loop<false>(c, distances, count);
+    }
+}
+
+template <bool ALIGNED>
+__attribute__((target("avx2,fma")))
+static inline void avx2_soa_f32_loop(const float* const* c, float* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_sub_ps(avx2_load<ALIGNED>(&c[3][i]), avx2_load<ALIGNED>(&c[0][i]));
+        __m256 dy = _mm256_sub_ps(avx2_load<ALIGNED>(&c[4][i]), avx2_load<ALIGNED>(&c[1][i]));
+        __m256 dz = _mm256_sub_ps(avx2_load<ALIGNED>(&c[5][i]), avx2_load<ALIGNED>(&c[2][i]));
+        __m256 sum = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        if (ALIGNED) {
+            _mm256_store_ps(&distances[i], _mm256_sqrt_ps(sum));
+        } else {
+            _mm256_storeu_ps(&distances[i], _mm256_sqrt_ps(sum));
+        }
+    }
+    
+    scalar_distance_3d_soa_f32_tail(c, distances, i, count);
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_distance_3d_soa_f32(const float* const* c, float* distances, size_t count) {
+    if (soa_aligned(c, distances, 32)) {
+        avx2_soa_f32_loop<true>(c, distances, count);
+    } else {
+        avx2_soa_f32_loop<false>(c, distances, count);
+    }
+}
+
+/**
+ * Eight doubles per iteration; the tail is a masked iteration instead of
+ * a scalar loop.
+ */
+template <bool ALIGNED>
+__attribute__((target("avx512f")))
+static inline void avx512_soa_loop(const double* const* c, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d dx = ALIGNED ? _mm512_sub_pd(_mm512_load_pd(&c[3][i]), _mm512_load_pd(&c[0][i]))
+                             : _mm512_sub_pd(_mm512_loadu_pd(&c[3][i]), _mm512_loadu_pd(&c[0][i]));
+        __m512d dy = ALIGNED ? _mm512_sub_pd(_mm512_load_pd(&c[4][i]), _mm512_load_pd(&c[1][i]))
+                             : _mm512_sub_pd(_mm512_loadu_pd(&c[4][i]), _mm512_loadu_pd(&c[1][i]));
+        __m512d dz = ALIGNED ? _mm512_sub_pd(_mm512_load_pd(&c[5][i]), _mm512_load_pd(&c[2][i]))
+                             : _mm512_sub_pd(_mm512_loadu_pd(&c[5][i]), _mm512_loadu_pd(&c[2][i]));
+        __m512d sum = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx)));
+        __m512d dist = _mm512_maskz_sqrt_pd(0xFF, sum);
+        if (ALIGNED) {
+            _mm512_store_pd(&distances[i], dist);
+        } else {
+            _mm512_storeu_pd(&distances[i], dist);
+        }
+    }
+    if (i < count) {
+        __mmask8 m = (__mmask8)((1u << (count - i)) - 1);
+        __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &c[3][i]), _mm512_maskz_loadu_pd(m, &c[0][i]));
+        __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &c[4][i]), _mm512_maskz_loadu_pd(m, &c[1][i]));
+        __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &c[5][i]), _mm512_maskz_loadu_pd(m, &c[2][i]));
+        __m512d sum = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx)));
+        _mm512_mask_storeu_pd(&distances[i], m, _mm512_maskz_sqrt_pd(m, sum));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512_distance_3d_soa(const double* const* c, double* distances, size_t count) {
+    if (soa_aligned(c, distances, 64)) {
+        avx512_soa_loop<true>(c, distances, count);
+    } else {
+        avx512_soa_loop<false>(c, distances, count);
+    }
+}
+
+template <bool ALIGNED>
+__attribute__((target("avx512f")))
+static inline void avx512_soa_f32_loop(const float* const* c, float* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 dx = ALIGNED ? _mm512_sub_ps(_mm512_load_ps(&c[3][i]), _mm512_load_ps(&c[0][i]))
+                            : _mm512_sub_ps(_mm512_loadu_ps(&c[3][i]), _mm512_loadu_ps(&c[0][i]));
+        __m512 dy = ALIGNED ? _mm512_sub_ps(_mm512_load_ps(&c[4][i]), _mm512_load_ps(&c[1][i]))
+                            : _mm512_sub_ps(_mm512_loadu_ps(&c[4][i]), _mm512_loadu_ps(&c[1][i]));
+        __m512 dz = ALIGNED ? _mm512_sub_ps(_mm512_load_ps(&c[5][i]), _mm512_load_ps(&c[2][i]))
+                            : _mm512_sub_ps(_mm512_loadu_ps(&c[5][i]), _mm512_loadu_ps(&c[2][i]));
+        __m512 sum = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+        __m512 dist = _mm512_maskz_sqrt_ps(0xFFFF, sum);
+        if (ALIGNED) {
+            _mm512_store_ps(&distances[i], dist);
+        } else {
+            _mm512_storeu_ps(&distances[i], dist);
+        }
+    }
+    if (i < count) {
+        __mmask16 m = (__mmask16)((1u << (count - i)) - 1);
+        __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, &c[3][i]), _mm512_maskz_loadu_ps(m, &c[0][i]));
+        __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, &c[4][i]), _mm512_maskz_loadu_ps(m, &c[1][i]));
+        __m512 dz = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, &c[5][i]), _mm512_maskz_loadu_ps(m, &c[2][i]));
+        __m512 sum = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+        _mm512_mask_storeu_ps(&distances[i], m, _mm512_maskz_sqrt_ps(m, sum));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512_distance_3d_soa_f32(const float* const* c, float* distances, size_t count) {
+    if (soa_aligned(c, distances, 64)) {
+        avx512_soa_f32_loop<true>(c, distances, count);
+    } else {
+        avx512_soa_f32_loop<false>(c, distances, count);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Aim kernels. Same polynomial and octant folding as scalar_atan2_poly with
+// selects instead of branches; the argmin keeps a best error and index per
+// lane and folds the lanes once at the end.
+// ----------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static inline __m128d sse2_select(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d sse2_atan2_poly(__m128d y, __m128d x) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d ax = _mm_andnot_pd(sign, x);
+    __m128d ay = _mm_andnot_pd(sign, y);
+    __m128d hi = _mm_max_pd(ax, ay);
+    __m128d lo = _mm_min_pd(ax, ay);
+    __m128d a = _mm_div_pd(lo, _mm_max_pd(hi, _mm_set1_pd(AIM_TINY)));
+    __m128d s = _mm_mul_pd(a, a);
+    
+    __m128d p = _mm_set1_pd(ATAN_C8);
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C7));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C6));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C5));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C4));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C3));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C2));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C1));
+    p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(ATAN_C0));
+    
+    __m128d r = _mm_mul_pd(a, p);
+    r = sse2_select(_mm_cmpgt_pd(ay, ax), _mm_sub_pd(_mm_set1_pd(AIM_HALF_PI), r), r);
+    r = sse2_select(_mm_cmplt_pd(x, _mm_setzero_pd()), _mm_sub_pd(_mm_set1_pd(AIM_PI), r), r);
+    return _mm_or_pd(r, _mm_and_pd(y, sign));   // r >= 0 here
+}
+
+__attribute__((target("sse2")))
+static int64_t sse2_aim_error(const macac_aim_pose* pose, const double* const* t, size_t count,
+                              double* out_yaw, double* out_pitch, double* out_error) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d rad_to_deg = _mm_set1_pd(AIM_RAD_TO_DEG);
+    const __m128d magic = _mm_set1_pd(6755399441055744.0);
+    __m128d eye_x = _mm_set1_pd(pose->eye_x);
+    __m128d eye_y = _mm_set1_pd(pose->eye_y);
+    __m128d eye_z = _mm_set1_pd(pose->eye_z);
+    __m128d actual_yaw = _mm_set1_pd(pose->yaw);
+    __m128d actual_pitch = _mm_set1_pd(pose->pitch);
+    
+    __m128d best = _mm_set1_pd(INFINITY);
+    __m128d best_index = _mm_set1_pd(-1.0);
+    __m128d index = _mm_set_pd(1.0, 0.0);
+    
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(&t[0][i]), eye_x);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(&t[1][i]), eye_y);
+        __m128d dz = _mm_sub_pd(_mm_loadu_pd(&t[2][i]), eye_z);
+        
+        __m128d horiz = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dz, dz)));
+        __m128d yaw = _mm_mul_pd(sse2_atan2_poly(_mm_xor_pd(dx, sign), dz), rad_to_deg);
+        __m128d pitch = _mm_mul_pd(_mm_xor_pd(sse2_atan2_poly(dy, horiz), sign), rad_to_deg);
+        
+        __m128d yaw_diff = _mm_sub_pd(actual_yaw, yaw);
+        __m128d turns = _mm_mul_pd(yaw_diff, _mm_set1_pd(1.0 / 360.0));
+        turns = _mm_sub_pd(_mm_add_pd(turns, magic), magic);
+        yaw_diff = _mm_sub_pd(yaw_diff, _mm_mul_pd(turns, _mm_set1_pd(360.0)));
+        __m128d pitch_diff = _mm_sub_pd(actual_pitch, pitch);
+        __m128d error = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(yaw_diff, yaw_diff),
+                                               _mm_mul_pd(pitch_diff, pitch_diff)));
+        
+        if (out_yaw) _mm_storeu_pd(&out_yaw[i], yaw);
+        if (out_pitch) _mm_storeu_pd(&out_pitch[i], pitch);
+        if (out_error) _mm_storeu_pd(&out_error[i], error);
+        
+        __m128d better = _mm_cmplt_pd(error, best);
+        best = sse2_select(better, error, best);
+        best_index = sse2_select(better, index, best_index);
+        index = _mm_add_pd(index, _mm_set1_pd(2.0));
+    }
+    
+    double lane_best[2], lane_index[2];
+    _mm_storeu_pd(lane_best, best);
+    _mm_storeu_pd(lane_index, best_index);
+    
+    double min_error = INFINITY;
+    int64_t min_index = -1;
+    aim_reduce_lanes(lane_best, lane_index, 2, &min_error, &min_index);
+    scalar_aim_error_tail(pose, t, i, count, out_yaw, out_pitch, out_error, &min_error, &min_index);
+    return min_index;
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d avx2_atan2_poly(__m256d y, __m256d x) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d ax = _mm256_andnot_pd(sign, x);
+    __m256d ay = _mm256_andnot_pd(sign, y);
+    __m256d hi = _mm256_max_pd(ax, ay);
+    __m256d lo = _mm256_min_pd(ax, ay);
+    __m256d a = _mm256_div_pd(lo, _mm256_max_pd(hi, _mm256_set1_pd(AIM_TINY)));
+    __m256d s = _mm256_mul_pd(a, a);
+    
+    __m256d p = _mm256_set1_pd(ATAN_C8);
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C7));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C6));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C5));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C4));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C3));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C2));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C1));
+    p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(ATAN_C0));
+    
+    __m256d r = _mm256_mul_pd(a, p);
+    r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(AIM_HALF_PI), r),
+                         _mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(AIM_PI), r),
+                         _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ));
+    return _mm256_or_pd(r, _mm256_and_pd(y, sign));
+}
+
+__attribute__((target("avx2,fma")))
+static int64_t avx2_aim_error(const macac_aim_pose* pose, const double* const* t, size_t count,
+                              double* out_yaw, double* out_pitch, double* out_error) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d rad_to_deg = _mm256_set1_pd(AIM_RAD_TO_DEG);
+    __m256d eye_x = _mm256_set1_pd(pose->eye_x);
+    __m256d eye_y = _mm256_set1_pd(pose->eye_y);
+    __m256d eye_z = _mm256_set1_pd(pose->eye_z);
+    __m256d actual_yaw = _mm256_set1_pd(pose->yaw);
+    __m256d actual_pitch = _mm256_set1_pd(pose->pitch);
+    
+    __m256d best = _mm256_set1_pd(INFINITY);
+    __m256d best_index = _mm256_set1_pd(-1.0);
+    __m256d index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(&t[0][i]), eye_x);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(&t[1][i]), eye_y);
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(&t[2][i]), eye_z);
+        
+        __m256d horiz = _mm256_sqrt_pd(_mm256_fmadd_pd(dz, dz, _mm256_mul_pd(dx, dx)));
+        __m256d yaw = _mm256_mul_pd(avx2_atan2_poly(_mm256_xor_pd(dx, sign), dz), rad_to_deg);
+        __m256d pitch = _mm256_mul_pd(_mm256_xor_pd(avx2_atan2_poly(dy, horiz), sign), rad_to_deg);
+        
+        __m256d yaw_diff = _mm256_sub_pd(actual_yaw, yaw);
+        __m256d turns = _mm256_round_pd(_mm256_mul_pd(yaw_diff, _mm256_set1_pd(1.0 / 360.0)),
+                                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        yaw_diff = _mm256_fnmadd_pd(turns, _mm256_set1_pd(360.0), yaw_diff);
+        __m256d pitch_diff = _mm256_sub_pd(actual_pitch, pitch);
+        __m256d error = _mm256_sqrt_pd(_mm256_fmadd_pd(pitch_diff, pitch_diff,
+                                                       _mm256_mul_pd(yaw_diff, yaw_diff)));
+        
+        if (out_yaw) _mm256_storeu_pd(&out_yaw[i], yaw);
+        if (out_pitch) _mm256_storeu_pd(&out_pitch[i], pitch);
+        if (out_error) _mm256_storeu_pd(&out_error[i], error);
+        
+        __m256d better = _mm256_cmp_pd(error, best, _CMP_LT_OQ);
+        best = _mm256_blendv_pd(best, error, better);
+        best_index = _mm256_blendv_pd(best_index, index, better);
+        index = _mm256_add_pd(index, _mm256_set1_pd(4.0));
+    }
+    
+    double lane_best[4], lane_index[4];
+    _mm256_storeu_pd(lane_best, best);
+    _mm256_storeu_pd(lane_index, best_index);
+    
+    double min_error = INFINITY;
+    int64_t min_index = -1;
+    aim_reduce_lanes(lane_best, lane_index, 4, &min_error, &min_index);
+    scalar_aim_error_tail(pose, t, i, count, out_yaw, out_pitch, out_error, &min_error, &min_index);
+    return min_index;
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d avx512_atan2_poly(__m512d y, __m512d x) {
+    const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+    __m512d ax = _mm512_abs_pd(x);
+    __m512d ay = _mm512_abs_pd(y);
+    __m512d hi = _mm512_maskz_max_pd(0xFF, ax, ay);
+    __m512d lo = _mm512_maskz_min_pd(0xFF, ax, ay);
+    __m512d a = _mm512_div_pd(lo, _mm512_maskz_max_pd(0xFF, hi, _mm512_set1_pd(AIM_TINY)));
+    __m512d s = _mm512_mul_pd(a, a);
+    
+    __m512d p = _mm512_set1_pd(ATAN_C8);
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C7));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C6));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C5));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C4));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C3));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C2));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C1));
+    p = _mm512_fmadd_pd(p, s, _mm512_set1_pd(ATAN_C0));
+    
+    __m512d r = _mm512_mul_pd(a, p);
+    r = _mm512_mask_sub_pd(r, _mm512_cmp_pd_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_pd(AIM_HALF_PI), r);
+    r = _mm512_mask_sub_pd(r, _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_LT_OQ),
+                           _mm512_set1_pd(AIM_PI), r);
+    __m512i bits = _mm512_or_epi64(_mm512_castpd_si512(r),
+                                   _mm512_and_epi64(_mm512_castpd_si512(y), sign));
+    return _mm512_castsi512_pd(bits);
+}
+
+/**
+ * Eight targets per iteration; the tail is a masked iteration whose
+ * inactive lanes are kept out of the argmin.
+ */
+__attribute__((target("avx512f")))
+static int64_t avx512_aim_error(const macac_aim_pose* pose, const double* const* t, size_t count,
+                                double* out_yaw, double* out_pitch, double* out_error) {
+    const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+    const __m512d rad_to_deg = _mm512_set1_pd(AIM_RAD_TO_DEG);
+    __m512d eye_x = _mm512_set1_pd(pose->eye_x);
+    __m512d eye_y = _mm512_set1_pd(pose->eye_y);
+    __m512d eye_z = _mm512_set1_pd(pose->eye_z);
+    __m512d actual_yaw = _mm512_set1_pd(pose->yaw);
+    __m512d actual_pitch = _mm512_set1_pd(pose->pitch);
+    
+    __m512d best = _mm512_set1_pd(INFINITY);
+    __m512d best_index = _mm512_set1_pd(-1.0);
+    __m512d index = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    
+    for (size_t i = 0; i < count; i += 8) {
+        size_t left = count - i;
+        __mmask8 m = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &t[0][i]), eye_x);
+        __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &t[1][i]), eye_y);
+        __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &t[2][i]), eye_z);
+        
+        __m512d neg_dx = _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(dx), sign));
+        __m512d horiz = _mm512_maskz_sqrt_pd(0xFF, _mm512_fmadd_pd(dz, dz, _mm512_mul_pd(dx, dx)));
+        __m512d yaw = _mm512_mul_pd(avx512_atan2_poly(neg_dx, dz), rad_to_deg);
+        __m512d pitch = _mm512_mul_pd(avx512_atan2_poly(dy, horiz), _mm512_set1_pd(-AIM_RAD_TO_DEG));
+        
+        __m512d yaw_diff = _mm512_sub_pd(actual_yaw, yaw);
+        __m512d turns = _mm512_maskz_roundscale_pd(0xFF, _mm512_mul_pd(yaw_diff, _mm512_set1_pd(1.0 / 360.0)),
+                                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        yaw_diff = _mm512_fnmadd_pd(turns, _mm512_set1_pd(360.0), yaw_diff);
+        __m512d pitch_diff = _mm512_sub_pd(actual_pitch, pitch);
+        __m512d error = _mm512_maskz_sqrt_pd(0xFF, _mm512_fmadd_pd(pitch_diff, pitch_diff,
+                                                                   _mm512_mul_pd(yaw_diff, yaw_diff)));
+        
+        if (out_yaw) _mm512_mask_storeu_pd(&out_yaw[i], m, yaw);
+        if (out_pitch) _mm512_mask_storeu_pd(&out_pitch[i], m, pitch);
+        if (out_error) _mm512_mask_storeu_pd(&out_error[i], m, error);
+        
+        __mmask8 better = _mm512_mask_cmp_pd_mask(m, error, best, _CMP_LT_OQ);
+        best = _mm512_mask_blend_pd(better, best, error);
+        best_index = _mm512_mask_blend_pd(better, best_index, index);
+        index = _mm512_add_pd(index, _mm512_set1_pd(8.0));
+    }
+    
+    double lane_best[8], lane_index[8];
+    _mm512_storeu_pd(lane_best, best);
+    _mm512_storeu_pd(lane_index, best_index);
+    
+    double min_error = INFINITY;
+    int64_t min_index = -1;
+    aim_reduce_lanes(lane_best, lane_index, 8, &min_error, &min_index);
+    return min_index;
+}
+
+#endif // MACAC_SIMD_X86
+
+// ============================================================================
+// AArch64 Kernels (NEON)
+// ============================================================================
+
+#if MACAC_SIMD_NEON
+
+static double neon_sum(const double* data, size_t count) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc0 = vaddq_f64(acc0, vld1q_f64(&data[i]));
+        acc1 = vaddq_f64(acc1, vld1q_f64(&data[i + 2]));
+    }
+    
+    double sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < count; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static double neon_sum_sq_dev(const double* data, size_t count, double mean) {
+    float64x2_t mean_vec = vdupq_n_f64(mean);
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float64x2_t d0 = vsubq_f64(vld1q_f64(&data[i]), mean_vec);
+        float64x2_t d1 = vsubq_f64(vld1q_f64(&data[i + 2]), mean_vec);
+        acc0 = vaddq_f64(acc0, vmulq_f64(d0, d0));
+        acc1 = vaddq_f64(acc1, vmulq_f64(d1, d1));
+    }
+    
+    double sum_sq = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < count; i++) {
+        double diff = data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sum_sq;
+}
+
+/**
+ * vminnm/vmaxnm skip NaN samples like the scalar compares (vmin/vmax would
+ * propagate them).
+ */
+static void neon_moments(const double* data, size_t count, double* out) {
+    float64x2_t shift = vdupq_n_f64(data[0]);
+    float64x2_t s1a = vdupq_n_f64(0.0), s1b = vdupq_n_f64(0.0);
+    float64x2_t s2a = vdupq_n_f64(0.0), s2b = vdupq_n_f64(0.0);
+    float64x2_t mna = shift, mnb = shift, mxa = shift, mxb = shift;
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float64x2_t x0 = vld1q_f64(&data[i]);
+        float64x2_t x1 = vld1q_f64(&data[i + 2]);
+        float64x2_t d0 = vsubq_f64(x0, shift);
+        float64x2_t d1 = vsubq_f64(x1, shift);
+        s1a = vaddq_f64(s1a, d0);
+        s1b = vaddq_f64(s1b, d1);
+        s2a = vfmaq_f64(s2a, d0, d0);
+        s2b = vfmaq_f64(s2b, d1, d1);
+        mna = vminnmq_f64(mna, x0);
+        mnb = vminnmq_f64(mnb, x1);
+        mxa = vmaxnmq_f64(mxa, x0);
+        mxb = vmaxnmq_f64(mxb, x1);
+    }
+    
+    out[0] = vaddvq_f64(vaddq_f64(s1a, s1b));
+    out[1] = vaddvq_f64(vaddq_f64(s2a, s2b));
+    out[2] = vminnmvq_f64(vminnmq_f64(mna, mnb));
+    out[3] = vmaxnmvq_f64(vmaxnmq_f64(mxa, mxb));
+    scalar_moments_tail(data, i, count, data[0], out);
+}
+
+static inline void neon_describe_step(float64x2_t x, float64x2_t shift, float64x2_t* s,
+                                      float64x2_t* mn, float64x2_t* mx) {
+    float64x2_t d = vsubq_f64(x, shift);
+    float64x2_t q = vmulq_f64(d, d);
+    s[0] = vaddq_f64(s[0], d);
+    s[1] = vaddq_f64(s[1], q);
+    s[2] = vfmaq_f64(s[2], q, d);
+    s[3] = vfmaq_f64(s[3], q, q);
+    *mn = vminnmq_f64(*mn, x);
+    *mx = vmaxnmq_f64(*mx, x);
+}
+
+static void neon_describe_block(const double* data, size_t count, double shift, double* out) {
+    float64x2_t sh = vdupq_n_f64(shift);
+    float64x2_t first = vdupq_n_f64(data[0]);
+    float64x2_t sa[4], sb[4];
+    for (int k = 0; k < 4; k++) {
+        sa[k] = vdupq_n_f64(0.0);
+        sb[k] = vdupq_n_f64(0.0);
+    }
+    float64x2_t mna = first, mnb = first, mxa = first, mxb = first;
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        neon_describe_step(vld1q_f64(&data[i]), sh, sa, &mna, &mxa);
+        neon_describe_step(vld1q_f64(&data[i + 2]), sh, sb, &mnb, &mxb);
+    }
+    
+    for (int k = 0; k < 4; k++) {
+        out[k] = vaddvq_f64(vaddq_f64(sa[k], sb[k]));
+    }
+    out[4] = vminnmvq_f64(vminnmq_f64(mna, mnb));
+    out[5] = vmaxnmvq_f64(vmaxnmq_f64(mxa, mxb));
+    scalar_describe_tail(data, i, count, shift, out);
+}
+
+static void neon_describe(const double* data, size_t count, double* out) {
+    describe_blocks(neon_describe_block, data, count, out);
+}
+
+static void neon_combat_moments(const double* const* c, size_t count, double* out) {
+    const double* aim = c[MACAC_COMBAT_AIM_ERROR];
+    const double* snap = c[MACAC_COMBAT_SNAP_ANGLE];
+    const double* reach = c[MACAC_COMBAT_REACH];
+    const double* interval = c[MACAC_COMBAT_ATTACK_INTERVAL];
+    const double* hit = c[MACAC_COMBAT_HIT];
+    float64x2_t aim0 = vdupq_n_f64(aim[0]);
+    float64x2_t interval0 = vdupq_n_f64(interval[0]);
+    float64x2_t acc[7];
+    for (int k = 0; k < 7; k++) {
+        acc[k] = vdupq_n_f64(0.0);
+    }
+    
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t da = vsubq_f64(vld1q_f64(&aim[i]), aim0);
+        float64x2_t di = vsubq_f64(vld1q_f64(&interval[i]), interval0);
+        acc[MACAC_COMBAT_AIM_ERROR] = vaddq_f64(acc[MACAC_COMBAT_AIM_ERROR], da);
+        acc[MACAC_COMBAT_SNAP_ANGLE] = vaddq_f64(acc[MACAC_COMBAT_SNAP_ANGLE], vld1q_f64(&snap[i]));
+        acc[MACAC_COMBAT_REACH] = vaddq_f64(acc[MACAC_COMBAT_REACH], vld1q_f64(&reach[i]));
+        acc[MACAC_COMBAT_ATTACK_INTERVAL] = vaddq_f64(acc[MACAC_COMBAT_ATTACK_INTERVAL], di);
+        acc[MACAC_COMBAT_HIT] = vaddq_f64(acc[MACAC_COMBAT_HIT], vld1q_f64(&hit[i]));
+        acc[5] = vfmaq_f64(acc[5], da, da);
+        acc[6] = vfmaq_f64(acc[6], di, di);
+    }
+    
+    for (int k = 0; k < 7; k++) {
+        out[k] = vaddvq_f64(acc[k]);
+    }
+    scalar_combat_moments_tail(c, i, count, out);
+}
+
+/**
+ * Two distances per iteration: vld3q splits each record's two points into
+ * x/y/z lanes, then uzp pairs first and second points across records.
+ */
+static void neon_distance_3d(const double* coords, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2x3_t a = vld3q_f64(&coords[i * 6]);        // {x1,x2} {y1,y2} {z1,z2}
+        float64x2x3_t b = vld3q_f64(&coords[i * 6 + 6]);
+        
+        float64x2_t dx = vsubq_f64(vuzp2q_f64(a.val[0], b.val[0]), vuzp1q_f64(a.val[0], b.val[0]));
+        float64x2_t dy = vsubq_f64(vuzp2q_f64(a.val[1], b.val[1]), vuzp1q_f64(a.val[1], b.val[1]));
+        float64x2_t dz = vsubq_f64(vuzp2q_f64(a.val[2], b.val[2]), vuzp1q_f64(a.val[2], b.val[2]));
+        
+        // Separate mul/add (no FMA) to round like the scalar path
+        float64x2_t sum = vaddq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), vmulq_f64(dz, dz));
+        vst1q_f64(&distances[i], vsqrtq_f64(sum));
+    }
+    
+    for (; i < count; i++) {
+        distances[i] = scalar_distance(&coords[i * 6]);
+    }
+}
+
+static void neon_distance_3d_soa(const double* const* c, double* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(&c[3][i]), vld1q_f64(&c[0][i]));
+        float64x2_t dy = vsubq_f64(vld1q_f64(&c[4][i]), vld1q_f64(&c[1][i]));
+        float64x2_t dz = vsubq_f64(vld1q_f64(&c[5][i]), vld1q_f64(&c[2][i]));
+        float64x2_t sum = vfmaq_f64(vfmaq_f64(vmulq_f64(dx, dx), dy, dy), dz, dz);
+        vst1q_f64(&distances[i], vsqrtq_f64(sum));
+    }
+    
+    scalar_distance_3d_soa_tail(c, distances, i, count);
+}
+
+static void neon_distance_3d_soa_f32(const float* const* c, float* distances, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t dx = vsubq_f32(vld1q_f32(&c[3][i]), vld1q_f32(&c[0][i]));
+        float32x4_t dy = vsubq_f32(vld1q_f32(&c[4][i]), vld1q_f32(&c[1][i]));
+        float32x4_t dz = vsubq_f32(vld1q_f32(&c[5][i]), vld1q_f32(&c[2][i]));
+        float32x4_t sum = vfmaq_f32(vfmaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz);
+        vst1q_f32(&distances[i], vsqrtq_f32(sum));
+    }
+    
+    scalar_distance_3d_soa_f32_tail(c, distances, i, count);
+}
+
+static inline float64x2_t neon_atan2_poly(float64x2_t y, float64x2_t x) {
+    float64x2_t ax = vabsq_f64(x);
+    float64x2_t ay = vabsq_f64(y);
+    float64x2_t hi = vmaxq_f64(ax, ay);
+    float64x2_t lo = vminq_f64(ax, ay);
+    float64x2_t a = vdivq_f64(lo, vmaxq_f64(hi, vdupq_n_f64(AIM_TINY)));
+    float64x2_t s = vmulq_f64(a, a);
+    
+    float64x2_t p = vdupq_n_f64(ATAN_C8);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C7), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C6), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C5), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C4), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C3), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C2), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C1), p, s);
+    p = vfmaq_f64(vdupq_n_f64(ATAN_C0), p, s);
+    
+    float64x2_t r = vmulq_f64(a, p);
+    r = vbslq_f64(vcgtq_f64(ay, ax), vsubq_f64(vdupq_n_f64(AIM_HALF_PI), r), r);
+    r = vbslq_f64(vcltq_f64(x, vdupq_n_f64(0.0)), vsubq_f64(vdupq_n_f64(AIM_PI), r), r);
+    uint64x2_t sign = vandq_u64(vreinterpretq_u64_f64(y), vdupq_n_u64(0x8000000000000000ULL));
+    return vreinterpretq_f64_u64(vorrq_u64(vreinterpretq_u64_f64(r), sign));
+}
+
+static int64_t neon_aim_error(const macac_aim_pose* pose, const double* const* t, size_t count,
+                              double* out_yaw, double* out_pitch, double* out_error) {
+    const float64x2_t rad_to_deg = vdupq_n_f64(AIM_RAD_TO_DEG);
+    float64x2_t eye_x = vdupq_n_f64(pose->eye_x);
+    float64x2_t eye_y = vdupq_n_f64(pose->eye_y);
+    float64x2_t eye_z = vdupq_n_f64(pose->eye_z);
+    float64x2_t actual_yaw = vdupq_n_f64(pose->yaw);
+    float64x2_t actual_pitch = vdupq_n_f64(pose->pitch);
+    
+    float64x2_t best = vdupq_n_f64(INFINITY);
+    float64x2_t best_index = vdupq_n_f64(-1.0);
+    const double first_index[2] = { 0.0, 1.0 };
+    float64x2_t index = vld1q_f64(first_index);
+    
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(&t[0][i]), eye_x);
+        float64x2_t dy = vsubq_f64(vld1q_f64(&t[1][i]), eye_y);
+        float64x2_t dz = vsubq_f64(vld1q_f64(&t[2][i]), eye_z);
+        
+        float64x2_t horiz = vsqrtq_f64(vfmaq_f64(vmulq_f64(dx, dx), dz, dz));
+        float64x2_t yaw = vmulq_f64(neon_atan2_poly(vnegq_f64(dx), dz), rad_to_deg);
+        float64x2_t pitch = vmulq_f64(vnegq_f64(neon_atan2_poly(dy, horiz)), rad_to_deg);
+        
+        float64x2_t yaw_diff = vsubq_f64(actual_yaw, yaw);
+        float64x2_t turns = vrndnq_f64(vmulq_f64(yaw_diff, vdupq_n_f64(1.0 / 360.0)));
+        yaw_diff = vfmsq_f64(yaw_diff, turns, vdupq_n_f64(360.0));
+        float64x2_t pitch_diff = vsubq_f64(actual_pitch, pitch);
+        float64x2_t error = vsqrtq_f64(vfmaq_f64(vmulq_f64(yaw_diff, yaw_diff), pitch_diff, pitch_diff));
+        
+        if (out_yaw) vst1q_f64(&out_yaw[i], yaw);
+        if (out_pitch) vst1q_f64(&out_pitch[i], pitch);
+        if (out_error) vst1q_f64(&out_error[i], error);
+        
+        uint64x2_t better = vcltq_f64(error, best);
+        best = vbslq_f64(better, error, best);
+        best_index = vbslq_f64(better, index, best_index);
+        index = vaddq_f64(index, vdupq_n_f64(2.0));
+    }
+    
+    double lane_best[2], lane_index[2];
+    vst1q_f64(lane_best, best);
+    vst1q_f64(lane_index, best_index);
+    
+    double min_error = INFINITY;
+    int64_t min_index = -1;
+    aim_reduce_lanes(lane_best, lane_index, 2, &min_error, &min_index);
+    scalar_aim_error_tail(pose, t, i, count, out_yaw, out_pitch, out_error, &min_error, &min_index);
+    return min_index;
+}
+
+#endif // MACAC_SIMD_NEON
+
+// ============================================================================
+// FFT Butterfly Kernels
+// ============================================================================
+
+/*
+ * Stages narrower than a vector (half < lanes) fall back to the next
+ * narrower ISA, ending at scalar; spectral.cpp only runs n <= 256, so
+ * those first stages are a small share of the butterflies.
+ */
+
+static void scalar_fft_stage(double* re, double* im, size_t n, size_t half, const double* wr,
+                             const double* wi) {
+    for (size_t block = 0; block < n; block += 2 * half) {
+        double* ar = re + block;
+        double* ai = im + block;
+        double* br = ar + half;
+        double* bi = ai + half;
+        for (size_t j = 0; j < half; j++) {
+            double tr = br[j] * wr[j] - bi[j] * wi[j];
+            double ti = br[j] * wi[j] + bi[j] * wr[j];
+            br[j] = ar[j] - tr;
+            bi[j] = ai[j] - ti;
+            ar[j] += tr;
+            ai[j] += ti;
+        }
+    }
+}
+
+#if MACAC_SIMD_X86
+
+__attribute__((target("sse2")))
+static void sse2_fft_stage(double* re, double* im, size_t n, size_t half, const double* wr,
+                           const double* wi) {
+    if (half < 2) {
+        scalar_fft_stage(re, im, n, half, wr, wi);
+        return;
+    }
+    for (size_t block = 0; block < n; block += 2 * half) {
+        double* ar = re + block;
+        double* ai = im + block;
+        double* br = ar + half;
+        double* bi = ai + half;
+        for (size_t j = 0; j < half; j += 2) {
+            __m128d w_r = _mm_loadu_pd(&wr[j]);
+            __m128d w_i = _mm_loadu_pd(&wi[j]);
+            __m128d xr = _mm_loadu_pd(&br[j]);
+            __m128d xi = _mm_loadu_pd(&bi[j]);
+            __m128d tr = _mm_sub_pd(_mm_mul_pd(xr, w_r), _mm_mul_pd(xi, w_i));
+            __m128d ti = _mm_add_pd(_mm_mul_pd(xr, w_i), _mm_mul_pd(xi, w_r));
+            __m128d yr = _mm_loadu_pd(&ar[j]);
+            __m128d yi = _mm_loadu_pd(&ai[j]);
+            _mm_storeu_pd(&br[j], _mm_sub_pd(yr, tr));
+            _mm_storeu_pd(&bi[j], _mm_sub_pd(yi, ti));
+            _mm_storeu_pd(&ar[j], _mm_add_pd(yr, tr));
+            _mm_storeu_pd(&ai[j], _mm_add_pd(yi, ti));
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_fft_stage(double* re, double* im, size_t n, size_t half, const double* wr,
+                           const double* wi) {
+    if (half < 4) {
+        sse2_fft_stage(re, im, n, half, wr, wi);
+        return;
+    }
+    for (size_t block = 0; block < n; block += 2 * half) {
+        double* ar = re + block;
+        double* ai = im + block;
+        double* br = ar + half;
+        double* bi = ai + half;
+        for (size_t j = 0; j < half; j += 4) {
+            __m256d w_r = _mm256_loadu_pd(&wr[j]);
+            __m256d w_i = _mm256_loadu_pd(&wi[j]);
+            __m256d xr = _mm256_loadu_pd(&br[j]);
+            __m256d xi = _mm256_loadu_pd(&bi[j]);
+            __m256d tr = _mm256_fmsub_pd(xr, w_r, _mm256_mul_pd(xi, w_i));
+            __m256d ti = _mm256_fmadd_pd(xr, w_i, _mm256_mul_pd(xi, w_r));
+            __m256d yr = _mm256_loadu_pd(&ar[j]);
+            __m256d yi = _mm256_loadu_pd(&ai[j]);
+            _mm256_storeu_pd(&br[j], _mm256_sub_pd(yr, tr));
+            _mm256_storeu_pd(&bi[j], _mm256_sub_pd(yi, ti));
+            _mm256_storeu_pd(&ar[j], _mm256_add_pd(yr, tr));
+            _mm256_storeu_pd(&ai[j], _mm256_add_pd(yi, ti));
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512_fft_stage(double* re, double* im, size_t n, size_t half, const double* wr,
+                             const double* wi) {
+    if (half < 8) {
+        avx2_fft_stage(re, im, n, half, wr, wi);
+        return;
+    }
+    for (size_t block = 0; block < n; block += 2 * half) {
+        double* ar = re + block;
+        double* ai = im + block;
+        double* br = ar + half;
+        double* bi = ai + half;
+        for (size_t j = 0; j < half; j += 8) {
+            __m512d w_r = _mm512_loadu_pd(&wr[j]);
+            __m512d w_i = _mm512_loadu_pd(&wi[j]);
+            __m512d xr = _mm512_loadu_pd(&br[j]);
+            __m512d xi = _mm512_loadu_pd(&bi[j]);
+            __m512d tr = _mm512_fmsub_pd(xr, w_r, _mm512_mul_pd(xi, w_i));
+            __m512d ti = _mm512_fmadd_pd(xr, w_i, _mm512_mul_pd(xi, w_r));
+            __m512d yr = _mm512_loadu_pd(&ar[j]);
+            __m512d yi = _mm512_loadu_pd(&ai[j]);
+            _mm512_storeu_pd(&br[j], _mm512_sub_pd(yr, tr));
+            _mm512_storeu_pd(&bi[j], _mm512_sub_pd(yi, ti));
+            _mm512_storeu_pd(&ar[j], _mm512_add_pd(yr, tr));
+            _mm512_storeu_pd(&ai[j], _mm512_add_pd(yi, ti));
+        }
+    }
+}
+
+#endif // MACAC_SIMD_X86
+
+#if MACAC_SIMD_NEON
+
+static void neon_fft_stage(double* re, double* im, size_t n, size_t half, const double* wr,
+                           const double* wi) {
+    if (half < 2) {
+        scalar_fft_stage(re, im, n, half, wr, wi);
+        return;
+    }
+    for (size_t block = 0; block < n; block += 2 * half) {
+        double* ar = re + block;
+        double* ai = im + block;
+        double* br = ar + half;
+        double* bi = ai + half;
+        for (size_t j = 0; j < half; j += 2) {
+            float64x2_t w_r = vld1q_f64(&wr[j]);
+            float64x2_t w_i = vld1q_f64(&wi[j]);
+            float64x2_t xr = vld1q_f64(&br[j]);
+            float64x2_t xi = vld1q_f64(&bi[j]);
+            float64x2_t tr = vfmsq_f64(vmulq_f64(xr, w_r), xi, w_i);
+            float64x2_t ti = vfmaq_f64(vmulq_f64(xr, w_i), xi, w_r);
+            float64x2_t yr = vld1q_f64(&ar[j]);
+            float64x2_t yi = vld1q_f64(&ai[j]);
+            vst1q_f64(&br[j], vsubq_f64(yr, tr));
+            vst1q_f64(&bi[j], vsubq_f64(yi, ti));
+            vst1q_f64(&ar[j], vaddq_f64(yr, tr));
+            vst1q_f64(&ai[j], vaddq_f64(yi, ti));
+        }
+    }
+}
+
+#endif // MACAC_SIMD_NEON
+
+// ============================================================================
+// Movement Step Kernels
+// ============================================================================
+
+/*
+ * Separate mul/add and a select for the ground case, so every ISA rounds
+ * exactly like the scalar loop (and like the same formula in Java).
+ * Players are independent, so the vector loops just run lanes of them.
+ */
+
+/**
+ * Players [start, count); also finishes the vector kernels' remainders.
+ */
+static inline void scalar_movement_step_tail(const double* const* in, double* const* out,
+                                             size_t start, size_t count) {
+    for (size_t i = start; i < count; i++) {
+        double friction = in[MACAC_MOVE_FRICTION][i];
+        double px = in[MACAC_MOVE_VX][i] * friction;
+        double pz = in[MACAC_MOVE_VZ][i] * friction;
+        double py = in[MACAC_MOVE_GROUND][i] != 0.0
+                    ? 0.0
+                    : (in[MACAC_MOVE_VY][i] - in[MACAC_MOVE_GRAVITY][i]) * in[MACAC_MOVE_DRAG][i];
+        double ex = in[MACAC_MOVE_DX][i] - px;
+        double ey = in[MACAC_MOVE_DY][i] - py;
+        double ez = in[MACAC_MOVE_DZ][i] - pz;
+        out[MACAC_MOVE_PREDICTED_X][i] = px;
+        out[MACAC_MOVE_PREDICTED_Y][i] = py;
+        out[MACAC_MOVE_PREDICTED_Z][i] = pz;
+        out[MACAC_MOVE_DRIFT_X][i] = ex;
+        out[MACAC_MOVE_DRIFT_Y][i] = ey;
+        out[MACAC_MOVE_DRIFT_Z][i] = ez;
+        out[MACAC_MOVE_DRIFT][i] = sqrt(ex*ex + ey*ey + ez*ez);
+    }
+}
+
+static void scalar_movement_step(const double* const* in, double* const* out, size_t count) {
+    scalar_movement_step_tail(in, out, 0, count);
+}
+
+#if MACAC_SIMD_X86
+
+__attribute__((target("sse2")))
+static void sse2_movement_step(const double* const* in, double* const* out, size_t count) {
+    const __m128d zero = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d friction = _mm_loadu_pd(&in[MACAC_MOVE_FRICTION][i]);
+        __m128d px = _mm_mul_pd(_mm_loadu_pd(&in[MACAC_MOVE_VX][i]), friction);
+        __m128d pz = _mm_mul_pd(_mm_loadu_pd(&in[MACAC_MOVE_VZ][i]), friction);
+        __m128d fall = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(&in[MACAC_MOVE_VY][i]),
+                                             _mm_loadu_pd(&in[MACAC_MOVE_GRAVITY][i])),
+                                  _mm_loadu_pd(&in[MACAC_MOVE_DRAG][i]));
+        __m128d ground = _mm_cmpneq_pd(_mm_loadu_pd(&in[MACAC_MOVE_GROUND][i]), zero);
+        __m128d py = _mm_andnot_pd(ground, fall);
+        __m128d ex = _mm_sub_pd(_mm_loadu_pd(&in[MACAC_MOVE_DX][i]), px);
+        __m128d ey = _mm_sub_pd(_mm_loadu_pd(&in[MACAC_MOVE_DY][i]), py);
+        __m128d ez = _mm_sub_pd(_mm_loadu_pd(&in[MACAC_MOVE_DZ][i]), pz);
+        __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey)), _mm_mul_pd(ez, ez));
+        _mm_storeu_pd(&out[MACAC_MOVE_PREDICTED_X][i], px);
+        _mm_storeu_pd(&out[MACAC_MOVE_PREDICTED_Y][i], py);
+        _mm_storeu_pd(&out[MACAC_MOVE_PREDICTED_Z][i], pz);
+        _mm_storeu_pd(&out[MACAC_MOVE_DRIFT_X][i], ex);
+        _mm_storeu_pd(&out[MACAC_MOVE_DRIFT_Y][i], ey);
+        _mm_storeu_pd(&out[MACAC_MOVE_DRIFT_Z][i], ez);
+        _mm_storeu_pd(&out[MACAC_MOVE_DRIFT][i], _mm_sqrt_pd(sum));
+    }
+    
+    scalar_movement_step_tail(in, out, i, count);
+}
+
+__attribute__((target("avx2")))
+static void avx2_movement_step(const double* const* in, double* const* out, size_t count) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d friction = _mm256_loadu_pd(&in[MACAC_MOVE_FRICTION][i]);
+        __m256d px = _mm256_mul_pd(_mm256_loadu_pd(&in[MACAC_MOVE_VX][i]), friction);
+        __m256d pz = _mm256_mul_pd(_mm256_loadu_pd(&in[MACAC_MOVE_VZ][i]), friction);
+        __m256d fall = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(&in[MACAC_MOVE_VY][i]),
+                                                   _mm256_loadu_pd(&in[MACAC_MOVE_GRAVITY][i])),
+                                     _mm256_loadu_pd(&in[MACAC_MOVE_DRAG][i]));
+        __m256d ground = _mm256_cmp_pd(_mm256_loadu_pd(&in[MACAC_MOVE_GROUND][i]), zero, _CMP_NEQ_UQ);
+        __m256d py = _mm256_andnot_pd(ground, fall);
+        __m256d ex = _mm256_sub_pd(_mm256_loadu_pd(&in[MACAC_MOVE_DX][i]), px);
+        __m256d ey = _mm256_sub_pd(_mm256_loadu_pd(&in[MACAC_MOVE_DY][i]), py);
+        __m256d ez = _mm256_sub_pd(_mm256_loadu_pd(&in[MACAC_MOVE_DZ][i]), pz);
+        __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey)),
+                                    _mm256_mul_pd(ez, ez));
+        _mm256_storeu_pd(&out[MACAC_MOVE_PREDICTED_X][i], px);
+        _mm256_storeu_pd(&out[MACAC_MOVE_PREDICTED_Y][i], py);
+        _mm256_storeu_pd(&out[MACAC_MOVE_PREDICTED_Z][i], pz);
+        _mm256_storeu_pd(&out[MACAC_MOVE_DRIFT_X][i], ex);
+        _mm256_storeu_pd(&out[MACAC_MOVE_DRIFT_Y][i], ey);
+        _mm256_storeu_pd(&out[MACAC_MOVE_DRIFT_Z][i], ez);
+        _mm256_storeu_pd(&out[MACAC_MOVE_DRIFT][i], _mm256_sqrt_pd(sum));
+    }
+    
+    scalar_movement_step_tail(in, out, i, count);
+}
+
+/**
+ * Eight players per iteration; the tail is one masked iteration.
+ */
+__attribute__((target("avx512f")))
+static inline void avx512_movement_lanes(const double* const* in, double* const* out, size_t i,
+                                         __mmask8 m) {
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d friction = _mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_FRICTION][i]);
+    __m512d px = _mm512_mul_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_VX][i]), friction);
+    __m512d pz = _mm512_mul_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_VZ][i]), friction);
+    __m512d fall = _mm512_mul_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_VY][i]),
+                                               _mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_GRAVITY][i])),
+                                 _mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_DRAG][i]));
+    __mmask8 air = _mm512_cmp_pd_mask(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_GROUND][i]), zero, _CMP_EQ_OQ);
+    __m512d py = _mm512_maskz_mov_pd(air, fall);
+    __m512d ex = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_DX][i]), px);
+    __m512d ey = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_DY][i]), py);
+    __m512d ez = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, &in[MACAC_MOVE_DZ][i]), pz);
+    __m512d sum = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(ex, ex), _mm512_mul_pd(ey, ey)),
+                                _mm512_mul_pd(ez, ez));
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_PREDICTED_X][i], m, px);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_PREDICTED_Y][i], m, py);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_PREDICTED_Z][i], m, pz);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_DRIFT_X][i], m, ex);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_DRIFT_Y][i], m, ey);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_DRIFT_Z][i], m, ez);
+    _mm512_mask_storeu_pd(&out[MACAC_MOVE_DRIFT][i], m, _mm512_maskz_sqrt_pd(m, sum));
+}
+
+__attribute__((target("avx512f")))
+static void avx512_movement_step(const double* const* in, double* const* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        avx512_movement_lanes(in, out, i, 0xFF);
+    }
+    if (i < count) {
+        avx512_movement_lanes(in, out, i, (__mmask8)((1u << (count - i)) - 1));
+    }
+}
+
+#endif // MACAC_SIMD_X86
+
+#if MACAC_SIMD_NEON
+
+static void neon_movement_step(const double* const* in, double* const* out, size_t count) {
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t friction = vld1q_f64(&in[MACAC_MOVE_FRICTION][i]);
+        float64x2_t px = vmulq_f64(vld1q_f64(&in[MACAC_MOVE_VX][i]), friction);
+        float64x2_t pz = vmulq_f64(vld1q_f64(&in[MACAC_MOVE_VZ][i]), friction);
+        float64x2_t fall = vmulq_f64(vsubq_f64(vld1q_f64(&in[MACAC_MOVE_VY][i]),
+                                               vld1q_f64(&in[MACAC_MOVE_GRAVITY][i])),
+                                     vld1q_f64(&in[MACAC_MOVE_DRAG][i]));
+        uint64x2_t air = vceqq_f64(vld1q_f64(&in[MACAC_MOVE_GROUND][i]), zero);
+        float64x2_t py = vreinterpretq_f64_u64(vandq_u64(air, vreinterpretq_u64_f64(fall)));
+        float64x2_t ex = vsubq_f64(vld1q_f64(&in[MACAC_MOVE_DX][i]), px);
+        float64x2_t ey = vsubq_f64(vld1q_f64(&in[MACAC_MOVE_DY][i]), py);
+        float64x2_t ez = vsubq_f64(vld1q_f64(&in[MACAC_MOVE_DZ][i]), pz);
+        
+        // Separate mul/add (no FMA) to round like the scalar path
+        float64x2_t sum = vaddq_f64(vaddq_f64(vmulq_f64(ex, ex), vmulq_f64(ey, ey)), vmulq_f64(ez, ez));
+        vst1q_f64(&out[MACAC_MOVE_PREDICTED_X][i], px);
+        vst1q_f64(&out[MACAC_MOVE_PREDICTED_Y][i], py);
+        vst1q_f64(&out[MACAC_MOVE_PREDICTED_Z][i], pz);
+        vst1q_f64(&out[MACAC_MOVE_DRIFT_X][i], ex);
+        vst1q_f64(&out[MACAC_MOVE_DRIFT_Y][i], ey);
+        vst1q_f64(&out[MACAC_MOVE_DRIFT_Z][i], ez);
+        vst1q_f64(&out[MACAC_MOVE_DRIFT][i], vsqrtq_f64(sum));
+    }
+    
+    scalar_movement_step_tail(in, out, i, count);
+}
+
+#endif // MACAC_SIMD_NEON
+
+// ============================================================================
+// Kernel Tables
+// ============================================================================
+
+static const macac_simd_kernels SCALAR_KERNELS = {
+    MACAC_ISA_SCALAR, scalar_sum, scalar_sum_sq_dev,
+    scalar_sum_f32, scalar_sum_sq_dev_f32, scalar_sum_i16, scalar_sum_sq_dev_i16, scalar_distance_3d,
+    scalar_distance_3d_soa, scalar_distance_3d_soa_f32, scalar_moments, scalar_combat_moments,
+    scalar_aim_error, scalar_describe, scalar_fft_stage, scalar_movement_step
+};
+
+#if MACAC_SIMD_X86
+static const macac_simd_kernels SSE2_KERNELS = {
+    MACAC_ISA_SSE2, sse2_sum, sse2_sum_sq_dev,
+    scalar_sum_f32, scalar_sum_sq_dev_f32, scalar_sum_i16, scalar_sum_sq_dev_i16, sse2_distance_3d,
+    sse2_distance_3d_soa, sse2_distance_3d_soa_f32, sse2_moments, sse2_combat_moments,
+    sse2_aim_error, sse2_describe, sse2_fft_stage, sse2_movement_step
+};
+
+static const macac_simd_kernels AVX2_KERNELS = {
+    MACAC_ISA_AVX2, avx2_sum, avx2_sum_sq_dev,
+    avx2_sum_f32, avx2_sum_sq_dev_f32, avx2_sum_i16, avx2_sum_sq_dev_i16, avx2_distance_3d,
+    avx2_distance_3d_soa, avx2_distance_3d_soa_f32, avx2_moments, avx2_combat_moments,
+    avx2_aim_error, avx2_describe, avx2_fft_stage, avx2_movement_step
+};
+
+// AoS distances keep the AVX2 transpose: stride-6 gathers measured slower;
+// the int16 sum reuses the AVX2 kernel (no AVX-512 variant yet)
+static const macac_simd_kernels AVX512_KERNELS = {
+    MACAC_ISA_AVX512, avx512_sum, avx512_sum_sq_dev,
+    avx512_sum_f32, avx512_sum_sq_dev_f32, avx2_sum_i16, avx512_sum_sq_dev_i16, avx2_distance_3d,
+    avx512_distance_3d_soa, avx512_distance_3d_soa_f32, avx512_moments, avx512_combat_moments,
+    avx512_aim_error, avx512_describe, avx512_fft_stage, avx512_movement_step
+};
+#endif
+
+#if MACAC_SIMD_NEON
+static const macac_simd_kernels NEON_KERNELS = {
+    MACAC_ISA_NEON, neon_sum, neon_sum_sq_dev,
+    scalar_sum_f32, scalar_sum_sq_dev_f32, scalar_sum_i16, scalar_sum_sq_dev_i16, neon_distance_3d,
+    neon_distance_3d_soa, neon_distance_3d_soa_f32, neon_moments, neon_combat_moments,
+    neon_aim_error, neon_describe, neon_fft_stage, neon_movement_step
+};
+#endif
+
+static std::atomic<const macac_simd_kernels*> g_active{nullptr};
+static std::atomic<int> g_best_isa{-1};
+
+// ============================================================================
+// CPU Detection
+// ============================================================================
+
+#if MACAC_SIMD_X86
+
+static uint64_t read_xcr0(void) {
+    uint32_t lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+#endif
+
+/**
+ * Best ISA the CPU and OS both support. AVX/AVX-512 also require the OS to
+ * save the wider register state (XCR0), not just the CPUID feature bits.
+ */
+static int detect_isa(void) {
+#if MACAC_SIMD_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return MACAC_ISA_SCALAR;
+    }
+    
+    int isa = (edx & bit_SSE2) ? MACAC_ISA_SSE2 : MACAC_ISA_SCALAR;
+    
+    // The AVX2 kernels also use FMA (every AVX2 CPU has it)
+    bool fma = (ecx & bit_FMA) != 0;
+    bool osxsave = (ecx & bit_OSXSAVE) != 0;
+    bool avx = (ecx & bit_AVX) != 0;
+    if (!osxsave || !avx || isa == MACAC_ISA_SCALAR) {
+        return isa;
+    }
+    
+    uint64_t xcr0 = read_xcr0();
+    if ((xcr0 & 0x6) != 0x6) {
+        return isa;
+    }
+    
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return isa;
+    }
+    if ((ebx & bit_AVX2) && fma) {
+        isa = MACAC_ISA_AVX2;
+    }
+    if (isa == MACAC_ISA_AVX2 && (ebx & bit_AVX512F) && (xcr0 & 0xE6) == 0xE6) {
+        isa = MACAC_ISA_AVX512;
+    }
+    return isa;
+#elif MACAC_SIMD_NEON
+    // Advanced SIMD is mandatory on AArch64
+    return MACAC_ISA_NEON;
+#else
+    return MACAC_ISA_SCALAR;
+#endif
+}
+
+static int best_isa(void) {
+    int isa = g_best_isa.load(std::memory_order_acquire);
+    if (isa < 0) {
+        isa = detect_isa();
+        g_best_isa.store(isa, std::memory_order_release);
+    }
+    return isa;
+}
+
+static const macac_simd_kernels* kernels_for(int isa) {
+    switch (isa) {
+#if MACAC_SIMD_X86
+        case MACAC_ISA_AVX512: return &AVX512_KERNELS;
+        case MACAC_ISA_AVX2: return &AVX2_KERNELS;
+        case MACAC_ISA_SSE2: return &SSE2_KERNELS;
+#endif
+#if MACAC_SIMD_NEON
+        case MACAC_ISA_NEON: return &NEON_KERNELS;
+#endif
+        default: return &SCALAR_KERNELS;
+    }
+}
+
+const macac_simd_kernels* macac_simd_active(void) {
+    const macac_simd_kernels* k = g_active.load(std::memory_order_acquire);
+    if (!k) {
+        macac_cpu_init();
+        k = g_active.load(std::memory_order_acquire);
+    }
+    return k;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+extern "C" {
+
+void macac_cpu_init(void) {
+    // Racing initializers all store the same table
+    const macac_simd_kernels* expected = nullptr;
+    g_active.compare_exchange_strong(expected, kernels_for(best_isa()), std::memory_order_acq_rel);
+}
+
+int macac_cpu_isa(void) {
+    return macac_simd_active()->isa;
+}
+
+int macac_cpu_best_isa(void) {
+    return best_isa();
+}
+
+int macac_cpu_supports(int isa) {
+    if (isa == MACAC_ISA_SCALAR) {
+        return 1;
+    }
+    
+    int best = best_isa();
+#if MACAC_SIMD_X86
+    return isa >= MACAC_ISA_SSE2 && isa <= MACAC_ISA_AVX512 && isa <= best;
+#else
+    return isa == best;
+#endif
+}
+
+int macac_cpu_set_isa(int isa) {
+    if (!macac_cpu_supports(isa)) {
+        return -1;
+    }
+    g_active.store(kernels_for(isa), std::memory_order_release);
+    return 0;
+}
+
+const char* macac_cpu_isa_name(int isa) {
+    switch (isa) {
+        case MACAC_ISA_SCALAR: return "scalar";
+        case MACAC_ISA_SSE2: return "sse2";
+        case MACAC_ISA_AVX2: return "avx2";
+        case MACAC_ISA_AVX512: return "avx512";
+        case MACAC_ISA_NEON: return "neon";
+        default: return "unknown";
+    }
+}
+
+} // extern "C"
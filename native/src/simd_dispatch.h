@@ -0,0 +1,87 @@
+/*
+ * MacAC Native Library - SIMD Kernel Dispatch (internal)
+ * 
+ * Per-ISA kernel table selected once from CPUID. Public entry points in
+ * stats.cpp/combat.cpp/movement.cpp call through it; nothing here is exported.
+ */
+
+#ifndef MACAC_SIMD_DISPATCH_H
+#define MACAC_SIMD_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Attacker pose for the batch aim kernel (eye position, actual aim in degrees).
+ */
+struct macac_aim_pose {
+    double eye_x;
+    double eye_y;
+    double eye_z;
+    double yaw;
+    double pitch;
+};
+
+struct macac_simd_kernels {
+    int isa;                                                            // MACAC_ISA_*
+    double (*sum)(const double* data, size_t count);
+    double (*sum_sq_dev)(const double* data, size_t count, double mean);  // sum (x - mean)^2
+    
+    // Compact storage, widened to double on load. sum_i16 is exact and sets
+    // *out_min to the smallest element (INT16_MAX if count is 0)
+    double (*sum_f32)(const float* data, size_t count);
+    double (*sum_sq_dev_f32)(const float* data, size_t count, double mean);
+    int64_t (*sum_i16)(const int16_t* data, size_t count, int32_t* out_min);
+    double (*sum_sq_dev_i16)(const int16_t* data, size_t count, double step, double mean);  // sum (x * step - mean)^2
+    
+    void (*distance_3d)(const double* coords, double* distances, size_t count);
+    
+    // SoA columns c = {ax, ay, az, bx, by, bz}, count elements each
+    void (*distance_3d_soa)(const double* const* c, double* distances, size_t count);
+    void (*distance_3d_soa_f32)(const float* const* c, float* distances, size_t count);
+    
+    // One pass: out = {sum(x - data[0]), sum((x - data[0])^2), min, max}; count > 0
+    void (*moments)(const double* data, size_t count, double* out);
+    
+    // One pass over the MACAC_COMBAT_* columns c: out[0..4] = column sums, aim
+    // error and attack interval taken relative to their first sample;
+    // out[5], out[6] = sums of those two deviations squared; count > 0
+    void (*combat_moments)(const double* const* c, size_t count, double* out);
+    
+    // Targets t = {tx, ty, tz}; outputs may be null; returns argmin error or -1
+    int64_t (*aim_error)(const macac_aim_pose* pose, const double* const* t, size_t count,
+                         double* out_yaw, double* out_pitch, double* out_error);
+    
+    // One pass: out = {sum(d), sum(d^2), sum(d^3), sum(d^4), min, max} with
+    // d = x - data[0], power sums compensated across blocks; count > 0
+    void (*describe)(const double* data, size_t count, double* out);
+    
+    // One radix-2 decimation-in-time stage over split complex data of length
+    // n: butterflies (a, a + half) in every block of 2 * half, with twiddles
+    // w[j] = wr[j] + i * wi[j] for j < half; n and half are powers of two
+    void (*fft_stage)(double* re, double* im, size_t n, size_t half, const double* wr, const double* wi);
+    
+    // Movement step over MACAC_MOVE_* columns: in[MACAC_MOVE_INPUT_COLUMNS]
+    // into out[MACAC_MOVE_OUTPUT_COLUMNS]; rounds like the scalar code
+    void (*movement_step)(const double* const* in, double* const* out, size_t count);
+};
+
+/**
+ * Wrap an angle difference to [-180, 180] without loops or libm calls.
+ * Adding and subtracting 1.5 * 2^52 rounds to the nearest integer
+ * (valid for |turns| < 2^51 in the default rounding mode).
+ */
+static inline double macac_wrap_degrees(double degrees) {
+    const double ROUND_MAGIC = 6755399441055744.0;
+    double turns = degrees * (1.0 / 360.0);
+    double nearest = (turns + ROUND_MAGIC) - ROUND_MAGIC;
+    return degrees - nearest * 360.0;
+}
+
+/**
+ * Active kernel table. Resolves it on first use if macac_cpu_init has not
+ * run yet; never null.
+ */
+const macac_simd_kernels* macac_simd_active(void);
+
+#endif // MACAC_SIMD_DISPATCH_H
@@ -0,0 +1,370 @@
+/*
+ * MacAC Native Library - Spatial Index
+ * 
+ * Uniform hash grid over one world's entity positions, so "which entities
+ * are within N blocks of this player / along this look ray" costs a few
+ * cell scans instead of a pass over every entity.
+ * 
+ * Layout (rebuilt by macac_spatial_update, counting sort by bucket):
+ *   starts[bucket]      first sorted entry of each hash bucket
+ *   x/y/z/ids/keys      entries sorted by bucket (structure-of-arrays)
+ * 
+ * Cells are cell_size blocks on each side (a chunk section by default) and
+ * are keyed by their packed coordinates, hashed into at least twice as many
+ * buckets as entities. Different cells can share a bucket, so scans compare
+ * the stored cell key before testing distance; that also stops an entity
+ * from being reported twice by one query.
+ */
+
+#include "macac_native.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+static_assert(sizeof(macac_spatial_entry_t) == MACAC_SPATIAL_ENTRY_SIZE, "entry layout");
+static_assert(sizeof(macac_spatial_query_t) == MACAC_SPATIAL_QUERY_SIZE, "query layout");
+
+static const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+// Bits per packed cell coordinate. Coordinates wrap beyond +-2^20 cells,
+// which only makes far-apart cells share a key; the distance test still
+// rejects their entities
+#define SPATIAL_KEY_BITS 21
+#define SPATIAL_KEY_MASK ((1ull << SPATIAL_KEY_BITS) - 1)
+
+// Keeps floor(coord / cell) comfortably inside int64_t
+#define SPATIAL_MAX_CELL 1e15
+
+struct macac_spatial {
+    size_t capacity;
+    size_t count;
+    double cell_size;
+    double inv_cell;
+    
+    unsigned bucket_shift;      // 64 - log2(buckets)
+    size_t buckets;
+    uint32_t* starts;           // buckets + 1
+    
+    // Sorted entries
+    double* x;
+    double* y;
+    double* z;
+    int64_t* ids;
+    uint64_t* keys;
+    
+    // Update scratch: accepted source index and bucket
+    uint32_t* scratch_src;
+    uint32_t* scratch_bucket;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static int64_t cell_of(const macac_spatial_t* index, double v) {
+    double c = floor(v * index->inv_cell);
+    if (c > SPATIAL_MAX_CELL) {
+        c = SPATIAL_MAX_CELL;
+    } else if (c < -SPATIAL_MAX_CELL) {
+        c = -SPATIAL_MAX_CELL;
+    }
+    return (int64_t)c;
+}
+
+static uint64_t cell_key(int64_t cx, int64_t cy, int64_t cz) {
+    return (((uint64_t)cx & SPATIAL_KEY_MASK) << (2 * SPATIAL_KEY_BITS)) |
+           (((uint64_t)cy & SPATIAL_KEY_MASK) << SPATIAL_KEY_BITS) |
+           ((uint64_t)cz & SPATIAL_KEY_MASK);
+}
+
+static size_t bucket_of(const macac_spatial_t* index, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> index->bucket_shift);
+}
+
+/**
+ * Nearest-first result list of one query, written straight into the
+ * caller's buffers.
+ */
+struct spatial_results {
+    int64_t* ids;
+    double* dist;
+    size_t cap;
+    size_t size;
+    
+    void offer(int64_t id, double d) {
+        if (size == cap && (cap == 0 || d >= dist[cap - 1])) {
+            return;
+        }
+        
+        // Insertion sort; caps are small (a handful of candidates)
+        size_t pos = size < cap ? size++ : cap - 1;
+        while (pos > 0 && dist[pos - 1] > d) {
+            dist[pos] = dist[pos - 1];
+            ids[pos] = ids[pos - 1];
+            pos--;
+        }
+        dist[pos] = d;
+        ids[pos] = id;
+    }
+};
+
+/**
+ * Look-cone test for a candidate at offset (dx, dy, dz) and distance d.
+ */
+struct cone_filter {
+    double dir_x, dir_y, dir_z;
+    double cos_half;
+    bool all;                   // half_angle >= 180
+    
+    explicit cone_filter(const macac_spatial_query_t& q) {
+        double half = q.half_angle;
+        if (!(half > 0.0)) {
+            half = 0.0;
+        }
+        all = half >= 180.0;
+        
+        double yaw = q.yaw * DEG_TO_RAD;
+        double pitch = q.pitch * DEG_TO_RAD;
+        dir_x = -sin(yaw) * cos(pitch);
+        dir_y = -sin(pitch);
+        dir_z = cos(yaw) * cos(pitch);
+        cos_half = cos(half * DEG_TO_RAD);
+    }
+    
+    bool accept(double dx, double dy, double dz, double d) const {
+        return all || dx * dir_x + dy * dir_y + dz * dir_z >= d * cos_half;
+    }
+};
+
+struct radius_filter {
+    explicit radius_filter(const macac_spatial_query_t&) {}
+    
+    bool accept(double, double, double, double) const {
+        return true;
+    }
+};
+
+template <typename Filter>
+static void scan_range(const macac_spatial_t* index, const macac_spatial_query_t& q,
+                       const Filter& filter, double range_sq, size_t begin, size_t end,
+                       uint64_t key, bool check_key, spatial_results* out) {
+    for (size_t k = begin; k < end; k++) {
+        if (check_key && index->keys[k] != key) {
+            continue;
+        }
+        double dx = index->x[k] - q.x;
+        double dy = index->y[k] - q.y;
+        double dz = index->z[k] - q.z;
+        double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > range_sq || index->ids[k] == q.exclude_id) {
+            continue;
+        }
+        double d = sqrt(d2);
+        if (filter.accept(dx, dy, dz, d)) {
+            out->offer(index->ids[k], d);
+        }
+    }
+}
+
+/**
+ * Visit every cell overlapping the query's bounding cube, or every entity
+ * when that would touch more cells than there are entities (or wrap the
+ * packed cell coordinates).
+ */
+template <typename Filter>
+static size_t run_query(const macac_spatial_t* index, const macac_spatial_query_t& q,
+                        int64_t* out_ids, double* out_dist, size_t cap) {
+    spatial_results results = { out_ids, out_dist, cap, 0 };
+    double range = q.range;
+    if (index->count == 0 || cap == 0 || !(range >= 0.0) || !std::isfinite(range) ||
+        !std::isfinite(q.x) || !std::isfinite(q.y) || !std::isfinite(q.z)) {
+        return 0;
+    }
+    
+    Filter filter(q);
+    double range_sq = range * range;
+    
+    int64_t x0 = cell_of(index, q.x - range), x1 = cell_of(index, q.x + range);
+    int64_t y0 = cell_of(index, q.y - range), y1 = cell_of(index, q.y + range);
+    int64_t z0 = cell_of(index, q.z - range), z1 = cell_of(index, q.z + range);
+    double cells = (double)(x1 - x0 + 1) * (double)(y1 - y0 + 1) * (double)(z1 - z0 + 1);
+    
+    if (cells >= (double)index->count || x1 - x0 >= (int64_t)SPATIAL_KEY_MASK ||
+        y1 - y0 >= (int64_t)SPATIAL_KEY_MASK || z1 - z0 >= (int64_t)SPATIAL_KEY_MASK) {
+        scan_range(index, q, filter, range_sq, 0, index->count, 0, false, &results);
+        return results.size;
+    }
+    
+    for (int64_t cx = x0; cx <= x1; cx++) {
+        for (int64_t cy = y0; cy <= y1; cy++) {
+            for (int64_t cz = z0; cz <= z1; cz++) {
+                uint64_t key = cell_key(cx, cy, cz);
+                size_t b = bucket_of(index, key);
+                scan_range(index, q, filter, range_sq, index->starts[b], index->starts[b + 1],
+                           key, true, &results);
+            }
+        }
+    }
+    return results.size;
+}
+
+template <typename Filter>
+static size_t run_batch(const macac_spatial_t* index, const macac_spatial_query_t* queries,
+                        size_t count, size_t cap, int64_t* out_ids, double* out_dist,
+                        uint32_t* out_counts) {
+    if (!index || !queries || !out_ids) {
+        return 0;
+    }
+    
+    // Distances are needed for ordering even when the caller skips them
+    double local_dist[64];
+    double* heap_dist = nullptr;
+    if (!out_dist && cap > 64) {
+        heap_dist = new (std::nothrow) double[cap];
+        if (!heap_dist) {
+            return 0;
+        }
+    }
+    
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        double* dist = out_dist ? out_dist + i * cap : (heap_dist ? heap_dist : local_dist);
+        size_t n = run_query<Filter>(index, queries[i], out_ids + i * cap, dist, cap);
+        if (out_counts) {
+            out_counts[i] = (uint32_t)n;
+        }
+        total += n;
+    }
+    
+    delete[] heap_dist;
+    return total;
+}
+
+extern "C" {
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+macac_spatial_t* macac_spatial_create(size_t max_entities, double cell_size) {
+    if (max_entities == 0 || max_entities > UINT32_MAX / 4) {
+        return nullptr;
+    }
+    if (!(cell_size > 0.0) || !std::isfinite(cell_size)) {
+        cell_size = MACAC_SPATIAL_DEFAULT_CELL;
+    }
+    
+    macac_spatial_t* index = new (std::nothrow) macac_spatial_t();
+    if (!index) {
+        return nullptr;
+    }
+    
+    // At least two buckets per entity keeps chains short
+    unsigned bits = 4;
+    while (((size_t)1 << bits) < 2 * max_entities) {
+        bits++;
+    }
+    
+    index->capacity = max_entities;
+    index->cell_size = cell_size;
+    index->inv_cell = 1.0 / cell_size;
+    index->buckets = (size_t)1 << bits;
+    index->bucket_shift = 64 - bits;
+    
+    index->starts = new (std::nothrow) uint32_t[index->buckets + 1]();
+    index->x = new (std::nothrow) double[max_entities];
+    index->y = new (std::nothrow) double[max_entities];
+    index->z = new (std::nothrow) double[max_entities];
+    index->ids = new (std::nothrow) int64_t[max_entities];
+    index->keys = new (std::nothrow) uint64_t[max_entities];
+    index->scratch_src = new (std::nothrow) uint32_t[max_entities];
+    index->scratch_bucket = new (std::nothrow) uint32_t[max_entities];
+    
+    if (!index->starts || !index->x || !index->y || !index->z || !index->ids ||
+        !index->keys || !index->scratch_src || !index->scratch_bucket) {
+        macac_spatial_destroy(index);
+        return nullptr;
+    }
+    
+    return index;
+}
+
+void macac_spatial_destroy(macac_spatial_t* index) {
+    if (!index) {
+        return;
+    }
+    
+    delete[] index->starts;
+    delete[] index->x;
+    delete[] index->y;
+    delete[] index->z;
+    delete[] index->ids;
+    delete[] index->keys;
+    delete[] index->scratch_src;
+    delete[] index->scratch_bucket;
+    delete index;
+}
+
+size_t macac_spatial_update(macac_spatial_t* index, const macac_spatial_entry_t* entries, size_t count) {
+    if (!index) {
+        return 0;
+    }
+    
+    memset(index->starts, 0, (index->buckets + 1) * sizeof(uint32_t));
+    
+    // Pass 1: bucket every accepted entry and count bucket sizes
+    size_t n = 0;
+    for (size_t j = 0; j < count && entries && n < index->capacity; j++) {
+        const macac_spatial_entry_t& e = entries[j];
+        if (!std::isfinite(e.x) || !std::isfinite(e.y) || !std::isfinite(e.z)) {
+            continue;
+        }
+        uint64_t key = cell_key(cell_of(index, e.x), cell_of(index, e.y), cell_of(index, e.z));
+        size_t b = bucket_of(index, key);
+        index->scratch_src[n] = (uint32_t)j;
+        index->scratch_bucket[n] = (uint32_t)b;
+        index->starts[b]++;
+        n++;
+    }
+    
+    // Inclusive prefix sums: starts[b] is the end of bucket b...
+    uint32_t sum = 0;
+    for (size_t b = 0; b < index->buckets; b++) {
+        sum += index->starts[b];
+        index->starts[b] = sum;
+    }
+    index->starts[index->buckets] = sum;
+    
+    // ...until pass 2 fills each bucket back to front, leaving its start
+    for (size_t i = n; i-- > 0;) {
+        const macac_spatial_entry_t& e = entries[index->scratch_src[i]];
+        size_t k = --index->starts[index->scratch_bucket[i]];
+        index->x[k] = e.x;
+        index->y[k] = e.y;
+        index->z[k] = e.z;
+        index->ids[k] = e.id;
+        index->keys[k] = cell_key(cell_of(index, e.x), cell_of(index, e.y), cell_of(index, e.z));
+    }
+    
+    index->count = n;
+    return n;
+}
+
+size_t macac_spatial_size(macac_spatial_t* index) {
+    return index ? index->count : 0;
+}
+
+size_t macac_spatial_query_radius(const macac_spatial_t* index, const macac_spatial_query_t* queries,
+                                  size_t count, size_t cap, int64_t* out_ids, double* out_dist,
+                                  uint32_t* out_counts) {
+    return run_batch<radius_filter>(index, queries, count, cap, out_ids, out_dist, out_counts);
+}
+
+size_t macac_spatial_query_cone(const macac_spatial_t* index, const macac_spatial_query_t* queries,
+                                size_t count, size_t cap, int64_t* out_ids, double* out_dist,
+                                uint32_t* out_counts) {
+    return run_batch<cone_filter>(index, queries, count, cap, out_ids, out_dist, out_counts);
+}
+
+} // extern "C"
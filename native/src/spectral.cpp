@@ -0,0 +1,294 @@
+/*
+ * MacAC Native Library - Spectral Analysis
+ * 
+ * Spectrum and autocorrelation of short interval series (attack intervals
+ * per click burst). Jittered auto-clickers pass mean/CV tests but leave a
+ * repeating pattern, which shows up as one dominant frequency (low
+ * spectral entropy) or a strong autocorrelation peak at the pattern's lag.
+ * 
+ * Method, for a window of n samples (power of two, up to 256):
+ *   1. remove the mean and zero-pad to 2n, so the autocorrelation below
+ *      is linear rather than circular
+ *   2. real FFT of length 2n as a complex FFT of length n over the packed
+ *      pairs x[2k] + i x[2k+1], then a split pass to the 2n-point spectrum
+ *   3. power P[k]; the even bins are the n-point spectrum of the window
+ *      (entropy, peak), and the inverse real FFT of P is the
+ *      autocorrelation (Wiener-Khinchin), through the same packing
+ * 
+ * The butterflies run through the dispatch table (fft_stage); twiddles
+ * and the bit-reversal permutation come from tables built once.
+ */
+
+#include "macac_native.h"
+#include "simd_dispatch.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+static_assert(sizeof(macac_spectral_t) == MACAC_SPECTRAL_FIELDS * sizeof(double), "spectral layout");
+
+// Complex FFT length is the window length, so 8 index bits cover 256
+#define SPECTRAL_MAX 256
+#define SPECTRAL_MAX_BITS 8
+
+static_assert(MACAC_SPECTRAL_MAX_WINDOW == SPECTRAL_MAX, "table size");
+
+struct spectral_tables {
+    // Stage with span h reads [h, 2h): w_j = exp(-i * pi * j / h)
+    alignas(64) double stage_re[SPECTRAL_MAX];
+    alignas(64) double stage_im[SPECTRAL_MAX];
+    
+    // exp(-2 * pi * i * k / (2 * SPECTRAL_MAX)) for k in [0, SPECTRAL_MAX];
+    // a 2n-point split reads every (SPECTRAL_MAX / n)-th entry
+    double split_re[SPECTRAL_MAX + 1];
+    double split_im[SPECTRAL_MAX + 1];
+    
+    // 8-bit reversal; an index of b bits reverses to rev[i] >> (8 - b)
+    uint8_t rev[SPECTRAL_MAX];
+    
+    spectral_tables() {
+        const double PI = 3.14159265358979323846;
+        stage_re[0] = 1.0;
+        stage_im[0] = 0.0;
+        for (size_t h = 1; h < SPECTRAL_MAX; h <<= 1) {
+            for (size_t j = 0; j < h; j++) {
+                double angle = -PI * (double)j / (double)h;
+                stage_re[h + j] = cos(angle);
+                stage_im[h + j] = sin(angle);
+            }
+        }
+        for (size_t k = 0; k <= SPECTRAL_MAX; k++) {
+            double angle = -PI * (double)k / (double)SPECTRAL_MAX;
+            split_re[k] = cos(angle);
+            split_im[k] = sin(angle);
+        }
+        for (unsigned i = 0; i < SPECTRAL_MAX; i++) {
+            unsigned r = 0;
+            for (unsigned b = 0; b < SPECTRAL_MAX_BITS; b++) {
+                r |= ((i >> b) & 1u) << (SPECTRAL_MAX_BITS - 1 - b);
+            }
+            rev[i] = (uint8_t)r;
+        }
+    }
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static const spectral_tables& tables(void) {
+    static const spectral_tables t;
+    return t;
+}
+
+/**
+ * Natural log for the entropy sum (x positive and normal): split off the
+ * binary exponent, then 2 atanh((m - 1) / (m + 1)) through s^11, within
+ * 2e-11 of libm and several times faster.
+ */
+static inline double entropy_log(double x) {
+    const double LN2 = 0.69314718055994530942;
+    const uint64_t SQRT_HALF_BITS = 0x3FE6A09E667F3BCDull;
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    
+    // Exponent relative to sqrt(1/2), so the mantissa lands in
+    // [sqrt(1/2), sqrt(2)) without a branch
+    int64_t e = (int64_t)(bits - SQRT_HALF_BITS) >> 52;
+    bits -= (uint64_t)e << 52;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double poly = 1.0 + s2 * (1.0 / 3.0 + s2 * (1.0 / 5.0 + s2 * (1.0 / 7.0 + s2 * (1.0 / 9.0 + s2 * (1.0 / 11.0)))));
+    return 2.0 * s * poly + (double)e * LN2;
+}
+
+/**
+ * In-place forward FFT of n >= 4 bit-reversed complex values. The first
+ * two stages have twiddles 1 and -i, so they run fused without multiplies;
+ * one-butterfly blocks were most of the kernel's time.
+ */
+static void fft(const macac_simd_kernels* k, const spectral_tables& t, double* re, double* im, size_t n) {
+    for (size_t b = 0; b < n; b += 4) {
+        double ar = re[b] + re[b + 1];
+        double ai = im[b] + im[b + 1];
+        double br = re[b] - re[b + 1];
+        double bi = im[b] - im[b + 1];
+        double cr = re[b + 2] + re[b + 3];
+        double ci = im[b + 2] + im[b + 3];
+        double dr = re[b + 2] - re[b + 3];
+        double di = im[b + 2] - im[b + 3];
+        re[b] = ar + cr;
+        im[b] = ai + ci;
+        re[b + 2] = ar - cr;
+        im[b + 2] = ai - ci;
+        
+        // (br, bi) +/- (-i)(dr, di)
+        re[b + 1] = br + di;
+        im[b + 1] = bi - dr;
+        re[b + 3] = br - di;
+        im[b + 3] = bi + dr;
+    }
+    for (size_t half = 4; half < n; half <<= 1) {
+        k->fft_stage(re, im, n, half, &t.stage_re[half], &t.stage_im[half]);
+    }
+}
+
+static int analyze(const double* ring, size_t count, size_t oldest, macac_spectral_t* out) {
+    if (!out) {
+        return -1;
+    }
+    memset(out, 0, sizeof(macac_spectral_t));
+    if (!ring || count < MACAC_SPECTRAL_MIN_WINDOW) {
+        return -1;
+    }
+    
+    size_t n = SPECTRAL_MAX;
+    while (n > count) {
+        n >>= 1;
+    }
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
+    
+    const spectral_tables& t = tables();
+    const macac_simd_kernels* k = macac_simd_active();
+    unsigned shift = SPECTRAL_MAX_BITS - bits;
+    size_t stride = SPECTRAL_MAX / n;
+    
+    // Newest n values, oldest first, as at most two ring spans
+    double x[SPECTRAL_MAX];
+    size_t first = (oldest % count + count - n) % count;
+    size_t span = std::min(n, count - first);
+    memcpy(x, ring + first, span * sizeof(double));
+    memcpy(x + span, ring, (n - span) * sizeof(double));
+    
+    // A NaN or infinity anywhere makes the sum non-finite
+    double mean = k->sum(x, n) / (double)n;
+    if (!std::isfinite(mean)) {
+        return -1;
+    }
+    double energy = k->sum_sq_dev(x, n, mean);
+    
+    // Spread below the rounding of the mean is no spread
+    if (!(energy > 1e-20 * (energy + (double)n * mean * mean))) {
+        return -1;
+    }
+    
+    // Pack x[2j] + i x[2j+1] in bit-reversed order; j >= n/2 is the padding
+    alignas(64) double zr[SPECTRAL_MAX];
+    alignas(64) double zi[SPECTRAL_MAX];
+    for (size_t j = 0; j < n / 2; j++) {
+        size_t r = t.rev[j] >> shift;
+        zr[r] = x[2 * j] - mean;
+        zi[r] = x[2 * j + 1] - mean;
+    }
+    for (size_t j = n / 2; j < n; j++) {
+        size_t r = t.rev[j] >> shift;
+        zr[r] = 0.0;
+        zi[r] = 0.0;
+    }
+    fft(k, t, zr, zi, n);
+    
+    // Split to the 2n-point spectrum: X[k] = E[k] + W^k O[k] with
+    // E = (Z[k] + conj Z[n-k]) / 2 and O = (Z[k] - conj Z[n-k]) / 2i
+    double power[SPECTRAL_MAX + 1];
+    for (size_t b = 0; b <= n; b++) {
+        size_t a = b & (n - 1);
+        size_t m = (n - b) & (n - 1);
+        double cr = zr[m];
+        double ci = -zi[m];
+        double er = 0.5 * (zr[a] + cr);
+        double ei = 0.5 * (zi[a] + ci);
+        double or_ = 0.5 * (zi[a] - ci);
+        double oi = -0.5 * (zr[a] - cr);
+        double wr = t.split_re[b * stride];
+        double wi = t.split_im[b * stride];
+        double xr = er + wr * or_ - wi * oi;
+        double xi = ei + wr * oi + wi * or_;
+        power[b] = xr * xr + xi * xi;
+    }
+    
+    // n-point bins 1..n/2 are the even 2n-point bins
+    double total = 0.0;
+    for (size_t b = 1; b <= n / 2; b++) {
+        total += power[2 * b];
+    }
+    if (!(total > 0.0)) {
+        return -1;
+    }
+    double entropy = 0.0;
+    double peak = 0.0;
+    size_t peak_bin = 1;
+    double inv_total = 1.0 / total;
+    for (size_t b = 1; b <= n / 2; b++) {
+        double p = power[2 * b] * inv_total;
+        if (p > 1e-300) {
+            entropy -= p * entropy_log(p);
+        }
+        if (p > peak) {
+            peak = p;
+            peak_bin = b;
+        }
+    }
+    
+    // Inverse real FFT of the (real, even) power spectrum through the same
+    // packing, conjugated so the forward kernel computes it
+    for (size_t b = 0; b < n; b++) {
+        double pk = power[b];
+        double pm = power[n - b];
+        double e = 0.5 * (pk + pm);
+        double d = 0.5 * (pk - pm);
+        size_t r = t.rev[b] >> shift;
+        zr[r] = e + d * t.split_im[b * stride];
+        zi[r] = -d * t.split_re[b * stride];
+    }
+    fft(k, t, zr, zi, n);
+    
+    // r[2m] = zr[m], r[2m+1] = -zi[m] (common 1/n scale cancels)
+    double r0 = zr[0];
+    if (!(r0 > 0.0)) {
+        return -1;
+    }
+    double best = -INFINITY;
+    size_t best_lag = 1;
+    for (size_t lag = 1; lag <= n / 2; lag++) {
+        double r = (lag & 1) ? -zi[lag >> 1] : zr[lag >> 1];
+        if (r > best) {
+            best = r;
+            best_lag = lag;
+        }
+    }
+    
+    out->window = (double)n;
+    out->entropy = entropy / log((double)(n / 2));
+    out->peak_power = peak;
+    out->peak_frequency = (double)peak_bin / (double)n;
+    out->autocorr_peak = best / r0;
+    out->autocorr_lag = (double)best_lag;
+    return 0;
+}
+
+extern "C" {
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void macac_spectral_init(void) {
+    tables();
+}
+
+int macac_spectral_analyze(const double* data, size_t count, macac_spectral_t* out) {
+    return analyze(data, count, 0, out);
+}
+
+int macac_spectral_analyze_ring(const double* ring, size_t count, size_t oldest, macac_spectral_t* out) {
+    return analyze(ring, count, oldest, out);
+}
+
+} // extern "C"
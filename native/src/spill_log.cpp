@@ -0,0 +1,497 @@
+/*
+ * MacAC Native Library - On-Disk Spill Log
+ * 
+ * The async sender's outage buffer: records go to fixed-size segment files
+ * named spill-<id>.log in one directory, each created at full size
+ * (posix_fallocate, so a full disk fails the create instead of a later
+ * store) and mapped shared. Appends are memcpy into the mapping; durability
+ * comes from spill_sync, which the I/O thread calls on a timer, so a burst
+ * costs one fdatasync per segment rather than one per record.
+ * 
+ * Segment layout:
+ *   "MACSPIL1" | u32 format | u32 reserved
+ *   then records, each padded to 8 bytes:
+ *   u32 len | u32 checksum (FNV-1a of the bytes) | u32 acked | u32 reserved | bytes
+ * A zero length ends the segment (the file is zero-filled at creation);
+ * the length is stored last, so a record torn by a crash reads as the end
+ * or fails its checksum.
+ * 
+ * Reading is in append order. A taken record is marked acked in place once
+ * the sender reports it written, so a restart replays only records that
+ * never were; a segment is deleted once fully read and acknowledged.
+ */
+
+#include "spill_log.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPILL_MAGIC "MACSPIL1"
+#define SPILL_HEADER_BYTES 16
+#define SPILL_RECORD_HEADER 16
+
+// Segment size bounds (offsets must fit the 32-bit half of a ticket)
+#define SPILL_MIN_SEGMENT (64 * 1024)
+#define SPILL_MAX_SEGMENT ((size_t)1 << 30)
+
+// Most segment files one log tracks, recovered ones included
+#define SPILL_MAX_SEGMENTS 4096
+
+#define SPILL_MAX_PATH 1024
+
+struct spill_record {
+    uint32_t len;
+    uint32_t checksum;
+    uint32_t acked;
+    uint32_t reserved;
+};
+
+struct spill_segment {
+    uint64_t file_id;
+    int fd;
+    char* base;
+    size_t size;
+    size_t write_off;           // End of the records in the segment
+    size_t read_off;            // Next record to take
+    size_t pending;             // Taken and not yet acknowledged
+    bool writable;              // Only the newest segment created by this log
+    bool dirty;                 // Appended to since the last sync
+};
+
+struct spill_log {
+    char directory[SPILL_MAX_PATH];
+    int lock_fd;
+    uint32_t format;
+    size_t segment_bytes;
+    size_t budget;              // Segments appends may grow the log to
+    
+    // Live segments: a ring indexed by sequence, [first, first + count)
+    spill_segment* segments;
+    size_t capacity;
+    uint64_t first;
+    size_t count;
+    uint64_t read_seq;          // Segment being read
+    uint64_t next_file;
+    
+    size_t unread;
+    bool dirty;
+};
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static inline size_t record_bytes(size_t len) {
+    return (SPILL_RECORD_HEADER + len + 7) & ~(size_t)7;
+}
+
+static uint32_t spill_checksum(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t hash = 0x811c9dc5u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+static inline spill_segment* segment_at(spill_log* log, uint64_t seq) {
+    return &log->segments[seq % log->capacity];
+}
+
+static void segment_path(const spill_log* log, uint64_t file_id, char* out, size_t out_size) {
+    snprintf(out, out_size, "%s/spill-%016" PRIx64 ".log", log->directory, file_id);
+}
+
+/**
+ * Parse "spill-<16 hex digits>.log". Returns false for any other name.
+ */
+static bool parse_segment_name(const char* name, uint64_t* out_id) {
+    if (strncmp(name, "spill-", 6) != 0 || strlen(name) != 6 + 16 + 4 || strcmp(name + 22, ".log") != 0) {
+        return false;
+    }
+    uint64_t id = 0;
+    for (int i = 6; i < 22; i++) {
+        char c = name[i];
+        int v = c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1);
+        if (v < 0) {
+            return false;
+        }
+        id = (id << 4) | (uint64_t)v;
+    }
+    *out_id = id;
+    return true;
+}
+
+static void segment_unmap(spill_segment* seg) {
+    if (seg->base) {
+        munmap(seg->base, seg->size);
+        seg->base = nullptr;
+    }
+    if (seg->fd >= 0) {
+        close(seg->fd);
+        seg->fd = -1;
+    }
+}
+
+static void segment_sync(spill_segment* seg) {
+    if (!seg->dirty) {
+        return;
+    }
+#ifdef __linux__
+    // The page cache is shared with the mapping, so this writes mapped stores too
+    fdatasync(seg->fd);
+#else
+    msync(seg->base, seg->size, MS_SYNC);
+#endif
+    seg->dirty = false;
+}
+
+/**
+ * Step the read offset over records already acknowledged (left by an
+ * earlier run between ones that were not).
+ */
+static void skip_acked(spill_segment* seg) {
+    while (seg->read_off < seg->write_off) {
+        const spill_record* rec = (const spill_record*)(seg->base + seg->read_off);
+        if (!rec->acked) {
+            break;
+        }
+        seg->read_off += record_bytes(rec->len);
+    }
+}
+
+/**
+ * Delete segments at the front that are fully read and acknowledged.
+ */
+static void spill_retire(spill_log* log) {
+    char path[SPILL_MAX_PATH + 32];
+    while (log->count > 0) {
+        spill_segment* seg = segment_at(log, log->first);
+        skip_acked(seg);
+        if (seg->read_off < seg->write_off || seg->pending > 0) {
+            break;
+        }
+        segment_unmap(seg);
+        segment_path(log, seg->file_id, path, sizeof(path));
+        unlink(path);
+        log->first++;
+        log->count--;
+    }
+    if (log->read_seq < log->first) {
+        log->read_seq = log->first;
+    }
+}
+
+/**
+ * Create and map the next segment file. Null when the budget is used up
+ * or the file cannot be created at full size.
+ */
+static spill_segment* spill_new_segment(spill_log* log) {
+    if (log->count >= log->budget || log->count >= log->capacity) {
+        return nullptr;
+    }
+    
+    char path[SPILL_MAX_PATH + 32];
+    uint64_t file_id = log->next_file++;
+    segment_path(log, file_id, path, sizeof(path));
+    
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* base = MAP_FAILED;
+    if (posix_fallocate(fd, 0, (off_t)log->segment_bytes) == 0) {
+        base = mmap(nullptr, log->segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        close(fd);
+        unlink(path);
+        return nullptr;
+    }
+    
+    char* header = (char*)base;
+    memcpy(header, SPILL_MAGIC, 8);
+    memcpy(header + 8, &log->format, 4);
+    
+    spill_segment* seg = segment_at(log, log->first + log->count);
+    seg->file_id = file_id;
+    seg->fd = fd;
+    seg->base = header;
+    seg->size = log->segment_bytes;
+    seg->write_off = SPILL_HEADER_BYTES;
+    seg->read_off = SPILL_HEADER_BYTES;
+    seg->pending = 0;
+    seg->writable = true;
+    seg->dirty = true;
+    log->count++;
+    return seg;
+}
+
+/**
+ * Map a segment left by an earlier run and find its records. Returns the
+ * number not yet acknowledged, or -1 if the file is not a segment of this
+ * format (it is left alone).
+ */
+static long spill_recover_segment(spill_log* log, uint64_t file_id, spill_segment* seg) {
+    char path[SPILL_MAX_PATH + 32];
+    segment_path(log, file_id, path, sizeof(path));
+    
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SPILL_HEADER_BYTES ||
+        (size_t)st.st_size > SPILL_MAX_SEGMENT) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    
+    char* p = (char*)base;
+    uint32_t format;
+    memcpy(&format, p + 8, 4);
+    if (memcmp(p, SPILL_MAGIC, 8) != 0 || format != log->format) {
+        munmap(base, size);
+        close(fd);
+        return -1;
+    }
+    
+    // Records up to the first empty, truncated or corrupt one
+    size_t off = SPILL_HEADER_BYTES;
+    size_t first_unacked = 0;
+    long unacked = 0;
+    while (off + SPILL_RECORD_HEADER <= size) {
+        const spill_record* rec = (const spill_record*)(p + off);
+        if (rec->len == 0 || record_bytes(rec->len) > size - off ||
+            spill_checksum(rec + 1, rec->len) != rec->checksum) {
+            break;
+        }
+        if (!rec->acked) {
+            if (unacked++ == 0) {
+                first_unacked = off;
+            }
+        }
+        off += record_bytes(rec->len);
+    }
+    
+    seg->file_id = file_id;
+    seg->fd = fd;
+    seg->base = p;
+    seg->size = size;
+    seg->write_off = off;
+    seg->read_off = unacked > 0 ? first_unacked : off;
+    seg->pending = 0;
+    seg->writable = false;
+    seg->dirty = false;
+    return unacked;
+}
+
+static void spill_free(spill_log* log) {
+    if (log->segments) {
+        for (size_t i = 0; i < log->count; i++) {
+            segment_unmap(segment_at(log, log->first + i));
+        }
+        delete[] log->segments;
+    }
+    if (log->lock_fd >= 0) {
+        close(log->lock_fd);
+    }
+    delete log;
+}
+
+// ============================================================================
+// Spill Log
+// ============================================================================
+
+spill_log* spill_open(const char* directory, size_t segment_bytes, size_t max_bytes, uint32_t format) {
+    size_t dir_len = directory ? strlen(directory) : 0;
+    if (dir_len == 0 || dir_len >= SPILL_MAX_PATH) {
+        return nullptr;
+    }
+    
+    spill_log* log = new (std::nothrow) spill_log();
+    if (!log) {
+        return nullptr;
+    }
+    memcpy(log->directory, directory, dir_len);
+    log->lock_fd = -1;
+    log->format = format;
+    
+    segment_bytes = segment_bytes < SPILL_MIN_SEGMENT ? SPILL_MIN_SEGMENT :
+                    (segment_bytes > SPILL_MAX_SEGMENT ? SPILL_MAX_SEGMENT : segment_bytes);
+    log->segment_bytes = (segment_bytes + 4095) & ~(size_t)4095;
+    log->budget = max_bytes / log->segment_bytes;
+    log->budget = log->budget < 1 ? 1 : (log->budget > SPILL_MAX_SEGMENTS ? SPILL_MAX_SEGMENTS : log->budget);
+    
+    // One log per directory: a second sender would replay the same records
+    char path[SPILL_MAX_PATH + 32];
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        spill_free(log);
+        return nullptr;
+    }
+    snprintf(path, sizeof(path), "%s/spill.lock", directory);
+    log->lock_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (log->lock_fd < 0 || flock(log->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        spill_free(log);
+        return nullptr;
+    }
+    
+    // Segments from earlier runs, oldest first
+    uint64_t* ids = new (std::nothrow) uint64_t[SPILL_MAX_SEGMENTS];
+    DIR* dir = ids ? opendir(directory) : nullptr;
+    if (!dir) {
+        delete[] ids;
+        spill_free(log);
+        return nullptr;
+    }
+    size_t found = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        uint64_t id;
+        if (parse_segment_name(entry->d_name, &id)) {
+            log->next_file = std::max(log->next_file, id + 1);
+            if (found < SPILL_MAX_SEGMENTS) {
+                ids[found++] = id;
+            }
+        }
+    }
+    closedir(dir);
+    std::sort(ids, ids + found);
+    
+    log->capacity = std::max(log->budget, found);
+    log->segments = new (std::nothrow) spill_segment[log->capacity]();
+    if (!log->segments) {
+        delete[] ids;
+        spill_free(log);
+        return nullptr;
+    }
+    
+    for (size_t i = 0; i < found; i++) {
+        spill_segment* seg = segment_at(log, log->first + log->count);
+        long unacked = spill_recover_segment(log, ids[i], seg);
+        if (unacked < 0) {
+            continue;
+        }
+        if (unacked == 0) {
+            segment_unmap(seg);
+            segment_path(log, ids[i], path, sizeof(path));
+            unlink(path);
+            continue;
+        }
+        log->unread += (size_t)unacked;
+        log->count++;
+    }
+    delete[] ids;
+    return log;
+}
+
+void spill_close(spill_log* log) {
+    if (!log) {
+        return;
+    }
+    spill_sync(log);
+    spill_retire(log);
+    spill_free(log);
+}
+
+bool spill_append(spill_log* log, const void* data, size_t len) {
+    size_t need = record_bytes(len);
+    if (len == 0 || need > log->segment_bytes - SPILL_HEADER_BYTES) {
+        return false;
+    }
+    
+    spill_segment* seg = log->count > 0 ? segment_at(log, log->first + log->count - 1) : nullptr;
+    if (!seg || !seg->writable || seg->write_off + need > seg->size) {
+        if (seg) {
+            seg->writable = false;
+        }
+        seg = spill_new_segment(log);
+        if (!seg) {
+            return false;
+        }
+    }
+    
+    spill_record* rec = (spill_record*)(seg->base + seg->write_off);
+    memcpy(rec + 1, data, len);
+    rec->checksum = spill_checksum(data, len);
+    rec->acked = 0;
+    rec->reserved = 0;
+    std::atomic_signal_fence(std::memory_order_release);
+    rec->len = (uint32_t)len;
+    
+    seg->write_off += need;
+    seg->dirty = true;
+    log->dirty = true;
+    log->unread++;
+    return true;
+}
+
+const void* spill_peek(spill_log* log, size_t* out_len) {
+    while (log->read_seq < log->first + log->count) {
+        spill_segment* seg = segment_at(log, log->read_seq);
+        skip_acked(seg);
+        if (seg->read_off < seg->write_off) {
+            const spill_record* rec = (const spill_record*)(seg->base + seg->read_off);
+            *out_len = rec->len;
+            return rec + 1;
+        }
+        if (log->read_seq + 1 == log->first + log->count) {
+            break;
+        }
+        log->read_seq++;
+    }
+    return nullptr;
+}
+
+uint64_t spill_take(spill_log* log) {
+    spill_segment* seg = segment_at(log, log->read_seq);
+    const spill_record* rec = (const spill_record*)(seg->base + seg->read_off);
+    uint64_t ticket = (log->read_seq << 32) | (uint64_t)seg->read_off;
+    seg->read_off += record_bytes(rec->len);
+    seg->pending++;
+    log->unread--;
+    return ticket;
+}
+
+void spill_ack(spill_log* log, uint64_t ticket) {
+    uint64_t seq = ticket >> 32;
+    if (seq < log->first || seq >= log->first + log->count) {
+        return;
+    }
+    spill_segment* seg = segment_at(log, seq);
+    ((spill_record*)(seg->base + (uint32_t)ticket))->acked = 1;
+    seg->pending--;
+    spill_retire(log);
+}
+
+size_t spill_unread(const spill_log* log) {
+    return log->unread;
+}
+
+bool spill_dirty(const spill_log* log) {
+    return log->dirty;
+}
+
+void spill_sync(spill_log* log) {
+    for (size_t i = 0; i < log->count; i++) {
+        segment_sync(segment_at(log, log->first + i));
+    }
+    log->dirty = false;
+}
@@ -0,0 +1,71 @@
+/*
+ * MacAC Native Library - On-Disk Spill Log (internal)
+ * 
+ * Segmented, memory-mapped append log behind the async sender's spill
+ * (network.cpp). Single-threaded: every call comes from the sender's I/O
+ * thread, except open and close, which run before it starts and after it
+ * stops. Nothing here is exported.
+ */
+
+#ifndef MACAC_SPILL_LOG_H
+#define MACAC_SPILL_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct spill_log;
+
+/**
+ * Open (creating if missing) the log in directory and recover the records
+ * earlier runs left unacknowledged. format tags the record layout; segments
+ * written with another format are left alone. Returns null if the directory
+ * cannot be used or another log holds it.
+ */
+spill_log* spill_open(const char* directory, size_t segment_bytes, size_t max_bytes, uint32_t format);
+
+/**
+ * Sync and unmap every segment. Segments with unacknowledged records stay
+ * on disk for the next open; the rest are deleted.
+ */
+void spill_close(spill_log* log);
+
+/**
+ * Append one record (len bytes, copied). Returns false when it would
+ * exceed the byte budget or a segment cannot be created.
+ */
+bool spill_append(spill_log* log, const void* data, size_t len);
+
+/**
+ * Oldest record not yet taken, or null if every record has been. The
+ * pointer is valid until the next call that changes the log.
+ */
+const void* spill_peek(spill_log* log, size_t* out_len);
+
+/**
+ * Take the record spill_peek returned. Returns its ticket (never 0) for
+ * spill_ack once it has been delivered or dropped.
+ */
+uint64_t spill_take(spill_log* log);
+
+/**
+ * Mark a taken record done. A segment is deleted once every record in it
+ * has been taken and acknowledged.
+ */
+void spill_ack(spill_log* log, uint64_t ticket);
+
+/**
+ * Records appended or recovered and not yet taken.
+ */
+size_t spill_unread(const spill_log* log);
+
+/**
+ * True if records were appended since the last spill_sync.
+ */
+bool spill_dirty(const spill_log* log);
+
+/**
+ * fdatasync every segment written since the last call.
+ */
+void spill_sync(spill_log* log);
+
+#endif // MACAC_SPILL_LOG_H
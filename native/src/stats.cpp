@@ -1,120 +1,18 @@
 /*
  * MacAC Native Library - SIMD Statistics Implementation
  * 
- * Uses AVX2 SIMD instructions for fast statistics calculations.
- * Falls back to scalar operations if AVX2 is not available.
+ * Sum, variance, moments and describe run on the SIMD kernels selected at init time
+ * (see simd_dispatch.cpp); median/MAD use quickselect.
  */
 
 #include "macac_native.h"
+#include "simd_dispatch.h"
 #include <cmath>
 #include <algorithm>
 #include <cstring>
 
-// Check for AVX2 support at compile time
-#if defined(__AVX2__)
-#include <immintrin.h>
-#define HAS_AVX2 1
-#else
-#define HAS_AVX2 0
-#endif
-
 extern "C" {
 
-// ============================================================================
-// AVX2 SIMD Implementation
-// ============================================================================
-
-#if HAS_AVX2
-
-/**
- * Sum 4 doubles using AVX2.
- * Process 4 elements at a time using 256-bit registers.
- */
-static double simd_sum_avx2(const double* data, size_t count) {
-    __m256d sum_vec = _mm256_setzero_pd();
-    
-    // Process 4 doubles at a time
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m256d vals = _mm256_loadu_pd(&data[i]);
-        sum_vec = _mm256_add_pd(sum_vec, vals);
-    }
-    
-    // Horizontal sum of the 4 doubles in sum_vec
-    // sum_vec = [a, b, c, d]
-    // After first add: [a+c, b+d, a+c, b+d]
-    // After second add: [a+b+c+d, ...]
-    __m128d low = _mm256_castpd256_pd128(sum_vec);
-    __m128d high = _mm256_extractf128_pd(sum_vec, 1);
-    __m128d sum128 = _mm_add_pd(low, high);
-    sum128 = _mm_hadd_pd(sum128, sum128);
-    
-    double sum = _mm_cvtsd_f64(sum128);
-    
-    // Handle remaining elements
-    for (; i < count; i++) {
-        sum += data[i];
-    }
-    
-    return sum;
-}
-
-/**
- * Variance using AVX2.
- * Computes sum of squared differences from mean.
- */
-static double simd_variance_avx2(const double* data, size_t count, double mean) {
-    __m256d mean_vec = _mm256_set1_pd(mean);
-    __m256d sum_sq_vec = _mm256_setzero_pd();
-    
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m256d vals = _mm256_loadu_pd(&data[i]);
-        __m256d diff = _mm256_sub_pd(vals, mean_vec);
-        __m256d sq = _mm256_mul_pd(diff, diff);
-        sum_sq_vec = _mm256_add_pd(sum_sq_vec, sq);
-    }
-    
-    // Horizontal sum
-    __m128d low = _mm256_castpd256_pd128(sum_sq_vec);
-    __m128d high = _mm256_extractf128_pd(sum_sq_vec, 1);
-    __m128d sum128 = _mm_add_pd(low, high);
-    sum128 = _mm_hadd_pd(sum128, sum128);
-    
-    double sum_sq = _mm_cvtsd_f64(sum128);
-    
-    // Handle remaining elements
-    for (; i < count; i++) {
-        double diff = data[i] - mean;
-        sum_sq += diff * diff;
-    }
-    
-    return sum_sq / (count > 1 ? count - 1 : 1);
-}
-
-#endif // HAS_AVX2
-
-// ============================================================================
-// Scalar Fallback Implementation
-// ============================================================================
-
-static double scalar_sum(const double* data, size_t count) {
-    double sum = 0.0;
-    for (size_t i = 0; i < count; i++) {
-        sum += data[i];
-    }
-    return sum;
-}
-
-static double scalar_variance(const double* data, size_t count, double mean) {
-    double sum_sq = 0.0;
-    for (size_t i = 0; i < count; i++) {
-        double diff = data[i] - mean;
-        sum_sq += diff * diff;
-    }
-    return sum_sq / (count > 1 ? count - 1 : 1);
-}
-
 // ============================================================================
 // Public API
 // ============================================================================
@@ -124,11 +22,7 @@ double macac_simd_sum(const double* data, size_t count) {
         return 0.0;
     }
     
-#if HAS_AVX2
-    return simd_sum_avx2(data, count);
-#else
-    return scalar_sum(data, count);
-#endif
+    return macac_simd_active()->sum(data, count);
 }
 
 double macac_simd_mean(const double* data, size_t count) {
@@ -144,11 +38,63 @@ double macac_simd_variance(const double* data, size_t count, double mean) {
         return 0.0;
     }
     
-#if HAS_AVX2
-    return simd_variance_avx2(data, count, mean);
-#else
-    return scalar_variance(data, count, mean);
-#endif
+    return macac_simd_active()->sum_sq_dev(data, count, mean) / (count - 1);
+}
+
+void macac_simd_moments(const double* data, size_t count, macac_moments_t* out) {
+    if (!out) {
+        return;
+    }
+    if (!data || count == 0) {
+        memset(out, 0, sizeof(macac_moments_t));
+        return;
+    }
+    
+    // {sum(d), sum(d^2), min, max} with d = x - data[0]
+    double acc[4];
+    macac_simd_active()->moments(data, count, acc);
+    
+    double n = (double)count;
+    out->mean = data[0] + acc[0] / n;
+    out->variance = count > 1 ? std::max(0.0, (acc[1] - acc[0] * acc[0] / n) / (n - 1.0)) : 0.0;
+    out->min = acc[2];
+    out->max = acc[3];
+}
+
+void macac_simd_describe(const double* data, size_t count, macac_describe_t* out) {
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(macac_describe_t));
+    if (!data || count == 0) {
+        return;
+    }
+    
+    // {sum(d), sum(d^2), sum(d^3), sum(d^4), min, max} with d = x - data[0]
+    double acc[6];
+    macac_simd_active()->describe(data, count, acc);
+    
+    double n = (double)count;
+    double a = acc[0] / n;
+    double r2 = acc[1] / n;
+    double r3 = acc[2] / n;
+    double r4 = acc[3] / n;
+    
+    // Central moments from the shifted raw moments
+    double m2 = std::max(0.0, r2 - a * a);
+    double m3 = r3 - 3.0 * a * r2 + 2.0 * a * a * a;
+    double m4 = r4 - 4.0 * a * r3 + 6.0 * a * a * r2 - 3.0 * a * a * a * a;
+    
+    out->count = count;
+    out->sum = data[0] * n + acc[0];
+    out->mean = data[0] + a;
+    out->variance = count > 1 ? m2 * n / (n - 1.0) : 0.0;
+    out->min = acc[4];
+    out->max = acc[5];
+    if (m2 > 0.0) {
+        out->skewness = m3 / (m2 * std::sqrt(m2));
+        out->kurtosis = std::max(0.0, m4) / (m2 * m2) - 3.0;
+    }
 }
 
 /**
@@ -194,52 +140,71 @@ static double quickselect(double* data, size_t left, size_t right, size_t k) {
     return data[left];
 }
 
-double macac_median(double* data, size_t count) {
-    if (!data || count == 0) {
-        return 0.0;
-    }
-    
+/**
+ * Median of values, reordering them in place.
+ */
+static double median_inplace(double* values, size_t count) {
     if (count == 1) {
-        return data[0];
+        return values[0];
     }
     
-    // Create a copy to avoid modifying original
-    double* copy = new double[count];
-    memcpy(copy, data, count * sizeof(double));
-    
-    double median;
     size_t mid = count / 2;
+    double upper = quickselect(values, 0, count - 1, mid);
     
     if (count % 2 == 0) {
-        // Even count: average of two middle elements
-        double a = quickselect(copy, 0, count - 1, mid - 1);
-        double b = quickselect(copy, 0, count - 1, mid);
-        median = (a + b) / 2.0;
-    } else {
-        // Odd count: middle element
-        median = quickselect(copy, 0, count - 1, mid);
+        // Even count: quickselect left the lower middle as the max of [0, mid)
+        double lower = *std::max_element(values, values + mid);
+        return (lower + upper) / 2.0;
+    }
+    return upper;
+}
+
+double macac_median_scratch(const double* data, size_t count, double* scratch) {
+    if (!data || !scratch || count == 0) {
+        return 0.0;
     }
     
-    delete[] copy;
-    return median;
+    memcpy(scratch, data, count * sizeof(double));
+    return median_inplace(scratch, count);
 }
 
-double macac_mad(double* data, size_t count) {
-    if (!data || count == 0) {
+double macac_mad_scratch(const double* data, size_t count, double* scratch) {
+    if (!data || !scratch || count == 0) {
         return 0.0;
     }
     
-    double median = macac_median(data, count);
+    double median = macac_median_scratch(data, count, scratch);
     
-    // Calculate absolute deviations
-    double* deviations = new double[count];
+    // Reuse scratch for absolute deviations
     for (size_t i = 0; i < count; i++) {
-        deviations[i] = std::abs(data[i] - median);
+        scratch[i] = std::abs(data[i] - median);
+    }
+    
+    return median_inplace(scratch, count);
+}
+
+double macac_median(double* data, size_t count) {
+    if (!data || count == 0) {
+        return 0.0;
+    }
+    
+    // Scratch copy to avoid modifying original
+    double* scratch = new double[count];
+    double median = macac_median_scratch(data, count, scratch);
+    
+    delete[] scratch;
+    return median;
+}
+
+double macac_mad(double* data, size_t count) {
+    if (!data || count == 0) {
+        return 0.0;
     }
     
-    double mad = macac_median(deviations, count);
+    double* scratch = new double[count];
+    double mad = macac_mad_scratch(data, count, scratch);
     
-    delete[] deviations;
+    delete[] scratch;
     return mad;
 }
 
@@ -7,15 +7,21 @@
  * 
  * Assembly is used for RDTSCP to ensure proper serialization
  * and to access the auxiliary register for CPU identification.
+ * 
+ * TSC frequency comes from the first source that reports one, so startup
+ * does not spin: CPUID leaf 0x15/0x16, the hypervisor timing leaf
+ * 0x40000010, Linux tsc_freq_khz, and only then a ~2 ms two-point
+ * calibration against CLOCK_MONOTONIC_RAW. Timestamps are converted with
+ * a 32.32 fixed-point multiply-shift anchored to CLOCK_MONOTONIC, and the
+ * TSC is used for macac_nanotime only when CPUID reports it invariant.
  */
 
 #include "macac_native.h"
 #include <time.h>
 #include <chrono>
-
-// TSC calibration factor (nanoseconds per tick)
-static double tsc_nanos_per_tick = 0.0;
-static bool tsc_calibrated = false;
+#include <atomic>
+#include <thread>
+#include <cstdio>
 
 // ============================================================================
 // x86/x86_64 Assembly for RDTSCP
@@ -23,6 +29,7 @@ static bool tsc_calibrated = false;
 
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
 #define HAS_RDTSCP 1
+#include <cpuid.h>
 
 /**
  * Read Time Stamp Counter with processor ID (RDTSCP)
@@ -92,96 +99,322 @@ static inline void cpu_pause(void) {
 #define HAS_RDTSCP 0
 #endif
 
+
 // ============================================================================
-// Public API Implementation
+// Calibration State
 // ============================================================================
 
-extern "C" {
+// Fixed-point scale: nanos = (ticks * mult) >> TSC_SHIFT
+#define TSC_SHIFT 32
 
-uint64_t macac_rdtscp(void) {
-#if HAS_RDTSCP
-    uint32_t aux;
-    return read_tsc_serialized(&aux);
+// Frequencies outside this range are treated as bogus CPUID/sysfs values
+#define TSC_MIN_HZ 100000000ull
+#define TSC_MAX_HZ 20000000000ull
+
+// Length of the CLOCK_MONOTONIC_RAW fallback calibration
+#define TSC_MEASURE_NANOS 2000000
+
+enum {
+    TSC_UNCALIBRATED = 0,
+    TSC_CALIBRATING = 1,
+    TSC_READY = 2
+};
+
+/**
+ * Written once by the calibrating thread, then published by the release
+ * store of tsc_phase = TSC_READY; read-only afterwards, so readers only
+ * need an acquire load of the phase.
+ */
+struct tsc_calibration {
+    uint64_t mult;              // 32.32 fixed-point nanoseconds per tick
+    uint64_t hz;                // Ticks per second (0 without a TSC)
+    uint64_t base_tsc;          // Anchor tick ...
+    int64_t base_nanos;         // ... and its CLOCK_MONOTONIC time
+    double nanos_per_tick;
+    int source;                 // MACAC_TSC_SOURCE_*
+    int invariant;              // Constant rate across P/C-states
+    int use_tsc;                // macac_nanotime reads the TSC
+};
+
+static tsc_calibration tsc_cal;
+static std::atomic<int> tsc_phase{TSC_UNCALIBRATED};
+
+static int64_t clock_nanos(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * (value * mult) >> TSC_SHIFT without overflowing 64 bits.
+ */
+static inline uint64_t mul_shift(uint64_t value, uint64_t mult) {
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((unsigned __int128)value * mult) >> TSC_SHIFT);
 #else
-    // Fallback: use steady_clock
-    auto now = std::chrono::steady_clock::now();
-    return now.time_since_epoch().count();
+    uint64_t hi = value >> 32;
+    uint64_t lo = value & 0xFFFFFFFFull;
+    return hi * mult + ((lo * mult) >> TSC_SHIFT);
 #endif
 }
 
-double macac_calibrate_tsc(void) {
-    if (tsc_calibrated) {
-        return tsc_nanos_per_tick;
+#if HAS_RDTSCP
+
+static bool plausible_hz(uint64_t hz) {
+    return hz >= TSC_MIN_HZ && hz <= TSC_MAX_HZ;
+}
+
+/**
+ * CPUID.80000007H:EDX[8] - TSC runs at a constant rate in all ACPI P-,
+ * C- and T-states, so it can serve as a wall clock.
+ */
+static int cpuid_invariant_tsc(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+        return 0;
+    }
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx >> 8) & 1;
+}
+
+/**
+ * CPUID leaf 0x15: TSC = crystal * EBX / EAX. When the crystal frequency
+ * (ECX) is not enumerated, leaf 0x16 base frequency equals the TSC rate.
+ */
+static uint64_t tsc_hz_from_cpuid(void) {
+    unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+    if (max_leaf < 0x15) {
+        return 0;
     }
     
-#if HAS_RDTSCP
-    // Calibrate TSC against system clock
-    // Take multiple samples for accuracy
+    unsigned int denominator, numerator, crystal_hz, edx;
+    __cpuid(0x15, denominator, numerator, crystal_hz, edx);
+    if (denominator == 0 || numerator == 0) {
+        return 0;
+    }
+    if (crystal_hz != 0) {
+        return (uint64_t)crystal_hz * numerator / denominator;
+    }
     
-    const int SAMPLES = 10;
-    double total_ratio = 0.0;
+    if (max_leaf < 0x16) {
+        return 0;
+    }
+    unsigned int base_mhz, ebx, ecx;
+    __cpuid(0x16, base_mhz, ebx, ecx, edx);
+    return (uint64_t)(base_mhz & 0xFFFF) * 1000000ull;
+}
+
+/**
+ * Hypervisor timing leaf (VMware, KVM with tsc frequency exposed):
+ * CPUID.40000010H:EAX is the TSC frequency in kHz.
+ */
+static uint64_t tsc_hz_from_hypervisor(void) {
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (!(ecx & (1u << 31))) {
+        return 0;
+    }
     
-    for (int i = 0; i < SAMPLES; i++) {
-        struct timespec start_ts, end_ts;
-        uint64_t start_tsc, end_tsc;
-        
-        // Memory fence before timing
-        memory_fence();
-        
-        // Get starting timestamps
-        clock_gettime(CLOCK_MONOTONIC, &start_ts);
-        start_tsc = macac_rdtscp();
+    __cpuid(0x40000000, eax, ebx, ecx, edx);
+    if (eax < 0x40000010) {
+        return 0;
+    }
+    __cpuid(0x40000010, eax, ebx, ecx, edx);
+    return (uint64_t)eax * 1000ull;
+}
+
+/**
+ * Kernel-reported TSC frequency, exposed by some Linux kernels.
+ */
+static uint64_t tsc_hz_from_sysfs(void) {
+#if defined(__linux__)
+    FILE* f = fopen("/sys/devices/system/cpu/cpu0/tsc_freq_khz", "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned long long khz = 0;
+    if (fscanf(f, "%llu", &khz) != 1) {
+        khz = 0;
+    }
+    fclose(f);
+    return (uint64_t)khz * 1000ull;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Read a (tsc, clock) pair, keeping the tightest of a few brackets so a
+ * preemption between the two reads does not skew the result.
+ */
+static void sample_pair(clockid_t clock, uint64_t* out_tsc, int64_t* out_nanos) {
+    uint64_t best_window = UINT64_MAX;
+    for (int i = 0; i < 5; i++) {
+        uint64_t before = macac_rdtscp();
+        int64_t nanos = clock_nanos(clock);
+        uint64_t after = macac_rdtscp();
         
-        // Busy wait for ~10ms
-        volatile int dummy = 0;
-        for (int j = 0; j < 10000000; j++) {
-            dummy++;
+        // The first bracket always counts, so the outputs are always written
+        if (i == 0 || after - before < best_window) {
+            best_window = after - before;
+            *out_tsc = before + (after - before) / 2;
+            *out_nanos = nanos;
         }
-        (void)dummy;
-        
-        // Get ending timestamps
-        end_tsc = macac_rdtscp();
-        clock_gettime(CLOCK_MONOTONIC, &end_ts);
-        
-        // Calculate elapsed time in nanos
-        int64_t elapsed_nanos = (end_ts.tv_sec - start_ts.tv_sec) * 1000000000LL +
-                                (end_ts.tv_nsec - start_ts.tv_nsec);
-        uint64_t elapsed_tsc = end_tsc - start_tsc;
-        
-        if (elapsed_tsc > 0) {
-            total_ratio += (double)elapsed_nanos / (double)elapsed_tsc;
+    }
+}
+
+/**
+ * Two-point calibration against the unslewed hardware clock.
+ */
+static uint64_t tsc_hz_measured(void) {
+#ifdef CLOCK_MONOTONIC_RAW
+    const clockid_t clock = CLOCK_MONOTONIC_RAW;
+#else
+    const clockid_t clock = CLOCK_MONOTONIC;
+#endif
+    uint64_t start_tsc, end_tsc;
+    int64_t start_nanos, end_nanos;
+    
+    memory_fence();
+    sample_pair(clock, &start_tsc, &start_nanos);
+    while (clock_nanos(clock) - start_nanos < TSC_MEASURE_NANOS) {
+        cpu_pause();
+    }
+    sample_pair(clock, &end_tsc, &end_nanos);
+    
+    int64_t elapsed_nanos = end_nanos - start_nanos;
+    if (elapsed_nanos <= 0 || end_tsc <= start_tsc) {
+        return 0;
+    }
+    return (uint64_t)((double)(end_tsc - start_tsc) * 1e9 / (double)elapsed_nanos);
+}
+
+#endif
+
+/**
+ * Fill tsc_cal. Runs once, on whichever thread wins the phase CAS.
+ */
+static void calibrate(void) {
+    tsc_calibration cal = {};
+    cal.source = MACAC_TSC_SOURCE_NONE;
+
+#if HAS_RDTSCP
+    cal.invariant = cpuid_invariant_tsc();
+    
+    uint64_t (*const sources[])(void) = {
+        tsc_hz_from_cpuid, tsc_hz_from_hypervisor, tsc_hz_from_sysfs, tsc_hz_measured
+    };
+    const int source_ids[] = {
+        MACAC_TSC_SOURCE_CPUID, MACAC_TSC_SOURCE_HYPERVISOR,
+        MACAC_TSC_SOURCE_SYSFS, MACAC_TSC_SOURCE_MEASURED
+    };
+    for (size_t i = 0; i < sizeof(source_ids) / sizeof(source_ids[0]); i++) {
+        uint64_t hz = sources[i]();
+        if (plausible_hz(hz)) {
+            cal.hz = hz;
+            cal.source = source_ids[i];
+            break;
         }
     }
+#endif
     
-    tsc_nanos_per_tick = total_ratio / SAMPLES;
-#else
-    // No TSC, ratio is 1.0 (already in nanos)
-    tsc_nanos_per_tick = 1.0;
+    if (cal.hz != 0) {
+        cal.mult = (1000000000ull << TSC_SHIFT) / cal.hz;
+        cal.nanos_per_tick = 1e9 / (double)cal.hz;
+        cal.use_tsc = cal.invariant;
+    } else {
+        // Ticks are already nanoseconds (steady_clock fallback)
+        cal.mult = 1ull << TSC_SHIFT;
+        cal.nanos_per_tick = 1.0;
+        cal.use_tsc = 0;
+    }
+
+#if HAS_RDTSCP
+    if (cal.use_tsc) {
+        sample_pair(CLOCK_MONOTONIC, &cal.base_tsc, &cal.base_nanos);
+    }
 #endif
     
-    tsc_calibrated = true;
-    return tsc_nanos_per_tick;
+    tsc_cal = cal;
 }
 
-int64_t macac_tsc_to_nanos(uint64_t tsc_value) {
-    if (!tsc_calibrated) {
-        macac_calibrate_tsc();
+/**
+ * Calibrate on first use. Concurrent callers wait for the winner, which
+ * takes microseconds unless the measured fallback is needed (~2 ms).
+ */
+static const tsc_calibration* ensure_calibrated(void) {
+    int phase = tsc_phase.load(std::memory_order_acquire);
+    if (phase == TSC_READY) {
+        return &tsc_cal;
+    }
+    
+    int expected = TSC_UNCALIBRATED;
+    if (tsc_phase.compare_exchange_strong(expected, TSC_CALIBRATING,
+                                          std::memory_order_acquire)) {
+        calibrate();
+        tsc_phase.store(TSC_READY, std::memory_order_release);
+        return &tsc_cal;
+    }
+    
+    while (tsc_phase.load(std::memory_order_acquire) != TSC_READY) {
+        std::this_thread::yield();
     }
-    return (int64_t)(tsc_value * tsc_nanos_per_tick);
+    return &tsc_cal;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+extern "C" {
+
+uint64_t macac_rdtscp(void) {
+#if HAS_RDTSCP
+    uint32_t aux;
+    return read_tsc_serialized(&aux);
+#else
+    // Fallback: use steady_clock
+    auto now = std::chrono::steady_clock::now();
+    return now.time_since_epoch().count();
+#endif
+}
+
+double macac_calibrate_tsc(void) {
+    return ensure_calibrated()->nanos_per_tick;
+}
+
+int64_t macac_tsc_to_nanos(uint64_t tsc_value) {
+    return (int64_t)mul_shift(tsc_value, ensure_calibrated()->mult);
 }
 
 int64_t macac_nanotime(void) {
 #if HAS_RDTSCP
-    // Use high-precision TSC if available and calibrated
-    if (tsc_calibrated) {
-        return macac_tsc_to_nanos(macac_rdtscp());
+    // Use TSC only once calibrated, and only if it is invariant
+    if (tsc_phase.load(std::memory_order_acquire) == TSC_READY && tsc_cal.use_tsc) {
+        uint64_t now = macac_rdtscp();
+        
+        // Another core's TSC may trail the anchor by a few ticks
+        if (now >= tsc_cal.base_tsc) {
+            return tsc_cal.base_nanos + (int64_t)mul_shift(now - tsc_cal.base_tsc, tsc_cal.mult);
+        }
+        return tsc_cal.base_nanos - (int64_t)mul_shift(tsc_cal.base_tsc - now, tsc_cal.mult);
     }
 #endif
     
     // Fallback to clock_gettime
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    return clock_nanos(CLOCK_MONOTONIC);
+}
+
+int macac_tsc_source(void) {
+    return ensure_calibrated()->source;
+}
+
+int macac_tsc_invariant(void) {
+    return ensure_calibrated()->invariant;
+}
+
+uint64_t macac_tsc_hz(void) {
+    return ensure_calibrated()->hz;
 }
 
 } // extern "C"
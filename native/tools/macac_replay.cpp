@@ -0,0 +1,614 @@
+/*
+ * MacAC Native Library - Capture Replay
+ * 
+ * Streams telemetry capture files (see capture.cpp) through the native
+ * kernels the plugin uses per packet, as fast as the host allows, and
+ * reports throughput plus per-kernel latency from the perf histograms.
+ * Captures can also be synthesized, to get a repeatable load such as
+ * "1000 players at 20 Hz" without a live server.
+ * 
+ * Per movement sample: history slab pushes, rolling ping median/MAD,
+ * tracked speed window, and every MOMENTS_EVERY samples a SIMD moments
+ * sweep over the player's slab window. Per attack: aim angles, snap
+ * angle and reach into a combat accumulator, then an O(1) analysis.
+ * 
+ * Usage:
+ *   macac_replay [--repeat N] [--isa scalar|sse2|avx2|avx512|neon]
+ *                [--window N] [--slots N] FILE.mcap...
+ *   macac_replay --synth PLAYERS,HZ,SECONDS --out PREFIX [--seed N]
+ * 
+ * The Java pipeline (features, checks, aggregation) replays the same
+ * files with com.macmoment.macac.tools.CaptureReplay.
+ */
+
+#include "macac_native.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Slab metric columns, as PlayerContext.SLAB_METRIC_*
+#define METRIC_PING 0
+#define METRIC_PACKET_DELTA 1
+#define METRIC_HORIZ_SPEED 2
+#define METRIC_VERT_SPEED 3
+#define METRIC_COUNT 4
+
+// Samples between moments sweeps of a player's speed window
+#define MOMENTS_EVERY 20
+
+// Eye height used by CombatInput.expectedPitch()
+#define EYE_HEIGHT 1.62
+
+struct replay_options {
+    std::vector<std::string> files;
+    int repeats = 1;
+    int isa = -1;
+    size_t window = 64;
+    size_t slots = 4096;
+    
+    // --synth
+    bool synth = false;
+    int synth_players = 0;
+    int synth_hz = 0;
+    int synth_seconds = 0;
+    std::string out_prefix;
+    uint64_t seed = 1;
+};
+
+static replay_options options;
+
+struct player_key {
+    uint64_t hi;
+    uint64_t lo;
+    
+    bool operator==(const player_key& other) const {
+        return hi == other.hi && lo == other.lo;
+    }
+};
+
+struct player_key_hash {
+    size_t operator()(const player_key& key) const {
+        uint64_t h = key.hi ^ (key.lo * 0x9E3779B97F4A7C15ull);
+        return (size_t)(h ^ (h >> 32));
+    }
+};
+
+struct replay_player {
+    int64_t slot;
+    macac_order_stats_t* ping;          // PlayerContext.pingWindow
+    macac_ringbuffer_t* speed;          // Tracked horizontal speed window
+    macac_combat_accum_t* combat;       // Created on first attack
+    int64_t last_nanos;
+    int64_t last_attack_nanos;
+    uint32_t samples;
+};
+
+struct replay_sites {
+    int telemetry;
+    int combat;
+    int slab_push;
+    int order_stats;
+    int ringbuffer;
+    int moments;
+    int aim;
+    int combat_accum;
+};
+
+struct replay_totals {
+    uint64_t telemetry;
+    uint64_t combat;
+    uint64_t skipped;
+    uint64_t bytes;
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/**
+ * Keep a value live without emitting a store (GNU/Clang inline asm).
+ */
+template <typename T>
+static inline void keep(const T& value) {
+    __asm__ __volatile__("" : : "r,m"(value) : "memory");
+}
+
+static int64_t wall_nanos(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * splitmix64: small, seedable and identical on every platform.
+ */
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double next_unit(uint64_t* state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static replay_player* player_for(std::unordered_map<player_key, replay_player, player_key_hash>& players,
+                                 macac_history_slab_t* slab, const player_key& key) {
+    auto it = players.find(key);
+    if (it != players.end()) {
+        return &it->second;
+    }
+    
+    replay_player player;
+    memset(&player, 0, sizeof(player));
+    player.slot = macac_slab_acquire_for(slab, key.hi, key.lo);
+    player.ping = macac_order_stats_create(options.window);
+    player.speed = macac_ringbuffer_create_tracked(options.window);
+    return &players.emplace(key, player).first->second;
+}
+
+static void free_players(std::unordered_map<player_key, replay_player, player_key_hash>& players) {
+    for (auto& entry : players) {
+        macac_order_stats_destroy(entry.second.ping);
+        macac_ringbuffer_destroy(entry.second.speed);
+        macac_combat_accum_destroy(entry.second.combat);
+    }
+    players.clear();
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+static void replay_telemetry(const macac_capture_telemetry_t* rec, replay_player* player,
+                             macac_history_slab_t* slab, const replay_sites* sites) {
+    uint64_t begin = macac_perf_begin();
+    const macac_telemetry_record_t* t = &rec->telemetry;
+    double horiz = sqrt(t->dx * t->dx + t->dz * t->dz);
+    
+    uint64_t stage = macac_perf_begin();
+    macac_slab_push(slab, player->slot, METRIC_PING, (double)t->ping);
+    if (player->last_nanos > 0 && t->nano_time > player->last_nanos) {
+        macac_slab_push(slab, player->slot, METRIC_PACKET_DELTA,
+                        (double)(t->nano_time - player->last_nanos) / 1e6);
+    }
+    macac_slab_push(slab, player->slot, METRIC_HORIZ_SPEED, horiz);
+    macac_slab_push(slab, player->slot, METRIC_VERT_SPEED, t->dy);
+    macac_perf_end(sites->slab_push, stage);
+    player->last_nanos = t->nano_time;
+    
+    stage = macac_perf_begin();
+    macac_order_stats_push(player->ping, (double)t->ping);
+    keep(macac_order_stats_median(player->ping));
+    keep(macac_order_stats_mad(player->ping));
+    macac_perf_end(sites->order_stats, stage);
+    
+    stage = macac_perf_begin();
+    macac_ringbuffer_push(player->speed, horiz);
+    keep(macac_ringbuffer_mean(player->speed));
+    keep(macac_ringbuffer_variance(player->speed));
+    macac_perf_end(sites->ringbuffer, stage);
+    
+    if (++player->samples % MOMENTS_EVERY == 0) {
+        stage = macac_perf_begin();
+        size_t count = 0;
+        const double* window = macac_slab_window(slab, player->slot, METRIC_HORIZ_SPEED, &count);
+        macac_moments_t moments;
+        macac_simd_moments(window, count, &moments);
+        keep(moments);
+        macac_perf_end(sites->moments, stage);
+    }
+    
+    macac_perf_end(sites->telemetry, begin);
+}
+
+static void replay_combat(const macac_capture_combat_t* rec, replay_player* player,
+                          const replay_sites* sites) {
+    uint64_t begin = macac_perf_begin();
+    if (!player->combat) {
+        player->combat = macac_combat_accum_create(options.window);
+        if (!player->combat) {
+            return;
+        }
+    }
+    
+    uint64_t stage = macac_perf_begin();
+    double expected_yaw, expected_pitch;
+    macac_calc_aim_angles(rec->attacker_x, rec->attacker_y + EYE_HEIGHT, rec->attacker_z,
+                          rec->target_x, rec->target_y, rec->target_z,
+                          &expected_yaw, &expected_pitch);
+    double aim_error = macac_calc_aim_error(rec->attacker_yaw, rec->attacker_pitch,
+                                            expected_yaw, expected_pitch);
+    double snap = macac_calc_snap_angle(rec->pre_attack_yaw, rec->pre_attack_pitch,
+                                        rec->attacker_yaw, rec->attacker_pitch);
+    double reach = macac_distance_3d(rec->attacker_x, rec->attacker_y, rec->attacker_z,
+                                     rec->target_x, rec->target_y, rec->target_z);
+    macac_perf_end(sites->aim, stage);
+    
+    stage = macac_perf_begin();
+    macac_combat_accum_push(player->combat, MACAC_COMBAT_AIM_ERROR, aim_error);
+    macac_combat_accum_push(player->combat, MACAC_COMBAT_SNAP_ANGLE, snap);
+    macac_combat_accum_push(player->combat, MACAC_COMBAT_REACH, reach);
+    if (rec->time_since_last > 0) {
+        macac_combat_accum_push(player->combat, MACAC_COMBAT_ATTACK_INTERVAL,
+                                (double)rec->time_since_last / 1e6);
+    }
+    macac_combat_accum_push(player->combat, MACAC_COMBAT_HIT,
+                            (rec->flags & MACAC_CAPTURE_HIT) ? 1.0 : 0.0);
+    macac_combat_analysis_t analysis;
+    macac_combat_accum_analyze(player->combat, &analysis);
+    keep(analysis);
+    macac_perf_end(sites->combat_accum, stage);
+    
+    macac_perf_end(sites->combat, begin);
+}
+
+/**
+ * Replay one mapped file. Returns false if it is not a capture.
+ */
+static bool replay_file(const std::string& path,
+                        std::unordered_map<player_key, replay_player, player_key_hash>& players,
+                        macac_history_slab_t* slab, const replay_sites* sites,
+                        replay_totals* totals) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(macac_capture_header_t)) {
+        fprintf(stderr, "%s: not a capture file\n", path.c_str());
+        close(fd);
+        return false;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "cannot map %s\n", path.c_str());
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    
+    const uint8_t* base = (const uint8_t*)map;
+    const macac_capture_header_t* header = (const macac_capture_header_t*)base;
+    if (memcmp(header->magic, MACAC_CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MACAC_CAPTURE_VERSION || header->header_bytes > size) {
+        fprintf(stderr, "%s: not a version %d capture\n", path.c_str(), MACAC_CAPTURE_VERSION);
+        munmap(map, size);
+        return false;
+    }
+    
+    size_t pos = header->header_bytes;
+    while (pos + 4 <= size) {
+        uint16_t type, rec_size;
+        memcpy(&type, base + pos, sizeof(type));
+        memcpy(&rec_size, base + pos + 2, sizeof(rec_size));
+        if (rec_size < 4 || pos + rec_size > size) {
+            break;              // Torn tail of a file still being written
+        }
+        
+        // Records are 8-byte multiples after a 64-byte header, so aligned
+        if (type == MACAC_CAPTURE_TELEMETRY && rec_size == MACAC_CAPTURE_TELEMETRY_SIZE) {
+            const macac_capture_telemetry_t* rec = (const macac_capture_telemetry_t*)(base + pos);
+            replay_player* player = player_for(players, slab, { rec->player_hi, rec->player_lo });
+            replay_telemetry(rec, player, slab, sites);
+            totals->telemetry++;
+        } else if (type == MACAC_CAPTURE_COMBAT && rec_size == MACAC_CAPTURE_COMBAT_SIZE) {
+            const macac_capture_combat_t* rec = (const macac_capture_combat_t*)(base + pos);
+            replay_player* player = player_for(players, slab, { rec->player_hi, rec->player_lo });
+            replay_combat(rec, player, sites);
+            totals->combat++;
+        } else {
+            totals->skipped++;
+        }
+        pos += rec_size;
+    }
+    totals->bytes += pos;
+    
+    munmap(map, size);
+    return true;
+}
+
+static void print_site(const char* label, int site) {
+    macac_perf_snapshot_t snap;
+    if (macac_perf_snapshot(site, &snap) != 0 || snap.count == 0) {
+        return;
+    }
+    printf("  %-22s %12llu %10.1f %10.1f %10.1f %10.1f %12.1f\n", label,
+           (unsigned long long)snap.count, snap.mean_ns, snap.p50_ns,
+           snap.p99_ns, snap.p999_ns, snap.max_ns);
+}
+
+static int run_replay(void) {
+    replay_sites sites;
+    sites.telemetry = macac_perf_register("replay.telemetry");
+    sites.combat = macac_perf_register("replay.combat");
+    sites.slab_push = macac_perf_register("kernel.slab_push");
+    sites.order_stats = macac_perf_register("kernel.order_stats");
+    sites.ringbuffer = macac_perf_register("kernel.ringbuffer");
+    sites.moments = macac_perf_register("kernel.simd_moments");
+    sites.aim = macac_perf_register("kernel.aim");
+    sites.combat_accum = macac_perf_register("kernel.combat_accum");
+    
+    macac_history_slab_t* slab = macac_slab_create(options.slots, METRIC_COUNT, options.window);
+    if (!slab) {
+        fprintf(stderr, "cannot allocate a %zu-slot history slab\n", options.slots);
+        return 1;
+    }
+    
+    std::unordered_map<player_key, replay_player, player_key_hash> players;
+    replay_totals totals;
+    memset(&totals, 0, sizeof(totals));
+    size_t peak_players = 0;
+    
+    int64_t start = wall_nanos();
+    for (int r = 0; r < options.repeats; r++) {
+        // Every pass starts cold, like a fresh server
+        for (auto& entry : players) {
+            macac_slab_release(slab, entry.second.slot);
+        }
+        free_players(players);
+        
+        for (const std::string& path : options.files) {
+            if (!replay_file(path, players, slab, &sites, &totals)) {
+                free_players(players);
+                macac_slab_destroy(slab);
+                return 1;
+            }
+        }
+        peak_players = players.size() > peak_players ? players.size() : peak_players;
+    }
+    double seconds = (double)(wall_nanos() - start) / 1e9;
+    
+    uint64_t events = totals.telemetry + totals.combat;
+    printf("isa:         %s\n", macac_cpu_isa_name(macac_cpu_isa()));
+    printf("files:       %zu x %d pass(es), %.1f MiB\n", options.files.size(), options.repeats,
+           (double)totals.bytes / (1024.0 * 1024.0));
+    printf("events:      %llu (%llu telemetry, %llu combat, %llu skipped)\n",
+           (unsigned long long)events, (unsigned long long)totals.telemetry,
+           (unsigned long long)totals.combat, (unsigned long long)totals.skipped);
+    printf("players:     %zu\n", peak_players);
+    printf("wall time:   %.3f s\n", seconds);
+    printf("throughput:  %.0f events/s\n", seconds > 0 ? (double)events / seconds : 0.0);
+    printf("\n  %-22s %12s %10s %10s %10s %10s %12s\n", "site (ns)", "count", "mean",
+           "p50", "p99", "p99.9", "max");
+    print_site("replay.telemetry", sites.telemetry);
+    print_site("  slab_push", sites.slab_push);
+    print_site("  order_stats", sites.order_stats);
+    print_site("  ringbuffer", sites.ringbuffer);
+    print_site("  simd_moments", sites.moments);
+    print_site("replay.combat", sites.combat);
+    print_site("  aim", sites.aim);
+    print_site("  combat_accum", sites.combat_accum);
+    
+    free_players(players);
+    macac_slab_destroy(slab);
+    return 0;
+}
+
+// ============================================================================
+// Synthesis
+// ============================================================================
+
+/**
+ * Queue a record, waiting for the writer instead of dropping.
+ */
+template <typename Push>
+static void push_blocking(Push push) {
+    while (push() != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+/**
+ * Write a capture of PLAYERS walking and fighting for SECONDS at HZ
+ * samples per second each, with plausible vanilla movement and a few
+ * attacks per second per player. Deterministic for a given seed.
+ */
+static int run_synth(void) {
+    macac_capture_t* capture = macac_capture_open(options.out_prefix.c_str(), 1 << 16,
+                                                  256ull * 1024 * 1024, 0);
+    if (!capture) {
+        fprintf(stderr, "cannot create capture %s\n", options.out_prefix.c_str());
+        return 1;
+    }
+    
+    uint64_t rng = options.seed;
+    int players = options.synth_players;
+    std::vector<player_key> keys(players);
+    std::vector<float> yaw(players), pitch(players);
+    std::vector<double> x(players), z(players);
+    std::vector<int64_t> last_attack(players, 0);
+    for (int p = 0; p < players; p++) {
+        keys[p] = { next_random(&rng), next_random(&rng) };
+        yaw[p] = (float)(next_unit(&rng) * 360.0 - 180.0);
+        x[p] = next_unit(&rng) * 200.0;
+        z[p] = next_unit(&rng) * 200.0;
+    }
+    
+    int64_t period = 1000000000ll / options.synth_hz;
+    int64_t samples = (int64_t)options.synth_seconds * options.synth_hz;
+    int64_t base = macac_nanotime();
+    
+    for (int64_t s = 0; s < samples; s++) {
+        for (int p = 0; p < players; p++) {
+            // Jittered arrival: +-2 ms around the nominal tick
+            int64_t now = base + s * period + (int64_t)((next_unit(&rng) - 0.5) * 4e6);
+            float delta_yaw = (float)((next_unit(&rng) - 0.5) * 12.0);
+            float delta_pitch = (float)((next_unit(&rng) - 0.5) * 4.0);
+            yaw[p] += delta_yaw;
+            pitch[p] = std::fmin(90.0f, std::fmax(-90.0f, pitch[p] + delta_pitch));
+            
+            double speed = 0.1 + next_unit(&rng) * 0.18;
+            double rad = yaw[p] * M_PI / 180.0;
+            
+            macac_telemetry_record_t t;
+            memset(&t, 0, sizeof(t));
+            t.dx = -sin(rad) * speed;
+            t.dz = cos(rad) * speed;
+            t.dy = next_unit(&rng) < 0.05 ? 0.42 : 0.0;
+            t.yaw = yaw[p];
+            t.pitch = pitch[p];
+            t.delta_yaw = delta_yaw;
+            t.delta_pitch = delta_pitch;
+            t.nano_time = now;
+            t.tick_delta = period;
+            t.ping = 20 + (int32_t)(next_unit(&rng) * 60.0);
+            t.flags = t.dy == 0.0 ? MACAC_TELEMETRY_ON_GROUND : 0;
+            x[p] += t.dx;
+            z[p] += t.dz;
+            push_blocking([&] { return macac_capture_telemetry(capture, keys[p].hi, keys[p].lo, &t); });
+            
+            // About four attacks per second
+            if (next_unit(&rng) < 4.0 / options.synth_hz) {
+                macac_capture_combat_t c;
+                memset(&c, 0, sizeof(c));
+                player_key target = keys[(p + 1) % players];
+                c.player_hi = keys[p].hi;
+                c.player_lo = keys[p].lo;
+                c.target_hi = target.hi;
+                c.target_lo = target.lo;
+                c.flags = MACAC_CAPTURE_HAS_TARGET;
+                if (next_unit(&rng) < 0.7) {
+                    c.flags |= MACAC_CAPTURE_HIT;
+                }
+                c.attacker_x = x[p];
+                c.attacker_y = 64.0;
+                c.attacker_z = z[p];
+                double reach = 1.5 + next_unit(&rng) * 1.5;
+                c.target_x = x[p] - sin(rad) * reach;
+                c.target_y = 64.0 + 0.9;
+                c.target_z = z[p] + cos(rad) * reach;
+                c.damage = (c.flags & MACAC_CAPTURE_HIT) ? 4.0 : 0.0;
+                c.attacker_yaw = yaw[p];
+                c.attacker_pitch = pitch[p];
+                c.pre_attack_yaw = yaw[p] - delta_yaw;
+                c.pre_attack_pitch = pitch[p] - delta_pitch;
+                c.nano_time = now;
+                c.time_since_last = last_attack[p] ? now - last_attack[p] : 0;
+                c.ping = t.ping;
+                last_attack[p] = now;
+                push_blocking([&] { return macac_capture_combat(capture, &c); });
+            }
+        }
+    }
+    
+    macac_capture_close(capture);
+    printf("wrote %d players x %d Hz x %d s to %s-*.mcap\n",
+           players, options.synth_hz, options.synth_seconds, options.out_prefix.c_str());
+    return 0;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--repeat N] [--isa scalar|sse2|avx2|avx512|neon]\n"
+            "          [--window N] [--slots N] FILE.mcap...\n"
+            "       %s --synth PLAYERS,HZ,SECONDS --out PREFIX [--seed N]\n",
+            argv0, argv0);
+}
+
+static int parse_isa(const char* name) {
+    for (int isa = MACAC_ISA_SCALAR; isa <= MACAC_ISA_NEON; isa++) {
+        if (strcmp(name, macac_cpu_isa_name(isa)) == 0) {
+            return isa;
+        }
+    }
+    return -1;
+}
+
+static bool parse_args(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            options.files.push_back(arg);
+            continue;
+        }
+        
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+        
+        if (arg == "--repeat") {
+            options.repeats = atoi(value);
+            if (options.repeats <= 0) {
+                return false;
+            }
+        } else if (arg == "--isa") {
+            options.isa = parse_isa(value);
+            if (options.isa < 0) {
+                fprintf(stderr, "unknown ISA %s\n", value);
+                return false;
+            }
+        } else if (arg == "--window") {
+            options.window = (size_t)strtoul(value, nullptr, 10);
+            if (options.window == 0) {
+                return false;
+            }
+        } else if (arg == "--slots") {
+            options.slots = (size_t)strtoul(value, nullptr, 10);
+            if (options.slots == 0) {
+                return false;
+            }
+        } else if (arg == "--synth") {
+            options.synth = sscanf(value, "%d,%d,%d", &options.synth_players,
+                                   &options.synth_hz, &options.synth_seconds) == 3;
+            if (!options.synth || options.synth_players <= 0 || options.synth_hz <= 0 ||
+                options.synth_seconds <= 0) {
+                fprintf(stderr, "--synth expects PLAYERS,HZ,SECONDS\n");
+                return false;
+            }
+        } else if (arg == "--out") {
+            options.out_prefix = value;
+        } else if (arg == "--seed") {
+            options.seed = strtoull(value, nullptr, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    
+    if (options.synth) {
+        return !options.out_prefix.empty();
+    }
+    return !options.files.empty();
+}
+
+int main(int argc, char** argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    macac_cpu_init();
+    if (options.synth) {
+        return run_synth();
+    }
+    
+    if (options.isa >= 0 && macac_cpu_set_isa(options.isa) != 0) {
+        fprintf(stderr, "ISA %s is not supported on this host\n", macac_cpu_isa_name(options.isa));
+        return 1;
+    }
+    return run_replay();
+}
@@ -1,6 +1,9 @@
 package com.macmoment.macac;
 
 import com.macmoment.macac.core.Engine;
+import com.macmoment.macac.pipeline.AnalysisScheduler;
+import com.macmoment.macac.util.Perf;
+import com.macmoment.macac.util.TelemetryCapture;
 
 import org.bukkit.ChatColor;
 import org.bukkit.command.Command;
@@ -14,7 +17,9 @@ import org.bukkit.event.player.PlayerJoinEvent;
 import org.bukkit.event.player.PlayerQuitEvent;
 import org.bukkit.event.player.PlayerTeleportEvent;
 import org.bukkit.plugin.java.JavaPlugin;
+import org.bukkit.scheduler.BukkitTask;
 
+import java.util.List;
 import java.util.Objects;
 import java.util.UUID;
 
@@ -43,9 +48,18 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
     /** Permission required for admin commands. */
     private static final String ADMIN_PERMISSION = "macac.admin";
     
+    /** Longest hardware counter profile, in seconds. */
+    private static final int MAX_PROFILE_SECONDS = 300;
+    
     /** Engine instance; null only before onEnable completes. */
     private Engine engine;
     
+    /** Pending end of a hardware counter profile; main thread only. */
+    private BukkitTask profileTask;
+    
+    /** Who receives the profile report. */
+    private CommandSender profileSender;
+    
     /**
      * Called when the plugin is enabled.
      * 
@@ -78,6 +92,11 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
      */
     @Override
     public void onDisable() {
+        if (profileTask != null) {
+            profileTask.cancel();
+            profileTask = null;
+            Perf.stopProfile();
+        }
         if (engine != null) {
             engine.stop();
             engine = null;
@@ -121,6 +140,9 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
             case "status" -> handleStatus(sender);
             case "exempt" -> handleExempt(sender, args);
             case "unexempt" -> handleUnexempt(sender, args);
+            case "perf" -> handlePerf(sender, args);
+            case "profile" -> handleProfile(sender, args);
+            case "capture" -> handleCapture(sender, args);
             default -> sendHelp(sender);
         }
         
@@ -157,6 +179,12 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
             ChatColor.WHITE + engine.getCheckRegistry().getEnabledChecks().size());
         sender.sendMessage(ChatColor.YELLOW + "Action threshold: " + 
             ChatColor.WHITE + String.format("%.4f", engine.getConfig().getActionConfidence()));
+        
+        final AnalysisScheduler scheduler = engine.getAnalysisScheduler();
+        sender.sendMessage(ChatColor.YELLOW + "Analysis: " + ChatColor.WHITE + (scheduler == null
+            ? "main thread"
+            : scheduler.getThreadCount() + " workers, " + scheduler.getExecutedCount() + " tasks ("
+              + scheduler.getStolenCount() + " stolen)"));
     }
     
     /**
@@ -207,6 +235,156 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
         }
     }
     
+    /**
+     * Handles the perf subcommand: per-site latency percentiles, or a reset.
+     */
+    private void handlePerf(final CommandSender sender, final String[] args) {
+        if (args.length >= 2 && args[1].equalsIgnoreCase("reset")) {
+            Perf.reset();
+            sender.sendMessage(ChatColor.GREEN + "[MacAC] Latency histograms reset.");
+            return;
+        }
+        
+        final List<Perf.Snapshot> snapshots = Perf.snapshot();
+        if (snapshots.isEmpty()) {
+            sender.sendMessage(ChatColor.RED + "[MacAC] No latency samples (native library required).");
+            return;
+        }
+        
+        sender.sendMessage(ChatColor.GOLD + "=== MacAC Latency (us: p50 / p99 / p99.9 / max) ===");
+        for (final Perf.Snapshot s : snapshots) {
+            sender.sendMessage(ChatColor.YELLOW + s.name() + ChatColor.WHITE + String.format(
+                " %.2f / %.2f / %.2f / %.2f" + ChatColor.GRAY + " (n=%d)",
+                s.p50Nanos() / 1000.0, s.p99Nanos() / 1000.0, s.p999Nanos() / 1000.0,
+                s.maxNanos() / 1000.0, s.count()));
+        }
+    }
+    
+    /**
+     * Handles the profile subcommand: count hardware events per timing site
+     * for a number of seconds, then report them.
+     */
+    private void handleProfile(final CommandSender sender, final String[] args) {
+        if (args.length >= 2 && args[1].equalsIgnoreCase("stop")) {
+            if (profileTask == null) {
+                sender.sendMessage(ChatColor.RED + "[MacAC] No profile running.");
+                return;
+            }
+            profileTask.cancel();
+            finishProfile();
+            return;
+        }
+        
+        final int seconds;
+        try {
+            seconds = args.length >= 2 ? Integer.parseInt(args[1]) : 0;
+        } catch (final NumberFormatException e) {
+            sender.sendMessage(ChatColor.RED + "Usage: /macac profile <seconds>|stop");
+            return;
+        }
+        if (seconds < 1 || seconds > MAX_PROFILE_SECONDS) {
+            sender.sendMessage(ChatColor.RED + "Usage: /macac profile <1-" + MAX_PROFILE_SECONDS + ">|stop");
+            return;
+        }
+        if (profileTask != null) {
+            sender.sendMessage(ChatColor.RED + "[MacAC] A profile is already running.");
+            return;
+        }
+        
+        final int events = Perf.startProfile();
+        if (events == 0) {
+            sender.sendMessage(ChatColor.RED + "[MacAC] Perf events unavailable (native library, Linux "
+                + "and kernel.perf_event_paranoid <= 2 required).");
+            return;
+        }
+        if ((events & Perf.HARDWARE_EVENTS) == 0) {
+            sender.sendMessage(ChatColor.YELLOW + "[MacAC] No hardware counters on this host (VM?); "
+                + "profiling CPU time only.");
+        }
+        
+        profileSender = sender;
+        profileTask = getServer().getScheduler().runTaskLater(this, this::finishProfile, seconds * 20L);
+        sender.sendMessage(ChatColor.GREEN + "[MacAC] Profiling for " + seconds + "s...");
+    }
+    
+    /**
+     * Ends the running profile and reports per-scope counter means.
+     */
+    private void finishProfile() {
+        Perf.stopProfile();
+        final CommandSender sender = profileSender;
+        profileTask = null;
+        profileSender = null;
+        if (sender == null) {
+            return;
+        }
+        
+        final List<Perf.Counters> counters = Perf.counters();
+        if (counters.isEmpty()) {
+            sender.sendMessage(ChatColor.YELLOW + "[MacAC] Profile finished: no timed scopes ran.");
+            return;
+        }
+        
+        sender.sendMessage(ChatColor.GOLD + "=== MacAC Profile (per scope: cycles / IPC / L1D / LLC / "
+            + "branch misses / GHz / CPU us) ===");
+        for (final Perf.Counters c : counters) {
+            sender.sendMessage(ChatColor.YELLOW + c.name() + ChatColor.WHITE + " "
+                + formatCounter(c, Perf.EVENT_CYCLES, c.perScope(c.cycles()), "%.0f") + " / "
+                + (c.has(Perf.EVENT_CYCLES | Perf.EVENT_INSTRUCTIONS) ? String.format("%.2f", c.ipc()) : "-") + " / "
+                + formatCounter(c, Perf.EVENT_L1D_MISSES, c.perScope(c.l1dMisses()), "%.1f") + " / "
+                + formatCounter(c, Perf.EVENT_LLC_MISSES, c.perScope(c.llcMisses()), "%.1f") + " / "
+                + formatCounter(c, Perf.EVENT_BRANCH_MISSES, c.perScope(c.branchMisses()), "%.1f") + " / "
+                + (c.has(Perf.EVENT_CYCLES | Perf.EVENT_TASK_CLOCK) ? String.format("%.2f", c.gigahertz()) : "-") + " / "
+                + formatCounter(c, Perf.EVENT_TASK_CLOCK, c.perScope(c.taskClockNanos()) / 1000.0, "%.2f")
+                + ChatColor.GRAY + String.format(" (n=%d, %d multiplexed)", c.scopes(), c.partial()));
+        }
+    }
+    
+    /**
+     * Formats a per-scope counter, or "-" if the event was not counted.
+     */
+    private static String formatCounter(final Perf.Counters counters, final int event,
+                                         final double value, final String format) {
+        return counters.has(event) ? String.format(format, value) : "-";
+    }
+    
+    /**
+     * Handles the capture subcommand: start, stop or report telemetry recording.
+     */
+    private void handleCapture(final CommandSender sender, final String[] args) {
+        if (engine == null) {
+            sender.sendMessage(ChatColor.RED + "[MacAC] Engine not initialized.");
+            return;
+        }
+        
+        final String action = args.length >= 2 ? args[1].toLowerCase() : "status";
+        switch (action) {
+            case "start" -> {
+                final TelemetryCapture capture = engine.startCapture();
+                if (capture != null) {
+                    sender.sendMessage(ChatColor.GREEN + "[MacAC] Capturing to " + capture.prefix() + "-*.mcap");
+                } else {
+                    sender.sendMessage(ChatColor.RED + "[MacAC] Could not start capture (see console).");
+                }
+            }
+            case "stop" -> sender.sendMessage(engine.stopCapture()
+                ? ChatColor.GREEN + "[MacAC] Capture stopped."
+                : ChatColor.RED + "[MacAC] No capture running.");
+            case "status" -> {
+                final TelemetryCapture capture = engine.getCapture();
+                if (capture == null) {
+                    sender.sendMessage(ChatColor.YELLOW + "[MacAC] No capture running.");
+                    return;
+                }
+                final long[] stats = capture.stats();
+                sender.sendMessage(ChatColor.YELLOW + "[MacAC] Capturing to " + capture.prefix() + "-*.mcap"
+                    + ChatColor.WHITE + String.format(": %d samples, %.1f MiB in %d file(s), %d dropped, %d errors",
+                        stats[0], stats[2] / (1024.0 * 1024.0), stats[3], stats[1], stats[4]));
+            }
+            default -> sender.sendMessage(ChatColor.RED + "Usage: /macac capture [start|stop|status]");
+        }
+    }
+    
     /**
      * Sends help message with available commands.
      */
@@ -216,6 +394,9 @@ public final class MacACPlugin extends JavaPlugin implements Listener {
         sender.sendMessage(ChatColor.YELLOW + "/macac status" + ChatColor.GRAY + " - Show engine status");
         sender.sendMessage(ChatColor.YELLOW + "/macac exempt <player>" + ChatColor.GRAY + " - Exempt a player");
         sender.sendMessage(ChatColor.YELLOW + "/macac unexempt <player>" + ChatColor.GRAY + " - Remove exemption");
+        sender.sendMessage(ChatColor.YELLOW + "/macac perf [reset]" + ChatColor.GRAY + " - Show pipeline latency");
+        sender.sendMessage(ChatColor.YELLOW + "/macac profile <seconds>|stop" + ChatColor.GRAY + " - Count hardware events per site");
+        sender.sendMessage(ChatColor.YELLOW + "/macac capture [start|stop|status]" + ChatColor.GRAY + " - Record telemetry for replay");
     }
     
     // ========================================================================
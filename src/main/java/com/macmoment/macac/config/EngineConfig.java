@@ -1,8 +1,15 @@
 package com.macmoment.macac.config;
 
+import com.macmoment.macac.network.Coalescing;
+import com.macmoment.macac.network.Endpoint;
+import com.macmoment.macac.network.Spill;
+import com.macmoment.macac.network.WireProtocol;
+
 import org.bukkit.configuration.file.FileConfiguration;
 import org.bukkit.plugin.java.JavaPlugin;
 
+import java.io.File;
+import java.util.ArrayList;
 import java.util.HashSet;
 import java.util.List;
 import java.util.Set;
@@ -26,12 +33,30 @@ public final class EngineConfig {
     // History
     private int historySize;
     private int medianWindowSize;
+    private int nativeHistorySlots;
+    private String historyNativeStorage;
+    private String historyPersistPath;
+    private int historySyncSeconds;
+    
+    // Telemetry capture
+    private boolean captureEnabled;
+    private String captureDirectory;
+    private long captureMaxFileBytes;
+    private int captureMaxFiles;
+    
+    // Population baseline
+    private boolean populationEnabled;
+    private int populationCompression;
+    private long populationWindowMs;
+    private long populationMinSamples;
+    private int populationRefreshTicks;
     
     // Checks
     private boolean packetTimingEnabled;
     private double packetTimingWeight;
     private long packetTimingMinDeltaMs;
     private double packetTimingMaxJitter;
+    private double packetTimingPopulationQuantile;
     
     private boolean movementConsistencyEnabled;
     private double movementConsistencyWeight;
@@ -61,6 +86,7 @@ public final class EngineConfig {
     // Performance
     private int maxChecksPerTick;
     private boolean asyncPackets;
+    private int analysisThreads;
     private boolean debug;
     
     // Stats
@@ -87,6 +113,17 @@ public final class EngineConfig {
     
     private int combatMinSamples;
     private int combatHistorySize;
+    
+    // Analytics
+    private boolean analyticsEnabled;
+    private String analyticsHost;
+    private int analyticsPort;
+    private int analyticsConnectTimeoutMs;
+    private int analyticsReconnectDelayMs;
+    private WireProtocol analyticsProtocol;
+    private List<Endpoint> analyticsEndpoints;
+    private Coalescing analyticsCoalescing;
+    private Spill analyticsSpill;
 
     /**
      * Loads configuration from the plugin's config.yml.
@@ -97,8 +134,18 @@ public final class EngineConfig {
     public static EngineConfig load(JavaPlugin plugin) {
         plugin.saveDefaultConfig();
         plugin.reloadConfig();
-        FileConfiguration config = plugin.getConfig();
-        
+        return load(plugin.getConfig(), plugin.getDataFolder());
+    }
+    
+    /**
+     * Loads configuration from an already-parsed config.yml. Used by
+     * offline tools that run the pipeline without a server.
+     * 
+     * @param config Parsed configuration
+     * @param dataFolder Directory that relative file settings resolve against
+     * @return Loaded configuration
+     */
+    public static EngineConfig load(FileConfiguration config, File dataFolder) {
         EngineConfig ec = new EngineConfig();
         
         // Thresholds
@@ -114,12 +161,33 @@ public final class EngineConfig {
         // History
         ec.historySize = Math.max(1, config.getInt("history.size", 64));
         ec.medianWindowSize = Math.max(1, config.getInt("stats.median_window", 20));
+        ec.nativeHistorySlots = Math.max(0, config.getInt("history.native_slots", 0));
+        ec.historyNativeStorage = config.getString("history.native_storage", "f64");
+        String persistFile = config.getString("history.persist_file", "history.bin");
+        ec.historyPersistPath = persistFile == null || persistFile.isBlank()
+            ? null
+            : new File(dataFolder, persistFile).getPath();
+        ec.historySyncSeconds = Math.min(3600, Math.max(1, config.getInt("history.sync_interval_seconds", 5)));
+        
+        // Telemetry capture
+        ec.captureEnabled = config.getBoolean("capture.enabled", false);
+        ec.captureDirectory = new File(dataFolder, config.getString("capture.directory", "captures")).getPath();
+        ec.captureMaxFileBytes = Math.min(4096L, Math.max(1L, config.getLong("capture.max_file_mb", 256))) * 1024L * 1024L;
+        ec.captureMaxFiles = Math.min(100_000, Math.max(0, config.getInt("capture.max_files", 16)));
+        
+        // Population baseline
+        ec.populationEnabled = config.getBoolean("population.enabled", false);
+        ec.populationCompression = Math.min(1000, Math.max(20, config.getInt("population.compression", 200)));
+        ec.populationWindowMs = Math.min(86_400L, Math.max(0L, config.getLong("population.window_seconds", 600))) * 1000L;
+        ec.populationMinSamples = Math.max(1L, config.getLong("population.min_samples", 5000));
+        ec.populationRefreshTicks = Math.min(1200, Math.max(1, config.getInt("population.refresh_ticks", 20)));
         
         // Packet timing check
         ec.packetTimingEnabled = config.getBoolean("checks.packet_timing.enabled", true);
         ec.packetTimingWeight = clamp(config.getDouble("checks.packet_timing.weight", 1.0), 0.0, 10.0);
         ec.packetTimingMinDeltaMs = config.getLong("checks.packet_timing.min_delta_ms", 5);
         ec.packetTimingMaxJitter = config.getDouble("checks.packet_timing.max_jitter_coefficient", 3.0);
+        ec.packetTimingPopulationQuantile = clamp(config.getDouble("checks.packet_timing.population_quantile", 0.0), 0.0, 1.0);
         
         // Movement consistency check
         ec.movementConsistencyEnabled = config.getBoolean("checks.movement_consistency.enabled", true);
@@ -160,6 +228,7 @@ public final class EngineConfig {
         // Performance
         ec.maxChecksPerTick = Math.max(1, config.getInt("performance.max_checks_per_tick", 10));
         ec.asyncPackets = config.getBoolean("performance.async_packets", true);
+        ec.analysisThreads = Math.min(64, Math.max(0, config.getInt("performance.analysis_threads", 0)));
         ec.debug = config.getBoolean("performance.debug", false);
         
         // Stats
@@ -190,6 +259,55 @@ public final class EngineConfig {
         ec.combatMinSamples = Math.max(3, config.getInt("checks.combat.min_samples", 10));
         ec.combatHistorySize = Math.max(10, config.getInt("checks.combat.history_size", 50));
         
+        // Analytics
+        ec.analyticsEnabled = config.getBoolean("analytics.enabled", false);
+        ec.analyticsHost = config.getString("analytics.host", "127.0.0.1");
+        ec.analyticsPort = Math.max(1, Math.min(65535, config.getInt("analytics.port", 9500)));
+        ec.analyticsConnectTimeoutMs = Math.max(100, config.getInt("analytics.connect_timeout_ms", 3000));
+        ec.analyticsReconnectDelayMs = Math.max(100, config.getInt("analytics.reconnect_delay_ms", 1000));
+        ec.analyticsProtocol = WireProtocol.fromConfig(config.getString("analytics.protocol", "json"));
+        
+        // Endpoint pool; invalid entries are skipped, and an empty list
+        // falls back to host/port
+        ec.analyticsEndpoints = new ArrayList<>();
+        for (String entry : config.getStringList("analytics.endpoints")) {
+            if (entry == null || entry.isBlank() || ec.analyticsEndpoints.size() >= Endpoint.MAX_ENDPOINTS) {
+                continue;
+            }
+            try {
+                ec.analyticsEndpoints.add(Endpoint.parse(entry, ec.analyticsPort));
+            } catch (IllegalArgumentException ignored) {
+                // Skip invalid endpoints
+            }
+        }
+        if (ec.analyticsEndpoints.isEmpty()) {
+            try {
+                ec.analyticsEndpoints.add(Endpoint.parse(ec.analyticsHost, ec.analyticsPort));
+            } catch (IllegalArgumentException e) {
+                ec.analyticsEndpoints.add(new Endpoint("127.0.0.1", ec.analyticsPort));
+            }
+        }
+        ec.analyticsEndpoints = List.copyOf(ec.analyticsEndpoints);
+        
+        // Coalescing (native sender only)
+        if (config.getBoolean("analytics.coalesce.enabled", false)) {
+            ec.analyticsCoalescing = new Coalescing(
+                Math.max(10, config.getInt("analytics.coalesce.window_ms", 1000)),
+                Math.max(16, config.getInt("analytics.coalesce.max_records", 4096)),
+                Math.max(0, config.getInt("analytics.coalesce.flush_count", 64)));
+        }
+        
+        // On-disk spill during outages (native sender only)
+        if (config.getBoolean("analytics.spill.enabled", false)) {
+            long segmentBytes = Math.min(1024L, Math.max(1L, config.getLong("analytics.spill.segment_mb", 4))) * 1024L * 1024L;
+            long maxBytes = Math.min(1L << 20, Math.max(1L, config.getLong("analytics.spill.max_mb", 64))) * 1024L * 1024L;
+            ec.analyticsSpill = new Spill(
+                new File(dataFolder, config.getString("analytics.spill.directory", "analytics-spill")).getPath(),
+                Math.max(segmentBytes, maxBytes),
+                segmentBytes,
+                Math.max(0, config.getInt("analytics.spill.high_water", 0)));
+        }
+        
         return ec;
     }
 
@@ -208,11 +326,27 @@ public final class EngineConfig {
     
     public int getHistorySize() { return historySize; }
     public int getMedianWindowSize() { return medianWindowSize; }
+    public int getNativeHistorySlots() { return nativeHistorySlots; }
+    public String getHistoryNativeStorage() { return historyNativeStorage; }
+    public String getHistoryPersistPath() { return historyPersistPath; }
+    public int getHistorySyncSeconds() { return historySyncSeconds; }
+    
+    public boolean isCaptureEnabled() { return captureEnabled; }
+    public String getCaptureDirectory() { return captureDirectory; }
+    public long getCaptureMaxFileBytes() { return captureMaxFileBytes; }
+    public int getCaptureMaxFiles() { return captureMaxFiles; }
+    
+    public boolean isPopulationEnabled() { return populationEnabled; }
+    public int getPopulationCompression() { return populationCompression; }
+    public long getPopulationWindowMs() { return populationWindowMs; }
+    public long getPopulationMinSamples() { return populationMinSamples; }
+    public int getPopulationRefreshTicks() { return populationRefreshTicks; }
     
     public boolean isPacketTimingEnabled() { return packetTimingEnabled; }
     public double getPacketTimingWeight() { return packetTimingWeight; }
     public long getPacketTimingMinDeltaMs() { return packetTimingMinDeltaMs; }
     public double getPacketTimingMaxJitter() { return packetTimingMaxJitter; }
+    public double getPacketTimingPopulationQuantile() { return packetTimingPopulationQuantile; }
     
     public boolean isMovementConsistencyEnabled() { return movementConsistencyEnabled; }
     public double getMovementConsistencyWeight() { return movementConsistencyWeight; }
@@ -239,6 +373,7 @@ public final class EngineConfig {
     
     public int getMaxChecksPerTick() { return maxChecksPerTick; }
     public boolean isAsyncPackets() { return asyncPackets; }
+    public int getAnalysisThreads() { return analysisThreads; }
     public boolean isDebug() { return debug; }
     
     public boolean isUseEwma() { return useEwma; }
@@ -267,4 +402,15 @@ public final class EngineConfig {
     // Combat shared settings
     public int getCombatMinSamples() { return combatMinSamples; }
     public int getCombatHistorySize() { return combatHistorySize; }
+    
+    // Analytics
+    public boolean isAnalyticsEnabled() { return analyticsEnabled; }
+    public String getAnalyticsHost() { return analyticsHost; }
+    public int getAnalyticsPort() { return analyticsPort; }
+    public int getAnalyticsConnectTimeoutMs() { return analyticsConnectTimeoutMs; }
+    public int getAnalyticsReconnectDelayMs() { return analyticsReconnectDelayMs; }
+    public WireProtocol getAnalyticsProtocol() { return analyticsProtocol; }
+    public List<Endpoint> getAnalyticsEndpoints() { return analyticsEndpoints; }
+    public Coalescing getAnalyticsCoalescing() { return analyticsCoalescing; }
+    public Spill getAnalyticsSpill() { return analyticsSpill; }
 }
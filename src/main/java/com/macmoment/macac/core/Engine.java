@@ -8,13 +8,21 @@ import com.macmoment.macac.ingest.PacketIngestor;
 import com.macmoment.macac.ingest.impl.FallbackEventIngestor;
 import com.macmoment.macac.ingest.impl.ProtocolLibPacketIngestor;
 import com.macmoment.macac.model.*;
+import com.macmoment.macac.network.AnalyticsClient;
 import com.macmoment.macac.pipeline.*;
+import com.macmoment.macac.util.HistorySlab;
 import com.macmoment.macac.util.MonoClock;
+import com.macmoment.macac.util.Perf;
+import com.macmoment.macac.util.PopulationBaseline;
+import com.macmoment.macac.util.TelemetryCapture;
 
 import org.bukkit.entity.Player;
 import org.bukkit.plugin.java.JavaPlugin;
+import org.bukkit.scheduler.BukkitTask;
 
+import java.io.File;
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.List;
 import java.util.Objects;
 import java.util.UUID;
@@ -38,8 +46,10 @@ import java.util.logging.Logger;
  * longer needed to release resources.
  * 
  * <p><strong>Thread Safety:</strong> This class is designed for single-threaded
- * access from the main server thread, with the exception of telemetry processing
- * which may occur asynchronously depending on the ingestor configuration.
+ * access from the main server thread. With {@code performance.async_packets},
+ * feature extraction, checks and aggregation run on an {@link AnalysisScheduler}
+ * (one thread per player at a time); the resulting violations come back to the
+ * main thread for mitigation, alerts and punishments.
  * 
  * @author MacAC Development Team
  * @since 1.0.0
@@ -55,6 +65,12 @@ public final class Engine {
     /** Ticks for world change exemption window (1 second = 20 ticks). */
     private static final long WORLD_CHANGE_EXEMPTION_TICKS = 20L;
     
+    /** Upper bound on analysis completions handled per tick. */
+    private static final int MAX_COMPLETIONS_PER_TICK = 4096;
+    
+    /** How long stop() waits for analysis workers to finish queued work. */
+    private static final long SCHEDULER_SHUTDOWN_MS = 2000L;
+    
     private final JavaPlugin plugin;
     private final Logger logger;
     private final MonoClock clock;
@@ -72,10 +88,39 @@ public final class Engine {
     private final AlertPublisher alertPublisher;
     private final PunishmentHandler punishmentHandler;
     private final WhitelistManager whitelistManager;
+    private final MovementPredictor movementPredictor;
+    
+    // Optional analytics reporting (null when disabled)
+    private volatile AnalyticsClient analyticsClient;
+    
+    // Off-thread analysis (null when running inline on the main thread)
+    private volatile AnalysisScheduler scheduler;
+    private BukkitTask completionTask;
+    
+    // Background flush of the history file (null when history is not persistent)
+    private BukkitTask historySyncTask;
+    
+    // Server-wide feature baseline and its background merge (null when disabled)
+    private volatile PopulationBaseline population;
+    private BukkitTask populationTask;
+    
+    // Recording of ingested telemetry (null when not capturing)
+    private volatile TelemetryCapture capture;
+    
+    // Reused by processTelemetryBatch (main thread only)
+    private UUID[] batchIds = new UUID[0];
+    private Runnable[] batchTasks = new Runnable[0];
+    private MovementPrediction[] batchPredictions = new MovementPrediction[0];
+    private int[] batchSlots = new int[0];
     
     // Engine state
     private volatile boolean running;
     
+    // Latency sites (Perf.NO_SITE without the native library)
+    private final int perfProcess;
+    private final int perfFeatures;
+    private final int perfAggregate;
+    
     /**
      * Creates a new engine instance for the specified plugin.
      * 
@@ -99,6 +144,11 @@ public final class Engine {
         this.alertPublisher = new AlertPublisher(plugin);
         this.punishmentHandler = new PunishmentHandler(plugin);
         this.whitelistManager = new WhitelistManager();
+        this.movementPredictor = new MovementPredictor();
+        
+        this.perfProcess = Perf.site("engine.process");
+        this.perfFeatures = Perf.site("features.extract");
+        this.perfAggregate = Perf.site("aggregator.aggregate");
         
         this.running = false;
     }
@@ -140,12 +190,21 @@ public final class Engine {
             return;
         }
         
+        startPopulation();
+        startScheduler();
+        startHistorySync();
+        if (config.isCaptureEnabled()) {
+            startCapture();
+        }
+        
         // Start the ingestor with our telemetry callback
         if (ingestor != null) {
             ingestor.setCallback(this::processTelemetry);
+            ingestor.setBatchCallback(this::processTelemetryBatch);
             ingestor.start();
         }
         
+        startAnalytics();
         running = true;
         
         final String ingestorName = (ingestor != null) ? ingestor.getName() : "none";
@@ -170,7 +229,17 @@ public final class Engine {
             ingestor.stop();
         }
         
-        historyStore.clear();
+        // Packet threads may still be recording (the ingestor does not wait
+        // for in-flight handlers); close() waits for those calls
+        final TelemetryCapture c = capture;
+        capture = null;
+        closeCapture(c);
+        
+        stopScheduler();
+        stopPopulation();
+        stopAnalytics(true);
+        stopHistorySync();
+        historyStore.close();
         
         logger.info("MacAC engine stopped");
     }
@@ -187,6 +256,13 @@ public final class Engine {
         config = EngineConfig.load(plugin);
         configureComponents();
         
+        // Endpoint or protocol may have changed; the old client flushes in
+        // the background so the server thread does not wait on the network
+        if (running) {
+            stopAnalytics(false);
+            startAnalytics();
+        }
+        
         logger.info("MacAC configuration reloaded");
     }
     
@@ -201,6 +277,206 @@ public final class Engine {
         alertPublisher.configure(config);
         punishmentHandler.configure(config);
         whitelistManager.configure(config);
+        movementPredictor.configure(config.getMinDriftSamples());
+    }
+    
+    /**
+     * Starts the analytics client if enabled in the current configuration.
+     */
+    private void startAnalytics() {
+        if (!config.isAnalyticsEnabled()) {
+            return;
+        }
+        
+        final AnalyticsClient client = new AnalyticsClient(
+            config.getAnalyticsEndpoints(),
+            config.getAnalyticsConnectTimeoutMs(),
+            config.getAnalyticsReconnectDelayMs(),
+            config.getAnalyticsProtocol(),
+            config.getAnalyticsCoalescing(),
+            config.getAnalyticsSpill());
+        client.start();
+        analyticsClient = client;
+    }
+    
+    /**
+     * Flushes and stops the analytics client, if any.
+     * 
+     * @param wait true to return only once the flush is done; false to
+     *             leave it to a background thread
+     */
+    private void stopAnalytics(boolean wait) {
+        final AnalyticsClient client = analyticsClient;
+        analyticsClient = null;
+        if (client == null) {
+            return;
+        }
+        if (wait) {
+            client.stop();
+        } else {
+            client.stopInBackground();
+        }
+    }
+    
+    /**
+     * Starts the analysis workers and the per-tick completion drain if
+     * async analysis is enabled.
+     */
+    private void startScheduler() {
+        if (!config.isAsyncPackets()) {
+            return;
+        }
+        
+        final int threads = config.getAnalysisThreads() > 0
+            ? config.getAnalysisThreads()
+            : AnalysisScheduler.defaultThreads();
+        final AnalysisScheduler s = new AnalysisScheduler(threads, logger);
+        scheduler = s;
+        completionTask = plugin.getServer().getScheduler().runTaskTimer(
+            plugin, () -> s.drainCompletions(MAX_COMPLETIONS_PER_TICK), 1L, 1L);
+        logger.info("Analysis running on " + threads + " worker thread(s)");
+    }
+    
+    /**
+     * Lets workers finish queued analysis and stops them. Returns only once
+     * no analysis task is running, so the native state closed after it is
+     * no longer in use. Decisions still waiting for the main thread are dropped.
+     */
+    private void stopScheduler() {
+        final AnalysisScheduler s = scheduler;
+        scheduler = null;
+        if (completionTask != null) {
+            completionTask.cancel();
+            completionTask = null;
+        }
+        if (s != null) {
+            s.shutdown(SCHEDULER_SHUTDOWN_MS);
+        }
+    }
+    
+    /**
+     * Creates the population baseline, attaches it to feature extraction
+     * and the checks, and schedules its background merge.
+     */
+    private void startPopulation() {
+        if (!config.isPopulationEnabled()) {
+            return;
+        }
+        
+        final PopulationBaseline p = PopulationBaseline.create(config.getPopulationCompression(),
+            config.getPopulationWindowMs(), config.getPopulationMinSamples());
+        if (p == null) {
+            logger.info("Population baseline unavailable (native library required)");
+            return;
+        }
+        population = p;
+        featureExtractor.setPopulation(p);
+        checkRegistry.setPopulation(p);
+        final long period = config.getPopulationRefreshTicks();
+        populationTask = plugin.getServer().getScheduler().runTaskTimerAsynchronously(
+            plugin, p::refresh, period, period);
+    }
+    
+    /**
+     * Detaches and frees the population baseline. Runs after the analysis
+     * workers have stopped, so nothing records into it any more.
+     */
+    private void stopPopulation() {
+        final PopulationBaseline p = population;
+        population = null;
+        if (populationTask != null) {
+            populationTask.cancel();
+            populationTask = null;
+        }
+        featureExtractor.setPopulation(null);
+        checkRegistry.setPopulation(null);
+        if (p != null) {
+            p.close();
+        }
+    }
+    
+    /**
+     * Schedules periodic write-back of the history file when the slab is
+     * file-backed. The flush only queues I/O, but runs off the main thread
+     * anyway so a slow disk can never stall a tick.
+     */
+    private void startHistorySync() {
+        final HistorySlab slab = historyStore.getSlab();
+        if (slab == null || !slab.isPersistent()) {
+            if (config.getHistoryPersistPath() != null && slab != null) {
+                logger.warning("Could not map history file " + config.getHistoryPersistPath()
+                    + "; player history will not survive restarts");
+            }
+            return;
+        }
+        
+        final long period = config.getHistorySyncSeconds() * 20L;
+        historySyncTask = plugin.getServer().getScheduler().runTaskTimerAsynchronously(
+            plugin, historyStore::sync, period, period);
+        logger.info("History file mapped with " + slab.dormantCount() + " restorable player(s)");
+    }
+    
+    private void stopHistorySync() {
+        if (historySyncTask != null) {
+            historySyncTask.cancel();
+            historySyncTask = null;
+        }
+    }
+    
+    /**
+     * Starts recording ingested telemetry to capture files in the configured
+     * directory. Main thread only.
+     * 
+     * @return the running capture, or null if it could not be started
+     */
+    public TelemetryCapture startCapture() {
+        final TelemetryCapture current = capture;
+        if (current != null) {
+            return current;
+        }
+        
+        final File directory = new File(config.getCaptureDirectory());
+        if (!directory.isDirectory() && !directory.mkdirs()) {
+            logger.warning("Could not create capture directory " + directory);
+            return null;
+        }
+        final TelemetryCapture c = TelemetryCapture.open(new File(directory, "capture").getPath(),
+            config.getCaptureMaxFileBytes(), config.getCaptureMaxFiles());
+        if (c == null) {
+            logger.warning("Could not start telemetry capture in " + directory
+                + " (native library required)");
+            return null;
+        }
+        capture = c;
+        logger.info("Capturing telemetry to " + c.prefix() + "-*.mcap");
+        return c;
+    }
+    
+    /**
+     * Stops recording. Packet threads may still be inside a record call on
+     * the old handle; the capture's close() waits for them. Main thread only.
+     * 
+     * @return true if a capture was running
+     */
+    public boolean stopCapture() {
+        final TelemetryCapture c = capture;
+        if (c == null) {
+            return false;
+        }
+        capture = null;
+        closeCapture(c);
+        return true;
+    }
+    
+    private void closeCapture(final TelemetryCapture c) {
+        if (c == null) {
+            return;
+        }
+        // Counters die with the handle, so read them just before closing
+        final long[] stats = c.stats();
+        c.close();
+        logger.info("Telemetry capture stopped: " + stats[3] + " file(s), "
+            + stats[1] + " sample(s) dropped");
     }
     
     /**
@@ -220,21 +496,137 @@ public final class Engine {
     }
     
     /**
-     * Main telemetry processing pipeline.
+     * Entry point for each movement packet/event.
      * 
-     * <p>This method is called for each movement packet/event and executes
-     * the complete detection pipeline: feature extraction, check execution,
-     * result aggregation, and action execution.
+     * <p>Runs the detection pipeline inline, or queues it on the player's
+     * analysis lane when async analysis is enabled.
      * 
      * @param player the player whose movement is being processed
      * @param input the telemetry data from the movement
      */
     private void processTelemetry(final Player player, final TelemetryInput input) {
+        processTelemetry(player, input, null);
+    }
+    
+    /**
+     * Runs or queues the pipeline for one movement with the prediction the
+     * tick's batch computed for it, if any.
+     */
+    private void processTelemetry(final Player player, final TelemetryInput input,
+                                  final MovementPrediction prediction) {
         // Early exit conditions
         if (!running || player == null || input == null) {
             return;
         }
         
+        final TelemetryCapture c = capture;
+        if (c != null) {
+            c.telemetry(player.getUniqueId(), input);
+        }
+        
+        final AnalysisScheduler s = scheduler;
+        if (s == null || !s.submit(player.getUniqueId(), () -> analyzeTelemetry(player, input, prediction, s))) {
+            analyzeTelemetry(player, input, prediction, null);
+        }
+    }
+    
+    /**
+     * Entry point for one tick's worth of batched telemetry: movement is
+     * predicted for every player in one native step, then the batch is
+     * submitted to the analysis workers in one call, waking each worker at
+     * most once.
+     */
+    private void processTelemetryBatch(final Player[] players, final TelemetryInput[] inputs,
+                                       final int count) {
+        if (!running) {
+            return;
+        }
+        
+        if (batchIds.length < count) {
+            batchIds = new UUID[count];
+            batchTasks = new Runnable[count];
+            batchPredictions = new MovementPrediction[count];
+            batchSlots = new int[count];
+        }
+        predictMovement(players, inputs, count);
+        
+        final AnalysisScheduler s = scheduler;
+        if (s == null) {
+            for (int i = 0; i < count; i++) {
+                processTelemetry(players[i], inputs[i], batchPredictions[i]);
+            }
+            Arrays.fill(batchPredictions, 0, count, null);
+            return;
+        }
+        
+        final TelemetryCapture c = capture;
+        int queued = 0;
+        for (int i = 0; i < count; i++) {
+            final Player player = players[i];
+            final TelemetryInput input = inputs[i];
+            if (player != null && input != null) {
+                if (c != null) {
+                    c.telemetry(player.getUniqueId(), input);
+                }
+                final MovementPrediction prediction = batchPredictions[i];
+                batchIds[queued] = player.getUniqueId();
+                batchTasks[queued] = () -> analyzeTelemetry(player, input, prediction, s);
+                queued++;
+            }
+        }
+        s.submitAll(batchIds, batchTasks, queued);
+        
+        Arrays.fill(batchIds, 0, queued, null);
+        Arrays.fill(batchTasks, 0, queued, null);
+        Arrays.fill(batchPredictions, 0, count, null);
+    }
+    
+    /**
+     * Fills batchPredictions for a batch, null for players with too little
+     * history or an exemption. Main thread only.
+     */
+    private void predictMovement(final Player[] players, final TelemetryInput[] inputs,
+                                 final int count) {
+        final MovementPredictor predictor = movementPredictor;
+        final int[] slots = batchSlots;
+        predictor.begin(count);
+        for (int i = 0; i < count; i++) {
+            final Player player = players[i];
+            final TelemetryInput input = inputs[i];
+            slots[i] = -1;
+            if (player != null && input != null && !whitelistManager.isExempt(player.getUniqueId())) {
+                slots[i] = predictor.add(player.getUniqueId(), input);
+            }
+        }
+        predictor.predict();
+        
+        for (int i = 0; i < count; i++) {
+            batchPredictions[i] = slots[i] >= 0 ? predictor.prediction(slots[i]) : null;
+        }
+        predictor.clear();
+    }
+    
+    /**
+     * Main telemetry processing pipeline.
+     * 
+     * <p>Executes feature extraction, check execution and result aggregation
+     * for one movement. A resulting violation goes through mitigation and
+     * action execution here when running inline, or is posted back to the
+     * main thread when running on an analysis worker.
+     * 
+     * @param player the player whose movement is being processed
+     * @param input the telemetry data from the movement
+     * @param prediction batched movement prediction for the input, or null
+     * @param async scheduler that owns this call, or null when inline
+     */
+    private void analyzeTelemetry(final Player player, final TelemetryInput input,
+                                  final MovementPrediction prediction,
+                                  final AnalysisScheduler async) {
+        if (!running) {
+            return;
+        }
+        
+        final long perfStart = Perf.begin();
         try {
             final UUID playerId = player.getUniqueId();
             final String playerName = player.getName();
@@ -251,7 +643,9 @@ public final class Engine {
             context.addTelemetry(input);
             
             // Extract features from raw telemetry
+            final long featuresStart = Perf.begin();
             final Features features = featureExtractor.extract(input, context);
+            Perf.end(perfFeatures, featuresStart);
             context.addFeatures(features);
             
             // Handle lag-based exemption
@@ -262,28 +656,51 @@ public final class Engine {
             }
             
             // Execute all enabled checks
+            context.setMovementPrediction(prediction);
             final List<CheckResult> results = executeChecks(input, features, context);
+            context.setMovementPrediction(null);
             
             // Aggregate check results into a potential violation
+            final long aggregateStart = Perf.begin();
             final Violation violation = aggregator.aggregate(
                 results, context, input.nanoTime(), input.ping());
+            Perf.end(perfAggregate, aggregateStart);
             
             if (violation == null) {
                 return;
             }
             
-            // Apply mitigation policy to determine action
-            final Decision decision = mitigationPolicy.evaluate(violation, context, player);
-            
-            // Execute the decision
-            executeDecision(decision);
+            // Mitigation and actions use the Bukkit API: main thread only
+            if (async != null) {
+                async.complete(() -> decide(violation, context, player));
+            } else {
+                decide(violation, context, player);
+            }
             
         } catch (final Exception e) {
             logger.log(Level.SEVERE, "Error processing telemetry", e);
             if (config != null && config.isDebug()) {
                 e.printStackTrace();
             }
+        } finally {
+            Perf.end(perfProcess, perfStart);
+        }
+    }
+    
+    /**
+     * Applies the mitigation policy to a violation and executes the decision.
+     * Main thread only.
+     */
+    private void decide(final Violation violation, final PlayerContext context, final Player player) {
+        if (!running) {
+            return;
         }
+        
+        // Apply mitigation policy to determine action
+        final Decision decision = mitigationPolicy.evaluate(violation, context, player);
+        
+        // Execute the decision
+        executeDecision(decision);
     }
     
     /**
@@ -296,11 +713,14 @@ public final class Engine {
         final List<CheckResult> results = new ArrayList<>(enabledChecks.size());
         
         for (final Check check : enabledChecks) {
+            final long checkStart = Perf.begin();
             try {
                 final CheckResult result = check.analyze(input, features, context);
                 results.add(result);
             } catch (final Exception e) {
                 logger.warning("Error in check " + check.getName() + ": " + e.getMessage());
+            } finally {
+                Perf.end(checkRegistry.perfSite(check), checkStart);
             }
         }
         
@@ -316,9 +736,13 @@ public final class Engine {
         }
         
         switch (decision.action()) {
-            case ALERT -> alertPublisher.publish(decision.violation());
+            case ALERT -> {
+                alertPublisher.publish(decision.violation());
+                reportViolation(decision.violation());
+            }
             case PUNISH -> {
                 alertPublisher.publish(decision.violation());
+                reportViolation(decision.violation());
                 punishmentHandler.execute(decision);
             }
             case FLAG -> debugLog("FLAG: " + decision.violation().playerName() + 
@@ -327,6 +751,16 @@ public final class Engine {
         }
     }
     
+    /**
+     * Queues a violation for the analytics server. Never blocks.
+     */
+    private void reportViolation(final Violation violation) {
+        final AnalyticsClient client = analyticsClient;
+        if (client != null) {
+            client.sendViolation(violation);
+        }
+    }
+    
     // ========================================================================
     // Player Lifecycle Methods
     // ========================================================================
@@ -366,7 +800,14 @@ public final class Engine {
     public void onPlayerQuit(final UUID playerId) {
         Objects.requireNonNull(playerId, "playerId must not be null");
         
-        historyStore.remove(playerId);
+        // Analysis still queued for the player runs before its context goes
+        final AnalysisScheduler s = scheduler;
+        if (s != null) {
+            s.retire(playerId, () -> historyStore.remove(playerId));
+        } else {
+            historyStore.remove(playerId);
+        }
+        movementPredictor.remove(playerId);
         
         // Clean up ingestor-specific state
         if (ingestor instanceof FallbackEventIngestor fallback) {
@@ -420,7 +861,14 @@ public final class Engine {
         }
         
         mitigationPolicy.setWorldChanging(context, true);
-        context.reset(); // Clear history for new world
+        movementPredictor.remove(playerId);
+        
+        // Clear history for new world, on the player's analysis lane so the
+        // history keeps a single writer
+        final AnalysisScheduler s = scheduler;
+        if (s == null || !s.submit(playerId, context::reset)) {
+            context.reset();
+        }
         
         // Clear flag after exemption window
         scheduleTask(() -> {
@@ -482,6 +930,24 @@ public final class Engine {
         return checkRegistry; 
     }
     
+    /**
+     * Returns the analysis scheduler.
+     * 
+     * @return scheduler; null when analysis runs on the main thread
+     */
+    public AnalysisScheduler getAnalysisScheduler() {
+        return scheduler;
+    }
+    
+    /**
+     * Returns the running telemetry capture.
+     * 
+     * @return capture; null when not capturing
+     */
+    public TelemetryCapture getCapture() {
+        return capture;
+    }
+    
     /**
      * Returns the whitelist manager.
      * 
@@ -491,6 +957,24 @@ public final class Engine {
         return whitelistManager; 
     }
     
+    /**
+     * Returns the analytics client.
+     * 
+     * @return analytics client; null when analytics is disabled or stopped
+     */
+    public AnalyticsClient getAnalyticsClient() {
+        return analyticsClient;
+    }
+    
+    /**
+     * Returns the server-wide feature baseline.
+     * 
+     * @return baseline; null when disabled, unavailable or stopped
+     */
+    public PopulationBaseline getPopulation() {
+        return population;
+    }
+    
     /**
      * Returns whether the engine is currently running.
      * 
@@ -42,4 +42,31 @@ public interface PacketIngestor {
      * @param callback Callback that receives player and telemetry
      */
     void setCallback(BiConsumer<Player, TelemetryInput> callback);
+    
+    /**
+     * Receiver for telemetry delivered in batches.
+     */
+    @FunctionalInterface
+    interface BatchCallback {
+        
+        /**
+         * Receives one batch. The arrays are reused by the ingestor and are
+         * only valid for the duration of the call.
+         * 
+         * @param players Player of each entry
+         * @param inputs Telemetry of each entry
+         * @param count Number of valid entries
+         */
+        void accept(Player[] players, TelemetryInput[] inputs, int count);
+    }
+    
+    /**
+     * Sets a callback for ingestors that collect telemetry into batches.
+     * When set, batched telemetry goes here instead of the per-packet
+     * callback. Ingestors that deliver one event at a time ignore it.
+     * 
+     * @param callback Callback that receives a batch, or null to disable
+     */
+    default void setBatchCallback(BatchCallback callback) {
+    }
 }
@@ -3,15 +3,21 @@ package com.macmoment.macac.ingest.impl;
 import com.macmoment.macac.ingest.PacketIngestor;
 import com.macmoment.macac.model.TelemetryInput;
 import com.macmoment.macac.util.MonoClock;
+import com.macmoment.macac.util.NativeHelper;
+import com.macmoment.macac.util.PacketQueue;
 
 import org.bukkit.Bukkit;
 import org.bukkit.Location;
 import org.bukkit.entity.Player;
 import org.bukkit.plugin.java.JavaPlugin;
+import org.bukkit.scheduler.BukkitTask;
 
+import java.util.ArrayDeque;
+import java.util.Arrays;
 import java.util.Map;
 import java.util.UUID;
 import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicReferenceArray;
 import java.util.function.BiConsumer;
 import java.util.logging.Logger;
 
@@ -20,26 +26,57 @@ import java.util.logging.Logger;
  * Provides lower-latency and more detailed movement data than Bukkit events.
  * 
  * Falls back gracefully if ProtocolLib is not available.
+ * 
+ * <p>Packets arrive on netty I/O threads. When the native library is loaded
+ * they are handed to the main thread through a lock-free MPSC
+ * {@link PacketQueue} of fixed-size records, drained in batches once per
+ * tick; otherwise the callback runs directly on the packet thread.
  */
 public final class ProtocolLibPacketIngestor implements PacketIngestor {
     
     private static final String NAME = "ProtocolLib";
     
+    // Records queued between drains; ~20 packets/s/player leaves ample headroom
+    private static final int QUEUE_CAPACITY = 16384;
+    private static final int DRAIN_BATCH = 256;
+    
+    // Player ids are slot | generation << SLOT_BITS, so a record queued
+    // before a quit never resolves to the slot's next occupant
+    private static final int SLOT_BITS = 12;
+    private static final int MAX_SLOTS = 1 << SLOT_BITS;
+    private static final int NO_SLOT = -1;
+    
     private final JavaPlugin plugin;
     private final MonoClock clock;
     private final Logger logger;
     private final Map<UUID, PlayerState> playerStates;
     
     private BiConsumer<Player, TelemetryInput> callback;
+    private BatchCallback batchCallback;
     private volatile boolean active;
     private Object packetAdapter; // ProtocolLib PacketAdapter stored as Object for soft dependency
     
+    // Hand-off to the main thread (null without native)
+    private volatile PacketQueue queue;
+    private BukkitTask drainTask;
+    private final AtomicReferenceArray<PlayerState> slots;
+    private final int[] slotGenerations;
+    private final ArrayDeque<Integer> freeSlots;
+    private int nextSlot;
+    
+    // Reused batch arrays (main thread only)
+    private final Player[] batchPlayers = new Player[DRAIN_BATCH];
+    private final TelemetryInput[] batchInputs = new TelemetryInput[DRAIN_BATCH];
+    
     public ProtocolLibPacketIngestor(JavaPlugin plugin, MonoClock clock) {
         this.plugin = plugin;
         this.clock = clock;
         this.logger = plugin.getLogger();
         this.playerStates = new ConcurrentHashMap<>();
         this.active = false;
+        this.slots = new AtomicReferenceArray<>(MAX_SLOTS);
+        this.slotGenerations = new int[MAX_SLOTS];
+        this.freeSlots = new ArrayDeque<>();
     }
     
     @Override
@@ -54,10 +91,13 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
         }
         
         try {
+            startQueue();
             registerPacketListener();
             active = true;
-            logger.info("ProtocolLibPacketIngestor started");
+            logger.info("ProtocolLibPacketIngestor started" +
+                (queue != null ? " (native packet queue)" : ""));
         } catch (Exception e) {
+            stopQueue();
             logger.warning("Failed to start ProtocolLibPacketIngestor: " + e.getMessage());
         }
     }
@@ -68,14 +108,17 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
             return;
         }
         
+        active = false;
         try {
             unregisterPacketListener();
         } catch (Exception e) {
             logger.warning("Error stopping ProtocolLibPacketIngestor: " + e.getMessage());
         }
         
-        playerStates.clear();
-        active = false;
+        stopQueue();
+        for (final UUID playerId : playerStates.keySet()) {
+            removePlayer(playerId);
+        }
         logger.info("ProtocolLibPacketIngestor stopped");
     }
     
@@ -94,6 +137,11 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
         this.callback = callback;
     }
     
+    @Override
+    public void setBatchCallback(BatchCallback callback) {
+        this.batchCallback = callback;
+    }
+    
     /**
      * Checks if ProtocolLib is available.
      * 
@@ -103,6 +151,128 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
         return Bukkit.getPluginManager().getPlugin("ProtocolLib") != null;
     }
     
+    /**
+     * Number of packets dropped because the hand-off queue was full.
+     * 
+     * @return dropped packets, or 0 if packets are dispatched directly
+     */
+    public long getDroppedPackets() {
+        final PacketQueue q = queue;
+        return q != null ? q.dropped() : 0L;
+    }
+    
+    /**
+     * Creates the packet queue and its per-tick drain task if native is available.
+     */
+    private void startQueue() {
+        queue = PacketQueue.create(QUEUE_CAPACITY, NativeHelper.QUEUE_MPSC, DRAIN_BATCH);
+        if (queue != null) {
+            drainTask = Bukkit.getScheduler().runTaskTimer(plugin, this::drainQueue, 1L, 1L);
+        }
+    }
+    
+    /**
+     * Dispatches what is still queued, then frees the queue. Packet threads
+     * may still be offering; close() waits for them, and what they queue
+     * after the final drain is discarded.
+     */
+    private void stopQueue() {
+        if (drainTask != null) {
+            drainTask.cancel();
+            drainTask = null;
+        }
+        
+        final PacketQueue q = queue;
+        if (q != null) {
+            drainQueue();
+            queue = null;
+            q.close();
+        }
+    }
+    
+    /**
+     * Main-thread consumer: moves queued packets to the callback in batches.
+     * Bounded to one queue's worth per tick so a burst cannot stall the tick.
+     */
+    private void drainQueue() {
+        final PacketQueue q = queue;
+        final BiConsumer<Player, TelemetryInput> cb = callback;
+        final BatchCallback batchCb = batchCallback;
+        if (q == null) {
+            return;
+        }
+        
+        for (int drained = 0; drained < QUEUE_CAPACITY; ) {
+            final int count = q.drain();
+            if (batchCb != null) {
+                dispatchBatch(q, count, batchCb);
+            } else {
+                for (int i = 0; i < count; i++) {
+                    final PlayerState state = stateForId(q.player(i));
+                    if (state != null && cb != null) {
+                        cb.accept(state.player, q.input(i));
+                    }
+                }
+            }
+            if (count < q.batchSize()) {
+                break;
+            }
+            drained += count;
+        }
+    }
+    
+    private void dispatchBatch(final PacketQueue q, final int count, final BatchCallback batchCb) {
+        int valid = 0;
+        for (int i = 0; i < count; i++) {
+            final PlayerState state = stateForId(q.player(i));
+            if (state != null) {
+                batchPlayers[valid] = state.player;
+                batchInputs[valid] = q.input(i);
+                valid++;
+            }
+        }
+        if (valid > 0) {
+            batchCb.accept(batchPlayers, batchInputs, valid);
+        }
+        
+        // Do not pin players or telemetry between ticks
+        Arrays.fill(batchPlayers, 0, valid, null);
+        Arrays.fill(batchInputs, 0, valid, null);
+    }
+    
+    private PlayerState stateForId(final int id) {
+        if (id < 0) {
+            return null;
+        }
+        final PlayerState state = slots.get(id & (MAX_SLOTS - 1));
+        return state != null && state.id == id ? state : null;
+    }
+    
+    /**
+     * Assigns a generation-tagged player id; runs once per join, not per packet.
+     */
+    private synchronized int acquireId() {
+        final int slot;
+        if (!freeSlots.isEmpty()) {
+            slot = freeSlots.poll();
+        } else if (nextSlot < MAX_SLOTS) {
+            slot = nextSlot++;
+        } else {
+            return NO_SLOT;
+        }
+        // Keep ids non-negative: 31 - SLOT_BITS generation bits
+        slotGenerations[slot] = (slotGenerations[slot] + 1) & ((1 << (31 - SLOT_BITS)) - 1);
+        return slot | (slotGenerations[slot] << SLOT_BITS);
+    }
+    
+    private synchronized void releaseId(final int id) {
+        if (id >= 0) {
+            final int slot = id & (MAX_SLOTS - 1);
+            slots.set(slot, null);
+            freeSlots.add(slot);
+        }
+    }
+    
     /**
      * Registers the ProtocolLib packet listener.
      */
@@ -215,8 +385,12 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
         
         PlayerState state = playerStates.computeIfAbsent(playerId, id -> {
             Location loc = player.getLocation();
-            return new PlayerState(loc.getX(), loc.getY(), loc.getZ(), 
-                                  loc.getYaw(), loc.getPitch(), now);
+            PlayerState created = new PlayerState(player, acquireId(), loc.getX(), loc.getY(),
+                                                  loc.getZ(), loc.getYaw(), loc.getPitch(), now);
+            if (created.id != NO_SLOT) {
+                slots.set(created.id & (MAX_SLOTS - 1), created);
+            }
+            return created;
         });
         
         // Calculate deltas
@@ -233,6 +407,26 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
         
         long tickDelta = now - state.lastNanos;
         
+        // Update state
+        state.lastX = x;
+        state.lastY = y;
+        state.lastZ = z;
+        state.lastYaw = yaw;
+        state.lastPitch = pitch;
+        state.lastNanos = now;
+        
+        // Hand off to the main thread without allocating; a racing stop()
+        // waits for this offer before it frees the queue
+        final PacketQueue q = queue;
+        if (q != null && state.id != NO_SLOT) {
+            q.offer(state.id,
+                    PacketQueue.flags(onGround, player.isInsideVehicle(), false,
+                                      player.isSwimming(), player.isGliding(), player.isClimbing()),
+                    dx, dy, dz, yaw, pitch, deltaYaw, deltaPitch,
+                    player.getPing(), now, tickDelta);
+            return;
+        }
+        
         // Build telemetry
         TelemetryInput input = TelemetryInput.builder()
             .dx(dx)
@@ -253,14 +447,6 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
             .tickDelta(tickDelta)
             .build();
         
-        // Update state
-        state.lastX = x;
-        state.lastY = y;
-        state.lastZ = z;
-        state.lastYaw = yaw;
-        state.lastPitch = pitch;
-        state.lastNanos = now;
-        
         // Dispatch callback
         callback.accept(player, input);
     }
@@ -271,22 +457,26 @@ public final class ProtocolLibPacketIngestor implements PacketIngestor {
      * @param playerId Player UUID
      */
     public void removePlayer(UUID playerId) {
-        playerStates.remove(playerId);
+        PlayerState state = playerStates.remove(playerId);
+        if (state != null) {
+            releaseId(state.id);
+        }
     }
     
     /**
      * Internal state tracking per player.
      */
     private static class PlayerState {
+        final Player player;
+        final int id;               // Queue player id, or NO_SLOT
         double lastX, lastY, lastZ;
         float lastYaw, lastPitch;
         long lastNanos;
         
-        PlayerState() {
-            this(0, 0, 0, 0, 0, 0);
-        }
-        
-        PlayerState(double x, double y, double z, float yaw, float pitch, long nanos) {
+        PlayerState(Player player, int id, double x, double y, double z,
+                    float yaw, float pitch, long nanos) {
+            this.player = player;
+            this.id = id;
             this.lastX = x;
             this.lastY = y;
             this.lastZ = z;
@@ -57,11 +57,11 @@ public final class CombatContext {
         this.playerId = playerId;
         this.playerName = playerName;
         this.combatHistory = new RingBuffer<>(historySize);
-        this.aimErrorWindow = new Stats.RollingWindow(windowSize);
-        this.snapAngleWindow = new Stats.RollingWindow(windowSize);
-        this.reachWindow = new Stats.RollingWindow(windowSize);
-        this.attackIntervalWindow = new Stats.RollingWindow(windowSize);
-        this.hitRateWindow = new Stats.RollingWindow(windowSize);
+        this.aimErrorWindow = Stats.RollingWindow.create(windowSize);
+        this.snapAngleWindow = Stats.RollingWindow.create(windowSize);
+        this.reachWindow = Stats.RollingWindow.create(windowSize);
+        this.attackIntervalWindow = Stats.RollingWindow.create(windowSize);
+        this.hitRateWindow = Stats.RollingWindow.create(windowSize);
         this.aimErrorEwma = new Stats.EWMA(ewmaAlpha);
         this.snapAngleEwma = new Stats.EWMA(ewmaAlpha);
         this.reachEwma = new Stats.EWMA(ewmaAlpha);
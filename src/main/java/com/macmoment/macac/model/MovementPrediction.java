@@ -0,0 +1,46 @@
+package com.macmoment.macac.model;
+
+import com.macmoment.macac.util.RingBuffer;
+
+/**
+ * One tick's movement prediction for a player, computed for the whole
+ * server in one batch before the player's checks run.
+ * 
+ * <p>The inputs the prediction was built from are read in place from the
+ * predictor's ring for the player: {@code window} of them, the newest at
+ * {@code ring[newest]} and older ones backwards. Consumers use the
+ * prediction only if they match the player's own history, so an input the
+ * batch never saw cannot skew a check. The main thread keeps writing the
+ * ring; a slot overwritten by a later tick holds an input the history
+ * cannot contain yet, so it only makes the match fail.
+ */
+public record MovementPrediction(
+    double predictedDx,         // Expected movement this tick
+    double predictedDy,
+    double predictedDz,
+    double drift,               // Distance between observed and expected movement
+    TelemetryInput[] ring,      // Predictor's input ring for the player; read only
+    int newest,                 // Ring index of the input preceding this one
+    int window                  // Inputs averaged into the prediction
+) {
+    /**
+     * Returns true if this prediction was built from exactly the inputs at
+     * ages 1 to {@code samples} of a history.
+     * 
+     * @param history Player telemetry history, newest at age 0
+     * @param samples Window length the consumer expects
+     */
+    public boolean matches(RingBuffer<TelemetryInput> history, int samples) {
+        if (window != samples || history.size() <= samples) {
+            return false;
+        }
+        int index = newest;
+        for (int i = 0; i < samples; i++) {
+            if (history.get(i + 1) != ring[index]) {
+                return false;
+            }
+            index = index == 0 ? ring.length - 1 : index - 1;
+        }
+        return true;
+    }
+}
@@ -1,5 +1,6 @@
 package com.macmoment.macac.model;
 
+import com.macmoment.macac.util.HistorySlab;
 import com.macmoment.macac.util.RingBuffer;
 import com.macmoment.macac.util.Stats;
 
@@ -10,6 +11,14 @@ import java.util.UUID;
  * This class is thread-safe for single-writer operations.
  */
 public final class PlayerContext {
+    
+    // Native history slab metric columns
+    public static final int SLAB_METRIC_PING = 0;
+    public static final int SLAB_METRIC_PACKET_DELTA = 1;
+    public static final int SLAB_METRIC_HORIZ_SPEED = 2;
+    public static final int SLAB_METRIC_VERT_SPEED = 3;
+    public static final int SLAB_METRIC_COUNT = 4;
+    
     private final UUID playerId;
     private final String playerName;
     
@@ -36,6 +45,13 @@ public final class PlayerContext {
     private volatile boolean teleporting;
     private volatile boolean worldChanging;
     private volatile boolean recentJoin;
+    
+    // Native history slab slot (optional)
+    private volatile HistorySlab slab;
+    private volatile long slabSlot = HistorySlab.NO_SLOT;
+    
+    // Batched prediction for the input being analyzed (analysis lane only)
+    private MovementPrediction movementPrediction;
 
     /**
      * Creates a new player context.
@@ -52,8 +68,8 @@ public final class PlayerContext {
         this.playerName = playerName;
         this.telemetryHistory = new RingBuffer<>(historySize);
         this.featureHistory = new RingBuffer<>(historySize);
-        this.pingWindow = new Stats.RollingWindow(pingWindowSize);
-        this.packetDeltaWindow = new Stats.RollingWindow(pingWindowSize);
+        this.pingWindow = Stats.RollingWindow.create(pingWindowSize);
+        this.packetDeltaWindow = Stats.RollingWindow.create(pingWindowSize);
         this.pingEwma = new Stats.EWMA(ewmaAlpha);
         this.speedEwma = new Stats.EWMA(ewmaAlpha);
         this.accelEwma = new Stats.EWMA(ewmaAlpha);
@@ -79,6 +95,69 @@ public final class PlayerContext {
     public Stats.EWMA getSpeedEwma() { return speedEwma; }
     public Stats.EWMA getAccelEwma() { return accelEwma; }
     
+    // Native history slab
+    public HistorySlab getSlab() { return slab; }
+    public long getSlabSlot() { return slabSlot; }
+    
+    /**
+     * Prediction computed for the current input by the tick's batch, or
+     * null when there is none. Set and cleared around the checks.
+     */
+    public MovementPrediction getMovementPrediction() { return movementPrediction; }
+    public void setMovementPrediction(MovementPrediction prediction) { this.movementPrediction = prediction; }
+    
+    /**
+     * Attaches a native history slab slot that mirrors this player's windows.
+     * 
+     * @param slab History slab
+     * @param slotId Slot id acquired from the slab
+     */
+    public void attachSlab(HistorySlab slab, long slotId) {
+        this.slabSlot = slotId;
+        this.slab = slab;
+    }
+    
+    /**
+     * Seeds the Java-side windows and EWMAs from the attached slab slot,
+     * oldest sample first. Used when the slot was handed back with history
+     * from an earlier session, so checks have a baseline immediately.
+     * 
+     * @return Number of ping samples restored
+     */
+    public int restoreFromSlab() {
+        HistorySlab s = slab;
+        long slot = slabSlot;
+        if (s == null) {
+            return 0;
+        }
+        
+        int pings = s.size(slot, SLAB_METRIC_PING);
+        for (int age = pings - 1; age >= 0; age--) {
+            double ping = s.get(slot, SLAB_METRIC_PING, age);
+            pingWindow.add(ping);
+            pingEwma.update(ping);
+        }
+        for (int age = s.size(slot, SLAB_METRIC_PACKET_DELTA) - 1; age >= 0; age--) {
+            packetDeltaWindow.add(s.get(slot, SLAB_METRIC_PACKET_DELTA, age));
+        }
+        for (int age = s.size(slot, SLAB_METRIC_HORIZ_SPEED) - 1; age >= 0; age--) {
+            speedEwma.update(s.get(slot, SLAB_METRIC_HORIZ_SPEED, age));
+        }
+        return pings;
+    }
+    
+    /**
+     * Detaches the native history slab slot.
+     * 
+     * @return The previously attached slot id, or {@link HistorySlab#NO_SLOT}
+     */
+    public long detachSlab() {
+        long slotId = slabSlot;
+        this.slab = null;
+        this.slabSlot = HistorySlab.NO_SLOT;
+        return slotId;
+    }
+    
     // Timing
     public long getLastTelemetryNanos() { return lastTelemetryNanos; }
     public void setLastTelemetryNanos(long nanos) { this.lastTelemetryNanos = nanos; }
@@ -143,9 +222,19 @@ public final class PlayerContext {
         pingWindow.add(input.ping());
         pingEwma.update(input.ping());
         
+        HistorySlab s = slab;
+        long slot = slabSlot;
+        if (s != null) {
+            s.push(slot, SLAB_METRIC_PING, input.ping());
+        }
+        
         if (lastTelemetryNanos > 0 && input.nanoTime() > lastTelemetryNanos) {
             long deltaNanos = input.nanoTime() - lastTelemetryNanos;
-            packetDeltaWindow.add(deltaNanos / 1_000_000.0); // Convert to ms
+            double deltaMs = deltaNanos / 1_000_000.0; // Convert to ms
+            packetDeltaWindow.add(deltaMs);
+            if (s != null) {
+                s.push(slot, SLAB_METRIC_PACKET_DELTA, deltaMs);
+            }
         }
         lastTelemetryNanos = input.nanoTime();
     }
@@ -159,6 +248,13 @@ public final class PlayerContext {
         featureHistory.push(features);
         speedEwma.update(features.horizSpeed());
         accelEwma.update(features.horizAccel());
+        
+        HistorySlab s = slab;
+        if (s != null) {
+            long slot = slabSlot;
+            s.push(slot, SLAB_METRIC_HORIZ_SPEED, features.horizSpeed());
+            s.push(slot, SLAB_METRIC_VERT_SPEED, features.vertSpeed());
+        }
     }
     
     /**
@@ -190,7 +286,20 @@ public final class PlayerContext {
         pingEwma.reset();
         speedEwma.reset();
         accelEwma.reset();
+        
+        // Recycle the slab slot so its native windows start empty
+        HistorySlab s = slab;
+        if (s != null) {
+            s.release(slabSlot);
+            long slot = s.acquire(playerId);
+            slabSlot = slot;
+            if (slot == HistorySlab.NO_SLOT) {
+                slab = null;
+            }
+        }
+        
         lastTelemetryNanos = 0;
+        movementPrediction = null;
         totalViolations = 0;
         recentViolations = 0;
         teleporting = false;
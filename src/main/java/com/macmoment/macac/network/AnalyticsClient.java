@@ -4,14 +4,27 @@ import com.macmoment.macac.model.Violation;
 import com.macmoment.macac.util.NativeHelper;
 
 import java.io.BufferedWriter;
+import java.io.DataInputStream;
 import java.io.IOException;
+import java.io.OutputStream;
 import java.io.OutputStreamWriter;
+import java.nio.file.Files;
+import java.nio.file.Paths;
 import java.net.InetSocketAddress;
 import java.net.Socket;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
 import java.util.concurrent.BlockingQueue;
 import java.util.concurrent.LinkedBlockingQueue;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.locks.ReadWriteLock;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
 import java.util.logging.Logger;
 
 /**
@@ -22,33 +35,94 @@ import java.util.logging.Logger;
  * - Async non-blocking sends via queue
  * - Auto-reconnection on failure
  * - Graceful degradation if native not available
+ * - JSON lines or binary frames ({@link WireProtocol})
+ * 
+ * When the native library is loaded, violations go straight into the native
+ * sender's lock-free queue and are serialized and written by its own I/O
+ * thread; the calling thread never formats, locks on I/O or makes syscalls.
+ * Otherwise a Java sender thread drains a {@link BlockingQueue}.
+ * 
+ * With several {@link Endpoint}s the native sender keeps one connection
+ * per collector, shards violations by player UUID and fails over to the
+ * next healthy collector when one drops or stalls. The Java fallback talks
+ * to one collector at a time and moves to the next on failure.
+ * 
+ * With {@link Coalescing} the native sender is fronted by a coalescer that
+ * merges each player's violations per category into one summary record per
+ * window, so a burst of near-identical reports costs one message.
+ * 
+ * With {@link Spill} the native sender keeps reports on disk while no
+ * collector is reachable and replays them in order afterwards, so an outage
+ * neither blocks the caller nor loses reports (up to the disk budget).
  */
 public final class AnalyticsClient {
     
     private static final Logger LOGGER = Logger.getLogger(AnalyticsClient.class.getName());
     
-    private final String host;
-    private final int port;
+    /** Maximum queued violations before new ones are dropped. */
+    private static final int QUEUE_CAPACITY = 1000;
+    
+    /** Time allowed for queued violations to drain on stop. */
+    private static final int STOP_FLUSH_TIMEOUT_MS = 2000;
+    
+    /** Worst-case binary send: every category definition plus one full batch. */
+    private static final int FRAME_BUFFER_BYTES =
+        BinaryWireFormat.MAX_CATEGORIES * (BinaryWireFormat.FRAME_HEADER_BYTES + 3 + BinaryWireFormat.MAX_CATEGORY_NAME)
+        + BinaryWireFormat.MAX_BATCH * (BinaryWireFormat.FRAME_HEADER_BYTES + BinaryWireFormat.RECORD_BYTES);
+    
+    // Background releases still running in any client; a spilling sender
+    // opens only once they are done, since only one can hold a spill directory
+    private static final Object CLOSING_LOCK = new Object();
+    private static int closingCount;
+    
+    private final List<Endpoint> endpoints;
     private final int connectTimeoutMs;
     private final int reconnectDelayMs;
+    private final WireProtocol protocol;
+    private final Coalescing coalescing;
+    private final Spill spill;
     
     // Connection state
     private final AtomicBoolean running;
     private final AtomicBoolean connected;
     private final BlockingQueue<Violation> sendQueue;
+    private final AtomicLong droppedCount;
+    
+    // Native async sender (if available); guarded by senderLock so a
+    // concurrent stop() cannot free it under a producer
+    private final ReadWriteLock senderLock;
+    private long nativeSender;
+    private long nativeCoalescer;
+    private boolean nativeSpill;
     
     // Native connection (if available)
     private long nativeHandle;
     
-    // Java fallback connection
+    // Java fallback connection (sender thread only): current endpoint and
+    // how often the fallback moved off one
     private Socket socket;
     private BufferedWriter writer;
+    private int endpointIndex;
+    private final AtomicLong failoverCount;
+    
+    // Java fallback binary framing (sender thread only); category ids are
+    // per connection and reset on every connect
+    private OutputStream binaryOut;
+    private final Map<String, Integer> categoryIds;
+    private final ByteBuffer frameBuffer;
+    private final List<Violation> pending;
+    private final int[] pendingIds;
     
     // Sender thread
     private Thread senderThread;
     
+    // Release started by stopInBackground(), and the thread that starts
+    // the sender once releases in its way are done (see start())
+    private Thread closer;
+    private Thread starter;
+    
     /**
-     * Creates a new analytics client.
+     * Creates a new analytics client using the JSON protocol.
      * 
      * @param host Server hostname
      * @param port Server port
@@ -56,19 +130,103 @@ public final class AnalyticsClient {
      * @param reconnectDelayMs Delay between reconnection attempts
      */
     public AnalyticsClient(String host, int port, int connectTimeoutMs, int reconnectDelayMs) {
-        this.host = host;
-        this.port = port;
+        this(host, port, connectTimeoutMs, reconnectDelayMs, WireProtocol.JSON);
+    }
+    
+    /**
+     * Creates a new analytics client.
+     * 
+     * @param host Server hostname
+     * @param port Server port
+     * @param connectTimeoutMs Connection timeout in milliseconds
+     * @param reconnectDelayMs Delay between reconnection attempts
+     * @param protocol Wire protocol
+     */
+    public AnalyticsClient(String host, int port, int connectTimeoutMs, int reconnectDelayMs,
+                           WireProtocol protocol) {
+        this(List.of(new Endpoint(host, port)), connectTimeoutMs, reconnectDelayMs, protocol);
+    }
+    
+    /**
+     * Creates a new analytics client over a pool of collectors.
+     * 
+     * @param endpoints Collectors, in shard order (1 to {@link Endpoint#MAX_ENDPOINTS})
+     * @param connectTimeoutMs Connection timeout in milliseconds; also how
+     *        long a collector may refuse writes before it counts as stalled
+     * @param reconnectDelayMs Delay between reconnection attempts
+     * @param protocol Wire protocol
+     * @throws IllegalArgumentException if the endpoint list is empty or too long
+     */
+    public AnalyticsClient(List<Endpoint> endpoints, int connectTimeoutMs, int reconnectDelayMs,
+                           WireProtocol protocol) {
+        this(endpoints, connectTimeoutMs, reconnectDelayMs, protocol, null);
+    }
+    
+    /**
+     * Creates a new analytics client over a pool of collectors, optionally
+     * coalescing violations before they are sent.
+     * 
+     * @param endpoints Collectors, in shard order (1 to {@link Endpoint#MAX_ENDPOINTS})
+     * @param connectTimeoutMs Connection timeout in milliseconds; also how
+     *        long a collector may refuse writes before it counts as stalled
+     * @param reconnectDelayMs Delay between reconnection attempts
+     * @param protocol Wire protocol
+     * @param coalescing Coalescing settings, or null to send every violation
+     * @throws IllegalArgumentException if the endpoint list is empty or too long
+     */
+    public AnalyticsClient(List<Endpoint> endpoints, int connectTimeoutMs, int reconnectDelayMs,
+                           WireProtocol protocol, Coalescing coalescing) {
+        this(endpoints, connectTimeoutMs, reconnectDelayMs, protocol, coalescing, null);
+    }
+    
+    /**
+     * Creates a new analytics client over a pool of collectors, optionally
+     * coalescing violations and spilling them to disk during outages.
+     * 
+     * @param endpoints Collectors, in shard order (1 to {@link Endpoint#MAX_ENDPOINTS})
+     * @param connectTimeoutMs Connection timeout in milliseconds; also how
+     *        long a collector may refuse writes before it counts as stalled
+     * @param reconnectDelayMs Delay between reconnection attempts
+     * @param protocol Wire protocol
+     * @param coalescing Coalescing settings, or null to send every violation
+     * @param spill Spill settings, or null to drop reports the queue cannot hold
+     * @throws IllegalArgumentException if the endpoint list is empty or too long
+     */
+    public AnalyticsClient(List<Endpoint> endpoints, int connectTimeoutMs, int reconnectDelayMs,
+                           WireProtocol protocol, Coalescing coalescing, Spill spill) {
+        if (endpoints == null || endpoints.isEmpty() || endpoints.size() > Endpoint.MAX_ENDPOINTS) {
+            throw new IllegalArgumentException("Expected 1 to " + Endpoint.MAX_ENDPOINTS + " endpoints");
+        }
+        this.endpoints = List.copyOf(endpoints);
         this.connectTimeoutMs = connectTimeoutMs;
         this.reconnectDelayMs = reconnectDelayMs;
+        this.protocol = protocol != null ? protocol : WireProtocol.JSON;
+        this.coalescing = coalescing;
+        this.spill = spill;
         this.running = new AtomicBoolean(false);
         this.connected = new AtomicBoolean(false);
-        this.sendQueue = new LinkedBlockingQueue<>(1000); // Max 1000 queued
+        this.sendQueue = new LinkedBlockingQueue<>(QUEUE_CAPACITY);
+        this.droppedCount = new AtomicLong();
+        this.senderLock = new ReentrantReadWriteLock();
+        this.nativeSender = 0;
+        this.nativeCoalescer = 0;
+        this.nativeSpill = false;
         this.nativeHandle = 0;
+        this.failoverCount = new AtomicLong();
+        this.categoryIds = new HashMap<>();
+        this.frameBuffer = ByteBuffer.allocate(FRAME_BUFFER_BYTES).order(ByteOrder.LITTLE_ENDIAN);
+        this.pending = new ArrayList<>(BinaryWireFormat.MAX_BATCH);
+        this.pendingIds = new int[BinaryWireFormat.MAX_BATCH];
     }
     
     /**
      * Starts the analytics client.
      * Spawns a background thread for sending violations.
+     * 
+     * <p>Never waits on a background release ({@link #stopInBackground()}
+     * of this client, or of another holding the spill directory): the
+     * sender is then opened by a starter thread once the release is done,
+     * and violations reported meanwhile are queued and handed to it.
      */
     public synchronized void start() {
         if (running.get()) {
@@ -77,28 +235,181 @@ public final class AnalyticsClient {
         
         running.set(true);
         
+        if ((closer != null && closer.isAlive())
+                || (spill != null && NativeHelper.isNativeAvailable() && isClosing())) {
+            final Thread previous = closer;
+            starter = new Thread(() -> startWhenReleased(previous), "MacAC-Analytics-Start");
+            starter.setDaemon(true);
+            starter.start();
+            return;
+        }
+        closer = null;
+        startSender();
+    }
+    
+    /**
+     * Starter thread: waits for the releases in the way, then opens the sender
+     * unless the client was stopped (or restarted) meanwhile.
+     */
+    private void startWhenReleased(Thread previous) {
+        awaitClose(previous);
+        if (spill != null) {
+            awaitClosing();
+        }
+        synchronized (this) {
+            if (!running.get() || starter != Thread.currentThread()) {
+                return;
+            }
+            starter = null;
+            closer = null;
+            startSender();
+        }
+    }
+    
+    /**
+     * Opens the native sender, or starts the Java sender thread without it.
+     * Caller holds this client's monitor with running set.
+     */
+    private void startSender() {
+        // Prefer the native sender: its I/O thread owns connect, backoff and writes
+        if (NativeHelper.isNativeAvailable()) {
+            long handle = startSpillingSender();
+            boolean spilling = handle != 0;
+            try {
+                if (handle == 0) {
+                    handle = NativeHelper.senderCreatePool(describeEndpoints(), endpoints.get(0).port(),
+                        QUEUE_CAPACITY, connectTimeoutMs, reconnectDelayMs, protocol.code());
+                }
+            } catch (Throwable t) {
+                LOGGER.fine("Native sender unavailable: " + t.getMessage());
+            }
+            if (handle != 0) {
+                long coalescer = startCoalescer(handle);
+                senderLock.writeLock().lock();
+                try {
+                    nativeSender = handle;
+                    nativeCoalescer = coalescer;
+                    nativeSpill = spilling;
+                } finally {
+                    senderLock.writeLock().unlock();
+                }
+                
+                // Reported while a starter thread waited
+                Violation queued;
+                while ((queued = sendQueue.poll()) != null) {
+                    sendViolation(queued);
+                }
+                
+                LOGGER.info("Analytics client started for " + describeEndpoints()
+                    + " (native sender, " + protocol.configName()
+                    + (coalescer != 0 ? ", coalescing " + coalescing.windowMs() + " ms" : "")
+                    + (spilling ? ", spilling to " + spill.directory() : "") + ")");
+                return;
+            }
+        }
+        
         senderThread = new Thread(this::senderLoop, "MacAC-Analytics-Sender");
         senderThread.setDaemon(true);
         senderThread.start();
         
-        LOGGER.info("Analytics client started for " + host + ":" + port);
+        LOGGER.info("Analytics client started for " + describeEndpoints() + " (" + protocol.configName() + ")");
     }
     
     /**
-     * Stops the analytics client.
+     * Stops the analytics client, returning once queued violations have
+     * been flushed (bounded) and the native sender is freed.
      */
     public synchronized void stop() {
-        if (!running.get()) {
+        final Runnable release = detach();
+        if (release != null) {
+            release.run();
+        }
+    }
+    
+    /**
+     * Stops the analytics client without waiting for the flush: producers
+     * are cut off before this returns, and the sender is flushed and freed
+     * on a background thread. For callers on the server thread.
+     */
+    public synchronized void stopInBackground() {
+        final Runnable release = detach();
+        if (release == null) {
             return;
         }
+        synchronized (CLOSING_LOCK) {
+            closingCount++;
+        }
+        closer = new Thread(() -> {
+            try {
+                release.run();
+            } finally {
+                synchronized (CLOSING_LOCK) {
+                    closingCount--;
+                    CLOSING_LOCK.notifyAll();
+                }
+            }
+        }, "MacAC-Analytics-Close");
+        closer.setDaemon(true);
+        closer.start();
+    }
+    
+    /**
+     * Marks the client stopped and takes the native handles out from under
+     * producers. Only the swap holds senderLock; the returned release does
+     * the blocking flush and teardown without it.
+     * 
+     * @return Release to run, or null if the client was not running
+     */
+    private Runnable detach() {
+        if (!running.get()) {
+            return null;
+        }
         
         running.set(false);
+        starter = null;
+        
+        final long coalescer;
+        final long sender;
+        final boolean spilling;
+        senderLock.writeLock().lock();
+        try {
+            coalescer = nativeCoalescer;
+            sender = nativeSender;
+            spilling = nativeSpill;
+            nativeCoalescer = 0;
+            nativeSender = 0;
+            nativeSpill = false;
+        } finally {
+            senderLock.writeLock().unlock();
+        }
+        
+        final Thread thread = senderThread;
+        senderThread = null;
+        return () -> release(coalescer, sender, spilling, thread);
+    }
+    
+    /**
+     * Flushes and frees detached native handles, then ends the Java sender.
+     */
+    private void release(long coalescer, long sender, boolean spilling, Thread thread) {
+        // Open coalesced records go to the sender first; the native sender
+        // then flushes (bounded) before closing
+        if (coalescer != 0) {
+            NativeHelper.coalescerDestroy(coalescer);
+        }
+        if (sender != 0) {
+            // A spilling sender keeps what it cannot send for the next start
+            if (!spilling) {
+                NativeHelper.senderFlush(sender, STOP_FLUSH_TIMEOUT_MS);
+            }
+            NativeHelper.senderDestroy(sender);
+        }
         
         // Interrupt sender thread
-        if (senderThread != null) {
-            senderThread.interrupt();
+        if (thread != null) {
+            thread.interrupt();
             try {
-                senderThread.join(5000);
+                thread.join(5000);
             } catch (InterruptedException e) {
                 Thread.currentThread().interrupt();
             }
@@ -110,6 +421,54 @@ public final class AnalyticsClient {
         LOGGER.info("Analytics client stopped");
     }
     
+    /**
+     * Waits for a release started by {@link #stopInBackground()}, if any.
+     */
+    private static void awaitClose(Thread thread) {
+        if (thread == null) {
+            return;
+        }
+        boolean interrupted = false;
+        while (thread.isAlive()) {
+            try {
+                thread.join();
+            } catch (InterruptedException e) {
+                interrupted = true;
+            }
+        }
+        if (interrupted) {
+            Thread.currentThread().interrupt();
+        }
+    }
+    
+    /**
+     * Returns true while any client is releasing in the background.
+     */
+    private static boolean isClosing() {
+        synchronized (CLOSING_LOCK) {
+            return closingCount > 0;
+        }
+    }
+    
+    /**
+     * Waits until no client is releasing in the background.
+     */
+    private static void awaitClosing() {
+        boolean interrupted = false;
+        synchronized (CLOSING_LOCK) {
+            while (closingCount > 0) {
+                try {
+                    CLOSING_LOCK.wait();
+                } catch (InterruptedException e) {
+                    interrupted = true;
+                }
+            }
+        }
+        if (interrupted) {
+            Thread.currentThread().interrupt();
+        }
+    }
+    
     /**
      * Queues a violation for sending.
      * Non-blocking - returns immediately.
@@ -122,7 +481,38 @@ public final class AnalyticsClient {
             return false;
         }
         
-        return sendQueue.offer(violation);
+        senderLock.readLock().lock();
+        try {
+            if (nativeCoalescer != 0) {
+                return NativeHelper.coalescerAdd(
+                    nativeCoalescer,
+                    violation.playerId().toString(),
+                    violation.category(),
+                    violation.confidence(),
+                    violation.severity(),
+                    violation.timestamp()
+                ) == 0;
+            }
+            if (nativeSender != 0) {
+                // Drops are counted natively
+                return NativeHelper.senderSendViolation(
+                    nativeSender,
+                    violation.playerId().toString(),
+                    violation.category(),
+                    violation.confidence(),
+                    violation.severity(),
+                    violation.timestamp()
+                ) == 0;
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        
+        if (!sendQueue.offer(violation)) {
+            droppedCount.incrementAndGet();
+            return false;
+        }
+        return true;
     }
     
     /**
@@ -131,18 +521,220 @@ public final class AnalyticsClient {
      * @return Number of pending violations
      */
     public int getQueueSize() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSender != 0) {
+                return NativeHelper.senderQueueDepth(nativeSender);
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
         return sendQueue.size();
     }
     
+    /**
+     * Returns the number of violations dropped because the queue was full.
+     * 
+     * @return Dropped violation count
+     */
+    public long getDroppedCount() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSender != 0) {
+                return NativeHelper.senderDroppedCount(nativeSender);
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        return droppedCount.get();
+    }
+    
     /**
      * Returns true if connected to server.
      * 
      * @return Connection status
      */
     public boolean isConnected() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSender != 0) {
+                return NativeHelper.senderIsConnected(nativeSender);
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
         return connected.get();
     }
     
+    /**
+     * Returns the number of violations sent to a collector other than their
+     * shard's (native) or the number of times the fallback moved to the next
+     * collector.
+     * 
+     * @return Failover count
+     */
+    public long getFailoverCount() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSender != 0) {
+                return NativeHelper.senderFailoverCount(nativeSender);
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        return failoverCount.get();
+    }
+    
+    /**
+     * Returns the number of violations merged into an earlier record of the
+     * same player and category instead of being sent on their own.
+     * 
+     * @return Merged violation count (0 without native coalescing)
+     */
+    public long getCoalescedCount() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeCoalescer != 0) {
+                long[] stats = NativeHelper.coalescerStats(nativeCoalescer);
+                return stats != null ? stats[1] : 0;
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        return 0;
+    }
+    
+    /**
+     * Returns the number of violations written to the spill log because no
+     * collector could take them.
+     * 
+     * @return Spilled violation count (0 without native spilling)
+     */
+    public long getSpilledCount() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSpill) {
+                long[] stats = NativeHelper.senderSpillStats(nativeSender);
+                return stats != null ? stats[0] : 0;
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        return 0;
+    }
+    
+    /**
+     * Returns the number of violations waiting in the spill log to be replayed.
+     * 
+     * @return Spill log depth (0 without native spilling)
+     */
+    public long getSpillDepth() {
+        senderLock.readLock().lock();
+        try {
+            if (nativeSpill) {
+                long[] stats = NativeHelper.senderSpillStats(nativeSender);
+                return stats != null ? stats[2] : 0;
+            }
+        } finally {
+            senderLock.readLock().unlock();
+        }
+        return 0;
+    }
+    
+    /**
+     * Returns true if violations are coalesced before sending.
+     * 
+     * @return Coalescing status
+     */
+    public boolean isCoalescing() {
+        senderLock.readLock().lock();
+        try {
+            return nativeCoalescer != 0;
+        } finally {
+            senderLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Returns the configured collectors.
+     * 
+     * @return Endpoints, in shard order
+     */
+    public List<Endpoint> getEndpoints() {
+        return endpoints;
+    }
+    
+    /**
+     * Returns the configured wire protocol.
+     * 
+     * @return Wire protocol
+     */
+    public WireProtocol getProtocol() {
+        return protocol;
+    }
+    
+    /**
+     * Returns the configured coalescing settings.
+     * 
+     * @return Coalescing settings, or null if disabled
+     */
+    public Coalescing getCoalescing() {
+        return coalescing;
+    }
+    
+    /**
+     * Returns the configured spill settings.
+     * 
+     * @return Spill settings, or null if disabled
+     */
+    public Spill getSpill() {
+        return spill;
+    }
+    
+    /**
+     * Creates a native sender that spills to disk, if configured.
+     * 
+     * @return Sender handle, or 0 to fall back to a sender without spill
+     */
+    private long startSpillingSender() {
+        if (spill == null) {
+            return 0;
+        }
+        long handle = 0;
+        try {
+            Files.createDirectories(Paths.get(spill.directory()));
+            handle = NativeHelper.senderCreateSpill(describeEndpoints(), endpoints.get(0).port(),
+                QUEUE_CAPACITY, connectTimeoutMs, reconnectDelayMs, protocol.code(),
+                spill.directory(), spill.segmentBytes(), spill.maxBytes(), spill.highWater());
+        } catch (Throwable t) {
+            LOGGER.fine("Native spill unavailable: " + t.getMessage());
+        }
+        if (handle == 0) {
+            LOGGER.warning("Analytics spill directory unusable, reports will not be kept on disk: "
+                + spill.directory());
+        }
+        return handle;
+    }
+    
+    /**
+     * Creates the native coalescer in front of a new sender, if configured.
+     * 
+     * @return Coalescer handle, or 0 to send violations directly
+     */
+    private long startCoalescer(long sender) {
+        if (coalescing == null) {
+            return 0;
+        }
+        long handle = 0;
+        try {
+            handle = NativeHelper.coalescerCreate(sender, coalescing.maxRecords(),
+                coalescing.windowMs(), coalescing.flushCount());
+        } catch (Throwable t) {
+            LOGGER.fine("Native coalescer unavailable: " + t.getMessage());
+        }
+        return handle;
+    }
+    
     /**
      * Background sender loop.
      */
@@ -164,12 +756,23 @@ public final class AnalyticsClient {
                     continue;
                 }
                 
-                // Send violation
-                boolean sent = doSend(violation);
+                pending.clear();
+                pending.add(violation);
+                if (protocol == WireProtocol.BINARY_BATCHED) {
+                    sendQueue.drainTo(pending, BinaryWireFormat.MAX_BATCH - 1);
+                }
+                
+                // Send violations
+                boolean sent = protocol.isBinary() ? doSendBinary(pending) : doSend(violation);
                 if (!sent) {
-                    // Put back in queue if send failed
-                    sendQueue.offer(violation);
+                    // Put back in queue if send failed and try the next collector
+                    for (Violation v : pending) {
+                        if (!sendQueue.offer(v)) {
+                            droppedCount.incrementAndGet();
+                        }
+                    }
                     disconnect();
+                    failover();
                 }
                 
             } catch (InterruptedException e) {
@@ -183,16 +786,48 @@ public final class AnalyticsClient {
     }
     
     /**
-     * Establishes connection to server.
+     * Connects to the current collector, moving on to the next ones in turn
+     * until one accepts.
      */
     private void connect() {
+        for (int attempt = 0; attempt < endpoints.size() && running.get(); attempt++) {
+            connect(endpoints.get(endpointIndex));
+            if (connected.get()) {
+                return;
+            }
+            failover();
+        }
+    }
+    
+    /**
+     * Moves the fallback to the next collector.
+     */
+    private void failover() {
+        if (endpoints.size() > 1) {
+            endpointIndex = (endpointIndex + 1) % endpoints.size();
+            failoverCount.incrementAndGet();
+        }
+    }
+    
+    /**
+     * Establishes connection to one collector.
+     */
+    private void connect(Endpoint endpoint) {
+        final String host = endpoint.host();
+        final int port = endpoint.port();
+        
+        if (protocol.isBinary()) {
+            connectBinary(endpoint);
+            return;
+        }
+        
         // Try native connection first
         if (NativeHelper.isNativeAvailable()) {
             try {
                 nativeHandle = NativeHelper.netConnect(host, port);
                 if (nativeHandle != 0) {
                     connected.set(true);
-                    LOGGER.info("Connected to analytics server (native): " + host + ":" + port);
+                    LOGGER.info("Connected to analytics server (native): " + endpoint);
                     return;
                 }
             } catch (Exception e) {
@@ -210,7 +845,7 @@ public final class AnalyticsClient {
             writer = new BufferedWriter(new OutputStreamWriter(socket.getOutputStream()));
             
             connected.set(true);
-            LOGGER.info("Connected to analytics server (Java): " + host + ":" + port);
+            LOGGER.info("Connected to analytics server (Java): " + endpoint);
             
         } catch (IOException e) {
             LOGGER.fine("Java connection failed: " + e.getMessage());
@@ -218,6 +853,40 @@ public final class AnalyticsClient {
         }
     }
     
+    /**
+     * Establishes a Java connection and performs the binary handshake.
+     */
+    private void connectBinary(Endpoint endpoint) {
+        try {
+            socket = new Socket();
+            socket.connect(new InetSocketAddress(endpoint.host(), endpoint.port()), connectTimeoutMs);
+            socket.setTcpNoDelay(true);
+            socket.setSoTimeout(connectTimeoutMs);
+            
+            binaryOut = socket.getOutputStream();
+            binaryOut.write(BinaryWireFormat.hello(protocol == WireProtocol.BINARY_BATCHED));
+            binaryOut.flush();
+            
+            byte[] ack = new byte[BinaryWireFormat.HELLO_BYTES];
+            new DataInputStream(socket.getInputStream()).readFully(ack);
+            int version = BinaryWireFormat.parseAck(ack);
+            if (version == 0) {
+                LOGGER.warning("Analytics server rejected binary protocol: " + endpoint);
+                disconnect();
+                return;
+            }
+            
+            socket.setSoTimeout(5000);
+            categoryIds.clear();
+            connected.set(true);
+            LOGGER.info("Connected to analytics server (Java, binary v" + version + "): " + endpoint);
+        
+        } catch (IOException e) {
+            LOGGER.fine("Java connection failed: " + e.getMessage());
+            disconnect();
+        }
+    }
+    
     /**
      * Closes the connection.
      */
@@ -243,6 +912,7 @@ public final class AnalyticsClient {
             }
             writer = null;
         }
+        binaryOut = null;
         
         if (socket != null) {
             try {
@@ -297,6 +967,99 @@ public final class AnalyticsClient {
         return false;
     }
     
+    /**
+     * Sends violations as binary frames: any new category definitions, then
+     * one violation frame each or a single batch frame.
+     * 
+     * @param violations Violations to send (at most one batch)
+     * @return true if sent successfully
+     */
+    private boolean doSendBinary(List<Violation> violations) {
+        if (binaryOut == null) {
+            return false;
+        }
+        
+        frameBuffer.clear();
+        
+        // Category definitions must precede the records that use them;
+        // unencodable violations are dropped from the list so a failed
+        // send does not requeue them
+        int count = 0;
+        for (int i = 0; i < violations.size(); i++) {
+            Violation v = violations.get(i);
+            int id = internCategory(v.category());
+            if (id < 0) {
+                droppedCount.incrementAndGet();
+                continue;
+            }
+            pendingIds[count] = id;
+            violations.set(count++, v);
+        }
+        violations.subList(count, violations.size()).clear();
+        if (count == 0) {
+            return true;
+        }
+        
+        if (protocol == WireProtocol.BINARY_BATCHED) {
+            BinaryWireFormat.putBatchHeader(frameBuffer, count);
+            for (int i = 0; i < count; i++) {
+                BinaryWireFormat.putRecord(frameBuffer, violations.get(i), pendingIds[i]);
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                BinaryWireFormat.putViolation(frameBuffer, violations.get(i), pendingIds[i]);
+            }
+        }
+        
+        try {
+            binaryOut.write(frameBuffer.array(), 0, frameBuffer.position());
+            binaryOut.flush();
+            return true;
+        } catch (IOException e) {
+            LOGGER.fine("Java send failed: " + e.getMessage());
+            // Ids defined in this buffer may not have reached the server
+            categoryIds.clear();
+            return false;
+        }
+    }
+    
+    /**
+     * Returns the connection-local id of a category, writing its definition
+     * frame into the frame buffer the first time it is seen.
+     * 
+     * @return Category id, or -1 if the name is too long or the table is full
+     */
+    private int internCategory(String category) {
+        Integer existing = categoryIds.get(category);
+        if (existing != null) {
+            return existing;
+        }
+        
+        byte[] name = BinaryWireFormat.categoryName(category);
+        if (name == null || categoryIds.size() >= BinaryWireFormat.MAX_CATEGORIES) {
+            return -1;
+        }
+        
+        int id = categoryIds.size();
+        categoryIds.put(category, id);
+        BinaryWireFormat.putCategory(frameBuffer, id, name);
+        return id;
+    }
+    
+    /**
+     * Returns the endpoints as the comma-separated list the native sender parses.
+     */
+    private String describeEndpoints() {
+        StringBuilder sb = new StringBuilder();
+        for (Endpoint endpoint : endpoints) {
+            if (sb.length() > 0) {
+                sb.append(',');
+            }
+            sb.append(endpoint);
+        }
+        return sb.toString();
+    }
+    
     /**
      * Formats a violation as JSON.
      */
@@ -0,0 +1,188 @@
+package com.macmoment.macac.network;
+
+import com.macmoment.macac.model.Violation;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.UUID;
+
+/**
+ * Encoder for the binary analytics wire protocol.
+ * 
+ * <p>Byte-for-byte identical to the native sender's format. All integers
+ * are little-endian.
+ * <pre>
+ *   hello / ack  "MACB" | u8 version | u8 flags (bit 0 = batching) | u16 reserved
+ *   frame        u32 length (bytes after this field) | u8 type | payload
+ *     CATEGORY   u16 id | u8 name_len | name (UTF-8)
+ *     VIOLATION  one record
+ *     BATCH      u16 count | count records
+ *     SUMMARY    one record | u32 count | i64 first_timestamp (version 2)
+ *   record       uuid[16] | u16 category_id | u16 reserved |
+ *                f32 confidence | f32 severity | i64 timestamp
+ * </pre>
+ * The server's ack carries the negotiated version (0 = rejected).
+ * Summary frames come only from the native sender's coalescer; this
+ * encoder speaks version 1.
+ * Category ids are only valid on the connection that defined them.
+ * 
+ * <p><strong>Thread Safety:</strong> Stateless; all methods are thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class BinaryWireFormat {
+    
+    /** Highest protocol version this client speaks. */
+    public static final int VERSION = 1;
+    
+    /** Size of the hello and ack messages. */
+    public static final int HELLO_BYTES = 8;
+    
+    /** Size of one violation record. */
+    public static final int RECORD_BYTES = 36;
+    
+    /** Length field plus type byte. */
+    public static final int FRAME_HEADER_BYTES = 5;
+    
+    /** Longest category name in UTF-8 bytes. */
+    public static final int MAX_CATEGORY_NAME = 255;
+    
+    /** Categories interned per connection (same limit as the native sender). */
+    public static final int MAX_CATEGORIES = 64;
+    
+    /** Records per batch frame. */
+    public static final int MAX_BATCH = 64;
+    
+    // Frame types
+    public static final byte FRAME_CATEGORY = 0x01;
+    public static final byte FRAME_VIOLATION = 0x02;
+    public static final byte FRAME_BATCH = 0x03;
+    public static final byte FRAME_SUMMARY = 0x04;
+    
+    private static final byte FLAG_BATCHING = 0x01;
+    private static final byte[] MAGIC = { 'M', 'A', 'C', 'B' };
+    
+    private BinaryWireFormat() {
+        throw new AssertionError("BinaryWireFormat is a utility class and cannot be instantiated");
+    }
+    
+    /**
+     * Encodes the client hello.
+     * 
+     * @param batching whether batch frames will be sent
+     * @return 8-byte hello
+     */
+    public static byte[] hello(final boolean batching) {
+        final ByteBuffer buf = ByteBuffer.allocate(HELLO_BYTES).order(ByteOrder.LITTLE_ENDIAN);
+        buf.put(MAGIC);
+        buf.put((byte) VERSION);
+        buf.put(batching ? FLAG_BATCHING : 0);
+        buf.putShort((short) 0);
+        return buf.array();
+    }
+    
+    /**
+     * Parses a server ack.
+     * 
+     * @param ack 8 bytes read from the server
+     * @return negotiated version, or 0 if the ack is invalid or rejects us
+     */
+    public static int parseAck(final byte[] ack) {
+        if (ack == null || ack.length != HELLO_BYTES) {
+            return 0;
+        }
+        for (int i = 0; i < MAGIC.length; i++) {
+            if (ack[i] != MAGIC[i]) {
+                return 0;
+            }
+        }
+        final int version = ack[4] & 0xFF;
+        return version >= 1 && version <= VERSION ? version : 0;
+    }
+    
+    /**
+     * Returns the encoded size of a category frame.
+     * 
+     * @param name UTF-8 category name
+     * @return frame bytes
+     */
+    public static int categoryFrameSize(final byte[] name) {
+        return FRAME_HEADER_BYTES + 3 + name.length;
+    }
+    
+    /**
+     * Writes a category definition frame.
+     * 
+     * @param out destination; must be little-endian
+     * @param id category id
+     * @param name UTF-8 name of at most {@value #MAX_CATEGORY_NAME} bytes
+     */
+    public static void putCategory(final ByteBuffer out, final int id, final byte[] name) {
+        out.putInt(1 + 3 + name.length);
+        out.put(FRAME_CATEGORY);
+        out.putShort((short) id);
+        out.put((byte) name.length);
+        out.put(name);
+    }
+    
+    /**
+     * Writes a single-violation frame.
+     * 
+     * @param out destination; must be little-endian
+     * @param violation violation to encode
+     * @param categoryId interned id of the violation's category
+     */
+    public static void putViolation(final ByteBuffer out, final Violation violation, final int categoryId) {
+        out.putInt(1 + RECORD_BYTES);
+        out.put(FRAME_VIOLATION);
+        putRecord(out, violation, categoryId);
+    }
+    
+    /**
+     * Writes a batch frame header; follow it with {@code count} records.
+     * 
+     * @param out destination; must be little-endian
+     * @param count records in the batch, at most {@value #MAX_BATCH}
+     */
+    public static void putBatchHeader(final ByteBuffer out, final int count) {
+        out.putInt(1 + 2 + count * RECORD_BYTES);
+        out.put(FRAME_BATCH);
+        out.putShort((short) count);
+    }
+    
+    /**
+     * Writes one 36-byte record.
+     * 
+     * @param out destination; must be little-endian
+     * @param violation violation to encode
+     * @param categoryId interned id of the violation's category
+     */
+    public static void putRecord(final ByteBuffer out, final Violation violation, final int categoryId) {
+        final UUID id = violation.playerId();
+        
+        // RFC 4122 byte order is big-endian
+        out.order(ByteOrder.BIG_ENDIAN);
+        out.putLong(id.getMostSignificantBits());
+        out.putLong(id.getLeastSignificantBits());
+        out.order(ByteOrder.LITTLE_ENDIAN);
+        
+        out.putShort((short) categoryId);
+        out.putShort((short) 0);
+        out.putFloat((float) violation.confidence());
+        out.putFloat((float) violation.severity());
+        out.putLong(violation.timestamp());
+    }
+    
+    /**
+     * Encodes a category name, or returns null if it is too long.
+     * 
+     * @param category category name
+     * @return UTF-8 bytes, or null
+     */
+    public static byte[] categoryName(final String category) {
+        final byte[] name = category.getBytes(StandardCharsets.UTF_8);
+        return name.length <= MAX_CATEGORY_NAME ? name : null;
+    }
+}
@@ -0,0 +1,37 @@
+package com.macmoment.macac.network;
+
+/**
+ * Settings for native violation coalescing in {@link AnalyticsClient}.
+ * 
+ * <p>Violations of one player and category that arrive within a window are
+ * merged into one summary record (count, maximum confidence, mean severity,
+ * first and last timestamp) before they reach the sender. Only the native
+ * sender coalesces; the Java fallback sends every violation.
+ * 
+ * @param windowMs How long a record collects violations before it is sent
+ * @param maxRecords Most records open at once; violations beyond it are sent as they are
+ * @param flushCount Violations that send a record before its window ends (0 = no limit)
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public record Coalescing(int windowMs, int maxRecords, int flushCount) {
+    
+    /**
+     * Validates the settings.
+     * 
+     * @throws IllegalArgumentException if the window or record limit is not positive,
+     *         or the flush count is negative
+     */
+    public Coalescing {
+        if (windowMs <= 0) {
+            throw new IllegalArgumentException("Invalid coalescing window: " + windowMs);
+        }
+        if (maxRecords <= 0) {
+            throw new IllegalArgumentException("Invalid coalescing record limit: " + maxRecords);
+        }
+        if (flushCount < 0) {
+            throw new IllegalArgumentException("Invalid coalescing flush count: " + flushCount);
+        }
+    }
+}
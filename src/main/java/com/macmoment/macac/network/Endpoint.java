@@ -0,0 +1,85 @@
+package com.macmoment.macac.network;
+
+/**
+ * One analytics collector address.
+ * 
+ * <p>Accepts the same forms as the native sender's endpoint list:
+ * {@code host}, {@code host:port}, {@code [v6]}, {@code [v6]:port} and
+ * bare IPv6 literals (more than one colon, no port).
+ * 
+ * @param host Hostname or IPv4/IPv6 literal, without brackets
+ * @param port TCP port
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public record Endpoint(String host, int port) {
+    
+    /** Most endpoints one client spreads reports across ({@code MACAC_SENDER_MAX_ENDPOINTS}). */
+    public static final int MAX_ENDPOINTS = 8;
+    
+    /**
+     * Validates the address.
+     * 
+     * @throws IllegalArgumentException if the host is empty or the port is out of range
+     */
+    public Endpoint {
+        if (host == null || host.isEmpty()) {
+            throw new IllegalArgumentException("Empty endpoint host");
+        }
+        if (port < 1 || port > 65535) {
+            throw new IllegalArgumentException("Invalid endpoint port: " + port);
+        }
+    }
+    
+    /**
+     * Parses one endpoint.
+     * 
+     * @param text endpoint text (surrounding whitespace ignored)
+     * @param defaultPort port used when the text has none
+     * @return parsed endpoint
+     * @throws IllegalArgumentException if the text is malformed
+     */
+    public static Endpoint parse(final String text, final int defaultPort) {
+        final String value = text == null ? "" : text.trim();
+        
+        if (value.startsWith("[")) {
+            final int close = value.indexOf(']');
+            if (close < 0) {
+                throw new IllegalArgumentException("Unclosed IPv6 bracket: " + value);
+            }
+            final String rest = value.substring(close + 1);
+            if (rest.isEmpty()) {
+                return new Endpoint(value.substring(1, close), defaultPort);
+            }
+            if (!rest.startsWith(":")) {
+                throw new IllegalArgumentException("Unexpected text after IPv6 address: " + value);
+            }
+            return new Endpoint(value.substring(1, close), parsePort(rest.substring(1), value));
+        }
+        
+        // Exactly one colon separates a port; more means a bare IPv6 address
+        final int colon = value.indexOf(':');
+        if (colon >= 0 && value.indexOf(':', colon + 1) < 0) {
+            return new Endpoint(value.substring(0, colon), parsePort(value.substring(colon + 1), value));
+        }
+        return new Endpoint(value, defaultPort);
+    }
+    
+    private static int parsePort(final String digits, final String value) {
+        if (digits.isEmpty() || digits.length() > 5 || !digits.chars().allMatch(c -> c >= '0' && c <= '9')) {
+            throw new IllegalArgumentException("Invalid endpoint port: " + value);
+        }
+        return Integer.parseInt(digits);
+    }
+    
+    /**
+     * Returns the endpoint as {@code host:port}, bracketing IPv6 literals.
+     * 
+     * @return endpoint text accepted by {@link #parse}
+     */
+    @Override
+    public String toString() {
+        return host.indexOf(':') >= 0 ? "[" + host + "]:" + port : host + ":" + port;
+    }
+}
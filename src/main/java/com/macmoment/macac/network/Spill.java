@@ -0,0 +1,41 @@
+package com.macmoment.macac.network;
+
+/**
+ * Settings for the native sender's on-disk spill in {@link AnalyticsClient}.
+ * 
+ * <p>While no collector is reachable, or the send queue is deeper than the
+ * high-water mark, violations are appended to segment files in the
+ * directory instead of being dropped, and replayed in order once a
+ * collector accepts again. Reports still unsent when the client stops are
+ * spilled too and replayed by the next client on the same directory. Only
+ * the native sender spills; the Java fallback keeps its in-memory queue.
+ * 
+ * @param directory Directory holding the segment files (one client at a time)
+ * @param maxBytes Disk budget over all segments; reports beyond it are dropped
+ * @param segmentBytes Size of each segment file
+ * @param highWater Queue depth that spills while connected (0 = three quarters of the queue)
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public record Spill(String directory, long maxBytes, long segmentBytes, int highWater) {
+    
+    /**
+     * Validates the settings.
+     * 
+     * @throws IllegalArgumentException if the directory is missing, a size is
+     *         not positive or the segment is larger than the budget, or the
+     *         high-water mark is negative
+     */
+    public Spill {
+        if (directory == null || directory.isBlank()) {
+            throw new IllegalArgumentException("Missing spill directory");
+        }
+        if (segmentBytes <= 0 || maxBytes < segmentBytes) {
+            throw new IllegalArgumentException("Invalid spill sizes: " + segmentBytes + " of " + maxBytes);
+        }
+        if (highWater < 0) {
+            throw new IllegalArgumentException("Invalid spill high-water mark: " + highWater);
+        }
+    }
+}
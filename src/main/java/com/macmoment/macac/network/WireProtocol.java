@@ -0,0 +1,77 @@
+package com.macmoment.macac.network;
+
+import java.util.Locale;
+
+/**
+ * Wire protocols supported by {@link AnalyticsClient}.
+ * 
+ * <p>Codes match the {@code MACAC_WIRE_*} constants of the native sender.
+ * See {@link BinaryWireFormat} for the binary layout.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public enum WireProtocol {
+    
+    /** One JSON object per line. */
+    JSON(0, "json"),
+    
+    /** Length-prefixed binary frames, one violation per frame. */
+    BINARY(1, "binary"),
+    
+    /** Length-prefixed binary frames, violations coalesced into batch frames. */
+    BINARY_BATCHED(2, "binary_batched");
+    
+    private final int code;
+    private final String configName;
+    
+    WireProtocol(final int code, final String configName) {
+        this.code = code;
+        this.configName = configName;
+    }
+    
+    /**
+     * Returns the native protocol code.
+     * 
+     * @return code passed to {@code NativeHelper.senderCreate}
+     */
+    public int code() {
+        return code;
+    }
+    
+    /**
+     * Returns the name used in config.yml.
+     * 
+     * @return config name
+     */
+    public String configName() {
+        return configName;
+    }
+    
+    /**
+     * Returns true for the binary protocols.
+     * 
+     * @return true if frames are binary
+     */
+    public boolean isBinary() {
+        return this != JSON;
+    }
+    
+    /**
+     * Parses a config value, falling back to {@link #JSON} for unknown names.
+     * 
+     * @param name config value (case-insensitive); may be null
+     * @return matching protocol
+     */
+    public static WireProtocol fromConfig(final String name) {
+        if (name != null) {
+            final String normalized = name.trim().toLowerCase(Locale.ROOT);
+            for (final WireProtocol protocol : values()) {
+                if (protocol.configName.equals(normalized)) {
+                    return protocol;
+                }
+            }
+        }
+        return JSON;
+    }
+}
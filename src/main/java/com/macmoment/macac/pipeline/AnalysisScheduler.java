@@ -0,0 +1,433 @@
+package com.macmoment.macac.pipeline;
+
+import java.util.Map;
+import java.util.Objects;
+import java.util.UUID;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedDeque;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.LongAdder;
+import java.util.concurrent.locks.LockSupport;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+/**
+ * Work-stealing thread pool for per-player detection work.
+ * 
+ * <p>Every task belongs to a player. A player's tasks go into that player's
+ * <em>lane</em>, a FIFO that at most one worker runs at a time, so a
+ * {@link com.macmoment.macac.model.PlayerContext} is only ever written by one
+ * thread and its tasks run in submission order. Lanes are sharded by UUID:
+ * a lane with work is queued on its home worker's deque, and an idle worker
+ * steals whole lanes from the opposite end of a busy worker's deque. Stealing
+ * moves a lane, never a single task, so per-player ordering survives it.
+ * A lane leaves the map only once it is empty, so a player never has two
+ * lanes with work at the same time.
+ * 
+ * <p>Main-thread follow-ups (alerts, punishments, anything that touches the
+ * Bukkit API) are posted with {@link #complete(Runnable)} and run by the
+ * server thread in {@link #drainCompletions(int)}.
+ * 
+ * <p><strong>Thread Safety:</strong> All methods are thread-safe except
+ * {@link #drainCompletions(int)}, which belongs to one consumer thread.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class AnalysisScheduler {
+    
+    /** Tasks a worker runs from one lane before requeueing it behind others. */
+    private static final int LANE_BUDGET = 32;
+    
+    /** Idle workers re-scan for stealable lanes at least this often. */
+    private static final long IDLE_PARK_NANOS = TimeUnit.MILLISECONDS.toNanos(50);
+    
+    private final Logger logger;
+    private final Worker[] workers;
+    private final Map<UUID, Lane> lanes;
+    private final ConcurrentLinkedQueue<Runnable> completions;
+    private final LongAdder executed;
+    private final LongAdder stolen;
+    private volatile boolean running;
+    
+    // Set once shutdown's deadline passes: workers drop queued work
+    private volatile boolean abandoned;
+    
+    /**
+     * Creates and starts a scheduler.
+     * 
+     * @param threads worker count; must be positive
+     * @param logger receives task failures; must not be null
+     * @throws IllegalArgumentException if threads is not positive
+     */
+    public AnalysisScheduler(final int threads, final Logger logger) {
+        if (threads <= 0) {
+            throw new IllegalArgumentException("threads must be positive: " + threads);
+        }
+        this.logger = Objects.requireNonNull(logger, "logger must not be null");
+        this.lanes = new ConcurrentHashMap<>();
+        this.completions = new ConcurrentLinkedQueue<>();
+        this.executed = new LongAdder();
+        this.stolen = new LongAdder();
+        this.running = true;
+        
+        this.workers = new Worker[threads];
+        for (int i = 0; i < threads; i++) {
+            workers[i] = new Worker(i);
+        }
+        for (final Worker worker : workers) {
+            worker.start();
+        }
+    }
+    
+    /**
+     * Worker count to use when the configuration asks for automatic sizing:
+     * half the cores, leaving the rest to the server and netty.
+     * 
+     * @return at least 1
+     */
+    public static int defaultThreads() {
+        return Math.max(1, Runtime.getRuntime().availableProcessors() / 2);
+    }
+    
+    /**
+     * Queues a task on a player's lane and wakes a worker if the lane was idle.
+     * 
+     * @param playerId owning player
+     * @param task work that may read and write the player's context
+     * @return true if queued; false after {@link #shutdown(long)}
+     */
+    public boolean submit(final UUID playerId, final Runnable task) {
+        if (!running) {
+            return false;
+        }
+        schedule(enqueue(playerId, task, false));
+        return true;
+    }
+    
+    /**
+     * Queues one tick's worth of tasks, waking each worker at most once.
+     * 
+     * @param playerIds owning player of each task
+     * @param tasks tasks, in submission order per player
+     * @param count number of entries to submit from both arrays
+     * @return number of tasks queued; 0 after {@link #shutdown(long)}
+     */
+    public int submitAll(final UUID[] playerIds, final Runnable[] tasks, final int count) {
+        if (!running) {
+            return 0;
+        }
+        
+        boolean wakeAll = false;
+        for (int i = 0; i < count; i++) {
+            final Lane lane = enqueue(playerIds[i], tasks[i], false);
+            if (lane.scheduled.compareAndSet(false, true)) {
+                workers[lane.home].deque.offerLast(lane);
+                wakeAll = true;
+            }
+        }
+        
+        // A batch usually spans every shard; idle workers steal the rest
+        if (wakeAll) {
+            for (final Worker worker : workers) {
+                if (worker.parked) {
+                    LockSupport.unpark(worker);
+                }
+            }
+        }
+        return count;
+    }
+    
+    /**
+     * Queues a task after everything already queued for the player, then
+     * forgets the player's lane once it has drained. Use for quit cleanup.
+     * 
+     * <p>Tasks submitted for the player in the meantime (a quick rejoin)
+     * queue behind the final task on the same lane; only after the lane is
+     * empty and removed does a new one start, so the two never overlap.
+     * 
+     * @param playerId departing player
+     * @param finalTask last task for the player; may be null
+     */
+    public void retire(final UUID playerId, final Runnable finalTask) {
+        final Runnable task = finalTask != null ? finalTask : () -> { };
+        if (!running || lanes.get(playerId) == null) {
+            task.run();
+            return;
+        }
+        schedule(enqueue(playerId, task, true));
+    }
+    
+    /**
+     * Posts a follow-up for the main thread.
+     * 
+     * @param completion action run by {@link #drainCompletions(int)}
+     */
+    public void complete(final Runnable completion) {
+        completions.offer(completion);
+    }
+    
+    /**
+     * Runs posted follow-ups on the calling (main) thread.
+     * 
+     * @param max maximum number to run
+     * @return number run
+     */
+    public int drainCompletions(final int max) {
+        int count = 0;
+        Runnable completion;
+        while (count < max && (completion = completions.poll()) != null) {
+            count++;
+            try {
+                completion.run();
+            } catch (final Exception e) {
+                logger.log(Level.SEVERE, "Error in analysis completion", e);
+            }
+        }
+        return count;
+    }
+    
+    /**
+     * Stops accepting work and lets workers finish queued tasks for up to
+     * {@code timeoutMs}. Past that, tasks still queued are dropped, but the
+     * call waits for running tasks to return: when it does, no worker is
+     * left, so the caller may free state the tasks use. Pending completions
+     * are discarded.
+     * 
+     * @param timeoutMs maximum time to wait for queued tasks
+     */
+    public void shutdown(final long timeoutMs) {
+        running = false;
+        for (final Worker worker : workers) {
+            LockSupport.unpark(worker);
+        }
+        
+        boolean interrupted = false;
+        final long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(Math.max(0, timeoutMs));
+        for (final Worker worker : workers) {
+            final long remaining = deadline - System.nanoTime();
+            try {
+                if (remaining > 0) {
+                    worker.join(Math.max(1, TimeUnit.NANOSECONDS.toMillis(remaining)));
+                }
+            } catch (final InterruptedException e) {
+                interrupted = true;
+                break;
+            }
+        }
+        
+        // Drop the backlog, then wait out the tasks already running
+        abandoned = true;
+        for (final Worker worker : workers) {
+            if (worker.isAlive()) {
+                worker.interrupt();
+            }
+        }
+        for (final Worker worker : workers) {
+            while (worker.isAlive()) {
+                try {
+                    worker.join();
+                } catch (final InterruptedException e) {
+                    interrupted = true;
+                }
+            }
+        }
+        if (interrupted) {
+            Thread.currentThread().interrupt();
+        }
+        
+        lanes.clear();
+        completions.clear();
+    }
+    
+    public int getThreadCount() { return workers.length; }
+    public long getExecutedCount() { return executed.sum(); }
+    public long getStolenCount() { return stolen.sum(); }
+    public int getPendingCompletions() { return completions.size(); }
+    
+    // ========================================================================
+    // Internals
+    // ========================================================================
+    
+    private Lane laneFor(final UUID playerId) {
+        final Lane lane = lanes.get(playerId);
+        return lane != null ? lane : lanes.computeIfAbsent(playerId, id -> new Lane(id, shardOf(id)));
+    }
+    
+    /**
+     * Adds a task to the player's current lane. A lane removed between the
+     * map lookup and the lock has no work left; the retry picks up (or
+     * creates) its successor.
+     * 
+     * @param retiring mark the lane for removal once it drains
+     * @return lane the task was added to
+     */
+    private Lane enqueue(final UUID playerId, final Runnable task, final boolean retiring) {
+        while (true) {
+            final Lane lane = laneFor(playerId);
+            synchronized (lane) {
+                if (!lane.removed) {
+                    lane.tasks.offer(task);
+                    if (retiring) {
+                        lane.retired = true;
+                    }
+                    return lane;
+                }
+            }
+        }
+    }
+    
+    private void schedule(final Lane lane) {
+        if (lane.scheduled.compareAndSet(false, true)) {
+            workers[lane.home].deque.offerLast(lane);
+            signal(lane.home);
+        }
+    }
+    
+    /**
+     * Home worker of a player. UUID.hashCode folds the halves with XOR, so
+     * mix again before reducing.
+     */
+    private int shardOf(final UUID playerId) {
+        int h = playerId.hashCode();
+        h ^= h >>> 16;
+        h *= 0x45d9f3b;
+        h ^= h >>> 16;
+        return (h & Integer.MAX_VALUE) % workers.length;
+    }
+    
+    /**
+     * Wakes the home worker, or if it is busy, any idle worker to steal.
+     */
+    private void signal(final int home) {
+        final Worker owner = workers[home];
+        if (owner.parked) {
+            LockSupport.unpark(owner);
+            return;
+        }
+        for (final Worker worker : workers) {
+            if (worker.parked) {
+                LockSupport.unpark(worker);
+                return;
+            }
+        }
+    }
+    
+    /**
+     * One player's queued work. {@code scheduled} is true while the lane is
+     * on a deque or being run, which is what keeps it single-threaded.
+     * Tasks are added and {@code removed} is set under the lane's monitor.
+     */
+    private static final class Lane {
+        final UUID playerId;
+        final int home;
+        final ConcurrentLinkedQueue<Runnable> tasks = new ConcurrentLinkedQueue<>();
+        final AtomicBoolean scheduled = new AtomicBoolean();
+        volatile boolean retired;
+        boolean removed;
+        
+        Lane(final UUID playerId, final int home) {
+            this.playerId = playerId;
+            this.home = home;
+        }
+    }
+    
+    private final class Worker extends Thread {
+        final int index;
+        final ConcurrentLinkedDeque<Lane> deque = new ConcurrentLinkedDeque<>();
+        volatile boolean parked;
+        
+        Worker(final int index) {
+            super("MacAC-Analysis-" + index);
+            this.index = index;
+            setDaemon(true);
+        }
+        
+        @Override
+        public void run() {
+            while ((running || hasWork()) && !abandoned) {
+                Lane lane = deque.pollFirst();
+                if (lane == null) {
+                    lane = steal();
+                }
+                if (lane != null) {
+                    runLane(lane);
+                    continue;
+                }
+                if (!running) {
+                    break;
+                }
+                
+                // Publish parked before the final scan: a submitter either sees
+                // it and unparks us, or we see its lane here
+                parked = true;
+                if (!hasWork()) {
+                    LockSupport.parkNanos(this, IDLE_PARK_NANOS);
+                }
+                parked = false;
+                if (isInterrupted()) {
+                    break;
+                }
+            }
+        }
+        
+        /**
+         * Takes the most recently queued lane of another worker, scanning from
+         * the next index so thieves spread over victims.
+         */
+        private Lane steal() {
+            for (int i = 1; i < workers.length; i++) {
+                final Lane lane = workers[(index + i) % workers.length].deque.pollLast();
+                if (lane != null) {
+                    stolen.increment();
+                    return lane;
+                }
+            }
+            return null;
+        }
+        
+        private boolean hasWork() {
+            for (final Worker worker : workers) {
+                if (!worker.deque.isEmpty()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        private void runLane(final Lane lane) {
+            int ran = 0;
+            Runnable task;
+            while (ran < LANE_BUDGET && !abandoned && (task = lane.tasks.poll()) != null) {
+                ran++;
+                try {
+                    task.run();
+                } catch (final Exception e) {
+                    logger.log(Level.SEVERE, "Error in analysis task", e);
+                }
+            }
+            executed.add(ran);
+            
+            // A retired lane leaves the map once drained; nothing can be
+            // added to it after that, so this worker was its last runner
+            if (lane.retired && lane.tasks.isEmpty()) {
+                synchronized (lane) {
+                    if (lane.tasks.isEmpty()) {
+                        lane.removed = true;
+                        lanes.remove(lane.playerId, lane);
+                    }
+                }
+            }
+            
+            // Release, then re-claim if work arrived (or the budget ran out):
+            // the submitter that raced us either saw scheduled=true and left
+            // it to us, or claims it itself after this store
+            lane.scheduled.set(false);
+            if (!lane.tasks.isEmpty() && lane.scheduled.compareAndSet(false, true)) {
+                deque.offerLast(lane);
+            }
+        }
+    }
+}
@@ -5,6 +5,7 @@ import com.macmoment.macac.model.CheckResult;
 import com.macmoment.macac.model.Features;
 import com.macmoment.macac.model.PlayerContext;
 import com.macmoment.macac.model.TelemetryInput;
+import com.macmoment.macac.util.PopulationBaseline;
 
 /**
  * Base interface for all anti-cheat detection checks.
@@ -124,6 +125,20 @@ public interface Check {
         // Default: no-op - most checks don't maintain separate state
     }
     
+    /**
+     * Supplies the server-wide feature baseline.
+     * 
+     * <p>Checks that score players against the population (e.g. "further
+     * out than all but 0.1% of the server") keep the reference and query it
+     * from {@link #analyze}. Called when the engine starts and stops.
+     * Default implementation ignores it.
+     * 
+     * @param population baseline, or null when there is none
+     */
+    default void setPopulation(final PopulationBaseline population) {
+        // Default: no-op - most checks use fixed thresholds only
+    }
+    
     /**
      * Updates check configuration.
      * 
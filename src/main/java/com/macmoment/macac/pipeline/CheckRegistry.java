@@ -4,10 +4,14 @@ import com.macmoment.macac.config.EngineConfig;
 import com.macmoment.macac.pipeline.checks.MovementConsistencyCheck;
 import com.macmoment.macac.pipeline.checks.PacketTimingCheck;
 import com.macmoment.macac.pipeline.checks.PredictionDriftCheck;
+import com.macmoment.macac.util.Perf;
+import com.macmoment.macac.util.PopulationBaseline;
 
 import java.util.ArrayList;
 import java.util.Collections;
+import java.util.IdentityHashMap;
 import java.util.List;
+import java.util.Map;
 import java.util.Objects;
 
 /**
@@ -37,16 +41,31 @@ public final class CheckRegistry {
     
     private final List<Check> checks;
     
+    // Latency site per check ("check.<name>"), resolved once at registration
+    private final Map<Check, Integer> perfSites;
+    
+    // Handed to checks registered later, too
+    private PopulationBaseline population;
+    
     /**
      * Creates a new check registry with built-in checks pre-registered.
      */
     public CheckRegistry() {
         this.checks = new ArrayList<>();
+        this.perfSites = new IdentityHashMap<>();
         
         // Register built-in movement checks
-        checks.add(new PacketTimingCheck());
-        checks.add(new MovementConsistencyCheck());
-        checks.add(new PredictionDriftCheck());
+        add(new PacketTimingCheck());
+        add(new MovementConsistencyCheck());
+        add(new PredictionDriftCheck());
+    }
+    
+    private void add(final Check check) {
+        checks.add(check);
+        perfSites.put(check, Perf.site("check." + check.getName()));
+        if (population != null) {
+            check.setPopulation(population);
+        }
     }
     
     /**
@@ -67,6 +86,18 @@ public final class CheckRegistry {
         }
     }
     
+    /**
+     * Passes the server-wide feature baseline to every registered check.
+     * 
+     * @param population baseline, or null to detach it
+     */
+    public void setPopulation(final PopulationBaseline population) {
+        this.population = population;
+        for (final Check check : checks) {
+            check.setPopulation(population);
+        }
+    }
+    
     /**
      * Returns a list of all currently enabled checks.
      * 
@@ -131,7 +162,7 @@ public final class CheckRegistry {
             return false;
         }
         
-        checks.add(check);
+        add(check);
         return true;
     }
     
@@ -148,9 +179,21 @@ public final class CheckRegistry {
     public boolean unregister(final String name) {
         Objects.requireNonNull(name, "name must not be null");
         
+        perfSites.keySet().removeIf(check -> name.equals(check.getName()));
         return checks.removeIf(check -> name.equals(check.getName()));
     }
     
+    /**
+     * Returns the latency site used to time a check.
+     * 
+     * @param check a registered check
+     * @return site id, or {@link Perf#NO_SITE} if untimed
+     */
+    public int perfSite(final Check check) {
+        final Integer site = perfSites.get(check);
+        return site != null ? site : Perf.NO_SITE;
+    }
+    
     /**
      * Returns the total number of registered checks.
      * 
@@ -4,15 +4,31 @@ import com.macmoment.macac.config.EngineConfig;
 import com.macmoment.macac.model.Features;
 import com.macmoment.macac.model.PlayerContext;
 import com.macmoment.macac.model.TelemetryInput;
+import com.macmoment.macac.util.PopulationBaseline;
 
 /**
  * Extracts features from raw telemetry input.
- * Computes derived metrics like speed, acceleration, and jitter.
+ * Computes derived metrics like speed, acceleration, and jitter, and
+ * records them into the server-wide baseline when one is attached.
  */
 public final class FeatureExtractor {
     
     private static final double NANOS_PER_TICK = 50_000_000.0; // 50ms
     
+    // Server-wide feature distribution (null when disabled or without native)
+    private volatile PopulationBaseline population;
+    
+    /**
+     * Attaches the baseline that extracted features are recorded into.
+     * Lagging movements and special movement states (flying, gliding,
+     * vehicles) are left out so they do not widen the population.
+     * 
+     * @param population baseline, or null to stop recording
+     */
+    public void setPopulation(final PopulationBaseline population) {
+        this.population = population;
+    }
+    
     /**
      * Extracts features from the current input and player context.
      * 
@@ -83,7 +99,12 @@ public final class FeatureExtractor {
         // Sample count
         builder.sampleCount(context.getTelemetryHistory().size());
         
-        return builder.build();
+        final Features features = builder.build();
+        final PopulationBaseline p = population;
+        if (p != null && !isLagging && !input.hasSpecialMovement()) {
+            p.record(features);
+        }
+        return features;
     }
     
     /**
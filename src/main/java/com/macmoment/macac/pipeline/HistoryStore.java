@@ -2,6 +2,7 @@ package com.macmoment.macac.pipeline;
 
 import com.macmoment.macac.config.EngineConfig;
 import com.macmoment.macac.model.PlayerContext;
+import com.macmoment.macac.util.HistorySlab;
 
 import java.util.Map;
 import java.util.UUID;
@@ -10,6 +11,16 @@ import java.util.concurrent.ConcurrentHashMap;
 /**
  * Manages per-player history and context data.
  * Thread-safe for concurrent access from multiple threads.
+ * 
+ * <p>When the native library is available, each player context is also
+ * given a slot in a shared native {@link HistorySlab}. Slots are acquired
+ * on first use and returned on removal, so join/quit churn maps to slot
+ * reuse rather than native allocations.
+ * 
+ * <p>With {@code history.persist_file} set, the slab is mapped from that file.
+ * Departing players' slots are parked instead of released, and a player
+ * whose slot survived (from earlier in the session or from before a
+ * restart) gets it back and their context is seeded from it.
  */
 public final class HistoryStore {
     
@@ -17,23 +28,48 @@ public final class HistoryStore {
     private int historySize;
     private int medianWindowSize;
     private double ewmaAlpha;
+    private int nativeSlots;
+    private int nativeStorage;
+    private String persistPath;
+    
+    // Native history slab (null when native is unavailable or disabled)
+    private volatile HistorySlab slab;
     
     public HistoryStore() {
         this.contexts = new ConcurrentHashMap<>();
         this.historySize = 64;
         this.medianWindowSize = 20;
         this.ewmaAlpha = 0.3;
+        this.nativeSlots = 0;
     }
     
     /**
      * Updates configuration values.
      * 
+     * <p>The native slab is created on first configuration. Its window size
+     * and capacity are fixed for the lifetime of the store; changes to
+     * {@code history.size}, {@code history.native_slots} or
+     * {@code history.native_storage} take effect on restart.
+     * 
      * @param config Engine configuration
      */
     public void configure(EngineConfig config) {
         this.historySize = config.getHistorySize();
         this.medianWindowSize = config.getMedianWindowSize();
         this.ewmaAlpha = config.getEwmaAlpha();
+        this.nativeSlots = config.getNativeHistorySlots();
+        this.nativeStorage = HistorySlab.storageOf(config.getHistoryNativeStorage());
+        this.persistPath = config.getHistoryPersistPath();
+        
+        if (slab == null && nativeSlots > 0) {
+            HistorySlab s = null;
+            if (persistPath != null) {
+                s = HistorySlab.openMapped(persistPath, nativeSlots, PlayerContext.SLAB_METRIC_COUNT, historySize,
+                    nativeStorage);
+            }
+            slab = s != null ? s : HistorySlab.create(nativeSlots, PlayerContext.SLAB_METRIC_COUNT, historySize,
+                nativeStorage);
+        }
     }
     
     /**
@@ -44,8 +80,18 @@ public final class HistoryStore {
      * @return Player context
      */
     public PlayerContext getOrCreate(UUID playerId, String playerName) {
-        return contexts.computeIfAbsent(playerId, 
-            id -> new PlayerContext(id, playerName, historySize, medianWindowSize, ewmaAlpha));
+        return contexts.computeIfAbsent(playerId, id -> {
+            PlayerContext context = new PlayerContext(id, playerName, historySize, medianWindowSize, ewmaAlpha);
+            HistorySlab s = slab;
+            if (s != null) {
+                long slotId = s.acquire(id);
+                if (slotId != HistorySlab.NO_SLOT) {
+                    context.attachSlab(s, slotId);
+                    context.restoreFromSlab();
+                }
+            }
+            return context;
+        });
     }
     
     /**
@@ -59,22 +105,57 @@ public final class HistoryStore {
     }
     
     /**
-     * Removes a player context.
+     * Removes a player context and returns its slab slot to the free-list,
+     * or parks it when the slab is persistent.
      * 
      * @param playerId Player UUID
      * @return Removed context or null
      */
     public PlayerContext remove(UUID playerId) {
-        return contexts.remove(playerId);
+        PlayerContext context = contexts.remove(playerId);
+        if (context != null) {
+            releaseSlot(context);
+        }
+        return context;
     }
     
     /**
-     * Clears all stored contexts.
+     * Clears all stored contexts and releases (or parks) their slab slots.
      */
     public void clear() {
+        for (PlayerContext context : contexts.values()) {
+            releaseSlot(context);
+        }
         contexts.clear();
     }
     
+    /**
+     * Releases the native slab. Called on engine shutdown.
+     * 
+     * <p>A persistent slab keeps every player's windows: slots are parked,
+     * flushed to the history file and left there for the next start.
+     */
+    public void close() {
+        clear();
+        HistorySlab s = slab;
+        slab = null;
+        if (s != null) {
+            s.sync(true);
+            s.close();
+        }
+    }
+    
+    /**
+     * Queues write-back of the history file without waiting for it.
+     * No-op unless the slab is persistent.
+     */
+    public void sync() {
+        HistorySlab s = slab;
+        if (s != null && s.isPersistent()) {
+            s.sync(false);
+        }
+    }
+    
     /**
      * Returns the number of tracked players.
      * 
@@ -92,4 +173,26 @@ public final class HistoryStore {
     public Map<UUID, PlayerContext> getAll() {
         return Map.copyOf(contexts);
     }
+    
+    /**
+     * Returns the native history slab.
+     * 
+     * @return History slab, or null if native is unavailable or disabled
+     */
+    public HistorySlab getSlab() {
+        return slab;
+    }
+    
+    private void releaseSlot(PlayerContext context) {
+        HistorySlab s = context.getSlab();
+        long slotId = context.detachSlab();
+        if (s == null) {
+            return;
+        }
+        if (s.isPersistent()) {
+            s.park(slotId);
+        } else {
+            s.release(slotId);
+        }
+    }
 }
@@ -0,0 +1,190 @@
+package com.macmoment.macac.pipeline;
+
+import com.macmoment.macac.model.MovementPrediction;
+import com.macmoment.macac.model.TelemetryInput;
+import com.macmoment.macac.util.MovementBatch;
+
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.UUID;
+
+/**
+ * Predicts one tick of movement for every player in a telemetry batch with
+ * a single {@link MovementBatch} step, ahead of the per-player checks.
+ * 
+ * <p>The model is the one {@code PredictionDriftCheck} applies: the player
+ * keeps the average of their last {@code window} movements, less gravity on
+ * Y. Averages are summed newest first, exactly as the check sums its
+ * history, so a prediction is bit-identical to the check's own.
+ * 
+ * <p>Each player's recent inputs are kept in a fixed ring, allocated when
+ * the player is first seen and written in place from then on, so tracking
+ * allocates nothing per tick. A prediction hands the ring and the position
+ * of its newest input to the player's analysis lane without copying; the
+ * ring holds {@link #LANE_LAG_TICKS} more inputs than a window, so later
+ * ticks do not overwrite a window its lane has yet to check.
+ * 
+ * <p><strong>Thread Safety:</strong> main thread only.
+ */
+public final class MovementPredictor {
+    
+    /** Vertical velocity lost per tick, as assumed by PredictionDriftCheck. */
+    private static final double GRAVITY = 0.08;
+    
+    /** Smallest batch allocated, so a growing server does not reallocate every tick. */
+    private static final int MIN_BATCH = 64;
+    
+    /**
+     * Ticks an analysis lane may fall behind before its prediction's window
+     * is overwritten (it then stops matching, and the check predicts itself).
+     */
+    private static final int LANE_LAG_TICKS = 8;
+    
+    private final Map<UUID, Recent> recent = new HashMap<>();
+    private int window;
+    
+    // Reused across batches; grown when a batch is larger
+    private MovementBatch batch;
+    private TelemetryInput[][] rings = new TelemetryInput[0][];
+    private int[] newest = new int[0];
+    
+    /**
+     * One player's inputs: ring[head] is the newest, then older ones
+     * backwards, count of them valid (at most the window).
+     */
+    private static final class Recent {
+        final TelemetryInput[] ring;
+        int head;
+        int count;
+        
+        Recent(int capacity) {
+            this.ring = new TelemetryInput[capacity];
+            this.head = capacity - 1;
+        }
+    }
+    
+    public MovementPredictor() {
+        this.window = 0;
+    }
+    
+    /**
+     * Sets the number of past inputs averaged into a prediction. Tracked
+     * inputs are dropped when it changes.
+     * 
+     * @param window Inputs per prediction; below 1 disables prediction
+     */
+    public void configure(int window) {
+        if (window != this.window) {
+            this.window = window;
+            recent.clear();
+        }
+    }
+    
+    /**
+     * Starts a batch of up to {@code players} inputs.
+     * 
+     * @param players Upper bound on {@link #add} calls before {@link #predict()}
+     */
+    public void begin(int players) {
+        if (batch == null || batch.maxPlayers() < players) {
+            batch = new MovementBatch(Math.max(MIN_BATCH, players));
+            rings = new TelemetryInput[batch.maxPlayers()][];
+            newest = new int[batch.maxPlayers()];
+        } else {
+            clear();
+        }
+    }
+    
+    /**
+     * Records a player's input and queues its prediction, if the player has
+     * a full window of earlier inputs. Call {@link #begin} first.
+     * 
+     * @param playerId Player UUID
+     * @param input The player's newest input
+     * @return Slot for {@link #prediction(int)}, or -1 if nothing was queued
+     */
+    public int add(UUID playerId, TelemetryInput input) {
+        if (window < 1) {
+            return -1;
+        }
+        
+        Recent r = recent.get(playerId);
+        if (r == null) {
+            r = new Recent(window + 1 + LANE_LAG_TICKS);
+            recent.put(playerId, r);
+        }
+        final TelemetryInput[] ring = r.ring;
+        
+        int slot = -1;
+        if (r.count == window) {
+            // Newest first, as the check sums its history
+            double totalDx = 0, totalDy = 0, totalDz = 0;
+            int index = r.head;
+            for (int i = 0; i < window; i++) {
+                final TelemetryInput sample = ring[index];
+                totalDx += sample.dx();
+                totalDy += sample.dy();
+                totalDz += sample.dz();
+                index = index == 0 ? ring.length - 1 : index - 1;
+            }
+            
+            slot = batch.add(totalDx / window, totalDy / window, totalDz / window,
+                input.dx(), input.dy(), input.dz(), false, 1.0, GRAVITY, 1.0);
+            rings[slot] = ring;
+            newest[slot] = r.head;
+        }
+        
+        r.head = r.head + 1 == ring.length ? 0 : r.head + 1;
+        ring[r.head] = input;
+        if (r.count < window) {
+            r.count++;
+        }
+        return slot;
+    }
+    
+    /**
+     * Runs the step for every prediction queued since the last call
+     * (natively when available).
+     */
+    public void predict() {
+        if (batch != null) {
+            batch.predict();
+        }
+    }
+    
+    /**
+     * Returns a prediction computed by the last {@link #predict()}.
+     * 
+     * @param slot Slot returned by {@link #add}
+     */
+    public MovementPrediction prediction(int slot) {
+        return new MovementPrediction(
+            batch.result(slot, MovementBatch.OUT_PREDICTED_X),
+            batch.result(slot, MovementBatch.OUT_PREDICTED_Y),
+            batch.result(slot, MovementBatch.OUT_PREDICTED_Z),
+            batch.result(slot, MovementBatch.OUT_DRIFT),
+            rings[slot],
+            newest[slot],
+            window);
+    }
+    
+    /**
+     * Drops the queued predictions and their windows; collect them first.
+     */
+    public void clear() {
+        if (batch != null) {
+            Arrays.fill(rings, 0, batch.size(), null);
+            batch.clear();
+        }
+    }
+    
+    /**
+     * Forgets a player's inputs (quit, or a world change clearing their history).
+     * 
+     * @param playerId Player UUID
+     */
+    public void remove(UUID playerId) {
+        recent.remove(playerId);
+    }
+}
@@ -90,8 +90,9 @@ public final class CombatAimbotCheck {
         
         // === Analysis 2: Aim Consistency Detection ===
         // Aimbots have unnaturally consistent aim (too perfect)
-        double aimVariance = context.getAimErrorWindow().stdDev();
-        double meanAimError = context.getAimErrorWindow().mean();
+        Stats.Description aimStats = context.getAimErrorWindow().describe();
+        double aimVariance = aimStats.stdDev();
+        double meanAimError = aimStats.mean();
         
         if (aimVariance < minAimVariance && meanAimError < maxAimPerfection) {
             // Too consistent and too accurate
@@ -15,6 +15,7 @@ import java.util.Map;
  * Detection signals:
  * - Unnaturally high hit rates (normal ~60-70%, aura often 90%+)
  * - Consistent attack intervals (auto-clickers)
+ * - Periodic interval patterns under added jitter (spectral analysis)
  * - Attacks while looking away from target
  * - Hitting multiple targets in quick succession
  * - Attack speed violations (exceeding cooldown)
@@ -45,6 +46,10 @@ public final class CombatAutoClickerCheck {
     private static final double HUMAN_AVERAGE_HIT_RATE = 0.65;
     private static final double HUMAN_MAX_HIT_RATE = 0.85;
     private static final double AIMBOT_HIT_RATE_THRESHOLD = 0.90;
+    
+    // Interval spectrum limits (white human jitter stays well below these)
+    private static final double MAX_HUMAN_PEAK_POWER = 0.4;
+    private static final double MAX_HUMAN_AUTOCORR = 0.6;
 
     public String getName() { return NAME; }
     public String getCategory() { return CATEGORY; }
@@ -104,8 +109,9 @@ public final class CombatAutoClickerCheck {
         // === Analysis 2: Attack Speed/CPS Analysis ===
         // Detect auto-clickers by analyzing click patterns
         if (context.getAttackIntervalWindow().size() >= minSamplesRequired) {
-            double meanInterval = context.getAttackIntervalWindow().mean();
-            double intervalStdDev = context.getAttackIntervalWindow().stdDev();
+            Stats.Description intervals = context.getAttackIntervalWindow().describe();
+            double meanInterval = intervals.mean();
+            double intervalStdDev = intervals.stdDev();
             
             // Calculate effective CPS
             double cps = meanInterval > 0 ? 1000.0 / meanInterval : 0;
@@ -119,7 +125,7 @@ public final class CombatAutoClickerCheck {
             }
             
             // Check attack cooldown violations
-            double minInterval = context.getAttackIntervalWindow().min();
+            double minInterval = intervals.min();
             if (minInterval < minAttackInterval) {
                 double cooldownViolation = (minAttackInterval - minInterval) / minAttackInterval;
                 anomalyScore += cooldownViolation;
@@ -148,7 +154,33 @@ public final class CombatAutoClickerCheck {
             }
         }
         
-        // === Analysis 4: Look-Away Attacks ===
+        // === Analysis 4: Periodic Click Pattern ===
+        // Jittered clickers pass the consistency test but repeat a pattern:
+        // one dominant interval frequency or a strong autocorrelation peak.
+        // The lowest bin and lag 1 are skipped; they mostly measure drift.
+        if (context.getAttackIntervalWindow().size() >= Stats.Spectrum.MIN_WINDOW) {
+            Stats.Spectrum spectrum = context.getAttackIntervalWindow().spectrum();
+            double patternAnomaly = 0.0;
+            
+            if (spectrum.peakPower() > MAX_HUMAN_PEAK_POWER
+                    && spectrum.peakFrequency() * spectrum.window() >= 2.0) {
+                patternAnomaly += (spectrum.peakPower() - MAX_HUMAN_PEAK_POWER) / (1.0 - MAX_HUMAN_PEAK_POWER);
+            }
+            if (spectrum.autocorrPeak() > MAX_HUMAN_AUTOCORR && spectrum.autocorrLag() >= 2) {
+                patternAnomaly += (spectrum.autocorrPeak() - MAX_HUMAN_AUTOCORR) / (1.0 - MAX_HUMAN_AUTOCORR);
+            }
+            
+            if (patternAnomaly > 0) {
+                anomalyScore += patternAnomaly * 1.5;
+                explain.put("intervalSpectralEntropy", spectrum.entropy());
+                explain.put("intervalSpectralPeak", spectrum.peakPower());
+                explain.put("intervalAutocorr", spectrum.autocorrPeak());
+                explain.put("intervalAutocorrLag", spectrum.autocorrLag());
+                explain.put("patternAnomaly", patternAnomaly);
+            }
+        }
+        
+        // === Analysis 5: Look-Away Attacks ===
         // Killaura can hit targets not in FOV
         double aimError = input.aimError();
         if (input.hit() && aimError > 90.0) {
@@ -164,7 +196,7 @@ public final class CombatAutoClickerCheck {
             explain.put("edgeAimError", aimError);
         }
         
-        // === Analysis 5: Multi-Target Rapid Switching ===
+        // === Analysis 6: Multi-Target Rapid Switching ===
         // Killaura rapidly switches between targets
         if (context.getCombatHistory().size() >= 3) {
             int targetSwitches = countRecentTargetSwitches(context, 5);
@@ -177,7 +209,7 @@ public final class CombatAutoClickerCheck {
             }
         }
         
-        // === Analysis 6: Critical Hit Rate ===
+        // === Analysis 7: Critical Hit Rate ===
         // Suspiciously high critical rate can indicate hack
         double critRate = context.getCriticalRate();
         if (critRate > 0.7 && context.getTotalHits() >= minSamplesRequired) {
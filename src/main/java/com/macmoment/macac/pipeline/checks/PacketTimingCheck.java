@@ -6,6 +6,7 @@ import com.macmoment.macac.model.Features;
 import com.macmoment.macac.model.PlayerContext;
 import com.macmoment.macac.model.TelemetryInput;
 import com.macmoment.macac.pipeline.Check;
+import com.macmoment.macac.util.PopulationBaseline;
 import com.macmoment.macac.util.Stats;
 
 import java.util.HashMap;
@@ -13,7 +14,9 @@ import java.util.Map;
 
 /**
  * Analyzes packet inter-arrival times to detect unnatural burst patterns.
- * Uses ping-normalized timing with rolling median and MAD for robust detection.
+ * Uses ping-normalized timing with rolling median and MAD for robust detection,
+ * and, with a population baseline, flags timing skew beyond what the rest of
+ * the server shows.
  */
 public final class PacketTimingCheck implements Check {
     
@@ -25,10 +28,17 @@ public final class PacketTimingCheck implements Check {
     private double weight;
     private long minDeltaMs;
     private double maxJitterCoeff;
+    private double populationQuantile;
+    
+    // Server-wide baseline (null when disabled)
+    private volatile PopulationBaseline population;
     
     // Expected tick interval (50ms for 20 TPS)
     private static final double EXPECTED_DELTA_MS = 50.0;
     private static final double SCALE_FACTOR = 2.0;
+    
+    // Population bounds below this skew are server-wide noise, not a norm
+    private static final double MIN_POPULATION_SKEW = 0.1;
 
     @Override
     public String getName() { return NAME; }
@@ -48,6 +58,12 @@ public final class PacketTimingCheck implements Check {
         this.weight = config.getPacketTimingWeight();
         this.minDeltaMs = config.getPacketTimingMinDeltaMs();
         this.maxJitterCoeff = config.getPacketTimingMaxJitter();
+        this.populationQuantile = config.getPacketTimingPopulationQuantile();
+    }
+    
+    @Override
+    public void setPopulation(PopulationBaseline population) {
+        this.population = population;
     }
 
     @Override
@@ -84,14 +100,8 @@ public final class PacketTimingCheck implements Check {
         }
         
         // Check for burst patterns (many packets in short time)
-        double[] deltas = context.getPacketDeltaWindow().toArray();
-        int burstCount = 0;
-        for (double delta : deltas) {
-            if (delta < minDeltaMs) {
-                burstCount++;
-            }
-        }
-        double burstRatio = (double) burstCount / deltas.length;
+        int burstCount = context.getPacketDeltaWindow().countBelow(minDeltaMs);
+        double burstRatio = (double) burstCount / context.getPacketDeltaWindow().size();
         
         // Calculate timing skew from expected interval
         // Account for ping in expected interval
@@ -99,8 +109,9 @@ public final class PacketTimingCheck implements Check {
         double skew = Math.abs(medianDelta - pingAdjustedExpected) / pingAdjustedExpected;
         
         // Check for jitter coefficient (stdDev / mean)
-        double mean = context.getPacketDeltaWindow().mean();
-        double stdDev = context.getPacketDeltaWindow().stdDev();
+        Stats.Description deltas = context.getPacketDeltaWindow().describe();
+        double mean = deltas.mean();
+        double stdDev = deltas.stdDev();
         double jitterCoeff = mean > 0 ? stdDev / mean : 0;
         
         // Combine anomaly signals
@@ -126,6 +137,16 @@ public final class PacketTimingCheck implements Check {
             anomalyScore += skew;
         }
         
+        // Skew beyond the population quantile (e.g. worse than 99.9% of the server)
+        double populationBound = Double.NaN;
+        PopulationBaseline p = population;
+        if (p != null && populationQuantile > 0 && p.isReady(PopulationBaseline.TIMING_SKEW)) {
+            populationBound = Math.max(MIN_POPULATION_SKEW, p.quantile(PopulationBaseline.TIMING_SKEW, populationQuantile));
+            if (features.timingSkew() > populationBound) {
+                anomalyScore += Math.min(1.0, (features.timingSkew() - populationBound) / populationBound);
+            }
+        }
+        
         // Convert to confidence using sigmoid transformation
         double confidence = Stats.anomalyToConfidence(anomalyScore, SCALE_FACTOR);
         
@@ -142,6 +163,10 @@ public final class PacketTimingCheck implements Check {
         explain.put("burstRatio", burstRatio);
         explain.put("jitterCoeff", jitterCoeff);
         explain.put("skew", skew);
+        if (!Double.isNaN(populationBound)) {
+            explain.put("populationSkewBound", populationBound);
+            explain.put("populationSkewRank", p.cdf(PopulationBaseline.TIMING_SKEW, features.timingSkew()));
+        }
         explain.put("anomalyScore", anomalyScore);
         
         return CheckResult.violation(NAME, confidence, severity, explain);
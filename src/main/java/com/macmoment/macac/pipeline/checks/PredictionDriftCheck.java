@@ -3,6 +3,7 @@ package com.macmoment.macac.pipeline.checks;
 import com.macmoment.macac.config.EngineConfig;
 import com.macmoment.macac.model.CheckResult;
 import com.macmoment.macac.model.Features;
+import com.macmoment.macac.model.MovementPrediction;
 import com.macmoment.macac.model.PlayerContext;
 import com.macmoment.macac.model.TelemetryInput;
 import com.macmoment.macac.pipeline.Check;
@@ -29,7 +30,8 @@ public final class PredictionDriftCheck implements Check {
     private double maxDriftThreshold;
     
     // Prediction state (per-player tracking handled via context)
-    // We use a simple linear extrapolation model
+    // We use a simple linear extrapolation model; the engine usually
+    // precomputes it for the whole tick (MovementPredictor)
 
     @Override
     public String getName() { return NAME; }
@@ -68,42 +70,52 @@ public final class PredictionDriftCheck implements Check {
             return CheckResult.clean(NAME);
         }
         
-        // Build prediction based on recent velocity trend
-        // Use last N samples to compute average velocity and predict current position
-        double totalDx = 0, totalDy = 0, totalDz = 0;
-        int sampleCount = 0;
-        
-        for (int i = 1; i <= minDriftSamples && i < history.size(); i++) {
-            TelemetryInput sample = history.get(i);
-            if (sample != null) {
-                totalDx += sample.dx();
-                totalDy += sample.dy();
-                totalDz += sample.dz();
-                sampleCount++;
+        // Batched prediction, if it was built from this player's history
+        double predictedDx, predictedDy, predictedDz, totalDrift;
+        MovementPrediction batched = context.getMovementPrediction();
+        if (batched != null && batched.matches(history, minDriftSamples)) {
+            predictedDx = batched.predictedDx();
+            predictedDy = batched.predictedDy();
+            predictedDz = batched.predictedDz();
+            totalDrift = batched.drift();
+        } else {
+            // Build prediction based on recent velocity trend
+            // Use last N samples to compute average velocity and predict current position
+            double totalDx = 0, totalDy = 0, totalDz = 0;
+            int sampleCount = 0;
+            
+            for (int i = 1; i <= minDriftSamples && i < history.size(); i++) {
+                TelemetryInput sample = history.get(i);
+                if (sample != null) {
+                    totalDx += sample.dx();
+                    totalDy += sample.dy();
+                    totalDz += sample.dz();
+                    sampleCount++;
+                }
             }
+            
+            if (sampleCount < minDriftSamples - 1) {
+                return CheckResult.clean(NAME);
+            }
+            
+            // Average velocity from history
+            double avgDx = totalDx / sampleCount;
+            double avgDy = totalDy / sampleCount;
+            double avgDz = totalDz / sampleCount;
+            
+            // Predicted delta for this tick (simple continuation of average velocity)
+            // Account for gravity on Y
+            predictedDx = avgDx;
+            predictedDy = avgDy - 0.08; // Apply gravity
+            predictedDz = avgDz;
+            
+            // Calculate drift from prediction
+            double driftX = Math.abs(input.dx() - predictedDx);
+            double driftY = Math.abs(input.dy() - predictedDy);
+            double driftZ = Math.abs(input.dz() - predictedDz);
+            totalDrift = Math.sqrt(driftX * driftX + driftY * driftY + driftZ * driftZ);
         }
         
-        if (sampleCount < minDriftSamples - 1) {
-            return CheckResult.clean(NAME);
-        }
-        
-        // Average velocity from history
-        double avgDx = totalDx / sampleCount;
-        double avgDy = totalDy / sampleCount;
-        double avgDz = totalDz / sampleCount;
-        
-        // Predicted delta for this tick (simple continuation of average velocity)
-        // Account for gravity on Y
-        double predictedDx = avgDx;
-        double predictedDy = avgDy - 0.08; // Apply gravity
-        double predictedDz = avgDz;
-        
-        // Calculate drift from prediction
-        double driftX = Math.abs(input.dx() - predictedDx);
-        double driftY = Math.abs(input.dy() - predictedDy);
-        double driftZ = Math.abs(input.dz() - predictedDz);
-        double totalDrift = Math.sqrt(driftX * driftX + driftY * driftY + driftZ * driftZ);
-        
         // Ping-adjusted threshold
         double pingFactor = 1.0 + (context.getMedianPing() / 300.0);
         double adjustedThreshold = maxDriftThreshold * pingFactor;
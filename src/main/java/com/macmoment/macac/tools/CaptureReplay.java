@@ -0,0 +1,417 @@
+package com.macmoment.macac.tools;
+
+import com.macmoment.macac.config.EngineConfig;
+import com.macmoment.macac.model.CheckResult;
+import com.macmoment.macac.model.CombatCheckResult;
+import com.macmoment.macac.model.CombatContext;
+import com.macmoment.macac.model.CombatInput;
+import com.macmoment.macac.model.Features;
+import com.macmoment.macac.model.PlayerContext;
+import com.macmoment.macac.model.TelemetryInput;
+import com.macmoment.macac.model.Violation;
+import com.macmoment.macac.pipeline.Aggregator;
+import com.macmoment.macac.pipeline.Check;
+import com.macmoment.macac.pipeline.CheckRegistry;
+import com.macmoment.macac.pipeline.FeatureExtractor;
+import com.macmoment.macac.pipeline.checks.CombatAimbotCheck;
+import com.macmoment.macac.pipeline.checks.CombatAutoClickerCheck;
+import com.macmoment.macac.pipeline.checks.CombatReachCheck;
+import com.macmoment.macac.util.CaptureReader;
+import com.macmoment.macac.util.HistorySlab;
+import com.macmoment.macac.util.NativeHelper;
+
+import org.bukkit.configuration.file.YamlConfiguration;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InputStreamReader;
+import java.io.Reader;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.UUID;
+import java.util.stream.Stream;
+
+/**
+ * Offline replay of capture files through the full detection pipeline.
+ * 
+ * <p>Every movement sample goes through feature extraction, every enabled
+ * movement check and aggregation, exactly as in the engine's analysis path;
+ * every attack goes through the combat checks. Mitigation and actions are
+ * skipped, since they need a live server. Samples are replayed back to back
+ * without pacing, so the result is the pipeline's throughput, plus latency
+ * percentiles per stage and per check, on this host and configuration.
+ * 
+ * <p>Run with the plugin jar and a server jar (for the YAML parser) on the
+ * class path:
+ * <pre>
+ *   java -cp MacAC.jar:paper.jar com.macmoment.macac.tools.CaptureReplay \
+ *       [--config config.yml] [--repeat N] capture-dir-or-files...
+ * </pre>
+ * The native library is used when {@code java.library.path} finds it, as on
+ * the server; captures for load tests can be written with
+ * {@code macac_replay --synth}.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class CaptureReplay implements CaptureReader.Visitor {
+    
+    private final EngineConfig config;
+    private final FeatureExtractor featureExtractor;
+    private final CheckRegistry checkRegistry;
+    private final Aggregator aggregator;
+    private final CombatAimbotCheck aimbotCheck;
+    private final CombatReachCheck reachCheck;
+    private final CombatAutoClickerCheck autoClickerCheck;
+    private final HistorySlab slab;
+    
+    private final Map<UUID, PlayerContext> players = new HashMap<>();
+    private final Map<UUID, CombatContext> combatants = new HashMap<>();
+    private final Map<String, Latency> stages = new LinkedHashMap<>();
+    private final Map<String, long[]> violations = new LinkedHashMap<>();
+    private long telemetryCount;
+    private long combatCount;
+    private long laggingCount;
+    
+    private CaptureReplay(final EngineConfig config) {
+        this.config = config;
+        this.featureExtractor = new FeatureExtractor();
+        this.checkRegistry = new CheckRegistry();
+        this.aggregator = new Aggregator();
+        this.aimbotCheck = new CombatAimbotCheck();
+        this.reachCheck = new CombatReachCheck();
+        this.autoClickerCheck = new CombatAutoClickerCheck();
+        checkRegistry.configure(config);
+        aggregator.configure(config);
+        aimbotCheck.configure(config);
+        reachCheck.configure(config);
+        autoClickerCheck.configure(config);
+        
+        // Same native windows as the server, but never the server's history file
+        this.slab = config.getNativeHistorySlots() > 0
+            ? HistorySlab.create(config.getNativeHistorySlots(), PlayerContext.SLAB_METRIC_COUNT,
+                config.getHistorySize(), HistorySlab.storageOf(config.getHistoryNativeStorage()))
+            : null;
+    }
+    
+    public static void main(final String[] args) throws IOException {
+        Path configPath = null;
+        int repeats = 1;
+        final List<Path> inputs = new ArrayList<>();
+        for (int i = 0; i < args.length; i++) {
+            switch (args[i]) {
+                case "--config" -> configPath = Paths.get(requireValue(args, ++i));
+                case "--repeat" -> repeats = Math.max(1, Integer.parseInt(requireValue(args, ++i)));
+                case "--help", "-h" -> {
+                    usage();
+                    return;
+                }
+                default -> inputs.add(Paths.get(args[i]));
+            }
+        }
+        
+        final List<Path> files = captureFiles(inputs);
+        if (files.isEmpty()) {
+            usage();
+            System.exit(1);
+        }
+        
+        final EngineConfig config = loadConfig(configPath);
+        System.out.println("native: " + (NativeHelper.isNativeAvailable() ? "yes" : "no")
+            + ", files: " + files.size() + " x " + repeats + " pass(es)");
+        
+        long elapsed = 0;
+        CaptureReplay replay = null;
+        for (int r = 0; r < repeats; r++) {
+            // Every pass starts cold, like a fresh server
+            final CaptureReplay pass = new CaptureReplay(config);
+            final long start = System.nanoTime();
+            for (final Path file : files) {
+                final CaptureReader.Summary summary = CaptureReader.read(file, pass);
+                if (summary.truncated()) {
+                    System.out.println("note: " + file + " ends inside a record");
+                }
+            }
+            elapsed += System.nanoTime() - start;
+            if (replay != null) {
+                pass.mergeFrom(replay);
+            }
+            pass.close();
+            replay = pass;
+        }
+        replay.report(elapsed);
+    }
+    
+    // ========================================================================
+    // Pipeline
+    // ========================================================================
+    
+    @Override
+    public void telemetry(final UUID playerId, final TelemetryInput input) {
+        telemetryCount++;
+        final long begin = System.nanoTime();
+        
+        final PlayerContext context = players.computeIfAbsent(playerId, this::newContext);
+        context.addTelemetry(input);
+        
+        final long featuresStart = System.nanoTime();
+        final Features features = featureExtractor.extract(input, context);
+        stage("features.extract").record(System.nanoTime() - featuresStart);
+        context.addFeatures(features);
+        
+        if (features.isLagging()) {
+            laggingCount++;
+            stage("replay.telemetry").record(System.nanoTime() - begin);
+            return;
+        }
+        
+        final List<Check> enabledChecks = checkRegistry.getEnabledChecks();
+        final List<CheckResult> results = new ArrayList<>(enabledChecks.size());
+        for (final Check check : enabledChecks) {
+            final long checkStart = System.nanoTime();
+            results.add(check.analyze(input, features, context));
+            stage("check." + check.getName()).record(System.nanoTime() - checkStart);
+        }
+        
+        final long aggregateStart = System.nanoTime();
+        final Violation violation = aggregator.aggregate(results, context, input.nanoTime(), input.ping());
+        stage("aggregator.aggregate").record(System.nanoTime() - aggregateStart);
+        if (violation != null) {
+            violations.computeIfAbsent("movement:" + violation.category(), k -> new long[1])[0]++;
+        }
+        
+        stage("replay.telemetry").record(System.nanoTime() - begin);
+    }
+    
+    @Override
+    public void combat(final CombatInput input) {
+        combatCount++;
+        final long begin = System.nanoTime();
+        
+        final CombatContext context = combatants.computeIfAbsent(input.attackerId(),
+            id -> new CombatContext(id, shortName(id), config.getCombatHistorySize(),
+                config.getCombatHistorySize(), config.getEwmaAlpha()));
+        context.addCombatInput(input);
+        
+        long checkStart = System.nanoTime();
+        countCombat(aimbotCheck.analyze(input, context));
+        stage("check." + aimbotCheck.getName()).record(System.nanoTime() - checkStart);
+        
+        checkStart = System.nanoTime();
+        countCombat(reachCheck.analyze(input, context));
+        stage("check." + reachCheck.getName()).record(System.nanoTime() - checkStart);
+        
+        checkStart = System.nanoTime();
+        countCombat(autoClickerCheck.analyze(input, context));
+        stage("check." + autoClickerCheck.getName()).record(System.nanoTime() - checkStart);
+        
+        stage("replay.combat").record(System.nanoTime() - begin);
+    }
+    
+    private PlayerContext newContext(final UUID id) {
+        final PlayerContext context = new PlayerContext(id, shortName(id), config.getHistorySize(),
+            config.getMedianWindowSize(), config.getEwmaAlpha());
+        if (slab != null) {
+            final long slotId = slab.acquire();
+            if (slotId != HistorySlab.NO_SLOT) {
+                context.attachSlab(slab, slotId);
+            }
+        }
+        return context;
+    }
+    
+    private void countCombat(final CombatCheckResult result) {
+        if (result.isViolation()) {
+            violations.computeIfAbsent("combat:" + result.checkName(), k -> new long[1])[0]++;
+        }
+    }
+    
+    private Latency stage(final String name) {
+        Latency latency = stages.get(name);
+        if (latency == null) {
+            latency = new Latency();
+            stages.put(name, latency);
+        }
+        return latency;
+    }
+    
+    // ========================================================================
+    // Reporting
+    // ========================================================================
+    
+    /**
+     * Folds an earlier pass into this one, so repeats report totals.
+     */
+    private void mergeFrom(final CaptureReplay earlier) {
+        telemetryCount += earlier.telemetryCount;
+        combatCount += earlier.combatCount;
+        laggingCount += earlier.laggingCount;
+        for (final Map.Entry<String, Latency> e : earlier.stages.entrySet()) {
+            stage(e.getKey()).merge(e.getValue());
+        }
+        for (final Map.Entry<String, long[]> e : earlier.violations.entrySet()) {
+            violations.computeIfAbsent(e.getKey(), k -> new long[1])[0] += e.getValue()[0];
+        }
+    }
+    
+    private void close() {
+        if (slab != null) {
+            slab.close();
+        }
+    }
+    
+    private void report(final long elapsedNanos) {
+        final long events = telemetryCount + combatCount;
+        final double seconds = elapsedNanos / 1e9;
+        System.out.printf("events:     %d (%d telemetry, %d combat, %d lagging)%n",
+            events, telemetryCount, combatCount, laggingCount);
+        System.out.printf("players:    %d (%d in combat)%n", players.size(), combatants.size());
+        System.out.printf("wall time:  %.3f s%n", seconds);
+        System.out.printf("throughput: %.0f events/s%n%n", seconds > 0 ? events / seconds : 0.0);
+        
+        System.out.printf("  %-28s %12s %10s %10s %10s %10s%n", "stage (us)", "count", "p50", "p99", "p99.9", "max");
+        for (final Map.Entry<String, Latency> e : stages.entrySet()) {
+            final Latency l = e.getValue();
+            System.out.printf("  %-28s %12d %10.2f %10.2f %10.2f %10.2f%n", e.getKey(), l.count(),
+                l.percentile(0.50) / 1000.0, l.percentile(0.99) / 1000.0,
+                l.percentile(0.999) / 1000.0, l.max() / 1000.0);
+        }
+        
+        if (!violations.isEmpty()) {
+            System.out.println();
+            for (final Map.Entry<String, long[]> e : violations.entrySet()) {
+                System.out.printf("  %-28s %12d%n", e.getKey(), e.getValue()[0]);
+            }
+        }
+    }
+    
+    // ========================================================================
+    // Setup
+    // ========================================================================
+    
+    private static String requireValue(final String[] args, final int index) {
+        if (index >= args.length) {
+            usage();
+            System.exit(1);
+        }
+        return args[index];
+    }
+    
+    private static void usage() {
+        System.err.println("usage: CaptureReplay [--config config.yml] [--repeat N] CAPTURE_DIR|FILE.mcap...");
+    }
+    
+    /**
+     * Expands directories to the capture files they hold, in name (and so
+     * rotation) order.
+     */
+    private static List<Path> captureFiles(final List<Path> inputs) throws IOException {
+        final List<Path> files = new ArrayList<>();
+        for (final Path input : inputs) {
+            if (Files.isDirectory(input)) {
+                try (Stream<Path> listing = Files.list(input)) {
+                    listing.filter(p -> p.getFileName().toString().endsWith(".mcap"))
+                        .sorted()
+                        .forEach(files::add);
+                }
+            } else {
+                files.add(input);
+            }
+        }
+        return files;
+    }
+    
+    /**
+     * Loads the given config.yml, or the defaults bundled in the jar. The
+     * data folder is a scratch directory so nothing of the server's is opened.
+     */
+    private static EngineConfig loadConfig(final Path configPath) throws IOException {
+        final File scratch = Files.createTempDirectory("macac-replay").toFile();
+        scratch.deleteOnExit();
+        
+        if (configPath != null) {
+            return EngineConfig.load(YamlConfiguration.loadConfiguration(configPath.toFile()), scratch);
+        }
+        try (InputStream in = CaptureReplay.class.getResourceAsStream("/config.yml")) {
+            if (in == null) {
+                throw new IOException("config.yml not found on the class path; pass --config");
+            }
+            try (Reader reader = new InputStreamReader(in, StandardCharsets.UTF_8)) {
+                return EngineConfig.load(YamlConfiguration.loadConfiguration(reader), scratch);
+            }
+        }
+    }
+    
+    private static String shortName(final UUID id) {
+        return id.toString().substring(0, 8);
+    }
+    
+    /**
+     * Log-linear latency histogram: 16 sub-buckets per power of two, so
+     * percentiles are within about 6%.
+     */
+    private static final class Latency {
+        private static final int SUB_BITS = 4;
+        private static final int SUB = 1 << SUB_BITS;
+        
+        private final long[] buckets = new long[64 * SUB];
+        private long count;
+        private long max;
+        
+        void record(final long nanos) {
+            final long v = Math.max(nanos, 0);
+            buckets[bucketOf(v)]++;
+            count++;
+            max = Math.max(max, v);
+        }
+        
+        void merge(final Latency other) {
+            for (int i = 0; i < buckets.length; i++) {
+                buckets[i] += other.buckets[i];
+            }
+            count += other.count;
+            max = Math.max(max, other.max);
+        }
+        
+        long count() { return count; }
+        long max() { return max; }
+        
+        double percentile(final double q) {
+            final long rank = (long) Math.ceil(q * count);
+            long seen = 0;
+            for (int i = 0; i < buckets.length; i++) {
+                seen += buckets[i];
+                if (seen >= rank && buckets[i] > 0) {
+                    return Math.min(upperBound(i), max);
+                }
+            }
+            return max;
+        }
+        
+        private static int bucketOf(final long v) {
+            if (v < SUB) {
+                return (int) v;
+            }
+            final int exp = 63 - Long.numberOfLeadingZeros(v);
+            final int sub = (int) (v >>> (exp - SUB_BITS)) & (SUB - 1);
+            return (exp - SUB_BITS + 1) * SUB + sub;
+        }
+        
+        private static double upperBound(final int bucket) {
+            if (bucket < SUB) {
+                return bucket;
+            }
+            final int exp = bucket / SUB + SUB_BITS - 1;
+            final int sub = bucket % SUB;
+            return (double) ((long) (SUB + sub + 1) << (exp - SUB_BITS));
+        }
+    }
+}
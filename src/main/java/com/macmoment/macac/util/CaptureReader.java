@@ -0,0 +1,231 @@
+package com.macmoment.macac.util;
+
+import com.macmoment.macac.model.CombatInput;
+import com.macmoment.macac.model.TelemetryInput;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.FileChannel;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.util.UUID;
+
+/**
+ * Reader for capture files written by {@link TelemetryCapture}.
+ * 
+ * <p>A file is a 64-byte header followed by records that each start with a
+ * 16-bit type and a 16-bit total size, so unknown record types are skipped.
+ * Files are memory-mapped and decoded in place; the writer's byte order is
+ * detected from the header, so captures move between hosts. A partly
+ * written last record (a capture still being written, or a crash) ends the
+ * file without an error.
+ * 
+ * <p>This is plain Java and does not need the native library.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class CaptureReader {
+    
+    /** Size of the file header ({@code macac_capture_header_t}). */
+    public static final int HEADER_BYTES = 64;
+    /** Record type of a movement sample. */
+    public static final int TYPE_TELEMETRY = 1;
+    /** Record type of an attack. */
+    public static final int TYPE_COMBAT = 2;
+    /** Size of a movement record ({@code macac_capture_telemetry_t}). */
+    public static final int TELEMETRY_BYTES = 96;
+    /** Size of an attack record ({@code macac_capture_combat_t}). */
+    public static final int COMBAT_BYTES = 136;
+    /** File format version this reader understands. */
+    public static final int VERSION = 1;
+    
+    private static final byte[] MAGIC = { 'M', 'A', 'C', 'A', 'C', 'C', 'A', 'P' };
+    
+    // Header field offsets
+    private static final int OFF_VERSION = 8;
+    private static final int OFF_HEADER_BYTES = 12;
+    private static final int OFF_START_UNIX_MS = 24;
+    private static final int OFF_FILE_INDEX = 32;
+    
+    // Telemetry record: packet queue record at offset 24
+    private static final int OFF_T_RECORD = 24;
+    
+    // Combat record field offsets
+    private static final int OFF_C_FLAGS = 4;
+    private static final int OFF_C_TARGET_HI = 24;
+    private static final int OFF_C_TARGET_X = 40;
+    private static final int OFF_C_ATTACKER_X = 64;
+    private static final int OFF_C_DAMAGE = 88;
+    private static final int OFF_C_YAW = 96;
+    private static final int OFF_C_NANO_TIME = 112;
+    private static final int OFF_C_SINCE_LAST = 120;
+    private static final int OFF_C_PING = 128;
+    
+    /**
+     * Receives decoded records in file order.
+     */
+    public interface Visitor {
+        void telemetry(UUID playerId, TelemetryInput input);
+        
+        /**
+         * @param input attack; {@code attackerName} is null, names are not captured
+         */
+        void combat(CombatInput input);
+    }
+    
+    /**
+     * Outcome of reading one file.
+     * 
+     * @param fileIndex position of the file in its capture's rotation
+     * @param startUnixMs wall clock when the file was started
+     * @param telemetry movement records decoded
+     * @param combat attack records decoded
+     * @param skipped records of unknown type or size
+     * @param truncated true if the file ended inside a record
+     */
+    public record Summary(int fileIndex, long startUnixMs, long telemetry, long combat,
+                          long skipped, boolean truncated) {
+    }
+    
+    private CaptureReader() {
+    }
+    
+    /**
+     * Maps and decodes one capture file.
+     * 
+     * @param file capture file
+     * @param visitor receives every record
+     * @return counts for the file
+     * @throws IOException if the file cannot be read or is not a capture
+     */
+    public static Summary read(final Path file, final Visitor visitor) throws IOException {
+        try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+            final long size = channel.size();
+            if (size > Integer.MAX_VALUE) {
+                throw new IOException("Capture file too large: " + file);
+            }
+            return read(channel.map(FileChannel.MapMode.READ_ONLY, 0, size), visitor);
+        }
+    }
+    
+    /**
+     * Decodes a capture held in a buffer, from position 0 to its limit.
+     * 
+     * @param buffer capture file contents
+     * @param visitor receives every record
+     * @return counts for the buffer
+     * @throws IOException if the buffer does not hold a capture
+     */
+    public static Summary read(final ByteBuffer buffer, final Visitor visitor) throws IOException {
+        final ByteBuffer in = buffer.duplicate();
+        final int size = in.limit();
+        if (size < HEADER_BYTES || !hasMagic(in)) {
+            throw new IOException("Not a capture file");
+        }
+        
+        // The writer's byte order: the version reads as 1 in exactly one of them
+        in.order(ByteOrder.LITTLE_ENDIAN);
+        if (in.getInt(OFF_VERSION) != VERSION) {
+            in.order(ByteOrder.BIG_ENDIAN);
+            if (in.getInt(OFF_VERSION) != VERSION) {
+                throw new IOException("Unsupported capture version");
+            }
+        }
+        
+        final int headerBytes = in.getInt(OFF_HEADER_BYTES);
+        if (headerBytes < HEADER_BYTES || headerBytes > size) {
+            throw new IOException("Corrupt capture header");
+        }
+        
+        long telemetry = 0;
+        long combat = 0;
+        long skipped = 0;
+        int pos = headerBytes;
+        while (pos + 4 <= size) {
+            final int type = in.getShort(pos) & 0xFFFF;
+            final int recordSize = in.getShort(pos + 2) & 0xFFFF;
+            if (recordSize < 4 || pos + recordSize > size) {
+                break;
+            }
+            
+            if (type == TYPE_TELEMETRY && recordSize == TELEMETRY_BYTES) {
+                visitor.telemetry(new UUID(in.getLong(pos + 8), in.getLong(pos + 16)),
+                    decodeTelemetry(in, pos + OFF_T_RECORD));
+                telemetry++;
+            } else if (type == TYPE_COMBAT && recordSize == COMBAT_BYTES) {
+                visitor.combat(decodeCombat(in, pos));
+                combat++;
+            } else {
+                skipped++;
+            }
+            pos += recordSize;
+        }
+        
+        return new Summary(in.getInt(OFF_FILE_INDEX), in.getLong(OFF_START_UNIX_MS),
+            telemetry, combat, skipped, pos != size);
+    }
+    
+    private static boolean hasMagic(final ByteBuffer in) {
+        for (int i = 0; i < MAGIC.length; i++) {
+            if (in.get(i) != MAGIC[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * Same field layout as a {@link PacketQueue} record.
+     */
+    private static TelemetryInput decodeTelemetry(final ByteBuffer in, final int base) {
+        final int flags = in.getInt(base + 64);
+        return new TelemetryInput(
+            in.getDouble(base),
+            in.getDouble(base + 8),
+            in.getDouble(base + 16),
+            in.getFloat(base + 24),
+            in.getFloat(base + 28),
+            in.getFloat(base + 32),
+            in.getFloat(base + 36),
+            (flags & PacketQueue.FLAG_ON_GROUND) != 0,
+            (flags & PacketQueue.FLAG_IN_VEHICLE) != 0,
+            (flags & PacketQueue.FLAG_TELEPORTING) != 0,
+            (flags & PacketQueue.FLAG_SWIMMING) != 0,
+            (flags & PacketQueue.FLAG_GLIDING) != 0,
+            (flags & PacketQueue.FLAG_CLIMBING) != 0,
+            in.getInt(base + 56),
+            in.getLong(base + 40),
+            in.getLong(base + 48)
+        );
+    }
+    
+    private static CombatInput decodeCombat(final ByteBuffer in, final int base) {
+        final int flags = in.getInt(base + OFF_C_FLAGS);
+        final UUID target = (flags & TelemetryCapture.COMBAT_HAS_TARGET) != 0
+            ? new UUID(in.getLong(base + OFF_C_TARGET_HI), in.getLong(base + OFF_C_TARGET_HI + 8))
+            : null;
+        return new CombatInput(
+            new UUID(in.getLong(base + 8), in.getLong(base + 16)),
+            null,
+            target,
+            in.getDouble(base + OFF_C_TARGET_X),
+            in.getDouble(base + OFF_C_TARGET_X + 8),
+            in.getDouble(base + OFF_C_TARGET_X + 16),
+            in.getDouble(base + OFF_C_ATTACKER_X),
+            in.getDouble(base + OFF_C_ATTACKER_X + 8),
+            in.getDouble(base + OFF_C_ATTACKER_X + 16),
+            in.getFloat(base + OFF_C_YAW),
+            in.getFloat(base + OFF_C_YAW + 4),
+            in.getFloat(base + OFF_C_YAW + 8),
+            in.getFloat(base + OFF_C_YAW + 12),
+            in.getLong(base + OFF_C_NANO_TIME),
+            in.getLong(base + OFF_C_SINCE_LAST),
+            (flags & TelemetryCapture.COMBAT_HIT) != 0,
+            in.getDouble(base + OFF_C_DAMAGE),
+            (flags & TelemetryCapture.COMBAT_CRITICAL) != 0,
+            in.getInt(base + OFF_C_PING)
+        );
+    }
+}
@@ -0,0 +1,127 @@
+package com.macmoment.macac.util;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Handle to a native incremental combat accumulator for one player.
+ * 
+ * <p>Each of the five combat columns keeps running mean, variance, min and
+ * max over its last {@code window} samples, updated as attacks are recorded.
+ * {@link #analyze()} therefore scores the window in constant time instead of
+ * rescanning it like {@link NativeHelper#analyzeCombat} or {@link CombatBatch}.
+ * 
+ * <p>The accumulator is only available when the native library is loaded; use
+ * {@link #create(int)} which returns null otherwise.
+ * 
+ * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class CombatAccumulator implements AutoCloseable {
+    
+    private final int window;
+    private final ByteBuffer output;
+    private long handle;
+    
+    private CombatAccumulator(final long handle, final int window) {
+        this.handle = handle;
+        this.window = window;
+        this.output = ByteBuffer.allocateDirect(CombatBatch.RESULT_FIELDS * Double.BYTES)
+            .order(ByteOrder.nativeOrder());
+    }
+    
+    /**
+     * Creates a native accumulator if the native library is available.
+     * 
+     * @param window samples kept per column; must be positive
+     * @return accumulator, or null if native is unavailable or allocation failed
+     */
+    public static CombatAccumulator create(final int window) {
+        if (window <= 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createCombatAccum(window);
+        return handle != 0 ? new CombatAccumulator(handle, window) : null;
+    }
+    
+    /**
+     * Records one attack across all five columns.
+     * 
+     * @param aimError aim error in degrees
+     * @param snapAngle snap angle in degrees
+     * @param reach reach distance in blocks
+     * @param attackInterval time since previous attack in ms
+     * @param hit true if the attack landed
+     */
+    public void record(final double aimError, final double snapAngle, final double reach,
+                       final double attackInterval, final boolean hit) {
+        final long h = handle;
+        if (h != 0) {
+            NativeHelper.combatAccumPush(h, NativeHelper.COMBAT_AIM_ERROR, aimError);
+            NativeHelper.combatAccumPush(h, NativeHelper.COMBAT_SNAP_ANGLE, snapAngle);
+            NativeHelper.combatAccumPush(h, NativeHelper.COMBAT_REACH, reach);
+            NativeHelper.combatAccumPush(h, NativeHelper.COMBAT_ATTACK_INTERVAL, attackInterval);
+            NativeHelper.combatAccumPush(h, NativeHelper.COMBAT_HIT, hit ? 1.0 : 0.0);
+        }
+    }
+    
+    /**
+     * Pushes one sample into a single column.
+     * 
+     * @param column one of the {@code NativeHelper.COMBAT_*} column indices
+     * @param value sample value
+     */
+    public void push(final int column, final double value) {
+        final long h = handle;
+        if (h != 0) {
+            NativeHelper.combatAccumPush(h, column, value);
+        }
+    }
+    
+    /**
+     * Scores the accumulated window. Results are all zero while any column
+     * holds fewer than 5 samples.
+     * 
+     * @return true if analysis ran; false if closed
+     */
+    public boolean analyze() {
+        final long h = handle;
+        return h != 0 && NativeHelper.combatAccumAnalyze(h, output) == 1;
+    }
+    
+    /**
+     * Returns one output field of the last {@link #analyze()}.
+     * 
+     * @param field one of the {@code CombatBatch.RESULT_*} constants
+     * @return field value
+     */
+    public double result(final int field) {
+        return output.getDouble(field * Double.BYTES);
+    }
+    
+    /**
+     * Clears all columns. The native accumulator is retained.
+     */
+    public void clear() {
+        final long h = handle;
+        if (h != 0) {
+            NativeHelper.combatAccumClear(h);
+        }
+    }
+    
+    public int window() { return window; }
+    
+    /**
+     * Frees the native accumulator. Subsequent calls are no-ops.
+     */
+    @Override
+    public void close() {
+        final long h = handle;
+        if (h != 0) {
+            handle = 0;
+            NativeHelper.destroyCombatAccum(h);
+        }
+    }
+}
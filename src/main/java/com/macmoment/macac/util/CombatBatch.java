@@ -0,0 +1,161 @@
+package com.macmoment.macac.util;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Reusable direct-buffer batch for native multi-player combat analysis.
+ * 
+ * <p>Collects the combat windows of many players into one packed off-heap
+ * buffer and analyzes all of them with a single JNI crossing via
+ * {@link NativeHelper#analyzeCombatBatch}. Buffers are allocated once at
+ * construction; filling and analyzing a batch performs no Java allocations.
+ * 
+ * <p><strong>Input layout</strong> (player-major, native-order doubles).
+ * Each player record is {@code 4 + 5 * window} doubles:
+ * <pre>
+ *   [0]                  sample count (&lt;= window)
+ *   [1..3]               reserved (keeps columns 32-byte aligned)
+ *   [4 + 0 * window]     aim errors
+ *   [4 + 1 * window]     snap angles
+ *   [4 + 2 * window]     reaches
+ *   [4 + 3 * window]     attack intervals (ms)
+ *   [4 + 4 * window]     hit flags (1.0 = hit, 0.0 = miss)
+ * </pre>
+ * 
+ * <p><strong>Output layout</strong>: {@value #RESULT_FIELDS} doubles per player,
+ * indexed by the {@code RESULT_*} constants (same order as
+ * {@link NativeHelper#analyzeCombat}).
+ * 
+ * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class CombatBatch {
+    
+    /** Doubles reserved at the start of each player record. */
+    public static final int HEADER_DOUBLES = 4;
+    
+    /** Number of input columns per player record. */
+    public static final int COLUMNS = 5;
+    
+    /** Doubles per output record. */
+    public static final int RESULT_FIELDS = 13;
+    
+    // Output field indices
+    public static final int RESULT_AIMBOT_CONFIDENCE = 0;
+    public static final int RESULT_REACH_CONFIDENCE = 1;
+    public static final int RESULT_AUTOCLICKER_CONFIDENCE = 2;
+    public static final int RESULT_COMBINED_CONFIDENCE = 3;
+    public static final int RESULT_AVG_AIM_ERROR = 4;
+    public static final int RESULT_AIM_VARIANCE = 5;
+    public static final int RESULT_AVG_SNAP_ANGLE = 6;
+    public static final int RESULT_AVG_REACH = 7;
+    public static final int RESULT_HIT_RATE = 8;
+    public static final int RESULT_AVG_ATTACK_INTERVAL = 9;
+    public static final int RESULT_INTERVAL_SPECTRAL_ENTROPY = 10;
+    public static final int RESULT_INTERVAL_SPECTRAL_PEAK = 11;
+    public static final int RESULT_INTERVAL_AUTOCORR = 12;
+    
+    private final int maxPlayers;
+    private final int window;
+    private final int recordBytes;
+    private final ByteBuffer input;
+    private final ByteBuffer output;
+    private int count;
+    
+    /**
+     * Creates a batch with room for {@code maxPlayers} records.
+     * 
+     * @param maxPlayers maximum players per batch; must be positive
+     * @param window samples per column; must be positive
+     * @throws IllegalArgumentException if either argument is not positive
+     */
+    public CombatBatch(final int maxPlayers, final int window) {
+        if (maxPlayers <= 0 || window <= 0) {
+            throw new IllegalArgumentException(
+                String.format("maxPlayers and window must be positive, got: %d, %d", maxPlayers, window));
+        }
+        this.maxPlayers = maxPlayers;
+        this.window = window;
+        this.recordBytes = (HEADER_DOUBLES + COLUMNS * window) * Double.BYTES;
+        this.input = ByteBuffer.allocateDirect(maxPlayers * recordBytes).order(ByteOrder.nativeOrder());
+        this.output = ByteBuffer.allocateDirect(maxPlayers * RESULT_FIELDS * Double.BYTES)
+            .order(ByteOrder.nativeOrder());
+        this.count = 0;
+    }
+    
+    /**
+     * Appends one player's combat windows to the batch.
+     * 
+     * <p>The newest {@code min(window, smallest window size)} samples of each
+     * window are copied so that all columns share one sample count.
+     * 
+     * @return record index for {@link #result(int, int)}, or -1 if the batch is full
+     */
+    public int add(final Stats.RollingWindow aimErrors, final Stats.RollingWindow snapAngles,
+                   final Stats.RollingWindow reaches, final Stats.RollingWindow attackIntervals,
+                   final Stats.RollingWindow hits) {
+        if (count >= maxPlayers) {
+            return -1;
+        }
+        
+        int samples = window;
+        samples = Math.min(samples, aimErrors.size());
+        samples = Math.min(samples, snapAngles.size());
+        samples = Math.min(samples, reaches.size());
+        samples = Math.min(samples, attackIntervals.size());
+        samples = Math.min(samples, hits.size());
+        
+        final int base = count * recordBytes;
+        final int columnBytes = window * Double.BYTES;
+        final int columns = base + HEADER_DOUBLES * Double.BYTES;
+        
+        input.putDouble(base, samples);
+        aimErrors.copyTo(input, columns, samples);
+        snapAngles.copyTo(input, columns + columnBytes, samples);
+        reaches.copyTo(input, columns + 2 * columnBytes, samples);
+        attackIntervals.copyTo(input, columns + 3 * columnBytes, samples);
+        hits.copyTo(input, columns + 4 * columnBytes, samples);
+        
+        return count++;
+    }
+    
+    /**
+     * Analyzes every record added since the last {@link #clear()}.
+     * 
+     * @return true if native analysis ran; false if native is unavailable
+     */
+    public boolean analyze() {
+        if (count == 0) {
+            return true;
+        }
+        if (!NativeHelper.isNativeAvailable()) {
+            return false;
+        }
+        return NativeHelper.analyzeCombatBatch(input, count, window, output) == count;
+    }
+    
+    /**
+     * Returns one output field of an analyzed record.
+     * 
+     * @param index record index returned by {@link #add}
+     * @param field one of the {@code RESULT_*} constants
+     * @return field value
+     */
+    public double result(final int index, final int field) {
+        return output.getDouble((index * RESULT_FIELDS + field) * Double.BYTES);
+    }
+    
+    /**
+     * Resets the batch for the next tick. Buffers are retained.
+     */
+    public void clear() {
+        count = 0;
+    }
+    
+    public int size() { return count; }
+    public int maxPlayers() { return maxPlayers; }
+    public int window() { return window; }
+}
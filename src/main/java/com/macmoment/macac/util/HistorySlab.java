@@ -0,0 +1,332 @@
+package com.macmoment.macac.util;
+
+import java.util.UUID;
+
+/**
+ * Handle to a native player history slab.
+ * 
+ * <p>A slab keeps the metric windows of every tracked player in a single
+ * contiguous, cache-line aligned native arena (one slot per player, one
+ * column per metric). Players acquire a slot on join and release it on quit;
+ * released slots are recycled through a free-list, so player churn does not
+ * cause native allocations.
+ * 
+ * <p>Slot ids are generation-tagged: once a slot is released, any copy of its
+ * old id is ignored by the native side, even if the slot has been reused.
+ * 
+ * <p>A slab opened with {@link #openMapped(String, int, int, int)} keeps its
+ * arena in a memory-mapped history file. Pushes write the file in place, so
+ * nothing is serialised on shutdown and nothing is parsed on startup: slots
+ * that were in use come back <em>dormant</em> and are handed back, windows
+ * intact, when {@link #acquire(UUID)} is called for the same player.
+ * {@link #park(long)} does the same for a player who leaves while the
+ * server keeps running.
+ * 
+ * <p>Windows are stored as doubles by default. {@link #STORAGE_F32} halves
+ * and {@link #STORAGE_Q16} quarters the arena (16-bit samples with one
+ * power-of-two step per window, about 4.5 significant digits); samples are
+ * narrowed on push and every read returns a double.
+ * 
+ * <p>The slab is only available when the native library is loaded; use
+ * {@link #create(int, int, int)} which returns null otherwise.
+ * 
+ * <p><strong>Thread Safety:</strong> {@link #acquire()}, {@link #release(long)},
+ * {@link #park(long)} and {@link #sync(boolean)} are thread-safe. Pushes to a
+ * given slot must come from a single writer.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class HistorySlab implements AutoCloseable {
+    
+    /** Slot id returned when no slot could be acquired. */
+    public static final long NO_SLOT = -1L;
+    
+    /** Windows of 64-bit doubles. */
+    public static final int STORAGE_F64 = 0;
+    
+    /** Windows of 32-bit floats. */
+    public static final int STORAGE_F32 = 1;
+    
+    /** Windows of 16-bit integers with a per-window power-of-two step. */
+    public static final int STORAGE_Q16 = 2;
+    
+    private final int maxSlots;
+    private final int numMetrics;
+    private final int window;
+    private final int storage;
+    private final boolean persistent;
+    private volatile long handle;
+    
+    private HistorySlab(final long handle, final int maxSlots, final int numMetrics, final int window,
+                        final int storage, final boolean persistent) {
+        this.handle = handle;
+        this.maxSlots = maxSlots;
+        this.numMetrics = numMetrics;
+        this.window = window;
+        this.storage = storage;
+        this.persistent = persistent;
+    }
+    
+    /**
+     * Parses a storage name ({@code f64}, {@code f32} or {@code q16}, case
+     * insensitive).
+     * 
+     * @param name storage name
+     * @return storage constant, or {@link #STORAGE_F64} if unrecognised
+     */
+    public static int storageOf(final String name) {
+        if ("f32".equalsIgnoreCase(name)) {
+            return STORAGE_F32;
+        }
+        if ("q16".equalsIgnoreCase(name)) {
+            return STORAGE_Q16;
+        }
+        return STORAGE_F64;
+    }
+    
+    /**
+     * Creates a native slab if the native library is available.
+     * 
+     * @param maxSlots maximum concurrent players; must be positive
+     * @param numMetrics windows per player; must be positive
+     * @param window samples per window; must be positive
+     * @return slab, or null if native is unavailable or allocation failed
+     */
+    public static HistorySlab create(final int maxSlots, final int numMetrics, final int window) {
+        return create(maxSlots, numMetrics, window, STORAGE_F64);
+    }
+    
+    /**
+     * Creates a native slab with the given window storage if the native
+     * library is available.
+     * 
+     * @param maxSlots maximum concurrent players; must be positive
+     * @param numMetrics windows per player; must be positive
+     * @param window samples per window; must be positive
+     * @param storage one of the {@code STORAGE_*} constants
+     * @return slab, or null if native is unavailable or allocation failed
+     */
+    public static HistorySlab create(final int maxSlots, final int numMetrics, final int window,
+                                     final int storage) {
+        if (maxSlots <= 0 || numMetrics <= 0 || window <= 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createHistorySlab(maxSlots, numMetrics, window, storage);
+        return handle != 0 ? new HistorySlab(handle, maxSlots, numMetrics, window, storage, false) : null;
+    }
+    
+    /**
+     * Opens a slab backed by a history file if the native library is available.
+     * 
+     * <p>A file written by a slab of the same geometry is mapped back as-is;
+     * a missing, older or differently sized file is (re)initialised empty.
+     * 
+     * @param path history file path
+     * @param maxSlots maximum concurrent players; must be positive
+     * @param numMetrics windows per player; must be positive
+     * @param window samples per window; must be positive
+     * @return slab, or null if native is unavailable, the file could not be
+     *         mapped, or another process has it open
+     */
+    public static HistorySlab openMapped(final String path, final int maxSlots, final int numMetrics,
+                                         final int window) {
+        return openMapped(path, maxSlots, numMetrics, window, STORAGE_F64);
+    }
+    
+    /**
+     * Opens a slab backed by a history file with the given window storage.
+     * The storage is part of the file's geometry: a file written with
+     * another storage is reinitialised empty.
+     * 
+     * @param path history file path
+     * @param maxSlots maximum concurrent players; must be positive
+     * @param numMetrics windows per player; must be positive
+     * @param window samples per window; must be positive
+     * @param storage one of the {@code STORAGE_*} constants
+     * @return slab, or null if native is unavailable, the file could not be
+     *         mapped, or another process has it open
+     */
+    public static HistorySlab openMapped(final String path, final int maxSlots, final int numMetrics,
+                                         final int window, final int storage) {
+        if (path == null || path.isEmpty() || maxSlots <= 0 || numMetrics <= 0 || window <= 0
+                || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.openHistorySlab(path, maxSlots, numMetrics, window, storage);
+        return handle != 0 ? new HistorySlab(handle, maxSlots, numMetrics, window, storage, true) : null;
+    }
+    
+    /**
+     * Acquires a free slot.
+     * 
+     * @return slot id, or {@link #NO_SLOT} if the slab is full or closed
+     */
+    public long acquire() {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabAcquire(h) : NO_SLOT;
+    }
+    
+    /**
+     * Acquires a slot for a player. If the player has a dormant slot (parked,
+     * or restored from the history file) its windows are handed back intact;
+     * otherwise a free slot is used, evicting the oldest dormant one if needed.
+     * 
+     * @param playerId owning player
+     * @return slot id, or {@link #NO_SLOT} if every slot is in use or the slab is closed
+     */
+    public long acquire(final UUID playerId) {
+        final long h = handle;
+        return h != 0
+            ? NativeHelper.slabAcquireFor(h, playerId.getMostSignificantBits(), playerId.getLeastSignificantBits())
+            : NO_SLOT;
+    }
+    
+    /**
+     * Releases a slot back to the free-list. Stale or invalid ids are ignored.
+     * 
+     * @param slotId slot id from {@link #acquire()}
+     */
+    public void release(final long slotId) {
+        final long h = handle;
+        if (h != 0 && slotId != NO_SLOT) {
+            NativeHelper.slabRelease(h, slotId);
+        }
+    }
+    
+    /**
+     * Deactivates a slot but keeps its windows for the owner's next
+     * {@link #acquire(UUID)}. Stale or invalid ids are ignored.
+     * 
+     * @param slotId slot id from {@link #acquire(UUID)}
+     */
+    public void park(final long slotId) {
+        final long h = handle;
+        if (h != 0 && slotId != NO_SLOT) {
+            NativeHelper.slabPark(h, slotId);
+        }
+    }
+    
+    /**
+     * Writes dirty pages of a persistent slab back to its file. Without
+     * {@code wait} this only queues the write-back and returns at once.
+     * No-op for an in-memory slab.
+     * 
+     * @param wait true to block until the data is on disk
+     * @return true on success
+     */
+    public boolean sync(final boolean wait) {
+        final long h = handle;
+        return h != 0 && NativeHelper.slabSync(h, wait) == 0;
+    }
+    
+    /**
+     * Pushes a value onto one metric window of a slot.
+     * 
+     * @param slotId slot id
+     * @param metric metric column index
+     * @param value value to push
+     */
+    public void push(final long slotId, final int metric, final double value) {
+        final long h = handle;
+        if (h != 0 && slotId != NO_SLOT) {
+            NativeHelper.slabPush(h, slotId, metric, value);
+        }
+    }
+    
+    /**
+     * Returns the value at the specified age (0 = most recent).
+     * 
+     * @param slotId slot id
+     * @param metric metric column index
+     * @param age age of element to retrieve
+     * @return value, or NaN if out of range or the slot is stale
+     */
+    public double get(final long slotId, final int metric, final int age) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabGet(h, slotId, metric, age) : Double.NaN;
+    }
+    
+    /**
+     * Returns the mean of one metric window, computed natively.
+     * 
+     * @param slotId slot id
+     * @param metric metric column index
+     * @return mean, or 0 if empty or the slot is stale
+     */
+    public double mean(final long slotId, final int metric) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabMean(h, slotId, metric) : 0.0;
+    }
+    
+    /**
+     * Returns the sample variance of one metric window, computed natively.
+     * 
+     * @param slotId slot id
+     * @param metric metric column index
+     * @return variance, or 0 if fewer than 2 samples or the slot is stale
+     */
+    public double variance(final long slotId, final int metric) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabVariance(h, slotId, metric) : 0.0;
+    }
+    
+    /**
+     * Returns the current number of samples in one metric window.
+     * 
+     * @param slotId slot id
+     * @param metric metric column index
+     * @return sample count
+     */
+    public int size(final long slotId, final int metric) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabSize(h, slotId, metric) : 0;
+    }
+    
+    /**
+     * Returns the number of acquired slots.
+     * 
+     * @return active slot count
+     */
+    public int activeCount() {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabActiveCount(h) : 0;
+    }
+    
+    /**
+     * Returns the number of dormant slots waiting for their players.
+     * 
+     * @return dormant slot count
+     */
+    public int dormantCount() {
+        final long h = handle;
+        return h != 0 ? NativeHelper.slabDormantCount(h) : 0;
+    }
+    
+    /**
+     * Returns the native handle, for use by native kernels that sweep the slab.
+     * 
+     * @return native handle, or 0 if closed
+     */
+    public long handle() {
+        return handle;
+    }
+    
+    public int maxSlots() { return maxSlots; }
+    public int numMetrics() { return numMetrics; }
+    public int window() { return window; }
+    public int storage() { return storage; }
+    public boolean isPersistent() { return persistent; }
+    
+    /**
+     * Frees the native arena. Subsequent calls are no-ops.
+     */
+    @Override
+    public synchronized void close() {
+        final long h = handle;
+        if (h != 0) {
+            handle = 0;
+            NativeHelper.destroyHistorySlab(h);
+        }
+    }
+}
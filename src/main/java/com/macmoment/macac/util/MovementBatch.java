@@ -0,0 +1,183 @@
+package com.macmoment.macac.util;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Reusable direct-buffer batch for the native one-tick movement prediction.
+ * 
+ * <p>Collects the velocity, observed movement and physics constants of many
+ * players into off-heap columns and steps all of them with a single JNI
+ * crossing via {@link NativeHelper#predictMovementBatch}. Without the native
+ * library the same formula runs in Java; both give bit-identical results.
+ * Buffers are allocated once at construction; filling and predicting a
+ * batch performs no Java allocations.
+ * 
+ * <p><strong>Layout</strong> (native-order doubles, structure-of-arrays).
+ * Column {@code c} of player {@code i} is at {@code c * stride + i}, where
+ * the stride is the capacity rounded up to a multiple of 8 so every column
+ * starts on a 64-byte boundary. Input columns are indexed by the
+ * {@code IN_*} constants, output columns by the {@code OUT_*} constants:
+ * <pre>
+ *   predicted x = vx * friction, predicted z = vz * friction
+ *   predicted y = onGround ? 0 : (vy - gravity) * drag
+ *   drift       = observed - predicted, and its length
+ * </pre>
+ * 
+ * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class MovementBatch {
+    
+    // Input column indices (MACAC_MOVE_* in macac_native.h)
+    public static final int IN_VX = 0;
+    public static final int IN_VY = 1;
+    public static final int IN_VZ = 2;
+    public static final int IN_DX = 3;
+    public static final int IN_DY = 4;
+    public static final int IN_DZ = 5;
+    public static final int IN_GROUND = 6;
+    public static final int IN_FRICTION = 7;
+    public static final int IN_GRAVITY = 8;
+    public static final int IN_DRAG = 9;
+    
+    /** Number of input columns. */
+    public static final int INPUT_COLUMNS = 10;
+    
+    // Output column indices
+    public static final int OUT_PREDICTED_X = 0;
+    public static final int OUT_PREDICTED_Y = 1;
+    public static final int OUT_PREDICTED_Z = 2;
+    public static final int OUT_DRIFT_X = 3;
+    public static final int OUT_DRIFT_Y = 4;
+    public static final int OUT_DRIFT_Z = 5;
+    public static final int OUT_DRIFT = 6;
+    
+    /** Number of output columns. */
+    public static final int OUTPUT_COLUMNS = 7;
+    
+    private final int maxPlayers;
+    private final int stride;
+    private final ByteBuffer input;
+    private final ByteBuffer output;
+    private int count;
+    
+    /**
+     * Creates a batch with room for {@code maxPlayers} players.
+     * 
+     * @param maxPlayers maximum players per batch; must be positive
+     * @throws IllegalArgumentException if maxPlayers is not positive
+     */
+    public MovementBatch(final int maxPlayers) {
+        if (maxPlayers <= 0) {
+            throw new IllegalArgumentException(
+                String.format("maxPlayers must be positive, got: %d", maxPlayers));
+        }
+        this.maxPlayers = maxPlayers;
+        this.stride = (maxPlayers + 7) & ~7;
+        this.input = ByteBuffer.allocateDirect(INPUT_COLUMNS * stride * Double.BYTES)
+            .order(ByteOrder.nativeOrder());
+        this.output = ByteBuffer.allocateDirect(OUTPUT_COLUMNS * stride * Double.BYTES)
+            .order(ByteOrder.nativeOrder());
+        this.count = 0;
+    }
+    
+    /**
+     * Appends one player's step to the batch.
+     * 
+     * @return player index for {@link #result(int, int)}, or -1 if the batch is full
+     */
+    public int add(final double vx, final double vy, final double vz,
+                   final double dx, final double dy, final double dz, final boolean onGround,
+                   final double friction, final double gravity, final double drag) {
+        if (count >= maxPlayers) {
+            return -1;
+        }
+        
+        put(IN_VX, vx);
+        put(IN_VY, vy);
+        put(IN_VZ, vz);
+        put(IN_DX, dx);
+        put(IN_DY, dy);
+        put(IN_DZ, dz);
+        put(IN_GROUND, onGround ? 1.0 : 0.0);
+        put(IN_FRICTION, friction);
+        put(IN_GRAVITY, gravity);
+        put(IN_DRAG, drag);
+        
+        return count++;
+    }
+    
+    /**
+     * Predicts every player added since the last {@link #clear()}.
+     * 
+     * @return true if the native kernel ran; false if the Java loop did
+     */
+    public boolean predict() {
+        if (count == 0) {
+            return true;
+        }
+        if (NativeHelper.isNativeAvailable()
+                && NativeHelper.predictMovementBatch(input, count, stride, output) == count) {
+            return true;
+        }
+        
+        // Same operations in the same order as the kernels
+        for (int i = 0; i < count; i++) {
+            final double friction = read(IN_FRICTION, i);
+            final double px = read(IN_VX, i) * friction;
+            final double pz = read(IN_VZ, i) * friction;
+            final double py = read(IN_GROUND, i) != 0.0
+                ? 0.0
+                : (read(IN_VY, i) - read(IN_GRAVITY, i)) * read(IN_DRAG, i);
+            final double ex = read(IN_DX, i) - px;
+            final double ey = read(IN_DY, i) - py;
+            final double ez = read(IN_DZ, i) - pz;
+            
+            output.putDouble(offset(OUT_PREDICTED_X, i), px);
+            output.putDouble(offset(OUT_PREDICTED_Y, i), py);
+            output.putDouble(offset(OUT_PREDICTED_Z, i), pz);
+            output.putDouble(offset(OUT_DRIFT_X, i), ex);
+            output.putDouble(offset(OUT_DRIFT_Y, i), ey);
+            output.putDouble(offset(OUT_DRIFT_Z, i), ez);
+            output.putDouble(offset(OUT_DRIFT, i), Math.sqrt(ex * ex + ey * ey + ez * ez));
+        }
+        return false;
+    }
+    
+    /**
+     * Returns one output column of a predicted player.
+     * 
+     * @param index player index returned by {@link #add}
+     * @param column one of the {@code OUT_*} constants
+     * @return column value
+     */
+    public double result(final int index, final int column) {
+        return output.getDouble(offset(column, index));
+    }
+    
+    /**
+     * Resets the batch for the next tick. Buffers are retained.
+     */
+    public void clear() {
+        count = 0;
+    }
+    
+    public int size() { return count; }
+    public int maxPlayers() { return maxPlayers; }
+    public int stride() { return stride; }
+    
+    private int offset(final int column, final int index) {
+        return (column * stride + index) * Double.BYTES;
+    }
+    
+    private void put(final int column, final double value) {
+        input.putDouble(offset(column, count), value);
+    }
+    
+    private double read(final int column, final int index) {
+        return input.getDouble(offset(column, index));
+    }
+}
@@ -4,6 +4,7 @@ import java.io.File;
 import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
+import java.nio.ByteBuffer;
 import java.util.logging.Level;
 import java.util.logging.Logger;
 
@@ -17,7 +18,8 @@ import java.util.logging.Logger;
  * <p><strong>Native capabilities when available:</strong>
  * <ul>
  *   <li>High-precision monotonic timing via RDTSCP instruction</li>
- *   <li>SIMD-optimized statistical calculations (AVX2)</li>
+ *   <li>SIMD-optimized statistical calculations (SSE2/AVX2/AVX-512/NEON,
+ *       selected at load time from CPUID)</li>
  *   <li>Native ring buffer for reduced GC pressure</li>
  *   <li>Optimized combat angle calculations</li>
  *   <li>Network communication for external analytics</li>
@@ -114,7 +116,7 @@ public final class NativeHelper {
             System.loadLibrary(LIB_NAME);
             nativeLoaded = true;
             init();
-            LOGGER.info("Native library loaded from system path");
+            LOGGER.info("Native library loaded from system path (SIMD: " + cpuIsaName() + ")");
             return true;
         } catch (final UnsatisfiedLinkError e) {
             LOGGER.fine("Native library not found in system path: " + e.getMessage());
@@ -130,7 +132,7 @@ public final class NativeHelper {
             loadFromResources();
             nativeLoaded = true;
             init();
-            LOGGER.info("Native library loaded from resources");
+            LOGGER.info("Native library loaded from resources (SIMD: " + cpuIsaName() + ")");
             return true;
         } catch (final Exception e) {
             LOGGER.log(Level.FINE, "Failed to load native library from resources", e);
@@ -209,6 +211,21 @@ public final class NativeHelper {
      */
     private static native void init();
     
+    /**
+     * Returns the instruction set of the active SIMD kernels.
+     * 
+     * @return 0 = scalar, 1 = SSE2, 2 = AVX2, 3 = AVX-512, 4 = NEON
+     */
+    public static native int cpuIsa();
+    
+    /**
+     * Returns the name of the active SIMD kernels ("scalar", "sse2",
+     * "avx2", "avx512" or "neon").
+     * 
+     * @return ISA name
+     */
+    public static native String cpuIsaName();
+    
     /**
      * Returns high-precision monotonic time in nanoseconds via RDTSCP.
      * 
@@ -221,6 +238,79 @@ public final class NativeHelper {
      */
     public static native long rdtscp();
     
+    /**
+     * Register a latency timing site, or look up an existing one by name.
+     * @param name Site name (truncated to 47 bytes)
+     * @return Site id, or -1 if the name is empty or the site table is full
+     */
+    public static native int perfRegister(String name);
+    
+    /**
+     * Start timestamp for {@link #perfEnd(int, long)} (TSC ticks).
+     */
+    public static native long perfBegin();
+    
+    /**
+     * Record the time since {@code begin} against a site. Samples go to a
+     * histogram owned by the calling thread; no lock is taken.
+     * @param site Site id from {@link #perfRegister(String)}
+     * @param begin Timestamp from {@link #perfBegin()}
+     */
+    public static native void perfEnd(int site, long begin);
+    
+    /**
+     * Number of registered timing sites; ids are {@code 0..count-1}.
+     */
+    public static native int perfSiteCount();
+    
+    /**
+     * Name of a timing site.
+     * @param site Site id
+     * @return Site name, or null if not registered
+     */
+    public static native String perfSiteName(int site);
+    
+    /**
+     * Latency summary of a site merged across all threads.
+     * @param site Site id
+     * @return [count, mean_ns, p50_ns, p99_ns, p999_ns, max_ns], or null if
+     *         the site is not registered
+     */
+    public static native double[] perfSnapshot(int site);
+    
+    /**
+     * Zero all timing histograms.
+     */
+    public static native void perfReset();
+    
+    /**
+     * Start a hardware counter session (Linux perf events): timing sites
+     * also count cycles, instructions, cache and branch misses until
+     * {@link #pmuStop()}. Clears the previous session's totals.
+     * @return Bitmask of events counted (bit 0 cycles .. bit 5 task clock),
+     *         or 0 if perf events are unavailable
+     */
+    public static native int pmuStart();
+    
+    /**
+     * End the hardware counter session; totals stay readable.
+     */
+    public static native void pmuStop();
+    
+    /**
+     * Whether a hardware counter session runs.
+     */
+    public static native boolean pmuActive();
+    
+    /**
+     * Counter totals of a site merged across all threads.
+     * @param site Site id
+     * @return [scopes, partial, events, cycles, instructions, l1d_misses,
+     *         llc_misses, branch_misses, task_clock_ns], or null if the site
+     *         is not registered
+     */
+    public static native long[] pmuSnapshot(int site);
+    
     /**
      * Create a native ring buffer.
      * @param capacity Buffer capacity
@@ -262,6 +352,288 @@ public final class NativeHelper {
      */
     public static native void ringBufferClear(long handle);
     
+    /**
+     * Create a native ring buffer that maintains running statistics.
+     * Mean, variance, min and max are then O(1) queries; the element
+     * count is {@link #ringBufferSize(long)}.
+     * @param capacity Buffer capacity
+     * @return Handle to native buffer, or 0 on failure
+     */
+    public static native long createTrackedRingBuffer(int capacity);
+    
+    /**
+     * Get mean of native ring buffer window.
+     * O(1) for tracked buffers, O(n) otherwise.
+     * @param handle Buffer handle
+     * @return Mean, or 0 if empty
+     */
+    public static native double ringBufferMean(long handle);
+    
+    /**
+     * Get sample variance of native ring buffer window.
+     * O(1) for tracked buffers, O(n) otherwise.
+     * @param handle Buffer handle
+     * @return Variance, or 0 if fewer than 2 elements
+     */
+    public static native double ringBufferVariance(long handle);
+    
+    /**
+     * Get minimum of native ring buffer window.
+     * O(1) for tracked buffers, O(n) otherwise.
+     * @param handle Buffer handle
+     * @return Minimum, or NaN if empty
+     */
+    public static native double ringBufferMin(long handle);
+    
+    /**
+     * Get maximum of native ring buffer window.
+     * O(1) for tracked buffers, O(n) otherwise.
+     * @param handle Buffer handle
+     * @return Maximum, or NaN if empty
+     */
+    public static native double ringBufferMax(long handle);
+    
+    /**
+     * Create a native player history slab.
+     * @param maxSlots Maximum concurrent players
+     * @param numMetrics Windows per player
+     * @param window Samples per window
+     * @param storage Window element type, one of {@code HistorySlab.STORAGE_*}
+     * @return Handle to native slab, or 0 on failure
+     */
+    public static native long createHistorySlab(int maxSlots, int numMetrics, int window, int storage);
+    
+    /**
+     * Open a player history slab backed by a memory-mapped file.
+     * @param path History file path (created if missing)
+     * @param maxSlots Maximum concurrent players
+     * @param numMetrics Windows per player
+     * @param window Samples per window
+     * @param storage Window element type, one of {@code HistorySlab.STORAGE_*}
+     * @return Handle to native slab, or 0 on failure
+     */
+    public static native long openHistorySlab(String path, int maxSlots, int numMetrics, int window, int storage);
+    
+    /**
+     * Destroy a native player history slab.
+     * @param handle Slab handle from createHistorySlab
+     */
+    public static native void destroyHistorySlab(long handle);
+    
+    /**
+     * Acquire a free slot from the slab.
+     * @param handle Slab handle
+     * @return Generation-tagged slot id, or -1 if full
+     */
+    public static native long slabAcquire(long handle);
+    
+    /**
+     * Acquire a slot for an owner, reclaiming the owner's dormant slot if any.
+     * @param handle Slab handle
+     * @param keyHi High half of the owner key
+     * @param keyLo Low half of the owner key
+     * @return Generation-tagged slot id, or -1 if full
+     */
+    public static native long slabAcquireFor(long handle, long keyHi, long keyLo);
+    
+    /**
+     * Release a slot back to the slab free-list.
+     * @param handle Slab handle
+     * @param slotId Slot id from slabAcquire
+     */
+    public static native void slabRelease(long handle, long slotId);
+    
+    /**
+     * Park a slot, keeping its windows for the owner's next slabAcquireFor.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     */
+    public static native void slabPark(long handle, long slotId);
+    
+    /**
+     * Write back a mapped slab's dirty pages.
+     * @param handle Slab handle
+     * @param wait true to block until written, false to only schedule
+     * @return 0 on success, -1 on error
+     */
+    public static native int slabSync(long handle, boolean wait);
+    
+    /**
+     * Push value to one metric window of a slot.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     * @param metric Metric column index
+     * @param value Value to push
+     */
+    public static native void slabPush(long handle, long slotId, int metric, double value);
+    
+    /**
+     * Get value from one metric window of a slot.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     * @param metric Metric column index
+     * @param age Age (0 = most recent)
+     * @return Value at age, or NaN if out of range or slot is stale
+     */
+    public static native double slabGet(long handle, long slotId, int metric, int age);
+    
+    /**
+     * Get the mean of one metric window of a slot, widened from its storage.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     * @param metric Metric column index
+     * @return Mean, or 0 if empty
+     */
+    public static native double slabMean(long handle, long slotId, int metric);
+    
+    /**
+     * Get the sample variance of one metric window of a slot.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     * @param metric Metric column index
+     * @return Variance, or 0 if fewer than 2 samples
+     */
+    public static native double slabVariance(long handle, long slotId, int metric);
+    
+    /**
+     * Get current size of one metric window of a slot.
+     * @param handle Slab handle
+     * @param slotId Slot id
+     * @param metric Metric column index
+     * @return Current size
+     */
+    public static native int slabSize(long handle, long slotId, int metric);
+    
+    /**
+     * Get number of acquired slots.
+     * @param handle Slab handle
+     * @return Active slot count
+     */
+    public static native int slabActiveCount(long handle);
+    
+    /**
+     * Get number of dormant (parked or restored) slots.
+     * @param handle Slab handle
+     * @return Dormant slot count
+     */
+    public static native int slabDormantCount(long handle);
+    
+    /**
+     * Create a native spatial index over entity positions.
+     * @param maxEntities Maximum entities per update
+     * @param cellSize Grid cell edge in blocks, or 0 for 16 (one chunk section)
+     * @return Handle to native index, or 0 on failure
+     */
+    public static native long createSpatialIndex(int maxEntities, double cellSize);
+    
+    /**
+     * Destroy a native spatial index.
+     * @param handle Index handle from createSpatialIndex
+     */
+    public static native void destroySpatialIndex(long handle);
+    
+    /**
+     * Replace the indexed positions. See {@link SpatialIndex} for the layout.
+     * @param handle Index handle
+     * @param entries Direct native-order buffer of 32-byte {id, x, y, z} entries
+     * @param count Number of entries
+     * @return Entities indexed, or -1 on invalid arguments
+     */
+    public static native int spatialUpdate(long handle, ByteBuffer entries, int count);
+    
+    /**
+     * Answer a batch of radius or look-cone queries. See {@link SpatialIndex}
+     * for the layouts; every buffer must be direct and native-order.
+     * @param handle Index handle
+     * @param queries 64-byte query records
+     * @param count Number of queries
+     * @param cap Result slots per query
+     * @param cone true for look-cone queries, false for radius queries
+     * @param outIds Receives {@code count * cap} longs, nearest first per query
+     * @param outDist Receives {@code count * cap} doubles, or null
+     * @param outCounts Receives {@code count} ints, or null
+     * @return Total results written, or -1 on invalid arguments
+     */
+    public static native int spatialQuery(long handle, ByteBuffer queries, int count, int cap, boolean cone,
+                                          ByteBuffer outIds, ByteBuffer outDist, ByteBuffer outCounts);
+    
+    /**
+     * Get number of indexed entities.
+     * @param handle Index handle
+     * @return Entity count
+     */
+    public static native int spatialSize(long handle);
+    
+    /**
+     * Create a native per-entity position history.
+     * @param maxEntities Maximum tracked entities
+     * @param window Samples kept per entity
+     * @return Handle to native history, or 0 on failure
+     */
+    public static native long createPositionHistory(int maxEntities, int window);
+    
+    /**
+     * Destroy a native position history.
+     * @param handle History handle from createPositionHistory
+     */
+    public static native void destroyPositionHistory(long handle);
+    
+    /**
+     * Append samples. See {@link PositionHistory} for the layout.
+     * @param handle History handle
+     * @param samples Direct native-order buffer of 48-byte samples
+     * @param count Number of samples
+     * @return Samples stored, or -1 on invalid arguments
+     */
+    public static native int positionHistoryRecord(long handle, ByteBuffer samples, int count);
+    
+    /**
+     * Forget an entity.
+     * @param handle History handle
+     * @param id Entity id
+     */
+    public static native void positionHistoryRemove(long handle, long id);
+    
+    /**
+     * Forget entities whose latest sample is older than nanoTime.
+     * @param handle History handle
+     * @param nanoTime Cut-off in {@link #nanoTime()} nanoseconds
+     * @return Entities removed
+     */
+    public static native int positionHistoryPrune(long handle, long nanoTime);
+    
+    /**
+     * Get number of tracked entities.
+     * @param handle History handle
+     * @return Entity count
+     */
+    public static native int positionHistorySize(long handle);
+    
+    /**
+     * Rewind entities to a past time.
+     * @param handle History handle
+     * @param ids Direct native-order buffer of {@code count} longs
+     * @param count Number of ids
+     * @param nanoTime Time to rewind to
+     * @param output Receives {@code count} 48-byte samples (NaN coordinates for unknown ids)
+     * @return Ids found, or -1 on invalid arguments
+     */
+    public static native int positionHistoryRewind(long handle, ByteBuffer ids, int count, long nanoTime,
+                                                   ByteBuffer output);
+    
+    /**
+     * Lag-compensated reach to an entity's bounding box.
+     * @param handle History handle
+     * @param id Entity id
+     * @param nanoTime Time to rewind the entity to
+     * @param eyeX Attacker eye X
+     * @param eyeY Attacker eye Y
+     * @param eyeZ Attacker eye Z
+     * @return Distance in blocks, or NaN if the entity is unknown
+     */
+    public static native double positionHistoryReach(long handle, long id, long nanoTime,
+                                                     double eyeX, double eyeY, double eyeZ);
+    
     /**
      * Calculate sum using SIMD.
      * @param data Array of doubles
@@ -290,6 +662,196 @@ public final class NativeHelper {
      */
     public static native double mad(double[] data);
     
+    /**
+     * Calculate sum over the first {@code count} doubles of a direct buffer,
+     * read in place (no copy).
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @return Sum, or 0 if the buffer is not direct or too small
+     */
+    public static native double simdSumDirect(ByteBuffer buffer, int count);
+    
+    /**
+     * Calculate mean over the first {@code count} doubles of a direct buffer.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @return Mean, or 0 if the buffer is not direct or too small
+     */
+    public static native double simdMeanDirect(ByteBuffer buffer, int count);
+    
+    /**
+     * Calculate sample variance (n - 1) over the first {@code count} doubles
+     * of a direct buffer.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @return Variance, or 0 if fewer than 2 values or the buffer is invalid
+     */
+    public static native double simdVarianceDirect(ByteBuffer buffer, int count);
+    
+    /**
+     * Describe the first {@code count} doubles of a direct buffer in one
+     * pass: {count, sum, mean, variance (n - 1), min, max, skewness, excess
+     * kurtosis}, skewness and kurtosis in their population form.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @param out Receives the eight values; length at least 8
+     * @return 0 on success, -1 if the buffer or {@code out} is invalid
+     */
+    public static native int simdDescribeDirect(ByteBuffer buffer, int count, double[] out);
+    
+    /**
+     * Spectrum and autocorrelation of a rolling window read in place: the
+     * buffer holds a ring of {@code count} doubles whose oldest value is at
+     * index {@code oldest}; the newest power-of-two run (at most 256) is
+     * analysed. Writes {window, entropy, peakPower, peakFrequency,
+     * autocorrPeak, autocorrLag}, all zero on failure.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values in the ring
+     * @param oldest Index of the oldest value
+     * @param out Receives the six values; length at least 6
+     * @return 0 on success, -1 if fewer than 32 values, no spread or invalid arguments
+     */
+    public static native int spectralDirect(ByteBuffer buffer, int count, int oldest, double[] out);
+    
+    /**
+     * Calculate median over the first {@code count} doubles of a direct
+     * buffer. The buffer is not modified.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @return Median, or 0 if the buffer is not direct or too small
+     */
+    public static native double medianDirect(ByteBuffer buffer, int count);
+    
+    /**
+     * Calculate MAD over the first {@code count} doubles of a direct buffer.
+     * The buffer is not modified.
+     * @param buffer Direct buffer in native byte order
+     * @param count Number of values
+     * @return MAD, or 0 if the buffer is not direct or too small
+     */
+    public static native double madDirect(ByteBuffer buffer, int count);
+    
+    /**
+     * Create a native rolling order-statistics window.
+     * Keeps the window ordered so median is O(1) and MAD is O(log^2 n)
+     * per query, with O(log n) pushes and no allocation after creation.
+     * @param window Window length
+     * @return Handle to native window, or 0 on failure
+     */
+    public static native long createOrderStats(int window);
+    
+    /**
+     * Destroy a native rolling order-statistics window.
+     * @param handle Window handle from createOrderStats
+     */
+    public static native void destroyOrderStats(long handle);
+    
+    /**
+     * Push value to native rolling order-statistics window.
+     * @param handle Window handle
+     * @param value Value to push
+     */
+    public static native void orderStatsPush(long handle, double value);
+    
+    /**
+     * Get median of native rolling window.
+     * @param handle Window handle
+     * @return Median, or 0 if empty
+     */
+    public static native double orderStatsMedian(long handle);
+    
+    /**
+     * Get MAD of native rolling window.
+     * @param handle Window handle
+     * @return MAD, or 0 if empty
+     */
+    public static native double orderStatsMad(long handle);
+    
+    /**
+     * Get k-th smallest value of native rolling window.
+     * @param handle Window handle
+     * @param k Rank (0 = smallest)
+     * @return Value, or NaN if out of range
+     */
+    public static native double orderStatsSelect(long handle, int k);
+    
+    /**
+     * Get native rolling window size.
+     * @param handle Window handle
+     * @return Current size
+     */
+    public static native int orderStatsSize(long handle);
+    
+    /**
+     * Clear native rolling order-statistics window.
+     * @param handle Window handle
+     */
+    public static native void orderStatsClear(long handle);
+    
+    /**
+     * Create a native population baseline: per-thread t-digest shards of a
+     * few metrics, merged into a queryable snapshot on refresh.
+     * @param metrics Number of metrics (1 to 16)
+     * @param compression t-digest compression (0 = default 200)
+     * @param windowMs Samples are retired after one to two windows (0 = never)
+     * @return Handle to native population, or 0 on failure
+     */
+    public static native long createPopulation(int metrics, int compression, long windowMs);
+    
+    /**
+     * Destroy a native population baseline.
+     * @param handle Population handle from createPopulation
+     */
+    public static native void destroyPopulation(long handle);
+    
+    /**
+     * Add one sample of a metric. Non-finite values are ignored.
+     * @param handle Population handle
+     * @param metric Metric index
+     * @param value Sample
+     */
+    public static native void populationAdd(long handle, int metric, double value);
+    
+    /**
+     * Add one sample of every metric under a single shard lock.
+     * Non-finite entries are skipped.
+     * @param handle Population handle
+     * @param values One sample per metric, indexed by metric
+     */
+    public static native void populationAddRow(long handle, double[] values);
+    
+    /**
+     * Merge every thread's shard into the snapshot that queries read.
+     * @param handle Population handle
+     */
+    public static native void populationRefresh(long handle);
+    
+    /**
+     * Get a quantile of a metric from the last snapshot.
+     * @param handle Population handle
+     * @param metric Metric index
+     * @param q Quantile in [0, 1]
+     * @return Value, or NaN if the metric has no samples
+     */
+    public static native double populationQuantile(long handle, int metric, double q);
+    
+    /**
+     * Get the fraction of a metric's samples at or below a value.
+     * @param handle Population handle
+     * @param metric Metric index
+     * @param x Value
+     * @return Fraction in [0, 1], or NaN if the metric has no samples
+     */
+    public static native double populationCdf(long handle, int metric, double x);
+    
+    /**
+     * Get the number of samples of a metric the last snapshot covers.
+     * @param handle Population handle
+     * @param metric Metric index
+     * @return Sample count
+     */
+    public static native long populationCount(long handle, int metric);
+    
     /**
      * Connect to analytics server.
      * @param host Server hostname
@@ -324,6 +886,196 @@ public final class NativeHelper {
      */
     public static native boolean netIsConnected(long handle);
     
+    /**
+     * Create an async sender with its own I/O thread.
+     * Violations are queued into a bounded lock-free queue and written by
+     * the I/O thread, which reconnects with exponential backoff.
+     * @param host Server hostname
+     * @param port Server port
+     * @param queueCapacity Maximum queued records (rounded up to a power of two)
+     * @param connectTimeoutMs Connection timeout in milliseconds
+     * @param reconnectDelayMs Initial reconnect backoff in milliseconds
+     * @param protocol Wire protocol code (see {@code WireProtocol#code()})
+     * @return Sender handle, or 0 on failure
+     */
+    public static native long senderCreate(String host, int port, int queueCapacity,
+                                           int connectTimeoutMs, int reconnectDelayMs, int protocol);
+    
+    /**
+     * Create an async sender over a pool of collector endpoints, one
+     * connection each. Violations are sharded by player UUID; records for a
+     * disconnected or stalled endpoint fail over to the next healthy one.
+     * @param endpoints Comma-separated "host", "host:port" or "[v6]:port" entries
+     * @param defaultPort Port for entries without one
+     * @param queueCapacity Maximum queued records (rounded up to a power of two)
+     * @param connectTimeoutMs Connection timeout, also the write-stall limit, in milliseconds
+     * @param reconnectDelayMs Initial reconnect backoff in milliseconds
+     * @param protocol Wire protocol code (see {@code WireProtocol#code()})
+     * @return Sender handle, or 0 if the list is invalid or creation failed
+     */
+    public static native long senderCreatePool(String endpoints, int defaultPort, int queueCapacity,
+                                               int connectTimeoutMs, int reconnectDelayMs, int protocol);
+    
+    /**
+     * Create an async sender over a pool of collector endpoints that
+     * spills to a segmented on-disk log instead of dropping reports while
+     * no collector is reachable or the queue is above its high-water mark.
+     * The log is replayed in order once a collector accepts again, and
+     * records left in it by an earlier run are replayed as well.
+     * @param endpoints Comma-separated "host", "host:port" or "[v6]:port" entries
+     * @param defaultPort Port for entries without one
+     * @param queueCapacity Maximum queued records (rounded up to a power of two)
+     * @param connectTimeoutMs Connection timeout, also the write-stall limit, in milliseconds
+     * @param reconnectDelayMs Initial reconnect backoff in milliseconds
+     * @param protocol Wire protocol code (see {@code WireProtocol#code()})
+     * @param directory Spill directory (one sender at a time)
+     * @param segmentBytes Size of each segment file (0 = native default)
+     * @param maxBytes Disk budget over all segments (0 = native default)
+     * @param highWater Queue depth that spills while connected (0 = 3/4 of the queue)
+     * @return Sender handle, or 0 if the list is invalid, the directory is
+     *         unusable or creation failed
+     */
+    public static native long senderCreateSpill(String endpoints, int defaultPort, int queueCapacity,
+                                                int connectTimeoutMs, int reconnectDelayMs, int protocol,
+                                                String directory, long segmentBytes, long maxBytes,
+                                                int highWater);
+    
+    /**
+     * Flush (bounded) and destroy an async sender.
+     * @param handle Sender handle
+     */
+    public static native void senderDestroy(long handle);
+    
+    /**
+     * Queue a violation for sending. Never blocks and does not allocate.
+     * @param handle Sender handle
+     * @return 0 if queued, -1 if dropped
+     */
+    public static native int senderSendViolation(long handle, String playerUuid, String category,
+                                                 double confidence, double severity, long timestamp);
+    
+    /**
+     * Wait until all queued violations have been written.
+     * @param handle Sender handle
+     * @param timeoutMs Maximum wait in milliseconds
+     * @return true if fully flushed
+     */
+    public static native boolean senderFlush(long handle, int timeoutMs);
+    
+    /**
+     * Get number of violations queued or in flight.
+     * @param handle Sender handle
+     * @return Queue depth
+     */
+    public static native int senderQueueDepth(long handle);
+    
+    /**
+     * Get number of violations dropped (queue full, oversized, shutdown).
+     * @param handle Sender handle
+     * @return Drop count
+     */
+    public static native long senderDroppedCount(long handle);
+    
+    /**
+     * Get number of violations fully written to the socket.
+     * @param handle Sender handle
+     * @return Sent count
+     */
+    public static native long senderSentCount(long handle);
+    
+    /**
+     * Check if async sender is connected.
+     * @param handle Sender handle
+     * @return true if connected
+     */
+    public static native boolean senderIsConnected(long handle);
+    
+    /**
+     * Get the binary wire protocol version negotiated on the current connection.
+     * @param handle Sender handle
+     * @return Negotiated version, or 0 if not connected or using JSON
+     */
+    public static native int senderProtocolVersion(long handle);
+    
+    /**
+     * Get number of violations written to an endpoint other than their shard's.
+     * @param handle Sender handle
+     * @return Failover count
+     */
+    public static native long senderFailoverCount(long handle);
+    
+    /**
+     * Get one endpoint's counters.
+     * @param handle Sender handle
+     * @param index Endpoint index, in configuration order
+     * @return {state, sent, reconnects, backlog, protocolVersion}, or null if out of range
+     */
+    public static native long[] senderEndpointStats(long handle, int index);
+    
+    /**
+     * Get a sender's spill counters.
+     * @param handle Sender handle
+     * @return {spilled, replayed, depth}: records written to the spill log,
+     *         read back from it, and still waiting in it
+     */
+    public static native long[] senderSpillStats(long handle);
+    
+    /**
+     * Create a coalescer that merges violations of one player and category
+     * into summary records before they reach an async sender.
+     * @param senderHandle Sender handle; must outlive the coalescer
+     * @param maxRecords Most records open at once (fixed memory)
+     * @param windowMs How long a record collects violations before it is sent
+     * @param flushCount Violations that send a record early (0 = no limit)
+     * @return Coalescer handle, or 0 on failure
+     */
+    public static native long coalescerCreate(long senderHandle, int maxRecords, int windowMs, int flushCount);
+    
+    /**
+     * Send every open record and destroy a coalescer.
+     * @param handle Coalescer handle
+     */
+    public static native void coalescerDestroy(long handle);
+    
+    /**
+     * Add a violation. Never blocks on I/O and does not allocate.
+     * @param handle Coalescer handle
+     * @return 0 if merged or queued, -1 if dropped
+     */
+    public static native int coalescerAdd(long handle, String playerUuid, String category,
+                                          double confidence, double severity, long timestamp);
+    
+    /**
+     * Send every open record now.
+     * @param handle Coalescer handle
+     * @return Records sent
+     */
+    public static native int coalescerFlush(long handle);
+    
+    /**
+     * Get a coalescer's counters.
+     * @param handle Coalescer handle
+     * @return {accepted, merged, summaries, singles, passthrough, rejected, open}
+     */
+    public static native long[] coalescerStats(long handle);
+    
+    /**
+     * Advance {@code count} players one physics tick and measure how far
+     * each one's observed movement drifted from the prediction. Every ISA
+     * rounds exactly like the formula in plain Java doubles; see
+     * {@link MovementBatch}, which owns the layout.
+     * 
+     * @param input {@link MovementBatch#INPUT_COLUMNS} double columns,
+     *        {@code stride} entries apart
+     * @param count Number of players
+     * @param stride Column spacing in doubles, at least {@code count}
+     * @param output Receives {@link MovementBatch#OUTPUT_COLUMNS} double
+     *        columns with the same stride
+     * @return Number of players written, or -1 on invalid arguments
+     */
+    public static native int predictMovementBatch(ByteBuffer input, int count, int stride,
+                                                  ByteBuffer output);
+    
     // ========================================================================
     // Java Fallback Implementations
     // ========================================================================
@@ -441,12 +1193,225 @@ public final class NativeHelper {
      * @param attackIntervals Array of attack intervals in ms
      * @param hits Array of hit flags (1.0 = hit, 0.0 = miss)
      * @return Analysis result array [aimbot_conf, reach_conf, autoclicker_conf, combined_conf,
-     *         avg_aim_error, aim_variance, avg_snap, avg_reach, hit_rate, avg_interval]
+     *         avg_aim_error, aim_variance, avg_snap, avg_reach, hit_rate, avg_interval,
+     *         interval_spectral_entropy, interval_spectral_peak, interval_autocorr]
      */
     public static native double[] analyzeCombat(double[] aimErrors, double[] snapAngles,
                                                 double[] reaches, double[] attackIntervals,
                                                 double[] hits);
     
+    /**
+     * Analyze combat data for many players in a single JNI call.
+     * 
+     * <p>Both buffers must be direct and in {@link java.nio.ByteOrder#nativeOrder()}.
+     * See {@link CombatBatch} for the packed layout and a reusable wrapper.
+     * 
+     * @param input Packed player-major records of {@code 4 + 5 * window} doubles each
+     * @param playerCount Number of player records in input
+     * @param window Column length per record
+     * @param output Receives {@code playerCount * 13} doubles in the same order
+     *        as {@link #analyzeCombat}
+     * @return Number of records written, or -1 on invalid arguments
+     */
+    public static native int analyzeCombatBatch(ByteBuffer input, int playerCount,
+                                                int window, ByteBuffer output);
+    
+    /**
+     * Calculate many single-precision 3D distances in one JNI call.
+     * 
+     * <p>Both buffers must be direct and in {@link java.nio.ByteOrder#nativeOrder()}.
+     * Keep them 64-byte aligned (and {@code count} a multiple of 16) so every
+     * column gets aligned vector loads.
+     * 
+     * @param input Six float columns of {@code count} entries each:
+     *        attacker x, y, z then target x, y, z
+     * @param count Number of distances
+     * @param output Receives {@code count} floats
+     * @return Number of distances written, or -1 on invalid arguments
+     */
+    public static native int batchDistance3DF32(ByteBuffer input, int count, ByteBuffer output);
+    
+    /**
+     * Score many candidate targets against the attacker's current aim in
+     * one JNI call.
+     * 
+     * <p>Angles use a polynomial atan2 accurate to
+     * {@code MACAC_ATAN2_MAX_ERROR_DEG} (1e-6 degrees) of
+     * {@link Math#atan2}. Buffers must be direct and in
+     * {@link java.nio.ByteOrder#nativeOrder()}.
+     * 
+     * @param attackerX Attacker feet X
+     * @param attackerY Attacker feet Y (eye height is added natively)
+     * @param attackerZ Attacker feet Z
+     * @param yaw Attacker's actual yaw in degrees
+     * @param pitch Attacker's actual pitch in degrees
+     * @param targets Three double columns of {@code count} entries: x, y, z
+     * @param count Number of targets
+     * @param output Receives three double columns (expected yaw, expected
+     *        pitch, aim error), or null to only find the best target
+     * @return Index of the target with the smallest aim error, or -1 if none
+     *         or on invalid arguments
+     */
+    public static native int batchAimError(double attackerX, double attackerY, double attackerZ,
+                                           double yaw, double pitch, ByteBuffer targets,
+                                           int count, ByteBuffer output);
+    
+    /** Column index of aim errors in a combat accumulator. */
+    public static final int COMBAT_AIM_ERROR = 0;
+    /** Column index of snap angles in a combat accumulator. */
+    public static final int COMBAT_SNAP_ANGLE = 1;
+    /** Column index of reach distances in a combat accumulator. */
+    public static final int COMBAT_REACH = 2;
+    /** Column index of attack intervals (ms) in a combat accumulator. */
+    public static final int COMBAT_ATTACK_INTERVAL = 3;
+    /** Column index of hit flags (1.0 = hit) in a combat accumulator. */
+    public static final int COMBAT_HIT = 4;
+    
+    /**
+     * Create an incremental combat accumulator. Each column keeps running
+     * statistics over its last {@code window} samples, so analysis costs
+     * O(1) per call instead of rescanning the window.
+     * @param window Samples kept per column
+     * @return Handle to native accumulator, or 0 on failure
+     */
+    public static native long createCombatAccum(int window);
+    
+    /**
+     * Destroy a combat accumulator.
+     * @param handle Accumulator handle
+     */
+    public static native void destroyCombatAccum(long handle);
+    
+    /**
+     * Push one sample into a column.
+     * @param handle Accumulator handle
+     * @param column One of the {@code COMBAT_*} column indices
+     * @param value Sample value
+     */
+    public static native void combatAccumPush(long handle, int column, double value);
+    
+    /**
+     * Clear all columns of a combat accumulator.
+     * @param handle Accumulator handle
+     */
+    public static native void combatAccumClear(long handle);
+    
+    /**
+     * Score the accumulated window. Output is all zero while any column
+     * holds fewer than 5 samples.
+     * @param handle Accumulator handle
+     * @param output Direct buffer in native order receiving 13 doubles in
+     *        the same order as {@link #analyzeCombat}
+     * @return 1 on success, or -1 on invalid arguments
+     */
+    public static native int combatAccumAnalyze(long handle, ByteBuffer output);
+    
+    /** Packet queue mode: one producer thread, one consumer thread. */
+    public static final int QUEUE_SPSC = 0;
+    /** Packet queue mode: any number of producer threads, one consumer thread. */
+    public static final int QUEUE_MPSC = 1;
+    
+    /**
+     * Create a lock-free telemetry queue.
+     * @param capacity Minimum record capacity (rounded up to a power of two)
+     * @param mode {@link #QUEUE_SPSC} or {@link #QUEUE_MPSC}
+     * @return Handle to native queue, or 0 on failure
+     */
+    public static native long createPacketQueue(int capacity, int mode);
+    
+    /**
+     * Destroy a telemetry queue. No thread may be pushing or draining.
+     * @param handle Queue handle
+     */
+    public static native void destroyPacketQueue(long handle);
+    
+    /**
+     * Queue one movement sample without blocking or allocating.
+     * @param handle Queue handle
+     * @param player Ingestor-assigned player id
+     * @param flags {@code PacketQueue.FLAG_*} bits
+     * @return 0 if queued, or -1 if the queue was full and the sample dropped
+     */
+    public static native int packetQueuePush(long handle, int player, int flags,
+                                             double dx, double dy, double dz,
+                                             float yaw, float pitch,
+                                             float deltaYaw, float deltaPitch,
+                                             int ping, long nanoTime, long tickDelta);
+    
+    /**
+     * Move up to {@code max} queued records, oldest first, into a buffer.
+     * Must only be called from one thread at a time.
+     * @param handle Queue handle
+     * @param output Direct buffer in native order with room for {@code max}
+     *        records of {@code PacketQueue.RECORD_BYTES} bytes
+     * @param max Maximum records to drain
+     * @return Records written, or -1 on invalid arguments
+     */
+    public static native int packetQueueDrain(long handle, ByteBuffer output, int max);
+    
+    /**
+     * Approximate number of queued records.
+     * @param handle Queue handle
+     */
+    public static native int packetQueueSize(long handle);
+    
+    /**
+     * Records dropped because the queue was full.
+     * @param handle Queue handle
+     */
+    public static native long packetQueueDropped(long handle);
+    
+    /**
+     * Start a telemetry capture writing {@code <prefix>-<unix secs>-NNNN.mcap}.
+     * @param prefix Path prefix of the capture files
+     * @param capacity Minimum queued record capacity (rounded up to a power of two)
+     * @param maxFileBytes Size at which to rotate to the next file
+     * @param maxFiles Files to keep, oldest deleted first; 0 keeps all
+     * @return Handle to native capture, or 0 if the first file cannot be created
+     */
+    public static native long captureOpen(String prefix, int capacity, long maxFileBytes, int maxFiles);
+    
+    /**
+     * Flush queued records and stop a capture. No thread may be recording.
+     * @param handle Capture handle
+     */
+    public static native void captureClose(long handle);
+    
+    /**
+     * Queue one movement sample for capture without blocking or allocating.
+     * @param handle Capture handle
+     * @param playerHi Most significant bits of the player UUID
+     * @param playerLo Least significant bits of the player UUID
+     * @param flags {@code PacketQueue.FLAG_*} bits
+     * @return 0 if queued, or -1 if the capture was full and the sample dropped
+     */
+    public static native int captureTelemetry(long handle, long playerHi, long playerLo, int flags,
+                                              double dx, double dy, double dz,
+                                              float yaw, float pitch,
+                                              float deltaYaw, float deltaPitch,
+                                              int ping, long nanoTime, long tickDelta);
+    
+    /**
+     * Queue one attack for capture without blocking or allocating.
+     * @param handle Capture handle
+     * @param flags {@code TelemetryCapture.COMBAT_*} bits
+     * @return 0 if queued, or -1 if the capture was full and the attack dropped
+     */
+    public static native int captureCombat(long handle, long playerHi, long playerLo,
+                                           long targetHi, long targetLo, int flags,
+                                           double targetX, double targetY, double targetZ,
+                                           double attackerX, double attackerY, double attackerZ,
+                                           double damage, float yaw, float pitch,
+                                           float preYaw, float prePitch,
+                                           int ping, long nanoTime, long timeSinceLast);
+    
+    /**
+     * Capture counters.
+     * @param handle Capture handle
+     * @return {records, dropped, bytes, files, errors}, or null if the handle is invalid
+     */
+    public static native long[] captureStats(long handle);
+    
     // ========================================================================
     // Combat Analysis Fallback Methods
     // ========================================================================
@@ -0,0 +1,236 @@
+package com.macmoment.macac.util;
+
+import com.macmoment.macac.model.TelemetryInput;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.concurrent.locks.ReadWriteLock;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
+
+/**
+ * Handle to a native lock-free queue of fixed-size telemetry records.
+ * 
+ * <p>Packet threads {@link #offer offer} movement samples as scalars, so the
+ * hand-off allocates nothing and shares only a read lock held against
+ * {@link #close()}; the analysis thread {@link #drain() drains} them in
+ * batches into a reused direct buffer and reads each record back with
+ * {@link #player(int)} / {@link #input(int)}.
+ * 
+ * <p>The queue is bounded: when it is full, {@link #offer offer} drops the
+ * sample and {@link #dropped()} counts it.
+ * 
+ * <p><strong>Thread Safety:</strong> {@link #offer offer} may be called from
+ * any number of threads on an {@link NativeHelper#QUEUE_MPSC} queue and from
+ * one thread at a time on an {@link NativeHelper#QUEUE_SPSC} queue.
+ * {@link #drain()} and the record accessors belong to a single consumer
+ * thread. {@link #close()} may race with either side: it waits for calls
+ * already inside the native queue, and later calls see the queue closed.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class PacketQueue implements AutoCloseable {
+    
+    /** Size of one native record ({@code macac_telemetry_record_t}). */
+    public static final int RECORD_BYTES = 72;
+    
+    /** Record flag: player reports being on ground. */
+    public static final int FLAG_ON_GROUND = 1;
+    /** Record flag: player is in a vehicle. */
+    public static final int FLAG_IN_VEHICLE = 1 << 1;
+    /** Record flag: player is teleporting. */
+    public static final int FLAG_TELEPORTING = 1 << 2;
+    /** Record flag: player is swimming. */
+    public static final int FLAG_SWIMMING = 1 << 3;
+    /** Record flag: player is gliding. */
+    public static final int FLAG_GLIDING = 1 << 4;
+    /** Record flag: player is climbing. */
+    public static final int FLAG_CLIMBING = 1 << 5;
+    
+    // Field offsets within a record
+    private static final int OFF_DX = 0;
+    private static final int OFF_DY = 8;
+    private static final int OFF_DZ = 16;
+    private static final int OFF_YAW = 24;
+    private static final int OFF_PITCH = 28;
+    private static final int OFF_DELTA_YAW = 32;
+    private static final int OFF_DELTA_PITCH = 36;
+    private static final int OFF_NANO_TIME = 40;
+    private static final int OFF_TICK_DELTA = 48;
+    private static final int OFF_PING = 56;
+    private static final int OFF_PLAYER = 60;
+    private static final int OFF_FLAGS = 64;
+    
+    private final int batchSize;
+    private final ByteBuffer batch;
+    
+    // Guarded by handleLock so close() cannot free the queue under a call
+    private final ReadWriteLock handleLock;
+    private long handle;
+    
+    private PacketQueue(final long handle, final int batchSize) {
+        this.handleLock = new ReentrantReadWriteLock();
+        this.handle = handle;
+        this.batchSize = batchSize;
+        this.batch = ByteBuffer.allocateDirect(batchSize * RECORD_BYTES)
+            .order(ByteOrder.nativeOrder());
+    }
+    
+    /**
+     * Creates a native queue if the native library is available.
+     * 
+     * @param capacity minimum number of queued records (rounded up to a power of two)
+     * @param mode {@link NativeHelper#QUEUE_SPSC} or {@link NativeHelper#QUEUE_MPSC}
+     * @param batchSize maximum records moved per {@link #drain()}
+     * @return queue, or null if native is unavailable or arguments are invalid
+     */
+    public static PacketQueue create(final int capacity, final int mode, final int batchSize) {
+        if (capacity <= 0 || batchSize <= 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createPacketQueue(capacity, mode);
+        return handle != 0 ? new PacketQueue(handle, batchSize) : null;
+    }
+    
+    /**
+     * Packs state booleans into record flags.
+     */
+    public static int flags(final boolean onGround, final boolean inVehicle, final boolean teleporting,
+                            final boolean swimming, final boolean gliding, final boolean climbing) {
+        return (onGround ? FLAG_ON_GROUND : 0)
+            | (inVehicle ? FLAG_IN_VEHICLE : 0)
+            | (teleporting ? FLAG_TELEPORTING : 0)
+            | (swimming ? FLAG_SWIMMING : 0)
+            | (gliding ? FLAG_GLIDING : 0)
+            | (climbing ? FLAG_CLIMBING : 0);
+    }
+    
+    /**
+     * Queues one movement sample. Never blocks, except behind a concurrent
+     * {@link #close()}.
+     * 
+     * @param player caller-assigned player id, returned by {@link #player(int)}
+     * @param flags {@code FLAG_*} bits, see {@link #flags}
+     * @return true if queued; false if the queue was full or closed
+     */
+    public boolean offer(final int player, final int flags,
+                         final double dx, final double dy, final double dz,
+                         final float yaw, final float pitch,
+                         final float deltaYaw, final float deltaPitch,
+                         final long ping, final long nanoTime, final long tickDelta) {
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            return h != 0 && NativeHelper.packetQueuePush(h, player, flags, dx, dy, dz,
+                yaw, pitch, deltaYaw, deltaPitch, (int) Math.min(ping, Integer.MAX_VALUE),
+                nanoTime, tickDelta) == 0;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Moves up to {@code batchSize} records, oldest first, into the batch
+     * buffer, replacing the previous batch.
+     * 
+     * @return number of records drained; 0 if empty or closed
+     */
+    public int drain() {
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            if (h == 0) {
+                return 0;
+            }
+            final int count = NativeHelper.packetQueueDrain(h, batch, batchSize);
+            return Math.max(count, 0);
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Returns the player id of a drained record.
+     * 
+     * @param index record index below the last {@link #drain()} count
+     */
+    public int player(final int index) {
+        return batch.getInt(index * RECORD_BYTES + OFF_PLAYER);
+    }
+    
+    /**
+     * Rebuilds a drained record as telemetry.
+     * 
+     * @param index record index below the last {@link #drain()} count
+     * @return telemetry input
+     */
+    public TelemetryInput input(final int index) {
+        final int base = index * RECORD_BYTES;
+        final int flags = batch.getInt(base + OFF_FLAGS);
+        return new TelemetryInput(
+            batch.getDouble(base + OFF_DX),
+            batch.getDouble(base + OFF_DY),
+            batch.getDouble(base + OFF_DZ),
+            batch.getFloat(base + OFF_YAW),
+            batch.getFloat(base + OFF_PITCH),
+            batch.getFloat(base + OFF_DELTA_YAW),
+            batch.getFloat(base + OFF_DELTA_PITCH),
+            (flags & FLAG_ON_GROUND) != 0,
+            (flags & FLAG_IN_VEHICLE) != 0,
+            (flags & FLAG_TELEPORTING) != 0,
+            (flags & FLAG_SWIMMING) != 0,
+            (flags & FLAG_GLIDING) != 0,
+            (flags & FLAG_CLIMBING) != 0,
+            batch.getInt(base + OFF_PING),
+            batch.getLong(base + OFF_NANO_TIME),
+            batch.getLong(base + OFF_TICK_DELTA)
+        );
+    }
+    
+    /**
+     * Approximate number of queued records.
+     */
+    public int size() {
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            return h != 0 ? NativeHelper.packetQueueSize(h) : 0;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Number of samples dropped because the queue was full.
+     */
+    public long dropped() {
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            return h != 0 ? NativeHelper.packetQueueDropped(h) : 0L;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    public int batchSize() { return batchSize; }
+    
+    /**
+     * Frees the native queue once calls in progress have returned; records
+     * still queued are discarded. Subsequent calls are no-ops.
+     */
+    @Override
+    public void close() {
+        final long h;
+        handleLock.writeLock().lock();
+        try {
+            h = handle;
+            handle = 0;
+        } finally {
+            handleLock.writeLock().unlock();
+        }
+        if (h != 0) {
+            NativeHelper.destroyPacketQueue(h);
+        }
+    }
+}
@@ -0,0 +1,170 @@
+package com.macmoment.macac.util;
+
+import com.macmoment.macac.model.Features;
+
+/**
+ * Handle to a native, server-wide distribution of movement features.
+ * 
+ * <p>Checks normally judge a player against fixed constants or against
+ * the player's own history. A baseline lets them ask where a player stands
+ * among everyone online instead, e.g. "timing skew above the server's
+ * p99.9". Every analysis thread records into its own native t-digest, so
+ * recording never contends; {@link #refresh()} merges them into the
+ * snapshot that {@link #quantile} and {@link #cdf} read in O(log k),
+ * independent of player count.
+ * 
+ * <p>Usage: {@link #record(Features)} once per analysed movement, and
+ * {@link #refresh()} periodically off the main thread (about once a
+ * second). Queries see the last refresh. With a window, samples are
+ * retired after one to two windows, so the baseline follows the players
+ * currently online.
+ * 
+ * <p>The baseline is only available when the native library is loaded;
+ * use {@link #create(int, long, long)} which returns null otherwise.
+ * 
+ * <p><strong>Thread Safety:</strong> Recording and queries are
+ * thread-safe. {@link #close()} must not run while other threads may
+ * still record or query.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class PopulationBaseline implements AutoCloseable {
+    
+    /** Horizontal speed, blocks per tick ({@link Features#horizSpeed()}). */
+    public static final int HORIZ_SPEED = 0;
+    
+    /** Rotation speed, degrees per tick ({@link Features#rotationSpeed()}). */
+    public static final int ROTATION_SPEED = 1;
+    
+    /** Movement jitter ({@link Features#jitterScore()}). */
+    public static final int JITTER = 2;
+    
+    /** Relative packet timing skew ({@link Features#timingSkew()}). */
+    public static final int TIMING_SKEW = 3;
+    
+    /** Number of metrics. */
+    public static final int METRICS = 4;
+    
+    // One reusable row per recording thread
+    private final ThreadLocal<double[]> rows = ThreadLocal.withInitial(() -> new double[METRICS]);
+    private final long minSamples;
+    private volatile long[] counts = new long[METRICS];
+    private volatile long handle;
+    
+    private PopulationBaseline(final long handle, final long minSamples) {
+        this.handle = handle;
+        this.minSamples = minSamples;
+    }
+    
+    /**
+     * Creates a native baseline if the native library is available.
+     * 
+     * @param compression t-digest compression (0 = native default); larger is more accurate
+     * @param windowMs how long samples count, between one and two windows (0 = forever)
+     * @param minSamples samples a metric needs before {@link #isReady(int)}
+     * @return baseline, or null if native is unavailable or allocation failed
+     */
+    public static PopulationBaseline create(final int compression, final long windowMs, final long minSamples) {
+        if (compression < 0 || windowMs < 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createPopulation(METRICS, compression, windowMs);
+        return handle != 0 ? new PopulationBaseline(handle, Math.max(1, minSamples)) : null;
+    }
+    
+    /**
+     * Records one movement's features, one sample per metric.
+     * 
+     * @param features extracted features
+     */
+    public void record(final Features features) {
+        final long h = handle;
+        if (h == 0) {
+            return;
+        }
+        final double[] row = rows.get();
+        row[HORIZ_SPEED] = features.horizSpeed();
+        row[ROTATION_SPEED] = features.rotationSpeed();
+        row[JITTER] = features.jitterScore();
+        row[TIMING_SKEW] = features.timingSkew();
+        NativeHelper.populationAddRow(h, row);
+    }
+    
+    /**
+     * Merges every thread's samples into the snapshot queries read and
+     * retires samples that have aged out. Costs a few milliseconds at most;
+     * keep it off the main thread.
+     */
+    public synchronized void refresh() {
+        final long h = handle;
+        if (h == 0) {
+            return;
+        }
+        NativeHelper.populationRefresh(h);
+        final long[] next = new long[METRICS];
+        for (int metric = 0; metric < METRICS; metric++) {
+            next[metric] = NativeHelper.populationCount(h, metric);
+        }
+        counts = next;
+    }
+    
+    /**
+     * Returns whether a metric had enough samples at the last refresh to
+     * judge players against.
+     * 
+     * @param metric metric index
+     * @return true if at least the configured minimum samples were covered
+     */
+    public boolean isReady(final int metric) {
+        return count(metric) >= minSamples;
+    }
+    
+    /**
+     * Returns the samples of a metric the last refresh covered.
+     * 
+     * @param metric metric index
+     * @return sample count, or 0 for an unknown metric
+     */
+    public long count(final int metric) {
+        return metric >= 0 && metric < METRICS ? counts[metric] : 0L;
+    }
+    
+    /**
+     * Returns the value at a quantile of a metric.
+     * 
+     * @param metric metric index
+     * @param q quantile in [0, 1]
+     * @return value, or NaN if the metric has no samples
+     */
+    public double quantile(final int metric, final double q) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.populationQuantile(h, metric, q) : Double.NaN;
+    }
+    
+    /**
+     * Returns the fraction of a metric's samples at or below a value.
+     * 
+     * @param metric metric index
+     * @param x value
+     * @return fraction in [0, 1], or NaN if the metric has no samples
+     */
+    public double cdf(final int metric, final double x) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.populationCdf(h, metric, x) : Double.NaN;
+    }
+    
+    public long minSamples() { return minSamples; }
+    
+    /**
+     * Frees the native baseline. Subsequent calls are no-ops.
+     */
+    @Override
+    public synchronized void close() {
+        final long h = handle;
+        if (h != 0) {
+            handle = 0;
+            NativeHelper.destroyPopulation(h);
+        }
+    }
+}
@@ -0,0 +1,268 @@
+package com.macmoment.macac.util;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Handle to a native, lag-compensated history of entity positions.
+ * 
+ * <p>Reach measured against a target's current position has to allow for
+ * the attacker's ping. This history keeps the last {@code window}
+ * timestamped positions and bounding boxes of every tracked entity, so a
+ * hit can be measured against where the target was at
+ * {@code attackTime - ping}: an O(log window) binary search plus a linear
+ * interpolation, with no Java allocation per hit.
+ * 
+ * <p>Usage, once per tick: {@link #add} each tracked entity and
+ * {@link #flush()} the batch in one JNI crossing. Per hit, call
+ * {@link #reach}; to rewind many entities at once, queue ids with
+ * {@link #addRewind} and call {@link #rewind(long)}. Timestamps only need
+ * to come from one monotonic clock (e.g. {@link NativeHelper#nanoTime()}).
+ * Call {@link #remove(long)} on despawn, or {@link #prune(long)}
+ * periodically.
+ * 
+ * <p><strong>Sample layout</strong> (48 bytes, native order):
+ * {@code long id, long nanoTime, double x, double y, double z,
+ * float width, float height}. The position is the entity's feet; the box is
+ * {@code width x height x width} standing on it.
+ * 
+ * <p>The history is only available when the native library is loaded; use
+ * {@link #create(int, int, int)} which returns null otherwise.
+ * 
+ * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class PositionHistory implements AutoCloseable {
+    
+    /** Bytes per sample record. */
+    public static final int SAMPLE_BYTES = 48;
+    
+    private final int maxEntities;
+    private final int window;
+    private final int maxBatch;
+    private final ByteBuffer samples;
+    private final ByteBuffer rewindIds;
+    private final ByteBuffer rewound;
+    private int sampleCount;
+    private int rewindCount;
+    private int rewoundCount;
+    private volatile long handle;
+    
+    private PositionHistory(final long handle, final int maxEntities, final int window, final int maxBatch) {
+        this.handle = handle;
+        this.maxEntities = maxEntities;
+        this.window = window;
+        this.maxBatch = maxBatch;
+        this.samples = ByteBuffer.allocateDirect(maxBatch * SAMPLE_BYTES).order(ByteOrder.nativeOrder());
+        this.rewindIds = ByteBuffer.allocateDirect(maxBatch * Long.BYTES).order(ByteOrder.nativeOrder());
+        this.rewound = ByteBuffer.allocateDirect(maxBatch * SAMPLE_BYTES).order(ByteOrder.nativeOrder());
+    }
+    
+    /**
+     * Creates a native history if the native library is available.
+     * 
+     * @param maxEntities maximum tracked entities; must be positive
+     * @param window samples kept per entity (20 covers one second of ticks); must be positive
+     * @param maxBatch maximum samples per {@link #flush()} and ids per {@link #rewind(long)}; must be positive
+     * @return history, or null if native is unavailable or allocation failed
+     */
+    public static PositionHistory create(final int maxEntities, final int window, final int maxBatch) {
+        if (maxEntities <= 0 || window <= 0 || maxBatch <= 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createPositionHistory(maxEntities, window);
+        return handle != 0 ? new PositionHistory(handle, maxEntities, window, maxBatch) : null;
+    }
+    
+    /**
+     * Queues one sample for the next {@link #flush()}.
+     * 
+     * @param id entity id
+     * @param nanoTime sample time
+     * @param x feet X
+     * @param y feet Y
+     * @param z feet Z
+     * @param width bounding box width
+     * @param height bounding box height
+     * @return false if the batch is full
+     */
+    public boolean add(final long id, final long nanoTime, final double x, final double y, final double z,
+                       final float width, final float height) {
+        if (sampleCount >= maxBatch) {
+            return false;
+        }
+        final int base = sampleCount * SAMPLE_BYTES;
+        samples.putLong(base, id);
+        samples.putLong(base + 8, nanoTime);
+        samples.putDouble(base + 16, x);
+        samples.putDouble(base + 24, y);
+        samples.putDouble(base + 32, z);
+        samples.putFloat(base + 40, width);
+        samples.putFloat(base + 44, height);
+        sampleCount++;
+        return true;
+    }
+    
+    /**
+     * Records the queued samples and empties the batch. Samples older than
+     * their entity's latest are dropped; new entities beyond
+     * {@link #maxEntities()} are ignored.
+     * 
+     * @return samples stored
+     */
+    public int flush() {
+        final long h = handle;
+        final int count = sampleCount;
+        sampleCount = 0;
+        if (h == 0 || count == 0) {
+            return 0;
+        }
+        return Math.max(0, NativeHelper.positionHistoryRecord(h, samples, count));
+    }
+    
+    /**
+     * Forgets an entity and frees its slot.
+     * 
+     * @param id entity id
+     */
+    public void remove(final long id) {
+        final long h = handle;
+        if (h != 0) {
+            NativeHelper.positionHistoryRemove(h, id);
+        }
+    }
+    
+    /**
+     * Forgets every entity with no sample since {@code nanoTime}.
+     * 
+     * @param nanoTime cut-off time
+     * @return entities removed
+     */
+    public int prune(final long nanoTime) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.positionHistoryPrune(h, nanoTime) : 0;
+    }
+    
+    /**
+     * Lag-compensated reach: distance from the attacker's eye to the nearest
+     * point of the target's bounding box as it was at {@code nanoTime}.
+     * 
+     * @param id target entity id
+     * @param nanoTime time the attacker saw (attack time minus ping)
+     * @param eyeX attacker eye X
+     * @param eyeY attacker eye Y
+     * @param eyeZ attacker eye Z
+     * @return distance in blocks (0 inside the box), or NaN if the target is unknown
+     */
+    public double reach(final long id, final long nanoTime, final double eyeX, final double eyeY,
+                        final double eyeZ) {
+        final long h = handle;
+        return h != 0 ? NativeHelper.positionHistoryReach(h, id, nanoTime, eyeX, eyeY, eyeZ) : Double.NaN;
+    }
+    
+    /**
+     * Queues one entity for the next {@link #rewind(long)}.
+     * 
+     * @param id entity id
+     * @return index for reading the result, or -1 if the batch is full
+     */
+    public int addRewind(final long id) {
+        if (rewindCount >= maxBatch) {
+            return -1;
+        }
+        rewindIds.putLong(rewindCount * Long.BYTES, id);
+        return rewindCount++;
+    }
+    
+    /**
+     * Rewinds every queued entity to {@code nanoTime} and empties the queue.
+     * Results stay readable until the next call.
+     * 
+     * @param nanoTime time to rewind to
+     * @return entities found
+     */
+    public int rewind(final long nanoTime) {
+        final long h = handle;
+        final int count = rewindCount;
+        rewindCount = 0;
+        rewoundCount = 0;
+        if (h == 0 || count == 0) {
+            return 0;
+        }
+        final int found = NativeHelper.positionHistoryRewind(h, rewindIds, count, nanoTime, rewound);
+        if (found < 0) {
+            return 0;
+        }
+        rewoundCount = count;
+        return found;
+    }
+    
+    /**
+     * Returns the rewound X of a result ({@code NaN} if the entity is unknown).
+     * 
+     * @param index index from {@link #addRewind}
+     * @return feet X
+     */
+    public double rewoundX(final int index) {
+        return index >= 0 && index < rewoundCount ? rewound.getDouble(index * SAMPLE_BYTES + 16) : Double.NaN;
+    }
+    
+    /**
+     * Returns the rewound Y of a result ({@code NaN} if the entity is unknown).
+     * 
+     * @param index index from {@link #addRewind}
+     * @return feet Y
+     */
+    public double rewoundY(final int index) {
+        return index >= 0 && index < rewoundCount ? rewound.getDouble(index * SAMPLE_BYTES + 24) : Double.NaN;
+    }
+    
+    /**
+     * Returns the rewound Z of a result ({@code NaN} if the entity is unknown).
+     * 
+     * @param index index from {@link #addRewind}
+     * @return feet Z
+     */
+    public double rewoundZ(final int index) {
+        return index >= 0 && index < rewoundCount ? rewound.getDouble(index * SAMPLE_BYTES + 32) : Double.NaN;
+    }
+    
+    /**
+     * Returns the sample time a result was taken at: the requested time, or
+     * the oldest/newest sample's time if the request fell outside the history.
+     * 
+     * @param index index from {@link #addRewind}
+     * @return sample time, or 0 if there is no such result
+     */
+    public long rewoundTime(final int index) {
+        return index >= 0 && index < rewoundCount ? rewound.getLong(index * SAMPLE_BYTES + 8) : 0L;
+    }
+    
+    /**
+     * Returns the number of tracked entities.
+     * 
+     * @return entity count
+     */
+    public int size() {
+        final long h = handle;
+        return h != 0 ? NativeHelper.positionHistorySize(h) : 0;
+    }
+    
+    public int maxEntities() { return maxEntities; }
+    public int window() { return window; }
+    public int maxBatch() { return maxBatch; }
+    
+    /**
+     * Frees the native history. Subsequent calls are no-ops.
+     */
+    @Override
+    public synchronized void close() {
+        final long h = handle;
+        if (h != 0) {
+            handle = 0;
+            NativeHelper.destroyPositionHistory(h);
+        }
+    }
+}
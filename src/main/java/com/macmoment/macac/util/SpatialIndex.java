@@ -0,0 +1,262 @@
+package com.macmoment.macac.util;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Handle to a native spatial index over one world's entity positions.
+ * 
+ * <p>Combat checks normally see a single attacker/target pair; resolving
+ * "which entities were within reach" or "which entities lay along the look
+ * ray" in Java costs one pass over every entity per player. The native
+ * index buckets positions into a uniform grid (16-block cells, one chunk
+ * section, by default) so each query only scans the cells it overlaps.
+ * 
+ * <p>Usage, once per tick: {@link #clear()}, {@link #add} every entity,
+ * {@link #rebuild()}; then queue queries with {@link #addQuery} and answer
+ * the whole batch with {@link #queryRadius()} or {@link #queryCone()}, one
+ * JNI crossing each. Results are read back per query, nearest first.
+ * All buffers are allocated once at construction.
+ * 
+ * <p><strong>Entry layout</strong> (32 bytes, native order):
+ * {@code long id, double x, double y, double z}.
+ * <strong>Query layout</strong> (64 bytes): {@code double x, y, z, yaw,
+ * pitch, range, halfAngle, long excludeId}. Yaw and pitch follow the
+ * Minecraft convention; radius queries ignore them.
+ * 
+ * <p>The index is only available when the native library is loaded; use
+ * {@link #create(int, int, int)} which returns null otherwise.
+ * 
+ * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class SpatialIndex implements AutoCloseable {
+    
+    /** Bytes per entry record. */
+    public static final int ENTRY_BYTES = 32;
+    
+    /** Bytes per query record. */
+    public static final int QUERY_BYTES = 64;
+    
+    /** Id that matches no entity, for queries that exclude nothing. */
+    public static final long NO_ID = Long.MIN_VALUE;
+    
+    private final int maxEntities;
+    private final int maxQueries;
+    private final int resultsPerQuery;
+    private final ByteBuffer entries;
+    private final ByteBuffer queries;
+    private final ByteBuffer ids;
+    private final ByteBuffer distances;
+    private final ByteBuffer counts;
+    private int entryCount;
+    private int queryCount;
+    private int answeredCount;
+    private volatile long handle;
+    
+    private SpatialIndex(final long handle, final int maxEntities, final int maxQueries,
+                         final int resultsPerQuery) {
+        this.handle = handle;
+        this.maxEntities = maxEntities;
+        this.maxQueries = maxQueries;
+        this.resultsPerQuery = resultsPerQuery;
+        this.entries = ByteBuffer.allocateDirect(maxEntities * ENTRY_BYTES).order(ByteOrder.nativeOrder());
+        this.queries = ByteBuffer.allocateDirect(maxQueries * QUERY_BYTES).order(ByteOrder.nativeOrder());
+        this.ids = ByteBuffer.allocateDirect(maxQueries * resultsPerQuery * Long.BYTES)
+            .order(ByteOrder.nativeOrder());
+        this.distances = ByteBuffer.allocateDirect(maxQueries * resultsPerQuery * Double.BYTES)
+            .order(ByteOrder.nativeOrder());
+        this.counts = ByteBuffer.allocateDirect(maxQueries * Integer.BYTES).order(ByteOrder.nativeOrder());
+    }
+    
+    /**
+     * Creates a native index if the native library is available.
+     * 
+     * @param maxEntities maximum entities per rebuild; must be positive
+     * @param maxQueries maximum queries per batch; must be positive
+     * @param resultsPerQuery nearest results kept per query; must be positive
+     * @return index, or null if native is unavailable or allocation failed
+     */
+    public static SpatialIndex create(final int maxEntities, final int maxQueries, final int resultsPerQuery) {
+        if (maxEntities <= 0 || maxQueries <= 0 || resultsPerQuery <= 0 || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.createSpatialIndex(maxEntities, 0.0);
+        return handle != 0 ? new SpatialIndex(handle, maxEntities, maxQueries, resultsPerQuery) : null;
+    }
+    
+    /**
+     * Discards entries added since the last {@link #rebuild()}.
+     */
+    public void clear() {
+        entryCount = 0;
+    }
+    
+    /**
+     * Adds one entity position for the next {@link #rebuild()}.
+     * 
+     * @param id caller-chosen id returned by queries (e.g. entity id)
+     * @param x position tested by queries (e.g. hitbox center)
+     * @param y position Y
+     * @param z position Z
+     * @return false if the entry buffer is full
+     */
+    public boolean add(final long id, final double x, final double y, final double z) {
+        if (entryCount >= maxEntities) {
+            return false;
+        }
+        final int base = entryCount * ENTRY_BYTES;
+        entries.putLong(base, id);
+        entries.putDouble(base + 8, x);
+        entries.putDouble(base + 16, y);
+        entries.putDouble(base + 24, z);
+        entryCount++;
+        return true;
+    }
+    
+    /**
+     * Replaces the indexed positions with the entries added since
+     * {@link #clear()}. Entries with non-finite coordinates are dropped.
+     * 
+     * @return number of entities indexed, or 0 if closed
+     */
+    public int rebuild() {
+        final long h = handle;
+        if (h == 0) {
+            return 0;
+        }
+        final int indexed = NativeHelper.spatialUpdate(h, entries, entryCount);
+        return Math.max(0, indexed);
+    }
+    
+    /**
+     * Discards queued queries and their results.
+     */
+    public void clearQueries() {
+        queryCount = 0;
+        answeredCount = 0;
+    }
+    
+    /**
+     * Queues one query for the next {@link #queryRadius()} or {@link #queryCone()}.
+     * 
+     * @param x origin X (eye position for look cones)
+     * @param y origin Y
+     * @param z origin Z
+     * @param yaw look yaw in degrees (cone only)
+     * @param pitch look pitch in degrees (cone only)
+     * @param range maximum distance in blocks
+     * @param halfAngle cone half-angle in degrees (cone only)
+     * @param excludeId id to skip (the querying player), or {@link #NO_ID}
+     * @return query index for reading results, or -1 if the batch is full
+     */
+    public int addQuery(final double x, final double y, final double z, final double yaw, final double pitch,
+                        final double range, final double halfAngle, final long excludeId) {
+        if (queryCount >= maxQueries) {
+            return -1;
+        }
+        final int base = queryCount * QUERY_BYTES;
+        queries.putDouble(base, x);
+        queries.putDouble(base + 8, y);
+        queries.putDouble(base + 16, z);
+        queries.putDouble(base + 24, yaw);
+        queries.putDouble(base + 32, pitch);
+        queries.putDouble(base + 40, range);
+        queries.putDouble(base + 48, halfAngle);
+        queries.putLong(base + 56, excludeId);
+        return queryCount++;
+    }
+    
+    /**
+     * Answers every queued query as a radius query.
+     * 
+     * @return total results across the batch
+     */
+    public int queryRadius() {
+        return run(false);
+    }
+    
+    /**
+     * Answers every queued query as a look-cone query.
+     * 
+     * @return total results across the batch
+     */
+    public int queryCone() {
+        return run(true);
+    }
+    
+    private int run(final boolean cone) {
+        final long h = handle;
+        answeredCount = 0;
+        if (h == 0 || queryCount == 0) {
+            return 0;
+        }
+        final int total = NativeHelper.spatialQuery(h, queries, queryCount, resultsPerQuery, cone,
+                                                    ids, distances, counts);
+        if (total < 0) {
+            return 0;
+        }
+        answeredCount = queryCount;
+        return total;
+    }
+    
+    /**
+     * Returns the number of results of an answered query.
+     * 
+     * @param query index from {@link #addQuery}
+     * @return result count, or 0 if the query was not answered
+     */
+    public int resultCount(final int query) {
+        return query >= 0 && query < answeredCount ? counts.getInt(query * Integer.BYTES) : 0;
+    }
+    
+    /**
+     * Returns the id of one result, nearest first.
+     * 
+     * @param query index from {@link #addQuery}
+     * @param rank result rank, below {@link #resultCount(int)}
+     * @return entity id
+     */
+    public long resultId(final int query, final int rank) {
+        return ids.getLong((query * resultsPerQuery + rank) * Long.BYTES);
+    }
+    
+    /**
+     * Returns the distance of one result from its query origin.
+     * 
+     * @param query index from {@link #addQuery}
+     * @param rank result rank, below {@link #resultCount(int)}
+     * @return distance in blocks
+     */
+    public double resultDistance(final int query, final int rank) {
+        return distances.getDouble((query * resultsPerQuery + rank) * Double.BYTES);
+    }
+    
+    /**
+     * Returns the number of entities in the index.
+     * 
+     * @return indexed entity count
+     */
+    public int size() {
+        final long h = handle;
+        return h != 0 ? NativeHelper.spatialSize(h) : 0;
+    }
+    
+    public int maxEntities() { return maxEntities; }
+    public int maxQueries() { return maxQueries; }
+    public int resultsPerQuery() { return resultsPerQuery; }
+    
+    /**
+     * Frees the native index. Subsequent calls are no-ops.
+     */
+    @Override
+    public synchronized void close() {
+        final long h = handle;
+        if (h != 0) {
+            handle = 0;
+            NativeHelper.destroySpatialIndex(h);
+        }
+    }
+}
@@ -1,5 +1,7 @@
 package com.macmoment.macac.util;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Arrays;
 import java.util.Objects;
 
@@ -241,6 +243,116 @@ public final class Stats {
         }
     }
 
+    /**
+     * One-pass summary of a {@link RollingWindow}, filled by
+     * {@link RollingWindow#describe()}.
+     * 
+     * <p>Skewness and kurtosis are the population moment coefficients
+     * (g1 = m3 / m2^1.5, excess g2 = m4 / m2^2 - 3) and are 0 when the values
+     * have no spread. Variance uses the n - 1 denominator, like
+     * {@link RollingWindow#stdDev()}.
+     * 
+     * @since 1.0.0
+     */
+    public static final class Description {
+        
+        /** Number of values written by the native bridge. */
+        private static final int FIELDS = 8;
+        
+        // {count, sum, mean, variance, min, max, skewness, kurtosis}
+        private final double[] values = new double[FIELDS];
+        
+        private Description() {
+        }
+        
+        public int count() { return (int) values[0]; }
+        
+        public double sum() { return values[1]; }
+        
+        public double mean() { return values[2]; }
+        
+        public double variance() { return values[3]; }
+        
+        public double stdDev() { return Math.sqrt(values[3]); }
+        
+        public double min() { return values[4]; }
+        
+        public double max() { return values[5]; }
+        
+        public double skewness() { return values[6]; }
+        
+        public double kurtosis() { return values[7]; }
+        
+        private void clear() {
+            Arrays.fill(values, EMPTY_RESULT);
+        }
+    }
+    
+    /**
+     * Spectrum and autocorrelation of the newest values of a
+     * {@link RollingWindow}, filled by {@link RollingWindow#spectrum()}.
+     * 
+     * <p>The newest power-of-two run of n values ({@value #MIN_WINDOW} to
+     * {@value #MAX_WINDOW}) is mean-removed and its power taken over DFT
+     * bins 1..n/2. Entropy is the Shannon entropy of that power
+     * distribution divided by log(n/2): near 1 for white jitter, near 0 when
+     * one frequency dominates. Autocorrelation is the linear estimate
+     * r[lag] / r[0] over lags 1..n/2. Everything is 0 when the window is
+     * shorter than {@value #MIN_WINDOW} or has no spread.
+     * 
+     * @since 1.0.0
+     */
+    public static final class Spectrum {
+        
+        /** Fewest values analysed. */
+        public static final int MIN_WINDOW = 32;
+        
+        /** Most values analysed; longer windows use their newest values. */
+        public static final int MAX_WINDOW = 256;
+        
+        /** Number of values written by the native bridge. */
+        private static final int FIELDS = 6;
+        
+        // One period of cos/sin over MAX_WINDOW points for the Java fallback
+        private static final double[] COS = new double[MAX_WINDOW];
+        private static final double[] SIN = new double[MAX_WINDOW];
+        
+        static {
+            for (int i = 0; i < MAX_WINDOW; i++) {
+                COS[i] = Math.cos(2.0 * Math.PI * i / MAX_WINDOW);
+                SIN[i] = Math.sin(2.0 * Math.PI * i / MAX_WINDOW);
+            }
+        }
+        
+        // {window, entropy, peakPower, peakFrequency, autocorrPeak, autocorrLag}
+        private final double[] values = new double[FIELDS];
+        
+        private Spectrum() {
+        }
+        
+        /** Values analysed, or 0 if the spectrum is unavailable. */
+        public int window() { return (int) values[0]; }
+        
+        /** Normalized spectral entropy in [0, 1]. */
+        public double entropy() { return values[1]; }
+        
+        /** Share of the power in the strongest bin. */
+        public double peakPower() { return values[2]; }
+        
+        /** Strongest bin in cycles per value (1 / period). */
+        public double peakFrequency() { return values[3]; }
+        
+        /** Largest normalized autocorrelation over lags 1..n/2. */
+        public double autocorrPeak() { return values[4]; }
+        
+        /** Lag of {@link #autocorrPeak()}. */
+        public int autocorrLag() { return (int) values[5]; }
+        
+        private void clear() {
+            Arrays.fill(values, EMPTY_RESULT);
+        }
+    }
+    
     /**
      * Rolling window for maintaining a fixed-size collection of recent values.
      * 
@@ -248,6 +360,13 @@ public final class Stats {
      * when capacity is reached. Provides efficient O(1) insertion and O(n)
      * statistical computations over the windowed data.
      * 
+     * <p>An {@linkplain #offHeap(int) off-heap} window keeps its values in a
+     * direct buffer. When the native library is loaded, mean, standard
+     * deviation, median, MAD, {@link #describe()} and {@link #spectrum()}
+     * are computed by native code reading the live window in place, so a
+     * query performs no allocation and no JNI copy.
+     * Statistics never allocate in either mode.
+     * 
      * <p><strong>Thread Safety:</strong> This class is NOT thread-safe.
      * External synchronization is required if accessed from multiple threads.
      * 
@@ -258,25 +377,74 @@ public final class Stats {
         /** Minimum valid capacity for a rolling window. */
         private static final int MIN_CAPACITY = 1;
         
-        private final double[] values;
+        private final double[] values;      // null when off-heap
+        private final ByteBuffer direct;    // null when on-heap
+        private final boolean nativeReads;
+        private final int capacity;
+        private double[] scratch;
+        private Description description;
+        private Spectrum spectrum;
         private int head;
         private int size;
 
         /**
-         * Creates a new rolling window with the specified capacity.
+         * Creates a new on-heap rolling window with the specified capacity.
          * 
          * @param capacity maximum number of values to retain; must be at least 1
          * @throws IllegalArgumentException if capacity is less than {@value #MIN_CAPACITY}
          */
         public RollingWindow(final int capacity) {
+            this(capacity, false);
+        }
+        
+        private RollingWindow(final int capacity, final boolean offHeap) {
             if (capacity < MIN_CAPACITY) {
                 throw new IllegalArgumentException(
                     String.format("Capacity must be at least %d, got: %d", MIN_CAPACITY, capacity));
             }
-            this.values = new double[capacity];
+            this.capacity = capacity;
+            this.values = offHeap ? null : new double[capacity];
+            this.direct = offHeap
+                ? ByteBuffer.allocateDirect(capacity * Double.BYTES).order(ByteOrder.nativeOrder())
+                : null;
+            this.nativeReads = offHeap && NativeHelper.isNativeAvailable();
             this.head = 0;
             this.size = 0;
         }
+        
+        /**
+         * Creates a rolling window backed by a native-order direct buffer.
+         * 
+         * @param capacity maximum number of values to retain; must be at least 1
+         * @return off-heap window
+         * @throws IllegalArgumentException if capacity is less than {@value #MIN_CAPACITY}
+         */
+        public static RollingWindow offHeap(final int capacity) {
+            return new RollingWindow(capacity, true);
+        }
+        
+        /**
+         * Creates a rolling window in the best backing for this runtime:
+         * off-heap when the native library is loaded, on-heap otherwise.
+         * 
+         * @param capacity maximum number of values to retain; must be at least 1
+         * @return rolling window
+         * @throws IllegalArgumentException if capacity is less than {@value #MIN_CAPACITY}
+         */
+        public static RollingWindow create(final int capacity) {
+            return NativeHelper.isNativeAvailable() ? offHeap(capacity) : new RollingWindow(capacity);
+        }
+        
+        private double read(final int index) {
+            return values != null ? values[index] : direct.getDouble(index * Double.BYTES);
+        }
+        
+        /**
+         * Ring slot of the i-th value, counting from the oldest.
+         */
+        private int slot(final int i) {
+            return (head - size + i + capacity) % capacity;
+        }
 
         /**
          * Adds a value to the window, discarding the oldest if at capacity.
@@ -284,9 +452,13 @@ public final class Stats {
          * @param value value to add
          */
         public void add(final double value) {
-            values[head] = value;
-            head = (head + 1) % values.length;
-            if (size < values.length) {
+            if (values != null) {
+                values[head] = value;
+            } else {
+                direct.putDouble(head * Double.BYTES, value);
+            }
+            head = (head + 1) % capacity;
+            if (size < capacity) {
                 size++;
             }
         }
@@ -301,12 +473,32 @@ public final class Stats {
         public double[] toArray() {
             final double[] result = new double[size];
             for (int i = 0; i < size; i++) {
-                final int index = (head - size + i + values.length) % values.length;
-                result[i] = values[index];
+                result[i] = read(slot(i));
             }
             return result;
         }
 
+        /**
+         * Copies the newest values into a buffer without allocating.
+         * 
+         * <p>Up to {@code maxCount} of the most recent values are written as
+         * doubles starting at {@code byteOffset}, ordered from oldest to newest,
+         * using absolute puts (the buffer position is not changed).
+         * 
+         * @param target destination buffer
+         * @param byteOffset byte offset of the first value
+         * @param maxCount maximum number of values to copy
+         * @return number of values copied
+         */
+        public int copyTo(final ByteBuffer target, final int byteOffset, final int maxCount) {
+            final int count = Math.min(size, Math.max(0, maxCount));
+            for (int i = 0; i < count; i++) {
+                final int index = (head - count + i + capacity) % capacity;
+                target.putDouble(byteOffset + i * Double.BYTES, read(index));
+            }
+            return count;
+        }
+        
         /**
          * Returns the current number of values in the window.
          * 
@@ -324,6 +516,15 @@ public final class Stats {
         public boolean isEmpty() {
             return size == 0;
         }
+        
+        /**
+         * Returns true if the values live in a direct buffer.
+         * 
+         * @return true for windows created by {@link #offHeap(int)}
+         */
+        public boolean isOffHeap() {
+            return direct != null;
+        }
 
         /**
          * Removes all values from the window.
@@ -339,7 +540,21 @@ public final class Stats {
          * @return median value, or 0.0 if empty
          */
         public double median() {
-            return Stats.median(toArray());
+            if (size == 0) {
+                return EMPTY_RESULT;
+            }
+            if (nativeReads) {
+                return NativeHelper.medianDirect(direct, size);
+            }
+            final double[] work = scratch();
+            if (values != null) {
+                System.arraycopy(values, 0, work, 0, size);
+            } else {
+                for (int i = 0; i < size; i++) {
+                    work[i] = read(i);
+                }
+            }
+            return sortedMedian(work, size);
         }
 
         /**
@@ -348,7 +563,44 @@ public final class Stats {
          * @return MAD value, or 0.0 if empty
          */
         public double mad() {
-            return Stats.mad(toArray());
+            if (size == 0) {
+                return EMPTY_RESULT;
+            }
+            if (nativeReads) {
+                return NativeHelper.madDirect(direct, size);
+            }
+            final double med = median();
+            final double[] work = scratch();
+            for (int i = 0; i < size; i++) {
+                work[i] = Math.abs(read(i) - med);
+            }
+            return sortedMedian(work, size);
+        }
+        
+        /**
+         * Returns the reusable work array used by {@link #median()},
+         * {@link #mad()} and {@link #spectrum()}, so repeated queries do not
+         * allocate.
+         * 
+         * <p>Until the window wraps, the values occupy slots {@code [0, size)};
+         * afterwards every slot is in the window. Either way the first
+         * {@code size} slots hold exactly the window contents (in ring order),
+         * which is all an order statistic (or a native reduction) needs.
+         */
+        private double[] scratch() {
+            if (scratch == null) {
+                scratch = new double[capacity];
+            }
+            return scratch;
+        }
+        
+        private static double sortedMedian(final double[] work, final int length) {
+            Arrays.sort(work, 0, length);
+            final int mid = length / 2;
+            if (length % 2 == 0) {
+                return (work[mid - 1] + work[mid]) / 2.0;
+            }
+            return work[mid];
         }
 
         /**
@@ -357,7 +609,18 @@ public final class Stats {
          * @return mean value, or 0.0 if empty
          */
         public double mean() {
-            return Stats.mean(toArray());
+            if (size == 0) {
+                return EMPTY_RESULT;
+            }
+            if (nativeReads) {
+                return NativeHelper.simdMeanDirect(direct, size);
+            }
+            // Oldest to newest, matching Stats.mean(toArray())
+            double sum = 0.0;
+            for (int i = 0; i < size; i++) {
+                sum += read(slot(i));
+            }
+            return sum / size;
         }
 
         /**
@@ -366,7 +629,185 @@ public final class Stats {
          * @return standard deviation, or 0.0 if fewer than 2 values
          */
         public double stdDev() {
-            return Stats.stdDev(toArray());
+            if (size < 2) {
+                return EMPTY_RESULT;
+            }
+            if (nativeReads) {
+                return Math.sqrt(NativeHelper.simdVarianceDirect(direct, size));
+            }
+            final double meanValue = mean();
+            double sumSquares = 0.0;
+            for (int i = 0; i < size; i++) {
+                final double diff = read(slot(i)) - meanValue;
+                sumSquares += diff * diff;
+            }
+            return Math.sqrt(sumSquares / (size - 1));
+        }
+        
+        /**
+         * Summarizes the window in one pass: count, sum, mean, variance,
+         * min, max, skewness and kurtosis.
+         * 
+         * <p>Callers that need several of these should use this rather than
+         * the individual accessors; on a native off-heap window it is a single
+         * JNI call and a single SIMD pass. The returned object is owned by the
+         * window and overwritten by the next call.
+         * 
+         * @return summary of the current contents; all zero if empty
+         */
+        public Description describe() {
+            if (description == null) {
+                description = new Description();
+            }
+            final Description d = description;
+            d.clear();
+            if (size == 0) {
+                return d;
+            }
+            if (nativeReads && NativeHelper.simdDescribeDirect(direct, size, d.values) == 0) {
+                return d;
+            }
+            
+            // Oldest to newest, matching mean() and stdDev()
+            double sum = 0.0;
+            double min = Double.MAX_VALUE;
+            double max = -Double.MAX_VALUE;
+            for (int i = 0; i < size; i++) {
+                final double v = read(slot(i));
+                sum += v;
+                if (v < min) {
+                    min = v;
+                }
+                if (v > max) {
+                    max = v;
+                }
+            }
+            final double meanValue = sum / size;
+            
+            double m2 = 0.0;
+            double m3 = 0.0;
+            double m4 = 0.0;
+            for (int i = 0; i < size; i++) {
+                final double diff = read(slot(i)) - meanValue;
+                final double sq = diff * diff;
+                m2 += sq;
+                m3 += sq * diff;
+                m4 += sq * sq;
+            }
+            
+            d.values[0] = size;
+            d.values[1] = sum;
+            d.values[2] = meanValue;
+            d.values[3] = size > 1 ? m2 / (size - 1) : EMPTY_RESULT;
+            d.values[4] = min;
+            d.values[5] = max;
+            if (m2 > 0.0) {
+                final double pm2 = m2 / size;
+                d.values[6] = (m3 / size) / (pm2 * Math.sqrt(pm2));
+                d.values[7] = (m4 / size) / (pm2 * pm2) - 3.0;
+            }
+            return d;
+        }
+        
+        /**
+         * Spectrum and autocorrelation of the newest values, for periodic
+         * structure that a mean/variance summary cannot see.
+         * 
+         * <p>On a native off-heap window this is one JNI call running a real
+         * FFT in place; the Java fallback is a direct O(n^2) transform. The
+         * returned object is owned by the window and overwritten by the
+         * next call.
+         * 
+         * @return spectrum of the newest values; all zero if unavailable
+         * @see Spectrum
+         */
+        public Spectrum spectrum() {
+            if (spectrum == null) {
+                spectrum = new Spectrum();
+            }
+            final Spectrum sp = spectrum;
+            sp.clear();
+            if (size < Spectrum.MIN_WINDOW) {
+                return sp;
+            }
+            if (nativeReads) {
+                // The first size slots form a ring whose oldest value is slot(0)
+                NativeHelper.spectralDirect(direct, size, slot(0), sp.values);
+                return sp;
+            }
+            
+            int n = Spectrum.MAX_WINDOW;
+            while (n > size) {
+                n >>= 1;
+            }
+            final double[] x = scratch();
+            double sum = 0.0;
+            for (int i = 0; i < n; i++) {
+                x[i] = read(slot(size - n + i));
+                sum += x[i];
+            }
+            if (!Double.isFinite(sum)) {
+                return sp;
+            }
+            final double meanValue = sum / n;
+            double energy = 0.0;
+            for (int i = 0; i < n; i++) {
+                x[i] -= meanValue;
+                energy += x[i] * x[i];
+            }
+            if (!(energy > 1e-20 * (energy + n * meanValue * meanValue))) {
+                return sp;
+            }
+            
+            // Entropy in one pass: H = ln(T) - sum(P ln P) / T
+            final int stride = Spectrum.MAX_WINDOW / n;
+            final int mask = Spectrum.MAX_WINDOW - 1;
+            double total = 0.0;
+            double weighted = 0.0;
+            double peak = 0.0;
+            int peakBin = 1;
+            for (int k = 1; k <= n / 2; k++) {
+                double re = 0.0;
+                double im = 0.0;
+                for (int m = 0; m < n; m++) {
+                    final int angle = (k * m * stride) & mask;
+                    re += x[m] * Spectrum.COS[angle];
+                    im -= x[m] * Spectrum.SIN[angle];
+                }
+                final double power = re * re + im * im;
+                total += power;
+                if (power > 0.0) {
+                    weighted += power * Math.log(power);
+                }
+                if (power > peak) {
+                    peak = power;
+                    peakBin = k;
+                }
+            }
+            if (!(total > 0.0)) {
+                return sp;
+            }
+            
+            double best = Double.NEGATIVE_INFINITY;
+            int bestLag = 1;
+            for (int lag = 1; lag <= n / 2; lag++) {
+                double r = 0.0;
+                for (int i = 0; i + lag < n; i++) {
+                    r += x[i] * x[i + lag];
+                }
+                if (r > best) {
+                    best = r;
+                    bestLag = lag;
+                }
+            }
+            
+            sp.values[0] = n;
+            sp.values[1] = Math.max(0.0, Math.log(total) - weighted / total) / Math.log(n / 2.0);
+            sp.values[2] = peak / total;
+            sp.values[3] = (double) peakBin / n;
+            sp.values[4] = best / energy;
+            sp.values[5] = bestLag;
+            return sp;
         }
         
         /**
@@ -380,8 +821,8 @@ public final class Stats {
             }
             
             double min = Double.MAX_VALUE;
-            final double[] arr = toArray();
-            for (final double v : arr) {
+            for (int i = 0; i < size; i++) {
+                final double v = read(i);
                 if (v < min) {
                     min = v;
                 }
@@ -400,8 +841,8 @@ public final class Stats {
             }
             
             double max = -Double.MAX_VALUE;
-            final double[] arr = toArray();
-            for (final double v : arr) {
+            for (int i = 0; i < size; i++) {
+                final double v = read(i);
                 if (v > max) {
                     max = v;
                 }
@@ -409,13 +850,29 @@ public final class Stats {
             return max;
         }
         
+        /**
+         * Returns the number of values strictly below a threshold.
+         * 
+         * @param threshold exclusive upper bound
+         * @return count of values less than {@code threshold}
+         */
+        public int countBelow(final double threshold) {
+            int count = 0;
+            for (int i = 0; i < size; i++) {
+                if (read(i) < threshold) {
+                    count++;
+                }
+            }
+            return count;
+        }
+        
         /**
          * Returns the capacity of this window.
          * 
          * @return maximum number of values this window can hold
          */
         public int capacity() {
-            return values.length;
+            return capacity;
         }
     }
 
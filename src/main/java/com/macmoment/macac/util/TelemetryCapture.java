@@ -0,0 +1,178 @@
+package com.macmoment.macac.util;
+
+import com.macmoment.macac.model.CombatInput;
+import com.macmoment.macac.model.TelemetryInput;
+
+import java.util.UUID;
+import java.util.concurrent.locks.ReadWriteLock;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
+
+/**
+ * Handle to a native telemetry capture: a recorder of movement and combat
+ * samples into rotating binary files for offline replay.
+ * 
+ * <p>Recording copies one fixed-size record into a lock-free native queue
+ * and returns; a native writer thread batches the queue into large writes.
+ * When the writer falls behind, samples are dropped and counted rather than
+ * waited on, so capturing never stalls the caller.
+ * 
+ * <p>Files are named {@code <prefix>-<unix secs>-NNNN.mcap} and can be read
+ * back with {@link CaptureReader}, replayed through the Java pipeline with
+ * {@code com.macmoment.macac.tools.CaptureReplay}, or through the native
+ * kernels with the {@code macac_replay} tool.
+ * 
+ * <p><strong>Thread Safety:</strong> {@link #telemetry} and {@link #combat}
+ * may be called from any number of threads. {@link #close()} may race with
+ * them: it waits for calls already recording, and later calls see the
+ * capture closed.
+ * 
+ * @author MacAC Development Team
+ * @since 1.0.0
+ */
+public final class TelemetryCapture implements AutoCloseable {
+    
+    /** Combat record flag: the attack hit its target. */
+    public static final int COMBAT_HIT = 1;
+    /** Combat record flag: the hit was a critical. */
+    public static final int COMBAT_CRITICAL = 1 << 1;
+    /** Combat record flag: the record carries a target id. */
+    public static final int COMBAT_HAS_TARGET = 1 << 2;
+    
+    /** Queued records between the recording threads and the writer. */
+    private static final int QUEUE_CAPACITY = 1 << 16;
+    
+    private final String prefix;
+    
+    // Guarded by handleLock so close() cannot free the capture under a call
+    private final ReadWriteLock handleLock;
+    private long handle;
+    
+    private TelemetryCapture(final long handle, final String prefix) {
+        this.handleLock = new ReentrantReadWriteLock();
+        this.handle = handle;
+        this.prefix = prefix;
+    }
+    
+    /**
+     * Starts a capture if the native library is available.
+     * 
+     * @param prefix path prefix of the capture files; its directory must exist
+     * @param maxFileBytes size at which to start the next file
+     * @param maxFiles files to keep, oldest deleted first; 0 keeps all
+     * @return capture, or null if native is unavailable or the first file
+     *         could not be created
+     */
+    public static TelemetryCapture open(final String prefix, final long maxFileBytes, final int maxFiles) {
+        if (prefix == null || prefix.isEmpty() || maxFileBytes <= 0 || maxFiles < 0
+                || !NativeHelper.isNativeAvailable()) {
+            return null;
+        }
+        final long handle = NativeHelper.captureOpen(prefix, QUEUE_CAPACITY, maxFileBytes, maxFiles);
+        return handle != 0 ? new TelemetryCapture(handle, prefix) : null;
+    }
+    
+    /**
+     * Records one movement sample. Never blocks, except behind a
+     * concurrent {@link #close()}.
+     * 
+     * @param playerId player the sample belongs to
+     * @param input movement sample
+     * @return true if queued; false if dropped or closed
+     */
+    public boolean telemetry(final UUID playerId, final TelemetryInput input) {
+        final int flags = PacketQueue.flags(input.onGround(), input.inVehicle(), input.teleporting(),
+            input.swimming(), input.gliding(), input.climbing());
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            return h != 0 && NativeHelper.captureTelemetry(h,
+                playerId.getMostSignificantBits(), playerId.getLeastSignificantBits(), flags,
+                input.dx(), input.dy(), input.dz(),
+                input.yaw(), input.pitch(), input.deltaYaw(), input.deltaPitch(),
+                (int) Math.min(input.ping(), Integer.MAX_VALUE),
+                input.nanoTime(), input.tickDelta()) == 0;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Records one attack. Never blocks, except behind a concurrent
+     * {@link #close()}. The attacker name is not recorded.
+     * 
+     * @param input attack sample
+     * @return true if queued; false if dropped or closed
+     */
+    public boolean combat(final CombatInput input) {
+        final UUID target = input.targetId();
+        final int flags = (input.hit() ? COMBAT_HIT : 0)
+            | (input.critical() ? COMBAT_CRITICAL : 0)
+            | (target != null ? COMBAT_HAS_TARGET : 0);
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            return h != 0 && NativeHelper.captureCombat(h,
+                input.attackerId().getMostSignificantBits(), input.attackerId().getLeastSignificantBits(),
+                target != null ? target.getMostSignificantBits() : 0L,
+                target != null ? target.getLeastSignificantBits() : 0L,
+                flags,
+                input.targetX(), input.targetY(), input.targetZ(),
+                input.attackerX(), input.attackerY(), input.attackerZ(),
+                input.damage(),
+                input.attackerYaw(), input.attackerPitch(),
+                input.preAttackYaw(), input.preAttackPitch(),
+                (int) Math.min(input.ping(), Integer.MAX_VALUE),
+                input.nanoTime(), input.timeSinceLastAttack()) == 0;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Capture counters.
+     * 
+     * @return {records written, dropped, bytes written, files started,
+     *         write errors}; all zero once closed
+     */
+    public long[] stats() {
+        final long[] stats;
+        handleLock.readLock().lock();
+        try {
+            final long h = handle;
+            stats = h != 0 ? NativeHelper.captureStats(h) : null;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+        return stats != null ? stats : new long[5];
+    }
+    
+    public String prefix() { return prefix; }
+    
+    public boolean isOpen() {
+        handleLock.readLock().lock();
+        try {
+            return handle != 0;
+        } finally {
+            handleLock.readLock().unlock();
+        }
+    }
+    
+    /**
+     * Writes out queued records and stops the capture, once calls in
+     * progress have returned. Subsequent calls are no-ops.
+     */
+    @Override
+    public void close() {
+        final long h;
+        handleLock.writeLock().lock();
+        try {
+            h = handle;
+            handle = 0;
+        } finally {
+            handleLock.writeLock().unlock();
+        }
+        if (h != 0) {
+            NativeHelper.captureClose(h);
+        }
+    }
+}
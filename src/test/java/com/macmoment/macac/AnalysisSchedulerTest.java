@@ -0,0 +1,212 @@
+package com.macmoment.macac;
+
+import com.macmoment.macac.pipeline.AnalysisScheduler;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.UUID;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.logging.Logger;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+/**
+ * Unit tests for AnalysisScheduler ordering and hand-off.
+ */
+class AnalysisSchedulerTest {
+    
+    private AnalysisScheduler scheduler;
+    
+    @BeforeEach
+    void setUp() {
+        scheduler = new AnalysisScheduler(4, Logger.getLogger("AnalysisSchedulerTest"));
+    }
+    
+    @AfterEach
+    void tearDown() {
+        scheduler.shutdown(1000);
+    }
+    
+    @Test
+    void testConstructorInvalidThreads() {
+        Logger logger = Logger.getLogger("AnalysisSchedulerTest");
+        assertThrows(IllegalArgumentException.class, () -> new AnalysisScheduler(0, logger));
+    }
+    
+    @Test
+    void testPerPlayerOrderAndSingleWriter() throws InterruptedException {
+        final int players = 16;
+        final int tasksPerPlayer = 2000;
+        final UUID[] ids = new UUID[players];
+        final int[] next = new int[players];
+        final AtomicBoolean[] busy = new AtomicBoolean[players];
+        final AtomicInteger violations = new AtomicInteger();
+        final CountDownLatch done = new CountDownLatch(players * tasksPerPlayer);
+        
+        for (int p = 0; p < players; p++) {
+            ids[p] = UUID.randomUUID();
+            busy[p] = new AtomicBoolean();
+        }
+        
+        for (int i = 0; i < tasksPerPlayer; i++) {
+            for (int p = 0; p < players; p++) {
+                final int player = p;
+                final int seq = i;
+                scheduler.submit(ids[p], () -> {
+                    if (!busy[player].compareAndSet(false, true)) {
+                        violations.incrementAndGet();
+                    }
+                    if (next[player] != seq) {
+                        violations.incrementAndGet();
+                    }
+                    next[player] = seq + 1;
+                    busy[player].set(false);
+                    done.countDown();
+                });
+            }
+        }
+        
+        assertTrue(done.await(10, TimeUnit.SECONDS));
+        assertEquals(0, violations.get());
+    }
+    
+    @Test
+    void testSubmitAll() throws InterruptedException {
+        final int count = 500;
+        final UUID[] ids = new UUID[count];
+        final Runnable[] tasks = new Runnable[count];
+        final CountDownLatch done = new CountDownLatch(count);
+        for (int i = 0; i < count; i++) {
+            ids[i] = UUID.randomUUID();
+            tasks[i] = done::countDown;
+        }
+        
+        assertEquals(count, scheduler.submitAll(ids, tasks, count));
+        assertTrue(done.await(10, TimeUnit.SECONDS));
+    }
+    
+    @Test
+    void testCompletionsRunOnDrainingThread() throws InterruptedException {
+        final UUID id = UUID.randomUUID();
+        final CountDownLatch posted = new CountDownLatch(1);
+        final List<Thread> ranOn = new ArrayList<>();
+        
+        scheduler.submit(id, () -> {
+            scheduler.complete(() -> ranOn.add(Thread.currentThread()));
+            posted.countDown();
+        });
+        
+        assertTrue(posted.await(10, TimeUnit.SECONDS));
+        assertEquals(1, scheduler.getPendingCompletions());
+        assertEquals(1, scheduler.drainCompletions(16));
+        assertEquals(List.of(Thread.currentThread()), ranOn);
+        assertEquals(0, scheduler.drainCompletions(16));
+    }
+    
+    @Test
+    void testRetireRunsAfterQueuedTasks() throws InterruptedException {
+        final UUID id = UUID.randomUUID();
+        final AtomicInteger ran = new AtomicInteger();
+        final AtomicInteger seenAtRetire = new AtomicInteger(-1);
+        final CountDownLatch retired = new CountDownLatch(1);
+        
+        for (int i = 0; i < 100; i++) {
+            scheduler.submit(id, ran::incrementAndGet);
+        }
+        scheduler.retire(id, () -> {
+            seenAtRetire.set(ran.get());
+            retired.countDown();
+        });
+        
+        assertTrue(retired.await(10, TimeUnit.SECONDS));
+        assertEquals(100, seenAtRetire.get());
+    }
+    
+    @Test
+    void testSubmitAfterRetireRunsAfterFinalTaskOnOneThread() throws InterruptedException {
+        final UUID id = UUID.randomUUID();
+        final AtomicInteger active = new AtomicInteger();
+        final AtomicInteger maxActive = new AtomicInteger();
+        final List<Integer> order = new ArrayList<>();
+        final CountDownLatch done = new CountDownLatch(1);
+        
+        for (int round = 0; round < 200; round++) {
+            final int tag = round;
+            final Runnable task = () -> {
+                maxActive.accumulateAndGet(active.incrementAndGet(), Math::max);
+                synchronized (order) {
+                    order.add(tag);
+                }
+                active.decrementAndGet();
+            };
+            for (int i = 0; i < 10; i++) {
+                scheduler.submit(id, task);
+            }
+            scheduler.retire(id, task);
+        }
+        scheduler.submit(id, done::countDown);
+        
+        assertTrue(done.await(10, TimeUnit.SECONDS));
+        assertEquals(1, maxActive.get());
+        synchronized (order) {
+            assertEquals(200 * 11, order.size());
+            for (int i = 1; i < order.size(); i++) {
+                assertTrue(order.get(i - 1) <= order.get(i));
+            }
+        }
+    }
+    
+    @Test
+    void testRetireUnknownPlayerRunsInline() {
+        final AtomicBoolean ran = new AtomicBoolean();
+        scheduler.retire(UUID.randomUUID(), () -> ran.set(true));
+        assertTrue(ran.get());
+    }
+    
+    @Test
+    void testSubmitAfterShutdown() {
+        scheduler.shutdown(1000);
+        assertFalse(scheduler.submit(UUID.randomUUID(), () -> { }));
+    }
+    
+    @Test
+    void testShutdownFinishesQueuedWork() {
+        final UUID id = UUID.randomUUID();
+        final AtomicInteger ran = new AtomicInteger();
+        for (int i = 0; i < 1000; i++) {
+            scheduler.submit(id, ran::incrementAndGet);
+        }
+        scheduler.shutdown(5000);
+        assertEquals(1000, ran.get());
+    }
+    
+    @Test
+    void testShutdownWaitsForRunningTaskPastDeadline() throws InterruptedException {
+        final UUID id = UUID.randomUUID();
+        final CountDownLatch started = new CountDownLatch(1);
+        final AtomicBoolean finished = new AtomicBoolean();
+        final AtomicInteger ran = new AtomicInteger();
+        scheduler.submit(id, () -> {
+            started.countDown();
+            final long end = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(300);
+            while (System.nanoTime() < end) {
+                Thread.onSpinWait();
+            }
+            finished.set(true);
+        });
+        for (int i = 0; i < 1000; i++) {
+            scheduler.submit(id, ran::incrementAndGet);
+        }
+        assertTrue(started.await(10, TimeUnit.SECONDS));
+        
+        scheduler.shutdown(10);
+        assertTrue(finished.get());
+        assertEquals(0, ran.get());
+    }
+}
@@ -0,0 +1,116 @@
+package com.macmoment.macac;
+
+import com.macmoment.macac.model.Violation;
+import com.macmoment.macac.network.BinaryWireFormat;
+import com.macmoment.macac.network.WireProtocol;
+import org.junit.jupiter.api.Test;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.List;
+import java.util.Map;
+import java.util.UUID;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+/**
+ * Unit tests for the binary analytics wire format.
+ */
+class BinaryWireFormatTest {
+    
+    private static Violation violation(UUID id, String category) {
+        return new Violation(id, "Player", category, 0.75, 0.5, 1703864123456L, 50L,
+            List.of(), Map.of());
+    }
+    
+    @Test
+    void testHelloAndAck() {
+        byte[] hello = BinaryWireFormat.hello(true);
+        assertEquals(BinaryWireFormat.HELLO_BYTES, hello.length);
+        assertEquals('M', hello[0]);
+        assertEquals('B', hello[3]);
+        assertEquals(BinaryWireFormat.VERSION, hello[4]);
+        assertEquals(1, hello[5]);
+        assertEquals(0, BinaryWireFormat.hello(false)[5]);
+        
+        // An echoed hello is a valid ack
+        assertEquals(BinaryWireFormat.VERSION, BinaryWireFormat.parseAck(hello));
+        
+        byte[] rejected = hello.clone();
+        rejected[4] = 0;
+        assertEquals(0, BinaryWireFormat.parseAck(rejected));
+        
+        byte[] future = hello.clone();
+        future[4] = (byte) (BinaryWireFormat.VERSION + 1);
+        assertEquals(0, BinaryWireFormat.parseAck(future));
+        
+        byte[] badMagic = hello.clone();
+        badMagic[0] = 'X';
+        assertEquals(0, BinaryWireFormat.parseAck(badMagic));
+        assertEquals(0, BinaryWireFormat.parseAck(new byte[3]));
+    }
+    
+    @Test
+    void testViolationFrameLayout() {
+        UUID id = UUID.fromString("0b7c1c2f-aaaa-bbbb-cccc-00000000002a");
+        ByteBuffer buf = ByteBuffer.allocate(64).order(ByteOrder.LITTLE_ENDIAN);
+        BinaryWireFormat.putViolation(buf, violation(id, "combat"), 7);
+        
+        assertEquals(BinaryWireFormat.FRAME_HEADER_BYTES + BinaryWireFormat.RECORD_BYTES, buf.position());
+        assertEquals(ByteOrder.LITTLE_ENDIAN, buf.order());
+        
+        buf.flip();
+        assertEquals(1 + BinaryWireFormat.RECORD_BYTES, buf.getInt());
+        assertEquals(BinaryWireFormat.FRAME_VIOLATION, buf.get());
+        
+        // UUID in RFC 4122 (big-endian) byte order
+        assertEquals(0x0b, buf.get(5));
+        assertEquals(0x2a, buf.get(5 + 15));
+        buf.position(5 + 16);
+        assertEquals(7, buf.getShort());
+        assertEquals(0, buf.getShort());
+        assertEquals(0.75f, buf.getFloat());
+        assertEquals(0.5f, buf.getFloat());
+        assertEquals(1703864123456L, buf.getLong());
+    }
+    
+    @Test
+    void testCategoryAndBatchFrames() {
+        byte[] name = BinaryWireFormat.categoryName("movement");
+        ByteBuffer buf = ByteBuffer.allocate(256).order(ByteOrder.LITTLE_ENDIAN);
+        BinaryWireFormat.putCategory(buf, 3, name);
+        assertEquals(BinaryWireFormat.categoryFrameSize(name), buf.position());
+        
+        BinaryWireFormat.putBatchHeader(buf, 2);
+        BinaryWireFormat.putRecord(buf, violation(UUID.randomUUID(), "movement"), 3);
+        BinaryWireFormat.putRecord(buf, violation(UUID.randomUUID(), "movement"), 3);
+        
+        buf.flip();
+        assertEquals(1 + 3 + name.length, buf.getInt());
+        assertEquals(BinaryWireFormat.FRAME_CATEGORY, buf.get());
+        assertEquals(3, buf.getShort());
+        assertEquals(name.length, buf.get());
+        buf.position(buf.position() + name.length);
+        
+        assertEquals(1 + 2 + 2 * BinaryWireFormat.RECORD_BYTES, buf.getInt());
+        assertEquals(BinaryWireFormat.FRAME_BATCH, buf.get());
+        assertEquals(2, buf.getShort());
+        assertEquals(2 * BinaryWireFormat.RECORD_BYTES, buf.remaining());
+    }
+    
+    @Test
+    void testCategoryNameLimit() {
+        assertNotNull(BinaryWireFormat.categoryName("a".repeat(BinaryWireFormat.MAX_CATEGORY_NAME)));
+        assertNull(BinaryWireFormat.categoryName("a".repeat(BinaryWireFormat.MAX_CATEGORY_NAME + 1)));
+    }
+    
+    @Test
+    void testProtocolFromConfig() {
+        assertEquals(WireProtocol.JSON, WireProtocol.fromConfig("json"));
+        assertEquals(WireProtocol.BINARY, WireProtocol.fromConfig("BINARY"));
+        assertEquals(WireProtocol.BINARY_BATCHED, WireProtocol.fromConfig(" binary_batched "));
+        assertEquals(WireProtocol.JSON, WireProtocol.fromConfig("xml"));
+        assertEquals(WireProtocol.JSON, WireProtocol.fromConfig(null));
+        assertEquals(2, WireProtocol.BINARY_BATCHED.code());
+    }
+}
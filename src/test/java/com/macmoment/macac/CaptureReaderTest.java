@@ -0,0 +1,170 @@
+package com.macmoment.macac;
+
+import com.macmoment.macac.model.CombatInput;
+import com.macmoment.macac.model.TelemetryInput;
+import com.macmoment.macac.util.CaptureReader;
+import com.macmoment.macac.util.PacketQueue;
+import com.macmoment.macac.util.TelemetryCapture;
+import org.junit.jupiter.api.Test;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.UUID;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+/**
+ * Unit tests for decoding capture files in the native record layout.
+ */
+class CaptureReaderTest {
+    
+    private static final UUID PLAYER = new UUID(0x0123456789ABCDEFL, 0xFEDCBA9876543210L);
+    private static final UUID TARGET = new UUID(42L, 43L);
+    
+    private final List<UUID> telemetryIds = new ArrayList<>();
+    private final List<TelemetryInput> telemetry = new ArrayList<>();
+    private final List<CombatInput> combat = new ArrayList<>();
+    
+    private final CaptureReader.Visitor visitor = new CaptureReader.Visitor() {
+        @Override
+        public void telemetry(UUID playerId, TelemetryInput input) {
+            telemetryIds.add(playerId);
+            telemetry.add(input);
+        }
+        
+        @Override
+        public void combat(CombatInput input) {
+            combat.add(input);
+        }
+    };
+    
+    private static ByteBuffer capture(ByteOrder order, int extra) {
+        ByteBuffer buf = ByteBuffer.allocate(CaptureReader.HEADER_BYTES + CaptureReader.TELEMETRY_BYTES
+            + CaptureReader.COMBAT_BYTES + extra).order(order);
+        buf.put("MACACCAP".getBytes());
+        buf.putInt(8, CaptureReader.VERSION);
+        buf.putInt(12, CaptureReader.HEADER_BYTES);
+        buf.putLong(24, 1703864123456L);
+        buf.putInt(32, 7);
+        
+        int t = CaptureReader.HEADER_BYTES;
+        buf.putShort(t, (short) CaptureReader.TYPE_TELEMETRY);
+        buf.putShort(t + 2, (short) CaptureReader.TELEMETRY_BYTES);
+        buf.putLong(t + 8, PLAYER.getMostSignificantBits());
+        buf.putLong(t + 16, PLAYER.getLeastSignificantBits());
+        int r = t + 24;
+        buf.putDouble(r, 0.1);
+        buf.putDouble(r + 8, 0.42);
+        buf.putDouble(r + 16, -0.2);
+        buf.putFloat(r + 24, 90.0f);
+        buf.putFloat(r + 28, -10.0f);
+        buf.putFloat(r + 32, 1.5f);
+        buf.putFloat(r + 36, -0.5f);
+        buf.putLong(r + 40, 123_000_000L);
+        buf.putLong(r + 48, 50_000_000L);
+        buf.putInt(r + 56, 35);
+        buf.putInt(r + 64, PacketQueue.FLAG_ON_GROUND | PacketQueue.FLAG_SWIMMING);
+        
+        int c = t + CaptureReader.TELEMETRY_BYTES;
+        buf.putShort(c, (short) CaptureReader.TYPE_COMBAT);
+        buf.putShort(c + 2, (short) CaptureReader.COMBAT_BYTES);
+        buf.putInt(c + 4, TelemetryCapture.COMBAT_HIT | TelemetryCapture.COMBAT_HAS_TARGET);
+        buf.putLong(c + 8, PLAYER.getMostSignificantBits());
+        buf.putLong(c + 16, PLAYER.getLeastSignificantBits());
+        buf.putLong(c + 24, TARGET.getMostSignificantBits());
+        buf.putLong(c + 32, TARGET.getLeastSignificantBits());
+        buf.putDouble(c + 40, 3.0);
+        buf.putDouble(c + 48, 64.0);
+        buf.putDouble(c + 56, 1.0);
+        buf.putDouble(c + 64, 0.5);
+        buf.putDouble(c + 72, 64.0);
+        buf.putDouble(c + 80, -1.0);
+        buf.putDouble(c + 88, 4.5);
+        buf.putFloat(c + 96, 45.0f);
+        buf.putFloat(c + 100, 5.0f);
+        buf.putFloat(c + 104, 40.0f);
+        buf.putFloat(c + 108, 6.0f);
+        buf.putLong(c + 112, 124_000_000L);
+        buf.putLong(c + 120, 250_000_000L);
+        buf.putInt(c + 128, 35);
+        return buf;
+    }
+    
+    @Test
+    void testDecodesRecords() throws IOException {
+        CaptureReader.Summary summary = CaptureReader.read(capture(ByteOrder.LITTLE_ENDIAN, 0), visitor);
+        
+        assertEquals(7, summary.fileIndex());
+        assertEquals(1703864123456L, summary.startUnixMs());
+        assertEquals(1, summary.telemetry());
+        assertEquals(1, summary.combat());
+        assertEquals(0, summary.skipped());
+        assertFalse(summary.truncated());
+        
+        assertEquals(PLAYER, telemetryIds.get(0));
+        TelemetryInput in = telemetry.get(0);
+        assertEquals(0.1, in.dx());
+        assertEquals(0.42, in.dy());
+        assertEquals(-0.2, in.dz());
+        assertEquals(90.0f, in.yaw());
+        assertEquals(-0.5f, in.deltaPitch());
+        assertTrue(in.onGround());
+        assertTrue(in.swimming());
+        assertFalse(in.gliding());
+        assertEquals(35, in.ping());
+        assertEquals(123_000_000L, in.nanoTime());
+        assertEquals(50_000_000L, in.tickDelta());
+        
+        CombatInput hit = combat.get(0);
+        assertEquals(PLAYER, hit.attackerId());
+        assertNull(hit.attackerName());
+        assertEquals(TARGET, hit.targetId());
+        assertEquals(3.0, hit.targetX());
+        assertEquals(-1.0, hit.attackerZ());
+        assertEquals(45.0f, hit.attackerYaw());
+        assertEquals(6.0f, hit.preAttackPitch());
+        assertEquals(250_000_000L, hit.timeSinceLastAttack());
+        assertTrue(hit.hit());
+        assertFalse(hit.critical());
+        assertEquals(4.5, hit.damage());
+    }
+    
+    @Test
+    void testDetectsWriterByteOrder() throws IOException {
+        CaptureReader.Summary summary = CaptureReader.read(capture(ByteOrder.BIG_ENDIAN, 0), visitor);
+        assertEquals(7, summary.fileIndex());
+        assertEquals(PLAYER, telemetryIds.get(0));
+        assertEquals(TARGET, combat.get(0).targetId());
+    }
+    
+    @Test
+    void testSkipsUnknownAndStopsAtTornTail() throws IOException {
+        ByteBuffer buf = capture(ByteOrder.LITTLE_ENDIAN, 16 + 8);
+        int tail = CaptureReader.HEADER_BYTES + CaptureReader.TELEMETRY_BYTES + CaptureReader.COMBAT_BYTES;
+        buf.putShort(tail, (short) 99);
+        buf.putShort(tail + 2, (short) 16);
+        buf.putShort(tail + 16, (short) CaptureReader.TYPE_TELEMETRY);
+        buf.putShort(tail + 18, (short) CaptureReader.TELEMETRY_BYTES);
+        
+        CaptureReader.Summary summary = CaptureReader.read(buf, visitor);
+        assertEquals(1, summary.telemetry());
+        assertEquals(1, summary.skipped());
+        assertTrue(summary.truncated());
+    }
+    
+    @Test
+    void testRejectsNonCapture() {
+        ByteBuffer buf = capture(ByteOrder.LITTLE_ENDIAN, 0);
+        buf.put(0, (byte) 'X');
+        assertThrows(IOException.class, () -> CaptureReader.read(buf, visitor));
+        
+        ByteBuffer future = capture(ByteOrder.LITTLE_ENDIAN, 0);
+        future.putInt(8, CaptureReader.VERSION + 1);
+        assertThrows(IOException.class, () -> CaptureReader.read(future, visitor));
+        
+        assertThrows(IOException.class, () -> CaptureReader.read(ByteBuffer.allocate(8), visitor));
+    }
+}
@@ -0,0 +1,45 @@
+package com.macmoment.macac;
+
+import com.macmoment.macac.network.Endpoint;
+import org.junit.jupiter.api.Test;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+/**
+ * Unit tests for analytics endpoint parsing.
+ */
+class EndpointTest {
+    
+    @Test
+    void testHostAndPort() {
+        assertEquals(new Endpoint("collector.example", 9600), Endpoint.parse("collector.example:9600", 9500));
+        assertEquals(new Endpoint("collector.example", 9500), Endpoint.parse(" collector.example ", 9500));
+        assertEquals(new Endpoint("10.0.0.5", 9501), Endpoint.parse("10.0.0.5:9501", 9500));
+    }
+    
+    @Test
+    void testIpv6Forms() {
+        assertEquals(new Endpoint("::1", 9600), Endpoint.parse("[::1]:9600", 9500));
+        assertEquals(new Endpoint("::1", 9500), Endpoint.parse("[::1]", 9500));
+        assertEquals(new Endpoint("fd00::5", 9500), Endpoint.parse("fd00::5", 9500));
+        
+        assertEquals("[::1]:9600", new Endpoint("::1", 9600).toString());
+        assertEquals("collector:9600", new Endpoint("collector", 9600).toString());
+        
+        // toString round-trips through parse
+        Endpoint v6 = new Endpoint("fd00::5", 7);
+        assertEquals(v6, Endpoint.parse(v6.toString(), 9500));
+    }
+    
+    @Test
+    void testRejectsMalformed() {
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("host:", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("host:abc", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("host:70000", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("[::1", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("[::1]9600", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse(":9600", 9500));
+        assertThrows(IllegalArgumentException.class, () -> Endpoint.parse("host", 0));
+    }
+}
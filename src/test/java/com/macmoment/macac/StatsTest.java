@@ -3,6 +3,9 @@ package com.macmoment.macac;
 import com.macmoment.macac.util.Stats;
 import org.junit.jupiter.api.Test;
 
+import java.nio.ByteBuffer;
+import java.util.Random;
+
 import static org.junit.jupiter.api.Assertions.*;
 
 /**
@@ -230,6 +233,170 @@ class StatsTest {
         assertThrows(IllegalArgumentException.class, () -> new Stats.RollingWindow(-1));
     }
     
+    @Test
+    void testRollingWindowMedianMadAfterWrap() {
+        Stats.RollingWindow window = new Stats.RollingWindow(4);
+        double[] samples = {100.0, 1.0, 9.0, 3.0, 7.0, 5.0};
+        for (double sample : samples) {
+            window.add(sample);
+        }
+        
+        // Window holds 9, 3, 7, 5; repeated queries reuse the same scratch
+        double[] expected = {9.0, 3.0, 7.0, 5.0};
+        for (int i = 0; i < 2; i++) {
+            assertEquals(Stats.median(expected), window.median(), DELTA);
+            assertEquals(Stats.mad(expected), window.mad(), DELTA);
+        }
+        
+        // Queries must not disturb the window order
+        assertArrayEquals(expected, window.toArray(), DELTA);
+    }
+    
+    @Test
+    void testRollingWindowCopyTo() {
+        Stats.RollingWindow window = new Stats.RollingWindow(3);
+        for (int i = 1; i <= 5; i++) {
+            window.add(i);
+        }
+        
+        ByteBuffer buffer = ByteBuffer.allocate(5 * Double.BYTES);
+        
+        // Oldest to newest after wraparound: 3, 4, 5
+        assertEquals(3, window.copyTo(buffer, Double.BYTES, 10));
+        assertEquals(0.0, buffer.getDouble(0), DELTA);
+        assertEquals(3.0, buffer.getDouble(Double.BYTES), DELTA);
+        assertEquals(4.0, buffer.getDouble(2 * Double.BYTES), DELTA);
+        assertEquals(5.0, buffer.getDouble(3 * Double.BYTES), DELTA);
+        
+        // maxCount keeps only the newest samples
+        assertEquals(2, window.copyTo(buffer, 0, 2));
+        assertEquals(4.0, buffer.getDouble(0), DELTA);
+        assertEquals(5.0, buffer.getDouble(Double.BYTES), DELTA);
+        assertEquals(0, buffer.position());
+    }
+    
+    @Test
+    void testRollingWindowOffHeapMatchesHeap() {
+        Stats.RollingWindow heap = new Stats.RollingWindow(4);
+        Stats.RollingWindow offHeap = Stats.RollingWindow.offHeap(4);
+        assertTrue(offHeap.isOffHeap());
+        assertFalse(heap.isOffHeap());
+        
+        double[] samples = {100.0, 1.0, 9.0, 3.0, 7.0, 5.0};
+        for (double sample : samples) {
+            heap.add(sample);
+            offHeap.add(sample);
+        }
+        
+        assertEquals(4, offHeap.size());
+        assertEquals(4, offHeap.capacity());
+        assertArrayEquals(heap.toArray(), offHeap.toArray(), DELTA);
+        assertEquals(heap.median(), offHeap.median(), DELTA);
+        assertEquals(heap.mad(), offHeap.mad(), DELTA);
+        assertEquals(heap.mean(), offHeap.mean(), DELTA);
+        assertEquals(heap.stdDev(), offHeap.stdDev(), DELTA);
+        assertEquals(3.0, offHeap.min(), DELTA);
+        assertEquals(9.0, offHeap.max(), DELTA);
+        assertEquals(2, offHeap.countBelow(6.0));
+    }
+    
+    @Test
+    void testRollingWindowStatsMatchArrayStats() {
+        Stats.RollingWindow window = new Stats.RollingWindow(3);
+        for (int i = 1; i <= 5; i++) {
+            window.add(i * 1.5);
+        }
+        
+        double[] contents = window.toArray();
+        assertEquals(Stats.mean(contents), window.mean(), 0.0);
+        assertEquals(Stats.stdDev(contents), window.stdDev(), 0.0);
+        assertEquals(0.0, new Stats.RollingWindow(3).stdDev(), DELTA);
+    }
+    
+    @Test
+    void testRollingWindowDescribe() {
+        Stats.RollingWindow window = new Stats.RollingWindow(8);
+        window.add(100.0);
+        window.add(100.0);
+        for (double v : new double[] {2, 4, 4, 4, 5, 5, 7, 9}) {
+            window.add(v);
+        }
+        
+        Stats.Description d = window.describe();
+        assertEquals(8, d.count());
+        assertEquals(40.0, d.sum(), DELTA);
+        assertEquals(window.mean(), d.mean(), 0.0);
+        assertEquals(window.stdDev(), d.stdDev(), 0.0);
+        assertEquals(32.0 / 7.0, d.variance(), DELTA);
+        assertEquals(2.0, d.min(), DELTA);
+        assertEquals(9.0, d.max(), DELTA);
+        assertEquals(0.65625, d.skewness(), DELTA);
+        assertEquals(-0.21875, d.kurtosis(), DELTA);
+        
+        window.clear();
+        window.add(3.0);
+        d = window.describe();
+        assertEquals(1, d.count());
+        assertEquals(3.0, d.mean(), DELTA);
+        assertEquals(0.0, d.variance(), DELTA);
+        assertEquals(0.0, d.skewness(), DELTA);
+        
+        window.clear();
+        assertEquals(0, window.describe().count());
+        assertEquals(0.0, window.describe().max(), DELTA);
+    }
+    
+    @Test
+    void testRollingWindowSpectrumPeriodic() {
+        // Wraps, so the newest 64 values start mid-ring
+        Stats.RollingWindow window = new Stats.RollingWindow(64);
+        for (int i = 0; i < 67; i++) {
+            window.add(80.0 + 20.0 * Math.sin(2.0 * Math.PI * i / 8.0));
+        }
+        
+        Stats.Spectrum s = window.spectrum();
+        assertEquals(64, s.window());
+        assertEquals(0.125, s.peakFrequency(), 1e-12);
+        assertEquals(1.0, s.peakPower(), 1e-9);
+        assertEquals(0.0, s.entropy(), 1e-6);
+        assertEquals(8, s.autocorrLag());
+        assertEquals(56.0 / 64.0, s.autocorrPeak(), 1e-9);
+    }
+    
+    @Test
+    void testRollingWindowSpectrumNoise() {
+        Stats.RollingWindow window = new Stats.RollingWindow(200);
+        Random random = new Random(42);
+        for (int i = 0; i < 200; i++) {
+            window.add(80.0 + 10.0 * random.nextGaussian());
+        }
+        
+        Stats.Spectrum s = window.spectrum();
+        assertEquals(128, s.window());
+        assertTrue(s.entropy() > 0.7, "white jitter spreads its power");
+        assertTrue(s.peakPower() < 0.3);
+        assertTrue(s.autocorrPeak() < 0.5);
+    }
+    
+    @Test
+    void testRollingWindowSpectrumUnavailable() {
+        Stats.RollingWindow window = new Stats.RollingWindow(64);
+        for (int i = 0; i < Stats.Spectrum.MIN_WINDOW - 1; i++) {
+            window.add(i % 2 == 0 ? 50.0 : 70.0);
+        }
+        assertEquals(0, window.spectrum().window());
+        
+        // No spread
+        window.clear();
+        for (int i = 0; i < 64; i++) {
+            window.add(50.0);
+        }
+        Stats.Spectrum s = window.spectrum();
+        assertEquals(0, s.window());
+        assertEquals(0.0, s.entropy(), 0.0);
+        assertEquals(0.0, s.autocorrPeak(), 0.0);
+    }
+    
     // Confidence bounding tests
     
     @Test